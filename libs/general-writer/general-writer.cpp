@@ -26,6 +26,7 @@
 
 #include <general-writer/general-writer.hpp>
 #include <general-writer/utf8-like-int-codec.h>
+#include <general-writer/gw-ring.h>
 
 #include <kfc/defs.h>
 
@@ -43,7 +44,7 @@
 namespace ncbi
 {
 
-#if GW_CURRENT_VERSION <= 2
+#if GW_CURRENT_VERSION <= 3
     typedef :: gwp_1string_evt_v1 gwp_1string_evt;
     typedef :: gwp_2string_evt_v1 gwp_2string_evt;
     typedef :: gwp_column_evt_v1 gwp_column_evt;
@@ -839,6 +840,188 @@ namespace ncbi
     }
 
 
+    template < class T > static
+    size_t encode_row ( const void * data, uint32_t elem_count, uint8_t * start, uint8_t * end )
+    {
+        // returns the packed size of the cell, or ~0 if it does not fit
+        const T * input = ( const T * ) data;
+        uint8_t * p = start;
+
+        for ( uint32_t i = 0; i < elem_count; ++ i )
+        {
+            int num_writ = encode_int < T > ( input [ i ], p, end );
+            if ( num_writ <= 0 )
+            {
+                if ( num_writ < 0 )
+                    throw "error encoding integer data";
+                return ~ ( size_t ) 0;
+            }
+            p += num_writ;
+        }
+
+        return p - start;
+    }
+
+    void GeneralWriter :: useRowBatches ()
+    {
+        if ( header_sent )
+            throw "row batches must be announced before the first event";
+
+        version = GW_CURRENT_VERSION;
+    }
+
+    void GeneralWriter :: writeRows ( int stream_id, uint32_t elem_bits, const void *data,
+                                      uint32_t elem_count, uint32_t row_count )
+    {
+        write_rows ( stream_id, elem_bits, data, elem_count, 0, row_count );
+    }
+
+    void GeneralWriter :: writeRows ( int stream_id, uint32_t elem_bits, const void *data,
+                                      const uint32_t *elem_counts, uint32_t row_count )
+    {
+        if ( elem_counts == 0 && row_count != 0 )
+            throw "Invalid elem_counts ptr";
+
+        write_rows ( stream_id, elem_bits, data, 0, elem_counts, row_count );
+    }
+
+    void GeneralWriter :: write_rows ( int stream_id, uint32_t elem_bits, const void *data,
+                                       uint32_t elem_count, const uint32_t *elem_counts, uint32_t row_count )
+    {
+        switch ( state )
+        {
+        case opened:
+            break;
+        default:
+            throw "state violation writing column data";
+        }
+
+        if ( version < GW_CURRENT_VERSION )
+            throw "row batches were not announced with useRowBatches";
+
+        if ( stream_id < 0 )
+            throw "Stream_id is not valid";
+        if ( stream_id > ( int ) streams.size () )
+            throw "Stream_id is out of bounds";
+
+        if ( row_count == 0 )
+            return;
+
+        const int_stream & s = streams [ stream_id - 1 ];
+
+        if ( elem_bits != s . elem_bits )
+            throw "Invalid elem_bits";
+        if ( elem_bits % 8 != 0 )
+            throw "Row batches need whole-byte elements";
+
+        size_t elem_bytes = elem_bits / 8;
+        const uint8_t * dp = ( const uint8_t * ) data;
+        if ( dp == 0 )
+            throw "Invalid data ptr";
+
+        bool compact_int = ( s . flag_bits & 1 ) != 0;
+        size_t ( * encode ) ( const void * data, uint32_t elem_count, uint8_t * start, uint8_t * end ) = 0;
+        if ( compact_int )
+        {
+            switch ( elem_bits )
+            {
+            case 16:
+                encode = encode_row < uint16_t >;
+                break;
+            case 32:
+                encode = encode_row < uint32_t >;
+                break;
+            case 64:
+                encode = encode_row < uint64_t >;
+                break;
+            default:
+                throw "INTERNAL ERROR: corrupt element bits";
+            }
+        }
+
+        // each event carries as many rows as fit into bsize bytes of payload
+        for ( uint32_t row = 0; row < row_count; )
+        {
+            uint32_t first = row;
+            const uint8_t * first_dp = dp;
+            size_t data_size = 0;
+
+            counts_buffer . clear ();
+            while ( row < row_count && row - first < 0x10000 )
+            {
+                uint32_t count = elem_counts != 0 ? elem_counts [ row ] : elem_count;
+
+                uint8_t count_buf [ 8 ];
+                size_t count_size = 0;
+                if ( elem_counts != 0 )
+                    count_size = encode_int < uint32_t > ( count, count_buf, count_buf + sizeof count_buf );
+
+                size_t used = counts_buffer . size () + count_size + data_size;
+                size_t avail = used < bsize ? bsize - used : 0;
+                size_t cell_size = ( size_t ) count * elem_bytes;
+                if ( encode != 0 )
+                {
+                    cell_size = ( * encode ) ( dp, count, packing_buffer + data_size, packing_buffer + data_size + avail );
+                    if ( cell_size == ~ ( size_t ) 0 )
+                    {
+                        if ( row == first )
+                            throw "packed cell exceeds maximum row batch";
+                        break;
+                    }
+                }
+                else if ( cell_size > avail && row != first )
+                {
+                    break;
+                }
+
+                counts_buffer . insert ( counts_buffer . end (), count_buf, count_buf + count_size );
+                data_size += cell_size;
+                dp += ( size_t ) count * elem_bytes;
+                ++ row;
+            }
+
+            gwp_rows_evt_v1 hdr;
+            init ( hdr, stream_id, evt_cell_rows );
+            set_rows ( hdr, row - first );
+            if ( elem_counts != 0 )
+                set_variable ( hdr );
+            else
+                set_elem_count ( hdr, elem_count );
+            set_size ( hdr, counts_buffer . size () + data_size );
+            write_event ( & hdr . dad, sizeof hdr );
+
+            if ( ! counts_buffer . empty () )
+                internal_write ( counts_buffer . data (), counts_buffer . size () );
+            if ( data_size != 0 )
+                internal_write ( encode != 0 ? packing_buffer : first_dp, data_size );
+        }
+    }
+
+    void GeneralWriter :: nextRows ( int table_id, uint32_t row_count )
+    {
+        switch ( state )
+        {
+        case opened:
+            break;
+        default:
+            throw "state violation advancing to next row";
+        }
+
+        if ( version < GW_CURRENT_VERSION )
+            throw "row batches were not announced with useRowBatches";
+
+        if ( table_id < 0 || ( size_t ) table_id > tables.size () )
+            throw "Invalid table id";
+
+        if ( row_count == 0 )
+            return;
+
+        gwp_move_ahead_evt_v1 hdr;
+        init ( hdr, table_id, evt_next_rows );
+        set_nrows ( hdr, row_count );
+        write_event ( & hdr . dad, sizeof hdr );
+    }
+
     void GeneralWriter :: moveAhead ( int table_id, uint64_t nrows )
     {
         switch ( state )
@@ -1016,10 +1199,32 @@ namespace ncbi
         , output_bsize ( 0 )
         , output_marker ( 0 )
         , out_fd ( -1 )
-        , state ( uninitialized )
+        , ring ( 0 )
+        , version ( GW_COMPATIBLE_VERSION )
+        , header_sent ( false )
+        , state ( header_written )
     {
         packing_buffer = new uint8_t [ bsize ];
-        writeHeader ();
+    }
+
+    GeneralWriter :: GeneralWriter ( const shared_ring & out_ring )
+        : evt_count ( 0 )
+        , byte_count ( 0 )
+        , pid ( getpid () )
+        , packing_buffer ( 0 )
+        , output_buffer ( 0 )
+        , output_bsize ( 0 )
+        , output_marker ( 0 )
+        , out_fd ( -1 )
+        , ring ( 0 )
+        , version ( GW_COMPATIBLE_VERSION )
+        , header_sent ( false )
+        , state ( header_written )
+    {
+        if ( gw_ring_create ( & ring, out_ring . path . c_str (), out_ring . size ) != 0 )
+            throw "Error creating shared ring";
+
+        packing_buffer = new uint8_t [ bsize ];
     }
 
 
@@ -1033,11 +1238,13 @@ namespace ncbi
         , output_bsize ( buffer_size )
         , output_marker ( 0 )
         , out_fd ( _out_fd )
-        , state ( uninitialized )
+        , ring ( 0 )
+        , version ( GW_COMPATIBLE_VERSION )
+        , header_sent ( false )
+        , state ( header_written )
     {
         packing_buffer = new uint8_t [ bsize ];
         output_buffer = new uint8_t [ buffer_size ];
-        writeHeader ();
     }
 
     GeneralWriter :: ~GeneralWriter ()
@@ -1050,6 +1257,9 @@ namespace ncbi
         {
         }
 
+        gw_ring_release ( ring );
+        ring = 0;
+
         delete [] output_buffer;
         delete [] packing_buffer;
 
@@ -1096,14 +1306,19 @@ namespace ncbi
     {
         :: gw_header_v1 hdr;
         init ( hdr );
+        hdr . dad . version = version;
+        header_sent = true;
         internal_write ( & hdr, sizeof hdr );
-        state = header_written;
-
     }
 
     void GeneralWriter :: flush ()
     {
-        if ( out_fd < 0 )
+        if ( ring != 0 )
+        {
+            if ( gw_ring_flush ( ring ) != 0 )
+                throw "Error writing to shared ring";
+        }
+        else if ( out_fd < 0 )
             out . flush ();
         else
         {
@@ -1123,7 +1338,13 @@ namespace ncbi
 
     void GeneralWriter :: internal_write ( const void * data, size_t num_bytes )
     {
-        if ( out_fd < 0 )
+        if ( ring != 0 )
+        {
+            if ( gw_ring_write ( ring, data, num_bytes ) != 0 )
+                throw "Error writing to shared ring";
+            byte_count += num_bytes;
+        }
+        else if ( out_fd < 0 )
         {
             out.write ( ( const char * ) data, num_bytes );
             byte_count += num_bytes;
@@ -1168,6 +1389,9 @@ namespace ncbi
 #endif
         ++ evt_count;
 
+        if ( ! header_sent )
+            writeHeader ();
+
         assert ( evt ( * e ) != evt_bad_event );
         assert ( evt ( * e ) <  evt_max_id );
 
@@ -729,6 +729,150 @@ namespace gw_dump
         }
     }
 
+    /* dump_cell_rows
+     */
+    static
+    void dump_cell_rows ( FILE * in, const gwp_evt_hdr_v1 & e )
+    {
+        gwp_rows_evt_v1 eh;
+        init ( eh, e );
+
+        size_t num_read = readFILE ( & eh . flags, sizeof eh - sizeof ( gwp_evt_hdr_v1 ), 1, in );
+        if ( num_read != 1 )
+            throw "failed to read cell-rows event";
+
+        check_cell_event ( eh );
+
+        auto const data_size = size ( eh );
+        auto data_buffer = std::vector<uint8_t>(data_size);
+        if (data_size != readFILE(data_buffer.data(), 1, data_size, in))
+            throw "failed to read cell-rows data";
+
+        auto const columnId = id(eh.dad);
+        col_entry const &entry = col_entries[columnId - 1];
+        if ( entry . elem_bits % 8 != 0 )
+            throw "cell-rows event for a column with partial-byte elements";
+
+        // per-row element counts come first when they vary
+        auto const nrows = rows ( eh );
+        const uint8_t * start = data_buffer . data ();
+        const uint8_t * end = start + data_size;
+        uint64_t elem_count = 0;
+        if ( variable ( eh ) )
+        {
+            for ( uint32_t i = 0; i < nrows; ++ i )
+            {
+                uint32_t count;
+                int num_read = decode_uint32 ( start, end, & count );
+                if ( num_read <= 0 )
+                    throw "corrupt row element counts in cell-rows event";
+                start += num_read;
+                elem_count += count;
+            }
+        }
+        else
+        {
+            elem_count = ( uint64_t ) nrows * ncbi :: elem_count ( eh );
+        }
+
+        bool packed_int = false;
+        size_t elems_size = end - start;
+        size_t unpacked_size = elems_size;
+        if ( ( entry . flag_bits & 1 ) != 0 )
+        {
+            switch ( entry . elem_bits )
+            {
+            case 16:
+                unpacked_size = check_int_packing < uint16_t > ( start, elems_size );
+                break;
+            case 32:
+                unpacked_size = check_int_packing < uint32_t > ( start, elems_size );
+                break;
+            case 64:
+                unpacked_size = check_int_packing < uint64_t > ( start, elems_size );
+                break;
+            default:
+                throw "bad element size for packed integer";
+            }
+
+            packed_int = true;
+        }
+        if ( unpacked_size != elem_count * ( entry . elem_bits / 8 ) )
+            throw "cell-rows data does not match element counts";
+
+        switch (display) {
+        case 1:
+            std :: cout
+                << event_num << ": cell-rows\n"
+                   "  stream_id = " << columnId << " ( " << tbl_entries[entry.table_id - 1].tbl_name << " . " << entry . spec << " )\n"
+                   "  elem_bits = " << entry . elem_bits << '\n'
+                << "  rows = " << nrows << ( variable ( eh ) ? " ( variable )" : "" ) << '\n'
+                ;
+            if ( packed_int )
+            {
+                std :: cout
+                    << "  elem_count = " << elem_count
+                    << " ( " << unpacked_size << " bytes, " << elems_size << " packed )\n"
+                    ;
+            }
+            else
+            {
+                std :: cout
+                    << "  elem_count = " << elem_count << " ( " << elems_size << " bytes )\n"
+                    ;
+            }
+            break;
+        case 2:
+            std::cout
+                << "{ \"event\": \"rows\""
+                   ", \"column-id\": " << columnId
+                << ", \"rows\": " << nrows
+                << ", \"elements\": " << elem_count
+                << ", \"data\": \"<packed data>\""
+                   " }\n";
+            break;
+        }
+    }
+
+    /* dump_next_rows
+     */
+    static
+    void dump_next_rows ( FILE * in, const gwp_evt_hdr_v1 & e )
+    {
+        gwp_move_ahead_evt_v1 eh;
+        init ( eh, e );
+
+        size_t num_read = readFILE ( eh . nrows, sizeof eh - sizeof ( gwp_evt_hdr_v1 ), 1, in );
+        if ( num_read != 1 )
+            throw "failed to read next-rows event";
+
+        check_move_ahead ( eh );
+
+        auto const tableId = id(eh.dad);
+        auto const nrows = get_nrows(eh);
+        tbl_entry & te = tbl_entries [ tableId - 1 ];
+
+        te . row_id += nrows;
+
+        switch (display) {
+        case 1:
+            std :: cout
+                << event_num << ": next-rows\n"
+                << "  table_id = " << tableId << " ( \"" << te . tbl_name << "\" )\n"
+                << "  nrows = " << nrows << '\n'
+                << "  row_id = " << te . row_id << '\n'
+                ;
+            break;
+        case 2:
+            std::cout
+                << "{ \"event\": \"next-rows\""
+                   ", \"table-id\": " << tableId
+                << ", \"rows\": " << nrows
+                << " }\n";
+            break;
+        }
+    }
+
     static char hex(uint8_t const x) {
         return x < 10 ? (x + '0') : ((x - 10 + 'A'));
     }
@@ -1879,6 +2023,9 @@ namespace gw_dump
         case evt_progmsg:
             dump_progmsg < gw_evt_hdr_v1, gw_status_evt_v1 > ( in, e );
             break;
+        case evt_cell_rows:
+        case evt_next_rows:
+            throw "packed event id within non-packed stream";
 
         default:
             throw "unrecognized event id";
@@ -2002,6 +2149,14 @@ namespace gw_dump
             dump_progmsg < gwp_evt_hdr_v1, gwp_status_evt_v1 > ( in, e );
             break;
 
+            // add in new message handlers for version 3
+        case evt_cell_rows:
+            dump_cell_rows ( in, e );
+            break;
+        case evt_next_rows:
+            dump_next_rows ( in, e );
+            break;
+
         default:
             throw "unrecognized packed event id";
         }
@@ -2081,6 +2236,7 @@ namespace gw_dump
         {
         case 1:
         case 2:
+        case 3:
             dump_v1_header ( in, hdr, packed );
             break;
         default:
@@ -2103,6 +2259,7 @@ namespace gw_dump
         {
         case 1:
         case 2:
+        case 3:
             if (packed)
                 dumper = dump_v1_packed_event;
 
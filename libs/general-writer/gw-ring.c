@@ -0,0 +1,500 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <general-writer/gw-ring.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#define GW_RING_SIGNATURE "GWRING01"
+
+/* how long a side sleeps before re-checking that its peer is still there */
+#define GW_RING_POLL_MS 100
+
+enum { producer, consumer };
+
+/* lives in the first page of the file; the producer and consumer
+   counters sit on separate cache lines */
+typedef struct gw_ring_hdr gw_ring_hdr;
+struct gw_ring_hdr
+{
+    char signature [ 8 ];
+    uint64_t capacity;
+    int32_t pid [ 2 ];
+    uint32_t closed [ 2 ];
+    uint8_t align0 [ 32 ];
+
+    /* written by producer */
+    uint64_t head;              /* bytes published       */
+    uint32_t head_seq;          /* futex word            */
+    uint32_t consumer_waiting;
+    uint8_t align1 [ 48 ];
+
+    /* written by consumer */
+    uint64_t tail;              /* bytes consumed        */
+    uint32_t tail_seq;          /* futex word            */
+    uint32_t producer_waiting;
+    uint8_t align2 [ 48 ];
+};
+
+struct gw_ring
+{
+    gw_ring_hdr * hdr;
+    uint8_t * data;             /* capacity bytes, mapped twice */
+    size_t map_size;
+    size_t capacity;
+    size_t batch;
+
+    uint64_t pos;               /* this side's own position            */
+    uint64_t published;         /* last position made visible to peer  */
+    uint64_t limit;             /* last seen position of the peer      */
+
+    int side;
+};
+
+#define LOAD( p ) __atomic_load_n ( p, __ATOMIC_SEQ_CST )
+#define LOAD_ACQ( p ) __atomic_load_n ( p, __ATOMIC_ACQUIRE )
+#define STORE( p, v ) __atomic_store_n ( p, v, __ATOMIC_SEQ_CST )
+#define STORE_REL( p, v ) __atomic_store_n ( p, v, __ATOMIC_RELEASE )
+#define BUMP( p ) __atomic_add_fetch ( p, 1, __ATOMIC_SEQ_CST )
+
+static
+void seq_wait ( uint32_t * seq, uint32_t val )
+{
+#if LINUX
+    struct timespec ts;
+    ts . tv_sec = 0;
+    ts . tv_nsec = GW_RING_POLL_MS * 1000000L;
+    syscall ( SYS_futex, seq, FUTEX_WAIT, val, & ts, NULL, 0 );
+#else
+    /* no cross-process futex: poll */
+    struct timespec ts;
+    ts . tv_sec = 0;
+    ts . tv_nsec = 1000000L;
+    if ( LOAD ( seq ) == val )
+        nanosleep ( & ts, NULL );
+#endif
+}
+
+static
+void seq_wake ( uint32_t * seq )
+{
+#if LINUX
+    syscall ( SYS_futex, seq, FUTEX_WAKE, 1, NULL, NULL, 0 );
+#else
+    ( void ) seq;
+#endif
+}
+
+static
+int peer_gone ( const gw_ring * self )
+{
+    int peer = 1 - self -> side;
+    int32_t pid;
+
+    if ( LOAD ( & self -> hdr -> closed [ peer ] ) != 0 )
+        return 1;
+
+    /* a peer that died without releasing the ring */
+    pid = LOAD ( & self -> hdr -> pid [ peer ] );
+    return pid != 0 && kill ( ( pid_t ) pid, 0 ) != 0 && errno == ESRCH;
+}
+
+/* make own position visible to the peer and wake it if it sleeps */
+static
+void publish ( gw_ring * self )
+{
+    gw_ring_hdr * hdr = self -> hdr;
+    if ( self -> pos == self -> published )
+        return;
+
+    self -> published = self -> pos;
+    if ( self -> side == producer )
+    {
+        STORE ( & hdr -> head, self -> pos );
+        BUMP ( & hdr -> head_seq );
+        if ( LOAD ( & hdr -> consumer_waiting ) )
+            seq_wake ( & hdr -> head_seq );
+    }
+    else
+    {
+        STORE ( & hdr -> tail, self -> pos );
+        BUMP ( & hdr -> tail_seq );
+        if ( LOAD ( & hdr -> producer_waiting ) )
+            seq_wake ( & hdr -> tail_seq );
+    }
+}
+
+/* producer: wait until at least one byte of space is free */
+static
+int wait_space ( gw_ring * self )
+{
+    gw_ring_hdr * hdr = self -> hdr;
+    int rc = 0;
+
+    publish ( self );
+    for ( ; ; )
+    {
+        uint32_t seq;
+        STORE ( & hdr -> producer_waiting, 1 );
+        seq = LOAD ( & hdr -> tail_seq );
+        self -> limit = LOAD ( & hdr -> tail );
+        if ( self -> pos - self -> limit < self -> capacity )
+            break;
+        if ( peer_gone ( self ) )
+        {
+            rc = EPIPE;
+            break;
+        }
+        seq_wait ( & hdr -> tail_seq, seq );
+    }
+    STORE ( & hdr -> producer_waiting, 0 );
+    return rc;
+}
+
+/* consumer: wait until "bytes" are available past pos */
+static
+int wait_data ( gw_ring * self, size_t bytes )
+{
+    gw_ring_hdr * hdr = self -> hdr;
+    int rc = 0;
+
+    publish ( self );
+    for ( ; ; )
+    {
+        uint32_t seq;
+        int gone;
+        STORE ( & hdr -> consumer_waiting, 1 );
+        seq = LOAD ( & hdr -> head_seq );
+        /* check the peer before the data, so that nothing published
+           right before the producer closed is missed */
+        gone = peer_gone ( self );
+        self -> limit = LOAD ( & hdr -> head );
+        if ( self -> limit - self -> pos >= bytes )
+            break;
+        if ( gone )
+        {
+            rc = EPIPE;
+            break;
+        }
+        seq_wait ( & hdr -> head_seq, seq );
+    }
+    STORE ( & hdr -> consumer_waiting, 0 );
+    return rc;
+}
+
+/* maps header page + data, then the data again right behind it */
+static
+int map_ring ( gw_ring * self, int fd, size_t page, size_t capacity )
+{
+    uint8_t * base;
+    size_t map_size = page + 2 * capacity;
+
+    base = mmap ( NULL, map_size, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0 );
+    if ( base == MAP_FAILED )
+        return errno;
+
+    if ( mmap ( base, page + capacity, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_FIXED, fd, 0 ) == MAP_FAILED ||
+         mmap ( base + page + capacity, capacity, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_FIXED, fd, ( off_t ) page ) == MAP_FAILED )
+    {
+        int rc = errno;
+        munmap ( base, map_size );
+        return rc;
+    }
+
+    self -> hdr = ( gw_ring_hdr * ) base;
+    self -> data = base + page;
+    self -> map_size = map_size;
+    self -> capacity = capacity;
+    self -> batch = capacity / 16;
+    return 0;
+}
+
+int gw_ring_create ( gw_ring ** ring, const char * path, size_t capacity )
+{
+    int rc, fd;
+    gw_ring * self;
+    char * tmp_path;
+    size_t page = ( size_t ) sysconf ( _SC_PAGESIZE );
+
+    if ( ring == NULL || path == NULL || capacity == 0 )
+        return EINVAL;
+    * ring = NULL;
+
+    capacity = ( capacity + page - 1 ) / page * page;
+
+    self = calloc ( 1, sizeof * self );
+    tmp_path = malloc ( strlen ( path ) + 8 );
+    if ( self == NULL || tmp_path == NULL )
+    {
+        free ( self );
+        free ( tmp_path );
+        return ENOMEM;
+    }
+
+    /* initialize under a temporary name so the consumer
+       never sees a half-made ring */
+    sprintf ( tmp_path, "%s.XXXXXX", path );
+    fd = mkstemp ( tmp_path );
+    if ( fd < 0 )
+        rc = errno;
+    else
+    {
+        if ( ftruncate ( fd, ( off_t ) ( page + capacity ) ) != 0 )
+            rc = errno;
+        else
+            rc = map_ring ( self, fd, page, capacity );
+        close ( fd );
+
+        if ( rc == 0 )
+        {
+            memcpy ( self -> hdr -> signature, GW_RING_SIGNATURE, sizeof self -> hdr -> signature );
+            self -> hdr -> capacity = capacity;
+            self -> hdr -> pid [ producer ] = ( int32_t ) getpid ();
+            self -> side = producer;
+
+            if ( rename ( tmp_path, path ) == 0 )
+            {
+                free ( tmp_path );
+                * ring = self;
+                return 0;
+            }
+
+            rc = errno;
+            munmap ( self -> hdr, self -> map_size );
+        }
+        unlink ( tmp_path );
+    }
+
+    free ( tmp_path );
+    free ( self );
+    return rc;
+}
+
+int gw_ring_attach ( gw_ring ** ring, const char * path, uint32_t timeout_ms )
+{
+    int rc, fd;
+    gw_ring * self;
+    gw_ring_hdr hdr;
+    struct stat st;
+    uint32_t waited;
+    size_t page = ( size_t ) sysconf ( _SC_PAGESIZE );
+
+    if ( ring == NULL || path == NULL )
+        return EINVAL;
+    * ring = NULL;
+
+    /* the producer may not have started yet */
+    for ( waited = 0; ; waited += 10 )
+    {
+        fd = open ( path, O_RDWR );
+        if ( fd >= 0 )
+            break;
+        if ( errno != ENOENT )
+            return errno;
+        if ( waited >= timeout_ms )
+            return ETIMEDOUT;
+        usleep ( 10000 );
+    }
+
+    if ( fstat ( fd, & st ) != 0 )
+        rc = errno;
+    else if ( pread ( fd, & hdr, sizeof hdr, 0 ) != ( ssize_t ) sizeof hdr ||
+              memcmp ( hdr . signature, GW_RING_SIGNATURE, sizeof hdr . signature ) != 0 ||
+              hdr . capacity == 0 || hdr . capacity % page != 0 ||
+              ( uint64_t ) st . st_size != page + hdr . capacity )
+    {
+        rc = EINVAL;
+    }
+    else
+    {
+        self = calloc ( 1, sizeof * self );
+        if ( self == NULL )
+            rc = ENOMEM;
+        else
+        {
+            rc = map_ring ( self, fd, page, ( size_t ) hdr . capacity );
+            if ( rc != 0 )
+                free ( self );
+            else
+            {
+                self -> side = consumer;
+                STORE ( & self -> hdr -> pid [ consumer ], ( int32_t ) getpid () );
+                /* nobody else may attach */
+                unlink ( path );
+                * ring = self;
+            }
+        }
+    }
+
+    close ( fd );
+    return rc;
+}
+
+void gw_ring_release ( gw_ring * self )
+{
+    if ( self != NULL )
+    {
+        gw_ring_hdr * hdr = self -> hdr;
+
+        publish ( self );
+        STORE ( & hdr -> closed [ self -> side ], 1 );
+        if ( self -> side == producer )
+        {
+            BUMP ( & hdr -> head_seq );
+            seq_wake ( & hdr -> head_seq );
+        }
+        else
+        {
+            BUMP ( & hdr -> tail_seq );
+            seq_wake ( & hdr -> tail_seq );
+        }
+
+        munmap ( hdr, self -> map_size );
+        free ( self );
+    }
+}
+
+size_t gw_ring_capacity ( const gw_ring * self )
+{
+    return self == NULL ? 0 : self -> capacity;
+}
+
+int gw_ring_write ( gw_ring * self, const void * data, size_t bytes )
+{
+    const uint8_t * src = data;
+
+    if ( self == NULL || self -> side != producer )
+        return EINVAL;
+
+    while ( bytes > 0 )
+    {
+        size_t space = self -> capacity - ( size_t ) ( self -> pos - self -> limit );
+        if ( space == 0 )
+        {
+            self -> limit = LOAD_ACQ ( & self -> hdr -> tail );
+            space = self -> capacity - ( size_t ) ( self -> pos - self -> limit );
+            if ( space == 0 )
+            {
+                int rc = wait_space ( self );
+                if ( rc != 0 )
+                    return rc;
+                continue;
+            }
+        }
+
+        if ( space > bytes )
+            space = bytes;
+
+        /* the second mapping makes the wrap-around contiguous */
+        memmove ( self -> data + self -> pos % self -> capacity, src, space );
+        self -> pos += space;
+        src += space;
+        bytes -= space;
+
+        if ( self -> pos - self -> published >= self -> batch )
+            publish ( self );
+    }
+
+    return 0;
+}
+
+int gw_ring_flush ( gw_ring * self )
+{
+    if ( self == NULL || self -> side != producer )
+        return EINVAL;
+    publish ( self );
+    return peer_gone ( self ) ? EPIPE : 0;
+}
+
+int gw_ring_acquire ( gw_ring * self, const void ** data, size_t bytes )
+{
+    if ( self == NULL || data == NULL || self -> side != consumer || bytes > self -> capacity )
+        return EINVAL;
+
+    if ( self -> limit - self -> pos < bytes )
+    {
+        self -> limit = LOAD_ACQ ( & self -> hdr -> head );
+        if ( self -> limit - self -> pos < bytes )
+        {
+            int rc = wait_data ( self, bytes );
+            if ( rc != 0 )
+                return rc;
+        }
+    }
+
+    * data = self -> data + self -> pos % self -> capacity;
+    return 0;
+}
+
+void gw_ring_consume ( gw_ring * self, size_t bytes )
+{
+    if ( self != NULL && self -> side == consumer )
+    {
+        self -> pos += bytes;
+        if ( self -> pos - self -> published >= self -> batch )
+            publish ( self );
+    }
+}
+
+int gw_ring_read ( gw_ring * self, void * buffer, size_t bytes )
+{
+    uint8_t * dst = buffer;
+
+    if ( self == NULL )
+        return EINVAL;
+
+    while ( bytes > 0 )
+    {
+        const void * src;
+        size_t chunk = bytes < self -> capacity ? bytes : self -> capacity;
+        int rc = gw_ring_acquire ( self, & src, chunk );
+        if ( rc != 0 )
+            return rc;
+
+        memmove ( dst, src, chunk );
+        gw_ring_consume ( self, chunk );
+        dst += chunk;
+        bytes -= chunk;
+    }
+
+    return 0;
+}
@@ -80,13 +80,20 @@ enum gw_evt_id
     evt_logmsg,
     evt_progmsg,
 
+    /* BEGIN VERSION 3 MESSAGES */
+    evt_cell_rows,                        /* cells of consecutive rows   */
+    evt_next_rows,                        /* commit rows of cell_rows    */
+
     evt_max_id                            /* must be last                */
 };
 
 #define GW_SIGNATURE "NCBIgnld"
 #define GW_GOOD_ENDIAN 1
 #define GW_REVERSE_ENDIAN ( 1 << 24 )
-#define GW_CURRENT_VERSION 2
+#define GW_CURRENT_VERSION 3
+/* what a writer stamps into streams without version 3 messages,
+   loaders built before version 3 can read them */
+#define GW_COMPATIBLE_VERSION 2
 
 //These are not to change
 #define STRING_LIMIT_8 0x100
@@ -374,6 +381,9 @@ struct gwp_data_evt_v1
 };
 
 /* gwp_move_ahead_evt_v1
+ *
+ *  used for events:
+ *    { evt_move_ahead, evt_next_rows }
  */
 struct gwp_move_ahead_evt_v1
 {
@@ -381,6 +391,32 @@ struct gwp_move_ahead_evt_v1
     uint16_t nrows [ 4 ]; /* the number of rows to move ahead                 */
 };
 
+/* gwp_rows_evt_v1
+ *  event used to transfer one cell for each of several consecutive rows
+ *  of a column with whole-byte elements. the cells are held until an
+ *  evt_next_rows on the column's table commits that many rows.
+ *
+ *  the payload holds, when flags has GW_ROWS_VARIABLE, the element count
+ *  of every row as utf8-like packed uint32, followed by the elements of
+ *  all rows, integer-packed if the column uses integer element packing.
+ *
+ *  packed streams of version 3 only
+ *
+ *  used for events:
+ *    { evt_cell_rows }
+ */
+#define GW_ROWS_VARIABLE 1
+
+struct gwp_rows_evt_v1
+{
+    gwp_evt_hdr_v1 dad;        /* common header : id = column id              */
+    uint8_t flags;             /* GW_ROWS_VARIABLE                            */
+    uint8_t reserved;
+    uint16_t rows;             /* the number - 1 of rows                      */
+    uint16_t elem_count [ 2 ]; /* elements in every row, unless variable      */
+    uint16_t sz [ 2 ];         /* the size of the payload in bytes            */
+};
+
 
 /* SPECIAL VERSIONS WITH 16-BIT SIZE FIELDS */
 
@@ -894,6 +930,72 @@ namespace ncbi
     }
 
 
+    // gwp_rows_evt_v1
+    inline void init ( :: gwp_rows_evt_v1 & hdr, uint32_t id, gw_evt_id evt )
+    {
+        init ( hdr . dad, id, evt );
+        hdr . flags = hdr . reserved = 0;
+        hdr . rows = 0;
+        memset ( & hdr . elem_count, 0, sizeof hdr . elem_count );
+        memset ( & hdr . sz, 0, sizeof hdr . sz );
+    }
+
+    inline void init ( :: gwp_rows_evt_v1 & hdr, const :: gwp_evt_hdr_v1 & dad )
+    {
+        hdr . dad = dad;
+        hdr . flags = hdr . reserved = 0;
+        hdr . rows = 0;
+        memset ( & hdr . elem_count, 0, sizeof hdr . elem_count );
+        memset ( & hdr . sz, 0, sizeof hdr . sz );
+    }
+
+    inline bool variable ( const :: gwp_rows_evt_v1 & self )
+    { return ( self . flags & GW_ROWS_VARIABLE ) != 0; }
+
+    inline uint32_t rows ( const :: gwp_rows_evt_v1 & self )
+    { return ( uint32_t ) self . rows + 1; }
+
+    inline void set_rows ( :: gwp_rows_evt_v1 & self, uint32_t rows )
+    {
+        assert ( rows != 0 );
+        assert ( rows <= 0x10000 );
+        self . rows = ( uint16_t ) ( rows - 1 );
+    }
+
+    inline uint32_t elem_count ( const :: gwp_rows_evt_v1 & self )
+    {
+        uint32_t elem_count;
+        memmove ( & elem_count, & self . elem_count, sizeof elem_count );
+        return elem_count;
+    }
+
+    inline void set_elem_count ( :: gwp_rows_evt_v1 & self, uint32_t elem_count )
+    {
+        self . flags &= ~ GW_ROWS_VARIABLE;
+        memmove ( & self . elem_count, & elem_count, sizeof self . elem_count );
+    }
+
+    inline void set_variable ( :: gwp_rows_evt_v1 & self )
+    {
+        self . flags |= GW_ROWS_VARIABLE;
+        memset ( & self . elem_count, 0, sizeof self . elem_count );
+    }
+
+    inline uint32_t size ( const :: gwp_rows_evt_v1 & self )
+    {
+        uint32_t sz;
+        memmove ( & sz, & self . sz, sizeof sz );
+        return sz;
+    }
+
+    inline void set_size ( :: gwp_rows_evt_v1 & self, size_t bytes )
+    {
+        assert ( sizeof bytes == 4 || ( bytes >> 32 ) == 0 );
+        uint32_t sz = ( uint32_t ) bytes;
+        memmove ( & self . sz, & sz, sizeof self . sz );
+    }
+
+
     // recording string size
     inline void set_string_size ( uint16_t & sz, size_t bytes )
     {
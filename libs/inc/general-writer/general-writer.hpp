@@ -40,9 +40,11 @@
 
 #include <string.h>
 
+struct gw_ring;
+
 namespace ncbi
 {
-#if GW_CURRENT_VERSION <= 2
+#if GW_CURRENT_VERSION <= 3
     typedef :: gwp_evt_hdr_v1 gwp_evt_hdr;
 #else
 #error "unrecognized GW version"
@@ -52,6 +54,17 @@ namespace ncbi
     {
     public:
 
+        // a shared-memory ring to be read by "general-loader --ring <path>"
+        // running on the same host, instead of a pipe
+        struct shared_ring
+        {
+            shared_ring ( const std :: string & _path, size_t _size = 64 * 1024 * 1024 )
+                : path ( _path ), size ( _size ) {}
+
+            std :: string path;
+            size_t size;
+        };
+
         // ask the general-loader to use this when naming its output
         void setRemotePath ( const std :: string & remote_db );
 
@@ -110,6 +123,26 @@ namespace ncbi
         // commit and close current row, move to next row
         void nextRow ( int table_id );
 
+        // announce that writeRows and nextRows will be used
+        // MUST be called before anything else is sent: it stamps the stream with
+        // GW_CURRENT_VERSION, which general-loaders older than version 3 reject
+        void useRowBatches ();
+
+        // generate one cell for each of row_count consecutive rows,
+        // elem_count elements per cell, as a single event per batch
+        // the column's elements must be whole bytes
+        // requires useRowBatches
+        void writeRows ( int stream_id, uint32_t elem_bits, const void *data,
+                         uint32_t elem_count, uint32_t row_count );
+
+        // same, with elem_counts [ i ] elements in the cell of row i
+        void writeRows ( int stream_id, uint32_t elem_bits, const void *data,
+                         const uint32_t *elem_counts, uint32_t row_count );
+
+        // commit row_count rows, whose cells were given by writeRows
+        // every column given to writeRows must have exactly row_count cells pending
+        void nextRows ( int table_id, uint32_t row_count );
+
         // commit and close current row, move ahead by nrows
         void moveAhead ( int table_id, uint64_t nrows );
 
@@ -131,6 +164,8 @@ namespace ncbi
         // out_path initializes output stream for writing to a file
         GeneralWriter ( int out_fd, size_t buffer_size = 32 * 1024 );
         GeneralWriter ( const std :: string & out_path );
+        // out_ring creates the ring file; cell data is copied straight into it
+        GeneralWriter ( const shared_ring & out_ring );
 
         // output stream is flushed and closed
         ~ GeneralWriter ();
@@ -140,6 +175,8 @@ namespace ncbi
         void writeHeader ();
         void internal_write ( const void *data, size_t num_bytes );
         void write_event ( const gwp_evt_hdr * evt, size_t evt_size );
+        void write_rows ( int stream_id, uint32_t elem_bits, const void *data,
+                          uint32_t elem_count, const uint32_t *elem_counts, uint32_t row_count );
         void flush ();
         uint32_t getPid ();
 
@@ -179,6 +216,7 @@ namespace ncbi
         int pid;
 
         uint8_t * packing_buffer;
+        std :: vector < uint8_t > counts_buffer;
 
         uint8_t * output_buffer;
         size_t output_bsize;
@@ -186,6 +224,12 @@ namespace ncbi
 
         int out_fd;
 
+        struct gw_ring * ring;
+
+        // the header goes out with the first event, until then the version can change
+        uint32_t version;
+        bool header_sent;
+
         enum stream_state
         {
             uninitialized,
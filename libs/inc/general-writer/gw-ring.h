@@ -0,0 +1,106 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_gw_ring_
+#define _h_gw_ring_
+
+#include <stdint.h>
+#include <stdlib.h> /* size_t on linux */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------------------------
+ * gw_ring
+ *  single-producer/single-consumer byte ring in a shared memory file,
+ *  used as a same-host replacement for the pipe between a GeneralWriter
+ *  and general-loader
+ *
+ *  the data area is mapped twice back to back, so any span of up to
+ *  "capacity" bytes is contiguous in memory and the consumer can hand
+ *  out pointers into the ring instead of copying
+ *
+ *  all functions return 0 on success or an errno value:
+ *    EPIPE     - the other side went away ( closed or died )
+ *    ETIMEDOUT - gw_ring_attach gave up waiting for the producer
+ *    EINVAL    - bad parameters or not a ring file
+ */
+typedef struct gw_ring gw_ring;
+
+/* default data area size */
+#define GW_RING_DEFAULT_SIZE ( ( size_t ) 64 * 1024 * 1024 )
+
+/* gw_ring_create
+ *  producer side: create a new ring file at "path"
+ *  "capacity" is rounded up to a multiple of the page size
+ *  the file appears under "path" only once fully initialized
+ */
+int gw_ring_create ( gw_ring ** ring, const char * path, size_t capacity );
+
+/* gw_ring_attach
+ *  consumer side: wait up to "timeout_ms" for a ring to appear at "path",
+ *  map it and remove the name from the file system
+ */
+int gw_ring_attach ( gw_ring ** ring, const char * path, uint32_t timeout_ms );
+
+/* gw_ring_release
+ *  tells the other side this end is done, unmaps the ring
+ *  the producer's unpublished bytes are published first
+ */
+void gw_ring_release ( gw_ring * ring );
+
+/* gw_ring_capacity
+ */
+size_t gw_ring_capacity ( const gw_ring * ring );
+
+/* gw_ring_write
+ *  producer side: copy "bytes" into the ring, waiting for space as needed
+ *  data becomes visible to the consumer in large batches; use gw_ring_flush
+ *  to publish everything written so far
+ */
+int gw_ring_write ( gw_ring * ring, const void * data, size_t bytes );
+int gw_ring_flush ( gw_ring * ring );
+
+/* gw_ring_acquire
+ *  consumer side: wait until "bytes" ( <= capacity ) are available and
+ *  return a pointer to them inside the ring; the bytes stay valid until
+ *  released by gw_ring_consume
+ */
+int gw_ring_acquire ( gw_ring * ring, const void ** data, size_t bytes );
+void gw_ring_consume ( gw_ring * ring, size_t bytes );
+
+/* gw_ring_read
+ *  consumer side: copy exactly "bytes" out of the ring and consume them
+ *  "bytes" may exceed the capacity
+ */
+int gw_ring_read ( gw_ring * ring, void * buffer, size_t bytes );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_gw_ring_ */
@@ -49,6 +49,15 @@ namespace ncbi
 
                 FragmentBlobIterator getFragmentBlobs() const;
 
+                /* getFragmentBlobs
+                *  returns partition "partition" ( 0-based ) of "numPartitions"
+                *  the partitions cover disjoint row ranges of nearly equal size,
+                *  blobs are cut short at the ends of the ranges
+                *  each partition reads through a cursor of its own
+                *  and may be iterated on a thread of its own
+                */
+                FragmentBlobIterator getFragmentBlobs ( uint32_t partition, uint32_t numPartitions ) const;
+
                 /* getReferences
                 *  returns an iterator of all References used
                 *  iterator will be empty if no Reads are aligned
@@ -49,6 +49,9 @@ namespace ncbi
                 ReferenceBlobIterator getBlobs() const;
                 // subset of blobs covering a slice, coordinates in bases
                 ReferenceBlobIterator getBlobs( uint64_t p_start, uint64_t p_count ) const;
+                // partition "partition" ( 0-based ) of "numPartitions" disjoint subsets of blobs of nearly equal size,
+                // each reads through a cursor of its own and may be iterated on a thread of its own
+                ReferenceBlobIterator getBlobPartition( uint32_t partition, uint32_t numPartitions ) const;
 
             public:
 
@@ -81,3 +81,22 @@ VdbReadCollection :: getFragmentBlobs() const
     THROW_ON_FAIL ( NGS_FragmentBlobIteratorRelease ( iter, ctx ) );
     return ret;
 }
+
+FragmentBlobIterator
+VdbReadCollection :: getFragmentBlobs ( uint32_t partition, uint32_t numPartitions ) const
+{
+    HYBRID_FUNC_ENTRY ( rcSRA, rcArc, rcAccessing );
+
+    // every call makes an iterator with a cursor of its own
+    THROW_ON_FAIL ( struct NGS_FragmentBlobIterator* iter = NGS_ReadCollectionGetFragmentBlobs ( reinterpret_cast<VdbReadCollectionItf*>(self) -> Self() , ctx ) );
+    ON_FAIL ( NGS_FragmentBlobIteratorSetPartition ( iter, ctx, partition, numPartitions ) )
+    {
+        :: ngs :: ErrBlock err;
+        NGS_ErrBlockThrow ( & err, ctx );
+        NGS_FragmentBlobIteratorRelease ( iter, ctx );
+        err . Throw ();
+    }
+    FragmentBlobIterator ret ( iter );
+    THROW_ON_FAIL ( NGS_FragmentBlobIteratorRelease ( iter, ctx ) );
+    return ret;
+}
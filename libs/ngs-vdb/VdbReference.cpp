@@ -92,3 +92,21 @@ VdbReference :: getBlobs (uint64_t p_start, uint64_t p_count ) const
     return ret;
 }
 
+
+ReferenceBlobIterator
+VdbReference :: getBlobPartition ( uint32_t partition, uint32_t numPartitions ) const
+{
+    HYBRID_FUNC_ENTRY ( rcSRA, rcArc, rcAccessing );
+
+    THROW_ON_FAIL ( struct NGS_ReferenceBlobIterator* iter = NGS_ReferenceGetBlobs ( reinterpret_cast<VdbReferenceItf*>(self) -> Self() , ctx, 0, (uint64_t)-1 ) );
+    ON_FAIL ( NGS_ReferenceBlobIteratorSetPartition ( iter, ctx, partition, numPartitions ) )
+    {
+        :: ngs :: ErrBlock err;
+        NGS_ErrBlockThrow ( & err, ctx );
+        NGS_ReferenceBlobIteratorRelease ( iter, ctx );
+        err . Throw ();
+    }
+    ReferenceBlobIterator ret ( iter );
+    THROW_ON_FAIL ( NGS_ReferenceBlobIteratorRelease ( iter, ctx ) );
+    return ret;
+}
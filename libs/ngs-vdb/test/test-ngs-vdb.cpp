@@ -341,6 +341,44 @@ TEST_CASE ( FragmentBlobIterator_nextBlob )
     //TODO: Verify
 }
 
+TEST_CASE ( FragmentBlobIterator_Partitions )
+{   // together, the partitions cover the same rows as the whole table, in order and without overlaps
+    VdbReadCollection coll = NGS_VDB :: openVdbReadCollection ( SRA_Accession . c_str () );
+
+    int64_t tableEnd = 1;
+    FragmentBlobIterator all = coll . getFragmentBlobs ();
+    while ( all . hasMore () )
+    {
+        int64_t first;
+        uint64_t count;
+        all . nextBlob () . GetRowRange ( & first, & count );
+        tableEnd = first + count;
+    }
+
+    const uint32_t NumPartitions = 3;
+    int64_t next = 1;
+    for ( uint32_t i = 0; i < NumPartitions; ++i )
+    {
+        FragmentBlobIterator blobIt = coll . getFragmentBlobs ( i, NumPartitions );
+        REQUIRE ( blobIt . hasMore () );
+        while ( blobIt . hasMore () )
+        {
+            int64_t first;
+            uint64_t count;
+            blobIt . nextBlob () . GetRowRange ( & first, & count );
+            REQUIRE_EQ ( next, first );
+            next = first + count;
+        }
+    }
+    REQUIRE_EQ ( tableEnd, next );
+}
+
+TEST_CASE ( FragmentBlobIterator_BadPartition )
+{
+    VdbReadCollection coll = NGS_VDB :: openVdbReadCollection ( SRA_Accession . c_str () );
+    REQUIRE_THROW ( coll . getFragmentBlobs ( 2, 2 ) );
+}
+
 /// VdbReadCollection
 
 TEST_CASE ( VdbReadCollection_CreateFromReadCollection )
@@ -727,6 +765,44 @@ FIXTURE_TEST_CASE ( VdbReference_Construct, KfcFixture )
     EXIT;
 }
 
+FIXTURE_TEST_CASE ( VdbReference_BlobPartitions, KfcFixture )
+{   // together, the partitions cover the same rows as the whole reference, in order and without overlaps
+    ReadCollection rCol = ncbi :: NGS :: openReadCollection ( CSRA1_Accession );
+    VdbReference ref ( rCol . getReference ( "supercont2.1" ) );
+
+    int64_t refFirst = 0;
+    int64_t refEnd = 0;
+    ReferenceBlobIterator all = ref . getBlobs ();
+    while ( all . hasMore () )
+    {
+        int64_t first;
+        uint64_t count;
+        all . nextBlob () . GetRowRange ( & first, & count );
+        if ( refFirst == 0 )
+        {
+            refFirst = first;
+        }
+        refEnd = first + count;
+    }
+
+    const uint32_t NumPartitions = 4;
+    int64_t next = refFirst;
+    for ( uint32_t i = 0; i < NumPartitions; ++i )
+    {
+        ReferenceBlobIterator blobIt = ref . getBlobPartition ( i, NumPartitions );
+        REQUIRE ( blobIt . hasMore () );
+        while ( blobIt . hasMore () )
+        {
+            int64_t first;
+            uint64_t count;
+            blobIt . nextBlob () . GetRowRange ( & first, & count );
+            REQUIRE_EQ ( next, first );
+            next = first + count;
+        }
+    }
+    REQUIRE_EQ ( refEnd, next );
+}
+
 /// VdbAlignment
 
 FIXTURE_TEST_CASE ( VdbAlignment_Create_toAlignment, KfcFixture )
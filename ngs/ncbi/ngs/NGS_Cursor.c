@@ -236,6 +236,23 @@ const NGS_Cursor* NGS_CursorMakeDb ( ctx_t ctx,
     }
 }
 
+/* MakeCopy
+ */
+const NGS_Cursor * NGS_CursorMakeCopy ( const NGS_Cursor * self, ctx_t ctx )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcCursor, rcConstructing );
+
+    assert ( self != NULL );
+
+    TRY ( const VTable * table = NGS_CursorGetTable ( self, ctx ) )
+    {
+        const NGS_Cursor * ret = NGS_CursorMake ( ctx, table, ( const char ** ) self -> col_specs, self -> num_cols );
+        VTableRelease ( table );
+        return ret;
+    }
+    return NULL;
+}
+
 /* Release
  *  release reference
  */
@@ -59,6 +59,12 @@ const NGS_Cursor* NGS_CursorMakeDb ( ctx_t ctx,
                                      const char * col_specs[],
                                      uint32_t num_cols );
 
+/* MakeCopy
+ *  a new cursor on the same table and columns,
+ *  independent of "self", e.g. for use on another thread
+ */
+const NGS_Cursor * NGS_CursorMakeCopy ( const NGS_Cursor * self, ctx_t ctx );
+
 /* Release
  *  release reference
  */
@@ -51,6 +51,7 @@ struct NGS_FragmentBlob
     int64_t rowId;      /* rowId of the first row in the blob (can differ from the first row of VBlob) */
     const void* data;   /* start of the first row */
     uint64_t size;      /* from the start of the first row until the end of the blob */
+    uint64_t maxRows;   /* if not 0, the blob is cut short after this many rows */
 
     const NGS_String* run;
     const VBlob* blob_READ;
@@ -77,8 +78,9 @@ static NGS_Refcount_vt NGS_FragmentBlob_vt =
     NGS_FragmentBlobWhack
 };
 
+static
 NGS_FragmentBlob *
-NGS_FragmentBlobMake ( ctx_t ctx, const NGS_String* run, const struct NGS_Cursor* curs, int64_t rowId )
+FragmentBlobMake ( ctx_t ctx, const NGS_String* run, const struct NGS_Cursor* curs, int64_t rowId, uint64_t maxRows )
 {
     FUNC_ENTRY ( ctx, rcSRA, rcBlob, rcConstructing );
     if ( run == NULL )
@@ -110,10 +112,11 @@ NGS_FragmentBlobMake ( ctx_t ctx, const NGS_String* run, const struct NGS_Cursor
                             TRY ( ret -> blob_READ_TYPE = NGS_CursorGetVBlob ( curs, ctx, rowId, seq_READ_TYPE ) )
                             {
                                 ret -> rowId = rowId;
+                                ret -> maxRows = maxRows;
                                 TRY ( VByteBlob_ContiguousChunk ( ret -> blob_READ,
                                                                   ctx,
                                                                   ret -> rowId,
-                                                                  0,
+                                                                  ret -> maxRows,
                                                                   false,
                                                                   & ret -> data,
                                                                   & ret -> size,
@@ -134,6 +137,24 @@ NGS_FragmentBlobMake ( ctx_t ctx, const NGS_String* run, const struct NGS_Cursor
     return NULL;
 }
 
+NGS_FragmentBlob *
+NGS_FragmentBlobMake ( ctx_t ctx, const NGS_String* run, const struct NGS_Cursor* curs, int64_t rowId )
+{
+    return FragmentBlobMake ( ctx, run, curs, rowId, 0 );
+}
+
+NGS_FragmentBlob *
+NGS_FragmentBlobMakeSlice ( ctx_t ctx, const NGS_String* run, const struct NGS_Cursor* curs, int64_t rowId, int64_t lastRowId )
+{
+    if ( lastRowId < rowId )
+    {
+        FUNC_ENTRY ( ctx, rcSRA, rcBlob, rcConstructing );
+        INTERNAL_ERROR ( xcParamOutOfBounds, "Invalid lastRowId: %li (less than rowId=%li)", lastRowId, rowId );
+        return NULL;
+    }
+    return FragmentBlobMake ( ctx, run, curs, rowId, lastRowId - rowId + 1 );
+}
+
 void
 NGS_FragmentBlobRelease ( struct NGS_FragmentBlob * self, ctx_t ctx )
 {
@@ -179,6 +200,10 @@ NGS_FragmentBlobRowRange ( const struct NGS_FragmentBlob * self, ctx_t ctx,  int
             if ( p_count != NULL )
             {
                 *p_count = count - ( self -> rowId - first );
+                if ( self -> maxRows != 0 && *p_count > self -> maxRows )
+                {
+                    *p_count = self -> maxRows;
+                }
             }
         }
     }
@@ -53,6 +53,12 @@ struct NGS_String;
  */
 struct NGS_FragmentBlob * NGS_FragmentBlobMake ( ctx_t ctx, const struct NGS_String * run, const struct NGS_Cursor* curs, int64_t rowId );
 
+/* MakeSlice
+ *  create a blob containing the given rowId, ending no later than lastRowId
+ *  run - accession name
+ */
+struct NGS_FragmentBlob * NGS_FragmentBlobMakeSlice ( ctx_t ctx, const struct NGS_String * run, const struct NGS_Cursor* curs, int64_t rowId, int64_t lastRowId );
+
 /* Release
  *  release reference
  */
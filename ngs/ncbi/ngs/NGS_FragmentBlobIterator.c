@@ -130,6 +130,35 @@ NGS_FragmentBlobIteratorDuplicate ( NGS_FragmentBlobIterator * self, ctx_t ctx )
     return ( NGS_FragmentBlobIterator* ) self;
 }
 
+/* SetPartition
+ */
+void
+NGS_FragmentBlobIteratorSetPartition ( NGS_FragmentBlobIterator * self, ctx_t ctx, uint32_t partition, uint32_t numPartitions )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcBlob, rcUpdating );
+
+    if ( self == NULL )
+    {
+        INTERNAL_ERROR ( xcSelfNull, "NULL FragmentBlobIterator accessed" );
+    }
+    else if ( partition >= numPartitions )
+    {
+        USER_ERROR ( xcParamOutOfBounds, "Invalid partition: %u (of %u)", partition, numPartitions );
+    }
+    else
+    {
+        int64_t first;
+        uint64_t count;
+        TRY ( NGS_CursorGetRowRange ( self -> curs, ctx, & first, & count ) )
+        {   /* count * partition / numPartitions, without overflowing */
+            uint64_t start = count / numPartitions * partition + count % numPartitions * partition / numPartitions;
+            uint64_t end = count / numPartitions * ( partition + 1 ) + count % numPartitions * ( partition + 1 ) / numPartitions;
+            self -> next_row = first + ( int64_t ) start;
+            self -> last_row = first + ( int64_t ) end - 1;
+        }
+    }
+}
+
 /* HasMore
  *  return true if there are more blobs to iterate on
  */
@@ -168,7 +197,12 @@ NGS_FragmentBlobIteratorNext ( NGS_FragmentBlobIterator * self, ctx_t ctx )
                                                & nextRow );
         if ( rc == 0 )
         {
-            TRY ( NGS_FragmentBlob* ret = NGS_FragmentBlobMake ( ctx, self -> run, self -> curs, nextRow ) )
+            if ( nextRow > self -> last_row )
+            {   /* the rest of the table belongs to another partition */
+                self -> next_row = self -> last_row + 1;
+                return NULL;
+            }
+            TRY ( NGS_FragmentBlob* ret = NGS_FragmentBlobMakeSlice ( ctx, self -> run, self -> curs, nextRow, self -> last_row ) )
             {
                 int64_t first;
                 uint64_t count;
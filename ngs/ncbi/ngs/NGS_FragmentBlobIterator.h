@@ -51,6 +51,14 @@ struct NGS_FragmentBlob;
  */
 NGS_FragmentBlobIterator* NGS_FragmentBlobIteratorMake ( ctx_t ctx, const struct NGS_String* run, const struct VTable* sequence );
 
+/* SetPartition
+ *  restrict the iteration to partition "partition" ( 0-based ) of "numPartitions"
+ *  nearly equal, disjoint row ranges of the table
+ *  blobs are cut short at the end of the partition's range
+ *  to be called before the first call to Next()
+ */
+void NGS_FragmentBlobIteratorSetPartition ( NGS_FragmentBlobIterator * self, ctx_t ctx, uint32_t partition, uint32_t numPartitions );
+
 /* Release
  *  release reference
  */
@@ -126,6 +126,39 @@ NGS_ReferenceBlobIteratorDuplicate ( NGS_ReferenceBlobIterator * self, ctx_t ctx
     return ( NGS_ReferenceBlobIterator* ) self;
 }
 
+/* SetPartition
+ */
+void
+NGS_ReferenceBlobIteratorSetPartition ( NGS_ReferenceBlobIterator * self, ctx_t ctx, uint32_t partition, uint32_t numPartitions )
+{
+    FUNC_ENTRY ( ctx, rcSRA, rcBlob, rcUpdating );
+
+    if ( self == NULL )
+    {
+        INTERNAL_ERROR ( xcSelfNull, "NULL ReferenceBlobIterator accessed" );
+    }
+    else if ( partition >= numPartitions )
+    {
+        USER_ERROR ( xcParamOutOfBounds, "Invalid partition: %u (of %u)", partition, numPartitions );
+    }
+    else
+    {   /* the cursor is shared with the reference, replace it with a private one */
+        TRY ( const NGS_Cursor* curs = NGS_CursorMakeCopy ( self -> curs, ctx ) )
+        {
+            uint64_t count = self -> next_row <= self -> last_row ? ( uint64_t ) ( self -> last_row - self -> next_row + 1 ) : 0;
+            /* count * partition / numPartitions, without overflowing */
+            uint64_t start = count / numPartitions * partition + count % numPartitions * partition / numPartitions;
+            uint64_t end = count / numPartitions * ( partition + 1 ) + count % numPartitions * ( partition + 1 ) / numPartitions;
+
+            NGS_CursorRelease ( self -> curs, ctx );
+            self -> curs = curs;
+
+            self -> last_row = self -> next_row + ( int64_t ) end - 1;
+            self -> next_row += ( int64_t ) start;
+        }
+    }
+}
+
 /* HasMore
  *  return true if there are more blobs to iterate on
  */
@@ -164,6 +197,11 @@ NGS_ReferenceBlobIteratorNext ( NGS_ReferenceBlobIterator * self, ctx_t ctx )
                                                & nextRow );
         if ( rc == 0 )
         {
+            if ( nextRow > self -> last_row )
+            {   /* the rest of the column belongs to another reference or partition */
+                self -> next_row = self -> last_row + 1;
+                return NULL;
+            }
             TRY ( NGS_ReferenceBlob* ret = NGS_ReferenceBlobMake ( ctx, self -> curs, nextRow, self -> ref_start, self -> last_row ) )
             {
                 int64_t first;
@@ -54,6 +54,14 @@ struct NGS_ReferenceBlob;
  */
 NGS_ReferenceBlobIterator* NGS_ReferenceBlobIteratorMake ( ctx_t ctx, const struct NGS_Cursor* curs, int64_t refStartId, int64_t firstRowId, int64_t lastRowId );
 
+/* SetPartition
+ *  restrict the iteration to partition "partition" ( 0-based ) of "numPartitions"
+ *  nearly equal, disjoint row ranges of the iterator's rows,
+ *  read through a cursor of its own so that partitions can be iterated on separate threads
+ *  to be called before the first call to Next()
+ */
+void NGS_ReferenceBlobIteratorSetPartition ( NGS_ReferenceBlobIterator * self, ctx_t ctx, uint32_t partition, uint32_t numPartitions );
+
 /* Release
  *  release reference
  */
@@ -491,7 +491,7 @@ bool BAMFile::ReadI32(int32_t &rslt) {
     return false;
 }
 
-void BAMFile::InflateInit(void) {
+static void InflateInit(z_stream &zs) {
     memset(&zs, 0, sizeof(zs));
     
     int const zrc = inflateInit2(&zs, MAX_WBITS + 16);
@@ -511,6 +511,10 @@ void BAMFile::InflateInit(void) {
     }
 }
 
+void BAMFile::InflateInit(void) {
+    ::InflateInit(zs);
+}
+
 void BAMFile::CheckHeaderSignature(void) {
     static char const sig[] = "BAM\1";
     char actual[4];
@@ -613,6 +617,8 @@ void BAMFile::LoadIndex(std::string const &filepath) {
 }
 
 BAMFile::BAMFile(std::string const &filepath)
+: path(filepath)
+, cache(new BGZFBlockCache())
 {
     InflateInit();
     
@@ -637,7 +643,8 @@ BAMFile::~BAMFile()
     inflateEnd(&zs);
 }
 
-BAMRecord const *BAMFile::Read()
+template <typename SOURCE>
+BAMRecord const *ReadRecord(SOURCE &src)
 {
     union aligned_BAMRecord {
         SizedRawData raw;
@@ -648,9 +655,10 @@ BAMRecord const *BAMFile::Read()
     };
     int32_t datasize;
     
-    if (!ReadI32(datasize)) // assumes cause is EOF
+    if (src.ReadN(sizeof(datasize), &datasize) != sizeof(datasize)) // assumes cause is EOF
         return 0;
     
+    datasize = LE2Host<int32_t>(&datasize);
     if (datasize < 0)
         throw std::runtime_error("file is corrupt: record size < 0");
 
@@ -658,13 +666,18 @@ BAMRecord const *BAMFile::Read()
     
     union aligned_BAMRecord *data = new aligned_BAMRecord[(size + sizeof(uint32_t) + sizeof(aligned_BAMRecord) - 1)/sizeof(aligned_BAMRecord)];
     data->raw.size = size;
-    if (Read(size, data->raw.data))
+    if (src.ReadN(size, data->raw.data) == size)
         return &data->record;
 
     delete [] data;
     throw std::runtime_error("file is truncated");
 }
 
+BAMRecord const *BAMFile::Read()
+{
+    return ReadRecord(*this);
+}
+
 bool BAMFile::isGoodRecord(BAMRecord const &rec)
 {
     if (rec.isTooSmall())
@@ -710,3 +723,186 @@ BAMRecordSource *BAMFile::Slice(const std::string &rname, unsigned start, unsign
     
     return new BAMFileSlice(*this, refID, start, last, index);
 }
+
+BGZFBlockPtr BGZFBlockCache::find(uint64_t const fpos)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unordered_map<uint64_t, EntryList::iterator>::const_iterator const i = byPosition.find(fpos);
+
+    if (i == byPosition.end())
+        return BGZFBlockPtr();
+
+    entries.splice(entries.begin(), entries, i->second);
+    return i->second->second;
+}
+
+BGZFBlockPtr BGZFBlockCache::insert(uint64_t const fpos, BGZFBlockPtr const &block)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unordered_map<uint64_t, EntryList::iterator>::const_iterator const i = byPosition.find(fpos);
+
+    if (i != byPosition.end()) {
+        entries.splice(entries.begin(), entries, i->second);
+        return i->second->second;
+    }
+    entries.push_front(Entry(fpos, block));
+    byPosition[fpos] = entries.begin();
+
+    while (entries.size() > capacity) {
+        byPosition.erase(entries.back().first);
+        entries.pop_back();
+    }
+    return block;
+}
+
+BGZFReader::BGZFReader(std::string const &filepath, std::shared_ptr<BGZFBlockCache> const &Cache)
+: file_pos(0)
+, cache(Cache)
+, bam_cur(0)
+{
+#if USE_STDIO
+    file = fopen(filepath.c_str(), "rb");
+    if (file == NULL)
+        throw std::runtime_error(std::string("The file '")+filepath+"' could not be opened");
+#else
+    file.open(filepath.c_str(), std::ifstream::in | std::ifstream::binary);
+    if (!file.is_open())
+        throw std::runtime_error(std::string("The file '")+filepath+"' could not be opened");
+#endif
+    try {
+        InflateInit(zs);
+    }
+    catch (...) {
+#if USE_STDIO
+        fclose(file);
+#endif
+        throw;
+    }
+}
+
+BGZFReader::~BGZFReader()
+{
+    inflateEnd(&zs);
+#if USE_STDIO
+    fclose(file);
+#endif
+}
+
+/* reads and inflates the BGZF block at fpos; returns NULL at EOF */
+BGZFBlockPtr BGZFReader::Inflate(uint64_t const fpos)
+{
+    static unsigned const hdr_size = 18; /* gzip header with the BC extra field */
+    static unsigned const ftr_size = 8;  /* CRC32 and ISIZE */
+    
+    if (fpos != file_pos) {
+#if USE_STDIO
+        if (fseek(file, fpos, SEEK_SET))
+            throw std::runtime_error("position is invalid");
+#else
+        file.clear();
+        file.seekg(fpos);
+#endif
+        file_pos = fpos;
+    }
+#if USE_STDIO
+    size_t const nhdr = fread(iobuffer, 1, hdr_size, file);
+#else
+    size_t const nhdr = file.read((char *)iobuffer, hdr_size).gcount();
+#endif
+    file_pos += nhdr;
+    if (nhdr == 0) /* EOF */
+        return BGZFBlockPtr();
+    
+    if (nhdr < hdr_size
+        || iobuffer[0] != 31 || iobuffer[1] != 139 || iobuffer[2] != 8 || (iobuffer[3] & 4) == 0
+        || LE2Host<uint16_t>(iobuffer + 10) != 6
+        || iobuffer[12] != 'B' || iobuffer[13] != 'C' || LE2Host<uint16_t>(iobuffer + 14) != 2)
+    {
+        throw std::runtime_error("file is corrupt: not a BGZF block");
+    }
+    unsigned const bsize = (unsigned)LE2Host<uint16_t>(iobuffer + 16) + 1;
+    if (bsize < hdr_size + ftr_size)
+        throw std::runtime_error("file is corrupt: BGZF block is too small");
+    
+#if USE_STDIO
+    size_t const nread = fread(iobuffer + hdr_size, 1, bsize - hdr_size, file);
+#else
+    size_t const nread = file.read((char *)(iobuffer + hdr_size), bsize - hdr_size).gcount();
+#endif
+    file_pos += nread;
+    if (nread != bsize - hdr_size)
+        throw std::runtime_error("file is truncated");
+    
+    uint32_t const isize = LE2Host<uint32_t>(iobuffer + bsize - 4);
+    if (isize > BAM_BLK_MAX)
+        throw std::runtime_error("file is corrupt: BGZF block is too large");
+    
+    BGZFBlock *const rslt = new BGZFBlock();
+    BGZFBlockPtr const holder(rslt);
+    Bytef empty;
+
+    rslt->next = fpos + bsize;
+    rslt->data.resize(isize);
+    
+    if (inflateReset(&zs) != Z_OK)
+        throw std::logic_error("inflateReset didn't return Z_OK");
+    zs.next_in   = iobuffer;
+    zs.avail_in  = bsize;
+    zs.next_out  = isize > 0 ? &rslt->data[0] : &empty;
+    zs.avail_out = isize;
+    
+    int const zrc = inflate(&zs, Z_FINISH);
+    if (zrc != Z_STREAM_END || zs.total_out != isize)
+        throw std::runtime_error("decompression failed");
+    
+    return holder;
+}
+
+BGZFBlockPtr BGZFReader::Load(uint64_t const fpos)
+{
+    BGZFBlockPtr rslt = cache->find(fpos);
+    
+    if (!rslt) {
+        rslt = Inflate(fpos);
+        if (rslt)
+            rslt = cache->insert(fpos, rslt);
+    }
+    return rslt;
+}
+
+void BGZFReader::Seek(uint64_t const fpos, unsigned const new_bam_cur)
+{
+    block = Load(fpos);
+    if (!block || block->data.size() <= new_bam_cur)
+        throw std::runtime_error("position is invalid");
+    bam_cur = new_bam_cur;
+}
+
+size_t BGZFReader::ReadN(size_t N, void *Dst)
+{
+    uint8_t *const dst = reinterpret_cast<uint8_t *>(Dst);
+    size_t n = 0;
+    
+    while (n < N && block) {
+        size_t const avail_out = N - n;
+        size_t const avail_in = block->data.size() - bam_cur;
+        
+        if (avail_in) {
+            size_t const copy = avail_out < avail_in ? avail_out : avail_in;
+            
+            memmove(dst + n, &block->data[bam_cur], copy);
+            bam_cur += copy;
+            n += copy;
+        }
+        else {
+            block = Load(block->next);
+            bam_cur = 0;
+        }
+    }
+    return n;
+}
+
+BAMRecord const *BGZFReader::Read()
+{
+    return ReadRecord(*this);
+}
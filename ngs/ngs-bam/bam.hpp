@@ -29,8 +29,13 @@
 #include <string.h>
 
 #include <stdexcept>
+#include <string>
 #include <vector>
 #include <map>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
 #include <algorithm>
 #include <iterator>
 
@@ -44,6 +49,7 @@
 
 #define BAM_BLK_MAX (64u * 1024u)
 #define IO_BLK_SIZE (1024u * 1024u)
+#define BGZF_CACHE_BLOCKS (256u)    /* at most 16MB of inflated blocks */
 
 template<typename T>
 static T LE2Host(void const *const src)
@@ -428,12 +434,75 @@ public:
     }
 };
 
+/* an inflated BGZF block */
+struct BGZFBlock {
+    uint64_t next;                  /* file position of the following block */
+    std::vector<Bytef> data;
+};
+typedef std::shared_ptr<BGZFBlock const> BGZFBlockPtr;
+
+/* LRU cache of inflated BGZF blocks keyed by file position;
+ * it is shared by all of the readers of a file and is thread-safe
+ */
+class BGZFBlockCache {
+    typedef std::pair<uint64_t, BGZFBlockPtr> Entry;
+    typedef std::list<Entry> EntryList;
+
+    std::mutex mutex;
+    EntryList entries;              /* most recently used is first */
+    std::unordered_map<uint64_t, EntryList::iterator> byPosition;
+    size_t const capacity;
+public:
+    BGZFBlockCache(size_t const Capacity = BGZF_CACHE_BLOCKS)
+    : capacity(Capacity)
+    {}
+    BGZFBlockPtr find(uint64_t const fpos);
+    /* returns the cached block, which is not `block` if another reader got there first */
+    BGZFBlockPtr insert(uint64_t const fpos, BGZFBlockPtr const &block);
+};
+
+/* reads BGZF blocks with its own file and decompression state,
+ * so that readers of the same file don't interfere with one another
+ */
+class BGZFReader {
+#if USE_STDIO
+    FILE *file;
+#else
+    std::ifstream file;
+#endif
+    uint64_t file_pos;              /* file position of the next read */
+    std::shared_ptr<BGZFBlockCache> const cache;
+    z_stream zs;
+
+    BGZFBlockPtr block;             /* current block */
+    unsigned bam_cur;               /* current offset in block */
+
+    Bytef iobuffer[BAM_BLK_MAX];
+
+    BGZFBlockPtr Inflate(uint64_t const fpos);
+    BGZFBlockPtr Load(uint64_t const fpos);
+
+    BGZFReader(BGZFReader const &);
+    BGZFReader &operator =(BGZFReader const &);
+public:
+    BGZFReader(std::string const &filepath, std::shared_ptr<BGZFBlockCache> const &Cache);
+    ~BGZFReader();
+    void Seek(uint64_t const fpos, unsigned const new_bam_cur);
+    size_t ReadN(size_t N, void *Dst);
+    BAMRecord const *Read();
+};
+
 class BAMFile : public BAMRecordSource {
+    friend class BAMFileSlice;
+    template <typename SOURCE> friend BAMRecord const *ReadRecord(SOURCE &src);
+
 #if USE_STDIO
     FILE *file;
 #else
     std::ifstream file;
 #endif
+    std::string const path;
+    std::shared_ptr<BGZFBlockCache> const cache;
     std::vector<HeaderRefInfo> references;
     std::map<std::string, unsigned> referencesByName;
     std::string headerText;
@@ -490,6 +559,13 @@ public:
 
     BAMRecordSource *Slice(std::string const &rname, unsigned start, unsigned last);
 
+    /* a reader that is independent of this object and of other readers;
+     * it shares the cache of inflated blocks with them
+     */
+    BGZFReader *OpenReader() const {
+        return new BGZFReader(path, cache);
+    }
+
     void DumpSAM(std::ostream &oss, BAMRecord const &rec) const;
 };
 
@@ -497,6 +573,7 @@ class BAMFileSlice : public BAMRecordSource {
     friend class BAMFile;
 
     BAMFile *const parent;
+    BGZFReader reader;
     BAMFilePosTypeList const index;
     unsigned const refID;
     unsigned const start;
@@ -509,14 +586,15 @@ class BAMFileSlice : public BAMRecordSource {
         size_t const fpos = pos.fpos();
         uint16_t const bpos = pos.bpos();
 
-        parent->Seek(fpos, bpos);
+        reader.Seek(fpos, bpos);
     }
     BAMFileSlice(BAMFile &p, unsigned const r, unsigned const s, unsigned const e, BAMFilePosTypeList const &i)
     : parent(&p)
+    , reader(p.path, p.cache)
+    , index(i)
     , refID(r)
     , start(s)
     , end(e)
-    , index(i)
     {
         cur = index.begin();
         Seek();
@@ -527,7 +605,7 @@ public:
     }
     virtual BAMRecord const *Read() {
         for ( ; ; ) {
-            BAMRecord const *const current = parent->Read();
+            BAMRecord const *const current = reader.Read();
 
             if (!current)
                 return 0;
@@ -82,6 +82,9 @@ public:
     BAMRecord const *ReadBAMRecord() {
         return file.Read();
     }
+    BGZFReader *OpenReader() const {
+        return file.OpenReader();
+    }
     HeaderRefInfo const &getRefInfo(unsigned const i) const {
         return file.getRefInfo(i);
     }
@@ -203,6 +206,9 @@ protected:
 
     ngs_adapt::StringItf *getCigar(bool const clipped, char const OPCODE[]) const;
 
+    virtual BAMRecord const *ReadBAMRecord() {
+        return parent->ReadBAMRecord();
+    }
     bool shouldSkip() const {
         int const flag = current->flag();
 
@@ -255,20 +261,38 @@ class ReadCollection::AlignmentSlice : public ReadCollection::Alignment
     unsigned end;
     BAMFilePosTypeList const slice;
     BAMFilePosTypeList::const_iterator cur;
+    BGZFReader *reader;             /* slices don't share file or inflate state */
+
+    BAMRecord const *ReadBAMRecord() {
+        return reader->Read();
+    }
 public:
     AlignmentSlice(ReadCollection const *Parent,
                    bool const WantPrimary,
                    bool const WantSecondary,
                    BAMFilePosTypeList const &Slice,
+                   unsigned const RefID,
                    unsigned const Beg,
                    unsigned const End)
     : Alignment(Parent, WantPrimary, WantSecondary)
-    , slice(Slice)
+    , refID(RefID)
     , beg(Beg)
     , end(End)
-    , cur(Slice.begin())
+    , slice(Slice)
+    , reader(Parent->OpenReader())
     {
-        parent->Seek(*cur++);
+        cur = slice.begin();
+        BAMFilePosType const pos = *cur++;
+        try {
+            reader->Seek(pos.fpos(), pos.bpos());
+        }
+        catch (...) {
+            delete reader;
+            throw;
+        }
+    }
+    ~AlignmentSlice() {
+        delete reader;
     }
 
     bool nextAlignment() {
@@ -372,7 +396,7 @@ public:
             return new ReadCollection::AlignmentNone();
 
         return new ReadCollection::AlignmentSlice(parent, want_primary, want_secondary,
-                                                  slice, start, end);
+                                                  slice, cur, start, end);
     }
     ngs_adapt::AlignmentItf * getFilteredAlignmentSlice ( int64_t start, uint64_t length, uint32_t flags, int32_t map_qual ) const {
         throw std::runtime_error("not available");
@@ -649,7 +673,7 @@ bool ReadCollection::Alignment::nextAlignment()
             delete current;
             current = 0;
         }
-        current = parent->ReadBAMRecord();
+        current = ReadBAMRecord();
         if (!current)
             return false;
     } while (shouldSkip());
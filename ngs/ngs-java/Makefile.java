@@ -161,10 +161,12 @@ NGS_SRC =                  \
 	FragmentIterator       \
 	Read                   \
 	ReadIterator           \
+	ReadBatchIterator      \
 	ReadGroup              \
 	ReadGroupIterator      \
 	Alignment              \
 	AlignmentIterator      \
+	AlignmentBatchIterator \
 	PileupEvent            \
 	PileupEventIterator    \
 	Pileup                 \
@@ -0,0 +1,68 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+package ngs;
+
+import java.nio.ByteBuffer;
+
+
+/**
+ * A AlignmentIterator that can copy the clipped fragment bases and qualities of many Alignments
+ * with a single native call.
+ * The AlignmentIterators of the NGS library implement it:
+ * <pre>
+ *   if ( it instanceof AlignmentBatchIterator )
+ *       n = ( ( AlignmentBatchIterator ) it ) . nextBatch ( count, data, offsets );
+ * </pre>
+ * It is separate from AlignmentIterator, so implementations of AlignmentIterator
+ * outside of the library are not affected.
+ */
+public interface AlignmentBatchIterator
+    extends AlignmentIterator
+{
+
+    /**
+     * Advance over up to count Alignments with a single native call
+     * copying their clipped fragment bases and qualities into a direct ByteBuffer.
+     * The bases of Alignment i are at [ offsets[2*i], offsets[2*i+1] ),
+     * its qualities ( phred values using ASCII offset of 33 )
+     * at [ offsets[2*i+1], offsets[2*i+2] ).
+     * The first Alignment starts at data.position(); the position is advanced
+     * past the last Alignment copied.
+     * An Alignment that does not fit is kept and starts the next batch;
+     * nextAlignment() also returns it without advancing.
+     * @param count is the maximum number of Alignments, it is reduced to ( offsets.length - 1 ) / 2
+     * @param data is a direct ByteBuffer receiving the values
+     * @param offsets receives the positions of the values of each Alignment
+     * @return the number of Alignments copied, 0 if no more Alignments are available
+     * @throws ErrorMsg if more Alignments should be available, but could not be accessed.
+     * @throws java.nio.BufferOverflowException if the next Alignment does not fit into data
+     * @throws IllegalArgumentException if data is not a direct ByteBuffer
+     */
+    int nextBatch ( int count, ByteBuffer data, int [] offsets )
+        throws ErrorMsg;
+}
@@ -0,0 +1,68 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+package ngs;
+
+import java.nio.ByteBuffer;
+
+
+/**
+ * A ReadIterator that can copy the bases and qualities of many Reads
+ * with a single native call.
+ * The ReadIterators of the NGS library implement it:
+ * <pre>
+ *   if ( it instanceof ReadBatchIterator )
+ *       n = ( ( ReadBatchIterator ) it ) . nextBatch ( count, data, offsets );
+ * </pre>
+ * It is separate from ReadIterator, so implementations of ReadIterator
+ * outside of the library are not affected.
+ */
+public interface ReadBatchIterator
+    extends ReadIterator
+{
+
+    /**
+     * Advance over up to count Reads with a single native call
+     * copying their bases and qualities into a direct ByteBuffer.
+     * The bases of Read i are at [ offsets[2*i], offsets[2*i+1] ),
+     * its qualities ( phred values using ASCII offset of 33 )
+     * at [ offsets[2*i+1], offsets[2*i+2] ).
+     * The first Read starts at data.position(); the position is advanced
+     * past the last Read copied.
+     * A Read that does not fit is kept and starts the next batch;
+     * nextRead() also returns it without advancing.
+     * @param count is the maximum number of Reads, it is reduced to ( offsets.length - 1 ) / 2
+     * @param data is a direct ByteBuffer receiving the values
+     * @param offsets receives the positions of the values of each Read
+     * @return the number of Reads copied, 0 if no more Reads are available
+     * @throws ErrorMsg if more Reads should be available, but could not be accessed.
+     * @throws java.nio.BufferOverflowException if the next Read does not fit into data
+     * @throws IllegalArgumentException if data is not a direct ByteBuffer
+     */
+    int nextBatch ( int count, ByteBuffer data, int [] offsets )
+        throws ErrorMsg;
+}
@@ -26,10 +26,14 @@
 
 package ngs.itf;
 
+import java.nio.BufferOverflowException;
+import java.nio.ByteBuffer;
+
 import ngs.ErrorMsg;
 import ngs.Fragment;
 import ngs.Alignment;
 import ngs.AlignmentIterator;
+import ngs.AlignmentBatchIterator;
 
 
 /*==========================================================================
@@ -39,7 +43,7 @@ import ngs.AlignmentIterator;
  */
 class AlignmentIteratorItf
     extends AlignmentItf
-    implements AlignmentIterator
+    implements AlignmentBatchIterator
 {
 
     /*******************************
@@ -57,15 +61,50 @@ class AlignmentIteratorItf
     public boolean nextAlignment ()
         throws ErrorMsg
     {
+        if ( batchPending )
+        {
+            // the current Alignment was left over by nextBatch
+            batchPending = false;
+            return true;
+        }
         return this . NextAlignment ( self );
     }
 
+    /* nextBatch
+     *  advance over up to "count" Alignments copying their
+     *  bases and qualities into "data" with a single native call
+     */
+    public int nextBatch ( int count, ByteBuffer data, int [] offsets )
+        throws ErrorMsg
+    {
+        if ( ! data . isDirect () )
+            throw new IllegalArgumentException ( "data is not a direct ByteBuffer" );
+
+        int max_count = ( offsets . length - 1 ) / 2;
+        if ( count > max_count )
+            count = max_count;
+        if ( count <= 0 )
+            return 0;
+
+        long rslt = this . NextBatch ( self, count, batchPending, data, data . position (), data . limit (), offsets );
+        int copied = ( int ) ( rslt >> 1 );
+        batchPending = ( rslt & 1 ) != 0;
+        if ( copied == 0 && batchPending )
+            throw new BufferOverflowException ();
+
+        data . position ( offsets [ 2 * copied ] );
+        return copied;
+    }
+
 
     /***************************************
      * AlignmentIteratorItf Implementation *
      ***************************************/
 
 
+    // set when the current Alignment did not fit into a batch
+    private boolean batchPending;
+
     // constructors
     AlignmentIteratorItf ( long ref )
     {
@@ -90,4 +129,7 @@ class AlignmentIteratorItf
     // native interface
     private native boolean NextAlignment ( long self )
         throws ErrorMsg;
+
+    private native long NextBatch ( long self, int count, boolean resume, ByteBuffer data, int position, int limit, int [] offsets )
+        throws ErrorMsg;
 }
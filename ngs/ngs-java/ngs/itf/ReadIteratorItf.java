@@ -26,9 +26,13 @@
 
 package ngs.itf;
 
+import java.nio.BufferOverflowException;
+import java.nio.ByteBuffer;
+
 import ngs.ErrorMsg;
 import ngs.Read;
 import ngs.ReadIterator;
+import ngs.ReadBatchIterator;
 
 
 /*==========================================================================
@@ -38,7 +42,7 @@ import ngs.ReadIterator;
  */
 class ReadIteratorItf
     extends ReadItf
-    implements ReadIterator
+    implements ReadBatchIterator
 {
 
     /**************************
@@ -55,15 +59,50 @@ class ReadIteratorItf
     public boolean nextRead ()
         throws ErrorMsg
     {
+        if ( batchPending )
+        {
+            // the current Read was left over by nextBatch
+            batchPending = false;
+            return true;
+        }
         return this . NextRead ( self );
     }
 
+    /* nextBatch
+     *  advance over up to "count" Reads copying their
+     *  bases and qualities into "data" with a single native call
+     */
+    public int nextBatch ( int count, ByteBuffer data, int [] offsets )
+        throws ErrorMsg
+    {
+        if ( ! data . isDirect () )
+            throw new IllegalArgumentException ( "data is not a direct ByteBuffer" );
+
+        int max_count = ( offsets . length - 1 ) / 2;
+        if ( count > max_count )
+            count = max_count;
+        if ( count <= 0 )
+            return 0;
+
+        long rslt = this . NextBatch ( self, count, batchPending, data, data . position (), data . limit (), offsets );
+        int copied = ( int ) ( rslt >> 1 );
+        batchPending = ( rslt & 1 ) != 0;
+        if ( copied == 0 && batchPending )
+            throw new BufferOverflowException ();
+
+        data . position ( offsets [ 2 * copied ] );
+        return copied;
+    }
+
 
     /**********************************
      * ReadIteratorItf Implementation *
      **********************************/
 
 
+    // set when the current Read did not fit into a batch
+    private boolean batchPending;
+
     // constructors
     ReadIteratorItf ( long ref )
     {
@@ -88,4 +127,7 @@ class ReadIteratorItf
     // native interface
     private native boolean NextRead ( long self )
         throws ErrorMsg;
+
+    private native long NextBatch ( long self, int count, boolean resume, ByteBuffer data, int position, int limit, int [] offsets )
+        throws ErrorMsg;
 }
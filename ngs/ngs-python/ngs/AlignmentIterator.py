@@ -29,14 +29,33 @@ from ctypes import c_int
 from . import NGS
 from .String import getNGSValue
 from .Alignment import Alignment
+from .Batch import AlignmentBatch
 
 class AlignmentIterator(Alignment):
+    _batch_pending = False
+
     def nextAlignment(self):
         """Advance to first alignment on initial invocation
         Advance to next Alignment subsequently
         :returns: false if no more Alignments are available.
         :throws: ErrorMsg if more Alignments should be available, but could not be accessed.
         """
+        if self._batch_pending:
+            # the current Alignment was left over by nextBatch
+            self._batch_pending = False
+            return True
         return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_AlignmentIteratorNext, c_int))
 
+    def nextBatch(self, count, fields=AlignmentBatch.defaultFields, batch=None):
+        """Advance over up to count Alignments with a single native call
+        copying the requested fields of each one into an AlignmentBatch
+        :param: fields are names from AlignmentBatch.stringFields and AlignmentBatch.valueFields
+        :param: batch is an AlignmentBatch returned by a previous call, its buffers are reused
+        :returns: AlignmentBatch, it is empty if no more Alignments are available
+        :throws: ErrorMsg if more Alignments should be available, but could not be accessed.
+        """
+        if batch is None or batch.capacity < count or batch.wanted != frozenset(fields):
+            batch = AlignmentBatch(count, fields)
+        return batch.fill(self, NGS.lib_manager.PY_NGS_AlignmentIteratorNextBatch, count)
+
 
@@ -0,0 +1,185 @@
+# ===========================================================================
+# 
+#                            PUBLIC DOMAIN NOTICE
+#               National Center for Biotechnology Information
+# 
+#  This software/database is a "United States Government Work" under the
+#  terms of the United States Copyright Act.  It was written as part of
+#  the author's official duties as a United States Government employee and
+#  thus cannot be copyrighted.  This software/database is freely available
+#  to the public for use. The National Library of Medicine and the U.S.
+#  Government have not placed any restriction on its use or reproduction.
+# 
+#  Although all reasonable efforts have been taken to ensure the accuracy
+#  and reliability of the software and data, the NLM and the U.S.
+#  Government do not and cannot warrant the performance or results that
+#  may be obtained by using this software or data. The NLM and the U.S.
+#  Government disclaim all warranties, express or implied, including
+#  warranties of performance, merchantability or fitness for any particular
+#  purpose.
+# 
+#  Please cite the author in any work or product based on this material.
+# 
+# ===========================================================================
+# 
+# 
+
+from ctypes import Structure, POINTER, addressof, byref, cast, create_string_buffer, string_at, \
+    c_char, c_int, c_int32, c_int64, c_uint32, c_uint64
+
+from .String import NGS_RawString
+
+
+class BatchField(Structure):
+    """Buffer receiving one string field for every item of a batch (PY_NGS_BatchField)"""
+    _fields_ = [("data",     POINTER(c_char)),
+                ("capacity", c_uint64),
+                ("used",     c_uint64),
+                ("offsets",  POINTER(c_uint64)),
+                ("lengths",  POINTER(c_uint32))]
+
+
+class AlignmentBatchValues(Structure):
+    """Arrays receiving the numeric fields of an alignment batch (PY_NGS_AlignmentBatchValues)"""
+    _fields_ = [("positions",        POINTER(c_int64)),
+                ("lengths",          POINTER(c_uint64)),
+                ("mappingQualities", POINTER(c_int32)),
+                ("isReversed",       POINTER(c_int32)),
+                ("categories",       POINTER(c_uint32))]
+
+
+class Batch:
+    """Values of up to `capacity` items fetched from an iterator with one native call
+    
+    String fields are stored back to back in one buffer per field,
+    numeric fields in one array per field.
+    Buffers are kept between calls, so reusing a batch avoids reallocating them.
+    """
+
+    # names of the string fields in the order of the native field indices
+    stringFields = ()
+    # names of the numeric fields mapped to their c_type
+    valueFields = {}
+    # initial bytes per item allocated for each string field
+    bytesPerItem = 256
+
+    def __init__(self, capacity, fields):
+        unknown = set(fields) - set(self.stringFields) - set(self.valueFields)
+        if unknown:
+            raise ValueError("unknown batch field(s): {}".format(", ".join(sorted(unknown))))
+        if capacity <= 0:
+            raise ValueError("batch capacity must be > 0")
+        self.capacity = capacity
+        self.wanted = frozenset(fields)
+        self.count = 0
+        self.fields = (BatchField * len(self.stringFields))()
+        self._buffers = {}
+        self._values = {}
+        for i, name in enumerate(self.stringFields):
+            if name in self.wanted:
+                self._allocate(i, capacity * self.bytesPerItem)
+        for name, value_type in self.valueFields.items():
+            if name in self.wanted:
+                self._values[name] = (value_type * capacity)()
+
+    def _allocate(self, i, size):
+        data = create_string_buffer(size)
+        offsets, lengths = self._buffers[i][1:] if i in self._buffers else \
+            ((c_uint64 * self.capacity)(), (c_uint32 * self.capacity)())
+        self._buffers[i] = (data, offsets, lengths)
+        field = self.fields[i]
+        field.data = cast(data, POINTER(c_char))
+        field.capacity = size
+        field.used = 0
+        field.offsets = offsets
+        field.lengths = lengths
+
+    def _grow(self):
+        for i in self._buffers:
+            self._allocate(i, 2 * self.fields[i].capacity)
+
+    def _fill(self, iterator, py_func, count, values):
+        """Calls the native batch function until at least one item fits"""
+        ret_count = c_uint32()
+        ret_pending = c_int()
+        count = min(count, self.capacity)
+        while True:
+            ngs_str_err = NGS_RawString()
+            try:
+                res = py_func(iterator.ref, count, int(iterator._batch_pending), self.fields, values,
+                              byref(ret_count), byref(ret_pending), byref(ngs_str_err.ref))
+            finally:
+                ngs_str_err.close()
+            iterator._batch_pending = bool(ret_pending.value)
+            if ret_count.value == 0 and iterator._batch_pending and count > 0:
+                self._grow() # the next item is larger than the buffers
+                continue
+            self.count = ret_count.value
+            return self
+
+    def __len__(self):
+        return self.count
+
+    def get(self, name, i):
+        """
+        :param: name is the field name
+        :param: i is zero-based and less than len(self)
+        :returns: the value of the field for the i-th item
+        """
+        if not 0 <= i < self.count:
+            raise IndexError("batch index out of range")
+        if name in self._values:
+            return self._values[name][i]
+        data, offsets, lengths = self._buffers[self.stringFields.index(name)]
+        return string_at(addressof(data) + offsets[i], lengths[i]).decode()
+
+    def values(self, name):
+        """
+        :param: name is the field name
+        :returns: list of the values of the field for all of the items
+        """
+        if name in self._values:
+            return self._values[name][:self.count]
+        raw, offsets, lengths = self.raw(name)
+        return [raw[offsets[i]:offsets[i] + lengths[i]].decode() for i in range(self.count)]
+
+    def raw(self, name):
+        """
+        :param: name is the name of a string field
+        :returns: (bytes, offsets, lengths) - the values back to back and where each one is
+        """
+        i = self.stringFields.index(name)
+        data, offsets, lengths = self._buffers[i]
+        return (string_at(data, self.fields[i].used), offsets[:self.count], lengths[:self.count])
+
+
+class ReadBatch(Batch):
+    stringFields = ("readId", "readName", "readGroup", "bases", "qualities")
+    valueFields = {"category": c_uint32}
+    defaultFields = ("readId", "bases", "qualities")
+
+    def fill(self, iterator, py_func, count):
+        categories = self._values.get("category")
+        return self._fill(iterator, py_func, count, categories)
+
+
+class AlignmentBatch(Batch):
+    stringFields = ("alignmentId", "referenceSpec", "readId", "readGroup",
+                    "clippedFragmentBases", "clippedFragmentQualities", "shortCigar")
+    valueFields = {"position": c_int64, "length": c_uint64, "mappingQuality": c_int32,
+                   "isReversed": c_int32, "category": c_uint32}
+    defaultFields = ("referenceSpec", "position", "shortCigar", "clippedFragmentBases")
+
+    def fill(self, iterator, py_func, count):
+        values = AlignmentBatchValues()
+        if "position" in self._values:
+            values.positions = self._values["position"]
+        if "length" in self._values:
+            values.lengths = self._values["length"]
+        if "mappingQuality" in self._values:
+            values.mappingQualities = self._values["mappingQuality"]
+        if "isReversed" in self._values:
+            values.isReversed = self._values["isReversed"]
+        if "category" in self._values:
+            values.categories = self._values["category"]
+        return self._fill(iterator, py_func, count, byref(values))
@@ -235,6 +235,8 @@ class LibManager:
 
         self.c_lib_sdk = load_library(libname_sdk, do_update_sdk, silent=False)
 
+        from .Batch import BatchField, AlignmentBatchValues # imports NGS, so not at the top
+
         ##############  ngs-engine imports below  ####################
         self._bind(self.c_lib_sdk, "PY_NGS_Engine_ReadCollectionMake",    [c_char_p, POINTER(c_void_p), POINTER(c_char), c_size_t], None)
         self._bind(self.c_lib_sdk, "PY_NGS_Engine_ReferenceSequenceMake", [c_char_p, POINTER(c_void_p), POINTER(c_char), c_size_t], None)
@@ -301,6 +303,7 @@ class LibManager:
         self.bind_sdk("PY_NGS_AlignmentGetMateIsReversedOrientation", [c_void_p, POINTER(c_int), POINTER(c_void_p)])
 
         self.bind_sdk("PY_NGS_AlignmentIteratorNext",                 [c_void_p, POINTER(c_int), POINTER(c_void_p)])
+        self.bind_sdk("PY_NGS_AlignmentIteratorNextBatch",            [c_void_p, c_uint32, c_int, POINTER(BatchField), POINTER(AlignmentBatchValues), POINTER(c_uint32), POINTER(c_int), POINTER(c_void_p)])
 
         # Fragment
 
@@ -362,6 +365,7 @@ class LibManager:
         self.bind_sdk("PY_NGS_ReadGetReadQualities", [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)])
 
         self.bind_sdk("PY_NGS_ReadIteratorNext",     [c_void_p, POINTER(c_int), POINTER(c_void_p)])
+        self.bind_sdk("PY_NGS_ReadIteratorNextBatch",[c_void_p, c_uint32, c_int, POINTER(BatchField), POINTER(c_uint32), POINTER(c_uint32), POINTER(c_int), POINTER(c_void_p)])
 
         # Reference
 
@@ -29,15 +29,34 @@ from ctypes import c_int
 from . import NGS
 from .String import getNGSValue
 from .Read import Read
+from .Batch import ReadBatch
 
 # ReadIterator
 # iterates across a list of Reads
 
 class ReadIterator(Read):
+    _batch_pending = False
+
     def nextRead(self):
         """Advance to first Read on initial invocation
         advance to next Read subsequently
         :returns: false if no more Reads are available.
         :throws: ErrorMsg if more Reads should be available, but could not be accessed.
         """
-        return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_ReadIteratorNext, c_int))
\ No newline at end of file
+        if self._batch_pending:
+            # the current Read was left over by nextBatch
+            self._batch_pending = False
+            return True
+        return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_ReadIteratorNext, c_int))
+
+    def nextBatch(self, count, fields=ReadBatch.defaultFields, batch=None):
+        """Advance over up to count Reads with a single native call
+        copying the requested fields of each one into a ReadBatch
+        :param: fields are names from ReadBatch.stringFields and ReadBatch.valueFields
+        :param: batch is a ReadBatch returned by a previous call, its buffers are reused
+        :returns: ReadBatch, it is empty if no more Reads are available
+        :throws: ErrorMsg if more Reads should be available, but could not be accessed.
+        """
+        if batch is None or batch.capacity < count or batch.wanted != frozenset(fields):
+            batch = ReadBatch(count, fields)
+        return batch.fill(self, NGS.lib_manager.PY_NGS_ReadIteratorNextBatch, count)
\ No newline at end of file
@@ -15,6 +15,14 @@ extern "C" {
 JNIEXPORT jboolean JNICALL Java_ngs_itf_AlignmentIteratorItf_NextAlignment
   (JNIEnv *, jobject, jlong);
 
+/*
+ * Class:     ngs_itf_AlignmentIteratorItf
+ * Method:    NextBatch
+ * Signature: (JIZLjava/nio/ByteBuffer;II[I)J
+ */
+JNIEXPORT jlong JNICALL Java_ngs_itf_AlignmentIteratorItf_NextBatch
+  (JNIEnv *, jobject, jlong, jint, jboolean, jobject, jint, jint, jintArray);
+
 #ifdef __cplusplus
 }
 #endif
@@ -68,3 +68,54 @@ JNIEXPORT jboolean JNICALL Java_ngs_itf_ReadIteratorItf_NextRead
 
     return false;
 }
+
+/*
+ * Class:     ngs_itf_ReadIteratorItf
+ * Method:    NextBatch
+ * Signature: (JIZLjava/nio/ByteBuffer;II[I)J
+ *
+ *  copies the bases and qualities of up to count reads into data
+ *  returns the number copied shifted left by one, with the low bit set
+ *  if the current Read did not fit and is still to be returned
+ */
+JNIEXPORT jlong JNICALL Java_ngs_itf_ReadIteratorItf_NextBatch
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jint count, jboolean resume,
+      jobject jdata, jint position, jint limit, jintArray joffsets )
+{
+    try
+    {
+        ReadItf * self = Self ( jself );
+        BatchBuffer batch ( jenv, jdata, position, limit, count );
+
+        bool pending = resume != JNI_FALSE;
+        while ( batch . Count () < count )
+        {
+            if ( ! pending && ! self -> nextRead () )
+                break;
+            pending = true;
+
+            StringItfRef bases ( self -> getReadBases () );
+            StringItfRef qualities ( self -> getReadQualities () );
+            if ( ! batch . Append ( bases, qualities ) )
+                break;
+            pending = false;
+        }
+        batch . CopyOffsets ( jenv, joffsets );
+
+        return ( ( jlong ) batch . Count () << 1 ) | ( pending ? 1 : 0 );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
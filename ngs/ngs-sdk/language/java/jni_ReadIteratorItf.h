@@ -15,6 +15,14 @@ extern "C" {
 JNIEXPORT jboolean JNICALL Java_ngs_itf_ReadIteratorItf_NextRead
   (JNIEnv *, jobject, jlong);
 
+/*
+ * Class:     ngs_itf_ReadIteratorItf
+ * Method:    NextBatch
+ * Signature: (JIZLjava/nio/ByteBuffer;II[I)J
+ */
+JNIEXPORT jlong JNICALL Java_ngs_itf_ReadIteratorItf_NextBatch
+  (JNIEnv *, jobject, jlong, jint, jboolean, jobject, jint, jint, jintArray);
+
 #ifdef __cplusplus
 }
 #endif
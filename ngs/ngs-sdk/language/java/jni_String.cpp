@@ -28,6 +28,7 @@
 #include "jni_ErrorMsg.hpp"
 
 #include <ngs/itf/StringItf.hpp>
+#include <ngs/itf/ErrorMsg.hpp>
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -167,3 +168,73 @@ jstring StringItfConvertToJString ( ngs :: StringItf * self, JNIEnv * jenv )
     self -> Release ();
     return jstr;
 }
+
+
+/*--------------------------------------------------------------------------
+ * StringItfRef
+ */
+
+StringItfRef :: StringItfRef ( StringItf * _ref )
+    : ref ( _ref )
+{
+}
+
+StringItfRef :: ~ StringItfRef ()
+{
+    if ( ref != 0 )
+        ref -> Release ();
+}
+
+const char * StringItfRef :: data () const
+{
+    return ref == 0 ? 0 : ref -> data ();
+}
+
+jint StringItfRef :: size () const
+{
+    return ref == 0 ? 0 : ( jint ) ref -> size ();
+}
+
+
+/*--------------------------------------------------------------------------
+ * BatchBuffer
+ */
+
+BatchBuffer :: BatchBuffer ( JNIEnv * jenv, jobject jdata, jint position, jint _limit, jint max_count )
+    : data ( ( char * ) jenv -> GetDirectBufferAddress ( jdata ) )
+    , limit ( _limit )
+{
+    if ( data == 0 )
+        throw ErrorMsg ( "data is not a direct ByteBuffer" );
+    if ( max_count < 0 )
+        throw ErrorMsg ( "negative count" );
+    if ( position < 0 || position > limit || ( jlong ) limit > jenv -> GetDirectBufferCapacity ( jdata ) )
+        throw ErrorMsg ( "invalid ByteBuffer position or limit" );
+
+    offsets . reserve ( 2 * ( size_t ) max_count + 1 );
+    offsets . push_back ( position );
+}
+
+bool BatchBuffer :: Append ( const StringItfRef & bases, const StringItfRef & qualities )
+{
+    jint const used = offsets . back ();
+    jint const bases_size = bases . size ();
+    jint const qualities_size = qualities . size ();
+
+    if ( ( jlong ) limit - used < ( jlong ) bases_size + qualities_size )
+        return false;
+
+    if ( bases_size != 0 )
+        memmove ( data + used, bases . data (), bases_size );
+    if ( qualities_size != 0 )
+        memmove ( data + used + bases_size, qualities . data (), qualities_size );
+
+    offsets . push_back ( used + bases_size );
+    offsets . push_back ( used + bases_size + qualities_size );
+    return true;
+}
+
+void BatchBuffer :: CopyOffsets ( JNIEnv * jenv, jintArray joffsets ) const
+{
+    jenv -> SetIntArrayRegion ( joffsets, 0, ( jsize ) offsets . size (), & offsets [ 0 ] );
+}
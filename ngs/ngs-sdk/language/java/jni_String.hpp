@@ -35,6 +35,8 @@
 
 #include <stdarg.h>
 
+#include <vector>
+
 
 /*--------------------------------------------------------------------------
  * forwards
@@ -81,4 +83,61 @@ jstring StringItfCopyToJString ( const ngs :: StringItf * self, JNIEnv * jenv  )
 jstring StringItfConvertToJString ( ngs :: StringItf * self, JNIEnv * jenv );
 
 
+/*--------------------------------------------------------------------------
+ * StringItfRef
+ *  releases a StringItf when going out of scope
+ */
+class StringItfRef
+{
+public:
+    explicit StringItfRef ( ngs :: StringItf * ref );
+    ~StringItfRef ();
+
+    const char * data () const;
+    jint size () const;
+
+private:
+    StringItfRef ( const StringItfRef & );
+    StringItfRef & operator = ( const StringItfRef & );
+
+    ngs :: StringItf * ref;
+};
+
+
+/*--------------------------------------------------------------------------
+ * BatchBuffer
+ *  a direct ByteBuffer being filled by a NextBatch call
+ *  with the bases and qualities of each item back to back.
+ *  offsets [ 2 * i ] is where the bases of item i start,
+ *  offsets [ 2 * i + 1 ] is where its qualities start and
+ *  offsets [ 2 * i + 2 ] is where they end
+ */
+class BatchBuffer
+{
+public:
+    BatchBuffer ( JNIEnv * jenv, jobject jdata, jint position, jint limit, jint max_count );
+
+    /* Append
+     *  copy the values of the next item
+     *  returns false without copying if they don't fit
+     */
+    bool Append ( const StringItfRef & bases, const StringItfRef & qualities );
+
+    jint Count () const
+    {
+        return ( jint ) ( offsets . size () / 2 );
+    }
+
+    /* CopyOffsets
+     *  copy the offsets of the items into the Java array
+     */
+    void CopyOffsets ( JNIEnv * jenv, jintArray joffsets ) const;
+
+private:
+    char * data;
+    jint limit;
+    std :: vector < jint > offsets;
+};
+
+
 #endif /* _hpp_jni_ErrorMsg_ */
@@ -26,6 +26,7 @@
 
 #include "py_AlignmentIteratorItf.h"
 #include "py_ErrorMsg.hpp"
+#include "py_Batch.hpp"
 
 #include <ngs/itf/AlignmentItf.hpp>
 
@@ -54,3 +55,75 @@ PY_RES_TYPE PY_NGS_AlignmentIteratorNext ( void* pRef, int* pRet, void** ppNGSSt
     return ret;
 }
 
+PY_RES_TYPE PY_NGS_AlignmentIteratorNextBatch ( void* pRef, uint32_t maxCount, int resume,
+    PY_NGS_BatchField* fields, PY_NGS_AlignmentBatchValues* values, uint32_t* pCount, int* pPending, void** ppNGSStrError )
+{
+    PY_RES_TYPE ret = PY_RES_ERROR;
+    try
+    {
+        ngs::AlignmentItf* self = CheckedCast< ngs::AlignmentItf* >(pRef);
+        assert(fields != NULL);
+        assert(values != NULL);
+        assert(pCount != NULL);
+        assert(pPending != NULL);
+
+        BatchItem::reset ( fields, PY_NGS_AlignmentBatchFieldCount );
+
+        uint32_t count = 0;
+        bool pending = resume != 0;
+        while ( count < maxCount )
+        {
+            if ( ! pending && ! self -> nextAlignment () )
+                break;
+            pending = true;
+
+            BatchItem item ( fields, PY_NGS_AlignmentBatchFieldCount );
+            if ( item.wants ( PY_NGS_AlignmentBatchAlignmentId ) )
+                item.set ( PY_NGS_AlignmentBatchAlignmentId, self -> getAlignmentId () );
+            if ( item.wants ( PY_NGS_AlignmentBatchReferenceSpec ) )
+                item.set ( PY_NGS_AlignmentBatchReferenceSpec, self -> getReferenceSpec () );
+            if ( item.wants ( PY_NGS_AlignmentBatchReadId ) )
+                item.set ( PY_NGS_AlignmentBatchReadId, self -> getReadId () );
+            if ( item.wants ( PY_NGS_AlignmentBatchReadGroup ) )
+                item.set ( PY_NGS_AlignmentBatchReadGroup, self -> getReadGroup () );
+            if ( item.wants ( PY_NGS_AlignmentBatchClippedFragmentBases ) )
+                item.set ( PY_NGS_AlignmentBatchClippedFragmentBases, self -> getClippedFragmentBases () );
+            if ( item.wants ( PY_NGS_AlignmentBatchClippedFragmentQualities ) )
+                item.set ( PY_NGS_AlignmentBatchClippedFragmentQualities, self -> getClippedFragmentQualities () );
+            if ( item.wants ( PY_NGS_AlignmentBatchShortCigar ) )
+                item.set ( PY_NGS_AlignmentBatchShortCigar, self -> getShortCigar ( true ) );
+            if ( ! item.fits () )
+                break;
+
+            item.copy ( count );
+            if ( values -> positions != NULL )
+                values -> positions [ count ] = self -> getAlignmentPosition ();
+            if ( values -> lengths != NULL )
+                values -> lengths [ count ] = self -> getAlignmentLength ();
+            if ( values -> mappingQualities != NULL )
+                values -> mappingQualities [ count ] = self -> getMappingQuality ();
+            if ( values -> isReversed != NULL )
+                values -> isReversed [ count ] = (int32_t)self -> getIsReversedOrientation ();
+            if ( values -> categories != NULL )
+                values -> categories [ count ] = self -> getAlignmentCategory ();
+            pending = false;
+            ++ count;
+        }
+        *pCount = count;
+        *pPending = (int)pending;
+        ret = PY_RES_OK;
+    }
+    catch ( ngs::ErrorMsg & x )
+    {
+        ret = ExceptionHandler ( x, ppNGSStrError );
+    }
+    catch ( std::exception & x )
+    {
+        ret = ExceptionHandler ( x, ppNGSStrError );
+    }
+    catch ( ... )
+    {
+        ret = ExceptionHandler ( ppNGSStrError );
+    }
+    return ret;
+}
@@ -34,6 +34,36 @@ extern "C" {
 
 LIB_EXPORT PY_RES_TYPE PY_NGS_AlignmentIteratorNext(void* pRef, int* pRet, void** ppNGSStrError);
 
+/* indices into the array of fields given to PY_NGS_AlignmentIteratorNextBatch */
+enum
+{
+    PY_NGS_AlignmentBatchAlignmentId,
+    PY_NGS_AlignmentBatchReferenceSpec,
+    PY_NGS_AlignmentBatchReadId,
+    PY_NGS_AlignmentBatchReadGroup,
+    PY_NGS_AlignmentBatchClippedFragmentBases,
+    PY_NGS_AlignmentBatchClippedFragmentQualities,
+    PY_NGS_AlignmentBatchShortCigar,    /* clipped */
+
+    PY_NGS_AlignmentBatchFieldCount
+};
+
+/* caller-supplied arrays that receive the numeric values of a batch,
+   NULL if not wanted */
+typedef struct PY_NGS_AlignmentBatchValues PY_NGS_AlignmentBatchValues;
+struct PY_NGS_AlignmentBatchValues
+{
+    int64_t* positions;
+    uint64_t* lengths;
+    int32_t* mappingQualities;
+    int32_t* isReversed;
+    uint32_t* categories;
+};
+
+/* same as PY_NGS_ReadIteratorNextBatch but for alignments */
+LIB_EXPORT PY_RES_TYPE PY_NGS_AlignmentIteratorNextBatch(void* pRef, uint32_t maxCount, int resume,
+    PY_NGS_BatchField* fields, PY_NGS_AlignmentBatchValues* values, uint32_t* pCount, int* pPending, void** ppNGSStrError);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,105 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <string.h>
+#include <ngs/itf/StringItf.hpp>
+
+namespace
+{
+    /* the string values of one item of a batch,
+       they are copied into the batch only if all of them fit */
+    class BatchItem
+    {
+    public:
+        enum { MaxFields = 8 };
+
+        BatchItem ( PY_NGS_BatchField* Fields, uint32_t Count )
+            : fields ( Fields )
+            , count ( Count )
+        {
+            assert ( count <= MaxFields );
+            for ( uint32_t i = 0; i < count; ++ i )
+                values [ i ] = NULL;
+        }
+        ~BatchItem ()
+        {
+            for ( uint32_t i = 0; i < count; ++ i )
+            {
+                if ( values [ i ] != NULL )
+                    values [ i ] -> Release ();
+            }
+        }
+
+        bool wants ( uint32_t field ) const
+        {
+            return fields [ field ] . data != NULL;
+        }
+        void set ( uint32_t field, ngs::StringItf* value )
+        {
+            values [ field ] = value;
+        }
+
+        bool fits () const
+        {
+            for ( uint32_t i = 0; i < count; ++ i )
+            {
+                if ( values [ i ] != NULL && fields [ i ] . used + values [ i ] -> size () > fields [ i ] . capacity )
+                    return false;
+            }
+            return true;
+        }
+        void copy ( uint32_t index ) const
+        {
+            for ( uint32_t i = 0; i < count; ++ i )
+            {
+                PY_NGS_BatchField& f = fields [ i ];
+                if ( f . data == NULL )
+                    continue;
+
+                size_t const size = values [ i ] != NULL ? values [ i ] -> size () : 0;
+                if ( size != 0 )
+                    ::memmove ( f . data + f . used, values [ i ] -> data (), size );
+                f . offsets [ index ] = f . used;
+                f . lengths [ index ] = ( uint32_t ) size;
+                f . used += size;
+            }
+        }
+
+        static void reset ( PY_NGS_BatchField* fields, uint32_t count )
+        {
+            for ( uint32_t i = 0; i < count; ++ i )
+                fields [ i ] . used = 0;
+        }
+
+    private:
+        BatchItem ( BatchItem const& );
+        BatchItem& operator = ( BatchItem const& );
+
+        PY_NGS_BatchField* fields;
+        uint32_t count;
+        ngs::StringItf* values [ MaxFields ];
+    };
+}
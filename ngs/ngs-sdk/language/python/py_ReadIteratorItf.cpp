@@ -26,6 +26,7 @@
 
 #include "py_ReadIteratorItf.h"
 #include "py_ErrorMsg.hpp"
+#include "py_Batch.hpp"
 
 #include <ngs/itf/ReadItf.hpp>
 
@@ -54,3 +55,62 @@ PY_RES_TYPE PY_NGS_ReadIteratorNext ( void* pRef, int* pRet, void** ppNGSStrErro
     return ret;
 }
 
+PY_RES_TYPE PY_NGS_ReadIteratorNextBatch ( void* pRef, uint32_t maxCount, int resume,
+    PY_NGS_BatchField* fields, uint32_t* categories, uint32_t* pCount, int* pPending, void** ppNGSStrError )
+{
+    PY_RES_TYPE ret = PY_RES_ERROR;
+    try
+    {
+        ngs::ReadItf* self = CheckedCast< ngs::ReadItf* >(pRef);
+        assert(fields != NULL);
+        assert(pCount != NULL);
+        assert(pPending != NULL);
+
+        BatchItem::reset ( fields, PY_NGS_ReadBatchFieldCount );
+
+        uint32_t count = 0;
+        bool pending = resume != 0;
+        while ( count < maxCount )
+        {
+            if ( ! pending && ! self -> nextRead () )
+                break;
+            pending = true;
+
+            BatchItem item ( fields, PY_NGS_ReadBatchFieldCount );
+            if ( item.wants ( PY_NGS_ReadBatchReadId ) )
+                item.set ( PY_NGS_ReadBatchReadId, self -> getReadId () );
+            if ( item.wants ( PY_NGS_ReadBatchReadName ) )
+                item.set ( PY_NGS_ReadBatchReadName, self -> getReadName () );
+            if ( item.wants ( PY_NGS_ReadBatchReadGroup ) )
+                item.set ( PY_NGS_ReadBatchReadGroup, self -> getReadGroup () );
+            if ( item.wants ( PY_NGS_ReadBatchReadBases ) )
+                item.set ( PY_NGS_ReadBatchReadBases, self -> getReadBases () );
+            if ( item.wants ( PY_NGS_ReadBatchReadQualities ) )
+                item.set ( PY_NGS_ReadBatchReadQualities, self -> getReadQualities () );
+            if ( ! item.fits () )
+                break;
+
+            item.copy ( count );
+            if ( categories != NULL )
+                categories [ count ] = self -> getReadCategory ();
+            pending = false;
+            ++ count;
+        }
+        *pCount = count;
+        *pPending = (int)pending;
+        ret = PY_RES_OK;
+    }
+    catch ( ngs::ErrorMsg & x )
+    {
+        ret = ExceptionHandler ( x, ppNGSStrError );
+    }
+    catch ( std::exception & x )
+    {
+        ret = ExceptionHandler ( x, ppNGSStrError );
+    }
+    catch ( ... )
+    {
+        ret = ExceptionHandler ( ppNGSStrError );
+    }
+    return ret;
+}
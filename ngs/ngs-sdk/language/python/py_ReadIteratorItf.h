@@ -34,6 +34,25 @@ extern "C" {
 
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReadIteratorNext(void* pRef, int* pRet, void** ppNGSStrError);
 
+/* indices into the array of fields given to PY_NGS_ReadIteratorNextBatch */
+enum
+{
+    PY_NGS_ReadBatchReadId,
+    PY_NGS_ReadBatchReadName,
+    PY_NGS_ReadBatchReadGroup,
+    PY_NGS_ReadBatchReadBases,
+    PY_NGS_ReadBatchReadQualities,
+
+    PY_NGS_ReadBatchFieldCount
+};
+
+/* advances over up to maxCount reads copying the wanted fields into fields[]
+   and the categories into categories[] (if not NULL).
+   *pPending is set when the current read did not fit; pass it back as resume
+   on the next call to start with that read instead of advancing. */
+LIB_EXPORT PY_RES_TYPE PY_NGS_ReadIteratorNextBatch(void* pRef, uint32_t maxCount, int resume,
+    PY_NGS_BatchField* fields, uint32_t* categories, uint32_t* pCount, int* pPending, void** ppNGSStrError);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,6 +34,19 @@
 #define PY_RES_ERROR  1
 
 #include <stdint.h>
+
+/* a caller-supplied buffer that receives one string field
+   for every item of a batch, values are stored back to back */
+typedef struct PY_NGS_BatchField PY_NGS_BatchField;
+struct PY_NGS_BatchField
+{
+    char* data;             /* NULL if the field is not wanted */
+    uint64_t capacity;      /* size of data */
+    uint64_t used;          /* set by the call: bytes of data filled */
+    uint64_t* offsets;      /* per item: start of its value in data */
+    uint32_t* lengths;      /* per item: length of its value */
+};
+
 #ifdef _WIN32
 #define LIB_EXPORT __declspec(dllexport)
 #else
@@ -0,0 +1,281 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "ordered_workers.h"
+
+#ifndef _h_kapp_main_
+#include <kapp/main.h>      /* for Quitting() */
+#endif
+
+#ifndef _h_kproc_thread_
+#include <kproc/thread.h>
+#endif
+
+#ifndef _h_kproc_queue_
+#include <kproc/queue.h>
+#endif
+
+#ifndef _h_kproc_timeout_
+#include <kproc/timeout.h>
+#endif
+
+#ifndef _h_klib_log_
+#include <klib/log.h>
+#endif
+
+#include <atomic32.h>
+#include <sysalloc.h>
+#include <stdlib.h>
+
+/* how many finished items a worker can have in flight */
+#define ORDERED_WORKERS_QUEUE_DEPTH 4
+/* how long to wait for a queue, before checking if we have to quit */
+#define ORDERED_WORKERS_WAIT_MS 100
+
+#define DISP_RC( rc, err ) ( void )( ( 0 == rc ) ? 0 : LOGERR( klogInt, rc, err ) )
+
+typedef struct ordered_item
+{
+    void * item;
+    bool turn_done;         /* the last item of a turn */
+} ordered_item;
+
+typedef struct ordered_worker
+{
+    KThread * thread;
+    KQueue * done_q;        /* finished items: the worker pushes, the consumer pops */
+    atomic32_t * quit;      /* shared by all workers, set in case of trouble */
+    ordered_workers_produce_fn produce;
+    ordered_workers_release_fn release;
+    void * data;
+    uint32_t worker_id;
+    uint32_t num_workers;
+    bool done;              /* set by the consumer after the worker has sealed its queue */
+} ordered_worker;
+
+static bool ordered_workers_timed_out( rc_t rc ) {
+    return ( rcExhausted == GetRCState( rc ) && ( enum RCObject )rcTimeout == GetRCObject( rc ) );
+}
+
+static bool ordered_workers_sealed( rc_t rc ) {
+    return ( rcDone == GetRCState( rc ) && ( enum RCObject )rcData == GetRCObject( rc ) );
+}
+
+static void ordered_item_release( ordered_item * oi, ordered_workers_release_fn release ) {
+    if ( NULL != oi ) {
+        if ( NULL != oi -> item && NULL != release ) {
+            release( oi -> item );
+        }
+        free( oi );
+    }
+}
+
+rc_t ordered_worker_deliver( struct ordered_worker * self, void * item, bool turn_done ) {
+    rc_t rc = 0;
+    ordered_item * oi = malloc( sizeof * oi );
+    if ( NULL == oi ) {
+        rc = RC( rcExe, rcQueue, rcWriting, rcMemory, rcExhausted );
+        if ( NULL != item && NULL != self -> release ) {
+            self -> release( item );
+        }
+    } else {
+        bool running = true;
+        oi -> item = item;
+        oi -> turn_done = turn_done;
+        while ( running ) {
+            if ( 0 != atomic32_read( self -> quit ) ) {
+                rc = RC( rcExe, rcQueue, rcWriting, rcTransfer, rcCanceled );
+                running = false;
+            } else {
+                struct timeout_t tm;
+                rc = TimeoutInit( &tm, ORDERED_WORKERS_WAIT_MS );
+                if ( 0 == rc ) {
+                    rc = KQueuePush( self -> done_q, oi, &tm );
+                }
+                if ( 0 == rc ) {
+                    oi = NULL; /* the consumer owns it now */
+                    running = false;
+                } else if ( ordered_workers_timed_out( rc ) ) {
+                    rc = 0; /* the consumer is busy, try again */
+                } else {
+                    DISP_RC( rc, "ordered_worker_deliver:KQueuePush() failed" );
+                    running = false;
+                }
+            }
+        }
+        ordered_item_release( oi, self -> release );
+    }
+    return rc;
+}
+
+static rc_t CC ordered_workers_thread( const KThread * thread, void * data ) {
+    ordered_worker * self = data;
+    rc_t rc = self -> produce( self, self -> worker_id, self -> num_workers, self -> data );
+    /* tell the consumer that there will be nothing more from this worker */
+    rc_t rc2 = KQueueSeal( self -> done_q );
+    DISP_RC( rc2, "ordered_workers_thread:KQueueSeal() failed" );
+    if ( 0 != rc ) {
+        atomic32_set( self -> quit, 1 );
+    }
+    return rc;
+}
+
+/* pops the next item of this worker, *oi is NULL if the worker is done */
+static rc_t ordered_workers_pop( ordered_worker * self, ordered_item ** oi ) {
+    rc_t rc = 0;
+    bool running = true;
+    *oi = NULL;
+    while ( running ) {
+        struct timeout_t tm;
+        rc = TimeoutInit( &tm, ORDERED_WORKERS_WAIT_MS );
+        if ( 0 == rc ) {
+            rc = KQueuePop( self -> done_q, ( void ** )oi, &tm );
+        }
+        if ( 0 == rc ) {
+            running = false;
+        } else if ( ordered_workers_sealed( rc ) ) {
+            self -> done = true;
+            rc = 0;
+            running = false;
+        } else if ( ordered_workers_timed_out( rc ) ) {
+            rc = Quitting(); /* the worker is busy, try again - unless we got a signal */
+            running = ( 0 == rc );
+        } else {
+            DISP_RC( rc, "ordered_workers_pop:KQueuePop() failed" );
+            running = false;
+        }
+    }
+    return rc;
+}
+
+/* the consumer: takes the turns round-robin from the workers */
+static rc_t ordered_workers_collect( ordered_worker * workers, uint32_t num_workers,
+                                     ordered_workers_consume_fn consume, void * consume_data,
+                                     ordered_workers_release_fn release ) {
+    rc_t rc = 0;
+    uint64_t turn = 0;
+    bool running = true;
+    while ( 0 == rc && running ) {
+        ordered_item * oi;
+        rc = ordered_workers_pop( &( workers[ turn % num_workers ] ), &oi );
+        if ( 0 == rc ) {
+            if ( NULL == oi ) {
+                /* the first missing turn ends the processing */
+                running = false;
+            } else {
+                rc = consume( oi -> item, consume_data );
+                if ( oi -> turn_done ) {
+                    turn++;
+                }
+                ordered_item_release( oi, release );
+            }
+        }
+    }
+    return rc;
+}
+
+/* drains the queues of all workers, to unblock them in case we stopped early */
+static void ordered_workers_drain( ordered_worker * workers, uint32_t num_workers,
+                                   ordered_workers_release_fn release ) {
+    uint32_t i;
+    for ( i = 0; i < num_workers; ++i ) {
+        ordered_worker * w = &( workers[ i ] );
+        while ( !w -> done ) {
+            ordered_item * oi;
+            if ( 0 != ordered_workers_pop( w, &oi ) ) break;
+            ordered_item_release( oi, release );
+        }
+    }
+}
+
+rc_t ordered_workers_run( uint32_t num_workers,
+                          ordered_workers_produce_fn produce, void ** data,
+                          ordered_workers_consume_fn consume, void * consume_data,
+                          ordered_workers_release_fn release ) {
+    rc_t rc = 0;
+    atomic32_t quit;
+    uint32_t i, started = 0;
+    ordered_worker * workers;
+
+    if ( 0 == num_workers || NULL == produce || NULL == data || NULL == consume ) {
+        return RC( rcExe, rcQueue, rcConstructing, rcParam, rcInvalid );
+    }
+    workers = calloc( num_workers, sizeof * workers );
+    if ( NULL == workers ) {
+        return RC( rcExe, rcQueue, rcConstructing, rcMemory, rcExhausted );
+    }
+    atomic32_set( &quit, 0 );
+
+    for ( i = 0; 0 == rc && i < num_workers; ++i ) {
+        ordered_worker * w = &( workers[ i ] );
+        w -> quit = &quit;
+        w -> produce = produce;
+        w -> release = release;
+        w -> data = data[ i ];
+        w -> worker_id = i;
+        w -> num_workers = num_workers;
+        rc = KQueueMake( &( w -> done_q ), ORDERED_WORKERS_QUEUE_DEPTH );
+        DISP_RC( rc, "ordered_workers_run:KQueueMake() failed" );
+    }
+    for ( i = 0; 0 == rc && i < num_workers; ++i ) {
+        rc = KThreadMake( &( workers[ i ] . thread ), ordered_workers_thread, &( workers[ i ] ) );
+        DISP_RC( rc, "ordered_workers_run:KThreadMake() failed" );
+        if ( 0 == rc ) {
+            started++;
+        }
+    }
+
+    if ( 0 == rc ) {
+        rc = ordered_workers_collect( workers, num_workers, consume, consume_data, release );
+    }
+
+    /* if we stopped early, make the workers stop and unblock them */
+    atomic32_set( &quit, 1 );
+    for ( i = started; i < num_workers; ++i ) {
+        workers[ i ] . done = true;
+    }
+    ordered_workers_drain( workers, num_workers, release );
+
+    for ( i = 0; i < num_workers; ++i ) {
+        ordered_worker * w = &( workers[ i ] );
+        if ( NULL != w -> thread ) {
+            rc_t rc_thread;
+            rc_t rc2 = KThreadWait( w -> thread, &rc_thread );
+            DISP_RC( rc2, "ordered_workers_run:KThreadWait() failed" );
+            rc = ( 0 == rc ) ? rc2 : rc;
+            /* a worker canceled because of somebody else's trouble does not count */
+            if ( 0 == rc && rcCanceled != GetRCState( rc_thread ) ) {
+                rc = rc_thread;
+            }
+            KThreadRelease( w -> thread );
+        }
+        if ( NULL != w -> done_q ) {
+            KQueueRelease( w -> done_q );
+        }
+    }
+    free( workers );
+    return rc;
+}
@@ -0,0 +1,74 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_ordered_workers_
+#define _h_ordered_workers_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _h_klib_rc_
+#include <klib/rc.h>
+#endif
+
+/********************************************************************
+ordered processing of items produced by multiple worker-threads:
+    - the work is cut into turns numbered 0, 1, 2 ...
+    - worker #n takes the turns n, n + N, n + 2N ... ( N = number of workers )
+      and hands the items of a turn to ordered_worker_deliver(),
+      the last item of a turn is delivered with turn_done set
+    - the calling thread takes the turns round-robin from the workers
+      and hands the items in their original order to the consumer
+    - the first worker that has no more turns ends the processing
+********************************************************************/
+struct ordered_worker;
+
+typedef rc_t ( CC * ordered_workers_produce_fn )( struct ordered_worker * self,
+                                                  uint32_t worker_id,
+                                                  uint32_t num_workers,
+                                                  void * data );
+
+typedef rc_t ( CC * ordered_workers_consume_fn )( void * item, void * data );
+
+typedef void ( CC * ordered_workers_release_fn )( void * item );
+
+/* hands an item over to the consumer, takes ownership of the item */
+rc_t ordered_worker_deliver( struct ordered_worker * self, void * item, bool turn_done );
+
+/* starts num_workers threads running produce( data[ worker_id ] ),
+   calls consume( item, consume_data ) in the calling thread for every item
+   in order, releases the items via release() and returns after all threads are done */
+rc_t ordered_workers_run( uint32_t num_workers,
+                          ordered_workers_produce_fn produce, void ** data,
+                          ordered_workers_consume_fn consume, void * consume_data,
+                          ordered_workers_release_fn release );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+bin_dir=$1
+sratools=$2
+
+echo "testing --jobs via ${sratools}"
+
+mkdir -p actual
+
+# the jobs run at once, their command lines come in any order
+run_jobs() {
+    NCBI_SETTINGS=tmp.mkfg \
+    PATH="${bin_dir}:$PATH" \
+    SRATOOLS_TESTING=2 \
+    SRATOOLS_IMPERSONATE=$1 \
+    ${bin_dir}/${sratools} "${@:2}" 2>&1 | sort
+}
+
+check() {
+    if [ "$1" != "$2" ]; then
+        echo "Driver tool test jobs via ${sratools} FAILED for $3"
+        echo "expected:"; echo "$2"
+        echo "actual:"; echo "$1"
+        exit 1
+    fi
+}
+
+# the thread and memory limits are shared by the jobs, the tool's defaults as well
+output=$(run_jobs fasterq-dump --jobs 2 SRR000001 ERR000001)
+check "$output" "fasterq-dump ERR000001 --threads 3 --mem 26214400
+fasterq-dump SRR000001 --threads 3 --mem 26214400" "default limits"
+
+output=$(run_jobs fasterq-dump --jobs 2 --threads 8 --mem 1G SRR000001 ERR000001)
+check "$output" "fasterq-dump ERR000001 --threads 4 --mem 536870912
+fasterq-dump SRR000001 --threads 4 --mem 536870912" "given limits"
+
+output=$(run_jobs fastq-dump --jobs 2 SRR000001 ERR000001)
+check "$output" "fastq-dump ERR000001
+fastq-dump SRR000001" "fastq-dump"
+
+# output to stdout is not interleaved: one accession at a time, no budget
+output=$(run_jobs fasterq-dump --jobs 2 --stdout SRR000001 ERR000001)
+check "$output" "--jobs 2: fasterq-dump is writing to one output, running one accession at a time.
+fasterq-dump --stdout ERR000001
+fasterq-dump --stdout SRR000001" "fasterq-dump --stdout"
+
+output=$(run_jobs vdb-dump --jobs 2 SRR000001 ERR000001)
+check "$output" "--jobs 2: vdb-dump is writing to one output, running one accession at a time.
+vdb-dump ERR000001
+vdb-dump SRR000001" "vdb-dump"
+
+echo "Driver tool test jobs via ${sratools} is finished"
@@ -32,6 +32,8 @@
 
 #include <ktst/unit_test.hpp>
 
+#include <cstdio>
+
 #include <kfg/config.h>
 #include <klib/text.h>
 
@@ -120,6 +122,7 @@ namespace vdb {
 ////////////////////
 // stub for Config, use test flags instead of KConfig
 static bool sdlDisabled = true;
+static opt_string sdlCachePath;
 sratools::Config::Config()
 {
     obj = NULL;
@@ -139,6 +142,10 @@ opt_string sratools::Config::get(char const *const keypath) const
     {
         return sdlDisabled ? opt_string("true") : opt_string();
     }
+    if ( string(keypath) == "/repository/remote/SDL-cache/path" )
+    {
+        return sdlCachePath;
+    }
 
     String *value = NULL;
     KConfigReadString((KConfig *)obj, keypath, &value);
@@ -724,6 +731,99 @@ FIXTURE_TEST_CASE( ConstructSDL_Encrypted_NoNGC_Skipped, DataSourcesFixture )
     // no other info; SRR000001 is ignored b/c encrypted and no NGC
 }
 
+class SDLCacheFixture
+{
+protected:
+    static char argv0[];
+    static char argv1[];
+    static char * argv[];
+    static char * envp[];
+
+    SDLCacheFixture()
+    : cl(2, argv, envp, nullptr)
+    {
+        sdlCachePath = ".";
+    }
+    ~SDLCacheFixture()
+    {
+        std::remove(data_sources::SDLCache(false)->pathFor(argv1).c_str());
+        sdlCachePath = opt_string();
+    }
+
+    static string response(char const *expirationDate)
+    {
+        return string(R"({"version": "2","result":[{
+            "bundle": "SRR000001",
+            "status": 200,
+            "msg": "ok",
+            "files": [
+                {
+                    "object": "srapub|SRR000001",
+                    "accession": "SRR000001",
+                    "type": "sra",
+                    "name": "SRR000001",
+                    "size": 312527083,
+                    "md5": "9bde35fefa9d955f457e22d9be52bcd9",
+                    "modificationDate": "2015-04-08T02:54:13Z",
+                    "locations": [
+                        {
+                            "service": "s3",
+                            "region": "us-east-1",
+                            "expirationDate": ")") + expirationDate + R"(",
+                            "link": "https://sra-pub-run-odp.s3.amazonaws.com/sra/SRR000001/SRR000001"
+                        }
+                    ]
+                }
+            ]
+        }]})";
+    }
+
+    CommandLine cl;
+};
+
+char SDLCacheFixture::argv0[] = "vdb-dump";
+char SDLCacheFixture::argv1[] = "SRR000001";
+char * SDLCacheFixture::argv[] = { argv0, argv1, nullptr };
+char * SDLCacheFixture::envp[] = { nullptr };
+
+FIXTURE_TEST_CASE( ConstructSDL_cached, SDLCacheFixture )
+{
+    vdb::ServiceResponse = response("2999-01-01T00:00:00Z");
+    {
+        auto const &ds = data_sources(cl, argumentsParsed(cl), true);
+        auto qi = ds.queryInfo;
+        REQUIRE(DictionaryValueMatches(qi[argv1], "remote", "1"));
+    }
+
+    // the stand-in service no longer knows about it, the answer must come from the cache
+    vdb::ServiceResponse = R"({"version": "2","result":[]})";
+    auto const &ds = data_sources(cl, argumentsParsed(cl), true);
+    auto qi = ds.queryInfo;
+    REQUIRE_EQ( (size_t)1, qi.size() );
+    auto dict = qi[argv1];
+    REQUIRE(DictionaryValueMatches(dict, "name", argv1));
+    REQUIRE(DictionaryHasKey(dict, "simple"));
+    REQUIRE(DictionaryValueMatches(dict, "remote", "1"));
+    REQUIRE(DictionaryValueMatches(dict, "SDL/status", "200"));
+    REQUIRE(DictionaryValueMatches(dict, "remote/1/filePath", "https://sra-pub-run-odp.s3.amazonaws.com/sra/SRR000001/SRR000001"));
+    REQUIRE(DictionaryValueMatches(dict, "remote/1/service", "s3"));
+}
+
+FIXTURE_TEST_CASE( ConstructSDL_expired_NotCached, SDLCacheFixture )
+{
+    vdb::ServiceResponse = response("2015-04-08T02:54:13Z");
+    {
+        auto const &ds = data_sources(cl, argumentsParsed(cl), true);
+        auto qi = ds.queryInfo;
+        REQUIRE(DictionaryValueMatches(qi[argv1], "remote", "1"));
+    }
+
+    vdb::ServiceResponse = R"({"version": "2","result":[]})";
+    auto const &ds = data_sources(cl, argumentsParsed(cl), true);
+    auto qi = ds.queryInfo;
+    REQUIRE( ! DictionaryHasKey(qi[argv1], "remote") );
+}
+
 #if WIN32
 #define main wmain
 #endif
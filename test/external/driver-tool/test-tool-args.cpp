@@ -109,6 +109,42 @@ TEST_CASE( ParseArgs )
     //TODO: (*it).reason
 }
 
+TEST_CASE( KeepSkipsJobs )
+{
+    char argv0[20] = "fasterq-dump";
+    char argv1[10] = "SRR000123";
+    char argv2[10] = "--jobs";
+    char argv3[10] = "4";
+    char argv4[10] = "SRR000124";
+    char argv5[10] = "--jobs=4";
+    char * argv[] = { argv0, argv1, argv2, argv3, argv4, argv5, nullptr };
+    char * envp[] = { nullptr };
+    CommandLine cl(6, argv, envp, nullptr);
+
+    Arguments args = argumentsParsed(cl);
+    REQUIRE_EQ(2u, args.countOfCommandArguments());
+    REQUIRE_EQ(2u, args.countMatching("jobs"));
+
+    Argument const *first = nullptr;
+    for (auto & arg : args) {
+        if (arg.isArgument() && first == nullptr)
+            first = &arg;
+        else if (arg == "jobs") {
+            REQUIRE_EQ( string("4"), string(arg.argument) );
+            arg.reason = "used";
+        }
+    }
+    REQUIRE_NOT_NULL( first );
+    REQUIRE_EQ( 1, first->argind );
+
+    auto const skip = args.keep(*first);
+    REQUIRE( ! skip.contains(1) );
+    REQUIRE( skip.contains(2) ); // --jobs
+    REQUIRE( skip.contains(3) ); // 4
+    REQUIRE( skip.contains(4) ); // SRR000124
+    REQUIRE( skip.contains(5) ); // --jobs=4
+}
+
 //TODO: more tests
 
 #if WIN32
@@ -0,0 +1,67 @@
+#!/bin/bash
+
+# the goal of this test is to verify the interpreter of --defline-seq/--defline-qual
+#
+# the expected output is the built-in defline of fastq-dump ( -I for read ids ),
+# which is not made by the interpreter: the templates below have to reproduce it.
+# optional groups have to behave like the plain variables if one of them is set,
+# and vanish if all of them are empty ( SRR000001 has no spot group )
+
+bin_dir=$1
+fastq_dump=$2
+
+ACC=SRR000001
+RANGE="-N 1 -X 20"
+TMP=./tmp_defline
+
+echo Testing ${fastq_dump} --defline-seq/--defline-qual from ${bin_dir}
+
+# $1 : options with a template, $2 : options giving the expected output
+function compare {
+    rm -rf ${TMP}
+    mkdir -p ${TMP}
+    eval ${bin_dir}/${fastq_dump} ${ACC} ${RANGE} -Z "$1" > ${TMP}/defline.out 2> ${TMP}/defline.err
+    res=$?
+    if [ "$res" != "0" ]; then
+        echo "fastq-dump $1 FAILED, res=$res" && cat ${TMP}/defline.err && exit 1
+    fi
+    eval ${bin_dir}/${fastq_dump} ${ACC} ${RANGE} -Z "$2" > ${TMP}/expected.out 2> ${TMP}/expected.err
+    res=$?
+    if [ "$res" != "0" ]; then
+        echo "fastq-dump $2 FAILED, res=$res" && cat ${TMP}/expected.err && exit 1
+    fi
+    if [ ! -s ${TMP}/expected.out ]; then
+        echo "fastq-dump $2 produced no output" && exit 1
+    fi
+    output=$(diff ${TMP}/expected.out ${TMP}/defline.out)
+    res=$?
+    if [ "$res" != "0" ]; then
+        echo "output of 'fastq-dump $1' differs from 'fastq-dump $2':"
+        echo "$output" | head -n 10
+        exit 1
+    fi
+    echo "'fastq-dump $1' == 'fastq-dump $2'"
+}
+
+# whole spots: $rl is the spot length
+compare "--defline-seq '@\$ac.\$si \$sn length=\$sl' --defline-qual '+\$ac.\$si \$sn length=\$sl'" ""
+compare "--defline-seq '@\$ac.\$si \$sn length=\$rl' --defline-qual '+\$ac.\$si \$sn length=\$rl'" ""
+
+# split spots: $ri and $rl are the ones of the read
+compare "--split-spot --defline-seq '@\$ac.\$si \$sn length=\$rl' --defline-qual '+\$ac.\$si \$sn length=\$rl'" "--split-spot"
+compare "--split-spot --defline-seq '@\$ac.\$si.\$ri \$sn length=\$rl' --defline-qual '+\$ac.\$si.\$ri \$sn length=\$rl'" "--split-spot -I"
+
+# optional groups: printed if one of their variables is set
+compare "--defline-seq '@\$ac.\$si[ \$sn] length=\$sl' --defline-qual '+\$ac.\$si[ \$sn][ length=\$sl]'" ""
+compare "--split-spot --defline-seq '@\$ac.\$si[.\$ri] [\$sg\$sn] length=\$rl' --defline-qual '+\$ac.\$si[.\$ri] \$sn length=\$rl'" "--split-spot -I"
+
+# optional groups: omitted if all of their variables are empty
+compare "--defline-seq '@\$ac.\$si[ group=\$sg] \$sn length=\$sl' --defline-qual '+\$ac.\$si \$sn[/\$sg/] length=\$sl'" ""
+compare "--split-spot --defline-seq '@\$ac.\$si[\$sg:\$sg] \$sn length=\$rl' --defline-qual '+\$ac.\$si \$sn length=\$rl[ \$sg]'" "--split-spot"
+
+# a group and the plain variable give the same output, empty or not
+compare "--split-spot --defline-seq '@\$ac.\$si/[\$rn]/' --defline-qual '+[\$rn]'" \
+        "--split-spot --defline-seq '@\$ac.\$si/\$rn/' --defline-qual '+\$rn'"
+
+rm -rf ${TMP}
+echo ${fastq_dump} --defline test is finished
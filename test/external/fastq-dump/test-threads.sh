@@ -0,0 +1,49 @@
+#!/bin/bash
+
+# the goal of this test is to verify that 'fastq-dump --threads N' produces
+# exactly the same files, stdout and stderr as the single-threaded fastq-dump
+#
+# the spot-range is longer than a few chunks ( 8192 spots ) of the parallel
+# dumper, and not a multiple of it
+
+bin_dir=$1
+fastq_dump=$2
+
+ACC=SRR000001
+RANGE="-N 1 -X 50000"
+TMP=./tmp_threads
+
+echo Testing ${fastq_dump} --threads from ${bin_dir}
+
+function compare {
+    OPTS="$1"
+    rm -rf ${TMP}
+    mkdir -p ${TMP}/st ${TMP}/mt
+    ${bin_dir}/${fastq_dump} ${ACC} ${RANGE} ${OPTS} -O ${TMP}/st > ${TMP}/st.out 2> ${TMP}/st.err
+    res=$?
+    if [ "$res" != "0" ]; then
+        echo "fastq-dump ${OPTS} FAILED, res=$res" && cat ${TMP}/st.err && exit 1
+    fi
+    ${bin_dir}/${fastq_dump} ${ACC} ${RANGE} ${OPTS} -O ${TMP}/mt --threads 4 > ${TMP}/mt.out 2> ${TMP}/mt.err
+    res=$?
+    if [ "$res" != "0" ]; then
+        echo "fastq-dump ${OPTS} --threads 4 FAILED, res=$res" && cat ${TMP}/mt.err && exit 1
+    fi
+    # the output-directories are part of the output of --split-3 ...
+    output=$(diff -r ${TMP}/st ${TMP}/mt && diff ${TMP}/st.out ${TMP}/mt.out && diff ${TMP}/st.err ${TMP}/mt.err)
+    res=$?
+    if [ "$res" != "0" ]; then
+        echo "output of 'fastq-dump ${OPTS}' differs with --threads 4:"
+        echo "$output" | head -n 10
+        exit 1
+    fi
+    echo "output of 'fastq-dump ${OPTS}' does not depend on the number of threads"
+}
+
+compare "--split-3"
+compare "-Z"
+compare "-Z --split-spot --skip-technical"
+compare "--split-3 -M 100 --read-filter pass --clip"
+
+rm -rf ${TMP}
+echo ${fastq_dump} --threads test is finished
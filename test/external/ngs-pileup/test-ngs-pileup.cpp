@@ -106,6 +106,26 @@ FIXTURE_TEST_CASE ( SingleReference_Slice, NGSPileupFixture )
     REQUIRE_EQ ( expected, Run().substr(0, expected.size()) );
 }
 
+FIXTURE_TEST_CASE ( SingleReference_Slice_DepthOnly, NGSPileupFixture )
+{
+    ps . AddInput ( "ERR247027" );
+    ps . AddReferenceSlice ( "AL844509.2", 1212492, 3 );
+    ps . depthOnly = true;
+    string expected =
+        "AL844509.2\t1212494\t1\n"
+        "AL844509.2\t1212495\t1\n";
+    REQUIRE_EQ ( expected, Run().substr(0, expected.size()) );
+}
+
+FIXTURE_TEST_CASE ( Threads_SameOutput, NGSPileupFixture )
+{
+    ps . AddInput ( "SRR833251" );
+    string expected = Run ();
+    m_str . str ( string () );
+    ps . threads = 4;
+    REQUIRE_EQ ( expected, Run () );
+}
+
 #if 0
 FIXTURE_TEST_CASE ( MultipleReferences, NGSPileupFixture )
 {
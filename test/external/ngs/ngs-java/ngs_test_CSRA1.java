@@ -36,6 +36,11 @@ import ngs.ReadGroupIterator;
 import ngs.Statistics;
 import ngs.Alignment;
 import ngs.ErrorMsg;
+import ngs.ReadBatchIterator;
+import ngs.AlignmentBatchIterator;
+
+import java.nio.BufferOverflowException;
+import java.nio.ByteBuffer;
 
 import gov.nih.nlm.ncbi.ngs.NGS;
 
@@ -972,4 +977,146 @@ public class ngs_test_CSRA1 {
         Statistics st = rgIt.getStatistics();
         st.getValueType(null);
     }
+
+// nextBatch
+
+    String batchString ( ByteBuffer data, int from, int to )
+    {
+        byte [] bytes = new byte [ to - from ];
+        for ( int i = 0; i < bytes . length; ++ i )
+            bytes [ i ] = data . get ( from + i );
+        return new String ( bytes );
+    }
+
+    void checkReadBatch ( ngs . ReadIterator expected, ByteBuffer data, int [] offsets, int copied ) throws ngs.ErrorMsg
+    {
+        for ( int i = 0; i < copied; ++ i )
+        {
+            assertTrue ( expected . nextRead () );
+            assertEquals ( expected . getReadBases (), batchString ( data, offsets [ 2 * i ], offsets [ 2 * i + 1 ] ) );
+            assertEquals ( expected . getReadQualities (), batchString ( data, offsets [ 2 * i + 1 ], offsets [ 2 * i + 2 ] ) );
+        }
+    }
+
+    @Test
+    public void ReadBatchIterator_nextBatch_full () throws ngs.ErrorMsg
+    {
+        ngs . ReadCollection run = NGS . openReadCollection ( PrimaryOnly );
+        ReadBatchIterator it = ( ReadBatchIterator ) run . getReads ( ngs . Read . all );
+        ByteBuffer data = ByteBuffer . allocateDirect ( 64 * 1024 );
+        int [] offsets = new int [ 2 * 10 + 1 ];
+
+        assertEquals ( 10, it . nextBatch ( 10, data, offsets ) );
+        assertEquals ( 0, offsets [ 0 ] );
+        assertEquals ( offsets [ 20 ], data . position () );
+        checkReadBatch ( run . getReads ( ngs . Read . all ), data, offsets, 10 );
+
+        // the iterator goes on after the batch
+        assertTrue ( it . nextRead () );
+        assertEquals ( PrimaryOnly + ".R.11", it . getReadId () );
+    }
+
+    @Test
+    public void ReadBatchIterator_nextBatch_pending () throws ngs.ErrorMsg
+    {
+        ngs . ReadCollection run = NGS . openReadCollection ( PrimaryOnly );
+        ngs . ReadIterator first = run . getReads ( ngs . Read . all );
+        assertTrue ( first . nextRead () );
+        int size = first . getReadBases () . length () + first . getReadQualities () . length ();
+
+        // room for the first Read only: the second one is left pending
+        ReadBatchIterator it = ( ReadBatchIterator ) run . getReads ( ngs . Read . all );
+        ByteBuffer data = ByteBuffer . allocateDirect ( size + 1 );
+        int [] offsets = new int [ 2 * 2 + 1 ];
+        assertEquals ( 1, it . nextBatch ( 2, data, offsets ) );
+        assertEquals ( size, data . position () );
+        checkReadBatch ( run . getReads ( ngs . Read . all ), data, offsets, 1 );
+
+        // the pending Read does not fit into the rest of the buffer at all
+        try
+        {
+            it . nextBatch ( 2, data, offsets );
+            fail ();
+        }
+        catch ( BufferOverflowException e ) {}
+
+        // nextRead returns the pending Read without advancing
+        assertTrue ( it . nextRead () );
+        assertEquals ( PrimaryOnly + ".R.2", it . getReadId () );
+        assertTrue ( it . nextRead () );
+        assertEquals ( PrimaryOnly + ".R.3", it . getReadId () );
+    }
+
+    @Test
+    public void ReadBatchIterator_nextBatch_end () throws ngs.ErrorMsg
+    {
+        ngs . ReadCollection run = NGS . openReadCollection ( PrimaryOnly );
+        ReadBatchIterator it = ( ReadBatchIterator ) run . getReadRange ( 2, 3 );
+        ByteBuffer data = ByteBuffer . allocateDirect ( 64 * 1024 );
+        int [] offsets = new int [ 2 * 10 + 1 ];
+
+        assertEquals ( 3, it . nextBatch ( 10, data, offsets ) );
+        checkReadBatch ( run . getReadRange ( 2, 3 ), data, offsets, 3 );
+        assertEquals ( 0, it . nextBatch ( 10, data, offsets ) );
+        assertFalse ( it . nextRead () );
+    }
+
+    @Test
+    public void AlignmentBatchIterator_nextBatch_full () throws ngs.ErrorMsg
+    {
+        ngs . ReadCollection run = NGS . openReadCollection ( PrimaryOnly );
+        AlignmentBatchIterator it = ( AlignmentBatchIterator ) run . getAlignments ( Alignment . primaryAlignment );
+        ByteBuffer data = ByteBuffer . allocateDirect ( 64 * 1024 );
+        int [] offsets = new int [ 2 * 10 + 1 ];
+
+        assertEquals ( 10, it . nextBatch ( 10, data, offsets ) );
+        assertEquals ( offsets [ 20 ], data . position () );
+
+        ngs . AlignmentIterator expected = run . getAlignments ( Alignment . primaryAlignment );
+        for ( int i = 0; i < 10; ++ i )
+        {
+            assertTrue ( expected . nextAlignment () );
+            assertEquals ( expected . getClippedFragmentBases (), batchString ( data, offsets [ 2 * i ], offsets [ 2 * i + 1 ] ) );
+            assertEquals ( expected . getClippedFragmentQualities (), batchString ( data, offsets [ 2 * i + 1 ], offsets [ 2 * i + 2 ] ) );
+        }
+        assertTrue ( expected . nextAlignment () );
+        assertTrue ( it . nextAlignment () );
+        assertEquals ( expected . getAlignmentId (), it . getAlignmentId () );
+    }
+
+    @Test
+    public void AlignmentBatchIterator_nextBatch_pending () throws ngs.ErrorMsg
+    {
+        ngs . ReadCollection run = NGS . openReadCollection ( PrimaryOnly );
+        ngs . AlignmentIterator expected = run . getAlignments ( Alignment . primaryAlignment );
+        assertTrue ( expected . nextAlignment () );
+        int size = expected . getClippedFragmentBases () . length () + expected . getClippedFragmentQualities () . length ();
+
+        AlignmentBatchIterator it = ( AlignmentBatchIterator ) run . getAlignments ( Alignment . primaryAlignment );
+        ByteBuffer data = ByteBuffer . allocateDirect ( size + 1 );
+        int [] offsets = new int [ 2 * 2 + 1 ];
+        assertEquals ( 1, it . nextBatch ( 2, data, offsets ) );
+
+        // nextAlignment returns the pending Alignment without advancing
+        assertTrue ( expected . nextAlignment () );
+        assertTrue ( it . nextAlignment () );
+        assertEquals ( expected . getAlignmentId (), it . getAlignmentId () );
+    }
+
+    @Test
+    public void AlignmentBatchIterator_nextBatch_end () throws ngs.ErrorMsg
+    {
+        ngs . ReadCollection run = NGS . openReadCollection ( PrimaryOnly );
+        int count = 0;
+        ngs . AlignmentIterator expected = run . getAlignmentRange ( 1, 3 );
+        while ( expected . nextAlignment () )
+            ++ count;
+
+        AlignmentBatchIterator it = ( AlignmentBatchIterator ) run . getAlignmentRange ( 1, 3 );
+        ByteBuffer data = ByteBuffer . allocateDirect ( 64 * 1024 );
+        int [] offsets = new int [ 2 * 10 + 1 ];
+        assertEquals ( count, it . nextBatch ( 10, data, offsets ) );
+        assertEquals ( 0, it . nextBatch ( 10, data, offsets ) );
+        assertFalse ( it . nextAlignment () );
+    }
 }
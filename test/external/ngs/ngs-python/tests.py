@@ -5,6 +5,7 @@ from ngs.ReadCollection import ReadCollection
 from ngs.ReferenceSequence import ReferenceSequence
 from ngs.Alignment import Alignment
 from ngs.Read import Read
+from ngs.Batch import ReadBatch, AlignmentBatch
 
 PrimaryOnly           = "SRR1063272"
 WithSecondary         = "SRR833251"
@@ -508,5 +509,99 @@ class Tests(unittest.TestCase):
         self.assertTrue(it.nextReadGroup());
         name = it.getName();
 
+    # nextBatch
+    readBatchFields = ("readId", "bases", "qualities", "category")
+
+    def expectedReads(self, it, count):
+        res = []
+        while len(res) < count and it.nextRead():
+            res.append((it.getReadId(), it.getReadBases(), it.getReadQualities(), it.getReadCategory()))
+        return res
+
+    def batchedReads(self, it, count, batch=None):
+        res = []
+        while True:
+            batch = it.nextBatch(count, self.readBatchFields, batch)
+            if len(batch) == 0:
+                return res
+            res.extend(zip(*[batch.values(name) for name in self.readBatchFields]))
+
+    def test_ReadIterator_nextBatch(self):
+        run = NGS.openReadCollection(PrimaryOnly)
+        expected = self.expectedReads(run.getReadRange(1, 25), 25)
+        self.assertEqual(expected, self.batchedReads(run.getReadRange(1, 25), 10))
+
+    def test_ReadIterator_nextBatch_end(self):
+        run = NGS.openReadCollection(PrimaryOnly)
+        it = run.getReadRange(2, 3)
+        batch = it.nextBatch(10, self.readBatchFields)
+        self.assertEqual(3, len(batch))
+        self.assertEqual(PrimaryOnly + ".R.2", batch.get("readId", 0))
+        self.assertEqual(0, len(it.nextBatch(10, self.readBatchFields, batch)))
+        self.assertFalse(it.nextRead())
+
+    def test_ReadIterator_nextBatch_pending(self):
+        run = NGS.openReadCollection(PrimaryOnly)
+        it = run.getReads(Read.all)
+        first = it.nextBatch(1, self.readBatchFields)
+        # buffers for exactly the first Read: 4 Reads do not fit, the second one is left pending
+        batch = ReadBatch(4, self.readBatchFields)
+        for i, name in enumerate(ReadBatch.stringFields):
+            if name in batch.wanted:
+                batch._allocate(i, len(first.get(name, 0)) + 1)
+        it = run.getReads(Read.all)
+        batch = it.nextBatch(4, self.readBatchFields, batch)
+        self.assertEqual(1, len(batch))
+        self.assertEqual(PrimaryOnly + ".R.1", batch.get("readId", 0))
+        # nextRead returns the pending Read without advancing
+        self.assertTrue(it.nextRead())
+        self.assertEqual(PrimaryOnly + ".R.2", it.getReadId())
+        self.assertTrue(it.nextRead())
+        self.assertEqual(PrimaryOnly + ".R.3", it.getReadId())
+
+    def test_ReadIterator_nextBatch_grow(self):
+        # buffers of 1 byte per Read: every call has to grow them before a Read fits
+        class TinyReadBatch(ReadBatch):
+            bytesPerItem = 1
+        run = NGS.openReadCollection(PrimaryOnly)
+        expected = self.expectedReads(run.getReadRange(1, 25), 25)
+        batch = TinyReadBatch(10, self.readBatchFields)
+        self.assertEqual(expected, self.batchedReads(run.getReadRange(1, 25), 10, batch))
+
+    def test_AlignmentIterator_nextBatch(self):
+        fields = ("alignmentId", "clippedFragmentBases", "clippedFragmentQualities", "position", "mappingQuality")
+        run = NGS.openReadCollection(PrimaryOnly)
+        expected = []
+        it = run.getAlignments(Alignment.primaryAlignment)
+        while len(expected) < 25 and it.nextAlignment():
+            expected.append((it.getAlignmentId(), it.getClippedFragmentBases(), it.getClippedFragmentQualities(),
+                             it.getAlignmentPosition(), it.getMappingQuality()))
+        batched = []
+        it = run.getAlignments(Alignment.primaryAlignment)
+        batch = None
+        while len(batched) < 25:
+            batch = it.nextBatch(min(10, 25 - len(batched)), fields, batch)
+            self.assertTrue(len(batch) > 0)
+            batched.extend(zip(*[batch.values(name) for name in fields]))
+        self.assertEqual(expected, batched)
+        # the iterator goes on after the batches
+        self.assertTrue(it.nextAlignment())
+        self.assertEqual(PrimaryOnly + ".PA.26", it.getAlignmentId())
+
+    def test_AlignmentIterator_nextBatch_pending(self):
+        fields = ("alignmentId", "clippedFragmentBases")
+        run = NGS.openReadCollection(PrimaryOnly)
+        first = run.getAlignments(Alignment.primaryAlignment).nextBatch(1, fields)
+        batch = AlignmentBatch(4, fields)
+        for i, name in enumerate(AlignmentBatch.stringFields):
+            if name in batch.wanted:
+                batch._allocate(i, len(first.get(name, 0)) + 1)
+        it = run.getAlignments(Alignment.primaryAlignment)
+        batch = it.nextBatch(4, fields, batch)
+        self.assertEqual(1, len(batch))
+        self.assertEqual(first.get("alignmentId", 0), batch.get("alignmentId", 0))
+        self.assertTrue(it.nextAlignment())
+        self.assertEqual(PrimaryOnly + ".PA.2", it.getAlignmentId())
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+import sys
+import gzip
+import struct
+
+# decodes a BAM-file ( BGZF-blocks are gzip-members ) back into SAM-text,
+# used to compare the output of 'sam-dump --bam' with the one of 'sam-dump'
+
+INT_TYPES = { 'c' : 'b', 'C' : 'B', 's' : 'h', 'S' : 'H', 'i' : 'i', 'I' : 'I', 'f' : 'f' }
+
+def reg2bin( beg, end ) :
+	end -= 1
+	for shift, offset in ( ( 14, 4681 ), ( 17, 585 ), ( 20, 73 ), ( 23, 9 ), ( 26, 1 ) ) :
+		if beg >> shift == end >> shift :
+			return offset + ( beg >> shift )
+	return 0
+
+def decode_tags( d, o, end ) :
+	tags = []
+	cigar = None
+	while o < end :
+		tag = d[ o : o + 2 ].decode()
+		t = chr( d[ o + 2 ] )
+		o += 3
+		if t in "cCsSiI" :
+			f = "<" + INT_TYPES[ t ]
+			v, = struct.unpack_from( f, d, o )
+			o += struct.calcsize( f )
+			tags.append( f"{tag}:i:{v}" )
+		elif t == 'A' :
+			tags.append( f"{tag}:A:{chr( d[ o ] )}" )
+			o += 1
+		elif t == 'f' :
+			v, = struct.unpack_from( "<f", d, o )
+			o += 4
+			tags.append( f"{tag}:f:{v:g}" )
+		elif t in "ZH" :
+			e = d.index( b"\0", o )
+			tags.append( f"{tag}:{t}:{d[ o : e ].decode()}" )
+			o = e + 1
+		elif t == 'B' :
+			sub = chr( d[ o ] )
+			n, = struct.unpack_from( "<i", d, o + 1 )
+			o += 5
+			f = "<%d%s" % ( n, INT_TYPES[ sub ] )
+			values = struct.unpack_from( f, d, o )
+			o += struct.calcsize( f )
+			if tag == "CG" :
+				cigar = values
+			else :
+				tags.append( f"{tag}:B:" + ",".join( [ sub ] + [ str( v ) for v in values ] ) )
+		else :
+			raise ValueError( f"unknown tag-type '{t}'" )
+	return tags, cigar
+
+def main( filename ) :
+	d = gzip.open( filename ).read()
+	if d[ : 4 ] != b"BAM\1" :
+		raise ValueError( "not a BAM-file" )
+	l_text, = struct.unpack_from( "<i", d, 4 )
+	sys.stdout.write( d[ 8 : 8 + l_text ].decode() )
+	o = 8 + l_text
+	n_ref, = struct.unpack_from( "<i", d, o )
+	o += 4
+	names = []
+	for i in range( n_ref ) :
+		l_name, = struct.unpack_from( "<i", d, o )
+		names.append( d[ o + 4 : o + 4 + l_name - 1 ].decode() )
+		o += 4 + l_name + 4
+	refname = lambda i : "*" if i < 0 else names[ i ]
+	while o < len( d ) :
+		block_size, = struct.unpack_from( "<i", d, o )
+		end = o + 4 + block_size
+		ref, pos, l_name, mapq, bin, n_cigar, flag, l_seq, next_ref, next_pos, tlen = struct.unpack_from( "<iiBBHHHiiii", d, o + 4 )
+		o += 36
+		qname = d[ o : o + l_name - 1 ].decode()
+		o += l_name
+		ops = struct.unpack_from( "<%dI" % n_cigar, d, o )
+		o += 4 * n_cigar
+		seq = "".join( "=ACMGRSVTWYHKDBN"[ ( d[ o + i // 2 ] >> ( 4 * ( 1 - i % 2 ) ) ) & 15 ] for i in range( l_seq ) )
+		o += ( l_seq + 1 ) // 2
+		qual = d[ o : o + l_seq ]
+		o += l_seq
+		tags, long_cigar = decode_tags( d, o, end )
+		o = end
+		if long_cigar is not None :
+			ops = long_cigar
+		cigar = "".join( "%d%s" % ( op >> 4, "MIDNSHP=X"[ op & 15 ] ) for op in ops )
+		span = sum( op >> 4 for op in ops if ( op & 15 ) in ( 0, 2, 3, 7, 8 ) )
+		expected_bin = 4680 if pos < 0 else reg2bin( pos, pos + max( span, 1 ) )
+		if bin != expected_bin :
+			raise ValueError( f"{qname}: bin is {bin}, expected {expected_bin}" )
+		rnext = "=" if next_ref == ref and ref >= 0 else refname( next_ref )
+		qual = "*" if l_seq == 0 or qual[ 0 ] == 255 else "".join( chr( q + 33 ) for q in qual )
+		fields = [ qname, str( flag ), refname( ref ), str( pos + 1 ), str( mapq ), cigar or "*",
+				   rnext, str( next_pos + 1 ), str( tlen ), seq or "*", qual ]
+		print( "\t".join( fields + tags ) )
+
+if __name__ == '__main__' :
+	main( sys.argv[ 1 ] )
@@ -0,0 +1,89 @@
+#!/usr/bin/env bash
+
+# the goal of this test is to verify that 'sam-dump --bam' produces the same
+# records as the SAM-output of sam-dump, and that the output does not depend
+# on the number of threads ( --threads ) formatting the records and compressing
+# the BGZF-blocks
+#
+# the test uses the short bam_to_sam.py - python-script
+# to decode the BAM-output back into SAM
+#
+# the test also uses the sam-factory-tool to produce a random cSRA-object
+# to be used in this test ( no dependecies on production-runs ! )
+#
+# the test also depends on the bam-load-tool and kar-tool to produce a cSRA-object
+#
+
+set -e
+
+source ./check_bin_tools.sh $1 $2 $3
+
+print_verbose "testing the bam - option for sam-dump"
+print_verbose "-------------------------------------------"
+
+#------------------------------------------------------------
+#produce a random sam-file
+
+RNDSAM="rnd_bam.SAM"
+RNDREF="rnd-bam-ref.fasta"
+
+rm -f "$RNDSAM" "$RNDREF"
+
+#enough alignment-pairs to fill many BGZF-blocks
+$SAMFACTORY << EOF
+r:type=random,name=R1,length=60000
+ref-out:$RNDREF
+sam-out:$RNDSAM
+p:name=A,repeat=20000
+p:name=A,repeat=20000
+EOF
+
+if [[ ! -f "$RNDSAM" ]]; then
+    echo "$RNDSAM not produced"
+    exit 3
+fi
+
+print_verbose "random SAM-file produced!"
+
+RNDCSRA="rnd_bam_csra"
+source ./sam_to_csra.sh $RNDSAM $RNDREF $RNDCSRA
+rm $RNDSAM $RNDREF
+
+#------------------------------------------------------------
+#run sam-dump with SAM- and with BAM-output
+
+SAM_OUT="dumped.SAM"
+BAM_OUT="dumped.BAM"
+BAM_MT="dumped_multi_thread.BAM"
+BAM_DECODED="decoded.SAM"
+
+for OPTS in "-u" "-u --with-md-flag" "-u --unaligned-spots-only"
+do
+    $SAMDUMP $RNDCSRA $OPTS > $SAM_OUT
+    $SAMDUMP $RNDCSRA $OPTS --bam > $BAM_OUT
+    $SAMDUMP $RNDCSRA $OPTS --bam --threads 4 > $BAM_MT
+
+    if ! cmp -s $BAM_OUT $BAM_MT ; then
+        echo "T1:BAM-output ( $OPTS ) differs between single- and multi-threaded"
+        exit 3
+    fi
+    print_verbose "BAM-output ( $OPTS ) does not depend on the number of threads"
+
+    ./bam_to_sam.py $BAM_OUT > $BAM_DECODED
+    if [[ "$OPTS" == *unaligned-spots-only* ]]; then
+        #the BAM-output needs the header even if only unaligned reads are dumped
+        grep -v '^@' $BAM_DECODED > $BAM_DECODED.tmp
+        mv $BAM_DECODED.tmp $BAM_DECODED
+    fi
+    if ! diff -q $SAM_OUT $BAM_DECODED > /dev/null ; then
+        echo "T2:decoded BAM-output ( $OPTS ) differs from the SAM-output"
+        diff $SAM_OUT $BAM_DECODED | head -n 10
+        exit 3
+    fi
+    print_verbose "decoded BAM-output ( $OPTS ) matches the SAM-output"
+done
+
+rm $SAM_OUT $BAM_OUT $BAM_MT $BAM_DECODED "$RNDCSRA"
+
+print_verbose "success!"
+print_verbose -e "--------\n"
@@ -0,0 +1,77 @@
+#!/usr/bin/env bash
+
+# the goal of this test is to verify that 'sam-dump --threads N' produces
+# exactly the same output as the single-threaded sam-dump
+#
+# the first reference is longer than one shard ( 4M bases ), some mates are
+# placed across the shard-boundary and some on the other reference, so that
+# the mate-cache of a worker is missed in all the possible ways
+#
+# the test also uses the sam-factory-tool to produce a random cSRA-object
+# to be used in this test ( no dependecies on production-runs ! )
+#
+# the test also depends on the bam-load-tool and kar-tool to produce a cSRA-object
+#
+
+set -e
+
+source ./check_bin_tools.sh $1 $2 $3
+
+print_verbose "testing the threads - option for sam-dump"
+print_verbose "-------------------------------------------"
+
+#------------------------------------------------------------
+#produce a random sam-file
+
+RNDSAM="rnd_threads.SAM"
+RNDREF="rnd-threads-ref.fasta"
+
+rm -f "$RNDSAM" "$RNDREF"
+
+$SAMFACTORY << EOF
+r:type=random,name=R1,length=4500000
+r:type=random,name=R2,length=60000
+ref-out:$RNDREF
+sam-out:$RNDSAM
+p:name=A,ref=R1,repeat=5000
+p:name=A,ref=R1,repeat=5000
+p:name=B,ref=R1,repeat=1000
+p:name=B,ref=R2,repeat=1000
+p:name=C,ref=R1,pos=4194200
+p:name=C,ref=R1,pos=4194400
+p:name=D,ref=R2,repeat=1000
+p:name=D,ref=R2,repeat=1000
+EOF
+
+if [[ ! -f "$RNDSAM" ]]; then
+    echo "$RNDSAM not produced"
+    exit 3
+fi
+
+print_verbose "random SAM-file produced!"
+
+RNDCSRA="rnd_threads_csra"
+source ./sam_to_csra.sh $RNDSAM $RNDREF $RNDCSRA
+rm $RNDSAM $RNDREF
+
+#------------------------------------------------------------
+#run sam-dump single- and multi-threaded
+
+ST_OUT="dumped_single_thread.SAM"
+MT_OUT="dumped_threads.SAM"
+
+for OPTS in "-u" "-u --with-md-flag" "--fastq" ; do
+    $SAMDUMP $RNDCSRA $OPTS > $ST_OUT
+    $SAMDUMP $RNDCSRA $OPTS --threads 4 > $MT_OUT
+    if ! cmp -s $ST_OUT $MT_OUT ; then
+        echo "T1:output of 'sam-dump $OPTS' differs with --threads 4"
+        diff $ST_OUT $MT_OUT | head -n 10
+        exit 3
+    fi
+    print_verbose "output of 'sam-dump $OPTS' does not depend on the number of threads"
+done
+
+rm $ST_OUT $MT_OUT "$RNDCSRA"
+
+print_verbose "success!"
+print_verbose -e "--------\n"
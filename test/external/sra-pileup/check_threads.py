@@ -0,0 +1,49 @@
+#!/usr/bin/env python
+
+import subprocess
+import sys
+import os.path
+
+TOOL = sys.argv [ 1 ]
+
+def check_if_tool_exits( tool ) :
+    if not os.path.exists ( tool ):
+        print ( "\nERROR: Can not find tool : '" + tool + "'\n" )
+        exit ( 1 )
+
+def run_tool( tool, args ) :
+    a = [ tool ]
+    for arg in args :
+        a.append( arg )
+    p = subprocess.Popen ( a, stdout = subprocess.PIPE, stderr = subprocess.PIPE )
+    res  = "".join( chr( x ) for x in p.stdout.read() )
+    if p.wait() != 0 :
+        print ( "error executing tool" )
+        exit( 1 )
+    return res
+
+if sys.version_info[ 0 ] < 3 :
+    print( "does not work with python version < 3!" )
+    sys.exit( 3 )
+
+check_if_tool_exits( TOOL )
+
+ACCESSION = "SRR5486177"
+# longer than one slice ( 4 MB ), to have alignments crossing a slice-boundary
+SLICE1 = "chr1:3000000-7500000"
+SLICE2 = "chr1:9000000-9100000"
+
+step = 0
+for func in [ [], [ "--function", "count" ], [ "--function", "mismatch" ] ] :
+    args = [ ACCESSION, "-r", SLICE1, "-r", SLICE2 ] + func
+
+    step += 1
+    print( "running step " + str( step ) )
+    out1 = run_tool( TOOL, args )
+    out2 = run_tool( TOOL, args + [ "--threads", "4" ] )
+    if out1 != out2 :
+        print ( "error comparison " + str( step ) + " ( " + " ".join( func ) + " ): --threads 4 differs from single-threaded" )
+        exit( 1 )
+
+print ( "[" + os.path.basename ( __file__ ) + "] test passed for tool '" + TOOL + "'" )
+exit( 0 )
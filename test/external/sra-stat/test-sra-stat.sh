@@ -72,6 +72,35 @@ fi
 rm actual/*
 echo quick_bases test is finished
 
+echo threaded_bases:
+
+echo SRR413283 with base composition counted by 4 threads
+NCBI_SETTINGS=/ NCBI_VDB_QUALITY=R ${bin_dir}/${sra_stat} -x --threads 4 SRR413283 > actual/SRR413283
+output=$(diff actual/SRR413283 expected/SRR413283-with-AssemblyStatistics)
+res=$?
+if [ "$res" != "0" ];
+	then echo "threaded_bases test FAILED, res=$res output=$output" && exit 1;
+fi
+
+echo SRR619505 is a cSRA: PRIMARY_ALIGNMENT and SEQUENCE counted by 4 threads
+NCBI_SETTINGS=/ ${bin_dir}/${sra_stat} -x --threads 4 SRR619505 | perl -w strip-path-sdlr.pl > actual/SRR619505
+output=$(diff actual/SRR619505 expected/SRR619505)
+res=$?
+if [ "$res" != "0" ];
+	then echo "threaded_bases test FAILED, res=$res output=$output" && exit 1;
+fi
+
+echo SRR1985136 is a cSRA: PRIMARY_ALIGNMENT and SEQUENCE counted by 3 threads
+NCBI_SETTINGS=/ NCBI_VDB_QUALITY=R ${bin_dir}/${sra_stat} -x --threads 3 SRR1985136 | perl -w strip-path.pl > actual/SRR1985136
+output=$(diff actual/SRR1985136 expected/SRR1985136-with-Changes)
+res=$?
+if [ "$res" != "0" ];
+	then echo "threaded_bases test FAILED, res=$res output=$output" && exit 1;
+fi
+
+rm actual/*
+echo threaded_bases test is finished
+
 R=SRR8483030
 echo test_bases:
 echo ${R} is a run having first 0-lenght bio reads
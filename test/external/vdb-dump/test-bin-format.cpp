@@ -0,0 +1,246 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for vdb-dump's binary columnar output format: writer and reader
+*/
+
+#include "vdb-dump-bin.h"
+#include "vdb-dump-bin-reader.h"
+
+#include <ktst/unit_test.hpp>
+
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+TEST_SUITE ( VdbDumpBinFormatTestSuite );
+
+class BinFixture
+{
+public:
+    BinFixture()
+    {
+        if ( vds_make( & m_out, 0, 1024 ) != 0 )
+        {
+            throw logic_error ( "BinFixture: vds_make() failed" );
+        }
+        memset( & m_reader, 0, sizeof m_reader );
+        memset( & m_group, 0, sizeof m_group );
+    }
+    ~BinFixture()
+    {
+        vdbbr_group_free( & m_group );
+        vdbbr_close( & m_reader );
+        vds_free( & m_out );
+    }
+
+    rc_t WriteHeader()
+    {
+        vdbb_col_desc cols[ 3 ] =
+        {
+            { "READ",     4, 8,  1 },  /* ascii */
+            { "READ_LEN", 1, 32, 1 },  /* uint32 */
+            { "BITS",     1, 1,  1 },  /* 1-bit values */
+        };
+        return vdbb_write_header( & m_out, 3, cols );
+    }
+
+    dump_str m_out;
+    vdbbr_reader m_reader;
+    vdbbr_group m_group;
+};
+
+TEST_CASE ( Header_NullParams )
+{
+    vdbb_col_desc col = { "A", 1, 8, 1 };
+    REQUIRE_RC_FAIL ( vdbb_write_header( NULL, 1, & col ) );
+    vdbbr_reader r;
+    REQUIRE_RC_FAIL ( vdbbr_open( & r, NULL, 0 ) );
+}
+
+FIXTURE_TEST_CASE ( Header_RoundTrip, BinFixture )
+{
+    REQUIRE_RC ( WriteHeader() );
+    REQUIRE_RC ( vdbb_write_trailer( & m_out ) );
+
+    REQUIRE_RC ( vdbbr_open( & m_reader, m_out . buf, m_out . str_len ) );
+    REQUIRE_EQ ( ( uint32_t )VDBB_VERSION, m_reader . version );
+    REQUIRE_EQ ( 3u, m_reader . num_cols );
+    REQUIRE_EQ ( string( "READ" ), string( m_reader . cols[ 0 ] . name, m_reader . cols[ 0 ] . name_len ) );
+    REQUIRE_EQ ( string( "READ_LEN" ), string( m_reader . cols[ 1 ] . name, m_reader . cols[ 1 ] . name_len ) );
+    REQUIRE_EQ ( 32u, m_reader . cols[ 1 ] . intrinsic_bits );
+    REQUIRE_EQ ( 4u, m_reader . cols[ 0 ] . domain );
+
+    bool done = false;
+    REQUIRE_RC ( vdbbr_next_group( & m_reader, & m_group, & done ) );
+    REQUIRE ( done );
+}
+
+FIXTURE_TEST_CASE ( Header_BadMagic, BinFixture )
+{
+    REQUIRE_RC ( WriteHeader() );
+    m_out . buf[ 0 ] = 'X';
+    REQUIRE_RC_FAIL ( vdbbr_open( & m_reader, m_out . buf, m_out . str_len ) );
+}
+
+FIXTURE_TEST_CASE ( Header_Truncated, BinFixture )
+{
+    REQUIRE_RC ( WriteHeader() );
+    REQUIRE_RC_FAIL ( vdbbr_open( & m_reader, m_out . buf, m_out . str_len - 1 ) );
+}
+
+FIXTURE_TEST_CASE ( Group_RoundTrip, BinFixture )
+{
+    REQUIRE_RC ( WriteHeader() );
+
+    vdbb_group g;
+    REQUIRE_RC ( vdbb_group_init( & g, 3 ) );
+
+    /* row 10: READ="ACGT", READ_LEN=4, BITS=101 starting at bit-offset 3 */
+    const uint32_t len10 = 4;
+    const uint8_t bits10 = 0x14; /* 0b00010100 : bits 3..5 = 1,0,1 ( MSB first ) */
+    REQUIRE_RC ( vdbb_group_add_row( & g, 10 ) );
+    REQUIRE_RC ( vdbb_group_add_cell( & g, 0, "ACGT", 0, 8, 4 ) );
+    REQUIRE_RC ( vdbb_group_add_cell( & g, 1, & len10, 0, 32, 1 ) );
+    REQUIRE_RC ( vdbb_group_add_cell( & g, 2, & bits10, 3, 1, 3 ) );
+
+    /* row 12: empty READ, unreadable READ_LEN, no BITS */
+    REQUIRE_RC ( vdbb_group_add_row( & g, 12 ) );
+    REQUIRE_RC ( vdbb_group_add_cell( & g, 0, "", 0, 8, 0 ) );
+    REQUIRE_RC ( vdbb_group_add_cell( & g, 1, NULL, 0, 32, 1 ) );
+    REQUIRE_RC ( vdbb_group_add_cell( & g, 2, & bits10, 0, 1, 0 ) );
+
+    REQUIRE_RC ( vdbb_group_write( & g, & m_out ) );
+    vdbb_group_free( & g );
+    REQUIRE_RC ( vdbb_write_trailer( & m_out ) );
+
+    REQUIRE_RC ( vdbbr_open( & m_reader, m_out . buf, m_out . str_len ) );
+    bool done = true;
+    REQUIRE_RC ( vdbbr_next_group( & m_reader, & m_group, & done ) );
+    REQUIRE ( ! done );
+    REQUIRE_EQ ( 2u, m_group . row_count );
+    REQUIRE_EQ ( ( int64_t )10, vdbbr_row_id( & m_group, 0 ) );
+    REQUIRE_EQ ( ( int64_t )12, vdbbr_row_id( & m_group, 1 ) );
+
+    vdbbr_cell_iter it;
+    const void * data;
+    uint32_t count;
+    size_t bytes;
+
+    REQUIRE_RC ( vdbbr_cell_iter_init( & it, & m_reader, & m_group, 0 ) );
+    REQUIRE ( vdbbr_cell_iter_next( & it, & data, & count, & bytes ) );
+    REQUIRE_EQ ( 4u, count );
+    REQUIRE_EQ ( string( "ACGT" ), string( ( const char * )data, bytes ) );
+    REQUIRE ( vdbbr_cell_iter_next( & it, & data, & count, & bytes ) );
+    REQUIRE_EQ ( 0u, count );
+    REQUIRE ( ! vdbbr_cell_iter_next( & it, & data, & count, & bytes ) );
+
+    REQUIRE_RC ( vdbbr_cell_iter_init( & it, & m_reader, & m_group, 1 ) );
+    REQUIRE ( vdbbr_cell_iter_next( & it, & data, & count, & bytes ) );
+    REQUIRE_EQ ( 1u, count );
+    uint32_t value;
+    memcpy( & value, data, sizeof value );
+    REQUIRE_EQ ( 4u, value );
+    REQUIRE ( vdbbr_cell_iter_next( & it, & data, & count, & bytes ) );
+    REQUIRE_EQ ( 0u, count );
+
+    /* the bits are shifted to the start of a byte and padded with zeros */
+    REQUIRE_RC ( vdbbr_cell_iter_init( & it, & m_reader, & m_group, 2 ) );
+    REQUIRE ( vdbbr_cell_iter_next( & it, & data, & count, & bytes ) );
+    REQUIRE_EQ ( 3u, count );
+    REQUIRE_EQ ( ( size_t )1, bytes );
+    REQUIRE_EQ ( ( int )0xA0, ( int )*( const uint8_t * )data );
+
+    vdbbr_group_free( & m_group );
+    REQUIRE_RC ( vdbbr_next_group( & m_reader, & m_group, & done ) );
+    REQUIRE ( done );
+}
+
+FIXTURE_TEST_CASE ( Group_MissingCell, BinFixture )
+{
+    vdbb_group g;
+    REQUIRE_RC ( vdbb_group_init( & g, 2 ) );
+    REQUIRE_RC ( vdbb_group_add_row( & g, 1 ) );
+    REQUIRE_RC ( vdbb_group_add_cell( & g, 0, "A", 0, 8, 1 ) );
+    /* no cell for column #1 */
+    REQUIRE_RC_FAIL ( vdbb_group_write( & g, & m_out ) );
+    REQUIRE_RC_FAIL ( vdbb_group_add_cell( & g, 2, "A", 0, 8, 1 ) );
+    vdbb_group_free( & g );
+}
+
+FIXTURE_TEST_CASE ( Group_Truncated, BinFixture )
+{
+    REQUIRE_RC ( WriteHeader() );
+    vdbb_group g;
+    REQUIRE_RC ( vdbb_group_init( & g, 3 ) );
+    const uint32_t len = 2;
+    REQUIRE_RC ( vdbb_group_add_row( & g, 1 ) );
+    REQUIRE_RC ( vdbb_group_add_cell( & g, 0, "AC", 0, 8, 2 ) );
+    REQUIRE_RC ( vdbb_group_add_cell( & g, 1, & len, 0, 32, 1 ) );
+    REQUIRE_RC ( vdbb_group_add_cell( & g, 2, & len, 0, 1, 2 ) );
+    REQUIRE_RC ( vdbb_group_write( & g, & m_out ) );
+    vdbb_group_free( & g );
+    /* no trailer */
+
+    REQUIRE_RC ( vdbbr_open( & m_reader, m_out . buf, m_out . str_len - 1 ) );
+    bool done = false;
+    REQUIRE_RC_FAIL ( vdbbr_next_group( & m_reader, & m_group, & done ) );
+    REQUIRE ( ! done );
+}
+
+//////////////////////////////////////////// Main
+extern "C"
+{
+
+#include <kapp/args.h>
+#include <kfg/config.h>
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+rc_t CC UsageSummary (const char * progname)
+{
+    return 0;
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return 0;
+}
+
+const char UsageDefaultName[] = "test-bin-format";
+
+rc_t CC KMain ( int argc, char *argv [] )
+{
+    KConfigDisableUserSettings();
+    rc_t rc=VdbDumpBinFormatTestSuite(argc, argv);
+    return rc;
+}
+
+}
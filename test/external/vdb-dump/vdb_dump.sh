@@ -53,6 +53,34 @@ function run_test_neg() {
 	echo run_test $test_id done
 }
 
+# compares the output of a multi-threaded dump with the single-threaded one
+function run_test_mt() {
+	local test_id=$1
+	local test_args=$2
+
+	local expected=actual/$test_id.st.stdout
+	local output=actual/$test_id.mt.stdout
+
+	${bin_dir}/${vdb_dump_binary} $test_args > $expected 2>actual/$test_id.st.stderr
+	local res=$?
+	if [ "$res" != "0" ];
+		then echo "${vdb_dump_binary} $test_args ($test_name $test_id) FAILED, res=$res output=$expected" && exit 1;
+	fi
+
+	${bin_dir}/${vdb_dump_binary} $test_args --threads 4 > $output 2>actual/$test_id.mt.stderr
+	res=$?
+	if [ "$res" != "0" ];
+		then echo "${vdb_dump_binary} $test_args --threads 4 ($test_name $test_id) FAILED, res=$res output=$output" && exit 1;
+	fi
+
+	diff $expected $output >actual/$test_id.diff
+	res=$?
+	if [ "$res" != "0" ];
+		then echo "${vdb_dump_binary} $test_name ($test_id) FAILED, res=$res diff=$(cat actual/$test_id.diff)" && exit 1;
+	fi
+	echo run_test_mt $test_id done
+}
+
 #TODO: fail if multiple tables and/or views are requested
 
 # output format
@@ -114,6 +142,25 @@ run_test "6.1" "data/ViewDatabase -T VIEW3"
 # 7.0 symbolic names for various platforms
 run_test "7.0" "input/platforms -C PLATFORM"
 
+# 8.x multi-threaded dump produces the same output as the single-threaded one
+run_test_mt "8.0" "SRR056386 -R 1-5000"
+run_test_mt "8.1" "SRR056386 -R 1-5000 -f csv -I"
+run_test_mt "8.2" "SRR056386 -R 1-5000 -f tab"
+run_test_mt "8.3" "SRR056386 -R 1-5000 -f json"
+run_test_mt "8.4" "SRR056386 -R 1-5000 -f xml"
+run_test_mt "8.5" "SRR056386 -R 1-100,2000-4000,4500 -f piped"
+# binary output contains NULs, it has to be written by length
+run_test_mt "8.6" "SRR056386 -R 1-5000 -f bin"
+run_test_mt "8.7" "SRR056386 -R 1-100,2000-4000,4500 -C READ,QUALITY,READ_LEN -f bin"
+# the fastq/fasta/qual formats have their own loops
+run_test_mt "8.8" "SRR056386 -R 1-5000 -f fastq"
+run_test_mt "8.9" "SRR056386 -R 1-100,2000-4000,4500 -f fastq1"
+run_test_mt "8.10" "SRR056386 -R 1-5000 -f fasta"
+run_test_mt "8.11" "SRR056386 -R 1-5000 -f qual"
+run_test_mt "8.12" "SRR056386 -R 1-100,2000-4000,4500 -f qual1"
+# fasta1 records span many rows: --threads is ignored
+run_test_mt "8.13" "SRR056386 -R 1-3000 -f fasta1"
+
 rm -rf actual
 # keep the test database for the other tests that might follow (e.g. Test_Vdb_dump_view-alias - see CMakeLists.txt)
 #rm -rf data
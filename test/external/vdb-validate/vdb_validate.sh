@@ -74,6 +74,15 @@ mkdir -p actual/
 	                ${TEST_DATA}/SRR1207586-READ_LEN-vs-READ-mismatch \
 	                -Cyes" READ_LEN 3 ; fi
 
+	# the multi-threaded checks have to come to the same verdict
+	# ( the order of the messages is not deterministic, check the exit code only )
+	if ! ${bin_dir}/${vdb_validate} db/sdc_len_mismatch.csra --threads 4 \
+	     > actual/threads 2>&1; \
+	 then echo "${vdb_validate} --threads 4 FAILED" && cat actual/threads && exit 1; fi
+	if ${bin_dir}/${vdb_validate} db/sdc_tmp_mismatch.csra --sdc:rows 100% --threads 4 \
+	     > actual/threads 2>&1; \
+	 then echo "${vdb_validate} --threads 4 should fail" && exit 1; fi
+
 	# verify failure verifying ancient no-schema run
 	if ${bin_dir}/${vdb_validate} db/SRR053325-no-schema 2> actual/noschema; \
 	 then echo ${vdb_validate} no-schema-run should fail; exit 1; fi
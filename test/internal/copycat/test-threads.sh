@@ -0,0 +1,24 @@
+#!/bin/bash
+
+bin_dir=$1
+tool_binary=$2
+FILE="big.txt"
+
+echo "testing ${tool_binary} md5 on hashing threads"
+mkdir -p actual
+rm -f actual/${FILE} actual/threads-*.out
+
+# large enough to be handed to a hashing thread
+for i in $(seq 1 100000); do echo "line ${i} of a file large enough to be hashed on a thread"; done > actual/${FILE}
+
+output=$(${bin_dir}/${tool_binary} actual/${FILE} /dev/null | sed -rn 's/^(.*) mtime="([[:print:]]{20,20})"(.*)/\1\3/p' > actual/threads-0.out &&
+         ${bin_dir}/${tool_binary} --threads 4 actual/${FILE} /dev/null | sed -rn 's/^(.*) mtime="([[:print:]]{20,20})"(.*)/\1\3/p' > actual/threads-4.out &&
+         diff -q actual/threads-0.out actual/threads-4.out &&
+         grep -q "md5=\"$(md5sum actual/${FILE} | cut -d ' ' -f 1)\"" actual/threads-4.out)
+
+res=$?
+if [ "$res" != "0" ];
+	then echo "${tool_binary} md5 on hashing threads failed, res=${res} output=${output}" && exit 1;
+fi
+
+echo "${tool_binary} md5 on hashing threads succeeded"
@@ -15,12 +15,14 @@ fi
 
 ACC="$2"
 ACC_COPY="the_copy"
+# the remaining arguments are passed to vdb-copy
+shift 2
 
 if [ -d $ACC_COPY ]; then
     rm -rf $ACC_COPY
 fi
 
-$VDB_COPY $ACC $ACC_COPY -p
+$VDB_COPY $ACC $ACC_COPY -p "$@"
 
 VDB_DIFF="vdb-diff"
 if [ ! -x $VDB_DIFF ]; then
@@ -0,0 +1,36 @@
+#!/bin/bash
+set -e
+
+# the i_name index of a cSRA REFERENCE table is built by the write-cursor,
+# a copy has to be able to look up the references by name
+
+TOOL_PATH="$1"
+ACC="$2"
+ACC_COPY="the_indexed_copy"
+
+VDB_COPY="vdb-copy"
+if [ ! -x $VDB_COPY ]; then
+    VDB_COPY="${TOOL_PATH}/$VDB_COPY"
+fi
+
+VDB_DUMP="vdb-dump"
+if [ ! -x $VDB_DUMP ]; then
+    VDB_DUMP="${TOOL_PATH}/$VDB_DUMP"
+fi
+
+if [ ! -x $VDB_COPY ] || [ ! -x $VDB_DUMP ]; then
+    echo "cannot find executable for vdb-copy or vdb-dump"
+    exit 3
+fi
+
+if [ -d $ACC_COPY ]; then
+    rm -rf $ACC_COPY
+fi
+
+$VDB_COPY $ACC $ACC_COPY
+
+$VDB_DUMP $ACC -T REFERENCE --idx-range i_name > $ACC.i_name.expected
+$VDB_DUMP $ACC_COPY -T REFERENCE --idx-range i_name > $ACC.i_name.actual
+diff $ACC.i_name.expected $ACC.i_name.actual
+
+rm -rf $ACC_COPY $ACC.i_name.expected $ACC.i_name.actual
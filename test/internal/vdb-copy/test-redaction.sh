@@ -56,7 +56,13 @@ SCRATCH=$(mktemp -d) || exit 1
 
     # Verify that redaction worked. awk will exit 3 if any redacted spot's sequence has anything but N
     "${VDB_DUMP}" -f tab 'test-data-redacted' -C"READ_FILTER,(INSDC:dna:text)READ" | \
-        awk 'BEGIN{ FS="\t" } $1~/REDACTED/ && $2~/[^N]/ {exit 3}'
+        awk 'BEGIN{ FS="\t" } $1~/REDACTED/ && $2~/[^N]/ {exit 3}' || exit $?
+
+    # The same with multiple threads decoding the source.
+    "${VDB_COPY}" -k "${CONFIG_PATH}" --threads 4 'test-data' 'test-data-redacted-mt' || exit $?
+    "${VDB_DUMP}" -f tab 'test-data-redacted' > 'redacted.txt' || exit $?
+    "${VDB_DUMP}" -f tab 'test-data-redacted-mt' > 'redacted-mt.txt' || exit $?
+    diff -q 'redacted.txt' 'redacted-mt.txt'
 )
 ec=$?
 rm -rf "${SCRATCH}"
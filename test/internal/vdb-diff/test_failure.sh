@@ -1,11 +1,12 @@
 BINDIR=$1
 ACCESSION=$2
 vdb_diff=$3
+shift 3
 
 rm -rf A1 A2
 $BINDIR/vdb-copy $ACCESSION A1 -R 1-10
 $BINDIR/vdb-copy $ACCESSION A2 -R 1,3-11
-$BINDIR/${vdb_diff} A1 A2
+$BINDIR/${vdb_diff} A1 A2 "$@"
 RESULT="$?"
 rm -rf A1 A2
 
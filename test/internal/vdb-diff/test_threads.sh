@@ -0,0 +1,30 @@
+BINDIR=$1
+ACCESSION=$2
+vdb_diff=$3
+shift 3
+
+# the rows of A2 are shifted by one: every row differs,
+# the output of --threads has to be the same as the one of the serial diff
+rm -rf A1 A2 serial.txt threads.txt
+$BINDIR/vdb-copy $ACCESSION A1 -R 1-10000
+$BINDIR/vdb-copy $ACCESSION A2 -R 2-10001
+
+RESULT=0
+for MAXERR in 1 100 100000; do
+    $BINDIR/${vdb_diff} A1 A2 -e $MAXERR "$@" > serial.txt
+    $BINDIR/${vdb_diff} A1 A2 -e $MAXERR --threads 4 "$@" > threads.txt
+    if ! cmp -s serial.txt threads.txt; then
+        echo "output of --threads 4 differs from the serial output ( maxerr = $MAXERR )"
+        diff serial.txt threads.txt | head -20
+        RESULT=1
+    fi
+done
+rm -rf A1 A2 serial.txt threads.txt
+
+if [ $RESULT -eq 0 ]; then
+    echo "test (--threads output equals serial output) passed for $BINDIR/vdb-diff"
+else
+    echo "test (--threads output equals serial output) failed for $BINDIR/vdb-diff"
+fi
+
+exit $RESULT
@@ -0,0 +1,77 @@
+#!/bin/bash
+
+# verifies that loading with --threads produces the same tables as the serial load
+#
+# $1 ... directory of the binaries
+# $2 ... directory of the schema-files
+# $3 ... directory with the PacBio HDF5-files to load
+
+BIN_DIR="$1"
+VDB_INCDIR="$2"
+SRC_DIR="$3"
+
+PACBIO_LOAD="${BIN_DIR}/pacbio-load"
+VDB_DUMP="${BIN_DIR}/vdb-dump"
+TMP_DIR="./tmp_pacbio_load"
+
+echo "testing ${PACBIO_LOAD} with --threads"
+
+if [ ! -x "${PACBIO_LOAD}" ]; then
+    echo "${PACBIO_LOAD} not found, skipping the test"
+    exit 0
+fi
+
+rm -rf "${TMP_DIR}"
+mkdir -p "${TMP_DIR}"
+
+cat << END > "${TMP_DIR}/tmp.kfg"
+/vdb/schema/paths = "${VDB_INCDIR}"
+END
+export VDB_CONFIG="${TMP_DIR}"
+
+# $1 ... source, $2 ... output, $3 ... additional options
+load() {
+    ${PACBIO_LOAD} "$1" -o "$2" $3 > "$2.log" 2>&1
+    if [ "$?" != "0" ]; then
+        echo "pacbio-load $3 failed on $1:"
+        cat "$2.log"
+        exit 1
+    fi
+}
+
+# $1 ... loaded database, $2 ... file to write the dump into
+dump() {
+    for TBL in SEQUENCE CONSENSUS PASSES METRICS; do
+        echo "table ${TBL}"
+        ${VDB_DUMP} "$1" -T ${TBL} 2>/dev/null
+    done > "$2"
+}
+
+COUNT=0
+for SRC in "${SRC_DIR}"/*.h5; do
+    [ -f "${SRC}" ] || continue
+    NAME=$(basename "${SRC}" .h5)
+
+    load "${SRC}" "${TMP_DIR}/${NAME}.serial" ""
+    dump "${TMP_DIR}/${NAME}.serial" "${TMP_DIR}/${NAME}.serial.txt"
+
+    for THREADS in 2 4; do
+        OUT="${TMP_DIR}/${NAME}.t${THREADS}"
+        load "${SRC}" "${OUT}" "--threads ${THREADS}"
+        dump "${OUT}" "${OUT}.txt"
+        diff -q "${TMP_DIR}/${NAME}.serial.txt" "${OUT}.txt" > /dev/null
+        if [ "$?" != "0" ]; then
+            echo "pacbio-load --threads ${THREADS} differs from the serial load of ${SRC}"
+            exit 1
+        fi
+    done
+    COUNT=$((COUNT + 1))
+done
+
+if [ "${COUNT}" == "0" ]; then
+    echo "no *.h5 files found in '${SRC_DIR}'"
+    exit 1
+fi
+
+rm -rf "${TMP_DIR}"
+echo "pacbio-load --threads test passed on ${COUNT} source(s)"
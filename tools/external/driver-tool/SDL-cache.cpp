@@ -0,0 +1,213 @@
+/* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* Project:
+*  sratools command line tool
+*
+* Purpose:
+ *  On-disk cache of resolved SDL query results
+*
+*/
+
+#include "util.hpp"
+
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cctype>
+
+#include "debug.hpp"
+#include "uuid.hpp"
+#include "SDL-cache.hpp"
+
+namespace sratools {
+
+static char const magic[] = "SDL-cache 1";
+
+/// @brief FNV-1a, only used to make file names, the key is checked on read
+static uint64_t hashOf(std::string const &key)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (auto ch : key) {
+        h ^= (uint8_t)ch;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+std::string SDL_Cache::pathFor(std::string const &query) const
+{
+    static char const hexdigits[] = "0123456789abcdef";
+    auto result = directory;
+    auto h = hashOf(keyFor(query));
+    char hex[17];
+
+    if (!result.empty() && result.back() != '/')
+        result += '/';
+    for (auto ch : query.substr(0, 64)) {
+        result += (isalnum((unsigned char)ch) || ch == '.' || ch == '_' || ch == '-') ? ch : '_';
+    }
+    for (auto i = 16; i > 0; h >>= 4)
+        hex[--i] = hexdigits[h & 0x0F];
+    hex[16] = '\0';
+    return result + '-' + hex + ".sdl";
+}
+
+bool SDL_Cache::isSDLKey(std::string const &key)
+{
+    return key == "accession" || key == "remote"
+        || starts_with("SDL/", key) || starts_with("remote/", key);
+}
+
+static bool isCivil(int year, int month, int day, int hour, int minute, int second)
+{
+    return year >= 1970 && 1 <= month && month <= 12 && 1 <= day && day <= 31
+        && 0 <= hour && hour < 24 && 0 <= minute && minute < 60 && 0 <= second && second <= 60;
+}
+
+/// @brief days since 1970-01-01 in the proleptic Gregorian calendar
+static long daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2 ? 1 : 0;
+    long const era = year / 400;
+    long const yoe = year - era * 400;
+    long const doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+std::time_t SDL_Cache::parseTimestamp(std::string const &timestamp)
+{
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+
+    if (std::sscanf(timestamp.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d", &year, &month, &day, &hour, &minute, &second) != 6)
+        return -1;
+    if (!isCivil(year, month, day, hour, minute, second))
+        return -1;
+    return (std::time_t)(((daysFromCivil(year, month, day) * 24 + hour) * 60 + minute) * 60 + second);
+}
+
+bool SDL_Cache::get(std::string const &query, Dictionary &info, std::time_t now) const
+{
+    auto const path = pathFor(query);
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    std::string line;
+    if (!std::getline(file, line) || line != magic)
+        return false;
+    if (!std::getline(file, line) || line != "key\t" + keyFor(query))
+        return false; // hash collision or a different context
+
+    if (!std::getline(file, line) || !starts_with("expires\t", line))
+        return false;
+    auto const expires = std::strtoll(line.c_str() + 8, nullptr, 10);
+    if (expires <= (long long)now) {
+        LOG(5) << "SDL cache entry for " << query << " has expired." << std::endl;
+        file.close();
+        std::remove(path.c_str());
+        return false;
+    }
+
+    Dictionary values;
+    while (std::getline(file, line)) {
+        if (line == ".") {
+            for (auto const &v : values)
+                info[v.first] = v.second;
+            LOG(5) << "Using SDL cache entry for " << query << " from " << path << std::endl;
+            return true;
+        }
+        auto const sep = line.find('\t');
+        if (sep == std::string::npos)
+            break;
+        values[line.substr(0, sep)] = line.substr(sep + 1);
+    }
+    LOG(2) << "SDL cache entry " << path << " is incomplete, ignoring it." << std::endl;
+    return false;
+}
+
+bool SDL_Cache::put(std::string const &query, Dictionary const &info, opt_string const &expiration, std::time_t now) const
+{
+    auto expires = (long long)now + ttl;
+    if (expiration) {
+        auto const urlExpires = parseTimestamp(expiration.value());
+        if (urlExpires < 0) {
+            LOG(3) << "Can't parse expiration date '" << expiration.value() << "', not caching " << query << std::endl;
+            return false;
+        }
+        if ((long long)urlExpires - expirationMargin < expires)
+            expires = (long long)urlExpires - expirationMargin;
+    }
+    if (expires <= (long long)now)
+        return false;
+
+    auto const path = pathFor(query);
+    auto const temp = path + "." + uuid();
+    {
+        std::ofstream file(temp);
+        if (!file) {
+            LOG(2) << "Can't write SDL cache entry " << temp << std::endl;
+            return false;
+        }
+        file << magic << '\n'
+             << "key\t" << keyFor(query) << '\n'
+             << "expires\t" << expires << '\n';
+        for (auto const &v : info) {
+            if (!isSDLKey(v.first))
+                continue;
+            if (v.second.find_first_of("\t\n") != std::string::npos) {
+                file.close();
+                std::remove(temp.c_str());
+                return false;
+            }
+            file << v.first << '\t' << v.second << '\n';
+        }
+        file << ".\n";
+        file.flush();
+        if (!file) {
+            LOG(2) << "Failed writing SDL cache entry " << temp << std::endl;
+            file.close();
+            std::remove(temp.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+#if WINDOWS
+        // rename does not replace an existing file on Windows
+        std::remove(path.c_str());
+        if (std::rename(temp.c_str(), path.c_str()) == 0)
+            return true;
+#endif
+        LOG(2) << "Can't rename SDL cache entry " << temp << " to " << path << std::endl;
+        std::remove(temp.c_str());
+        return false;
+    }
+    LOG(6) << "Saved SDL cache entry for " << query << " to " << path << std::endl;
+    return true;
+}
+
+}
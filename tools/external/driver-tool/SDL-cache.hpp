@@ -0,0 +1,92 @@
+/* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* Project:
+*  sratools command line tool
+*
+* Purpose:
+ *  On-disk cache of resolved SDL query results
+*
+*/
+
+#pragma once
+
+#include <string>
+#include <ctime>
+#include "util.hpp"
+#include "opt_string.hpp"
+
+namespace sratools {
+
+/// @brief A directory of resolved SDL query results, one file per query.
+///
+/// Entries are keyed by the query and a context string that captures
+/// everything else that affects the answer (resolver, location, quality
+/// preference, CE token). Each entry expires at the earlier of the
+/// configured TTL and the expiration of the URLs in it. Entries are
+/// written to a temporary file and renamed into place, so concurrent
+/// readers see either the old or the new entry, never a partial one.
+class SDL_Cache {
+    std::string directory;
+    std::string context;
+    long ttl;
+
+    std::string keyFor(std::string const &query) const {
+        return query + '\t' + context;
+    }
+public:
+    /// @brief default lifetime of an entry in seconds
+    static long constexpr defaultTTL = 3600;
+    /// @brief entries are not used this close to URL expiration
+    static long constexpr expirationMargin = 60;
+
+    SDL_Cache(std::string const &directory, std::string const &context, long ttl = defaultTTL)
+    : directory(directory)
+    , context(context)
+    , ttl(ttl)
+    {}
+
+    /// @brief the file that holds the entry for the query
+    std::string pathFor(std::string const &query) const;
+
+    /// @brief look up an unexpired entry for the query
+    /// @param info receives the cached values
+    /// @returns true if found
+    bool get(std::string const &query, Dictionary &info, std::time_t now = std::time(nullptr)) const;
+
+    /// @brief save the SDL values for a query
+    /// @param info the values for the query, only the SDL derived values are saved
+    /// @param expiration the earliest expiration date of the URLs (if any)
+    /// @returns true if saved
+    bool put(std::string const &query, Dictionary const &info, opt_string const &expiration, std::time_t now = std::time(nullptr)) const;
+
+    /// @brief true if the key is one that comes from SDL
+    static bool isSDLKey(std::string const &key);
+
+    /// @brief convert an ISO-8601 UTC timestamp, e.g. 2021-07-09T15:29:33Z
+    /// @returns seconds since the epoch, or -1 if it can't be parsed
+    static std::time_t parseTimestamp(std::string const &timestamp);
+};
+
+}
@@ -82,6 +82,16 @@ public:
     bool canUseSDL() const {
         return !isRemoteAccessDisabled();
     }
+
+    /// @brief directory for caching SDL results (if any)
+    opt_string SDLCacheDirectory() const {
+        return get("/repository/remote/SDL-cache/path");
+    }
+
+    /// @brief lifetime in seconds of cached SDL results (if set)
+    opt_string SDLCacheTTL() const {
+        return get("/repository/remote/SDL-cache/ttl");
+    }
 };
 
 }
@@ -33,6 +33,8 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <utility>
 #include "util.hpp"
 #include "file-path.hpp"
 #include "command-line.hpp"
@@ -112,6 +114,20 @@ struct Process_ : protected IMPL {
     ExitStatus wait() const {
         return IMPL::wait();
     }
+#if !WINDOWS
+    /// @brief Wait for any one of the children to finish.
+    ///
+    /// @return The index in children of the one that finished, and its exit status.
+    static std::pair<size_t, ExitStatus> waitAny(std::vector<Process_> const &children) {
+        auto impls = std::vector<IMPL>();
+        impls.reserve(children.size());
+        for (auto && child : children)
+            impls.push_back(static_cast<IMPL const &>(child));
+
+        auto const result = IMPL::waitAny(impls);
+        return { result.first, ExitStatus(result.second) };
+    }
+#endif
 
     static void runChild [[noreturn]] (FilePath const &toolPath, std::string const &toolName, char const *const *argv, Dictionary const &env = {})
     {
@@ -133,6 +149,8 @@ struct Process_ : protected IMPL {
 #endif
 
 private:
+    Process_(IMPL const &impl) : IMPL(impl) {}
+
 #if USE_WIDE_API
     using API_Char = wchar_t;
     static API_Char const *const *args(CommandLine const &cmd) { return cmd.wargv; }
@@ -148,9 +166,8 @@ private:
         return toolName == "fastq-dump" ? "-V" : "--version";
     }
 #endif
-public:
-    
-    static ExitStatus runTool(CommandLine const &cmd, UniqueOrderedList<int> const &skip, Dictionary const &env)
+    /// @brief The tool's argv: the command line, less the skipped arguments; it is null terminated.
+    static std::vector<API_Char const *> toolArgs(CommandLine const &cmd, UniqueOrderedList<int> const &skip)
     {
         auto j = skip.begin();
         auto const srcArgs = args(cmd);
@@ -166,9 +183,31 @@ public:
                 ++j;
         }
         args.push_back(nullptr);
-        
+        return args;
+    }
+public:
+    
+    static ExitStatus runTool(CommandLine const &cmd, UniqueOrderedList<int> const &skip, Dictionary const &env)
+    {
+        auto const args = toolArgs(cmd, skip);
         return runChildAndWait(cmd.toolPath, cmd.toolName, args.data(), env);
     }
+#if !WINDOWS
+    /// @brief Like runTool, but does not wait for the tool to finish.
+    ///
+    /// @param extra More arguments for the tool, appended after the ones from the command line.
+    static Process_ spawnTool(CommandLine const &cmd, UniqueOrderedList<int> const &skip, Dictionary const &env, std::vector<std::string> const &extra = {})
+    {
+        auto args = toolArgs(cmd, skip);
+
+        args.pop_back();
+        for (auto && arg : extra)
+            args.push_back(arg.c_str());
+        args.push_back(nullptr);
+
+        return Process_(IMPL::spawnChild(cmd.toolPath, cmd.toolName, args.data(), env));
+    }
+#endif
     static void execVersion [[noreturn]] (CommandLine const &cmd)
     {
         API_Char const *args[] = {
@@ -43,6 +43,7 @@
 #include <memory>
 #include <functional>
 #include <atomic>
+#include <algorithm>
 
 #include <cstdlib>
 #include <cstdio>
@@ -143,13 +144,19 @@ static void exec [[noreturn]] (FilePath const &toolPath, std::string const &tool
     }
 }
 
-static pid_t forward_target_pid;
+static pid_t const *forward_targets;
+static size_t forward_target_count;
 static void sig_handler_for_waiting(int sig)
 {
-    kill(forward_target_pid, sig);
+    for (size_t i = 0; i < forward_target_count; ++i)
+        kill(forward_targets[i], sig);
 }
 
-static int waitpid_with_signal_forwarding(pid_t const pid, int *const status)
+/// @brief waitpid, with SIGINT forwarded to the children being waited on
+///
+/// @param pid the child to wait for, or -1 for any child
+/// @param targets the children to forward signals to
+static int waitpid_with_signal_forwarding(pid_t const pid, int *const status, pid_t const *const targets, size_t const count)
 {
     struct sigaction act, old;
 
@@ -161,7 +168,8 @@ static int waitpid_with_signal_forwarding(pid_t const pid, int *const status)
         throw std::logic_error("NOT REENTRANT!!!");
 
     // set up signal forwarding
-    forward_target_pid = pid;
+    forward_targets = targets;
+    forward_target_count = count;
 
     act.sa_handler = sig_handler_for_waiting;
     sigemptyset(&act.sa_mask);
@@ -177,6 +185,7 @@ static int waitpid_with_signal_forwarding(pid_t const pid, int *const status)
     if (sigaction(SIGINT, &old, nullptr))
         throw_system_error("sigaction failed");
 
+    forward_target_count = 0;
     lock.clear();
 
     return rc;
@@ -234,7 +243,7 @@ Process::ExitStatus Process::wait() const
 
     do { // loop if wait is interrupted
         auto status = int(0);
-        auto const rc = waitpid_with_signal_forwarding(pid, &status);
+        auto const rc = waitpid_with_signal_forwarding(pid, &status, &pid, 1);
 
         if (rc > 0) {
             assert(rc == pid);
@@ -260,6 +269,11 @@ void Process::runChild [[noreturn]] (::FilePath const &toolpath, std::string con
 }
 
 Process::ExitStatus Process::runChildAndWait(::FilePath const &toolpath, std::string const &toolname, char const *const *argv, Dictionary const &env)
+{
+    return spawnChild(toolpath, toolname, argv, env).wait();
+}
+
+Process Process::spawnChild(::FilePath const &toolpath, std::string const &toolname, char const *const *argv, Dictionary const &env)
 {
     auto const pid = ::fork();
     if (pid < 0)
@@ -267,7 +281,39 @@ Process::ExitStatus Process::runChildAndWait(::FilePath const &toolpath, std::st
     if (pid == 0) {
         runChild(toolpath, toolname, argv, env);
     }
-    return Process(pid).wait();
+    return Process(pid);
+}
+
+std::pair<size_t, Process::ExitStatus> Process::waitAny(std::vector<Process> const &children)
+{
+    assert(!children.empty());
+    auto pids = std::vector<pid_t>();
+    pids.reserve(children.size());
+    for (auto && child : children) {
+        assert(child.pid != 0); ///< you can't wait on yourself
+        pids.push_back(child.pid);
+    }
+
+    for ( ; ; ) {
+        auto status = int(0);
+        auto const rc = waitpid_with_signal_forwarding(-1, &status, pids.data(), pids.size());
+
+        if (rc > 0) {
+            auto const fnd = std::find(pids.begin(), pids.end(), rc);
+            if (fnd != pids.end())
+                return { size_t(fnd - pids.begin()), ExitStatus(status) }; ///< normal return is here
+            continue; // not one of these
+        }
+
+        assert(rc != 0); // only happens if WNOHANG is given
+        if (errno != EINTR) // loop if wait is interrupted
+            break;
+    }
+
+    if (errno == ECHILD)
+        throw std::logic_error("no child process to wait for");
+
+    throw_system_error("waitpid failed");
 }
 
 #if 0
@@ -38,6 +38,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <utility>
 
 #include <signal.h>
 #include <sys/wait.h>
@@ -122,6 +123,15 @@ struct Process {
     static void runChild [[noreturn]] (::FilePath const &toolpath, std::string const &toolname, char const *const *argv, Dictionary const &env);
     static ExitStatus runChildAndWait(::FilePath const &toolpath, std::string const &toolname, char const *const *argv, Dictionary const &env);
 
+      /// @brief start a child process without waiting for it
+      /// @throw system_error if fork fails
+    static Process spawnChild(::FilePath const &toolpath, std::string const &toolname, char const *const *argv, Dictionary const &env);
+
+      /// @brief wait for any one of these processes to finish; SIGINT is forwarded to all of them
+      /// @return the index of the process that finished and its exit status
+      /// @throw system_error if wait fails
+    static std::pair<size_t, ExitStatus> waitAny(std::vector<Process> const &children);
+
     Process(Process const &) = default;
     Process &operator =(Process const &) = default;
     Process(Process &&) = default;
@@ -39,7 +39,9 @@
 #include <utility>
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <cstdint>
+#include <cstdlib>
 
 #include "globals.hpp"
 #include "constants.hpp"
@@ -50,6 +52,7 @@
 #include "opt_string.hpp"
 #include "run-source.hpp"
 #include "SDL-response.hpp"
+#include "SDL-cache.hpp"
 #include "sratools.hpp"
 
 #include "service.hpp"
@@ -67,14 +70,24 @@ static std::string config_or_default(char const *const config_node, char const *
     return from_config ? from_config.value() : default_value;
 }
 
+static std::string resolver_version()
+{
+    return config_or_default("/repository/remote/version", resolver::version());
+}
+
+static std::string resolver_url()
+{
+    return config_or_default("/repository/remote/main/SDL.2/resolver-cgi", resolver::url());
+}
+
 // convert to a virtual method on Service, pass Service to preload and ctors
 static Service::Response get_SDL_response(std::vector<std::string> const &runs, bool const haveCE)
 {
     if (runs.empty())
         throw std::domain_error("No query");
 
-    auto const &version_string = config_or_default("/repository/remote/version", resolver::version());
-    auto const &url_string = config_or_default("/repository/remote/main/SDL.2/resolver-cgi", resolver::url());
+    auto const &version_string = resolver_version();
+    auto const &url_string = resolver_url();
 
     assert(!runs.empty());
 
@@ -93,6 +106,47 @@ static Service::Response get_SDL_response(std::vector<std::string> const &runs,
     return query.response(url_string, version_string);
 }
 
+std::unique_ptr<SDL_Cache> data_sources::SDLCache(bool const haveCE)
+{
+    if (perm || ngc)
+        return std::unique_ptr<SDL_Cache>();
+
+    auto directory = EnvironmentVariables::get("SRATOOLS_SDL_CACHE");
+    if (!directory)
+        directory = config->SDLCacheDirectory();
+    if (!directory || directory.value().empty())
+        return std::unique_ptr<SDL_Cache>();
+
+    auto ttl = SDL_Cache::defaultTTL;
+    auto const &ttl_string = config->SDLCacheTTL();
+    if (ttl_string) {
+        char *endp = nullptr;
+        auto const value = std::strtol(ttl_string.value().c_str(), &endp, 10);
+        if (*endp == '\0' && value >= 0)
+            ttl = value;
+        else
+            LOG(1) << "Ignoring invalid SDL cache TTL '" << ttl_string.value() << "'" << std::endl;
+    }
+
+    auto const quality = qualityPreference();
+    auto const context = resolver_url() + '\t' + resolver_version()
+        + '\t' + (location ? *location : std::string())
+        + '\t' + (quality.isSet ? (quality.isFullQuality ? Accession::qualityTypeForFull : Accession::qualityTypeForLite) : "")
+        + '\t' + (haveCE ? "CE" : "");
+
+    LOG(6) << "Using SDL cache in " << directory.value() << std::endl;
+    return std::unique_ptr<SDL_Cache>(new SDL_Cache(directory.value(), context, ttl));
+}
+
+/// @brief keep the earlier of two URL expiration dates
+static void keep_earliest(opt_string &earliest, opt_string const &date)
+{
+    if (!date)
+        return;
+    if (!earliest || SDL_Cache::parseTimestamp(date.value()) < SDL_Cache::parseTimestamp(earliest.value()))
+        earliest = date;
+}
+
 struct RemoteKey {
     std::string prefix;
     std::string filePath;
@@ -492,13 +546,17 @@ data_sources::data_sources(CommandLine const &cmdline, Arguments const &args, bo
 
     if (withSDL) {
         std::vector<std::string> terms;
+        auto const cache = SDLCache(have_ce_token);
 
-        for (auto const &i : queryInfo) {
+        for (auto &i : queryInfo) {
             if (DictionaryHasKey(i.second, "local")) {
                 LOG(9) << "already found " << i.first << " locally." << std::endl;
             }
             else if (DictionaryHasKey(i.second, "simple")) {
-                terms.emplace_back(i.first);
+                if (cache && cache->get(i.first, i.second))
+                    LOG(9) << "found " << i.first << " in the SDL cache." << std::endl;
+                else
+                    terms.emplace_back(i.first);
             }
             else {
                 LOG(9) << "Not sending " << i.first << " to resolver." << std::endl;
@@ -531,6 +589,7 @@ data_sources::data_sources(CommandLine const &cmdline, Arguments const &args, bo
                     // SDL should have applied similar logic, so this is probably unneccessary.
                     unsigned added = 0, pass = qualityPreference().isFullQuality ? 0 : 1;
                     auto encrypted = false;
+                    auto expiration = opt_string();
 
                     do {
                         ++pass;
@@ -573,6 +632,7 @@ data_sources::data_sources(CommandLine const &cmdline, Arguments const &args, bo
                                 info[key.CER] = "1";
                             if (location.payRequired)
                                 info[key.payR] = "1";
+                            keep_earliest(expiration, location.expirationDate);
 
                             auto const cache = sdl_result.getCacheFor(fl);
                             if (cache >= 0) {
@@ -584,6 +644,7 @@ data_sources::data_sources(CommandLine const &cmdline, Arguments const &args, bo
                                     info[key.cacheCER] = "1";
                                 if (cacheFile.second.payRequired)
                                     info[key.cachePayR] = "1";
+                                keep_earliest(expiration, cacheFile.second.expirationDate);
                             }
                             added += 1;
                         }
@@ -597,6 +658,8 @@ data_sources::data_sources(CommandLine const &cmdline, Arguments const &args, bo
                     }
                     else {
                         queryInfo[query]["remote"] = std::to_string(added);
+                        if (cache)
+                            cache->put(query, queryInfo[query], expiration);
                     }
                 }
                 else if (sdl_result.status == "404") {
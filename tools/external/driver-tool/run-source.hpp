@@ -33,12 +33,14 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <memory>
 #include "util.hpp"
 #include "constants.hpp"
 #include "opt_string.hpp"
 #include "sratools.hpp"
 #include "command-line.hpp"
 #include "tool-args.hpp"
+#include "SDL-cache.hpp"
 
 /// @brief Contains the response from SDL and/or local file info.
 class data_sources {
@@ -148,6 +150,11 @@ public:
     };
     static QualityPreference qualityPreference();
 
+    /// @brief The SDL cache, if the user has configured one.
+    /// @note `SRATOOLS_SDL_CACHE` overrides the configured directory.
+    /// Results for controlled access data are never cached.
+    static std::unique_ptr<sratools::SDL_Cache> SDLCache(bool haveCE);
+
     /// @brief Call SDL with accesion/query list and process the results.
     /// Can use local file info if no response from SDL.
     static data_sources preload(CommandLine const &cmdline, Arguments const &parsed);
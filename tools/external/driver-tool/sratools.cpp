@@ -406,12 +406,249 @@ static void do_sratools [[noreturn]] (CommandLine const &argv)
     printHelp();
 }
 
+/// @brief How many accessions to run the tool for at once; from --jobs, the default is 1.
+///
+/// @return false if --jobs is not a positive number.
+static bool getJobSlots(Arguments const &args, unsigned *jobs)
+{
+    auto good = true;
+
+    *jobs = 1;
+    args.each("jobs", [&](Argument const &arg) {
+        char *endp = nullptr;
+        auto const value = std::strtoul(arg.argument, &endp, 10);
+
+        if (endp == arg.argument || *endp != '\0' || value == 0 || value > 0xFFFF) {
+            std::cerr << "--jobs " << arg.argument << "\nExpected a positive number." << std::endl;
+            good = false;
+        }
+        else
+            *jobs = unsigned(value);
+        arg.reason = "used";
+    });
+    return good;
+}
+
+/// @brief Parse a size like fasterq-dump does, e.g. 100, 10K, 100M, 1G.
+static bool parseSize(char const *const str, uint64_t *result)
+{
+    char *endp = nullptr;
+    auto const value = std::strtoull(str, &endp, 10);
+    uint64_t scale = 1;
+
+    if (endp == str)
+        return false;
+    switch (*endp) {
+    case '\0':
+        break;
+    case 'k': case 'K':
+        scale = 1024;
+        ++endp;
+        break;
+    case 'm': case 'M':
+        scale = 1024 * 1024;
+        ++endp;
+        break;
+    case 'g': case 'G':
+        scale = 1024 * 1024 * 1024;
+        ++endp;
+        break;
+    default:
+        return false;
+    }
+    if (*endp != '\0')
+        return false;
+    *result = value * scale;
+    return true;
+}
+
+/// @brief fasterq-dump's own limits, used when the user gave none; see fasterq-dump.c.
+static auto constexpr fasterqDumpDefaultThreads = 6ul;
+static auto constexpr fasterqDumpDefaultMem = uint64_t(50) * 1024 * 1024;
+
+/// @brief Share out the tool's thread and memory limits among the jobs running at once.
+///
+/// The limits, the user's or else the tool's defaults, are for the whole run,
+/// so they are taken off the command line and each job gets its part as extra
+/// arguments. Only fasterq-dump has such limits.
+static std::vector<std::string> budgetForJobs(CommandLine const &argv, Arguments const &args, unsigned jobs)
+{
+    auto result = std::vector<std::string>();
+
+    if (jobs < 2 || argv.toolName != "fasterq-dump")
+        return result;
+
+    auto threads = fasterqDumpDefaultThreads;
+    auto bad = false;
+    args.each("threads", [&](Argument const &arg) {
+        char *endp = nullptr;
+        auto const value = std::strtoul(arg.argument, &endp, 10);
+
+        if (endp == arg.argument || *endp != '\0' || value == 0) {
+            bad = true;
+            return; // leave it for the tool to complain about
+        }
+        threads = value;
+        arg.reason = "used";
+    });
+    if (!bad) {
+        result.push_back("--threads");
+        result.push_back(std::to_string(std::max(1ul, threads / jobs)));
+        LOG(2) << "Each job gets " << result.back() << " of " << threads << " threads" << std::endl;
+    }
+
+    auto mem = fasterqDumpDefaultMem;
+    bad = false;
+    args.each("mem", [&](Argument const &arg) {
+        uint64_t value = 0;
+        if (!parseSize(arg.argument, &value) || value == 0) {
+            bad = true;
+            return; // leave it for the tool to complain about
+        }
+        mem = value;
+        arg.reason = "used";
+    });
+    if (!bad) {
+        result.push_back("--mem");
+        result.push_back(std::to_string(std::max<uint64_t>(1, mem / jobs)));
+        LOG(2) << "Each job gets " << result.back() << " of " << mem << " bytes of memory" << std::endl;
+    }
+    return result;
+}
+
+/// @brief Can the tool run for several accessions at once?
+///
+/// Only if every run writes files of its own; output to stdout, or into
+/// the one file named on the command line, would get interleaved.
+static bool canRunJobs(CommandLine const &argv, Arguments const &args)
+{
+    if (argv.toolName == "fastq-dump")
+        return !args.any("stdout");
+    if (argv.toolName == "fasterq-dump")
+        return !args.any("stdout") && !args.any("outfile");
+    return false; // sam-dump, sra-pileup, vdb-dump
+}
+
+template <typename Sources>
+static void reportNoData(std::string const &acc, Sources const &sources)
+{
+    std::cerr << "Could not get any data for " << acc << ", tried to get data from:" << std::endl;
+    for (auto i : sources) {
+        std::cerr << '\t' << i.service << std::endl;
+    }
+    std::cerr << "This may be temporary, retry later." << std::endl;
+}
+
 static auto constexpr error_continues_message = "If this continues to happen, please contact the SRA Toolkit at https://trace.ncbi.nlm.nih.gov/Traces/sra/";
 static auto constexpr fullQualityName = "Normalized Format";
 static auto constexpr zeroQualityName = "Lite";
 static auto constexpr fullQualityDesc = "full base quality scores";
 static auto constexpr zeroQualityDesc = "simplified base quality scores";
 
+#if !WINDOWS
+/// @brief Running the tool for one accession; its sources are tried in order until one works.
+struct ToolJob {
+    Argument const *arg;
+    std::vector<data_sources::accession::info> sources;
+    size_t next; ///< the source to try next
+
+    ToolJob(Argument const &arg, data_sources::accession const &accession)
+    : arg(&arg)
+    , next(0)
+    {
+        for (auto src : accession)
+            sources.push_back(src);
+    }
+};
+
+/// @brief Run the tool for every accession, with up to `jobs` of them running at once.
+///
+/// Results are treated the same as when running one at a time, except that
+/// a failure does not stop the jobs that are already running; it only stops
+/// any more from being started. The result is that of the first failure.
+static int runJobs(CommandLine const &argv, Arguments const &parsed, data_sources const &all_sources, unsigned jobs, unsigned verbosity)
+{
+    auto const &budget = budgetForJobs(argv, parsed, jobs);
+    auto pending = std::vector<ToolJob>();
+    auto running = std::vector<Process>();
+    auto runningJob = std::vector<size_t>(); ///< parallel to running
+    auto nextJob = size_t(0);
+    auto result = 0;
+
+    for (auto const &arg : parsed) {
+        if (arg.isArgument())
+            pending.emplace_back(arg, all_sources[arg.argument]);
+    }
+
+    /// start the job on its next source; false if there are none left
+    auto const start = [&](size_t const which) {
+        auto &job = pending[which];
+        if (job.next == job.sources.size())
+            return false;
+
+        auto const &src = job.sources[job.next++];
+        if (verbosity > 0 && src.haveQualityType()) {
+            auto const name = src.haveFullQuality() ? fullQualityName : zeroQualityName;
+            auto const desc = src.haveFullQuality() ? fullQualityDesc : zeroQualityDesc;
+            std::cerr << job.arg->argument << " is an SRA " << name << " file with " << desc << ".\n";
+        }
+        // MARK: Run the driven tool
+        running.push_back(Process::spawnTool(argv, parsed.keep(*job.arg), src.environment, budget));
+        runningJob.push_back(which);
+        return true;
+    };
+
+    for ( ; ; ) {
+        while (result == 0 && running.size() < jobs && nextJob < pending.size()) {
+            auto const which = nextJob++;
+            if (!start(which)) {
+                reportNoData(pending[which].arg->argument, pending[which].sources);
+                result = EX_TEMPFAIL;
+            }
+        }
+        if (running.empty())
+            break;
+
+        auto const done = Process::waitAny(running);
+        auto const which = runningJob[done.first];
+        auto const &status = done.second;
+        auto const &job = pending[which];
+        auto const acc = job.arg->argument;
+        auto const &src = job.sources[job.next - 1];
+
+        running.erase(running.begin() + done.first);
+        runningJob.erase(runningJob.begin() + done.first);
+
+        if (status.didExitNormally()) {
+            LOG(2) << "Processed " << acc << " with data from " << src.service << std::endl;
+            continue;
+        }
+        if (status.didExit()) {
+            auto const exit_code = status.exitCode();
+            if (exit_code == EX_TEMPFAIL) {
+                LOG(1) << "Failed to get data for " << acc << " from " << src.service << std::endl;
+                if (result == 0 && start(which))
+                    continue;
+                if (job.next == job.sources.size()) {
+                    reportNoData(acc, job.sources);
+                    if (result == 0)
+                        result = EX_TEMPFAIL;
+                }
+                continue;
+            }
+            std::cerr << argv.toolName << " quit with error code " << exit_code << " for " << acc << std::endl;
+            if (result == 0)
+                result = exit_code;
+            continue;
+        }
+        // was killed or something
+        if (result == 0)
+            result = status.exitCode();
+    }
+    return result;
+}
+#endif
+
 static int main(CommandLine const &argv)
 {
 #if DEBUG || _DEBUGGING
@@ -475,6 +712,10 @@ static int main(CommandLine const &argv)
         if (!checkCommonOptions(argv, parsed, &auto_perm, &auto_ngc))
             return EX_USAGE;
 
+        unsigned jobs = 1;
+        if (!getJobSlots(parsed, &jobs))
+            return EX_USAGE;
+
         if (!auto_perm.empty())
             perm = &auto_perm;
 
@@ -518,6 +759,19 @@ static int main(CommandLine const &argv)
 
         all_sources.set_ce_token_env_var();
 
+        // MARK: Run for more than one accession at once.
+        if (jobs > 1 && !canRunJobs(argv, parsed)) {
+            std::cerr << "--jobs " << jobs << ": " << argv.toolName << " is writing to one output, running one accession at a time." << std::endl;
+            jobs = 1;
+        }
+        if (jobs > 1 && parsed.countOfCommandArguments() > 1) {
+#if WINDOWS
+            LOG(1) << "--jobs is not available on this platform, running one at a time" << std::endl;
+#else
+            return runJobs(argv, parsed, all_sources, jobs, verbosity);
+#endif
+        }
+
         for (auto const &arg : parsed) {
             if (!arg.isArgument()) continue;
 
@@ -551,11 +805,7 @@ static int main(CommandLine const &argv)
                 exit(result.exitCode());
             }
             if (!success) {
-                std::cerr << "Could not get any data for " << acc << ", tried to get data from:" << std::endl;
-                for (auto i : sources) {
-                    std::cerr << '\t' << i.service << std::endl;
-                }
-                std::cerr << "This may be temporary, retry later." << std::endl;
+                reportNoData(acc, sources);
                 return EX_TEMPFAIL;
             }
         }
@@ -616,7 +616,8 @@ UniqueOrderedList<int> Arguments::keep(Argument const &keep) const {
             max_argind = arg.argind;
     }
 
-    std::vector< bool > used(max_argind + 1, false);
+    // one extra, for an ignored parameter that is the last one
+    std::vector< bool > used(max_argind + 2, false);
     for (auto & arg : container)
         used[arg.argind] = true;
 
@@ -36,6 +36,7 @@
 #include <klib/rc.h>
 
 #include <sysalloc.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <iostream>
@@ -52,12 +53,58 @@ const char * ref_usage[] = { "Filter by position on genome.",
                              "\"from\" and \"to\" are 1-based coordinates",
                              NULL };
                              
+#define OPTION_THREADS "threads"
+#define ALIAS_THREADS  NULL
+static const char * threads_usage[] = { "Number of threads processing slices of references,",
+                                        "output stays in reference order (default 1)",
+                                        NULL };
+
+#define OPTION_DEPTH   "depth-only"
+#define ALIAS_DEPTH    NULL
+static const char * depth_usage[] = { "Compute depth from alignment start/end positions",
+                                      "instead of full pileups",
+                                      NULL };
+
+#define MAX_THREADS 64
+
 OptDef options[] =
 {   /*name,           alias,         hfkt, usage-help,    maxcount, needs value, required */
     { OPTION_REF,     ALIAS_REF,     NULL, ref_usage,     0,        true,        false },
     { OPTION_NGC,     ALIAS_NGC,     NULL, ngc_usage,     0,        true,        false },
+    { OPTION_THREADS, ALIAS_THREADS, NULL, threads_usage, 1,        true,        false },
+    { OPTION_DEPTH,   ALIAS_DEPTH,   NULL, depth_usage,   1,        false,       false },
 };
 
+/* "name" or "name:from-to" with 1-based inclusive coordinates;
+   a suffix that is not a range stays a part of the name */
+static
+void
+AddRegion ( NGS_Pileup::Settings & settings, const std::string & region )
+{
+    std::string::size_type colon = region . rfind ( ':' );
+    if ( colon != std::string::npos )
+    {
+        const char * range = region . c_str () + colon + 1;
+        char * end;
+        unsigned long long from = strtoull ( range, & end, 10 );
+        if ( end != range && * end == '-' )
+        {
+            const char * to_str = end + 1;
+            unsigned long long to = strtoull ( to_str, & end, 10 );
+            if ( end != to_str && * end == 0 )
+            {
+                if ( from == 0 || to < from )
+                {
+                    throw ngs :: ErrorMsg ( "invalid region: " + region );
+                }
+                settings . AddReferenceSlice ( region . substr ( 0, colon ), from - 1, to - from + 1 );
+                return;
+            }
+        }
+    }
+    settings . AddReference ( region );
+}
+
 
 const char UsageDefaultName[] = "ngs-pileup";
 
@@ -102,6 +149,8 @@ rc_t CC Usage ( const Args * args )
         }
         else if (strcmp(opt->name, OPTION_NGC) == 0)
             param = "PATH";
+        else if (strcmp(opt->name, OPTION_THREADS) == 0)
+            param = "count";
 
         HelpOptionLine(alias, opt->name, param, opt->help);
     }
@@ -129,18 +178,39 @@ rc_t CC KMain( int argc, char *argv [] )
             void const *value = NULL;
 
             rc = ArgsOptionCount ( args, OPTION_REF, &pcount );
-            if ( pcount > 1 )
-            {
-                throw ngs :: ErrorMsg ( "multiple positions are not supported at this point" );
-            }
-            if ( pcount == 1 )
+            for ( uint32_t i = 0; i < pcount; ++i )
             {
-                rc = ArgsOptionValue ( args, OPTION_REF, 0, & value );
+                rc = ArgsOptionValue ( args, OPTION_REF, i, & value );
                 if ( rc != 0 )
                 {
                     throw ngs :: ErrorMsg ( "ArgsOptionValue (" OPTION_REF ") failed" );
                 }
-                settings . AddReference ( static_cast <char const*> (value) );
+                AddRegion ( settings, static_cast <char const*> (value) );
+            }
+
+/* OPTION_THREADS */
+            {
+                rc = ArgsOptionCount ( args, OPTION_THREADS, &pcount );
+                if ( pcount == 1 )
+                {
+                    rc = ArgsOptionValue ( args, OPTION_THREADS, 0, & value );
+                    if ( rc != 0 )
+                    {
+                        throw ngs :: ErrorMsg ( "ArgsOptionValue (" OPTION_THREADS ") failed" );
+                    }
+                    unsigned long threads = strtoul ( static_cast <char const*> (value), NULL, 10 );
+                    if ( threads == 0 || threads > MAX_THREADS )
+                    {
+                        throw ngs :: ErrorMsg ( "invalid number of threads" );
+                    }
+                    settings . threads = threads;
+                }
+            }
+
+/* OPTION_DEPTH */
+            {
+                rc = ArgsOptionCount ( args, OPTION_DEPTH, &pcount );
+                settings . depthOnly = rc == 0 && pcount > 0;
             }
             
 /* OPTION_NGC */
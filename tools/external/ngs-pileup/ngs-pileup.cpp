@@ -26,45 +26,155 @@
 
 #include "ngs-pileup.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <map>
+#include <atomic>
+#include <thread>
 
 #include <ngs/ncbi/NGS.hpp>
 #include <ngs/ReadCollection.hpp>
+#include <ngs/AlignmentIterator.hpp>
 #include <ngs/PileupIterator.hpp>
 
 using namespace std;
 
+/* positions per unit of work when references are processed in parallel
+   or with the depth-only sweep; bounds the memory per worker */
+static const uint64_t ChunkSize = 256 * 1024;
+
+/* depth of every position in [ p_first, p_first + p_length ) from the start/end events of
+   the overlapping alignments: a difference array with a running sum */
+static
+void
+SweepDepth ( ostream & out,
+             const string & p_name,
+             const vector < ngs :: Reference > & p_refs,
+             int64_t p_first,
+             uint64_t p_length )
+{
+    vector < int32_t > delta ( p_length + 1, 0 );
+    const int64_t end = p_first + ( int64_t ) p_length;
+
+    for ( vector < ngs :: Reference > :: const_iterator i = p_refs . begin (); i != p_refs . end (); ++i )
+    {
+        ngs :: AlignmentIterator it = i -> getAlignmentSlice ( p_first, p_length, ngs :: Alignment :: all );
+        while ( it . nextAlignment () )
+        {
+            int64_t alStart = it . getAlignmentPosition ();
+            int64_t alEnd   = alStart + ( int64_t ) it . getAlignmentLength ();
+            if ( alStart < p_first )
+            {
+                alStart = p_first;
+            }
+            if ( alEnd > end )
+            {
+                alEnd = end;
+            }
+            if ( alStart < alEnd )
+            {
+                ++ delta [ alStart - p_first ];
+                -- delta [ alEnd - p_first ];
+            }
+        }
+    }
+
+    int32_t depth = 0;
+    for ( uint64_t i = 0; i < p_length; ++i )
+    {
+        depth += delta [ i ];
+        if ( depth > 0 )
+        {
+            out << p_name
+                << '\t' << ( p_first + ( int64_t ) i + 1 ) // convert to 1-based position to emulate samtools
+                << '\t' << depth
+                << '\n';
+        }
+    }
+}
+
+/* depth of every position in [ p_first, p_first + p_length ) by walking pileups of all the references in lockstep */
+static
+void
+PileupDepth ( ostream & out,
+              const string & p_name,
+              const vector < ngs :: Reference > & p_refs,
+              int64_t p_first,
+              uint64_t p_length )
+{
+    typedef vector < ngs :: PileupIterator> Pileups;
+    Pileups pileups;
+
+    // create pileup iterators
+    for ( vector < ngs :: Reference > :: const_iterator i = p_refs . begin(); i != p_refs . end(); ++i )
+    {
+        pileups . push_back ( i -> getPileupSlice ( p_first, p_length, ngs::Alignment::all ) );
+    }
+
+    int64_t curPos = p_first;
+    const int64_t lastPos = p_first + ( int64_t ) p_length - 1;
+    while ( curPos <= lastPos )
+    {
+        uint32_t total_depth = 0;
+        for ( Pileups :: iterator i = pileups . begin (); i != pileups. end (); ++i )
+        {
+            bool next = i -> nextPileup ();
+            assert ( next );
+            UNUSED(next);
+            total_depth += i -> getPileupDepth ();
+        }
+
+        if ( total_depth > 0 )
+        {
+            out << p_name
+                << '\t' << ( curPos + 1 ) // convert to 1-based position to emulate samtools
+                << '\t' << total_depth
+                << '\n';
+        }
+
+        ++ curPos;
+    }
+}
+
 struct NGS_Pileup::TargetReference
 {
-    typedef pair < int64_t, int64_t >       Slice;
+    typedef pair < int64_t, uint64_t >      Slice; /* first, length */
     typedef vector < Slice >                Slices;
     typedef vector < ngs :: Reference >     Targets;
-    typedef vector < ngs :: PileupIterator> Pileups;
+    typedef pair < string, string >         Source; /* accession, reference common name */
+    typedef vector < Source >               Sources;
 
     string  m_canonicalName;
     Slices  m_slices;
     Targets m_targets;
-    Pileups m_pileups;
+    Sources m_sources;
     bool    m_complete;
 
-    TargetReference ( ngs :: Reference p_ref )
+    TargetReference ( const string & p_acc, ngs :: Reference p_ref )
     : m_canonicalName ( p_ref . getCanonicalName() ), m_complete ( true )
     {
-        AddReference ( p_ref );
+        AddReference ( p_acc, p_ref );
     }
-    TargetReference ( ngs :: Reference p_ref,
+    TargetReference ( const string & p_acc,
+                      ngs :: Reference p_ref,
                       int64_t p_first,
-                      int64_t p_last )
+                      uint64_t p_length )
     : m_canonicalName ( p_ref . getCanonicalName() ), m_complete ( false )
     {
-        AddReference ( p_ref );
+        AddReference ( p_acc, p_ref );
+        AddSlice ( p_first, p_length );
     }
     ~TargetReference ()
     {
     }
 
-    void AddSlice ( int64_t p_first, int64_t p_last )
+    void AddSlice ( int64_t p_first, uint64_t p_length )
     {
+        if ( ! m_complete )
+        {
+            m_slices . push_back ( Slice ( p_first, p_length ) );
+        }
     }
     void MakeComplete ()
     {
@@ -72,43 +182,60 @@ struct NGS_Pileup::TargetReference
         m_slices . clear();
     }
 
-    void AddReference ( ngs :: Reference p_ref )
+    void AddReference ( const string & p_acc, ngs :: Reference p_ref )
     {
-        m_targets. push_back ( p_ref );
+        Source source ( p_acc, p_ref . getCommonName () );
+        if ( find ( m_sources . begin (), m_sources . end (), source ) == m_sources . end () )
+        {   // the same reference can be requested more than once, as a whole or by slices
+            m_targets . push_back ( p_ref );
+            m_sources . push_back ( source );
+        }
     }
 
-    void Process ( ostream& out )
+    /* the ranges to report, clipped to the reference and sorted */
+    Slices Ranges () const
     {
-        int64_t firstPos = 0;
-        int64_t lastPos = m_targets . front () . getLength () - 1;
-
-        // create pileup iterators
-        for ( Targets::iterator i = m_targets.begin(); i != m_targets.end(); ++i )
+        Slices ret;
+        const uint64_t refLength = m_targets . front () . getLength ();
+        if ( m_complete )
         {
-            m_pileups . push_back ( i -> getPileups ( ngs::Alignment::all ) );
+            ret . push_back ( Slice ( 0, refLength ) );
         }
-
-        int64_t curPos = firstPos;
-        while ( curPos <= lastPos )
+        else
         {
-            uint32_t total_depth = 0;
-            for ( Pileups :: iterator i = m_pileups . begin (); i != m_pileups. end (); ++i )
+            for ( Slices :: const_iterator i = m_slices . begin (); i != m_slices . end (); ++i )
             {
-                bool next = i -> nextPileup ();
-                assert ( next );
-                UNUSED(next);
-                total_depth += i -> getPileupDepth ();
+                if ( i -> first >= 0 && ( uint64_t ) i -> first < refLength )
+                {
+                    uint64_t length = min ( i -> second, refLength - i -> first );
+                    if ( length > 0 )
+                    {
+                        ret . push_back ( Slice ( i -> first, length ) );
+                    }
+                }
             }
+            sort ( ret . begin (), ret . end () );
+        }
+        return ret;
+    }
 
-            if ( total_depth > 0 )
+    void Process ( ostream& out, bool p_depthOnly ) const
+    {
+        Slices ranges = Ranges ();
+        for ( Slices :: const_iterator r = ranges . begin (); r != ranges . end (); ++r )
+        {
+            if ( p_depthOnly )
+            {   // the difference array is per chunk
+                for ( uint64_t offset = 0; offset < r -> second; offset += ChunkSize )
+                {
+                    SweepDepth ( out, m_canonicalName, m_targets,
+                                 r -> first + ( int64_t ) offset, min ( ChunkSize, r -> second - offset ) );
+                }
+            }
+            else
             {
-                out << m_canonicalName
-                    << '\t' << ( curPos + 1 ) // convert to 1-based position to emulate samtools
-                    << '\t' << total_depth
-                    << endl;
+                PileupDepth ( out, m_canonicalName, m_targets, r -> first, r -> second );
             }
-
-            ++ curPos;
         }
     }
 };
@@ -116,20 +243,117 @@ struct NGS_Pileup::TargetReference
 class NGS_Pileup::TargetReferences : public vector < TargetReference >
 {
 public :
-    void AddComplete ( ngs :: Reference ref )
+    void AddComplete ( const string & acc, ngs :: Reference ref )
+    {
+        string name = ref . getCanonicalName ();
+        for ( iterator i = begin(); i != end (); ++ i )
+        {
+            if ( i -> m_canonicalName == name )
+            {
+                i -> AddReference ( acc, ref );
+                i -> MakeComplete ();
+                return;
+            }
+        }
+        // not found - add new reference
+        push_back ( TargetReference ( acc, ref ) );
+    }
+
+    void AddSlice ( const string & acc, ngs :: Reference ref, int64_t first, uint64_t length )
     {
         string name = ref . getCanonicalName ();
         for ( iterator i = begin(); i != end (); ++ i )
         {
             if ( i -> m_canonicalName == name )
             {
-                i -> AddReference ( ref );
+                i -> AddReference ( acc, ref );
+                i -> AddSlice ( first, length );
                 return;
             }
         }
         // not found - add new reference
-        push_back ( TargetReference ( ref ) );
+        push_back ( TargetReference ( acc, ref, first, length ) );
+    }
+};
+
+/* a piece of a target reference processed by one worker; text is written out in the order of chunks */
+struct NGS_Pileup::Chunk
+{
+    Chunk ( size_t p_target, int64_t p_first, uint64_t p_length )
+    : target ( p_target ), first ( p_first ), length ( p_length )
+    {
+    }
+
+    size_t   target;
+    int64_t  first;
+    uint64_t length;
+    string   text;
+};
+
+/* ngs objects are not shared between threads: every worker opens its own read collections */
+class NGS_Pileup::Worker
+{
+public:
+    Worker ( const TargetReferences & p_refs, bool p_depthOnly )
+    : m_refs ( p_refs ), m_depthOnly ( p_depthOnly ), m_failed ( false )
+    {
+    }
+
+    void Run ( vector < Chunk > & p_chunks, atomic < size_t > & p_next )
+    {
+        try
+        {
+            for ( size_t i = p_next ++; i < p_chunks . size () && ! m_failed; i = p_next ++ )
+            {
+                Chunk & c = p_chunks [ i ];
+                const TargetReference & target = m_refs [ c . target ];
+
+                vector < ngs :: Reference > refs;
+                for ( TargetReference :: Sources :: const_iterator s = target . m_sources . begin ();
+                      s != target . m_sources . end ();
+                      ++s )
+                {
+                    refs . push_back ( Collection ( s -> first ) . getReference ( s -> second ) );
+                }
+
+                ostringstream out;
+                if ( m_depthOnly )
+                {
+                    SweepDepth ( out, target . m_canonicalName, refs, c . first, c . length );
+                }
+                else
+                {
+                    PileupDepth ( out, target . m_canonicalName, refs, c . first, c . length );
+                }
+                c . text = out . str ();
+            }
+        }
+        catch ( exception & ex )
+        {
+            m_failed = true;
+            m_error = ex . what ();
+        }
+    }
+
+    bool Failed () const { return m_failed; }
+    const string & Error () const { return m_error; }
+
+private:
+    ngs :: ReadCollection Collection ( const string & p_acc )
+    {
+        map < string, ngs :: ReadCollection > :: iterator i = m_collections . find ( p_acc );
+        if ( i == m_collections . end () )
+        {
+            i = m_collections . insert ( make_pair ( p_acc, ncbi :: NGS :: openReadCollection ( p_acc ) ) ) . first;
+        }
+        return i -> second;
     }
+
+    const TargetReferences & m_refs;
+    bool m_depthOnly;
+    bool m_failed;
+    string m_error;
+    map < string, ngs :: ReadCollection > m_collections;
 };
 
 NGS_Pileup::NGS_Pileup ( const Settings& p_settings )
@@ -138,18 +362,19 @@ NGS_Pileup::NGS_Pileup ( const Settings& p_settings )
 }
 
 static
-bool FindReference ( const NGS_Pileup :: Settings :: References & requested, const ngs :: Reference & ref )
+const NGS_Pileup :: Settings :: ReferenceSlice *
+FindReference ( const NGS_Pileup :: Settings :: References & requested,
+                const ngs :: Reference & ref,
+                NGS_Pileup :: Settings :: References :: const_iterator & from )
 {
-    for ( NGS_Pileup :: Settings :: References :: const_iterator i = requested . begin();
-          i != requested . end ();
-          ++i )
+    for ( ; from != requested . end (); ++from )
     {
-        if ( i->m_name == ref . getCanonicalName () || i->m_name == ref . getCommonName () )
+        if ( from->m_name == ref . getCanonicalName () || from->m_name == ref . getCommonName () )
         {
-            return true;
+            return & * from ++;
         }
     }
-    return false;
+    return 0;
 }
 
 void
@@ -170,23 +395,91 @@ NGS_Pileup::Run () const
             {
                 /* need to create a Reference object that is not attached to the iterator, so as
                     it is not invalidated on the next call to refIt.NextReference() */
-                references . AddComplete ( col . getReference ( refIt. getCommonName () ) );
+                references . AddComplete ( *i, col . getReference ( refIt. getCommonName () ) );
             }
-            else if ( FindReference ( m_settings . references, refIt ) )
+            else
             {
-                //TODO: handle slices
-                references . AddComplete ( col . getReference ( refIt. getCommonName () ) );
+                Settings :: References :: const_iterator from = m_settings . references . begin ();
+                const Settings :: ReferenceSlice * slice;
+                while ( ( slice = FindReference ( m_settings . references, refIt, from ) ) != 0 )
+                {
+                    if ( slice -> m_full )
+                    {
+                        references . AddComplete ( *i, col . getReference ( refIt. getCommonName () ) );
+                    }
+                    else
+                    {
+                        references . AddSlice ( *i,
+                                                col . getReference ( refIt. getCommonName () ),
+                                                slice -> m_firstPos,
+                                                slice -> m_length );
+                    }
+                }
             }
         }
     }
 
     ostream & out ( m_settings . output != (ostream*)0 ? * m_settings . output : cout );
 
-    // walk the references and output pileups
-    for ( TargetReferences :: iterator i = references . begin(); i != references . end (); ++i )
+    if ( m_settings . threads <= 1 )
+    {
+        // walk the references and output pileups
+        for ( TargetReferences :: const_iterator i = references . begin(); i != references . end (); ++i )
+        {
+            i -> Process ( out, m_settings . depthOnly );
+        }
+        out . flush ();
+        return;
+    }
+
+    // cut the references into chunks, in output order
+    vector < Chunk > chunks;
+    for ( size_t t = 0; t < references . size (); ++t )
+    {
+        TargetReference :: Slices ranges = references [ t ] . Ranges ();
+        for ( TargetReference :: Slices :: const_iterator r = ranges . begin (); r != ranges . end (); ++r )
+        {
+            for ( uint64_t offset = 0; offset < r -> second; offset += ChunkSize )
+            {
+                chunks . push_back ( Chunk ( t, r -> first + ( int64_t ) offset, min ( ChunkSize, r -> second - offset ) ) );
+            }
+        }
+    }
+
+    vector < Worker > workers ( m_settings . threads, Worker ( references, m_settings . depthOnly ) );
+
+    // a batch of chunks at a time, to keep the buffered output bounded
+    const size_t batchSize = workers . size () * 4;
+    for ( size_t batchStart = 0; batchStart < chunks . size (); batchStart += batchSize )
     {
-        i -> Process ( out );
+        size_t batchEnd = min ( batchStart + batchSize, chunks . size () );
+        vector < Chunk > batch ( chunks . begin () + batchStart, chunks . begin () + batchEnd );
+        atomic < size_t > next ( 0 );
+
+        vector < thread > threads;
+        for ( vector < Worker > :: iterator w = workers . begin (); w != workers . end (); ++w )
+        {
+            threads . push_back ( thread ( & Worker :: Run, & * w, ref ( batch ), ref ( next ) ) );
+        }
+        for ( vector < thread > :: iterator t = threads . begin (); t != threads . end (); ++t )
+        {
+            t -> join ();
+        }
+
+        for ( vector < Worker > :: const_iterator w = workers . begin (); w != workers . end (); ++w )
+        {
+            if ( w -> Failed () )
+            {
+                throw ngs :: ErrorMsg ( w -> Error () );
+            }
+        }
+
+        for ( vector < Chunk > :: const_iterator c = batch . begin (); c != batch . end (); ++c )
+        {
+            out << c -> text;
+        }
     }
+    out . flush ();
 }
 
 //// NGS_Pileup::Settings
@@ -200,8 +493,8 @@ NGS_Pileup::Settings::AddReference ( const string& commonOrCanonicalName )
 void
 NGS_Pileup::Settings::AddReferenceSlice ( const string& commonOrCanonicalName,
                                         int64_t firstPos,
-                                        int64_t lastPos )
+                                        uint64_t length )
 {
-    references . push_back ( ReferenceSlice ( commonOrCanonicalName, firstPos, lastPos ) );
+    references . push_back ( ReferenceSlice ( commonOrCanonicalName, firstPos, length ) );
 }
 
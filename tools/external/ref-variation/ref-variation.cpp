@@ -34,6 +34,8 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <sstream>
+#include <algorithm>
 
 #include <kapp/main.h>
 #include <klib/rc.h>
@@ -103,6 +105,7 @@ namespace NSRefVariation
         size_t thread_count;
         bool calc_coverage;
         char const* input_file;
+        char const* query_file;
         EnumCountStrand count_strand;
         uint32_t query_min_rep;
         uint32_t query_max_rep;
@@ -117,6 +120,7 @@ namespace NSRefVariation
         1,
         false,
         "",
+        "",
         COUNT_STRAND_NONE,
         0,
         0,
@@ -224,6 +228,9 @@ namespace NSRefVariation
     char const ALIAS_INPUT_FILE[]  = "i";
     char const* USAGE_INPUT_FILE[] = { "take runs from input file rather than from command line. The file must be in text format, each line should contain three tab-separated values: <run-accession> <run-path> <pileup-stats-path>, the latter two are optional", NULL };
 
+    char const OPTION_QUERY_FILE[] = "query-file";
+    char const* USAGE_QUERY_FILE[] = { "take variation queries from the file rather than from -r, -p, --query and -l options. The file must be in text format, each line should contain four tab-separated values: <reference-accession> <position> <variation-length> <query> (\"-\" is treated as an empty query, or deletion). All queries are looked up in a single pass over each run", NULL };
+
     char const OPTION_COUNT_STRAND[] = "count-strand";
     //char const ALIAS_COUNT_STRAND[]  = "s";
     char const* USAGE_COUNT_STRAND[] = { "controls relative orientation of 3' and 5' fragments. "
@@ -239,13 +246,14 @@ namespace NSRefVariation
 
     ::OptDef Options[] =
     {
-        { OPTION_REFERENCE_ACC, ALIAS_REFERENCE_ACC, NULL, USAGE_REFERENCE_ACC, 1, true, true }
-        ,{ OPTION_REF_POS,       ALIAS_REF_POS,       NULL, USAGE_REF_POS,       1, true, true }
-        ,{ OPTION_QUERY,         /*ALIAS_QUERY*/NULL, NULL, USAGE_QUERY,         1, true, true }
-        ,{ OPTION_VAR_LEN_ON_REF,ALIAS_VAR_LEN_ON_REF,NULL, USAGE_VAR_LEN_ON_REF,1, true, true }
+        { OPTION_REFERENCE_ACC, ALIAS_REFERENCE_ACC, NULL, USAGE_REFERENCE_ACC, 1, true, false }
+        ,{ OPTION_REF_POS,       ALIAS_REF_POS,       NULL, USAGE_REF_POS,       1, true, false }
+        ,{ OPTION_QUERY,         /*ALIAS_QUERY*/NULL, NULL, USAGE_QUERY,         1, true, false }
+        ,{ OPTION_VAR_LEN_ON_REF,ALIAS_VAR_LEN_ON_REF,NULL, USAGE_VAR_LEN_ON_REF,1, true, false }
         ,{ OPTION_THREADS,       ALIAS_THREADS,       NULL, USAGE_THREADS,       1, true, false }
         ,{ OPTION_COVERAGE,      ALIAS_COVERAGE,      NULL, USAGE_COVERAGE,      1, false,false }
         ,{ OPTION_INPUT_FILE,    ALIAS_INPUT_FILE,    NULL, USAGE_INPUT_FILE,    1, true, false }
+        ,{ OPTION_QUERY_FILE,    NULL,                NULL, USAGE_QUERY_FILE,    1, true, false }
         ,{ OPTION_COUNT_STRAND,  NULL,                NULL, USAGE_COUNT_STRAND,  1, true, false }
         ,{ OPTION_ALG,           NULL,                NULL, USAGE_ALG,           1, true, false }
 #if SECRET_OPTION != 0
@@ -1140,7 +1148,8 @@ BREAK_ALIGNMENT_ITER:
     }
 
     void print_variation_specs ( char const* ref_slice, size_t ref_slice_size,
-        KSearch::CVRefVariation const& obj, const char* query, size_t query_len )
+        KSearch::CVRefVariation const& obj, const char* query, size_t query_len,
+        char const* ref_acc, int64_t ref_pos_var, size_t var_len_on_ref )
     {
         if ( g_Params.verbosity >= NSRefVariation::VERBOSITY_SOME_DETAILS )
         {
@@ -1165,8 +1174,8 @@ BREAK_ALIGNMENT_ITER:
                 ( klogInfo,
                 "Input variation spec   : $(REFACC):$(REFPOSVAR):$(VARLENONREF):$(QUERY)",
                 "REFACC=%s,REFPOSVAR=%ld,VARLENONREF=%lu,QUERY=%.*s",
-                g_Params.ref_acc, g_Params.ref_pos_var,
-                g_Params.var_len_on_ref, query_len, query
+                ref_acc, ref_pos_var,
+                var_len_on_ref, query_len, query
                 ));
 
             size_t allele_size = obj.GetAlleleSize();
@@ -1175,20 +1184,21 @@ BREAK_ALIGNMENT_ITER:
                 ( klogInfo,
                 "Adjusted variation spec: $(REFACC):$(REFPOSVAR):$(VARLENONREF):$(ALLELE)",
                 "REFACC=%s,REFPOSVAR=%ld,VARLENONREF=%lu,ALLELE=%.*s",
-                g_Params.ref_acc, obj.GetAlleleStartAbsolute(),
+                ref_acc, obj.GetAlleleStartAbsolute(),
                 obj.GetAlleleLenOnRef(), (int)allele_size, allele
                 ));
         }
     }
 
     void get_ref_var_object (KSearch::CVRefVariation& obj,
-        char const* query, size_t query_len, ngs::ReferenceSequence const& ref_seq)
+        char const* query, size_t query_len, ngs::ReferenceSequence const& ref_seq,
+        char const* ref_acc, int64_t ref_pos_var, size_t var_len_on_ref)
     {
         size_t var_len = query_len;
 
         size_t chunk_size = 5000; // TODO: add the method Reference[Sequence].getChunkSize() to the API
-        size_t chunk_no = g_Params.ref_pos_var / chunk_size;
-        size_t ref_pos_in_slice = g_Params.ref_pos_var % chunk_size;
+        size_t chunk_no = ref_pos_var / chunk_size;
+        size_t ref_pos_in_slice = ref_pos_var % chunk_size;
         size_t bases_start = chunk_no * chunk_size;
         size_t chunk_no_last = ref_seq.getLength() / chunk_size;
 
@@ -1199,22 +1209,23 @@ BREAK_ALIGNMENT_ITER:
         {
             ngs::StringRef ref_chunk = ref_seq.getReferenceChunk ( bases_start );
 
-            if ( ! check_ref_slice (ref_chunk.data() + ref_pos_in_slice, g_Params.var_len_on_ref) )
+            if ( ! check_ref_slice (ref_chunk.data() + ref_pos_in_slice, var_len_on_ref) )
             {
                 throw Utils::CErrorMsg (
                     "The selected reference region [%.*s] does not contain valid bases, "
                     "exiting...",
-                    (int)g_Params.var_len_on_ref, ref_chunk.data() + ref_pos_in_slice );
+                    (int)var_len_on_ref, ref_chunk.data() + ref_pos_in_slice );
             }
 
             cont = Common::find_variation_core_step ( obj, g_Params.alg,
                 ref_chunk.data(), ref_chunk.size(), ref_pos_in_slice,
-                query, var_len, g_Params.var_len_on_ref,
+                query, var_len, var_len_on_ref,
                 chunk_size, chunk_no_last, bases_start, chunk_no_start, chunk_no_end );
 
             if ( !cont )
             {
-                print_variation_specs ( ref_chunk.data(), ref_chunk.size(), obj, query, query_len );
+                print_variation_specs ( ref_chunk.data(), ref_chunk.size(), obj, query, query_len,
+                    ref_acc, ref_pos_var, var_len_on_ref );
             }
         }
 
@@ -1229,10 +1240,11 @@ BREAK_ALIGNMENT_ITER:
 
                 cont = Common::find_variation_core_step ( obj, g_Params.alg,
                     ref_slice.c_str(), ref_slice.size(), ref_pos_in_slice,
-                    query, var_len, g_Params.var_len_on_ref,
+                    query, var_len, var_len_on_ref,
                     chunk_size, chunk_no_last, bases_start, chunk_no_start, chunk_no_end );
             }
-            print_variation_specs ( ref_slice.c_str(), ref_slice.size(), obj, query, query_len );
+            print_variation_specs ( ref_slice.c_str(), ref_slice.size(), obj, query, query_len,
+                    ref_acc, ref_pos_var, var_len_on_ref );
         }
     }
 
@@ -1299,12 +1311,14 @@ BREAK_ALIGNMENT_ITER:
         ngs::StringRef query = ref_seq.getReferenceChunk ( start, len );
         if ( query.size() == len )
         {
-            get_ref_var_object ( obj, query.data(), query.size(), ref_seq );
+            get_ref_var_object ( obj, query.data(), query.size(), ref_seq,
+                g_Params.ref_acc, g_Params.ref_pos_var, g_Params.var_len_on_ref );
         }
         else
         {
             ngs::String query_copy = ref_seq.getReferenceBases ( start, len );
-            get_ref_var_object ( obj, query_copy.c_str(), query_copy.size(), ref_seq );
+            get_ref_var_object ( obj, query_copy.c_str(), query_copy.size(), ref_seq,
+                g_Params.ref_acc, g_Params.ref_pos_var, g_Params.var_len_on_ref );
         }
     }
 
@@ -1332,7 +1346,8 @@ BREAK_ALIGNMENT_ITER:
         {
             char const* query = get_query ( g_Params.query,
                 g_Params.query_min_rep + i, generated_query );
-            get_ref_var_object ( vec_obj [i], query, strlen(query), ref_seq );
+            get_ref_var_object ( vec_obj [i], query, strlen(query), ref_seq,
+                g_Params.ref_acc, g_Params.ref_pos_var, g_Params.var_len_on_ref );
         }
 
         check_var_objects (vec_obj);
@@ -1341,6 +1356,462 @@ BREAK_ALIGNMENT_ITER:
         return 0;
     }
 
+    /////////////////////////////
+    // batch mode: many (reference, position, variation) queries at once
+
+    // queries closer than this are looked up with a single alignment slice
+    size_t const BATCH_WINDOW_GAP = 512;
+    // but a window does not grow longer than this
+    size_t const BATCH_WINDOW_MAX = 16 * 1024;
+
+    struct CBatchQuery
+    {
+        // as given in the query file
+        std::string ref_acc;
+        int64_t ref_pos_var;
+        size_t var_len_on_ref;
+        std::string query;
+
+        // search parameters of the adjusted variation: computed once,
+        // read-only when runs are processed by threads
+        std::string variation;
+        size_t var_start;
+        size_t slice_size;
+    };
+
+    struct CBatchWindow
+    {
+        std::string ref_acc;
+        size_t start, end; // [start, end) on the reference
+        size_t first, count; // range in the sorted order of queries
+    };
+
+    struct CBatch
+    {
+        std::vector <CBatchQuery> queries;  // in query file order
+        std::vector <size_t> order;         // sorted by reference and position
+        std::vector <CBatchWindow> windows;
+    };
+
+    struct batch_counts
+    {
+        size_t total, total_negative;
+        size_t matched, matched_negative;
+    };
+
+    void load_batch_queries ( char const* path, CBatch& batch )
+    {
+        std::ifstream input_file( path );
+        if ( !input_file.good() )
+            throw Utils::CErrorMsg( "Failed to open file %s", path );
+
+        std::string line;
+        size_t line_no = 0;
+        while ( std::getline ( input_file, line) )
+        {
+            ++ line_no;
+            if ( line.empty() || line[0] == '#' )
+                continue;
+
+            char ref_acc[256], query[256];
+            long long pos;
+            unsigned long len;
+            if ( sscanf ( line.c_str(), "%255s\t%lld\t%lu\t%255s", ref_acc, & pos, & len, query ) != 4 || pos < 0 )
+            {
+                throw Utils::CErrorMsg(
+                    "Failed to parse line # %lu from file %s", line_no, path );
+            }
+            if ( strspn ( query, "ACGTNacgtn.-" ) != strlen ( query ) )
+            {
+                throw Utils::CErrorMsg(
+                    "Invalid query at line # %lu from file %s", line_no, path );
+            }
+
+            CBatchQuery q;
+            q.ref_acc = ref_acc;
+            q.ref_pos_var = pos;
+            q.var_len_on_ref = len;
+            q.query = strcmp ( query, "-" ) == 0 ? "" : query;
+            q.var_start = q.slice_size = 0;
+            batch.queries.push_back ( q );
+        }
+    }
+
+    struct CBatchQueryLess
+    {
+        CBatchQueryLess ( std::vector <CBatchQuery> const& queries ) : m_queries ( queries ) {}
+        bool operator() ( size_t a, size_t b ) const
+        {
+            CBatchQuery const& qa = m_queries [a];
+            CBatchQuery const& qb = m_queries [b];
+            if ( qa.ref_acc != qb.ref_acc )
+                return qa.ref_acc < qb.ref_acc;
+            if ( qa.var_start != qb.var_start )
+                return qa.var_start < qb.var_start;
+            return a < b;
+        }
+        std::vector <CBatchQuery> const& m_queries;
+    };
+
+    // every reference is opened once and every variation is adjusted once,
+    // then the queries are sorted and grouped into reference windows
+    void prepare_batch ( CBatch& batch )
+    {
+        std::vector <CBatchQuery>& queries = batch.queries;
+
+        batch.order.resize ( queries.size() );
+        for ( size_t i = 0; i < queries.size(); ++i )
+            batch.order [i] = i;
+
+        // pass 1: by reference only, to open each reference once
+        std::sort ( batch.order.begin(), batch.order.end(), CBatchQueryLess ( queries ) );
+
+        for ( size_t first = 0; first < batch.order.size(); )
+        {
+            std::string const& ref_acc = queries [ batch.order [first] ].ref_acc;
+            ngs::ReferenceSequence ref_seq = ncbi::NGS::openReferenceSequence ( ref_acc );
+
+            size_t i = first;
+            for ( ; i < batch.order.size() && queries [ batch.order [i] ].ref_acc == ref_acc; ++i )
+            {
+                CBatchQuery& q = queries [ batch.order [i] ];
+
+                KSearch::CVRefVariation obj;
+                get_ref_var_object ( obj, q.query.c_str(), q.query.size(), ref_seq,
+                    q.ref_acc.c_str(), q.ref_pos_var, q.var_len_on_ref );
+
+                q.variation.assign ( obj.GetSearchQuery(), obj.GetSearchQuerySize() );
+                q.var_start = obj.GetSearchQueryStartAbsolute();
+                q.slice_size = obj.GetSearchQueryLenOnRef();
+                if ( q.slice_size == 0 )
+                    q.slice_size = 1; // for a pure insertion we at least a slice of length == 1
+            }
+            first = i;
+        }
+
+        // pass 2: by adjusted position
+        std::sort ( batch.order.begin(), batch.order.end(), CBatchQueryLess ( queries ) );
+
+        for ( size_t i = 0; i < batch.order.size(); ++i )
+        {
+            CBatchQuery const& q = queries [ batch.order [i] ];
+            size_t q_end = q.var_start + q.slice_size;
+
+            if ( ! batch.windows.empty() )
+            {
+                CBatchWindow& w = batch.windows.back();
+                if ( w.ref_acc == q.ref_acc
+                    && q.var_start <= w.end + BATCH_WINDOW_GAP
+                    && q_end - w.start <= BATCH_WINDOW_MAX )
+                {
+                    if ( q_end > w.end )
+                        w.end = q_end;
+                    ++ w.count;
+                    continue;
+                }
+            }
+
+            CBatchWindow w;
+            w.ref_acc = q.ref_acc;
+            w.start = q.var_start;
+            w.end = q_end;
+            w.first = i;
+            w.count = 1;
+            batch.windows.push_back ( w );
+        }
+
+        if ( g_Params.verbosity >= NSRefVariation::VERBOSITY_SOME_DETAILS )
+        {
+            PLOGMSG ( klogInfo,
+                ( klogInfo,
+                "$(QUERYCOUNT) queries grouped into $(WINDOWCOUNT) reference windows",
+                "QUERYCOUNT=%zu,WINDOWCOUNT=%zu", queries.size(), batch.windows.size()
+                ));
+        }
+    }
+
+    // the same test as in find_alignments_in_run_db, for one query
+    void match_batch_query ( ngs::AlignmentIterator const& ai, CBatchQuery const& q,
+        batch_counts& counts )
+    {
+        if ( ! g_Params.calc_coverage && counts.matched != 0 )
+            return; // without -c only the fact of a match is reported
+
+        uint64_t ref_pos_range = ai.getReferencePositionProjectionRange ( q.var_start );
+        if ( ref_pos_range == (uint64_t)-1 ) // effectively, checking that read doesn't start past ref_start
+            return;
+
+        int64_t align_pos_first = (int64_t)( ref_pos_range >> 32);
+        int64_t align_pos_count = ref_pos_range & 0xFFFFFFFF;
+
+        // checking that read doesn't end before ref slice ends
+        if ( (int64_t) ai.getAlignmentLength() - align_pos_first < (int64_t)q.slice_size )
+            return;
+
+        ngs::StringRef bases = ai.getAlignedFragmentBases ();
+
+        ++ counts.total;
+        bool is_negative = g_Params.count_strand != COUNT_STRAND_NONE
+            && ai.getIsReversedOrientation();
+        if ( g_Params.count_strand == COUNT_STRAND_COUNTERALIGNED && ! is_primary_mate ( ai ) )
+            is_negative = ! is_negative;
+
+        if (is_negative)
+            ++ counts.total_negative;
+
+        char const* bases_data = bases.data();
+        size_t bases_size = bases.size();
+        size_t var_size = q.variation.size();
+
+        for (int64_t i = 0; i < align_pos_count; ++i)
+        {
+            int64_t align_pos = align_pos_first + i;
+            if ( bases_size + align_pos >= var_size
+                && strncmp ( q.variation.c_str(), bases_data + align_pos, var_size ) == 0 )
+            {
+                ++ counts.matched;
+                if (is_negative)
+                    ++ counts.matched_negative;
+                break; // an alignment is counted once, whatever position matched
+            }
+        }
+    }
+
+    void print_batch_counts ( std::ostream& out, size_t count, size_t negative )
+    {
+        out << "\t" << count;
+        if ( g_Params.count_strand != COUNT_STRAND_NONE )
+            out << "," << count - negative;
+    }
+
+    // one scan of the run per reference window; the output of the run is
+    // buffered and written with a single lock
+    template <class TLock> void find_batch_in_single_run ( CInputRun const& input_run,
+        CBatch const* pbatch, TLock* lock_cout, size_t thread_num )
+    {
+        CBatch const& batch = *pbatch;
+        char const* acc = input_run.GetRunName().c_str();
+        char const* path = input_run.GetRunPath().c_str();
+
+        ncbi::ReadCollection run = ncbi::NGS::openReadCollection ( path && path[0] ? path : acc );
+
+        std::vector <batch_counts> counts ( batch.queries.size() );
+        memset ( & counts [0], 0, counts.size() * sizeof counts [0] );
+
+        std::vector <CBatchWindow> const& windows = batch.windows;
+        for ( size_t first = 0; first < windows.size(); )
+        {
+            std::string const& ref_acc = windows [first].ref_acc;
+            size_t last = first;
+            for ( ; last < windows.size() && windows [last].ref_acc == ref_acc; ++last );
+
+            if ( ! run.hasReference ( ref_acc ) )
+            {
+                if ( g_Params.verbosity >= NSRefVariation::VERBOSITY_MORE_DETAILS )
+                {
+                    LOCK_GUARD l(*lock_cout);
+                    PLOGMSG ( klogInfo,
+                        ( klogInfo,
+                        "[$(THREAD_NUM)] reference $(REFNAME) NOT FOUND in $(ACC), skipping",
+                        "THREAD_NUM=%zu,REFNAME=%s,ACC=%s", thread_num, ref_acc.c_str(), acc
+                        ));
+                }
+                first = last;
+                continue;
+            }
+
+            ngs::Reference reference = run.getReference ( ref_acc );
+            for ( ; first < last; ++first )
+            {
+                CBatchWindow const& w = windows [first];
+
+                // TODO: remove C-cast to ngs::Alignment::AlignmentFilter
+                // when it's fixed in ngs api
+                ngs::AlignmentIterator ai = reference.getFilteredAlignmentSlice (
+                    w.start, w.end - w.start, ngs::Alignment::all, (ngs::Alignment::AlignmentFilter)0, 0);
+
+                while ( ai.nextAlignment() )
+                {
+                    for ( size_t i = w.first; i < w.first + w.count; ++i )
+                    {
+                        size_t q = batch.order [i];
+                        match_batch_query ( ai, batch.queries [q], counts [q] );
+                    }
+                }
+            }
+        }
+
+        std::ostringstream out;
+        for ( size_t q = 0; q < batch.queries.size(); ++q )
+        {
+            CBatchQuery const& query = batch.queries [q];
+            batch_counts const& c = counts [q];
+
+            if ( ! g_Params.calc_coverage && c.matched == 0 )
+                continue;
+
+            out << acc
+                << "\t" << query.ref_acc << ":" << query.ref_pos_var << ":" << query.var_len_on_ref
+                << ":" << ( query.query.empty() ? "-" : query.query );
+            if ( g_Params.calc_coverage )
+            {
+                print_batch_counts ( out, c.matched, c.matched_negative );
+                print_batch_counts ( out, c.total, c.total_negative );
+            }
+            out << "\n";
+        }
+
+        LOCK_GUARD l(*lock_cout);
+        std::cout << out.str() << std::flush;
+    }
+
+    template <class TLock> void find_batch ( CBatch const* pbatch,
+        TLock* lock_cout, size_t thread_num, CInputRuns const* p_input_runs,
+        KApp::CProgressBar* progress_bar )
+    {
+        try
+        {
+            for ( ; ; )
+            {
+                CInputRun const& input_run = p_input_runs -> Get( p_input_runs -> GetNextIndex() );
+                if ( ! input_run.IsValid() )
+                    break;
+
+                try
+                {
+                    find_batch_in_single_run ( input_run, pbatch, lock_cout, thread_num );
+                }
+                catch ( ngs::ErrorMsg const& e )
+                {
+                    if ( strstr (e.what(), "Cannot open accession") == e.what() )
+                    {
+                        if ( g_Params.verbosity >= NSRefVariation::VERBOSITY_MORE_DETAILS )
+                        {
+                            LOCK_GUARD l(*lock_cout);
+                            PLOGMSG ( klogWarn,
+                                ( klogWarn,
+                                "[$(THREAD_NUM)] $(WHAT), skipping",
+                                "THREAD_NUM=%zu,WHAT=%s", thread_num, e.what()
+                                ));
+                        }
+                    }
+                    else
+                        throw;
+                }
+
+                {
+                    LOCK_GUARD l(*lock_cout);
+                    progress_bar -> Process( 1, false );
+                }
+
+                if ( ::Quitting() )
+                {
+                    LOCK_GUARD l(*lock_cout);
+                    PLOGMSG ( klogWarn,
+                        ( klogWarn,
+                        "[$(THREAD_NUM)] Interrupted",
+                        "THREAD_NUM=%zu", thread_num
+                        ));
+                    break;
+                }
+            }
+        }
+        catch ( ngs::ErrorMsg const& e )
+        {
+            LOCK_GUARD l(*lock_cout); // reuse cout mutex
+            PLOGMSG ( klogErr,
+                ( klogErr,
+                "[$(THREAD_NUM)] ngs::ErrorMsg: $(WHAT)",
+                "THREAD_NUM=%zu,WHAT=%s", thread_num, e.what()
+                ));
+        }
+        catch (...)
+        {
+            LOCK_GUARD l(*lock_cout); // reuse cout mutex
+            Utils::HandleException ();
+        }
+    }
+
+#if CPP_THREADS == 0
+    struct AdapterFindBatch
+    {
+        KProc::CKThread thread;
+
+        CBatch const* pbatch;
+        LOCK* lock_cout;
+        size_t thread_num;
+        CInputRuns const* p_input_runs;
+        KApp::CProgressBar* progress_bar;
+    };
+
+    rc_t AdapterFindBatchFunc ( void* data )
+    {
+        AdapterFindBatch& p = * (static_cast<AdapterFindBatch*>(data));
+        find_batch ( p.pbatch, p.lock_cout, p.thread_num, p.p_input_runs, p.progress_bar );
+        return 0;
+    }
+#endif
+
+    int find_variation_batch_impl (KApp::CArgs const& args)
+    {
+        KApp::CProgressBar progress_bar(1);
+        progress_bar.Process ( 0, true );
+
+        CBatch batch;
+        load_batch_queries ( g_Params.query_file, batch );
+        if ( batch.queries.empty() )
+            return 0;
+
+        prepare_batch ( batch );
+
+        CInputRuns input_runs ( args );
+
+        size_t param_count = input_runs.GetCount();
+        progress_bar.Append ( param_count );
+
+        if ( param_count == 0 )
+            return 0;
+
+        size_t thread_count = g_Params.thread_count < param_count ? g_Params.thread_count : param_count;
+        if ( thread_count <= 1 )
+        {
+            CNoMutex mtx;
+            find_batch ( & batch, & mtx, 0, & input_runs, & progress_bar );
+        }
+        else
+        {
+            LOCK mutex_cout;
+#if CPP_THREADS != 0
+            std::vector<std::thread> vec_threads;
+            for (size_t i = 0; i < thread_count; ++i)
+            {
+                vec_threads.push_back(
+                    std::thread( find_batch <LOCK>, & batch, & mutex_cout, i + 1,
+                                 & input_runs, & progress_bar ));
+            }
+            for (std::thread& th : vec_threads)
+                th.join();
+#else
+            std::vector<AdapterFindBatch> vec_threads ( thread_count );
+            for (size_t i = 0; i < thread_count; ++i)
+            {
+                AdapterFindBatch & params = vec_threads [ i ];
+                params.pbatch = & batch;
+                params.lock_cout = & mutex_cout;
+                params.thread_num = i + 1;
+                params.p_input_runs = & input_runs;
+                params.progress_bar = & progress_bar;
+
+                params.thread.Make ( AdapterFindBatchFunc, & params );
+            }
+            for (std::vector<AdapterFindBatch>::iterator it = vec_threads.begin(); it != vec_threads.end(); ++it)
+                it->thread.Wait();
+#endif
+        }
+
+        return 0;
+    }
+
 #if SECRET_OPTION != 0
     void get_ref_bases ( int64_t offset, uint64_t len, std::string & ret,
         VDBObjects::CVCursor const& cursor,
@@ -1643,7 +2114,10 @@ BREAK_ALIGNMENT_ITER:
         int ret = 0;
         try
         {
-            ret = find_variation_region_impl ( args );
+            if ( g_Params.query_file [0] != '\0' )
+                ret = find_variation_batch_impl ( args );
+            else
+                ret = find_variation_region_impl ( args );
         }
         catch ( ngs::ErrorMsg const& e )
         {
@@ -1670,8 +2144,22 @@ BREAK_ALIGNMENT_ITER:
             args.MakeAndHandle (argc, argv, Options, countof (Options), ::XMLLogger_Args, ::XMLLogger_ArgsQty);
             KApp::CXMLLogger xml_logger ( args );
 
-            // Actually GetOptionCount check is not needed here since
-            // CArgs checks that exactly 1 option is required
+            if (args.GetOptionCount (OPTION_QUERY_FILE) == 1)
+                g_Params.query_file = args.GetOptionValue ( OPTION_QUERY_FILE, 0 );
+            else if ( args.GetOptionCount (OPTION_REFERENCE_ACC) != 1
+                || args.GetOptionCount (OPTION_REF_POS) != 1
+                || args.GetOptionCount (OPTION_QUERY) != 1
+                || args.GetOptionCount (OPTION_VAR_LEN_ON_REF) != 1 )
+            {
+                PLOGMSG ( klogErr,
+                    ( klogErr,
+                    "$(PROGNAME): $(REF), $(POS), $(QUERY) and $(VARLEN) options are required unless $(QUERYFILE) is given",
+                    "PROGNAME=%s,REF=%s,POS=%s,QUERY=%s,VARLEN=%s,QUERYFILE=%s",
+                    argv [0], OPTION_REFERENCE_ACC, OPTION_REF_POS, OPTION_QUERY,
+                    OPTION_VAR_LEN_ON_REF, OPTION_QUERY_FILE
+                    ));
+                return 3;
+            }
 
             if (args.GetOptionCount (OPTION_REFERENCE_ACC) == 1)
                 g_Params.ref_acc = args.GetOptionValue ( OPTION_REFERENCE_ACC, 0 );
@@ -1971,10 +2459,11 @@ extern "C"
         OUTMSG ((
         "Usage example:\n"
         "  %s -r <reference accession> -p <position on reference> -q <query to look for> -l 0 [<parameters>]\n"
+        "  %s --query-file <file with queries> [<parameters>]\n"
         "\n"
         "Summary:\n"
         "  Find a possible indel window\n"
-        "\n", progname));
+        "\n", progname, progname));
         return 0;
     }
 
@@ -2002,6 +2491,7 @@ extern "C"
         HelpOptionLine (NSRefVariation::ALIAS_THREADS, NSRefVariation::OPTION_THREADS, "value", NSRefVariation::USAGE_THREADS);
         HelpOptionLine (NSRefVariation::ALIAS_COVERAGE, NSRefVariation::OPTION_COVERAGE, "", NSRefVariation::USAGE_COVERAGE);
         HelpOptionLine (NSRefVariation::ALIAS_INPUT_FILE, NSRefVariation::OPTION_INPUT_FILE, "string", NSRefVariation::USAGE_INPUT_FILE);
+        HelpOptionLine (NULL, NSRefVariation::OPTION_QUERY_FILE, "string", NSRefVariation::USAGE_QUERY_FILE);
         HelpOptionLine (NULL, NSRefVariation::OPTION_COUNT_STRAND, "value", NSRefVariation::USAGE_COUNT_STRAND);
         HelpOptionLine (NULL, NSRefVariation::OPTION_ALG, "value", NSRefVariation::USAGE_ALG);
         //HelpOptionLine (NSRefVariation::ALIAS_VERBOSITY, NSRefVariation::OPTION_VERBOSITY, "", NSRefVariation::USAGE_VERBOSITY);
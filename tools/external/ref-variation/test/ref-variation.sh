@@ -10,6 +10,28 @@ function Case(){
     diff expected/$TESTCASE.out $TESTCASE.out >>diff.out
 }
 
+# the counts of a --query-file run must be the ones of running its queries
+# one -q at a time; rows are keyed by run and query number
+function BatchCase(){
+    TESTCASE=$1
+    QUERIES=$2
+    shift 2
+    PARAMS=$*
+    rm -f $TESTCASE.single.out
+    n=0
+    grep -v '^#' $QUERIES | while read ref pos len query
+    do
+        n=$((n+1))
+        $BINDIR/ref-variation --no-user-settings --algorithm=ra -L err -r $ref -p $pos -l $len --query "$query" $PARAMS 2>>$TESTCASE.err |
+            awk -v n=$n '{ print $1 "\t" n "\t" $2 "\t" $3 }' >>$TESTCASE.single.out
+    done
+    cmd="$BINDIR/ref-variation --no-user-settings --algorithm=ra -L err --query-file $QUERIES $PARAMS 2>>$TESTCASE.err"
+    echo "$cmd"
+    eval $cmd | awk '{ n[$1]++; print $1 "\t" n[$1] "\t" $3 "\t" $4 }' >$TESTCASE.batch.out
+    sort $TESTCASE.single.out >$TESTCASE.out
+    sort $TESTCASE.batch.out | diff $TESTCASE.out - >>diff.out
+}
+
 if [ "$(uname)" = "Darwin" ]
 then
 	echo "ref-variation test is disabled for Mac"
@@ -32,6 +54,8 @@ else
 	Case 15 -r CM000684.1 -p 36662045 --query - -l 6 -c SRR1597729
 	Case 16 -r NC_000001.10 -p 570000 -l 1 --query A 2>&1 > 16.out
 	Case 17 -L err -c -t 1 -r NC_000002.11 -p 73613067 --query "-" -l 3 -i ref-variation.in
+	BatchCase 18 ref-variation.queries -c -t 1 SRR867061 SRR867131
+	BatchCase 19 ref-variation.queries -c -t 1 --count-strand counteraligned SRR867061 SRR867131
     if [ -s diff.out ]; 
     then
         exit 1
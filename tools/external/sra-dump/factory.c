@@ -157,6 +157,35 @@ void SRASplitterFactory_FilerReport(uint64_t* total, uint64_t* biggest_file)
     }
 }
 
+static
+const char* SRASplitterFiler_KeyStart(const char* key)
+{
+    if( g_filer->key_as_dir ) {
+        /* skip initial non-letters */
+        while( !isalnum(*key) && *key != '\0' ) {
+            ++key;
+        }
+    }
+    return key;
+}
+
+/* appends i-th element of the path to a file key */
+static
+void SRASplitterFiler_AppendKey(char* key, int i, const char* elem)
+{
+    if( elem[0] == '\0' ) {
+        return;
+    }
+    if( g_filer->key_as_dir ) {
+        if( i != 0 ) {
+            strcat(key, "/");
+        }
+    } else if( i != 0 && isalnum(elem[0]) ) {
+        strcat(key, "_");
+    }
+    strcat(key, elem);
+}
+
 static
 rc_t SRASplitterFiler_PushKey(const char* key)
 {
@@ -166,12 +195,7 @@ rc_t SRASplitterFiler_PushKey(const char* key)
     if( g_filer->path_tail == sizeof(g_filer->path) - 1 ) {
         return RC(rcExe, rcFile, rcAttaching, rcDirEntry, rcTooLong);
     }
-    if( g_filer->key_as_dir ) {
-        /* skip initial non-letters */
-        while( !isalnum(*key) && *key != '\0' ) {
-            ++key;
-        }
-    }
+    key = SRASplitterFiler_KeyStart(key);
     g_filer->path[g_filer->path_tail++] = key;
     g_filer->path_len += strlen(key) + 1;
     return 0;
@@ -344,20 +368,7 @@ rc_t SRASplitterFiler_GetCurrFile(const SRASplitterFile** out_file)
          */
         key[0] = '\0';
         for(i = 0; i < g_filer->path_tail; i++ ) {
-            if( g_filer->path[i][0] == '\0' ) {
-                continue;
-            }
-            if( g_filer->key_as_dir ) {
-                if( i != 0 ) {
-                    strcat(key, "/");
-                }
-                strcat(key, g_filer->path[i]);
-            } else {
-                if( i != 0 && isalnum(g_filer->path[i][0]) ) {
-                    strcat(key, "_");
-                }
-                strcat(key, g_filer->path[i]);
-            }
+            SRASplitterFiler_AppendKey(key, i, g_filer->path[i]);
         }
     }
     if( !SLListDoUntil( &g_filer->files, SRASplitterFiler_GetCurrFile_FindByKey, &file ) ) {
@@ -503,6 +514,414 @@ rc_t SRASplitterFactory_FilerInit(bool to_stdout, bool gzip, bool bzip2, bool ke
     return rc;
 }
 
+/* ### Spooled output ######################################################### */
+
+/* output of one splitter tree for a range of spots, kept in memory until it is written into the files */
+typedef struct SRASplitterSpoolFile_struct {
+    SLNode dad;
+    /* key as filer builds it, but without the prefix */
+    char* key;
+    /* elements of the path to the file, each one '\0' terminated */
+    char* path;
+    int path_qty;
+    KDataBuffer data;
+    uint64_t size;
+    /* keep track of number of spots written to file */
+    spotid_t curr_spot;
+    uint64_t spot_qty;
+    /* file was activated since last detach */
+    bool active;
+} SRASplitterSpoolFile;
+
+struct SRASplitterSpool {
+    /* path of current spot through the tree, prefix is not here */
+    int path_tail;
+    const char* path[DUMPER_MAX_TREE_DEPTH];
+    SLList files;
+    /* keep track of number of spots written */
+    spotid_t curr_spot;
+    uint64_t spot_qty;
+};
+
+typedef struct SRASplitterChunkFile_struct {
+    SLNode dad;
+    const SRASplitterSpoolFile* file;
+    KDataBuffer data;
+    uint64_t size;
+    uint64_t spot_qty;
+} SRASplitterChunkFile;
+
+struct SRASplitterChunk {
+    SLList files;
+    uint64_t spot_qty;
+};
+
+static
+void CC SRASplitterSpool_WhackFile( SLNode *node, void *data )
+{
+    SRASplitterSpoolFile* file = (SRASplitterSpoolFile*)node;
+
+    KDataBufferWhack(&file->data);
+    free(file->key);
+    free(file->path);
+    free(file);
+}
+
+rc_t SRASplitterSpool_Make(SRASplitterSpool** self)
+{
+    if( self == NULL ) {
+        return RC(rcExe, rcFile, rcConstructing, rcParam, rcNull);
+    }
+    if( g_filer == NULL ) {
+        return RC(rcExe, rcFile, rcConstructing, rcSelf, rcNotOpen);
+    }
+    *self = calloc(1, sizeof(**self));
+    if( *self == NULL ) {
+        return RC(rcExe, rcFile, rcConstructing, rcMemory, rcExhausted);
+    }
+    SLListInit(&(*self)->files);
+    return 0;
+}
+
+void SRASplitterSpool_Release(SRASplitterSpool* self)
+{
+    if( self != NULL ) {
+        SLListWhack(&self->files, SRASplitterSpool_WhackFile, NULL);
+        free(self);
+    }
+}
+
+static
+rc_t SRASplitterSpool_PushKey(SRASplitterSpool* self, const char* key)
+{
+    if( key == NULL ) {
+        return RC(rcExe, rcFile, rcAttaching, rcParam, rcNull);
+    }
+    if( self->path_tail == sizeof(self->path) / sizeof(self->path[0]) ) {
+        return RC(rcExe, rcFile, rcAttaching, rcDirEntry, rcTooLong);
+    }
+    self->path[self->path_tail++] = SRASplitterFiler_KeyStart(key);
+    return 0;
+}
+
+static
+rc_t SRASplitterSpool_PopKey(SRASplitterSpool* self)
+{
+    if( self->path_tail == 0 ) {
+        return RC(rcExe, rcFile, rcDetaching, rcDirEntry, rcTooShort);
+    }
+    self->path_tail--;
+    return 0;
+}
+
+static
+bool CC SRASplitterSpool_FindByKey( SLNode *node, void *data )
+{
+    SRASplitterSpoolFile** d = (SRASplitterSpoolFile**)data;
+    SRASplitterSpoolFile* file = (SRASplitterSpoolFile*)node;
+
+    if( strcmp(file->key, (*d)->key) == 0 ) {
+        *d = file;
+        return true;
+    }
+    return false;
+}
+
+/* same as SRASplitterFiler_GetCurrFile, but the file is in memory */
+static
+rc_t SRASplitterSpool_GetCurrFile(SRASplitterSpool* self, SRASplitterSpoolFile** out_file)
+{
+    rc_t rc = 0;
+    int i;
+    size_t path_sz = 0;
+    char key[sizeof(g_filer->key_buf)];
+    SRASplitterSpoolFile probe, *file = &probe;
+
+    key[0] = '\0';
+    if( g_filer->kf_stdout ) {
+        strcpy(key, "stdout");
+    } else {
+        for(i = 0; i < self->path_tail; i++ ) {
+            /* prefix is always the 1st element in filer's path */
+            SRASplitterFiler_AppendKey(key, i + 1, self->path[i]);
+        }
+    }
+    probe.key = key;
+    if( !SLListDoUntil(&self->files, SRASplitterSpool_FindByKey, &file) ) {
+        SRA_DUMP_DBG(5, ("New spooled file: '%s'\n", key));
+        for(i = 0; i < self->path_tail; i++ ) {
+            path_sz += strlen(self->path[i]) + 1;
+        }
+        file = calloc(1, sizeof(*file));
+        if( file == NULL ) {
+            rc = RC(rcExe, rcFile, rcResolving, rcMemory, rcExhausted);
+        } else {
+            file->key = string_dup(key, string_size(key));
+            file->path = malloc(path_sz + 1);
+            if( file->key == NULL || file->path == NULL ) {
+                rc = RC(rcExe, rcFile, rcResolving, rcMemory, rcExhausted);
+            } else if( (rc = KDataBufferMakeBytes(&file->data, 0)) == 0 ) {
+                char* p = file->path;
+                for(i = 0; i < self->path_tail; i++ ) {
+                    size_t sz = strlen(self->path[i]) + 1;
+                    memmove(p, self->path[i], sz);
+                    p += sz;
+                }
+                file->path_qty = self->path_tail;
+                SLListPushTail(&self->files, &file->dad);
+            }
+            if( rc != 0 ) {
+                free(file->key);
+                free(file->path);
+                free(file);
+                file = NULL;
+            }
+        }
+    }
+    if( rc == 0 ) {
+        file->active = true;
+    }
+    *out_file = file;
+    return rc;
+}
+
+static
+rc_t SRASplitterSpool_FileWrite(SRASplitterSpool* self, SRASplitterSpoolFile* f, spotid_t spot, const void* buf, size_t size)
+{
+    rc_t rc = 0;
+
+    if( KDataBufferBytes(&f->data) < f->size + size ) {
+        rc = KDataBufferResize(&f->data, f->size + size + DATABUFFER_INC_SZ);
+    }
+    if( rc == 0 ) {
+        memmove(&((char*)f->data.base)[f->size], buf, size);
+        f->size += size;
+        if( f->curr_spot != spot && spot != 0 ) {
+            f->curr_spot = spot;
+            f->spot_qty = f->spot_qty + 1;
+        }
+        if( self->curr_spot != spot && spot != 0 ) {
+            self->curr_spot = spot;
+            self->spot_qty = self->spot_qty + 1;
+        }
+    }
+    return rc;
+}
+
+typedef struct SRASplitterSpool_DetachData_struct {
+    rc_t rc;
+    SRASplitterChunk* chunk;
+} SRASplitterSpool_DetachData;
+
+static
+bool CC SRASplitterSpool_DetachFile( SLNode *node, void *data )
+{
+    SRASplitterSpoolFile* file = (SRASplitterSpoolFile*)node;
+    SRASplitterSpool_DetachData* d = (SRASplitterSpool_DetachData*)data;
+
+    if( file->active ) {
+        SRASplitterChunkFile* cf = calloc(1, sizeof(*cf));
+        if( cf == NULL ) {
+            d->rc = RC(rcExe, rcFile, rcDetaching, rcMemory, rcExhausted);
+        } else {
+            /* hand the data over to the chunk */
+            cf->file = file;
+            cf->data = file->data;
+            cf->size = file->size;
+            cf->spot_qty = file->spot_qty;
+            SLListPushTail(&d->chunk->files, &cf->dad);
+            file->size = 0;
+            file->spot_qty = 0;
+            file->active = false;
+            d->rc = KDataBufferMakeBytes(&file->data, 0);
+        }
+    }
+    return d->rc != 0;
+}
+
+rc_t SRASplitterSpool_Detach(SRASplitterSpool* self, SRASplitterChunk** chunk)
+{
+    rc_t rc = 0;
+
+    if( self == NULL || chunk == NULL ) {
+        rc = RC(rcExe, rcFile, rcDetaching, rcParam, rcNull);
+    } else if( (*chunk = calloc(1, sizeof(**chunk))) == NULL ) {
+        rc = RC(rcExe, rcFile, rcDetaching, rcMemory, rcExhausted);
+    } else {
+        SRASplitterSpool_DetachData d;
+        d.rc = 0;
+        d.chunk = *chunk;
+        SLListInit(&(*chunk)->files);
+        SLListDoUntil(&self->files, SRASplitterSpool_DetachFile, &d);
+        (*chunk)->spot_qty = self->spot_qty;
+        self->spot_qty = 0;
+        rc = d.rc;
+        if( rc != 0 ) {
+            SRASplitterChunk_Release(*chunk);
+            *chunk = NULL;
+        }
+    }
+    return rc;
+}
+
+static
+bool CC SRASplitterChunk_WriteFile( SLNode *node, void *data )
+{
+    const SRASplitterChunkFile* cf = (const SRASplitterChunkFile*)node;
+    rc_t* rc = (rc_t*)data;
+    const char* p = cf->file->path;
+    const SRASplitterFile* cfile = NULL;
+    int i, pushed = 0;
+
+    for(i = 0; *rc == 0 && i < cf->file->path_qty; i++ ) {
+        if( (*rc = SRASplitterFiler_PushKey(p)) == 0 ) {
+            pushed++;
+        }
+        p += strlen(p) + 1;
+    }
+    if( *rc == 0 ) {
+        *rc = SRASplitterFiler_GetCurrFile(&cfile);
+    }
+    while( pushed-- > 0 ) {
+        SRASplitterFiler_PopKey();
+    }
+    if( *rc == 0 && cf->size > 0 ) {
+        size_t writ = 0;
+        SRASplitterFile* f = (SRASplitterFile*)cfile;
+        *rc = KFileWriteAll(f->file, f->pos, cf->data.base, cf->size, &writ);
+        if( *rc == 0 ) {
+            f->pos += writ;
+        }
+    }
+    if( *rc == 0 ) {
+        ((SRASplitterFile*)cfile)->spot_qty += cf->spot_qty;
+    }
+    return *rc != 0;
+}
+
+rc_t SRASplitterChunk_Write(const SRASplitterChunk* self)
+{
+    rc_t rc = 0;
+
+    if( self == NULL ) {
+        rc = RC(rcExe, rcFile, rcWriting, rcParam, rcNull);
+    } else if( g_filer == NULL ) {
+        rc = RC(rcExe, rcFile, rcWriting, rcSelf, rcNotOpen);
+    } else {
+        SLListDoUntil(&self->files, SRASplitterChunk_WriteFile, &rc);
+        if( rc == 0 ) {
+            g_filer->spot_qty += self->spot_qty;
+        }
+    }
+    return rc;
+}
+
+static
+void CC SRASplitterChunk_WhackFile( SLNode *node, void *data )
+{
+    SRASplitterChunkFile* cf = (SRASplitterChunkFile*)node;
+
+    KDataBufferWhack(&cf->data);
+    free(cf);
+}
+
+void SRASplitterChunk_Release(SRASplitterChunk* self)
+{
+    if( self != NULL ) {
+        SLListWhack(&self->files, SRASplitterChunk_WhackFile, NULL);
+        free(self);
+    }
+}
+
+/* ### Interned keys ########################################################## */
+
+/* keys are interned by factories before any splitter runs, ids are reused by all splitter trees */
+typedef struct SRASplitterKey {
+    BSTNode node;
+    uint32_t id;
+    char text[1];
+} SRASplitterKey;
+
+static struct {
+    BSTree tree;
+    /* by id - DUMPER_EMPTY_KEY_ID - 1 */
+    SRASplitterKey** keys;
+    uint32_t qty;
+    uint32_t max;
+} g_keys;
+
+static
+int64_t CC SRASplitterKey_Find(const void* item, const BSTNode* node)
+{
+    return strcmp((const char*)item, ((const SRASplitterKey*)node)->text);
+}
+
+static
+int64_t CC SRASplitterKey_Cmp(const BSTNode* item, const BSTNode* node)
+{
+    return strcmp(((const SRASplitterKey*)item)->text, ((const SRASplitterKey*)node)->text);
+}
+
+rc_t SRASplitter_KeyIntern(const char* key, uint32_t* id)
+{
+    const SRASplitterKey* found = NULL;
+    SRASplitterKey* k = NULL;
+    size_t sz;
+
+    if( key == NULL || id == NULL ) {
+        return RC(rcExe, rcNode, rcInserting, rcParam, rcNull);
+    }
+    if( key[0] == '\0' ) {
+        *id = DUMPER_EMPTY_KEY_ID;
+        return 0;
+    }
+    if( (found = (const SRASplitterKey*)BSTreeFind(&g_keys.tree, key, SRASplitterKey_Find)) != NULL ) {
+        *id = found->id;
+        return 0;
+    }
+    if( g_keys.qty == g_keys.max ) {
+        uint32_t max = g_keys.max == 0 ? 64 : g_keys.max * 2;
+        SRASplitterKey** p = realloc(g_keys.keys, sizeof(*g_keys.keys) * max);
+        if( p == NULL ) {
+            return RC(rcExe, rcNode, rcInserting, rcMemory, rcExhausted);
+        }
+        g_keys.keys = p;
+        g_keys.max = max;
+    }
+    sz = strlen(key);
+    if( (k = malloc(sizeof(*k) + sz)) == NULL ) {
+        return RC(rcExe, rcNode, rcInserting, rcMemory, rcExhausted);
+    }
+    memmove(k->text, key, sz + 1);
+    k->id = DUMPER_EMPTY_KEY_ID + 1 + g_keys.qty;
+    BSTreeInsert(&g_keys.tree, &k->node, SRASplitterKey_Cmp);
+    g_keys.keys[g_keys.qty++] = k;
+    *id = k->id;
+    return 0;
+}
+
+const char* SRASplitter_KeyText(uint32_t id)
+{
+    if( id == DUMPER_EMPTY_KEY_ID ) {
+        return "";
+    }
+    if( id > DUMPER_EMPTY_KEY_ID && id - DUMPER_EMPTY_KEY_ID <= g_keys.qty ) {
+        return g_keys.keys[id - DUMPER_EMPTY_KEY_ID - 1]->text;
+    }
+    return NULL;
+}
+
+void SRASplitter_KeysRelease(void)
+{
+    uint32_t i;
+
+    for( i = 0; i < g_keys.qty; i++ ) {
+        free(g_keys.keys[i]);
+    }
+    free(g_keys.keys);
+    memset(&g_keys, 0, sizeof(g_keys));
+}
+
 /* ### Base splitter code ##################################################### */
 
 /* used to detect correct object pointers */
@@ -532,6 +951,13 @@ struct SRASplitter {
     SRASplitter_Release_Func* Release;
     BSTree children;
     SRASplitter_Child* last_found;
+    /* children by interned key id, filled as keys are seen */
+    SRASplitter_Child** by_id;
+    uint32_t by_id_max;
+    /* set if the tree writes into memory instead of files */
+    SRASplitterSpool* spool;
+    /* keys leading to this splitter, separated by '\1', only set for spooled trees */
+    char* path;
 };
 
 struct SRASplitter_Child {
@@ -543,6 +969,8 @@ struct SRASplitter_Child {
         const SRASplitter* splitter;
         /* file object for self type of eSplitterFormat */
         const SRASplitterFile* file;
+        /* same for spooled trees */
+        SRASplitterSpoolFile* spooled;
     } child;
 };
 
@@ -620,6 +1048,42 @@ int64_t CC SRASplitter_Child_Find(const void* item, const BSTNode* node)
     return strcmp(key, n->key);
 }
 
+static
+rc_t SRASplitter_ResolveSelf(const SRASplitter* self, enum RCContext ctx, SRASplitter** resolved);
+
+/* makes child of a spooled splitter spooled too */
+static
+rc_t SRASplitter_Inherit(const SRASplitter* cchild, const SRASplitter* parent, const char* key)
+{
+    SRASplitter* child = NULL;
+    rc_t rc = SRASplitter_ResolveSelf(cchild, rcAttaching, &child);
+
+    if( rc == 0 ) {
+        size_t sz = strlen(parent->path) + strlen(key) + 2;
+        child->spool = parent->spool;
+        child->path = malloc(sz);
+        if( child->path == NULL ) {
+            rc = RC(rcExe, rcNode, rcAttaching, rcMemory, rcExhausted);
+        } else {
+            /* '\1' sorts before any key character, so paths sort like the tree is walked */
+            sprintf(child->path, "%s\1%s", parent->path, key);
+        }
+    }
+    return rc;
+}
+
+static
+rc_t SRASplitter_PushKey(const SRASplitter* self, const char* key)
+{
+    return self->spool != NULL ? SRASplitterSpool_PushKey(self->spool, key) : SRASplitterFiler_PushKey(key);
+}
+
+static
+rc_t SRASplitter_PopKey(const SRASplitter* self)
+{
+    return self->spool != NULL ? SRASplitterSpool_PopKey(self->spool) : SRASplitterFiler_PopKey();
+}
+
 static /* not virtual, self is direct pointer to base type here !!! */
 rc_t SRASplitter_FindNextSplitter(SRASplitter* self, const char* key)
 {
@@ -632,7 +1096,10 @@ rc_t SRASplitter_FindNextSplitter(SRASplitter* self, const char* key)
             const SRASplitter* splitter = NULL;
             SRA_DUMP_DBG(5, ("New splitter on key '%s'\n", key));
             if( (rc = SRASplitterFactory_NewObj(self->next_fact, &splitter)) == 0 ) {
-                if( (rc = SRASplitter_Child_MakeSplitter(&self->last_found, key, splitter)) == 0 ) {
+                if( self->spool != NULL ) {
+                    rc = SRASplitter_Inherit(splitter, self, key);
+                }
+                if( rc == 0 && (rc = SRASplitter_Child_MakeSplitter(&self->last_found, key, splitter)) == 0 ) {
                     if( (rc = BSTreeInsertUnique(&self->children, &self->last_found->node, NULL, SRASplitter_Child_Cmp)) != 0 ) {
                         SRASplitter_Child_Whack(&self->last_found->node, NULL);
                         self->last_found = NULL;
@@ -646,6 +1113,29 @@ rc_t SRASplitter_FindNextSplitter(SRASplitter* self, const char* key)
     return rc;
 }
 
+static /* not virtual, self is direct pointer to base type here !!! */
+rc_t SRASplitter_FindNextSplitterId(SRASplitter* self, uint32_t id, const char* key)
+{
+    rc_t rc = 0;
+
+    if( id != 0 && id < self->by_id_max && self->by_id[id] != NULL ) {
+        self->last_found = self->by_id[id];
+    } else if( (rc = SRASplitter_FindNextSplitter(self, key)) == 0 && id != 0 ) {
+        if( id >= self->by_id_max ) {
+            uint32_t max = id + 16;
+            SRASplitter_Child** p = realloc(self->by_id, sizeof(*self->by_id) * max);
+            if( p == NULL ) {
+                return RC(rcExe, rcNode, rcInserting, rcMemory, rcExhausted);
+            }
+            memset(&p[self->by_id_max], 0, sizeof(*p) * (max - self->by_id_max));
+            self->by_id = p;
+            self->by_id_max = max;
+        }
+        self->by_id[id] = self->last_found;
+    }
+    return rc;
+}
+
 static /* not virtual, self is direct pointer to base type here !!! */
 rc_t SRASplitter_FindNextFile(SRASplitter* self, const char* key)
 {
@@ -656,18 +1146,28 @@ rc_t SRASplitter_FindNextFile(SRASplitter* self, const char* key)
         if( self->last_found == NULL ) {
             /* create new child using global filer */
             const SRASplitterFile* file = NULL;
+            SRASplitterSpoolFile* spooled = NULL;
             SRA_DUMP_DBG(5, ("New file on key '%s'\n", key));
-            if( (rc = SRASplitterFiler_GetCurrFile(&file)) == 0 ) {
-                if( (rc = SRASplitter_Child_MakeFile(&self->last_found, key, file)) == 0 ) {
-                    if( (rc = BSTreeInsertUnique(&self->children, &self->last_found->node, NULL, SRASplitter_Child_Cmp)) != 0 ) {
-                        SRASplitter_Child_Whack(&self->last_found->node, NULL);
-                        self->last_found = NULL;
-                    }
+            if( self->spool != NULL ) {
+                if( (rc = SRASplitterSpool_GetCurrFile(self->spool, &spooled)) == 0 &&
+                    (rc = SRASplitter_Child_Make(&self->last_found, key)) == 0 ) {
+                    self->last_found->child.spooled = spooled;
+                }
+            } else if( (rc = SRASplitterFiler_GetCurrFile(&file)) == 0 ) {
+                rc = SRASplitter_Child_MakeFile(&self->last_found, key, file);
+            }
+            if( rc == 0 ) {
+                if( (rc = BSTreeInsertUnique(&self->children, &self->last_found->node, NULL, SRASplitter_Child_Cmp)) != 0 ) {
+                    SRASplitter_Child_Whack(&self->last_found->node, NULL);
+                    self->last_found = NULL;
                 }
             }
         }
     }
-    if( rc == 0 ) {
+    if( rc == 0 && self->spool != NULL ) {
+        /* several keys can share a file, e.g. stdout */
+        self->last_found->child.spooled->active = true;
+    } else if( rc == 0 ) {
         /* make sure file is opened */
         rc = SRASplitterFiler_OpenFile((SRASplitterFile*)(self->last_found->child.file), false);
     }
@@ -742,7 +1242,8 @@ rc_t SRASplitter_AddSpot( const SRASplitter * cself, spotid_t spot, readmask_t *
                     /* merge readmasks from duplicate keys in array */
                     for ( j = i + 1; j < key_qty; j++ )
                     {
-                        if ( keys[ i ].key == keys[ j ].key || strcmp( keys[ i ].key, keys[ j ].key ) == 0 )
+                        if ( keys[ i ].id != 0 && keys[ j ].id != 0 ? keys[ i ].id == keys[ j ].id :
+                             keys[ j ].key != NULL && ( keys[ i ].key == keys[ j ].key || strcmp( keys[ i ].key, keys[ j ].key ) == 0 ) )
                         {
                             set_readmask( used_readmasks, j );
                             for ( k = 0; k < nreads_max; k++ )
@@ -764,17 +1265,17 @@ rc_t SRASplitter_AddSpot( const SRASplitter * cself, spotid_t spot, readmask_t *
                     if ( j > 0 )
 #endif
                     {
-                        rc = SRASplitter_FindNextSplitter( self, keys[ i ].key );
+                        rc = SRASplitter_FindNextSplitterId( self, keys[ i ].id, keys[ i ].key );
                         if ( rc == 0 )
                         {
                             /* push spot to next splitter in chain */
-                            rc = SRASplitterFiler_PushKey( self->last_found->key );
+                            rc = SRASplitter_PushKey( self, self->last_found->key );
                             if ( rc == 0 )
                             {
                                 /* here comes RECURSION!!! */
                                 rc_t rc2;
                                 rc = SRASplitter_AddSpot( self->last_found->child.splitter, spot, local_readmask );
-                                rc2 = SRASplitterFiler_PopKey();
+                                rc2 = SRASplitter_PopKey( self );
                                 rc = rc ? rc : rc2;
                             }
                         }
@@ -804,17 +1305,18 @@ rc_t SRASplitter_AddSpot( const SRASplitter * cself, spotid_t spot, readmask_t *
                 if ( j > 0 )
 #endif
                 {
-                    rc = SRASplitter_FindNextSplitter( self, key );
+                    /* most filters pass everything on the empty key */
+                    rc = SRASplitter_FindNextSplitterId( self, key[ 0 ] == '\0' ? DUMPER_EMPTY_KEY_ID : 0, key );
                     if ( rc == 0 )
                     {
                         /* push spot to next splitter in chain */
-                        rc = SRASplitterFiler_PushKey( self->last_found->key );
+                        rc = SRASplitter_PushKey( self, self->last_found->key );
                         if ( rc == 0 )
                         {
                             /* here comes RECURSION!!! */
                             rc_t rc2;
                             rc = SRASplitter_AddSpot( self->last_found->child.splitter, spot, readmask );
-                            rc2 = SRASplitterFiler_PopKey();
+                            rc2 = SRASplitter_PopKey( self );
                             rc = rc ? rc : rc2;
                         }
                     }
@@ -845,22 +1347,152 @@ rc_t SRASplitter_Release(const SRASplitter* cself)
                 rc = self->Release(cself);
             }
             BSTreeWhack( &self->children, SRASplitter_Child_Whack, NULL );
+            free(self->by_id);
+            free(self->path);
             free(self);
         }
     }
     return rc;
 }
 
+rc_t SRASplitter_Spool(const SRASplitter* cself, SRASplitterSpool* spool)
+{
+    rc_t rc = 0;
+    SRASplitter* self = NULL;
+
+    if( spool == NULL ) {
+        rc = RC(rcExe, rcNode, rcAttaching, rcParam, rcNull);
+    } else if( (rc = SRASplitter_ResolveSelf(cself, rcAttaching, &self)) == 0 ) {
+        if( self->spool != NULL || BSTreeFirst(&self->children) != NULL ) {
+            rc = RC(rcExe, rcNode, rcAttaching, rcSelf, rcBusy);
+        } else if( (self->path = string_dup("", 1)) == NULL ) {
+            rc = RC(rcExe, rcNode, rcAttaching, rcMemory, rcExhausted);
+        } else {
+            self->spool = spool;
+        }
+    }
+    return rc;
+}
+
+typedef struct SRASplitterRejected_struct {
+    SLNode dad;
+    char* path;
+    char* what;
+    uint64_t qty;
+} SRASplitterRejected;
+
+/* counts of spooled trees, sorted by path and text */
+static SLList g_rejected;
+
+typedef struct SRASplitterRejected_FindData_struct {
+    const SRASplitter* self;
+    const char* what;
+    SRASplitterRejected* found;
+    SRASplitterRejected* prev;
+} SRASplitterRejected_FindData;
+
+static
+bool CC SRASplitterRejected_Find( SLNode *node, void *data )
+{
+    SRASplitterRejected* r = (SRASplitterRejected*)node;
+    SRASplitterRejected_FindData* d = (SRASplitterRejected_FindData*)data;
+    int diff = strcmp(r->path, d->self->path);
+
+    if( diff == 0 ) {
+        /* READS before SPOTS, as filters report them */
+        diff = strcmp(r->what, d->what);
+    }
+    if( diff == 0 ) {
+        d->found = r;
+        return true;
+    }
+    if( diff > 0 ) {
+        return true;
+    }
+    d->prev = r;
+    return false;
+}
+
+rc_t SRASplitter_Rejected(const SRASplitter* cself, uint64_t qty, const char* what)
+{
+    rc_t rc = 0;
+    SRASplitter* self = NULL;
+
+    if( what == NULL ) {
+        rc = RC(rcExe, rcNode, rcWriting, rcParam, rcNull);
+    } else if( (rc = SRASplitter_ResolveSelf(cself, rcWriting, &self)) == 0 ) {
+        if( self->path == NULL ) {
+            rc = KOutMsg("Rejected %lu %s\n", qty, what);
+        } else {
+            SRASplitterRejected_FindData d;
+            d.self = self;
+            d.what = what;
+            d.found = NULL;
+            d.prev = NULL;
+            SLListDoUntil(&g_rejected, SRASplitterRejected_Find, &d);
+            if( d.found != NULL ) {
+                d.found->qty += qty;
+            } else if( (d.found = calloc(1, sizeof(*d.found))) == NULL ) {
+                rc = RC(rcExe, rcNode, rcWriting, rcMemory, rcExhausted);
+            } else {
+                d.found->path = string_dup(self->path, string_size(self->path));
+                d.found->what = string_dup(what, string_size(what));
+                d.found->qty = qty;
+                if( d.found->path == NULL || d.found->what == NULL ) {
+                    free(d.found->path);
+                    free(d.found->what);
+                    free(d.found);
+                    rc = RC(rcExe, rcNode, rcWriting, rcMemory, rcExhausted);
+                } else if( d.prev == NULL ) {
+                    SLListPushHead(&g_rejected, &d.found->dad);
+                } else {
+                    /* insert after prev */
+                    d.found->dad.next = d.prev->dad.next;
+                    d.prev->dad.next = &d.found->dad;
+                    if( g_rejected.tail == &d.prev->dad ) {
+                        g_rejected.tail = &d.found->dad;
+                    }
+                }
+            }
+        }
+    }
+    return rc;
+}
+
+static
+void CC SRASplitterRejected_Report( SLNode *node, void *data )
+{
+    SRASplitterRejected* r = (SRASplitterRejected*)node;
+    rc_t* rc = (rc_t*)data;
+    rc_t rc2 = KOutMsg("Rejected %lu %s\n", r->qty, r->what);
+
+    if( *rc == 0 ) {
+        *rc = rc2;
+    }
+    free(r->path);
+    free(r->what);
+    free(r);
+}
+
+rc_t SRASplitter_ReportRejected(void)
+{
+    rc_t rc = 0;
+
+    SLListWhack(&g_rejected, SRASplitterRejected_Report, &rc);
+    SLListInit(&g_rejected);
+    return rc;
+}
+
 rc_t SRASplitter_FileActivate(const SRASplitter* cself, const char* key)
 {
     rc_t rc = 0, rc2 = 0;
     SRASplitter* self = NULL;
 
     if( (rc = SRASplitter_ResolveSelf(cself, rcExecuting, &self)) == 0 ) {
-        if( (rc = SRASplitterFiler_PushKey(key)) == 0 ) {
+        if( (rc = SRASplitter_PushKey(self, key)) == 0 ) {
             /* sets self->last_found */
             rc = SRASplitter_FindNextFile(self, key);
-            rc2 = SRASplitterFiler_PopKey();
+            rc2 = SRASplitter_PopKey(self);
             rc = rc ? rc : rc2;
         }
     }
@@ -878,6 +1510,10 @@ rc_t SRASplitter_FileWrite( const SRASplitter* cself, spotid_t spot, const void*
         {
             rc = RC( rcExe, rcFile, rcWriting, rcDirEntry, rcUnknown );
         }
+        else if ( buf != NULL && size > 0 && self->spool != NULL )
+        {
+            rc = SRASplitterSpool_FileWrite( self->spool, self->last_found->child.spooled, spot, buf, size );
+        }
         else if ( buf != NULL && size > 0 )
         {
             size_t writ = 0;
@@ -914,6 +1550,11 @@ rc_t SRASplitter_FileWritePos( const SRASplitter* cself, spotid_t spot,
         {
             rc = RC( rcExe, rcFile, rcWriting, rcDirEntry, rcUnknown );
         }
+        else if ( self->spool != NULL )
+        {
+            /* position in the file is not known until the spool is written */
+            rc = RC( rcExe, rcFile, rcWriting, rcFunction, rcUnsupported );
+        }
         else if ( buf != NULL && size > 0 )
         {
             const SRASplitterFile* f = self->last_found->child.file;
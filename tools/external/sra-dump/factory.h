@@ -74,9 +74,22 @@ extern bool g_legacy_report;
 
 typedef struct SRASplitter_Keys_struct {
     const char* key;
+    /* optional id of key from SRASplitter_KeyIntern, 0 if key is not interned */
+    uint32_t id;
     make_readmask(readmask);
 } SRASplitter_Keys;
 
+/* id of "" which needs not to be interned */
+#define DUMPER_EMPTY_KEY_ID 1
+
+/**
+  * Interned keys let splitters find the next splitter by id instead of comparing strings for every spot.
+  * Intern keys from factory Init only, before any splitter tree runs, text is valid until SRASplitter_KeysRelease
+  */
+rc_t SRASplitter_KeyIntern(const char* key, uint32_t* id);
+const char* SRASplitter_KeyText(uint32_t id);
+void SRASplitter_KeysRelease(void);
+
 /* for eSpot splitter: returns pointer to key and (optionally) modified readmask, based on spotid and readmask
    key == NULL stops further processing of the spot, char* key alloc and dealloc must be handled by splitter itself
  */
@@ -132,6 +145,37 @@ rc_t SRASplitter_FileActivate(const SRASplitter* self, const char* key);
 rc_t SRASplitter_FileWrite( const SRASplitter* cself, spotid_t spot, const void* buf, size_t size );
 rc_t SRASplitter_FileWritePos( const SRASplitter* cself, spotid_t spot, uint64_t pos, const void* buf, size_t size );
 
+/**
+  * Report number of rejected reads or spots: "Rejected <qty> <what>"
+  * for spooled trees counts of all trees are summed up and reported by SRASplitter_ReportRejected
+  */
+rc_t SRASplitter_Rejected(const SRASplitter* self, uint64_t qty, const char* what);
+rc_t SRASplitter_ReportRejected(void);
+
+/**
+  * Spooled output: allows to run several splitter trees in parallel, each on its own range of spots.
+  * A spooled tree writes into memory, the data is detached from the spool as a chunk
+  * and chunks are written into the files by single thread in order of spots.
+  */
+typedef struct SRASplitterSpool SRASplitterSpool;
+typedef struct SRASplitterChunk SRASplitterChunk;
+
+/* call after SRASplitterFactory_FilerInit */
+rc_t SRASplitterSpool_Make(SRASplitterSpool** self);
+void SRASplitterSpool_Release(SRASplitterSpool* self);
+
+/* self [IN] - root of a fresh splitter tree, all its children will write into spool */
+rc_t SRASplitter_Spool(const SRASplitter* self, SRASplitterSpool* spool);
+
+/* spooled trees report rejects into a common list, release them from a single thread */
+
+/* takes the data written into spool so far, chunk refers to spool, release chunk first */
+rc_t SRASplitterSpool_Detach(SRASplitterSpool* self, SRASplitterChunk** chunk);
+
+/* writes the data into the files, must not be called concurrently */
+rc_t SRASplitterChunk_Write(const SRASplitterChunk* self);
+void SRASplitterChunk_Release(SRASplitterChunk* self);
+
 typedef struct SRASplitterFactory SRASplitterFactory;
 
 typedef rc_t (SRASplitterFactory_Init_Func)(const SRASplitterFactory* self);
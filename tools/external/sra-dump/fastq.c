@@ -68,6 +68,8 @@ typedef struct TMatepairDistance_struct
 } TMatepairDistance;
 
 
+typedef struct Defline_struct Defline;
+
 struct FastqArgs_struct
 {
     bool is_platform_cs_native;
@@ -86,9 +88,9 @@ struct FastqArgs_struct
     bool qual_filter;
     bool qual_filter1;
     const char* b_deffmt;
-    SLList* b_defline;
+    Defline* b_defline;
     const char* q_deffmt;
-    SLList* q_defline;
+    Defline* q_defline;
     const char *desiredCsKey;
     bool split_files;
     bool split_3;
@@ -136,8 +138,6 @@ typedef struct DefNode_struct
 
 typedef struct DeflineData_struct
 {
-    rc_t rc;
-    bool optional;
     union
     {
         spotid_t* id;
@@ -154,109 +154,149 @@ typedef struct DeflineData_struct
 } DeflineData;
 
 
-static bool CC Defline_Builder( SLNode *node, void *data )
+/* compiled defline: a flat array of nodes with the literal text concatenated,
+   an optional group is one node followed by its member nodes */
+typedef struct DefOp_struct
 {
-    DefNode* n = ( DefNode* )node;
-    DeflineData* d = ( DeflineData* )data;
-    char s[ 256 ];
-    size_t w;
-    int x = 0;
+    DefNodeType type;
+    /* DefNode_Text: length of text, DefNode_Optional: number of nodes in the group */
+    uint32_t len;
+    const char* text;
+} DefOp;
 
-    s[ 0 ] = '\0';
-    switch ( n->type )
+
+struct Defline_struct
+{
+    DefOp* ops;
+    uint32_t qty;
+    char* text;
+};
+
+
+static size_t Defline_Int( char* s, int64_t value )
+{
+    char tmp[ 24 ];
+    size_t i = sizeof( tmp ), x;
+    uint64_t v = value < 0 ? -( uint64_t )value : ( uint64_t )value;
+
+    do
     {
-        case DefNode_Optional :
-            d->optional = true;
-            w = *d->writ;
-            *d->writ = 0;
-            SLListDoUntil( n->data.optional, Defline_Builder, data );
-            x = ( *d->writ == 0 ) ? 0 : 1;
-            d->optional = false;
-            *d->writ = w;
-            if ( x > 0 )
-            {
-                SLListDoUntil( n->data.optional, Defline_Builder, data );
-            }
-            break;
+        tmp[ --i ] = '0' + ( v % 10 );
+        v /= 10;
+    } while ( v > 0 );
+    if ( value < 0 )
+    {
+        tmp[ --i ] = '-';
+    }
+    x = sizeof( tmp ) - i;
+    memmove( s, &tmp[ i ], x );
+    return x;
+}
 
-        case DefNode_Text :
-            if ( d->optional )
-            {
-                break;
-            }
-            d->values[n->type].str.s = n->data.text;
-            d->values[n->type].str.sz = strlen( n->data.text );
 
+/* same as variable printed in optional part of format: nonempty string or nonzero number */
+static bool Defline_IsSet( const DeflineData* d, const DefOp* op )
+{
+    switch ( op->type )
+    {
         case DefNode_Accession :
         case DefNode_SpotName :
         case DefNode_SpotGroup :
         case DefNode_ReadName :
-            if ( d->values[n->type].str.s != NULL )
-            {
-                x = d->values[ n->type ].str.sz;
-                if ( x < sizeof( s ) )
-                {
-                    strncpy( s, d->values[ n->type ].str.s, x );
-                    s[ x ] = '\0';
-                    *d->writ = *d->writ + x;
-                }
-                else
-                {
-                    d->rc = RC( rcExe, rcNamelist, rcExecuting, rcBuffer, rcInsufficient );
-                }
-            }
-            break;
+            return d->values[ op->type ].str.s != NULL && d->values[ op->type ].str.sz > 0;
 
         case DefNode_SpotId :
-            if ( d->values[ n->type ].id != NULL &&
-                ( !d->optional || *d->values[ n->type ].id > 0 ) )
-            {
-                x = snprintf( s, sizeof( s ), "%lld", (long long int)*d->values[ n->type ].id );
-                if ( x < 0 || x >= sizeof( s ) )
-                {
-                    d->rc = RC( rcExe, rcNamelist, rcExecuting, rcBuffer, rcInsufficient );
-                }
-                else
-                {
-                    *d->writ = *d->writ + x;
-                }
-            }
-            break;
+            return d->values[ op->type ].id != NULL && *d->values[ op->type ].id > 0;
 
         case DefNode_ReadId :
         case DefNode_SpotLen :
         case DefNode_ReadLen :
-            if ( d->values[ n->type] .u32 != NULL &&
-                 ( !d->optional || *d->values[ n->type ].u32 > 0 ) )
-            {
-                x = snprintf( s, sizeof( s ), "%u", *d->values[ n->type ].u32 );
-                if ( x < 0 || x >= sizeof( s ) )
+            return d->values[ op->type ].u32 != NULL && *d->values[ op->type ].u32 > 0;
+
+        default :
+            return false;
+    }
+}
+
+
+static rc_t Defline_Run( const DefOp* op, const DefOp* end, DeflineData* d )
+{
+    char num[ 24 ];
+
+    while ( op < end )
+    {
+        const char* s = NULL;
+        size_t x = 0;
+
+        switch ( op->type )
+        {
+            case DefNode_Optional :
                 {
-                    d->rc = RC( rcExe, rcNamelist, rcExecuting, rcBuffer, rcInsufficient );
+                    const DefOp* grp_end = op + 1 + op->len;
+                    const DefOp* i;
+                    for ( i = op + 1; i < grp_end && !Defline_IsSet( d, i ); i++ )
+                    {
+                    }
+                    if ( i < grp_end )
+                    {
+                        rc_t rc = Defline_Run( op + 1, grp_end, d );
+                        if ( rc != 0 )
+                        {
+                            return rc;
+                        }
+                    }
+                    op = grp_end;
                 }
-                else
+                continue;
+
+            case DefNode_Text :
+                s = op->text;
+                x = op->len;
+                break;
+
+            case DefNode_Accession :
+            case DefNode_SpotName :
+            case DefNode_SpotGroup :
+            case DefNode_ReadName :
+                s = d->values[ op->type ].str.s;
+                x = s != NULL ? d->values[ op->type ].str.sz : 0;
+                break;
+
+            case DefNode_SpotId :
+                if ( d->values[ op->type ].id != NULL )
                 {
-                    *d->writ = *d->writ + x;
+                    s = num;
+                    x = Defline_Int( num, *d->values[ op->type ].id );
                 }
-            }
-            break;
+                break;
 
-        default:
-            d->rc = RC( rcExe, rcNamelist, rcExecuting, rcId, rcInvalid );
-    } /* switch */
+            case DefNode_ReadId :
+            case DefNode_SpotLen :
+            case DefNode_ReadLen :
+                if ( d->values[ op->type ].u32 != NULL )
+                {
+                    s = num;
+                    x = Defline_Int( num, *d->values[ op->type ].u32 );
+                }
+                break;
 
-    if ( d->rc == 0 && !d->optional && n->type != DefNode_Optional )
-    {
-        if ( *d->writ < d->buf_sz )
-        {
-            strcat( d->buf, s );
+            default:
+                return RC( rcExe, rcNamelist, rcExecuting, rcId, rcInvalid );
         }
-        else
+        if ( x > 0 )
         {
-            d->rc = RC( rcExe, rcNamelist, rcExecuting, rcBuffer, rcInsufficient );
+            /* keep room for terminator */
+            if ( *d->writ + x >= d->buf_sz )
+            {
+                *d->writ += x;
+                return RC( rcExe, rcNamelist, rcExecuting, rcBuffer, rcInsufficient );
+            }
+            memmove( &d->buf[ *d->writ ], s, x );
+            *d->writ += x;
         }
+        op++;
     }
-    return d->rc != 0;
+    return 0;
 }
 
 
@@ -289,25 +329,27 @@ static rc_t Defline_Bind( DeflineData* data, const char* accession,
 }
 
 
-static rc_t Defline_Build( const SLList* def, DeflineData* data, char* buf,
+static rc_t Defline_Build( const Defline* def, DeflineData* data, char* buf,
                            size_t buf_sz, size_t* writ )
 {
+    rc_t rc;
+
     if ( data == NULL )
     {
         return RC( rcExe, rcNamelist, rcExecuting, rcMemory, rcInsufficient );
     }
 
-    data->rc = 0;
-    data->optional = false;
     data->buf = buf;
     data->buf_sz = buf_sz;
     data->writ = writ;
 
-    data->buf[ 0 ] = '\0';
     *data->writ = 0;
-
-    SLListDoUntil( def, Defline_Builder, data );
-    return data->rc;
+    rc = Defline_Run( def->ops, def->ops + def->qty, data );
+    if ( rc == 0 )
+    {
+        data->buf[ *data->writ ] = '\0';
+    }
+    return rc;
 }
 
 
@@ -359,7 +401,7 @@ static rc_t DeflineNode_Add( SLList* list, DefNode** node,
 }
 
 
-static void Defline_Release( SLList* list );
+static void DefNodeList_Release( SLList* list );
 
 
 static void CC DeflineNode_Whack( SLNode* node, void* data )
@@ -373,14 +415,14 @@ static void CC DeflineNode_Whack( SLNode* node, void* data )
         }
         else if ( n->type == DefNode_Optional )
         {
-            Defline_Release( n->data.optional );
+            DefNodeList_Release( n->data.optional );
         }
         free( node );
     }
 }
 
 
-static void Defline_Release( SLList* list )
+static void DefNodeList_Release( SLList* list )
 {
     if ( list != NULL )
     {
@@ -390,6 +432,17 @@ static void Defline_Release( SLList* list )
 }
 
 
+static void Defline_Release( Defline* self )
+{
+    if ( self != NULL )
+    {
+        free( self->ops );
+        free( self->text );
+        free( self );
+    }
+}
+
+
 #if _DEBUGGING
 static void CC Defline_Dump( SLNode* node, void* data )
 {
@@ -429,7 +482,7 @@ static void CC Defline_Dump( SLNode* node, void* data )
 #endif
 
 
-static rc_t Defline_Parse( SLList** def, const char* line )
+static rc_t DefNodeList_Parse( SLList** def, const char* line )
 {
     rc_t rc = 0;
     size_t i, sz, text = 0, opt_vars = 0;
@@ -589,6 +642,94 @@ static rc_t Defline_Parse( SLList** def, const char* line )
     return rc;
 }
 
+
+typedef struct DeflineCompile_struct
+{
+    Defline* def;
+    uint32_t qty;
+    size_t text_sz;
+} DeflineCompile;
+
+
+static void CC DeflineNode_Count( SLNode* node, void* data )
+{
+    DefNode* n = ( DefNode* )node;
+    DeflineCompile* c = ( DeflineCompile* )data;
+
+    c->qty++;
+    if ( n->type == DefNode_Text )
+    {
+        c->text_sz += strlen( n->data.text );
+    }
+    else if ( n->type == DefNode_Optional )
+    {
+        SLListForEach( n->data.optional, DeflineNode_Count, data );
+    }
+}
+
+
+static void CC DeflineNode_Compile( SLNode* node, void* data )
+{
+    DefNode* n = ( DefNode* )node;
+    DeflineCompile* c = ( DeflineCompile* )data;
+    DefOp* op = &c->def->ops[ c->def->qty++ ];
+
+    op->type = n->type;
+    if ( n->type == DefNode_Text )
+    {
+        char* t = &c->def->text[ c->text_sz ];
+        op->len = strlen( n->data.text );
+        memmove( t, n->data.text, op->len );
+        op->text = t;
+        c->text_sz += op->len;
+    }
+    else if ( n->type == DefNode_Optional )
+    {
+        uint32_t first = c->def->qty;
+        SLListForEach( n->data.optional, DeflineNode_Compile, data );
+        op->len = c->def->qty - first;
+    }
+}
+
+
+/* turns format into flat program, so per spot build does not walk lists */
+static rc_t Defline_Parse( Defline** def, const char* line )
+{
+    SLList* list = NULL;
+    rc_t rc = DefNodeList_Parse( &list, line );
+
+    if ( rc == 0 )
+    {
+        DeflineCompile c;
+
+        memset( &c, 0, sizeof( c ) );
+        SLListForEach( list, DeflineNode_Count, &c );
+        c.def = calloc( 1, sizeof( *c.def ) );
+        if ( c.def == NULL )
+        {
+            rc = RC( rcExe, rcNamelist, rcConstructing, rcMemory, rcExhausted );
+        }
+        else
+        {
+            c.def->ops = malloc( sizeof( *c.def->ops ) * ( c.qty + 1 ) );
+            c.def->text = malloc( c.text_sz + 1 );
+            if ( c.def->ops == NULL || c.def->text == NULL )
+            {
+                rc = RC( rcExe, rcNamelist, rcConstructing, rcMemory, rcExhausted );
+                Defline_Release( c.def );
+            }
+            else
+            {
+                c.text_sz = 0;
+                SLListForEach( list, DeflineNode_Compile, &c );
+                *def = c.def;
+            }
+        }
+    }
+    DefNodeList_Release( list );
+    return rc;
+}
+
 /* ### ALIGNMENT_COUNT based filtering ##################################################### */
 
 typedef struct AlignedFilter_struct
@@ -648,7 +789,7 @@ static rc_t AlignedFilter_Release( const SRASplitter* cself )
     else
     {
         if ( self->rejected_reads > 0 && !g_legacy_report )
-            rc = KOutMsg( "Rejected %lu READS because of aligned/unaligned filter\n", self->rejected_reads );
+            rc = SRASplitter_Rejected( cself, self->rejected_reads, "READS because of aligned/unaligned filter" );
     }
     return rc;
 }
@@ -860,7 +1001,7 @@ static rc_t AlignRegionFilter_Release( const SRASplitter* cself )
     else
     {
         if ( self->rejected_spots > 0 && !g_legacy_report )
-            rc = KOutMsg( "Rejected %lu SPOTS because of AlignRegionFilter\n", self->rejected_spots );
+            rc = SRASplitter_Rejected( cself, self->rejected_spots, "SPOTS because of AlignRegionFilter" );
     }
     return rc;
 }
@@ -1090,7 +1231,7 @@ static rc_t AlignPairDistanceFilter_Release( const SRASplitter* cself )
     else
     {
         if ( self->rejected_reads > 0 && !g_legacy_report )
-            rc = KOutMsg( "Rejected %lu READS because of AlignPairDistanceFilter\n", self->rejected_reads );
+            rc = SRASplitter_Rejected( cself, self->rejected_reads, "READS because of AlignPairDistanceFilter" );
     }
     return rc;
 }
@@ -1284,7 +1425,7 @@ static rc_t FastqBioFilter_Release( const SRASplitter * cself )
     else
     {
         if ( self->rejected_reads > 0 && !g_legacy_report )
-            rc = KOutMsg( "Rejected %lu READS because of filtering out non-biological READS\n", self->rejected_reads );
+            rc = SRASplitter_Rejected( cself, self->rejected_reads, "READS because of filtering out non-biological READS" );
     }
     return rc;
 }
@@ -1451,10 +1592,11 @@ static rc_t FastqRNumberFilter_Release( const SRASplitter* cself )
     {
         rc = RC( rcExe, rcNode, rcExecuting, rcParam, rcInvalid );
     }
-    else
+    else if ( self->rejected_reads > 0 && !g_legacy_report )
     {
-        if ( self->rejected_reads > 0 && !g_legacy_report )
-            rc = KOutMsg( "Rejected %lu READS because of max. number of READS = %u\n", self->rejected_reads, FastqArgs.maxReads );
+        char what[ 128 ];
+        snprintf( what, sizeof what, "READS because of max. number of READS = %u", FastqArgs.maxReads );
+        rc = SRASplitter_Rejected( cself, self->rejected_reads, what );
     }
     return rc;
 }
@@ -1772,9 +1914,9 @@ static rc_t FastqQFilter_Release( const SRASplitter * cself )
     else if ( !g_legacy_report )
     {
         if ( self->rejected_reads > 0 )
-            rc = KOutMsg( "Rejected %lu READS because of Quality-Filtering\n", self->rejected_reads );
+            rc = SRASplitter_Rejected( cself, self->rejected_reads, "READS because of Quality-Filtering" );
         if ( rc == 0 && self->rejected_spots > 0 )
-            rc = KOutMsg( "Rejected %lu SPOTS because of Quality-Filtering\n", self->rejected_spots );
+            rc = SRASplitter_Rejected( cself, self->rejected_spots, "SPOTS because of Quality-Filtering" );
 
     }
     return rc;
@@ -1975,10 +2117,17 @@ static rc_t FastqReadLenFilter_Release( const SRASplitter * cself )
         rc = RC( rcExe, rcNode, rcExecuting, rcParam, rcInvalid );
     else if ( !g_legacy_report )
     {
+        char what[ 128 ];
         if ( self->rejected_reads > 0 )
-            rc = KOutMsg( "Rejected %lu READS because READLEN < %u\n", self->rejected_reads, FastqArgs.minReadLen );
+        {
+            snprintf( what, sizeof what, "READS because READLEN < %u", FastqArgs.minReadLen );
+            rc = SRASplitter_Rejected( cself, self->rejected_reads, what );
+        }
         if ( self->rejected_spots > 0 && rc == 0 )
-            rc = KOutMsg( "Rejected %lu SPOTS because SPOTLEN < %u\n", self->rejected_spots, FastqArgs.minReadLen );
+        {
+            snprintf( what, sizeof what, "SPOTS because SPOTLEN < %u", FastqArgs.minReadLen );
+            rc = SRASplitter_Rejected( cself, self->rejected_spots, what );
+        }
     }
     return rc;
 }
@@ -2077,7 +2226,68 @@ static rc_t FastqReadLenFilterFactory_Make( const SRASplitterFactory** cself,
 
 /* ============== FASTQ read splitter ============================ */
 
+/* the factories make it before any splitter runs, the splitter trees can be used by several threads */
+static rc_t ReadSplitter_MakeKeyBuf( char** key_buf, uint32_t** key_ids, const size_t key_offset )
+{
+    rc_t rc = 0;
+
+    if ( *key_buf == NULL )
+    {
+        /* initial alloc key_buf: "  1\0  2\0...\0  9\0 10\0 11\0...\03220..\08192\0" */
+        if ( nreads_max > 9999 )
+        {
+            /* key_offset and sprintf format size are insufficient for keys longer than 4 digits */
+            rc = RC( rcExe, rcNode, rcExecuting, rcBuffer, rcInsufficient );
+        }
+        else
+        {
+            char* buf = malloc( nreads_max * key_offset );
+            uint32_t* ids = malloc( nreads_max * sizeof( *ids ) );
+            if ( buf == NULL || ids == NULL )
+            {
+                rc = RC( rcExe, rcNode, rcExecuting, rcMemory, rcExhausted );
+            }
+            else
+            {
+                /* fill buffer w/keys and intern them w/o leading spaces */
+                int i;
+                char* p = buf;
+                for ( i = 1; rc == 0 && i <= nreads_max; i++ )
+                {
+                    if ( sprintf( p, "%4u", i ) <= 0 )
+                    {
+                        rc = RC( rcExe, rcNode, rcExecuting, rcTransfer, rcIncomplete );
+                    }
+                    else
+                    {
+                        const char* k = p;
+                        while ( k[ 0 ] == ' ' )
+                        {
+                            k++;
+                        }
+                        rc = SRASplitter_KeyIntern( k, &ids[ i - 1 ] );
+                    }
+                    p += key_offset;
+                }
+            }
+            if ( rc == 0 )
+            {
+                *key_buf = buf;
+                *key_ids = ids;
+            }
+            else
+            {
+                free( buf );
+                free( ids );
+            }
+        }
+    }
+    return rc;
+}
+
+
 char* FastqReadSplitter_key_buf = NULL;
+uint32_t* FastqReadSplitter_key_ids = NULL;
 
 
 typedef struct FastqReadSplitter_struct
@@ -2104,37 +2314,7 @@ static rc_t FastqReadSplitter_GetKeySet( const SRASplitter* cself, const SRASpli
         uint32_t num_reads = 0;
 
         *keys = 0;
-        if ( FastqReadSplitter_key_buf == NULL )
-        {
-            /* initial alloc key_buf: "  1\0  2\0...\0  9\0 10\0 11\0...\03220..\08192\0" */
-            if ( nreads_max > 9999 )
-            {
-                /* key_offset and sprintf format size are insufficient for keys longer than 4 digits */
-                rc = RC( rcExe, rcNode, rcExecuting, rcBuffer, rcInsufficient );
-            }
-            else
-            {
-                FastqReadSplitter_key_buf = malloc( nreads_max * key_offset );
-                if ( FastqReadSplitter_key_buf == NULL )
-                {
-                    rc = RC( rcExe, rcNode, rcExecuting, rcMemory, rcExhausted );
-                }
-                else
-                {
-                    /* fill buffer w/keys */
-                    int i;
-                    char* p = FastqReadSplitter_key_buf;
-                    for ( i = 1; rc == 0 && i <= nreads_max; i++ )
-                    {
-                        if ( sprintf( p, "%4u", i ) <= 0 )
-                        {
-                            rc = RC( rcExe, rcNode, rcExecuting, rcTransfer, rcIncomplete );
-                        }
-                        p += key_offset;
-                    }
-                }
-            }
-        }
+        rc = ReadSplitter_MakeKeyBuf( &FastqReadSplitter_key_buf, &FastqReadSplitter_key_ids, key_offset );
 
         if ( rc == 0 )
         {
@@ -2169,6 +2349,7 @@ static rc_t FastqReadSplitter_GetKeySet( const SRASplitter* cself, const SRASpli
                             }
                         }
                         self->keys[ good ].key = &FastqReadSplitter_key_buf[ readId * key_offset ];
+                        self->keys[ good ].id = FastqReadSplitter_key_ids[ readId ];
                         while ( self->keys[ good ].key[ 0 ] == ' ' && self->keys[ good ].key[0] != '\0' )
                         {
                             self->keys[ good ].key++;
@@ -2237,6 +2418,10 @@ static rc_t FastqReadSplitterFactory_Init( const SRASplitterFactory* cself )
                               FastqArgs.is_platform_cs_native, false, FastqArgs.fasta > 0, false,
                               false, !FastqArgs.applyClip, FastqArgs.SuppressQualForCSKey, 0,
                               FastqArgs.offset, '\0', 0, 0 );
+        if ( rc == 0 )
+        {
+            rc = ReadSplitter_MakeKeyBuf( &FastqReadSplitter_key_buf, &FastqReadSplitter_key_ids, 5 );
+        }
     }
     return rc;
 }
@@ -2272,6 +2457,8 @@ static void FastqReadSplitterFactory_Release( const SRASplitterFactory* cself )
         FastqReaderWhack( self->reader );
         free( FastqReadSplitter_key_buf );
         FastqReadSplitter_key_buf = NULL;
+        free( FastqReadSplitter_key_ids );
+        FastqReadSplitter_key_ids = NULL;
     }
 }
 
@@ -2306,6 +2493,7 @@ static rc_t FastqReadSplitterFactory_Make( const SRASplitterFactory** cself,
 /* ============== FASTQ 3 read splitter ============================ */
 
 char* Fastq3ReadSplitter_key_buf = NULL;
+uint32_t* Fastq3ReadSplitter_key_ids = NULL;
 
 typedef struct Fastq3ReadSplitter_struct
 {
@@ -2331,37 +2519,7 @@ static rc_t Fastq3ReadSplitter_GetKeySet( const SRASplitter* cself, const SRASpl
         uint32_t num_reads = 0;
 
         *keys = 0;
-        if ( Fastq3ReadSplitter_key_buf == NULL )
-        {
-            /* initial alloc key_buf: "  1\0  2\0...\0  9\0 10\0 11\0...\03220..\08192\0" */
-            if ( nreads_max > 9999 )
-            {
-                /* key_offset and sprintf format size are insufficient for keys longer than 4 digits */
-                rc = RC( rcExe, rcNode, rcExecuting, rcBuffer, rcInsufficient );
-            }
-            else
-            {
-                Fastq3ReadSplitter_key_buf = malloc( nreads_max * key_offset );
-                if ( Fastq3ReadSplitter_key_buf == NULL )
-                {
-                    rc = RC( rcExe, rcNode, rcExecuting, rcMemory, rcExhausted );
-                }
-                else
-                {
-                    /* fill buffer w/keys */
-                    int i;
-                    char* p = Fastq3ReadSplitter_key_buf;
-                    for ( i = 1; rc == 0 && i <= nreads_max; i++ )
-                    {
-                        if ( sprintf( p, "%4u", i ) <= 0 )
-                        {
-                            rc = RC( rcExe, rcNode, rcExecuting, rcTransfer, rcIncomplete );
-                        }
-                        p += key_offset;
-                    }
-                }
-            }
-        }
+        rc = ReadSplitter_MakeKeyBuf( &Fastq3ReadSplitter_key_buf, &Fastq3ReadSplitter_key_ids, key_offset );
 
         if ( rc == 0 )
         {
@@ -2383,6 +2541,7 @@ static rc_t Fastq3ReadSplitter_GetKeySet( const SRASplitter* cself, const SRASpl
                             continue;
                         }
                         self->keys[ good ].key = &Fastq3ReadSplitter_key_buf[ good * key_offset ];
+                        self->keys[ good ].id = Fastq3ReadSplitter_key_ids[ good ];
                         while ( self->keys[ good ].key[ 0 ] == ' ' && self->keys[good].key[ 0 ] != '\0' )
                         {
                             self->keys[ good ].key++;
@@ -2404,6 +2563,7 @@ static rc_t Fastq3ReadSplitter_GetKeySet( const SRASplitter* cself, const SRASpl
                             for ( readId = 0; readId < good; readId++ )
                             {
                                 self->keys[ readId ].key = "";
+                                self->keys[ readId ].id = DUMPER_EMPTY_KEY_ID;
                             }
                             SRA_DUMP_DBG( 3, ( " all keys joined to ''" ) );
                         }
@@ -2450,6 +2610,10 @@ static rc_t Fastq3ReadSplitterFactory_Init( const SRASplitterFactory* cself )
                               FastqArgs.is_platform_cs_native, false, FastqArgs.fasta > 0, false,
                               false, !FastqArgs.applyClip, FastqArgs.SuppressQualForCSKey, 0,
                               FastqArgs.offset, '\0', 0, 0 );
+        if ( rc == 0 )
+        {
+            rc = ReadSplitter_MakeKeyBuf( &Fastq3ReadSplitter_key_buf, &Fastq3ReadSplitter_key_ids, 5 );
+        }
     }
     return rc;
 }
@@ -2487,6 +2651,8 @@ static void Fastq3ReadSplitterFactory_Release( const SRASplitterFactory* cself )
 
         free( Fastq3ReadSplitter_key_buf );
         Fastq3ReadSplitter_key_buf = NULL;
+        free( Fastq3ReadSplitter_key_ids );
+        Fastq3ReadSplitter_key_ids = NULL;
     }
 }
 
@@ -3660,11 +3826,12 @@ rc_t FastqDumper_Factories( const SRADumperFmt* fmt, const SRASplitterFactory**
 
     if ( rc == 0 )
     {
-        if ( FastqArgs.b_deffmt != NULL )
+        /* formats are compiled once, factories are made for every thread */
+        if ( FastqArgs.b_deffmt != NULL && FastqArgs.b_defline == NULL )
         {
             rc = Defline_Parse( &FastqArgs.b_defline, FastqArgs.b_deffmt );
         }
-        if ( FastqArgs.q_deffmt != NULL )
+        if ( rc == 0 && FastqArgs.q_deffmt != NULL && FastqArgs.q_defline == NULL )
         {
             rc = Defline_Parse( &FastqArgs.q_defline, FastqArgs.q_deffmt );
         }
@@ -3808,6 +3975,7 @@ rc_t SRADumper_Init( SRADumperFmt* fmt )
     fmt->gzip = true;
     fmt->bzip2 = true;
     fmt->split_files = false;
+    fmt->parallel = true;
 
     return 0;
 }
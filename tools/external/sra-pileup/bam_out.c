@@ -0,0 +1,1308 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "bam_out.h"
+
+#ifndef _h_klib_out_
+#include <klib/out.h>
+#endif
+
+#ifndef _h_klib_log_
+#include <klib/log.h>
+#endif
+
+#ifndef _h_klib_container_
+#include <klib/container.h>
+#endif
+
+#ifndef _h_klib_text_
+#include <klib/text.h>
+#endif
+
+#ifndef _h_kproc_thread_
+#include <kproc/thread.h>
+#endif
+
+#ifndef _h_kproc_queue_
+#include <kproc/queue.h>
+#endif
+
+#ifndef _h_kproc_timeout_
+#include <kproc/timeout.h>
+#endif
+
+#include <atomic32.h>
+#include <strtol.h>
+#include <sysalloc.h>
+
+#include <zlib.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/* uncompressed payload of a BGZF-block, the same as samtools/htslib use */
+#define BGZF_BLOCK_DATA 0xff00
+/* a compressed BGZF-block can not be bigger than this ( BSIZE is 16 bit ) */
+#define BGZF_MAX_BLOCK 0x10000
+#define BGZF_HDR_LEN 18
+#define BGZF_FTR_LEN 8
+
+/* how many blocks a worker can have in each of its queues */
+#define BAM_QUEUE_DEPTH 2
+/* how long to wait for a queue, before checking if we have to quit */
+#define BAM_WAIT_MS 100
+/* more cigar-operations than this do not fit into the record, they go into the CG-tag */
+#define BAM_MAX_CIGAR_OPS 0xffff
+
+static const uint8_t bgzf_eof[ 28 ] = {
+    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43,
+    0x02, 0x00, 0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+/* ----------------------------------------------------------------------------------- */
+
+typedef struct bam_buf {
+    uint8_t * data;
+    size_t len;
+    size_t size;
+} bam_buf;
+
+static void buf_release( bam_buf * self ) {
+    free( ( void * ) self -> data );
+    self -> data = NULL;
+    self -> len = self -> size = 0;
+}
+
+static rc_t buf_reserve( bam_buf * self, size_t additional ) {
+    rc_t rc = 0;
+    size_t needed = self -> len + additional + 1; /* one more for the terminator */
+    if ( needed > self -> size ) {
+        size_t new_size = self -> size > 0 ? self -> size : 4096;
+        uint8_t * tmp;
+        while ( new_size < needed ) { new_size += new_size; }
+        tmp = realloc( self -> data, new_size );
+        if ( tmp == NULL ) {
+            rc = RC( rcExe, rcBuffer, rcResizing, rcMemory, rcExhausted );
+        } else {
+            self -> data = tmp;
+            self -> size = new_size;
+        }
+    }
+    return rc;
+}
+
+static rc_t buf_add( bam_buf * self, const void * src, size_t len ) {
+    rc_t rc = buf_reserve( self, len );
+    if ( rc == 0 && len > 0 ) {
+        memmove( self -> data + self -> len, src, len );
+        self -> len += len;
+        self -> data[ self -> len ] = 0;
+    }
+    return rc;
+}
+
+static rc_t buf_add_u8( bam_buf * self, uint8_t value ) {
+    return buf_add( self, &value, 1 );
+}
+
+static rc_t buf_add_u16( bam_buf * self, uint16_t value ) {
+    uint8_t b[ 2 ];
+    b[ 0 ] = ( uint8_t )value;
+    b[ 1 ] = ( uint8_t )( value >> 8 );
+    return buf_add( self, b, sizeof b );
+}
+
+static rc_t buf_add_u32( bam_buf * self, uint32_t value ) {
+    uint8_t b[ 4 ];
+    b[ 0 ] = ( uint8_t )value;
+    b[ 1 ] = ( uint8_t )( value >> 8 );
+    b[ 2 ] = ( uint8_t )( value >> 16 );
+    b[ 3 ] = ( uint8_t )( value >> 24 );
+    return buf_add( self, b, sizeof b );
+}
+
+static void put_u16_at( uint8_t * dst, uint16_t value ) {
+    dst[ 0 ] = ( uint8_t )value;
+    dst[ 1 ] = ( uint8_t )( value >> 8 );
+}
+
+static void put_u32_at( uint8_t * dst, uint32_t value ) {
+    dst[ 0 ] = ( uint8_t )value;
+    dst[ 1 ] = ( uint8_t )( value >> 8 );
+    dst[ 2 ] = ( uint8_t )( value >> 16 );
+    dst[ 3 ] = ( uint8_t )( value >> 24 );
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+typedef struct bgzf_block {
+    uint8_t data[ BGZF_BLOCK_DATA ];
+    uint8_t cdata[ BGZF_MAX_BLOCK ];
+    uint32_t data_len;
+    uint32_t cdata_len;
+    rc_t rc;                /* the result of deflating it */
+} bgzf_block;
+
+typedef struct bam_worker {
+    KThread * thread;
+    KQueue * in_q;          /* filled blocks: the writer pushes, the worker pops */
+    KQueue * out_q;         /* deflated blocks: the worker pushes, the writer pops */
+    atomic32_t * quit;      /* shared by all workers, set by the writer */
+    int level;
+} bam_worker;
+
+typedef struct bam_ref {
+    BSTNode node;
+    char * name;
+    size_t name_len;
+    int32_t id;
+    uint32_t len;
+} bam_ref;
+
+typedef struct bam_out {
+    KWrtWriter writer;      /* the KOut-writer at the time we were made */
+    void * writer_data;
+    Vector refs;            /* bam_ref's in the order of the @SQ-lines */
+    BSTree ref_index;       /* the same bam_ref's, by name */
+    bgzf_block * block;     /* the block being filled */
+    bam_worker * workers;
+    uint64_t blocks_sent;
+    uint64_t blocks_written;
+    atomic32_t quit;
+    uint32_t num_workers;
+    uint32_t started;
+    int level;
+    bool header_written;
+} bam_out;
+
+typedef struct bam_rec {
+    const bam_out * out;
+    const bam_ref * last_ref;   /* the records come sorted, most lookups hit this one */
+    bam_buf name;
+    bam_buf cigar;          /* the encoded cigar-operations */
+    bam_buf seq;            /* the bases as text */
+    bam_buf qual;           /* the phred-values */
+    bam_buf tags;           /* the encoded optional fields */
+    bam_buf tmp;            /* one optional field given as text */
+    bam_buf rec;            /* the encoded record */
+    int64_t pos;
+    int64_t mate_pos;
+    int64_t tlen;
+    int64_t ref_span;
+    int32_t ref_id;
+    int32_t mate_ref_id;
+    uint32_t flags;
+    uint32_t mapq;
+    uint32_t n_ops;
+} bam_rec;
+
+static bool timed_out( rc_t rc ) {
+    return ( GetRCState( rc ) == rcExhausted && GetRCObject( rc ) == ( enum RCObject )rcTimeout );
+}
+
+static bool sealed( rc_t rc ) {
+    return ( GetRCState( rc ) == rcDone && GetRCObject( rc ) == ( enum RCObject )rcData );
+}
+
+/* compresses block -> data into block -> cdata, as a complete BGZF-block */
+static rc_t deflate_block( bgzf_block * block, int level ) {
+    rc_t rc = 0;
+    z_stream zs;
+    int zr;
+
+    memset( &zs, 0, sizeof zs );
+    zr = deflateInit2( &zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY );
+    if ( zr != Z_OK ) {
+        rc = RC( rcExe, rcBuffer, rcPacking, rcParam, rcInvalid );
+    } else {
+        zs.next_in = block -> data;
+        zs.avail_in = block -> data_len;
+        zs.next_out = block -> cdata + BGZF_HDR_LEN;
+        zs.avail_out = BGZF_MAX_BLOCK - BGZF_HDR_LEN - BGZF_FTR_LEN;
+        zr = deflate( &zs, Z_FINISH );
+        deflateEnd( &zs );
+        if ( zr != Z_STREAM_END ) {
+            if ( level != 0 ) {
+                /* did not shrink enough, stored blocks always fit */
+                return deflate_block( block, 0 );
+            }
+            rc = RC( rcExe, rcBuffer, rcPacking, rcBuffer, rcInsufficient );
+        } else {
+            uint8_t * c = block -> cdata;
+            uint32_t clen = ( uint32_t )zs.total_out;
+            uint32_t total = BGZF_HDR_LEN + clen + BGZF_FTR_LEN;
+            uLong crc = crc32( 0L, Z_NULL, 0 );
+
+            crc = crc32( crc, block -> data, block -> data_len );
+            c[ 0 ] = 0x1f; c[ 1 ] = 0x8b; c[ 2 ] = 8; c[ 3 ] = 4;  /* gzip, FEXTRA */
+            put_u32_at( c + 4, 0 );                                 /* MTIME */
+            c[ 8 ] = 0; c[ 9 ] = 0xff;                              /* XFL, OS */
+            put_u16_at( c + 10, 6 );                                /* XLEN */
+            c[ 12 ] = 'B'; c[ 13 ] = 'C';                           /* the BGZF-subfield */
+            put_u16_at( c + 14, 2 );
+            put_u16_at( c + 16, ( uint16_t )( total - 1 ) );        /* BSIZE */
+            put_u32_at( c + BGZF_HDR_LEN + clen, ( uint32_t )crc );
+            put_u32_at( c + BGZF_HDR_LEN + clen + 4, block -> data_len );
+            block -> cdata_len = total;
+        }
+    }
+    return rc;
+}
+
+/* pushes into a queue, gives up if somebody asks us to quit */
+static rc_t push_block( KQueue * q, bgzf_block * block, atomic32_t * quit ) {
+    rc_t rc = 0;
+    bool running = true;
+    while ( running ) {
+        if ( atomic32_read( quit ) != 0 ) {
+            rc = RC( rcExe, rcQueue, rcInserting, rcTransfer, rcCanceled );
+            running = false;
+        } else {
+            struct timeout_t tm;
+            rc = TimeoutInit( &tm, BAM_WAIT_MS );
+            if ( rc == 0 ) {
+                rc = KQueuePush( q, block, &tm );
+            }
+            if ( rc == 0 ) {
+                running = false;
+            } else if ( timed_out( rc ) ) {
+                rc = 0; /* the other side is busy, try again */
+            } else {
+                LOGERR( klogInt, rc, "KQueuePush() failed" );
+                running = false;
+            }
+        }
+    }
+    return rc;
+}
+
+/* pops from a queue, *block is NULL if the queue has been sealed */
+static rc_t pop_block( KQueue * q, bgzf_block ** block, atomic32_t * quit ) {
+    rc_t rc = 0;
+    bool running = true;
+    *block = NULL;
+    while ( running ) {
+        if ( atomic32_read( quit ) != 0 ) {
+            rc = RC( rcExe, rcQueue, rcRemoving, rcTransfer, rcCanceled );
+            running = false;
+        } else {
+            struct timeout_t tm;
+            rc = TimeoutInit( &tm, BAM_WAIT_MS );
+            if ( rc == 0 ) {
+                rc = KQueuePop( q, ( void ** )block, &tm );
+            }
+            if ( rc == 0 ) {
+                running = false;
+            } else if ( sealed( rc ) ) {
+                rc = 0;
+                running = false;
+            } else if ( timed_out( rc ) ) {
+                rc = 0; /* the other side is busy, try again */
+            } else {
+                LOGERR( klogInt, rc, "KQueuePop() failed" );
+                running = false;
+            }
+        }
+    }
+    return rc;
+}
+
+static rc_t CC worker_thread( const KThread * thread, void * data ) {
+    bam_worker * self = data;
+    rc_t rc = 0;
+    bool running = true;
+    while ( rc == 0 && running ) {
+        bgzf_block * block;
+        rc = pop_block( self -> in_q, &block, self -> quit );
+        if ( rc == 0 ) {
+            if ( block == NULL ) {
+                running = false; /* the writer has no more blocks */
+            } else {
+                block -> rc = deflate_block( block, self -> level );
+                rc = push_block( self -> out_q, block, self -> quit );
+                if ( rc != 0 ) {
+                    free( ( void * ) block );
+                }
+            }
+        }
+    }
+    /* the writer must not wait for blocks that will never come */
+    KQueueSeal( self -> out_q );
+    return rc;
+}
+
+static rc_t write_through( bam_out * self, const void * data, size_t len ) {
+    size_t num_writ;
+    rc_t rc = self -> writer( self -> writer_data, data, len, &num_writ );
+    if ( rc == 0 && num_writ != len ) {
+        rc = RC( rcExe, rcFile, rcWriting, rcTransfer, rcIncomplete );
+    }
+    if ( rc != 0 ) {
+        LOGERR( klogErr, rc, "writing BAM-output failed" );
+    }
+    return rc;
+}
+
+static rc_t write_block( bam_out * self, bgzf_block * block ) {
+    rc_t rc = block -> rc;
+    if ( rc != 0 ) {
+        LOGERR( klogInt, rc, "compressing BGZF-block failed" );
+    } else {
+        rc = write_through( self, block -> cdata, block -> cdata_len );
+    }
+    free( ( void * ) block );
+    return rc;
+}
+
+/* waits for the oldest block in flight and writes it */
+static rc_t write_oldest( bam_out * self ) {
+    bam_worker * w = &( self -> workers[ self -> blocks_written % self -> num_workers ] );
+    bgzf_block * block;
+    rc_t rc = pop_block( w -> out_q, &block, &( self -> quit ) );
+    if ( rc == 0 ) {
+        if ( block == NULL ) {
+            rc = RC( rcExe, rcQueue, rcRemoving, rcThread, rcDestroyed );
+            LOGERR( klogInt, rc, "BGZF-worker stopped early" );
+        } else {
+            self -> blocks_written++;
+            rc = write_block( self, block );
+        }
+    }
+    return rc;
+}
+
+/* hands the current block over to be compressed and written */
+static rc_t send_block( bam_out * self ) {
+    rc_t rc = 0;
+    bgzf_block * block = self -> block;
+    self -> block = NULL;
+    if ( block == NULL || block -> data_len == 0 ) {
+        free( ( void * ) block );
+    } else if ( self -> num_workers == 0 ) {
+        block -> rc = deflate_block( block, self -> level );
+        rc = write_block( self, block );
+    } else {
+        /* keep the memory bounded: at most 2 blocks per worker in flight */
+        while ( rc == 0 && self -> blocks_sent - self -> blocks_written >= 2 * ( uint64_t )self -> num_workers ) {
+            rc = write_oldest( self );
+        }
+        if ( rc == 0 ) {
+            bam_worker * w = &( self -> workers[ self -> blocks_sent % self -> num_workers ] );
+            rc = push_block( w -> in_q, block, &( self -> quit ) );
+        }
+        if ( rc == 0 ) {
+            self -> blocks_sent++;
+        } else {
+            free( ( void * ) block );
+        }
+    }
+    return rc;
+}
+
+/* appends to the BGZF-stream, a record is not split across blocks if it fits into one */
+static rc_t put_data( bam_out * self, const uint8_t * src, size_t len ) {
+    rc_t rc = 0;
+    if ( self -> block != NULL && len <= BGZF_BLOCK_DATA &&
+         self -> block -> data_len + len > BGZF_BLOCK_DATA ) {
+        rc = send_block( self );
+    }
+    while ( rc == 0 && len > 0 ) {
+        if ( self -> block == NULL ) {
+            self -> block = malloc( sizeof * self -> block );
+            if ( self -> block == NULL ) {
+                rc = RC( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+            } else {
+                self -> block -> data_len = 0;
+                self -> block -> cdata_len = 0;
+                self -> block -> rc = 0;
+            }
+        }
+        if ( rc == 0 ) {
+            bgzf_block * block = self -> block;
+            size_t n = BGZF_BLOCK_DATA - block -> data_len;
+            if ( n > len ) { n = len; }
+            memmove( block -> data + block -> data_len, src, n );
+            block -> data_len += ( uint32_t )n;
+            src += n;
+            len -= n;
+            if ( block -> data_len == BGZF_BLOCK_DATA ) {
+                rc = send_block( self );
+            }
+        }
+    }
+    return rc;
+}
+
+/* ----------------------------------------------------------------------------------- */
+/* ----------------------------------------------------------------------------------- */
+
+static int64_t CC ref_vs_ref( const BSTNode * item, const BSTNode * n ) {
+    return strcmp( ( ( const bam_ref * )item ) -> name, ( ( const bam_ref * )n ) -> name );
+}
+
+typedef struct ref_key {
+    const char * name;
+    size_t len;
+} ref_key;
+
+/* the same order as strcmp(), but the name does not have to be NUL-terminated */
+static int64_t CC key_vs_ref( const void * item, const BSTNode * n ) {
+    const ref_key * key = item;
+    const bam_ref * ref = ( const bam_ref * )n;
+    size_t len = key -> len < ref -> name_len ? key -> len : ref -> name_len;
+    int cmp = memcmp( key -> name, ref -> name, len );
+    if ( cmp != 0 ) {
+        return cmp;
+    }
+    return ( int64_t )key -> len - ( int64_t )ref -> name_len;
+}
+
+static void CC release_ref( void * item, void * data ) {
+    bam_ref * ref = item;
+    if ( ref != NULL ) {
+        free( ( void * ) ref -> name );
+        free( ( void * ) ref );
+    }
+}
+
+static rc_t bad_header( const char * what ) {
+    rc_t rc = RC( rcExe, rcData, rcConverting, rcFormat, rcInvalid );
+    (void)PLOGERR( klogErr, ( klogErr, rc, "cannot convert SAM-header to BAM: $(w)", "w=%s", what ) );
+    return rc;
+}
+
+static rc_t bad_value( const char * what ) {
+    rc_t rc = RC( rcExe, rcData, rcConverting, rcFormat, rcInvalid );
+    (void)PLOGERR( klogErr, ( klogErr, rc, "cannot encode BAM-record: $(w)", "w=%s", what ) );
+    return rc;
+}
+
+/* @SQ SN:name LN:length ... ( the line is NUL-terminated ) */
+static rc_t on_sq_line( bam_out * self, char * line ) {
+    rc_t rc = 0;
+    const char * name = NULL;
+    uint64_t len = 0;
+    bool have_len = false;
+    char * field = strchr( line, '\t' );
+    while ( field != NULL ) {
+        char * next = strchr( ++field, '\t' );
+        size_t flen = next != NULL ? ( size_t )( next - field ) : strlen( field );
+        if ( flen > 3 && field[ 0 ] == 'S' && field[ 1 ] == 'N' && field[ 2 ] == ':' ) {
+            name = field + 3;
+            if ( next != NULL ) { *next = 0; }
+        } else if ( flen > 3 && field[ 0 ] == 'L' && field[ 1 ] == 'N' && field[ 2 ] == ':' ) {
+            char * endp;
+            len = strtou64( field + 3, &endp, 10 );
+            have_len = ( endp == field + flen );
+        }
+        field = next;
+    }
+    if ( name == NULL || !have_len || len > 0x7fffffff ) {
+        rc = bad_header( "@SQ-line without valid SN- and LN-fields" );
+    } else {
+        bam_ref * ref = calloc( 1, sizeof * ref );
+        if ( ref == NULL ) {
+            rc = RC( rcExe, rcData, rcAllocating, rcMemory, rcExhausted );
+        } else {
+            ref -> name = string_dup_measure( name, &( ref -> name_len ) );
+            ref -> id = ( int32_t )VectorLength( &( self -> refs ) );
+            ref -> len = ( uint32_t )len;
+            if ( ref -> name == NULL ) {
+                rc = RC( rcExe, rcData, rcAllocating, rcMemory, rcExhausted );
+            } else {
+                BSTNode * existing = NULL;
+                rc = BSTreeInsertUnique( &( self -> ref_index ), &( ref -> node ), &existing, ref_vs_ref );
+                if ( rc != 0 ) {
+                    rc = bad_header( "duplicate reference-name in @SQ-lines" );
+                } else {
+                    rc = VectorAppend( &( self -> refs ), NULL, ref );
+                    if ( rc != 0 ) {
+                        BSTreeUnlink( &( self -> ref_index ), &( ref -> node ) );
+                    }
+                }
+            }
+            if ( rc != 0 ) {
+                release_ref( ref, NULL );
+            }
+        }
+    }
+    return rc;
+}
+
+/* collects the references from the @SQ-lines of the header-text */
+static rc_t on_header_text( bam_out * self, const char * text, size_t len ) {
+    rc_t rc = 0;
+    bam_buf line;
+    const char * p = text;
+    const char * end = text + len;
+
+    memset( &line, 0, sizeof line );
+    while ( rc == 0 && p < end ) {
+        const char * nl = memchr( p, '\n', end - p );
+        const char * stop = ( nl != NULL ) ? nl : end;
+        if ( stop - p > 4 && strncmp( p, "@SQ\t", 4 ) == 0 ) {
+            line . len = 0;
+            rc = buf_add( &line, p, stop - p );
+            if ( rc == 0 ) {
+                rc = on_sq_line( self, ( char * )line . data );
+            }
+        }
+        p = stop + ( nl != NULL ? 1 : 0 );
+    }
+    buf_release( &line );
+    return rc;
+}
+
+static rc_t write_header( bam_out * self, const char * text, size_t len ) {
+    rc_t rc = 0;
+    uint32_t i, n = VectorLength( &( self -> refs ) );
+    bam_buf b;
+
+    memset( &b, 0, sizeof b );
+    rc = buf_add( &b, "BAM\1", 4 );
+    if ( rc == 0 ) { rc = buf_add_u32( &b, ( uint32_t )len ); }
+    if ( rc == 0 ) { rc = buf_add( &b, text, len ); }
+    if ( rc == 0 ) { rc = buf_add_u32( &b, n ); }
+    for ( i = 0; rc == 0 && i < n; ++i ) {
+        const bam_ref * ref = VectorGet( &( self -> refs ), i );
+        rc = buf_add_u32( &b, ( uint32_t )( ref -> name_len + 1 ) );
+        if ( rc == 0 ) { rc = buf_add( &b, ref -> name, ref -> name_len + 1 ); }
+        if ( rc == 0 ) { rc = buf_add_u32( &b, ref -> len ); }
+    }
+    if ( rc == 0 ) {
+        rc = put_data( self, b . data, b . len );
+    }
+    /* the records start in a block of their own */
+    if ( rc == 0 ) {
+        rc = send_block( self );
+    }
+    buf_release( &b );
+    self -> header_written = true;
+    return rc;
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+static rc_t ref_id_of( bam_rec * self, const char * name, size_t len, int32_t * id ) {
+    rc_t rc = 0;
+    if ( name == NULL || len == 0 || ( len == 1 && name[ 0 ] == '*' ) ) {
+        *id = -1;
+    } else {
+        ref_key key;
+        const bam_ref * ref = self -> last_ref;
+        key . name = name;
+        key . len = len;
+        if ( ref == NULL || key_vs_ref( &key, &( ref -> node ) ) != 0 ) {
+            ref = ( const bam_ref * )BSTreeFind( &( self -> out -> ref_index ), &key, key_vs_ref );
+        }
+        if ( ref == NULL ) {
+            rc = bad_value( "reference-name not found in the @SQ-lines of the header" );
+        } else {
+            self -> last_ref = ref;
+            *id = ref -> id;
+        }
+    }
+    return rc;
+}
+
+/* the BAI-bin of the 0-based, half-open interval [ beg, end ) */
+static uint16_t reg2bin( int64_t beg, int64_t end ) {
+    --end;
+    if ( beg >> 14 == end >> 14 ) { return ( uint16_t )( ( ( 1 << 15 ) - 1 ) / 7 + ( beg >> 14 ) ); }
+    if ( beg >> 17 == end >> 17 ) { return ( uint16_t )( ( ( 1 << 12 ) - 1 ) / 7 + ( beg >> 17 ) ); }
+    if ( beg >> 20 == end >> 20 ) { return ( uint16_t )( ( ( 1 << 9 ) - 1 ) / 7 + ( beg >> 20 ) ); }
+    if ( beg >> 23 == end >> 23 ) { return ( uint16_t )( ( ( 1 << 6 ) - 1 ) / 7 + ( beg >> 23 ) ); }
+    if ( beg >> 26 == end >> 26 ) { return ( uint16_t )( ( ( 1 << 3 ) - 1 ) / 7 + ( beg >> 26 ) ); }
+    return 0;
+}
+
+static uint8_t nibble_of( char c ) {
+    switch ( c ) {
+        case '=' : return 0;
+        case 'A' : case 'a' : return 1;
+        case 'C' : case 'c' : return 2;
+        case 'M' : case 'm' : return 3;
+        case 'G' : case 'g' : return 4;
+        case 'R' : case 'r' : return 5;
+        case 'S' : case 's' : return 6;
+        case 'V' : case 'v' : return 7;
+        case 'T' : case 't' : return 8;
+        case 'W' : case 'w' : return 9;
+        case 'Y' : case 'y' : return 10;
+        case 'H' : case 'h' : return 11;
+        case 'K' : case 'k' : return 12;
+        case 'D' : case 'd' : return 13;
+        case 'B' : case 'b' : return 14;
+        default  : return 15;
+    }
+}
+
+/* the smallest integer-type the value fits into, the way samtools picks it */
+static rc_t add_int_tag_value( bam_buf * b, int64_t v ) {
+    rc_t rc;
+    if ( v < 0 ) {
+        if ( v >= -128 ) {
+            rc = buf_add_u8( b, 'c' );
+            if ( rc == 0 ) { rc = buf_add_u8( b, ( uint8_t )( int8_t )v ); }
+        } else if ( v >= -32768 ) {
+            rc = buf_add_u8( b, 's' );
+            if ( rc == 0 ) { rc = buf_add_u16( b, ( uint16_t )( int16_t )v ); }
+        } else {
+            rc = buf_add_u8( b, 'i' );
+            if ( rc == 0 ) { rc = buf_add_u32( b, ( uint32_t )( int32_t )v ); }
+        }
+    } else {
+        if ( v <= 0xff ) {
+            rc = buf_add_u8( b, 'C' );
+            if ( rc == 0 ) { rc = buf_add_u8( b, ( uint8_t )v ); }
+        } else if ( v <= 0xffff ) {
+            rc = buf_add_u8( b, 'S' );
+            if ( rc == 0 ) { rc = buf_add_u16( b, ( uint16_t )v ); }
+        } else {
+            rc = buf_add_u8( b, 'I' );
+            if ( rc == 0 ) { rc = buf_add_u32( b, ( uint32_t )v ); }
+        }
+    }
+    return rc;
+}
+
+static rc_t add_float( bam_buf * b, const char * s, char ** endp ) {
+    float f = ( float )strtod( s, endp );
+    uint32_t u;
+    memmove( &u, &f, sizeof u );
+    return buf_add_u32( b, u );
+}
+
+/* B:t,v1,v2,... */
+static rc_t add_array_tag_value( bam_buf * b, const char * value ) {
+    rc_t rc = 0;
+    char sub = value[ 0 ];
+    uint32_t count = 0;
+    size_t count_at;
+    const char * s = value + 1;
+
+    if ( strchr( "cCsSiIf", sub ) == NULL || sub == 0 ) {
+        return bad_value( "invalid sub-type of B-tag" );
+    }
+    rc = buf_add_u8( b, 'B' );
+    if ( rc == 0 ) { rc = buf_add_u8( b, ( uint8_t )sub ); }
+    count_at = b -> len;
+    if ( rc == 0 ) { rc = buf_add_u32( b, 0 ); }
+    while ( rc == 0 && *s == ',' ) {
+        char * endp;
+        ++s;
+        if ( sub == 'f' ) {
+            rc = add_float( b, s, &endp );
+        } else {
+            int64_t v = strtoi64( s, &endp, 10 );
+            switch ( sub ) {
+                case 'c' : case 'C' : rc = buf_add_u8( b, ( uint8_t )v ); break;
+                case 's' : case 'S' : rc = buf_add_u16( b, ( uint16_t )v ); break;
+                default  : rc = buf_add_u32( b, ( uint32_t )v ); break;
+            }
+        }
+        if ( rc == 0 && endp == s ) {
+            rc = bad_value( "invalid value in B-tag" );
+        }
+        s = endp;
+        count++;
+    }
+    if ( rc == 0 && *s != 0 ) {
+        rc = bad_value( "invalid B-tag" );
+    }
+    if ( rc == 0 ) {
+        put_u32_at( b -> data + count_at, count );
+    }
+    return rc;
+}
+
+/* TG:T:value ( NUL-terminated ) */
+static rc_t add_text_tag( bam_buf * b, const char * tag ) {
+    rc_t rc;
+    const char * value = tag + 5;
+    if ( strlen( tag ) < 5 || tag[ 2 ] != ':' || tag[ 4 ] != ':' ) {
+        return bad_value( "invalid optional field" );
+    }
+    rc = buf_add( b, tag, 2 );
+    if ( rc == 0 ) {
+        switch( tag[ 3 ] ) {
+            case 'A' :
+                if ( value[ 0 ] == 0 || value[ 1 ] != 0 ) {
+                    rc = bad_value( "invalid A-tag" );
+                } else {
+                    rc = buf_add( b, "A", 1 );
+                    if ( rc == 0 ) { rc = buf_add_u8( b, ( uint8_t )value[ 0 ] ); }
+                }
+                break;
+
+            case 'i' : {
+                    char * endp;
+                    int64_t v = strtoi64( value, &endp, 10 );
+                    if ( endp == value || *endp != 0 || v < -2147483648LL || v > 4294967295LL ) {
+                        rc = bad_value( "invalid i-tag" );
+                    } else {
+                        rc = add_int_tag_value( b, v );
+                    }
+                }
+                break;
+
+            case 'f' : {
+                    char * endp;
+                    rc = buf_add( b, "f", 1 );
+                    if ( rc == 0 ) { rc = add_float( b, value, &endp ); }
+                    if ( rc == 0 && ( endp == value || *endp != 0 ) ) {
+                        rc = bad_value( "invalid f-tag" );
+                    }
+                }
+                break;
+
+            case 'Z' :
+            case 'H' :
+                rc = buf_add( b, tag + 3, 1 );
+                if ( rc == 0 ) { rc = buf_add( b, value, strlen( value ) + 1 ); }
+                break;
+
+            case 'B' :
+                rc = add_array_tag_value( b, value );
+                break;
+
+            default :
+                rc = bad_value( "unknown type of optional field" );
+                break;
+        }
+    }
+    return rc;
+}
+
+static bool valid_tag( const char * tag ) {
+    return ( tag != NULL && tag[ 0 ] != 0 && tag[ 1 ] != 0 && tag[ 2 ] == 0 );
+}
+
+/* back to an empty, unplaced record */
+static void clear_rec( bam_rec * self ) {
+    self -> name . len = 0;
+    self -> cigar . len = 0;
+    self -> seq . len = 0;
+    self -> qual . len = 0;
+    self -> tags . len = 0;
+    self -> pos = -1;
+    self -> mate_pos = -1;
+    self -> tlen = 0;
+    self -> ref_span = 0;
+    self -> ref_id = -1;
+    self -> mate_ref_id = -1;
+    self -> flags = 0;
+    self -> mapq = 0;
+    self -> n_ops = 0;
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+static rc_t start_workers( bam_out * self ) {
+    rc_t rc = 0;
+    uint32_t i;
+    self -> workers = calloc( self -> num_workers, sizeof * self -> workers );
+    if ( self -> workers == NULL ) {
+        return RC( rcExe, rcThread, rcConstructing, rcMemory, rcExhausted );
+    }
+    for ( i = 0; rc == 0 && i < self -> num_workers; ++i ) {
+        bam_worker * w = &( self -> workers[ i ] );
+        w -> quit = &( self -> quit );
+        w -> level = self -> level;
+        rc = KQueueMake( &( w -> in_q ), BAM_QUEUE_DEPTH );
+        if ( rc == 0 ) {
+            rc = KQueueMake( &( w -> out_q ), BAM_QUEUE_DEPTH );
+        }
+        if ( rc != 0 ) {
+            LOGERR( klogInt, rc, "KQueueMake() failed" );
+        }
+    }
+    for ( i = 0; rc == 0 && i < self -> num_workers; ++i ) {
+        rc = KThreadMake( &( self -> workers[ i ] . thread ), worker_thread, &( self -> workers[ i ] ) );
+        if ( rc != 0 ) {
+            LOGERR( klogInt, rc, "KThreadMake() failed" );
+        } else {
+            self -> started++;
+        }
+    }
+    return rc;
+}
+
+/* seals the input of the workers, waits for them and drops what is still in flight */
+static rc_t stop_workers( bam_out * self, rc_t rc ) {
+    uint32_t i;
+    if ( self -> workers == NULL ) {
+        return rc;
+    }
+    if ( rc != 0 ) {
+        atomic32_set( &( self -> quit ), 1 );
+    }
+    for ( i = 0; i < self -> num_workers; ++i ) {
+        if ( self -> workers[ i ] . in_q != NULL ) {
+            KQueueSeal( self -> workers[ i ] . in_q );
+        }
+    }
+    for ( i = 0; i < self -> num_workers; ++i ) {
+        bam_worker * w = &( self -> workers[ i ] );
+        if ( w -> thread != NULL ) {
+            rc_t rc_thread;
+            rc_t rc2 = KThreadWait( w -> thread, &rc_thread );
+            if ( rc2 != 0 ) {
+                LOGERR( klogInt, rc2, "KThreadWait() failed" );
+            }
+            if ( rc == 0 ) { rc = rc2; }
+            if ( rc == 0 && GetRCState( rc_thread ) != rcCanceled ) { rc = rc_thread; }
+            KThreadRelease( w -> thread );
+        }
+        /* in case of trouble there can be blocks left in the queues */
+        if ( w -> in_q != NULL ) {
+            void * item;
+            struct timeout_t tm;
+            while ( TimeoutInit( &tm, 0 ) == 0 && KQueuePop( w -> in_q, &item, &tm ) == 0 ) {
+                free( item );
+            }
+            KQueueRelease( w -> in_q );
+        }
+        if ( w -> out_q != NULL ) {
+            void * item;
+            struct timeout_t tm;
+            while ( TimeoutInit( &tm, 0 ) == 0 && KQueuePop( w -> out_q, &item, &tm ) == 0 ) {
+                free( item );
+            }
+            KQueueRelease( w -> out_q );
+        }
+    }
+    free( ( void * ) self -> workers );
+    self -> workers = NULL;
+    return rc;
+}
+
+static void release_bam_out( bam_out * self ) {
+    free( ( void * ) self -> block );
+    VectorWhack( &( self -> refs ), release_ref, NULL ); /* the tree shares the nodes */
+    free( ( void * ) self );
+}
+
+rc_t bam_out_make( struct bam_out ** self, uint32_t num_threads, int level ) {
+    rc_t rc = 0;
+    bam_out * res;
+
+    if ( self == NULL ) {
+        return RC( rcExe, rcFile, rcConstructing, rcSelf, rcNull );
+    }
+    *self = NULL;
+    res = calloc( 1, sizeof * res );
+    if ( res == NULL ) {
+        return RC( rcExe, rcFile, rcConstructing, rcMemory, rcExhausted );
+    }
+    VectorInit( &( res -> refs ), 0, 64 );
+    BSTreeInit( &( res -> ref_index ) );
+    atomic32_set( &( res -> quit ), 0 );
+    res -> num_workers = num_threads;
+    res -> level = level;
+    res -> writer = KOutWriterGet();
+    res -> writer_data = KOutDataGet();
+    if ( res -> writer == NULL ) {
+        rc = RC( rcExe, rcFile, rcConstructing, rcParam, rcNull );
+        LOGERR( klogInt, rc, "no KOut-writer to write the BAM-output to" );
+    }
+    if ( rc == 0 && res -> num_workers > 0 ) {
+        rc = start_workers( res );
+    }
+    if ( rc == 0 ) {
+        *self = res;
+    } else {
+        stop_workers( res, rc );
+        release_bam_out( res );
+    }
+    return rc;
+}
+
+rc_t bam_out_header( struct bam_out * self, const char * text, size_t len ) {
+    rc_t rc;
+    if ( self == NULL ) {
+        return RC( rcExe, rcFile, rcWriting, rcSelf, rcNull );
+    }
+    if ( self -> header_written ) {
+        return bad_header( "the header comes after the first record" );
+    }
+    rc = on_header_text( self, text, len );
+    if ( rc == 0 ) {
+        rc = write_header( self, text, len );
+    }
+    return rc;
+}
+
+rc_t bam_out_write( struct bam_out * self, const void * data, size_t len ) {
+    rc_t rc = 0;
+    const uint8_t * p = data;
+    if ( self == NULL ) {
+        return RC( rcExe, rcFile, rcWriting, rcSelf, rcNull );
+    }
+    /* without a header ( unaligned reads only ) the records go into an empty one */
+    if ( !self -> header_written ) {
+        rc = write_header( self, "", 0 );
+    }
+    /* one record at a time, to not split a record across blocks if it fits into one */
+    while ( rc == 0 && len > 0 ) {
+        size_t rec_len = 4;
+        if ( len >= 4 ) {
+            rec_len += ( size_t )p[ 0 ] | ( ( size_t )p[ 1 ] << 8 ) |
+                       ( ( size_t )p[ 2 ] << 16 ) | ( ( size_t )p[ 3 ] << 24 );
+        }
+        if ( rec_len > len ) {
+            rc = RC( rcExe, rcFile, rcWriting, rcData, rcIncomplete );
+            LOGERR( klogInt, rc, "incomplete BAM-record" );
+        } else {
+            rc = put_data( self, p, rec_len );
+            p += rec_len;
+            len -= rec_len;
+        }
+    }
+    return rc;
+}
+
+rc_t bam_out_finish( struct bam_out * self, rc_t rc ) {
+    if ( self == NULL ) {
+        return rc;
+    }
+    if ( rc == 0 && !self -> header_written ) {
+        rc = write_header( self, "", 0 );
+    }
+    if ( rc == 0 ) {
+        rc = send_block( self );
+    }
+    while ( rc == 0 && self -> workers != NULL && self -> blocks_written < self -> blocks_sent ) {
+        rc = write_oldest( self );
+    }
+    if ( rc == 0 ) {
+        rc = write_through( self, bgzf_eof, sizeof bgzf_eof );
+    }
+    rc = stop_workers( self, rc );
+    release_bam_out( self );
+    return rc;
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+rc_t bam_rec_make( struct bam_rec ** self, const struct bam_out * out ) {
+    bam_rec * res;
+    if ( self == NULL ) {
+        return RC( rcExe, rcData, rcConstructing, rcSelf, rcNull );
+    }
+    *self = NULL;
+    if ( out == NULL ) {
+        return RC( rcExe, rcData, rcConstructing, rcParam, rcNull );
+    }
+    res = calloc( 1, sizeof * res );
+    if ( res == NULL ) {
+        return RC( rcExe, rcData, rcConstructing, rcMemory, rcExhausted );
+    }
+    res -> out = out;
+    clear_rec( res );
+    *self = res;
+    return 0;
+}
+
+void bam_rec_release( struct bam_rec * self ) {
+    if ( self != NULL ) {
+        buf_release( &( self -> name ) );
+        buf_release( &( self -> cigar ) );
+        buf_release( &( self -> seq ) );
+        buf_release( &( self -> qual ) );
+        buf_release( &( self -> tags ) );
+        buf_release( &( self -> tmp ) );
+        buf_release( &( self -> rec ) );
+        free( ( void * ) self );
+    }
+}
+
+rc_t bam_rec_name( struct bam_rec * self, const char * name, size_t len ) {
+    if ( self == NULL ) {
+        return RC( rcExe, rcData, rcWriting, rcSelf, rcNull );
+    }
+    return buf_add( &( self -> name ), name, len );
+}
+
+rc_t bam_rec_place( struct bam_rec * self, uint32_t flags, const char * ref_name, size_t ref_name_len,
+                    int64_t pos, uint32_t mapq ) {
+    if ( self == NULL ) {
+        return RC( rcExe, rcData, rcWriting, rcSelf, rcNull );
+    }
+    if ( flags > 0xffff ) {
+        return bad_value( "invalid FLAG" );
+    }
+    if ( pos < -1 || pos >= 0x7fffffff ) {
+        return bad_value( "invalid POS" );
+    }
+    if ( mapq > 0xff ) {
+        return bad_value( "invalid MAPQ" );
+    }
+    self -> flags = flags;
+    self -> pos = pos;
+    self -> mapq = mapq;
+    return ref_id_of( self, ref_name, ref_name_len, &( self -> ref_id ) );
+}
+
+/* the CIGAR-operations go into self -> cigar, counts them and the reference-span */
+rc_t bam_rec_cigar( struct bam_rec * self, const char * cigar, size_t len ) {
+    static const char ops[] = "MIDNSHP=X";
+    rc_t rc = 0;
+    const char * s = cigar;
+    const char * end = cigar + len;
+
+    if ( self == NULL ) {
+        return RC( rcExe, rcData, rcWriting, rcSelf, rcNull );
+    }
+    self -> cigar . len = 0;
+    self -> n_ops = 0;
+    self -> ref_span = 0;
+    if ( len == 0 || ( len == 1 && cigar[ 0 ] == '*' ) ) {
+        return 0;
+    }
+    while ( rc == 0 && s < end ) {
+        uint64_t n = 0;
+        const char * op = NULL;
+        const char * start = s;
+        while ( s < end && *s >= '0' && *s <= '9' && n < ( 1 << 28 ) ) {
+            n = n * 10 + ( *s++ - '0' );
+        }
+        if ( s < end && *s != 0 ) {
+            op = strchr( ops, *s );
+        }
+        if ( s == start || op == NULL || n >= ( 1 << 28 ) ) {
+            rc = bad_value( "invalid CIGAR" );
+        } else {
+            uint32_t code = ( uint32_t )( op - ops );
+            rc = buf_add_u32( &( self -> cigar ), ( uint32_t )( n << 4 ) | code );
+            if ( code == 0 || code == 2 || code == 3 || code == 7 || code == 8 ) {
+                self -> ref_span += n;   /* M, D, N, =, X consume the reference */
+            }
+            self -> n_ops++;
+            s++;
+        }
+    }
+    return rc;
+}
+
+rc_t bam_rec_mate( struct bam_rec * self, const char * mate_ref_name, size_t mate_ref_name_len,
+                   int64_t mate_pos, int64_t tlen ) {
+    if ( self == NULL ) {
+        return RC( rcExe, rcData, rcWriting, rcSelf, rcNull );
+    }
+    if ( mate_pos < -1 || mate_pos >= 0x7fffffff ) {
+        return bad_value( "invalid PNEXT" );
+    }
+    if ( tlen < -2147483647LL || tlen > 2147483647LL ) {
+        return bad_value( "invalid TLEN" );
+    }
+    self -> mate_pos = mate_pos;
+    self -> tlen = tlen;
+    if ( mate_ref_name_len == 1 && mate_ref_name[ 0 ] == '=' ) {
+        self -> mate_ref_id = self -> ref_id;
+        return 0;
+    }
+    return ref_id_of( self, mate_ref_name, mate_ref_name_len, &( self -> mate_ref_id ) );
+}
+
+rc_t bam_rec_seq( struct bam_rec * self, const char * bases, size_t len ) {
+    if ( self == NULL ) {
+        return RC( rcExe, rcData, rcWriting, rcSelf, rcNull );
+    }
+    return buf_add( &( self -> seq ), bases, len );
+}
+
+rc_t bam_rec_qual( struct bam_rec * self, const char * qual, size_t len ) {
+    rc_t rc;
+    if ( self == NULL ) {
+        return RC( rcExe, rcData, rcWriting, rcSelf, rcNull );
+    }
+    rc = buf_reserve( &( self -> qual ), len );
+    if ( rc == 0 ) {
+        size_t i;
+        uint8_t * dst = self -> qual . data + self -> qual . len;
+        for ( i = 0; i < len; ++i ) {
+            dst[ i ] = ( uint8_t )( qual[ i ] - 33 );
+        }
+        self -> qual . len += len;
+    }
+    return rc;
+}
+
+rc_t bam_rec_tag_Z( struct bam_rec * self, const char * tag, const char * value, size_t len ) {
+    rc_t rc;
+    if ( self == NULL ) {
+        return RC( rcExe, rcData, rcWriting, rcSelf, rcNull );
+    }
+    if ( !valid_tag( tag ) || memchr( value, 0, len ) != NULL ) {
+        return bad_value( "invalid Z-tag" );
+    }
+    rc = buf_add( &( self -> tags ), tag, 2 );
+    if ( rc == 0 ) { rc = buf_add_u8( &( self -> tags ), 'Z' ); }
+    if ( rc == 0 ) { rc = buf_add( &( self -> tags ), value, len ); }
+    if ( rc == 0 ) { rc = buf_add_u8( &( self -> tags ), 0 ); }
+    return rc;
+}
+
+rc_t bam_rec_tag_i( struct bam_rec * self, const char * tag, int64_t value ) {
+    rc_t rc;
+    if ( self == NULL ) {
+        return RC( rcExe, rcData, rcWriting, rcSelf, rcNull );
+    }
+    if ( !valid_tag( tag ) || value < -2147483648LL || value > 4294967295LL ) {
+        return bad_value( "invalid i-tag" );
+    }
+    rc = buf_add( &( self -> tags ), tag, 2 );
+    if ( rc == 0 ) { rc = add_int_tag_value( &( self -> tags ), value ); }
+    return rc;
+}
+
+rc_t bam_rec_tag_A( struct bam_rec * self, const char * tag, char value ) {
+    rc_t rc;
+    if ( self == NULL ) {
+        return RC( rcExe, rcData, rcWriting, rcSelf, rcNull );
+    }
+    if ( !valid_tag( tag ) ) {
+        return bad_value( "invalid A-tag" );
+    }
+    rc = buf_add( &( self -> tags ), tag, 2 );
+    if ( rc == 0 ) { rc = buf_add_u8( &( self -> tags ), 'A' ); }
+    if ( rc == 0 ) { rc = buf_add_u8( &( self -> tags ), ( uint8_t )value ); }
+    return rc;
+}
+
+rc_t bam_rec_tags( struct bam_rec * self, const char * text, size_t len ) {
+    rc_t rc = 0;
+    const char * p = text;
+    const char * end = text + len;
+    if ( self == NULL ) {
+        return RC( rcExe, rcData, rcWriting, rcSelf, rcNull );
+    }
+    while ( rc == 0 && p < end ) {
+        const char * tab = memchr( p, '\t', end - p );
+        const char * stop = ( tab != NULL ) ? tab : end;
+        if ( stop > p ) {
+            self -> tmp . len = 0;
+            rc = buf_add( &( self -> tmp ), p, stop - p );  /* NUL-terminates */
+            if ( rc == 0 ) {
+                rc = add_text_tag( &( self -> tags ), ( const char * )self -> tmp . data );
+            }
+        }
+        p = stop + ( tab != NULL ? 1 : 0 );
+    }
+    return rc;
+}
+
+rc_t bam_rec_finish( struct bam_rec * self, const void ** data, size_t * len ) {
+    rc_t rc = 0;
+    bam_buf * b;
+    size_t l_seq, l_name;
+
+    if ( self == NULL ) {
+        return RC( rcExe, rcData, rcWriting, rcSelf, rcNull );
+    }
+    if ( data == NULL || len == NULL ) {
+        return RC( rcExe, rcData, rcWriting, rcParam, rcNull );
+    }
+    *data = NULL;
+    *len = 0;
+    b = &( self -> rec );
+    l_seq = self -> seq . len;
+    if ( self -> name . len == 0 ) {
+        rc = buf_add_u8( &( self -> name ), '*' );
+    }
+    l_name = self -> name . len + 1;
+    if ( rc == 0 && l_name > 255 ) {
+        rc = bad_value( "QNAME too long" );
+    }
+    if ( rc == 0 && self -> qual . len != 0 && self -> qual . len != l_seq ) {
+        rc = bad_value( "QUAL and SEQ differ in length" );
+    }
+
+    b -> len = 0;
+    if ( rc == 0 ) { rc = buf_add_u32( b, 0 ); }   /* block_size, patched below */
+    if ( rc == 0 ) { rc = buf_add_u32( b, ( uint32_t )self -> ref_id ); }
+    if ( rc == 0 ) { rc = buf_add_u32( b, ( uint32_t )( int32_t )self -> pos ); }
+    if ( rc == 0 ) { rc = buf_add_u8( b, ( uint8_t )l_name ); }
+    if ( rc == 0 ) { rc = buf_add_u8( b, ( uint8_t )self -> mapq ); }
+    if ( rc == 0 ) {
+        /* unplaced records get the bin of [ -1, 0 ), others the one of the aligned span */
+        int64_t span = ( self -> ref_span > 0 ) ? self -> ref_span : 1;
+        uint16_t bin = ( self -> pos < 0 ) ? 4680 : reg2bin( self -> pos, self -> pos + span );
+        rc = buf_add_u16( b, bin );
+    }
+    if ( rc == 0 ) { rc = buf_add_u16( b, ( uint16_t )( self -> n_ops > BAM_MAX_CIGAR_OPS ? 2 : self -> n_ops ) ); }
+    if ( rc == 0 ) { rc = buf_add_u16( b, ( uint16_t )self -> flags ); }
+    if ( rc == 0 ) { rc = buf_add_u32( b, ( uint32_t )l_seq ); }
+    if ( rc == 0 ) { rc = buf_add_u32( b, ( uint32_t )self -> mate_ref_id ); }
+    if ( rc == 0 ) { rc = buf_add_u32( b, ( uint32_t )( int32_t )self -> mate_pos ); }
+    if ( rc == 0 ) { rc = buf_add_u32( b, ( uint32_t )( int32_t )self -> tlen ); }
+    if ( rc == 0 ) { rc = buf_add( b, self -> name . data, self -> name . len ); }
+    if ( rc == 0 ) { rc = buf_add_u8( b, 0 ); }
+    if ( rc == 0 ) {
+        if ( self -> n_ops > BAM_MAX_CIGAR_OPS ) {
+            /* the SAM-spec way: a placeholder kSmN, the real operations go into CG:B:I */
+            rc = buf_add_u32( b, ( uint32_t )( l_seq << 4 ) | 4 );
+            if ( rc == 0 ) { rc = buf_add_u32( b, ( uint32_t )( self -> ref_span << 4 ) | 3 ); }
+        } else {
+            rc = buf_add( b, self -> cigar . data, self -> cigar . len );
+        }
+    }
+    if ( rc == 0 ) {
+        size_t j;
+        const char * seq = ( const char * )self -> seq . data;
+        for ( j = 0; rc == 0 && j < l_seq; j += 2 ) {
+            uint8_t v = ( uint8_t )( nibble_of( seq[ j ] ) << 4 );
+            if ( j + 1 < l_seq ) {
+                v |= nibble_of( seq[ j + 1 ] );
+            }
+            rc = buf_add_u8( b, v );
+        }
+    }
+    if ( rc == 0 ) {
+        if ( self -> qual . len == 0 ) {
+            size_t j;
+            for ( j = 0; rc == 0 && j < l_seq; ++j ) {
+                rc = buf_add_u8( b, 0xff );
+            }
+        } else {
+            rc = buf_add( b, self -> qual . data, l_seq );
+        }
+    }
+    if ( rc == 0 ) { rc = buf_add( b, self -> tags . data, self -> tags . len ); }
+    if ( rc == 0 && self -> n_ops > BAM_MAX_CIGAR_OPS ) {
+        rc = buf_add( b, "CGBI", 4 );
+        if ( rc == 0 ) { rc = buf_add_u32( b, self -> n_ops ); }
+        if ( rc == 0 ) { rc = buf_add( b, self -> cigar . data, self -> cigar . len ); }
+    }
+    if ( rc == 0 ) {
+        put_u32_at( b -> data, ( uint32_t )( b -> len - 4 ) );
+        *data = b -> data;
+        *len = b -> len;
+    }
+    clear_rec( self );
+    return rc;
+}
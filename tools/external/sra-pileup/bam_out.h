@@ -0,0 +1,110 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+#ifndef _h_bam_out_
+#define _h_bam_out_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _h_klib_rc_
+#include <klib/rc.h>
+#endif
+
+/*************************************************************************************
+    BAM-output for sam-dump:
+        - the printers fill a bam_rec with the values of the columns instead of
+          printing SAM-text, bam_rec_finish() encodes the record ( CIGAR-ops,
+          4-bit SEQ, QUAL, typed tags )
+        - a record can be encoded in any thread, the encoded records are handed
+          in order to bam_out_write()
+        - bam_out appends the records to BGZF-blocks of 0xff00 bytes, block #k is
+          deflated by worker-thread #k % N, the calling thread writes the compressed
+          blocks in order via the current KOut-writer
+        - with zero threads, the blocks are deflated by the calling thread
+*************************************************************************************/
+
+struct bam_out;
+
+/* level is the zlib compression-level ( -1 = default ) */
+rc_t bam_out_make( struct bam_out ** self, uint32_t num_threads, int level );
+
+/* the SAM-header-text, the reference-dictionary is made from its @SQ-lines */
+rc_t bam_out_header( struct bam_out * self, const char * text, size_t len );
+
+/* appends one or more records encoded by bam_rec_finish() */
+rc_t bam_out_write( struct bam_out * self, const void * data, size_t len );
+
+/* if rc is 0: flushes the pending records, writes the BGZF-EOF-marker,
+   always: stops the threads and releases self */
+rc_t bam_out_finish( struct bam_out * self, rc_t rc );
+
+
+/* one record at a time, one bam_rec per thread, the reference-names are
+   looked up in the dictionary of out ( the header has to be given before ) */
+struct bam_rec;
+
+rc_t bam_rec_make( struct bam_rec ** self, const struct bam_out * out );
+void bam_rec_release( struct bam_rec * self );
+
+/* QNAME: appends to the name of the record */
+rc_t bam_rec_name( struct bam_rec * self, const char * name, size_t len );
+
+/* FLAG, RNAME, POS, MAPQ: ref_name NULL or "*" = unplaced, pos is 0-based, -1 = none */
+rc_t bam_rec_place( struct bam_rec * self, uint32_t flags, const char * ref_name, size_t ref_name_len,
+                    int64_t pos, uint32_t mapq );
+
+/* CIGAR: the text of the CIGAR-column, empty or "*" = none */
+rc_t bam_rec_cigar( struct bam_rec * self, const char * cigar, size_t len );
+
+/* RNEXT, PNEXT, TLEN: mate_ref_name NULL or "*" = none, "=" = RNAME, mate_pos is 0-based, -1 = none */
+rc_t bam_rec_mate( struct bam_rec * self, const char * mate_ref_name, size_t mate_ref_name_len,
+                   int64_t mate_pos, int64_t tlen );
+
+/* SEQ: appends bases */
+rc_t bam_rec_seq( struct bam_rec * self, const char * bases, size_t len );
+
+/* QUAL: appends qualities given as phred + 33 ( not given at all = '*' ) */
+rc_t bam_rec_qual( struct bam_rec * self, const char * qual, size_t len );
+
+/* optional fields, tag is the 2-letter name */
+rc_t bam_rec_tag_Z( struct bam_rec * self, const char * tag, const char * value, size_t len );
+rc_t bam_rec_tag_i( struct bam_rec * self, const char * tag, int64_t value );
+rc_t bam_rec_tag_A( struct bam_rec * self, const char * tag, char value );
+
+/* optional fields that come as SAM-text "TG:T:value" separated by tabs ( the CG-tags of cg_tools.c ) */
+rc_t bam_rec_tags( struct bam_rec * self, const char * text, size_t len );
+
+/* encodes the record, *data is valid until the next call, self is empty again afterwards */
+rc_t bam_rec_finish( struct bam_rec * self, const void ** data, size_t * len );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
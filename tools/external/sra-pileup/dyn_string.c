@@ -38,6 +38,8 @@
 #include <klib/out.h>
 #endif
 
+#include <string.h>
+
 typedef struct dyn_string {
     char * data;
     size_t allocated;
@@ -179,21 +181,42 @@ rc_t ds_add_ds( struct dyn_string *self, struct dyn_string *other ) {
     return rc;
 }
 
-rc_t ds_add_fmt( struct dyn_string * self, const char *fmt, ... ) {
+/* binary data, grows by doubling because it is called often with small pieces */
+rc_t ds_add_mem( struct dyn_string *self, const void * src, size_t len ) {
+    rc_t rc = 0;
+    if ( NULL != self ) {
+        size_t needed = self -> data_len + len + 1;
+        if ( needed > self -> allocated ) {
+            size_t new_size = self -> allocated > 0 ? self -> allocated : 64;
+            while ( new_size < needed ) { new_size += new_size; }
+            rc = ds_expand( self, new_size );
+        }
+        if ( rc == 0 && len > 0 ) {
+            memmove( &( self -> data[ self -> data_len ] ), src, len );
+            self -> data_len += len;
+            self -> data[ self -> data_len ] = 0;
+        }
+    } else {
+        rc = RC( rcApp, rcNoTarg, rcConstructing, rcSelf, rcNull );
+    }
+    return rc;
+}
+
+rc_t ds_add_vfmt( struct dyn_string * self, const char *fmt, va_list args ) {
     rc_t rc;
     if ( NULL != self ) {
         if ( NULL != fmt ) {
             bool not_enough;
             do {
                 size_t num_writ;
-                va_list args;
-                va_start ( args, fmt );
+                va_list args_copy;
+                va_copy ( args_copy, args );
                 rc = string_vprintf ( &( self -> data[ self -> data_len ] ), 
                                     self -> allocated - ( self -> data_len + 1 ),
                                     &num_writ,
                                     fmt,
-                                    args );
-                va_end ( args );
+                                    args_copy );
+                va_end ( args_copy );
 
                 if ( rc == 0 ) {
                     self -> data_len += num_writ;
@@ -213,6 +236,15 @@ rc_t ds_add_fmt( struct dyn_string * self, const char *fmt, ... ) {
     return rc;
 }
 
+rc_t ds_add_fmt( struct dyn_string * self, const char *fmt, ... ) {
+    rc_t rc;
+    va_list args;
+    va_start ( args, fmt );
+    rc = ds_add_vfmt( self, fmt, args );
+    va_end ( args );
+    return rc;
+}
+
 rc_t ds_print( struct dyn_string * self ) {
     if ( self != NULL ) {
         return KOutMsg( "%.*s", self -> data_len, self -> data );
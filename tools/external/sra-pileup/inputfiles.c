@@ -259,6 +259,7 @@ rc_t discover_input_files( input_files **self, const VDBManager *mgr,
         } else {
             VectorInit( &( ipf->dbs ), 0, 5 );
             VectorInit( &( ipf->tabs ), 0, 5 );
+            ipf->reflist_options = reflist_options;
             rc = split_input_files( ipf, mgr, src, reflist_options );
         }
         if ( rc != 0 ) {
@@ -270,6 +271,45 @@ rc_t discover_input_files( input_files **self, const VDBManager *mgr,
     return rc;
 }
 
+rc_t clone_input_databases( input_files **self, const input_files * src ) {
+    rc_t rc = 0;
+
+    input_files * ipf = calloc( sizeof * ipf, 1 );
+    *self = NULL;
+    if ( ipf == NULL ) {
+        rc = RC( rcApp, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+        (void)LOGERR( klogErr, rc, "cannot create inputfiles structure" );
+    } else {
+        rc = VNamelistMake( &( ipf->not_found ), 5 );
+        if ( rc != 0 ) {
+            (void)LOGERR( klogErr, rc, "cannot create inputfiles.not_found structure" );
+        } else {
+            uint32_t idx;
+            VectorInit( &( ipf->dbs ), 0, 5 );
+            VectorInit( &( ipf->tabs ), 0, 5 );
+            ipf->reflist_options = src->reflist_options;
+            for ( idx = 0; idx < src->database_count && rc == 0; ++idx ) {
+                const input_database * id = VectorGet( &( src->dbs ), idx );
+                if ( id != NULL ) {
+                    rc = VDatabaseAddRef( id->db );
+                    if ( rc != 0 ) {
+                        (void)PLOGERR( klogErr, ( klogErr, rc, "cannot add reference to db '$(t)'", "t=%s", id->path ) );
+                    } else {
+                        /* append_database() takes ownership of the added reference */
+                        rc = append_database( ipf, id->db, id->path, src->reflist_options, true );
+                    }
+                }
+            }
+        }
+        if ( rc != 0 ) {
+            release_input_files( ipf );
+        } else {
+            *self = ipf;
+        }
+    }
+    return rc;
+}
+
 static void CC db_whack( void * item, void * data ) {
     input_database * id = ( input_database * )item;
     free_input_database( id );
@@ -86,6 +86,7 @@ typedef struct input_files {
     uint32_t database_count;
     uint32_t table_count;
     uint32_t not_found_count;
+    uint32_t reflist_options;
 
     Vector dbs;
     Vector tabs;
@@ -95,6 +96,13 @@ typedef struct input_files {
 rc_t discover_input_files( input_files **self, const VDBManager *mgr,
                            const VNamelist * src, uint32_t reflist_options );
 
+/*
+    a copy of the databases in src for another thread: it shares the
+    vdb-db-handles, but has its own ReferenceLists ( with their own cursors ),
+    the tables and the not-found list are not copied
+*/
+rc_t clone_input_databases( input_files **self, const input_files * src );
+
 void release_input_files( input_files *self );
 
 #ifdef __cplusplus
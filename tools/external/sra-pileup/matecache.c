@@ -360,6 +360,52 @@ rc_t matecache_lookup_unaligned( const matecache * const self, uint32_t db_idx,
     return rc;
 }
 
+typedef struct merge_ctx {
+    matecache_per_file * dst;
+    const matecache_per_file * src;
+} merge_ctx;
+
+static rc_t CC on_merge_unaligned( uint64_t key, uint64_t value, void *user_data ) {
+    merge_ctx * mctx = user_data;
+    uint64_t seq_id;
+    rc_t rc = KVectorGetU64( mctx->src->unaligned_64_b, key, &seq_id );
+    if ( rc != 0 ) {
+        (void)LOGERR( klogErr, rc, "cannot retrieve value (unaligned b) U64" );
+    } else {
+        rc = KVectorSetU64( mctx->dst->unaligned_64_a, key, value );
+        if ( rc != 0 ) {
+            (void)LOGERR( klogErr, rc, "cannot insert into KVector (unaligned a) U64" );
+        } else {
+            rc = KVectorSetU64( mctx->dst->unaligned_64_b, key, seq_id );
+            if ( rc != 0 ) {
+                (void)LOGERR( klogErr, rc, "cannot insert into KVector (unaligned b) U64" );
+            }
+        }
+        if ( rc == 0 ) {
+            mctx->dst->stat_unaligned.count++;
+            mctx->dst->stat_unaligned.inserts++;
+        }
+    }
+    return rc;
+}
+
+rc_t matecache_merge_unaligned( matecache * const self, const matecache * const other ) {
+    rc_t rc = 0;
+    if ( self == NULL || other == NULL ) {
+        rc = RC( rcApp, rcNoTarg, rcAccessing, rcSelf, rcNull );
+        (void)LOGERR( klogErr, rc, "cannot merge unaligned-cache" );
+    } else {
+        uint32_t idx;
+        for ( idx = 0; idx < self->count && idx < other->count && rc == 0; ++idx ) {
+            merge_ctx mctx;
+            mctx.dst = &self->per_file[ idx ];
+            mctx.src = &other->per_file[ idx ];
+            rc = KVectorVisitU64 ( mctx.src->unaligned_64_a, false, on_merge_unaligned, &mctx );
+        }
+    }
+    return rc;
+}
+
 typedef struct visit_ctx {
     rc_t ( CC * f ) ( int64_t seq_id, int64_t al_id, void * user_data );
     void * user_data;
@@ -105,6 +105,9 @@ rc_t matecache_insert_unaligned( matecache * const self,
 rc_t matecache_lookup_unaligned( const matecache * const self, uint32_t db_idx, int64_t key,
                                  INSDC_coord_zero * const ref_pos, uint32_t * const ref_idx, int64_t * const seq_id );
 
+/* copies the half aligned mates of other into self ( collected by another thread ) */
+rc_t matecache_merge_unaligned( matecache * const self, const matecache * const other );
+
 rc_t foreach_unaligned_entry( const matecache * const self,
                               uint32_t db_idx,
                               rc_t ( CC * f ) ( int64_t seq_id, int64_t al_id, void * user_data ),
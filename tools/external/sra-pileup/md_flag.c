@@ -30,7 +30,16 @@
 #include <klib/out.h>
 #endif
 
+#ifndef _h_pileup_threads_
+#include "pileup_threads.h"
+#endif
+
+#ifndef _h_dyn_string_
+#include "dyn_string.h"
+#endif
+
 #include <ctype.h>    /* isdigit() */
+#include <stdarg.h>
 
 struct cigar_t {
     char * op;
@@ -133,18 +142,37 @@ void free_cigar_t( struct cigar_t * c ) {
     }
 }
 
-static rc_t kout_delete( int count, int *match_count,
+/* the MD-tag is printed into a sink, or collected into a dyn_string for the BAM-output */
+typedef struct md_out {
+    struct pt_sink * sink;
+    struct dyn_string * value;
+} md_out;
+
+static rc_t md_print( const md_out * out, const char * fmt, ... ) {
+    rc_t rc;
+    va_list args;
+    va_start ( args, fmt );
+    if ( out -> value != NULL ) {
+        rc = ds_add_vfmt( out -> value, fmt, args ); /* dyn_string.c */
+    } else {
+        rc = pt_vout( out -> sink, fmt, args ); /* pileup_threads.c */
+    }
+    va_end ( args );
+    return rc;
+}
+
+static rc_t kout_delete( const md_out * out, int count, int *match_count,
                         const uint8_t * ref, const INSDC_coord_len ref_len, int *ref_idx ) {
     rc_t rc = 0;
     
     if ( *match_count > 0 ) {
-        rc = KOutMsg( "%d", *match_count );
+        rc = md_print( out, "%d", *match_count );
         *match_count = 0;
     }
     
     if ( rc == 0 ) {
         if ( ( *ref_idx + count ) < ref_len ) {
-            rc = KOutMsg( "^%.*s", count, &(ref[ *ref_idx ] ) );
+            rc = md_print( out, "^%.*s", count, &(ref[ *ref_idx ] ) );
             (*ref_idx) += count;
         } else {
             rc = RC( rcExe, rcNoTarg, rcAllocating, rcItem, rcIncomplete );
@@ -153,7 +181,7 @@ static rc_t kout_delete( int count, int *match_count,
     return rc;
 }
 
-static rc_t kout_match( int count, int *match_count,
+static rc_t kout_match( const md_out * out, int count, int *match_count,
                         const char * read, size_t read_len, int *read_idx,
                         const uint8_t *ref, const INSDC_coord_len ref_len, int *ref_idx ) {
     rc_t rc = 0;
@@ -163,7 +191,7 @@ static rc_t kout_match( int count, int *match_count,
             if ( read[ (*read_idx)++ ] == ref[ *ref_idx ] ) {
                 (*match_count)++;
             } else {
-                rc = KOutMsg( "%d%c", *match_count, ref[ *ref_idx ] );
+                rc = md_print( out, "%d%c", *match_count, ref[ *ref_idx ] );
                 *match_count = 0;
             }
             (*ref_idx)++;
@@ -174,14 +202,17 @@ static rc_t kout_match( int count, int *match_count,
     return rc;
 }
 
-static rc_t kout_tag( const struct cigar_t * c,
+static rc_t kout_tag( const md_out * out,
+                    const struct cigar_t * c,
                     const char * read,
                     const size_t read_len,
                     const uint8_t * ref,
                     const INSDC_coord_len ref_len ) {
     rc_t rc = 0;
     if ( c != NULL && read != NULL && read_len > 0 && ref != NULL && ref_len > 0 ) {
-        rc = KOutMsg( "\tMD:Z:" );
+        if ( out -> value == NULL ) {
+            rc = md_print( out, "\tMD:Z:" );
+        }
         if ( rc == 0 ) {
             int read_idx = 0;
             int ref_idx = 0;
@@ -190,15 +221,15 @@ static rc_t kout_tag( const struct cigar_t * c,
             for ( cigar_idx = 0; cigar_idx < c->length && rc == 0; ++cigar_idx ) {
                 int count = c->count[ cigar_idx ];
                 switch ( c->op[ cigar_idx ] ) {
-                    case 'D' : rc = kout_delete( count, &match_count, ref, ref_len, &ref_idx ); break;
+                    case 'D' : rc = kout_delete( out, count, &match_count, ref, ref_len, &ref_idx ); break;
                     
                     case 'I' : read_idx += count; break;
 
-                    case 'M' : rc = kout_match( count, &match_count, read, read_len, &read_idx, ref, ref_len, &ref_idx ); break;
+                    case 'M' : rc = kout_match( out, count, &match_count, read, read_len, &read_idx, ref, ref_len, &ref_idx ); break;
                 }
             }
             if ( rc == 0 && match_count > 0 ) {
-                rc = KOutMsg( "%d", match_count );
+                rc = md_print( out, "%d", match_count );
             }
         }
     } else {
@@ -207,19 +238,45 @@ static rc_t kout_tag( const struct cigar_t * c,
     return rc;
 }
 
-rc_t kout_md_tag_from_cigar_string( const char * cigar_str,
-                                    const size_t cigar_len,
-                                    const char * read,
-                                    const size_t read_len,
-                                    const uint8_t * ref,
-                                    const INSDC_coord_len ref_len ) {
+static rc_t md_tag( const md_out * out,
+                    const char * cigar_str,
+                    const size_t cigar_len,
+                    const char * read,
+                    const size_t read_len,
+                    const uint8_t * ref,
+                    const INSDC_coord_len ref_len ) {
     rc_t rc = 0;
     struct cigar_t * cigar = make_cigar_t( cigar_str, cigar_len );
     if ( cigar == NULL ) {
         rc = RC( rcExe, rcNoTarg, rcAllocating, rcItem, rcIncomplete );
     } else {
-        rc = kout_tag( cigar, read, read_len, ref, ref_len );
+        rc = kout_tag( out, cigar, read, read_len, ref, ref_len );
         free_cigar_t( cigar );
     }
     return rc;
 }
+
+rc_t kout_md_tag_from_cigar_string( struct pt_sink * out,
+                                    const char * cigar_str,
+                                    const size_t cigar_len,
+                                    const char * read,
+                                    const size_t read_len,
+                                    const uint8_t * ref,
+                                    const INSDC_coord_len ref_len ) {
+    md_out o = { out, NULL };
+    return md_tag( &o, cigar_str, cigar_len, read, read_len, ref, ref_len );
+}
+
+rc_t md_tag_from_cigar_string( struct dyn_string * value,
+                               const char * cigar_str,
+                               const size_t cigar_len,
+                               const char * read,
+                               const size_t read_len,
+                               const uint8_t * ref,
+                               const INSDC_coord_len ref_len ) {
+    md_out o = { NULL, value };
+    if ( value == NULL ) {
+        return RC( rcExe, rcNoTarg, rcAllocating, rcParam, rcNull );
+    }
+    return md_tag( &o, cigar_str, cigar_len, read, read_len, ref, ref_len );
+}
@@ -39,13 +39,27 @@ extern "C" {
 #include <insdc/insdc.h>
 #endif
 
-rc_t kout_md_tag_from_cigar_string( const char * cigar_str,
+struct pt_sink;
+struct dyn_string;
+
+/* prints the MD-tag into out, or via KOutMsg() if out is NULL ( pileup_threads.c ) */
+rc_t kout_md_tag_from_cigar_string( struct pt_sink * out,
+                                    const char * cigar_str,
                                     const size_t cigar_len,
                                     const char * read,
                                     const size_t read_len,
                                     const uint8_t * ref,
                                     const INSDC_coord_len ref_len );
 
+/* appends the value of the MD-tag to value ( for the BAM-output ) */
+rc_t md_tag_from_cigar_string( struct dyn_string * value,
+                               const char * cigar_str,
+                               const size_t cigar_len,
+                               const char * read,
+                               const size_t read_len,
+                               const uint8_t * ref,
+                               const INSDC_coord_len ref_len );
+
 #ifdef __cplusplus
 }
 #endif
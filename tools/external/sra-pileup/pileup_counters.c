@@ -38,6 +38,10 @@
 #include "4na_ascii.h"
 #endif
 
+#ifndef _h_pileup_threads_
+#include "pileup_threads.h"
+#endif
+
 static uint32_t percent( uint32_t v1, uint32_t v2 ) {
     uint32_t sum = v1 + v2;
     uint32_t res = 0;
@@ -127,6 +131,7 @@ static void count_indel_fragment( BSTree * fragments, const INSDC_4na_bin *bases
 }
 
 typedef struct walk_fragment_ctx {
+    struct pt_sink * out;
     rc_t rc;
     uint32_t n;
 } walk_fragment_ctx;
@@ -136,16 +141,17 @@ static void CC on_fragment( BSTNode *n, void *data ) {
     const indel_fragment * fragment = ( const indel_fragment * )n;
     if ( wctx->rc == 0 ) {
         if ( wctx->n == 0 ) {
-            wctx->rc = KOutMsg( "%u-%.*s", fragment->count, fragment->len, fragment->bases );
+            wctx->rc = pt_out( wctx->out, "%u-%.*s", fragment->count, fragment->len, fragment->bases );
         } else {
-            wctx->rc = KOutMsg( "|%u-%.*s", fragment->count, fragment->len, fragment->bases );
+            wctx->rc = pt_out( wctx->out, "|%u-%.*s", fragment->count, fragment->len, fragment->bases );
         }
         wctx->n++;
     }
 }
 
-static rc_t print_fragments( BSTree * fragments ) {
+static rc_t print_fragments( struct pt_sink * out, BSTree * fragments ) {
     walk_fragment_ctx wctx;
+    wctx.out = out;
     wctx.rc = 0;
     wctx.n = 0;
     BSTreeForEach ( fragments, false, on_fragment, &wctx );
@@ -235,53 +241,54 @@ static void walk_counter_state( ReferenceIterator *ref_iter, int32_t state, bool
     }
 }
 
-static rc_t print_counter_line( const char * ref_name,
+static rc_t print_counter_line( struct pt_sink * out,
+                                const char * ref_name,
                                 INSDC_coord_zero ref_pos,
                                 INSDC_4na_bin ref_base,
                                 uint32_t depth,
                                 pileup_counters * counters ) {
     char c = _4na_to_ascii( ref_base, false );
 
-    rc_t rc = KOutMsg( "%s\t%u\t%c\t%u\t", ref_name, ref_pos + 1, c, depth );
+    rc_t rc = pt_out( out, "%s\t%u\t%c\t%u\t", ref_name, ref_pos + 1, c, depth );
 
     if ( rc == 0 && counters->matches > 0 ) {
-        rc = KOutMsg( "%u", counters->matches );
+        rc = pt_out( out, "%u", counters->matches );
     }
     if ( rc == 0 /* && counters->mismatches[ 0 ] > 0 */ ) {
-        rc = KOutMsg( "\t%u-A", counters->mismatches[ 0 ] );
+        rc = pt_out( out, "\t%u-A", counters->mismatches[ 0 ] );
     }
     if ( rc == 0 /* && counters->mismatches[ 1 ] > 0 */ ) {
-        rc = KOutMsg( "\t%u-C", counters->mismatches[ 1 ] );
+        rc = pt_out( out, "\t%u-C", counters->mismatches[ 1 ] );
     }
     if ( rc == 0 /* && counters->mismatches[ 2 ] > 0 */ ) {
-        rc = KOutMsg( "\t%u-G", counters->mismatches[ 2 ] );
+        rc = pt_out( out, "\t%u-G", counters->mismatches[ 2 ] );
     }
     if ( rc == 0 /* && counters->mismatches[ 3 ] > 0 */ ) {
-        rc = KOutMsg( "\t%u-T", counters->mismatches[ 3 ] );
+        rc = pt_out( out, "\t%u-T", counters->mismatches[ 3 ] );
     }
     if ( rc == 0 ) {
-        rc = KOutMsg( "\tI:" );
+        rc = pt_out( out, "\tI:" );
     }
     if ( rc == 0 ) {
-        rc = print_fragments( &(counters->insert_fragments) );
+        rc = print_fragments( out, &(counters->insert_fragments) );
     }
     if ( rc == 0 ) {
-        rc = KOutMsg( "\tD:" );
+        rc = pt_out( out, "\tD:" );
     }
     if ( rc == 0 ) {
-        rc = print_fragments( &(counters->delete_fragments) );
+        rc = print_fragments( out, &(counters->delete_fragments) );
     }
     if ( rc == 0 ) {
-        rc = KOutMsg( "\t%u%%", percent( counters->forward, counters->reverse ) );
+        rc = pt_out( out, "\t%u%%", percent( counters->forward, counters->reverse ) );
     }
     if ( rc == 0 && counters->starting > 0 ) {
-        rc = KOutMsg( "\tS%u", counters->starting );
+        rc = pt_out( out, "\tS%u", counters->starting );
     }
     if ( rc == 0 && counters->ending > 0 ) {
-        rc = KOutMsg( "\tE%u", counters->ending );
+        rc = pt_out( out, "\tE%u", counters->ending );
     }
     if ( rc == 0 ) {
-        rc = KOutMsg( "\n" );
+        rc = pt_out( out, "\n" );
     }
     free_fragments( &(counters->insert_fragments) );
     free_fragments( &(counters->delete_fragments) );
@@ -297,7 +304,7 @@ static rc_t CC walk_counters_enter_ref_pos( walk_data * data ) {
 }
 
 static rc_t CC walk_counters_exit_ref_pos( walk_data * data ) {
-    rc_t rc = print_counter_line( data->ref_name, data->ref_pos, data->ref_base, data->depth, data->data );
+    rc_t rc = print_counter_line( data->options->out, data->ref_name, data->ref_pos, data->ref_base, data->depth, data->data );
     return rc;
 }
 
@@ -334,7 +341,8 @@ rc_t walk_counters( ReferenceIterator *ref_iter, pileup_options *options ) {
 
 /* =========================================================================================== */
 
-static rc_t print_mismatches_line( const char * ref_name,
+static rc_t print_mismatches_line( struct pt_sink * out,
+                                   const char * ref_name,
                                    INSDC_coord_zero ref_pos,
                                    uint32_t depth,
                                    uint32_t min_mismatch_percent,
@@ -347,7 +355,7 @@ static rc_t print_mismatches_line( const char * ref_name,
                                     counters->mismatches[ 3 ];
                             
         if ( total_mismatches * 100 >= min_mismatch_percent * depth ) {
-            rc = KOutMsg( "%s\t%u\t%u\t%u\n", ref_name, ref_pos + 1, depth, total_mismatches );
+            rc = pt_out( out, "%s\t%u\t%u\t%u\n", ref_name, ref_pos + 1, depth, total_mismatches );
         }
     }
     free_fragments( &(counters->insert_fragments) );
@@ -363,7 +371,7 @@ static rc_t CC walk_mismatches_enter_ref_pos( walk_data * data ) {
 }
 
 static rc_t CC walk_mismatches_exit_ref_pos( walk_data * data ) {
-    rc_t rc = print_mismatches_line( data->ref_name, data->ref_pos,
+    rc_t rc = print_mismatches_line( data->options->out, data->ref_name, data->ref_pos,
                                      data->depth, data->options->min_mismatch, data->data );
     return rc;
 }
@@ -53,9 +53,11 @@ typedef struct pileup_options
     uint32_t min_mismatch;
     uint32_t merge_dist;
     uint32_t source_table;
+    uint32_t threads;   /* walk slices of the references in parallel if > 1 */
     uint32_t function;  /* sra_pileup_samtools, sra_pileup_counters, sra_pileup_stat, 
                            sra_pileup_report_ref, sra_pileup_report_ref_ext, sra_pileup_debug, etc */
     struct skiplist * skiplist;     /* from ref_regions.h */
+    struct pt_sink * out;           /* from pileup_threads.h, NULL ... KOutMsg() */
 } pileup_options;
 
 
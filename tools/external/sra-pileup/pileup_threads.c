@@ -0,0 +1,207 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "pileup_threads.h"
+
+#ifndef _h_dyn_string_
+#include "dyn_string.h"
+#endif
+
+#ifndef _h_ordered_workers_
+#include "ordered_workers.h"
+#endif
+
+#ifndef _h_klib_out_
+#include <klib/out.h>
+#endif
+
+#ifndef _h_klib_log_
+#include <klib/log.h>
+#endif
+
+#include <sysalloc.h>
+
+#include <stdlib.h>
+#include <stdarg.h>
+
+/* initial size of a chunk */
+#define PT_CHUNK_INC ( 64 * 1024 )
+/* a chunk is handed over to the writer when it grows beyond this */
+#define PT_CHUNK_FLUSH ( 4 * 1024 * 1024 )
+
+typedef struct pt_sink {
+    struct ordered_worker * worker;
+    pt_slice_fn on_slice;
+    void * data;
+    struct dyn_string * chunk;  /* the chunk currently filled by the worker */
+    uint32_t num_slices;
+} pt_sink;
+
+static void CC release_chunk( void * item ) {
+    ds_free( item ); /* dyn_string.c */
+}
+
+/* hands the current chunk over to the writer, an empty slice is delivered as NULL */
+static rc_t deliver( pt_sink * self, bool slice_end ) {
+    struct dyn_string * chunk = self -> chunk;
+    self -> chunk = NULL;
+    return ordered_worker_deliver( self -> worker, chunk, slice_end ); /* ordered_workers.c */
+}
+
+rc_t pt_vout( struct pt_sink * sink, const char * fmt, va_list args ) {
+    rc_t rc = 0;
+    if ( sink == NULL ) {
+        rc = KOutVMsg( fmt, args );
+    } else {
+        if ( sink -> chunk == NULL ) {
+            rc = ds_allocate( &( sink -> chunk ), PT_CHUNK_INC ); /* dyn_string.c */
+        }
+        if ( rc == 0 ) {
+            rc = ds_add_vfmt( sink -> chunk, fmt, args ); /* dyn_string.c */
+        }
+        if ( rc == 0 && ds_len( sink -> chunk ) >= PT_CHUNK_FLUSH ) {
+            rc = deliver( sink, false );
+        }
+    }
+    return rc;
+}
+
+rc_t pt_out( struct pt_sink * sink, const char * fmt, ... ) {
+    rc_t rc;
+    va_list args;
+    va_start ( args, fmt );
+    rc = pt_vout( sink, fmt, args );
+    va_end ( args );
+    return rc;
+}
+
+rc_t pt_write( struct pt_sink * sink, const void * data, size_t len ) {
+    rc_t rc = 0;
+    if ( sink == NULL ) {
+        return RC( rcApp, rcNoTarg, rcWriting, rcSelf, rcNull );
+    }
+    if ( sink -> chunk == NULL ) {
+        rc = ds_allocate( &( sink -> chunk ), PT_CHUNK_INC ); /* dyn_string.c */
+    }
+    if ( rc == 0 ) {
+        rc = ds_add_mem( sink -> chunk, data, len ); /* dyn_string.c */
+    }
+    if ( rc == 0 && ds_len( sink -> chunk ) >= PT_CHUNK_FLUSH ) {
+        rc = deliver( sink, false );
+    }
+    return rc;
+}
+
+/* worker #n walks the slices n, n + N, n + 2N ... */
+static rc_t CC produce( struct ordered_worker * worker, uint32_t worker_id,
+                        uint32_t num_workers, void * data ) {
+    pt_sink * self = data;
+    rc_t rc = 0;
+    uint32_t idx;
+    self -> worker = worker;
+    for ( idx = worker_id; rc == 0 && idx < self -> num_slices; idx += num_workers ) {
+        rc = self -> on_slice( idx, self, self -> data );
+        if ( rc == 0 ) {
+            rc = deliver( self, true );
+        }
+    }
+    if ( self -> chunk != NULL ) {
+        release_chunk( self -> chunk );
+        self -> chunk = NULL;
+    }
+    return rc;
+}
+
+/* the default writer: the current KOut-writer */
+static rc_t CC write_kout( const void * data, size_t len, void * writer_data ) {
+    rc_t rc = 0;
+    KWrtWriter writer = KOutWriterGet();
+    if ( writer == NULL ) {
+        rc = KOutMsg( "%.*s", ( uint32_t )len, data );
+    } else {
+        size_t num_writ;
+        rc = writer( KOutDataGet(), data, len, &num_writ );
+        if ( rc == 0 && num_writ != len ) {
+            rc = RC( rcApp, rcNoTarg, rcWriting, rcTransfer, rcIncomplete );
+        }
+    }
+    return rc;
+}
+
+typedef struct pt_writer {
+    pt_write_fn write;
+    void * data;
+} pt_writer;
+
+static rc_t CC write_chunk( void * item, void * data ) {
+    rc_t rc = 0;
+    const pt_writer * writer = data;
+    struct dyn_string * chunk = item;
+    size_t len = ( chunk == NULL ) ? 0 : ds_len( chunk );
+    if ( len > 0 ) {
+        rc = writer -> write( ds_get_char( chunk, 0 ), len, writer -> data );
+        if ( rc != 0 ) {
+            LOGERR( klogInt, rc, "writing pileup-output failed" );
+        }
+    }
+    return rc;
+}
+
+rc_t pt_run_into( uint32_t num_workers, uint32_t num_slices, pt_slice_fn on_slice, void ** data,
+                  pt_write_fn writer, void * writer_data ) {
+    rc_t rc = 0;
+    pt_sink * sinks;
+    void ** sink_ptrs;
+    uint32_t i;
+
+    if ( num_workers == 0 || on_slice == NULL || data == NULL || writer == NULL ) {
+        return RC( rcApp, rcNoTarg, rcConstructing, rcParam, rcInvalid );
+    }
+    sinks = calloc( num_workers, sizeof * sinks );
+    sink_ptrs = calloc( num_workers, sizeof * sink_ptrs );
+    if ( sinks == NULL || sink_ptrs == NULL ) {
+        rc = RC( rcApp, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    } else {
+        pt_writer w;
+        w . write = writer;
+        w . data = writer_data;
+        for ( i = 0; i < num_workers; ++i ) {
+            sinks[ i ] . on_slice = on_slice;
+            sinks[ i ] . data = data[ i ];
+            sinks[ i ] . num_slices = num_slices;
+            sink_ptrs[ i ] = &( sinks[ i ] );
+        }
+        rc = ordered_workers_run( num_workers, produce, sink_ptrs,
+                                  write_chunk, &w, release_chunk ); /* ordered_workers.c */
+    }
+    free( ( void * ) sink_ptrs );
+    free( ( void * ) sinks );
+    return rc;
+}
+
+rc_t pt_run( uint32_t num_workers, uint32_t num_slices, pt_slice_fn on_slice, void ** data ) {
+    return pt_run_into( num_workers, num_slices, on_slice, data, write_kout, NULL );
+}
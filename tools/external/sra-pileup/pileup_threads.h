@@ -0,0 +1,80 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_pileup_threads_
+#define _h_pileup_threads_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _h_klib_rc_
+#include <klib/rc.h>
+#endif
+
+#include <stdarg.h>
+
+/*************************************************************************************
+    ordered output of reference-slices walked by multiple worker-threads:
+        - the work is cut into slices numbered 0, 1, 2 ...
+        - worker #n walks the slices n, n + N, n + 2N ... ( N = number of workers )
+          in ascending order, the output of a slice goes into the sink of the worker
+        - a sink hands its text over to the writer in chunks, to limit memory use
+          for long or deep slices
+        - the calling thread collects the chunks round-robin from the workers and
+          writes them in slice-order via the current KOut-writer
+          ( that respects --outfile, --gzip, --bzip2 ... )
+        - the threads and queues are the ones of ordered_workers.c ( shared )
+*************************************************************************************/
+
+struct pt_sink;
+
+/* called in a worker-thread for each of its slices */
+typedef rc_t ( CC * pt_slice_fn )( uint32_t slice_idx, struct pt_sink * sink, void * data );
+
+/* appends to the output of the current slice, falls back to KOutMsg() if sink is NULL */
+rc_t pt_out( struct pt_sink * sink, const char * fmt, ... );
+rc_t pt_vout( struct pt_sink * sink, const char * fmt, va_list args );
+
+/* appends binary data to the output of the current slice, sink must not be NULL */
+rc_t pt_write( struct pt_sink * sink, const void * data, size_t len );
+
+/* takes the output in slice-order instead of the KOut-writer */
+typedef rc_t ( CC * pt_write_fn )( const void * data, size_t len, void * writer_data );
+
+/* starts num_workers threads calling on_slice( idx, sink, data[ worker_id ] ),
+   writes the output in slice-order and returns after all threads are done */
+rc_t pt_run( uint32_t num_workers, uint32_t num_slices, pt_slice_fn on_slice, void ** data );
+
+/* the same as pt_run(), but the output goes to writer( ..., writer_data ) */
+rc_t pt_run_into( uint32_t num_workers, uint32_t num_slices, pt_slice_fn on_slice, void ** data,
+                  pt_write_fn writer, void * writer_data );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*  _h_pileup_threads_ */
@@ -58,6 +58,26 @@
 #include "rna_splice_log.h"
 #endif
 
+#ifndef _h_pileup_threads_
+#include "pileup_threads.h"
+#endif
+
+#ifndef _h_bam_out_
+#include "bam_out.h"
+#endif
+
+#ifndef _h_dyn_string_
+#include "dyn_string.h"
+#endif
+
+#ifndef _h_klib_printf_
+#include <klib/printf.h>
+#endif
+
+#ifndef _h_kproc_lock_
+#include <kproc/lock.h>
+#endif
+
 rc_t Quitting( void );      /* instead of including <kapp/main.h> */
 
 const char * PRIM_TABLE = "PRIMARY_ALIGNMENT";
@@ -783,17 +803,18 @@ static rc_t print_qslice( const samdump_opts * const opts,
             const char * ptr = &source[ *source_offset ];
             rc = dump_quality_33( opts, ptr, len, reverse ); /* sam-dump-opts.c */
             if ( rc == 0 ) {
-                rc = KOutMsg( "" );
+                rc = pt_out( opts -> out, "" );
                 if ( rc == 0 ) { *source_offset += len; }
             }
         } else {
-            rc = KOutMsg( "*" );
+            rc = pt_out( opts -> out, "*" );
         }
     }
     return rc;
 }
 
-static rc_t modify_and_print_cigar( const char * cigar,
+static rc_t modify_and_print_cigar( const samdump_opts * const opts,
+                                    const char * cigar,
                                     size_t cigar_len,
                                     CigOps *ref_cig,
                                     int32_t ref_cig_len,
@@ -805,9 +826,9 @@ static rc_t modify_and_print_cigar( const char * cigar,
         CigOps al_cig[ 1024 ];
         ExplodeCIGAR( al_cig, 1024, cigar, cigar_len );
         CombineCIGAR( cigbuf, al_cig, read_len, ref_pos, ref_cig, ref_cig_len );
-        rc = KOutMsg( "%s\t", cigbuf );
+        rc = pt_out( opts -> out, "%s\t", cigbuf );
     } else {
-        rc = KOutMsg( "*\t" );
+        rc = pt_out( opts -> out, "*\t" );
     }
     return rc;
 }
@@ -912,7 +933,8 @@ static rc_t print_quality_or_star( const samdump_opts * const opts,
         star_qual = ( i == q_len );
     }
     if ( star_qual ) {
-        rc = KOutMsg( "*" );
+        /* a BAM-record without qualities gets 0xff for them */
+        rc = ( opts -> rec != NULL ) ? 0 : pt_out( opts -> out, "*" );
     } else {
         rc = dump_quality_33( opts, q, q_len, false ); /* sam-dump-opts.c */
     }
@@ -944,12 +966,12 @@ static rc_t print_evidence_alignment_cg_sam( const samdump_opts * const opts,
         if ( opts -> print_cg_names ) {
             if ( spot_group_len > 0 ) {
                 /* SAM-FIELD: QNAME     constructed from spot-group/seq-name */
-                rc = KOutMsg( "%.*s-1:%.*s\t", spot_group_len, spot_group, seq_name_len, seq_name );
+                rc = pt_out( opts -> out, "%.*s-1:%.*s\t", spot_group_len, spot_group, seq_name_len, seq_name );
             }
         } else {
             if ( seq_name_len > 0 ) {
                 /* SAM-FIELD: QNAME     constructed from allel-id/sub-id */
-                rc = KOutMsg( "%.*s/ALLELE_%li.%u\t", seq_name_len, seq_name, rec -> id, ploidy_idx );
+                rc = pt_out( opts -> out, "%.*s/ALLELE_%li.%u\t", seq_name_len, seq_name, rec -> id, ploidy_idx );
             }
         }
     }
@@ -974,7 +996,7 @@ static rc_t print_evidence_alignment_cg_sam( const samdump_opts * const opts,
     /* SAM-FIELD: POS       SRA-column: REF_POS + 1 */
     /* SAM-FIELD: MAPQ      SRA-column: MAPQ ( from evidence-alignment-table, not from allel! ) */
     if ( rc == 0 ) {
-        rc = KOutMsg( "%u\t%s\t%i\t%d\t", sam_flags, ref_name, allele_pos + ref_pos + 1, mapq );
+        rc = pt_out( opts -> out, "%u\t%s\t%i\t%d\t", sam_flags, ref_name, allele_pos + ref_pos + 1, mapq );
     }
     /* get READ, QUALITY and EIDT_DIST before cigar manipulation because we need/change these values */
     if ( rc == 0 ) {
@@ -989,7 +1011,7 @@ static rc_t print_evidence_alignment_cg_sam( const samdump_opts * const opts,
             rc = cg_cigar_treatments( opts -> cigar_treatment, &cgc_input, &cgc_output, align_id, &( atx -> eval ) );
         }
         if ( rc == 0 ) {
-            rc = modify_and_print_cigar( cgc_output . p_cigar . ptr, cgc_output . p_cigar . len,
+            rc = modify_and_print_cigar( opts, cgc_output . p_cigar . ptr, cgc_output . p_cigar . len,
                                          atx -> cig_op_buffer, ref_cig_len, ref_pos, cgc_output . p_read . len );
         }
     }
@@ -998,7 +1020,7 @@ static rc_t print_evidence_alignment_cg_sam( const samdump_opts * const opts,
     /* SAM-FIELD: TLEN      SRA-column: TEMPLATE_LEN '0' not in table */
     /* SAM-FIELD: SEQ       SRA-column: READ  */
     if ( rc == 0 ) {
-        rc = KOutMsg( "*\t0\t0\t%.*s\t", cgc_output . p_read . len, cgc_output . p_read . ptr );
+        rc = pt_out( opts -> out, "*\t0\t0\t%.*s\t", cgc_output . p_read . len, cgc_output . p_read . ptr );
     }
     /* SAM-FIELD: QUAL      SRA-column: SAM_QUALITY */
     if ( rc == 0 ) {
@@ -1007,15 +1029,15 @@ static rc_t print_evidence_alignment_cg_sam( const samdump_opts * const opts,
     }
     /* OPT SAM-FIELD: RG     SRA-column: SEQ_SPOT_GROUP */
     if ( rc == 0 && spot_group_len > 0 ) {
-        rc = KOutMsg( "\tRG:Z:%.*s", spot_group_len, spot_group );
+        rc = pt_out( opts -> out, "\tRG:Z:%.*s", spot_group_len, spot_group );
     }
     if ( rc == 0 && cgc_output . p_tags . len > 0 ) {
-        rc = KOutMsg( "\t%.*s", cgc_output . p_tags . len, cgc_output . p_tags . ptr );
+        rc = pt_out( opts -> out, "\t%.*s", cgc_output . p_tags . len, cgc_output . p_tags . ptr );
     }
     /* OPT SAM-FIELD: ZI     SRA-column: rec -> id */
     /* OPT SAM-FIELD: ZA     SRA-column: ploidy_idx */
     if ( rc == 0 ) {
-        rc = KOutMsg( "\tZI:i:%li\tZA:i:%u", rec -> id, ploidy_idx );
+        rc = pt_out( opts -> out, "\tZI:i:%li\tZA:i:%u", rec -> id, ploidy_idx );
     }
     /* OPT SAM-FIELD: NH     SRA-column: ALIGNMENT_COUNT */
     if ( rc == 0 && atx -> eval . al_count_idx != COL_NOT_AVAILABLE ) {
@@ -1024,19 +1046,19 @@ static rc_t print_evidence_alignment_cg_sam( const samdump_opts * const opts,
         rc = read_uint8_ptr( align_id, cursor, atx -> eval . al_count_idx,
                              &al_count, &al_count_len, "ALIGNMENT_COUNT" );
         if ( rc == 0 && al_count_len > 0 ) {
-            rc = KOutMsg( "\tNH:i:%u", *al_count );
+            rc = pt_out( opts -> out, "\tNH:i:%u", *al_count );
         }
     }
     /* OPT SAM-FIELD: NM     SRA-column: EDIT_DISTANCE */
     if ( rc == 0 ) {
-        rc = KOutMsg( "\tNM:i:%u", cgc_output . edit_dist );
+        rc = pt_out( opts -> out, "\tNM:i:%u", cgc_output . edit_dist );
     }
     /* OPT SAM-FIELD: XI     SRA-column: ALIGN_ID */
     if ( rc == 0 && opts -> print_alignment_id_in_column_xi ) {
-        rc = KOutMsg( "\tXI:i:%u", align_id );
+        rc = pt_out( opts -> out, "\tXI:i:%u", align_id );
     }
     if ( rc == 0 ) {
-        rc = KOutMsg( "\n" );
+        rc = pt_out( opts -> out, "\n" );
     }
     return rc;
 }
@@ -1063,12 +1085,12 @@ static rc_t print_evidence_alignment_cg_ev_dnb( const samdump_opts * const opts,
         if ( opts -> print_cg_names ) {
             if ( spot_group_len > 0 ) {
                 /* SAM-FIELD: QNAME     constructed from spot-group/seq-name */
-                rc = KOutMsg( "%.*s-1:%.*s\t", spot_group_len, spot_group, seq_name_len, seq_name );
+                rc = pt_out( opts -> out, "%.*s-1:%.*s\t", spot_group_len, spot_group, seq_name_len, seq_name );
             }
         } else {
             if ( seq_name_len > 0 ) {
                 /* SAM-FIELD: QNAME     constructed from allel-id/sub-id */
-                rc = KOutMsg( "%.*s/ALLELE_%li.%u\t", seq_name_len, seq_name, rec -> id, ploidy_idx );
+                rc = pt_out( opts -> out, "%.*s/ALLELE_%li.%u\t", seq_name_len, seq_name, rec -> id, ploidy_idx );
             }
         }
     }
@@ -1093,7 +1115,7 @@ static rc_t print_evidence_alignment_cg_ev_dnb( const samdump_opts * const opts,
     /* SAM-FIELD: POS       SRA-column: REF_POS + 1 */
     /* SAM-FIELD: MAPQ      SRA-column: MAPQ ( from evidence-alignment-table, not from allel! ) */
     if ( rc == 0 ) {
-        rc = KOutMsg( "%u\tALLELE_%li.%u\t%i\t%d\t", sam_flags, rec -> id, ploidy_idx, ref_pos + 1, mapq );
+        rc = pt_out( opts -> out, "%u\tALLELE_%li.%u\t%i\t%d\t", sam_flags, rec -> id, ploidy_idx, ref_pos + 1, mapq );
     }
     /* get READ, QUALITY and EIDT_DIST before cigar manipulation because we need/change these values */
     if ( rc == 0 ) {
@@ -1110,14 +1132,14 @@ static rc_t print_evidence_alignment_cg_ev_dnb( const samdump_opts * const opts,
         if ( rc == 0 ) {
             rc = cg_canonical_print_cigar( cgc_output . p_cigar . ptr, cgc_output . p_cigar . len );
         }
-        if ( rc == 0 ) { rc = KOutMsg( "\t"); }
+        if ( rc == 0 ) { rc = pt_out( opts -> out, "\t"); }
     }
     /* SAM-FIELD: RNEXT     SRA-column: MATE_REF_NAME '*' no mates! */
     /* SAM-FIELD: PNEXT     SRA-column: MATE_REF_POS + 1 '0' no mates */
     /* SAM-FIELD: TLEN      SRA-column: TEMPLATE_LEN '0' not in table */
     /* SAM-FIELD: SEQ       SRA-column: READ  */
     if ( rc == 0 ) {
-        rc = KOutMsg( "*\t0\t0\t%.*s\t", cgc_output.p_read.len, cgc_output.p_read.ptr );
+        rc = pt_out( opts -> out, "*\t0\t0\t%.*s\t", cgc_output.p_read.len, cgc_output.p_read.ptr );
     }
     /* SAM-FIELD: QUAL      SRA-column: SAM_QUALITY */
     if ( rc == 0 ) {
@@ -1125,10 +1147,10 @@ static rc_t print_evidence_alignment_cg_ev_dnb( const samdump_opts * const opts,
     }
     /* OPT SAM-FIELD: RG     SRA-column: SEQ_SPOT_GROUP */
     if ( rc == 0 && spot_group_len > 0 ) {
-        rc = KOutMsg( "\tRG:Z:%.*s", spot_group_len, spot_group );
+        rc = pt_out( opts -> out, "\tRG:Z:%.*s", spot_group_len, spot_group );
     }
     if ( rc == 0 && cgc_output.p_tags.len > 0 ) {
-        rc = KOutMsg( "\t%.*s", cgc_output.p_tags.len, cgc_output.p_tags.ptr );
+        rc = pt_out( opts -> out, "\t%.*s", cgc_output.p_tags.len, cgc_output.p_tags.ptr );
     }
     /* OPT SAM-FIELD: NH     SRA-column: ALIGNMENT_COUNT */
     if ( rc == 0 && atx -> eval . al_count_idx != COL_NOT_AVAILABLE ) {
@@ -1136,19 +1158,19 @@ static rc_t print_evidence_alignment_cg_ev_dnb( const samdump_opts * const opts,
         uint32_t al_count_len;
         rc = read_uint8_ptr( align_id, cursor, atx -> eval . al_count_idx, &al_count, &al_count_len, "ALIGNMENT_COUNT" );
         if ( rc == 0 && al_count_len > 0 ) {
-            rc = KOutMsg( "\tNH:i:%u", *al_count );
+            rc = pt_out( opts -> out, "\tNH:i:%u", *al_count );
         }
     }
     /* OPT SAM-FIELD: NM     SRA-column: EDIT_DISTANCE */
     if ( rc == 0 ) {
-        rc = KOutMsg( "\tNM:i:%u", cgc_output.edit_dist );
+        rc = pt_out( opts -> out, "\tNM:i:%u", cgc_output.edit_dist );
     }
     /* OPT SAM-FIELD: XI     SRA-column: ALIGN_ID */
     if ( rc == 0 && opts -> print_alignment_id_in_column_xi ) {
-        rc = KOutMsg( "\tXI:i:%u", align_id );
+        rc = pt_out( opts -> out, "\tXI:i:%u", align_id );
     }
     if ( rc == 0 ) {
-        rc = KOutMsg( "\n" );
+        rc = pt_out( opts -> out, "\n" );
     }
     return rc;
 }
@@ -1214,24 +1236,24 @@ static rc_t print_alignment_sam_ev( const sam_dump_ctx * sam_ctx,
                 /* SAM-FIELD: MAPQ      SRA-column: MAPQ */
                 if ( rc == 0 ) {
                     if ( opts -> print_cg_names ) {
-                        rc = KOutMsg( "-1:0\t" );
+                        rc = pt_out( opts -> out, "-1:0\t" );
                     } else {
-                        rc = KOutMsg( "ALLELE_%li.%u\t", rec -> id, ploidy_idx + 1 );
+                        rc = pt_out( opts -> out, "ALLELE_%li.%u\t", rec -> id, ploidy_idx + 1 );
                     }
                 }
                 if ( rc == 0 ) {
-                    rc = KOutMsg( "0\t%s\t%u\t%d\t", ref_name, pos + 1, rec -> mapq );
+                    rc = pt_out( opts -> out, "0\t%s\t%u\t%d\t", ref_name, pos + 1, rec -> mapq );
                 }
                 /* SAM-FIELD: CIGAR     SRA-column: CIGAR_SHORT / CIGAR_LONG sliced!!! */
                 if ( rc == 0 ) {
-                    rc = KOutMsg( "%.*s\t", cigar_slice_len, transformed_cigar );
+                    rc = pt_out( opts -> out, "%.*s\t", cigar_slice_len, transformed_cigar );
                 }
                 /* SAM-FIELD: RNEXT     SRA-column: MATE_REF_NAME ( !!! row_len can be zero !!! ) */
                 /* SAM-FIELD: PNEXT     SRA-column: MATE_REF_POS + 1 ( !!! row_len can be zero !!! ) */
                 /* SAM-FIELD: TLEN      SRA-column: TEMPLATE_LEN ( !!! row_len can be zero !!! ) */
                 /* SAM-FIELD: SEQ       SRA-column: READ sliced!!! */
                 if ( rc == 0 ) {
-                    rc = KOutMsg( "*\t0\t0\t%.*s\t", read_slice_len, read );
+                    rc = pt_out( opts -> out, "*\t0\t0\t%.*s\t", read_slice_len, read );
                 }
                 /* SAM-FIELD: QUAL      SRA-column: SAM_QUALITY sliced!!! */
                 if ( rc == 0 ) {
@@ -1239,22 +1261,22 @@ static rc_t print_alignment_sam_ev( const sam_dump_ctx * sam_ctx,
                         rc = print_qslice( opts, false, quality, quality_str_len, &quality_offset,
                                            read_len_vector, read_len_vector_len, ploidy_idx );
                     else
-                        rc = KOutMsg( "*" );
+                        rc = pt_out( opts -> out, "*" );
                 }
                 /* OPT SAM-FIELD: RG     SRA-column: ploidy_idx */
                 if ( rc == 0 ) {
-                    rc = KOutMsg( "\tRG:Z:ALLELE_%u", ploidy_idx + 1 );
+                    rc = pt_out( opts -> out, "\tRG:Z:ALLELE_%u", ploidy_idx + 1 );
                 }
                 /* OPT SAM-FIELD: XI     SRA-column: ALIGN_ID */
                 if ( rc == 0 && opts -> print_alignment_id_in_column_xi ) {
-                    rc = KOutMsg( "\tXI:i:%u", rec -> id );
+                    rc = pt_out( opts -> out, "\tXI:i:%u", rec -> id );
                 }
                 /* OPT SAM-FIELD: NM     SRA-column: EDIT_DISTANCE sliced!!! */
                 if ( rc == 0 && ( ploidy_idx < edit_dist_vector_len ) ) {
-                    rc = KOutMsg( "\tNM:i:%u", edit_dist_vector[ ploidy_idx ] );
+                    rc = pt_out( opts -> out, "\tNM:i:%u", edit_dist_vector[ ploidy_idx ] );
                 }
                 if ( rc == 0 ) {
-                    rc = KOutMsg( "\n" );
+                    rc = pt_out( opts -> out, "\n" );
                 }
             }
             /* we do that here per ALLEL-READ, not at the end per ALLEL, because we have to test which alignments
@@ -1295,17 +1317,21 @@ static rc_t print_alignment_sam_ev( const sam_dump_ctx * sam_ctx,
     return rc;
 }
 
-static rc_t opt_field_spot_group( const VCursor * cursor, uint32_t col_id, int64_t row_id ) {
+static rc_t opt_field_spot_group( const samdump_opts * const opts, const VCursor * cursor, uint32_t col_id, int64_t row_id ) {
     const char * value = NULL;
     uint32_t len;    
     rc_t rc = read_char_ptr( row_id, cursor, col_id, &value, &len, "SPOT_GROUP" );
     if ( rc == 0 && len > 0 ) {
-        rc = KOutMsg( "\tRG:Z:%.*s", len, value );
+        if ( opts -> rec != NULL ) {
+            rc = bam_rec_tag_Z( opts -> rec, "RG", value, len ); /* bam_out.c */
+        } else {
+            rc = pt_out( opts -> out, "\tRG:Z:%.*s", len, value );
+        }
     }
     return rc;
 }
 
-static rc_t opt_field_lnk_group( const VCursor * cursor, uint32_t col_id, int64_t row_id ) {
+static rc_t opt_field_lnk_group( const samdump_opts * const opts, const VCursor * cursor, uint32_t col_id, int64_t row_id ) {
     const char * value = NULL;
     uint32_t len;    
     rc_t rc = read_char_ptr( row_id, cursor, col_id, &value, &len, "LINKAGE_GROUP" );
@@ -1345,9 +1371,18 @@ static rc_t opt_field_lnk_group( const VCursor * cursor, uint32_t col_id, int64_
         }
 
         if ( CB.addr == NULL && UB.addr == NULL ) {
-            rc = KOutMsg( "\tBX:Z:%.*s", len, value );
+            if ( opts -> rec != NULL ) {
+                rc = bam_rec_tag_Z( opts -> rec, "BX", value, len ); /* bam_out.c */
+            } else {
+                rc = pt_out( opts -> out, "\tBX:Z:%.*s", len, value );
+            }
+        } else if ( opts -> rec != NULL ) {
+            rc = bam_rec_tag_Z( opts -> rec, "CB", CB.addr, CB.size ); /* bam_out.c */
+            if ( rc == 0 ) {
+                rc = bam_rec_tag_Z( opts -> rec, "UB", UB.addr, UB.size ); /* bam_out.c */
+            }
         } else {
-            rc = KOutMsg( "\tCB:Z:%S\tUB:Z:%S", &CB, &UB );
+            rc = pt_out( opts -> out, "\tCB:Z:%S\tUB:Z:%S", &CB, &UB );
         }
     }
     return rc;
@@ -1483,12 +1518,12 @@ static rc_t print_alignment_sam_ps( const sam_dump_ctx * sam_ctx,
             } else {
                 rc = dump_name( opts, *seq_spot_id, NULL, 0 ); /* sam-dump-opts.c */
             }
-        } else {
-            rc = KOutMsg( "*" );
+        } else if ( opts -> rec == NULL ) {
+            rc = pt_out( opts -> out, "*" ); /* an empty name is a '*' in the BAM-record */
         }
     }
-    if ( rc == 0 ) {
-        rc = KOutMsg( "\t" );
+    if ( rc == 0 && opts -> rec == NULL ) {
+        rc = pt_out( opts -> out, "\t" );
     }
     /* massage the sam-flag if we are not dumping unaligned reads... */
     if ( !opts -> dump_unaligned_reads  /** not going to dump unaligned **/
@@ -1503,7 +1538,12 @@ static rc_t print_alignment_sam_ps( const sam_dump_ctx * sam_ctx,
     /* SAM-FIELD: POS       SRA-column: REF_POS + 1 */
     /* SAM-FIELD: MAPQ      SRA-column: MAPQ */
     if ( rc == 0 ) {
-        rc = KOutMsg( "%u\t%s\t%u\t%d\t", sam_flags, ref_name, pos + 1, rec -> mapq );
+        if ( opts -> rec != NULL ) {
+            rc = bam_rec_place( opts -> rec, sam_flags, ref_name, string_size( ref_name ),
+                                pos, rec -> mapq ); /* bam_out.c */
+        } else {
+            rc = pt_out( opts -> out, "%u\t%s\t%u\t%d\t", sam_flags, ref_name, pos + 1, rec -> mapq );
+        }
     }
     /* get READ, QUALITY and EIDT_DIST before cigar manipulation because we need/change these values */
     if ( rc == 0 ) {
@@ -1583,27 +1623,44 @@ static rc_t print_alignment_sam_ps( const sam_dump_ctx * sam_ctx,
             }
         }
         if ( rc == 0 ) {
-            rc = KOutMsg( "%.*s\t", cgc_output . p_cigar . len, cgc_output . p_cigar . ptr );
+            if ( opts -> rec != NULL ) {
+                rc = bam_rec_cigar( opts -> rec, cgc_output . p_cigar . ptr, cgc_output . p_cigar . len ); /* bam_out.c */
+            } else {
+                rc = pt_out( opts -> out, "%.*s\t", cgc_output . p_cigar . len, cgc_output . p_cigar . ptr );
+            }
         }
         if ( temp_cigar != NULL ) { free( temp_cigar ); }
     }
     /* SAM-FIELD: RNEXT     SRA-column: MATE_REF_NAME ( !!! row_len can be zero !!! ) */
     /* SAM-FIELD: PNEXT     SRA-column: MATE_REF_POS + 1 ( !!! row_len can be zero !!! ) */
     /* SAM-FIELD: TLEN      SRA-column: TEMPLATE_LEN ( !!! row_len can be zero !!! ) */
-    if ( rc == 0 ) {
+    if ( rc == 0 && opts -> rec != NULL ) {
+        /* the BAM-record has the 0-based positions, PNEXT is printed as given there */
+        if ( mate_ref_name_len > 0 ) {
+            rc = bam_rec_mate( opts -> rec, mate_ref_name, mate_ref_name_len, mate_ref_pos, tlen ); /* bam_out.c */
+        } else if ( mate_ref_pos_len == 0 ) {
+            rc = bam_rec_mate( opts -> rec, NULL, 0, -1, tlen ); /* bam_out.c */
+        } else {
+            rc = bam_rec_mate( opts -> rec, NULL, 0, ( int64_t )mate_ref_pos - 1, tlen ); /* bam_out.c */
+        }
+    } else if ( rc == 0 ) {
         if ( mate_ref_name_len > 0 ) {
-            rc = KOutMsg( "%.*s\t%u\t%d\t", mate_ref_name_len, mate_ref_name, mate_ref_pos + 1, tlen );
+            rc = pt_out( opts -> out, "%.*s\t%u\t%d\t", mate_ref_name_len, mate_ref_name, mate_ref_pos + 1, tlen );
         } else {
             if ( mate_ref_pos_len == 0 ) {
-                rc = KOutMsg( "*\t0\t%d\t", tlen );
+                rc = pt_out( opts -> out, "*\t0\t%d\t", tlen );
             } else {
-                rc = KOutMsg( "*\t%u\t%d\t", mate_ref_pos, tlen );
+                rc = pt_out( opts -> out, "*\t%u\t%d\t", mate_ref_pos, tlen );
             }
         }
     }
     /* SAM-FIELD: SEQ       SRA-column: READ */
     if ( rc == 0 ) {
-        rc = KOutMsg( "%.*s\t", cgc_output . p_read . len, cgc_output . p_read . ptr );
+        if ( opts -> rec != NULL ) {
+            rc = bam_rec_seq( opts -> rec, cgc_output . p_read . ptr, cgc_output . p_read . len ); /* bam_out.c */
+        } else {
+            rc = pt_out( opts -> out, "%.*s\t", cgc_output . p_read . len, cgc_output . p_read . ptr );
+        }
     }
     /* SAM-FIELD: QUAL      SRA-column: SAM_QUALITY */
     if ( rc == 0 ) {
@@ -1612,18 +1669,26 @@ static rc_t print_alignment_sam_ps( const sam_dump_ctx * sam_ctx,
     }
     /* OPT SAM-FIELD: RG     SRA-column: SPOT_GROUP */
     if ( rc == 0 && ( atx -> cmn . seq_spot_group_idx != COL_NOT_AVAILABLE ) ) {
-        rc = opt_field_spot_group( cursor, atx -> cmn . seq_spot_group_idx, id );
+        rc = opt_field_spot_group( opts, cursor, atx -> cmn . seq_spot_group_idx, id );
     }
     /* OPT SAM-FIELD: BZ     SRA-column: LINKAGE_GROUP */
     if ( rc == 0 && ( atx -> lnk_group_idx != COL_NOT_AVAILABLE ) ) {
-        rc = opt_field_lnk_group( cursor, atx -> lnk_group_idx, id );
+        rc = opt_field_lnk_group( opts, cursor, atx -> lnk_group_idx, id );
     }
     if ( rc == 0 && cgc_output . p_tags . len > 0 ) {
-        rc = KOutMsg( "\t%.*s", cgc_output . p_tags . len, cgc_output . p_tags . ptr );
+        if ( opts -> rec != NULL ) {
+            rc = bam_rec_tags( opts -> rec, cgc_output . p_tags . ptr, cgc_output . p_tags . len ); /* bam_out.c */
+        } else {
+            rc = pt_out( opts -> out, "\t%.*s", cgc_output . p_tags . len, cgc_output . p_tags . ptr );
+        }
     }
     /* OPT SAM-FIELD: XI     SRA-column: ALIGN_ID */
     if ( rc == 0 && opts -> print_alignment_id_in_column_xi ) {
-        rc = KOutMsg( "\tXI:i:%u", id );
+        if ( opts -> rec != NULL ) {
+            rc = bam_rec_tag_i( opts -> rec, "XI", ( uint32_t )id ); /* bam_out.c */
+        } else {
+            rc = pt_out( opts -> out, "\tXI:i:%u", id );
+        }
     }
     /* to match sam-tools output: in case we are dumping this in CG-mode.... */
     if ( rc == 0 &&
@@ -1636,7 +1701,18 @@ static rc_t print_alignment_sam_ps( const sam_dump_ctx * sam_ctx,
             uint32_t i;
             for ( i = 0; rc == 0 && i < align_grp_len - 1; ++i ) {
                 if ( align_grp[ i ] == '_' ) {
-                    rc = KOutMsg( "\tZI:i:%.*s\tZA:i:%.1s", i, align_grp, align_grp + i + 1 );
+                    if ( opts -> rec != NULL ) {
+                        /* the ALIGN_GROUP-column has the values as text, like the CG-tags */
+                        char tags[ 128 ];
+                        size_t num_writ;
+                        rc = string_printf( tags, sizeof tags, &num_writ, "ZI:i:%.*s\tZA:i:%.1s",
+                                            i, align_grp, align_grp + i + 1 );
+                        if ( rc == 0 ) {
+                            rc = bam_rec_tags( opts -> rec, tags, num_writ ); /* bam_out.c */
+                        }
+                    } else {
+                        rc = pt_out( opts -> out, "\tZI:i:%.*s\tZA:i:%.1s", i, align_grp, align_grp + i + 1 );
+                    }
                     break;
                 }
             }
@@ -1648,22 +1724,31 @@ static rc_t print_alignment_sam_ps( const sam_dump_ctx * sam_ctx,
         uint32_t al_count_len;
         rc = read_uint8_ptr( id, cursor, atx -> cmn . al_count_idx, &al_count, &al_count_len, "ALIGNMENT_COUNT" );
         if ( rc == 0 && al_count_len > 0 ) {
-            rc = KOutMsg( "\tNH:i:%u", *al_count );
+            if ( opts -> rec != NULL ) {
+                rc = bam_rec_tag_i( opts -> rec, "NH", *al_count ); /* bam_out.c */
+            } else {
+                rc = pt_out( opts -> out, "\tNH:i:%u", *al_count );
+            }
         }
     }
     /* OPT SAM-FIELD: NM     SRA-column: EDIT_DISTANCE */
     if ( rc == 0 ) {
-        rc = KOutMsg( "\tNM:i:%u", ( cgc_output . edit_dist - NM_adjustments ) );
+        if ( opts -> rec != NULL ) {
+            rc = bam_rec_tag_i( opts -> rec, "NM", ( uint32_t )( cgc_output . edit_dist - NM_adjustments ) ); /* bam_out.c */
+        } else {
+            rc = pt_out( opts -> out, "\tNM:i:%u", ( cgc_output . edit_dist - NM_adjustments ) );
+        }
     }
     /* OPT SAM-FIELD: XS:A:+/-  SRA-column: RNA-SPLICING detected via computation, or from the RNA_ORIENTATION - column */
     if ( rc == 0 ) {
         if ( opts -> rna_splicing ) {
             /* analysis of rna-splicing explicitly requested at the commandline */
             if ( candidates . fwd_matched > 0 || candidates . rev_matched > 0 ) {
-                if ( candidates . fwd_matched > 0 ) {
-                    rc = KOutMsg( "\tXS:A:+" );
+                char strand = ( candidates . fwd_matched > 0 ) ? '+' : '-';
+                if ( opts -> rec != NULL ) {
+                    rc = bam_rec_tag_A( opts -> rec, "XS", strand ); /* bam_out.c */
                 } else {
-                    rc = KOutMsg( "\tXS:A:-" );
+                    rc = pt_out( opts -> out, "\tXS:A:%c", strand );
                 }
             }
         } else {
@@ -1674,7 +1759,11 @@ static rc_t print_alignment_sam_ps( const sam_dump_ctx * sam_ctx,
                 rc = read_char_ptr( id, cursor, atx -> rna_orientation_idx,
                                     &rna_orientation, &rna_orientation_len, "RNA_ORIENTATION" );
                 if ( rc == 0 && rna_orientation_len > 0 ) {
-                    rc = KOutMsg( "\tXS:A:%c", rna_orientation[ 0 ] );
+                    if ( opts -> rec != NULL ) {
+                        rc = bam_rec_tag_A( opts -> rec, "XS", rna_orientation[ 0 ] ); /* bam_out.c */
+                    } else {
+                        rc = pt_out( opts -> out, "\tXS:A:%c", rna_orientation[ 0 ] );
+                    }
                 }
             }
         }
@@ -1687,8 +1776,22 @@ static rc_t print_alignment_sam_ps( const sam_dump_ctx * sam_ctx,
         } else {
             INSDC_coord_len ref_len;
             rc = ReferenceObj_Read( rec -> ref, pos, rec -> len, alig_ref, &ref_len );
-            if ( rc == 0 ) {
-                rc = kout_md_tag_from_cigar_string( cgc_output . p_cigar.ptr, cgc_output . p_cigar . len, /* cigar */
+            if ( rc == 0 && opts -> rec != NULL ) {
+                struct dyn_string * md;
+                rc = ds_allocate( &md, 128 ); /* dyn_string.c */
+                if ( rc == 0 ) {
+                    rc = md_tag_from_cigar_string( md,
+                            cgc_output . p_cigar.ptr, cgc_output . p_cigar . len,                         /* cigar */
+                            cgc_output . p_read . ptr, cgc_output . p_read . len,                         /* read */
+                            alig_ref, ref_len );                                                    /* reference */
+                    if ( rc == 0 ) {
+                        rc = bam_rec_tag_Z( opts -> rec, "MD", ds_get_char( md, 0 ), ds_len( md ) ); /* bam_out.c */
+                    }
+                    ds_free( md );
+                }
+            } else if ( rc == 0 ) {
+                rc = kout_md_tag_from_cigar_string( opts -> out,
+                        cgc_output . p_cigar.ptr, cgc_output . p_cigar . len,                             /* cigar */
                         cgc_output . p_read . ptr, cgc_output . p_read . len,                             /* read */
                         alig_ref, ref_len );                                                        /* reference */
             }
@@ -1696,7 +1799,11 @@ static rc_t print_alignment_sam_ps( const sam_dump_ctx * sam_ctx,
         }
     }
     if ( rc == 0 ) {
-        rc = KOutMsg( "\n" );
+        if ( opts -> rec != NULL ) {
+            rc = dump_bam_rec( opts ); /* sam-dump-opts.c */
+        } else {
+            rc = pt_out( opts -> out, "\n" );
+        }
     }
 
     /* print a log-info if have to because RNA-splicing is requested and we have not homogeneous bits */
@@ -1734,9 +1841,9 @@ static rc_t print_alignment_fastx( const sam_dump_ctx * sam_ctx,
     }
 
     if ( opts -> output_format == of_fastq ) {
-        rc = KOutMsg( "@" );
+        rc = pt_out( opts -> out, "@" );
     } else {
-        rc = KOutMsg( ">" );
+        rc = pt_out( opts -> out, ">" );
     }
 
     /* SAM-FIELD: QNAME     1.row: name */
@@ -1754,13 +1861,13 @@ static rc_t print_alignment_fastx( const sam_dump_ctx * sam_ctx,
                 rc = dump_name( opts, *seq_spot_id, NULL, 0 ); /* sam-dump-opts.c */
             }
         } else {
-            rc = KOutMsg( "*" );
+            rc = pt_out( opts -> out, "*" );
         }
         if ( rc == 0 ) {
             uint32_t seq_read_id;
             rc = read_uint32( rec -> id, cursor, atx -> cmn . seq_read_id_idx, &seq_read_id, 0, "SEQ_READ_ID" );
             if ( rc == 0 ) {
-                rc = KOutMsg( "/%u", seq_read_id );
+                rc = pt_out( opts -> out, "/%u", seq_read_id );
             }
         }
     }
@@ -1772,15 +1879,15 @@ static rc_t print_alignment_fastx( const sam_dump_ctx * sam_ctx,
     /* source of the alignment: primary/secondary/evidence */
     if ( rc == 0 ) {
         switch( atx -> align_table_type ) {
-            case att_primary    :   rc = KOutMsg( " primary" ); break;
-            case att_secondary  :   rc = KOutMsg( " secondary" ); break;
-            case att_evidence   :   rc = KOutMsg( " evidence" ); break;
+            case att_primary    :   rc = pt_out( opts -> out, " primary" ); break;
+            case att_secondary  :   rc = pt_out( opts -> out, " secondary" ); break;
+            case att_evidence   :   rc = pt_out( opts -> out, " evidence" ); break;
         }
     }
 
     /* against what reference aligned, at what position, with what mapping-quality */
     if ( rc == 0 ) {
-        rc = KOutMsg( " ref=%s pos=%u mapq=%i\n", ref_name, pos + 1, rec -> mapq );
+        rc = pt_out( opts -> out, " ref=%s pos=%u mapq=%i\n", ref_name, pos + 1, rec -> mapq );
     }
     /* READ at a new line */
     if ( rc == 0 ) {
@@ -1789,16 +1896,16 @@ static rc_t print_alignment_fastx( const sam_dump_ctx * sam_ctx,
         rc = read_char_ptr( rec -> id, cursor, atx -> cmn . raw_read_idx, &read, &read_size, "RAW_READ" );
         if ( rc == 0 ) {
             if ( read_size > 0 ) {
-                rc = KOutMsg( "%.*s\n", read_size, read );
+                rc = pt_out( opts -> out, "%.*s\n", read_size, read );
             } else {
-                rc = KOutMsg( "*\n" );
+                rc = pt_out( opts -> out, "*\n" );
             }
         }
     }
 
     /* QUALITY on a new line if in fastq-mode */
     if ( rc == 0 && opts -> output_format == of_fastq ) {
-        rc = KOutMsg( "+\n" );
+        rc = pt_out( opts -> out, "+\n" );
         if ( rc == 0 ) {
             const char * quality;
             uint32_t quality_size;
@@ -1807,10 +1914,10 @@ static rc_t print_alignment_fastx( const sam_dump_ctx * sam_ctx,
                 if ( quality_size > 0 ) {
                     rc = dump_quality_33( opts, quality, quality_size, orientation );  /* sam-dump-opts.c */
                 } else {
-                    rc = KOutMsg( "*" );
+                    rc = pt_out( opts -> out, "*" );
                 }
             }
-            if ( rc == 0 ) { rc = KOutMsg( "\n" ); }
+            if ( rc == 0 ) { rc = pt_out( opts -> out, "\n" ); }
         }
     }
     return rc;
@@ -2060,6 +2167,271 @@ static rc_t print_all_aligned_spots_0( const sam_dump_ctx * sam_ctx,
     return rc;
 }
 
+/* =========================================================================================== */
+
+/*
+    multi-threaded strategy #1 ( --threads N ):
+    * the references are cut into shards of SAM_DUMP_SHARD_LEN, in the order of strategy #1
+    * every shard gets its own placement-iterators and cursors, an alignment is printed
+      by the shard it starts in ( walk_position() filters by the start of the window )
+    * the worker-threads format the shards, each one with its own reference-lists and
+      mate-cache, the main-thread writes the output in shard-order ( pileup_threads.c )
+    * a mate in another shard is not in the mate-cache of the worker, its fields are read
+      from the table, as with --no-mate-cache ---> the output is the same as single-threaded
+    * the alignments with an unaligned mate, found by the workers, are merged into the
+      mate-cache of the caller, print_unaligned_spots() needs them
+    * placing the alignments of a shard is done under a lock, walking it is not
+*/
+
+#define SAM_DUMP_SHARD_LEN ( 4 * 1024 * 1024 )
+
+typedef struct aligned_shard {
+    uint32_t db_idx;
+    uint32_t ref_idx;
+    INSDC_coord_zero start;
+    INSDC_coord_len len;
+} aligned_shard;
+
+typedef struct shard_worker {
+    samdump_opts opts;          /* a copy, with the output-sink and the BAM-record of the worker */
+    input_files * ifs;          /* the same databases, but its own reference-lists */
+    matecache * mc;
+    const AlignMgr * a_mgr;
+    KLock * prepare_lock;       /* shared by all workers */
+    const Vector * shards;
+} shard_worker;
+
+static void CC shard_whack( void *item, void *data ) {
+    free( item );
+}
+
+static rc_t add_shard( Vector * shards, uint32_t db_idx, uint32_t ref_idx,
+                       INSDC_coord_zero start, INSDC_coord_len len ) {
+    rc_t rc = 0;
+    aligned_shard * shard = malloc( sizeof * shard );
+    if ( shard == NULL ) {
+        rc = RC( rcExe, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    } else {
+        shard -> db_idx = db_idx;
+        shard -> ref_idx = ref_idx;
+        shard -> start = start;
+        shard -> len = len;
+        rc = VectorAppend( shards, NULL, shard );
+        if ( rc != 0 ) {
+            free( shard );
+        }
+    }
+    return rc;
+}
+
+/* the same input-files and references as print_all_aligned_spots_0(), cut into shards */
+static rc_t plan_shards( const sam_dump_ctx * sam_ctx, Vector * shards ) {
+    rc_t rc = 0;
+    uint32_t db_idx;
+    for ( db_idx = 0; db_idx < sam_ctx -> ifs -> database_count && rc == 0; ++db_idx ) {
+        const input_database * ids = VectorGet( &( sam_ctx -> ifs -> dbs ), db_idx );
+        if ( ids != NULL ) {
+            uint32_t refobj_count;
+            rc = ReferenceList_Count( ids -> reflist, &refobj_count );
+            if ( rc == 0 && refobj_count > 0 ) {
+                uint32_t ref_idx;
+                for ( ref_idx = 0; ref_idx < refobj_count && rc == 0; ++ref_idx ) {
+                    const ReferenceObj * ref_obj;
+                    rc = ReferenceList_Get( ids -> reflist, &ref_obj, ref_idx );
+                    if ( rc == 0 && ref_obj != NULL ) {
+                        INSDC_coord_len ref_len;
+                        rc = ReferenceObj_SeqLength( ref_obj, &ref_len );
+                        if ( rc == 0 ) {
+                            uint64_t start;
+                            for ( start = 0; rc == 0 && start < ref_len; start += SAM_DUMP_SHARD_LEN ) {
+                                uint64_t len = ref_len - start;
+                                if ( len > SAM_DUMP_SHARD_LEN ) { len = SAM_DUMP_SHARD_LEN; }
+                                rc = add_shard( shards, db_idx, ref_idx, start, len );
+                            }
+                        }
+                        ReferenceObj_Release( ref_obj );
+                    }
+                }
+            }
+        }
+    }
+    return rc;
+}
+
+/* called by pileup_threads.c in the thread of the worker */
+static rc_t CC on_shard( uint32_t shard_idx, struct pt_sink * sink, void * data ) {
+    shard_worker * w = data;
+    const aligned_shard * shard = VectorGet( w -> shards, shard_idx );
+    const input_database * ids = NULL;
+    rc_t rc = 0;
+
+    if ( shard != NULL ) {
+        ids = VectorGet( &( w -> ifs -> dbs ), shard -> db_idx );
+    }
+    if ( ids == NULL ) {
+        rc = RC( rcExe, rcNoTarg, rcReading, rcParam, rcNull );
+        LOGERR( klogInt, rc, "invalid shard" );
+    } else {
+        sam_dump_ctx ctx = { &( w -> opts ), w -> ifs, w -> mc, NULL };
+        const ReferenceObj * ref_obj = NULL;
+        PlacementSetIterator * set_iter = NULL;
+        Vector context_list;
+
+        VectorInit ( &context_list, 0, 5 );
+        w -> opts . out = sink;
+
+        rc = KLockAcquire( w -> prepare_lock );
+        if ( rc != 0 ) {
+            LOGERR( klogInt, rc, "KLockAcquire() failed" );
+        } else {
+            rc = ReferenceList_Get( ids -> reflist, &ref_obj, shard -> ref_idx );
+            if ( rc != 0 ) {
+                LOGERR( klogInt, rc, "ReferenceList_Get() failed" );
+            } else {
+                rc = AlignMgrMakePlacementSetIterator( w -> a_mgr, &set_iter );
+                if ( rc != 0 ) {
+                    (void)LOGERR( klogErr, rc, "cannot create PlacementSetIterator" );
+                } else {
+                    rc = add_pl_iters( &( w -> opts ), set_iter, ref_obj, ids,    /* above */
+                        shard -> start,     /* where the shard starts on the reference */
+                        shard -> len,       /* the length of the shard */
+                        NULL,               /* no spotgroup re-grouping (yet) */
+                        &context_list
+                        );
+                }
+            }
+            KLockUnlock( w -> prepare_lock );
+        }
+
+        if ( rc == 0 ) {
+            rc = walk_placements( &ctx, set_iter ); /* above */
+        }
+
+        /* walk the context_list to free the align_table_context records, close/free the cursors... */
+        VectorWhack ( &context_list, destroy_align_table_context, NULL );
+        if ( set_iter != NULL ) { PlacementSetIteratorRelease( set_iter ); }
+        if ( ref_obj != NULL ) { ReferenceObj_Release( ref_obj ); }
+    }
+    return rc;
+}
+
+static rc_t make_shard_workers( const sam_dump_ctx * sam_ctx,
+                                const AlignMgr * const a_mgr,
+                                const Vector * shards,
+                                KLock * prepare_lock,
+                                shard_worker * workers,
+                                uint32_t num_workers ) {
+    const samdump_opts * opts = sam_ctx -> opts;
+    rc_t rc = 0;
+    uint32_t i;
+    for ( i = 0; rc == 0 && i < num_workers; ++i ) {
+        shard_worker * w = &( workers[ i ] );
+        w -> opts = *opts;
+        w -> opts . out = NULL;
+        w -> opts . rec = NULL;
+        w -> a_mgr = a_mgr;
+        w -> prepare_lock = prepare_lock;
+        w -> shards = shards;
+        if ( opts -> bam != NULL ) {
+            rc = bam_rec_make( &( w -> opts . rec ), opts -> bam ); /* bam_out.c */
+        }
+        if ( rc == 0 ) {
+            rc = clone_input_databases( &( w -> ifs ), sam_ctx -> ifs ); /* inputfiles.c */
+        }
+        if ( rc == 0 && opts -> use_mate_cache ) {
+            rc = make_matecache( &( w -> mc ), sam_ctx -> ifs -> database_count ); /* matecache.c */
+        }
+    }
+    return rc;
+}
+
+static rc_t release_shard_workers( const sam_dump_ctx * sam_ctx,
+                                   shard_worker * workers,
+                                   uint32_t num_workers,
+                                   rc_t rc ) {
+    uint32_t i;
+    for ( i = 0; i < num_workers; ++i ) {
+        shard_worker * w = &( workers[ i ] );
+        if ( w -> mc != NULL ) {
+            if ( rc == 0 && sam_ctx -> mc != NULL ) {
+                rc = matecache_merge_unaligned( sam_ctx -> mc, w -> mc ); /* matecache.c */
+            }
+            release_matecache( w -> mc );
+        }
+        if ( w -> ifs != NULL ) {
+            release_input_files( w -> ifs ); /* inputfiles.c */
+        }
+        if ( w -> opts . rec != NULL ) {
+            bam_rec_release( w -> opts . rec ); /* bam_out.c */
+        }
+    }
+    return rc;
+}
+
+/* called by pileup_threads.c in the main-thread: the encoded records of a shard */
+static rc_t CC write_bam_shard( const void * data, size_t len, void * writer_data ) {
+    return bam_out_write( writer_data, data, len ); /* bam_out.c */
+}
+
+static rc_t print_all_aligned_spots_0_mt( const sam_dump_ctx * sam_ctx,
+                                          const AlignMgr * const a_mgr ) {
+    Vector shards;
+    rc_t rc;
+
+    VectorInit( &shards, 0, 512 );
+    rc = plan_shards( sam_ctx, &shards );
+    if ( rc == 0 && VectorLength( &shards ) > 0 ) {
+        uint32_t num_shards = VectorLength( &shards );
+        uint32_t num_workers = sam_ctx -> opts -> threads;
+        shard_worker * workers;
+        void ** data;
+
+        if ( num_workers > num_shards ) { num_workers = num_shards; }
+        workers = calloc( num_workers, sizeof * workers );
+        data = calloc( num_workers, sizeof * data );
+        if ( workers == NULL || data == NULL ) {
+            rc = RC( rcExe, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+            (void)LOGERR( klogErr, rc, "cannot create shard-workers" );
+        } else {
+            KLock * prepare_lock;
+            rc = KLockMake( &prepare_lock );
+            if ( rc != 0 ) {
+                LOGERR( klogInt, rc, "KLockMake() failed" );
+            } else {
+                uint32_t i;
+                for ( i = 0; i < num_workers; ++i ) {
+                    data[ i ] = &( workers[ i ] );
+                }
+                rc = make_shard_workers( sam_ctx, a_mgr, &shards, prepare_lock, workers, num_workers );
+                if ( rc == 0 && sam_ctx -> opts -> bam != NULL ) {
+                    rc = pt_run_into( num_workers, num_shards, on_shard, data,
+                                      write_bam_shard, sam_ctx -> opts -> bam ); /* pileup_threads.c */
+                } else if ( rc == 0 ) {
+                    rc = pt_run( num_workers, num_shards, on_shard, data ); /* pileup_threads.c */
+                }
+                rc = release_shard_workers( sam_ctx, workers, num_workers, rc );
+                KLockRelease( prepare_lock );
+            }
+        }
+        free( ( void * ) data );
+        free( ( void * ) workers );
+    }
+    VectorWhack( &shards, shard_whack, NULL );
+    return rc;
+}
+
+/* only the default output of strategy #1 can be sharded without changing it */
+static bool use_shards( const samdump_opts * opts ) {
+    return ( opts -> threads > 1 &&
+             !opts -> no_mt &&
+             opts -> region_count == 0 &&
+             opts -> dump_mode == dm_one_ref_at_a_time &&
+             !opts -> rna_splicing &&
+             opts -> rna_splice_log == NULL &&
+             opts -> perf_log == NULL &&
+             !opts -> report_cache );
+}
+
 /*
    the user did not specify regions, print all alignments from all input-files
    this is strategy #2 to do this, throw all iterators for all input-files and all there references
@@ -2147,7 +2519,11 @@ rc_t print_aligned_spots( const sam_dump_ctx * sam_ctx ) {
         if ( opts -> region_count == 0 ) {
             /* the user did not specify regions to be printed ==> print all alignments */
             switch( opts -> dump_mode ) {
-                case dm_one_ref_at_a_time : rc = print_all_aligned_spots_0( sam_ctx, a_mgr ); /* above */
+                case dm_one_ref_at_a_time : if ( use_shards( opts ) ) {
+                                                rc = print_all_aligned_spots_0_mt( sam_ctx, a_mgr ); /* above */
+                                            } else {
+                                                rc = print_all_aligned_spots_0( sam_ctx, a_mgr ); /* above */
+                                            }
                                             break;
                 case dm_prepare_all_refs  : rc = print_all_aligned_spots_1( sam_ctx, a_mgr ); /* above */
                                             break;
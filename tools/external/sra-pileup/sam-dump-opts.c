@@ -50,6 +50,20 @@
 #include "rna_splice_log.h"
 #endif
 
+#ifndef _h_pileup_threads_
+#include "pileup_threads.h"
+#endif
+
+#ifndef _h_bam_out_
+#include "bam_out.h"
+#endif
+
+#ifndef _h_klib_printf_
+#include <klib/printf.h>
+#endif
+
+#include <stdarg.h>
+
 #define CURSOR_CACHE_SIZE 256*1024*1024
 
 /* =========================================================================================== */
@@ -711,6 +725,10 @@ static rc_t gather_flag_options( Args * args, samdump_opts * opts ) {
     rc = get_bool_option( args, OPT_NOQUAL, &opts->no_qual );
     if ( rc != 0 ) { return rc; }
 
+    /* produce BAM instead of SAM */
+    rc = get_bool_option( args, OPT_BAM, &opts->output_bam );
+    if ( rc != 0 ) { return rc; }
+
     /* forcing to use the legacy code in case of Evidence-Dnb was requested */
     if ( rc == 0 ) {
         if ( opts->dump_cg_ev_dnb ) {
@@ -819,6 +837,9 @@ static rc_t gather_int_options( Args * args, samdump_opts * opts ) {
     if ( rc == 0 ) {
         rc = get_uint32_option( args, OPT_RNA_SPLICEL, 0, &opts->rna_splice_level, true );
     }
+    if ( rc == 0 ) {
+        rc = get_uint32_option( args, OPT_THREADS, 1, &opts->threads, true );
+    }
     return rc;
 }
 
@@ -1159,6 +1180,8 @@ void report_options( const samdump_opts * opts ) {
     KOutMsg( "multithreading        : %s\n",  opts -> no_mt ? "NO" : "YES" );  
     KOutMsg( "with-MD-flag          : %s\n",  opts -> with_md_flag ? "YES" : "NO" );
     KOutMsg( "omit-qualities        : %s\n",  opts -> no_qual ? "YES" : "NO" );
+    KOutMsg( "BAM-output            : %s\n",  opts -> output_bam ? "YES" : "NO" );
+    KOutMsg( "threads               : %u\n",  opts -> threads );
     
 #if _DEBUGGING
     if ( opts->timing_file != NULL ) {
@@ -1192,6 +1215,30 @@ void release_options( samdump_opts * opts ) {
 
 /* =========================================================================================== */
 
+/* the BAM-records need the reference-dictionary of the header */
+static rc_t check_bam_options( samdump_opts * opts ) {
+    rc_t rc = 0;
+    if ( opts->output_bam ) {
+        const char * conflict = NULL;
+        if ( opts->output_format != of_sam ) {
+            conflict = "--fasta/--fastq";
+        } else if ( opts->output_compression != oc_none ) {
+            conflict = "--gzip/--bzip2";
+        } else if ( opts->header_mode == hm_none ) {
+            conflict = "--no-header";
+        } else if ( opts->force_legacy || opts->dump_cg_evidence || opts->dump_cg_sam || opts->dump_cg_ev_dnb ) {
+            conflict = "the CG-evidence/legacy-options";
+        } else if ( opts->report_cache ) {
+            conflict = "--cachereport";
+        }
+        if ( conflict != NULL ) {
+            rc = RC( rcExe, rcArgv, rcParsing, rcParam, rcInvalid );
+            (void)PLOGERR( klogErr, ( klogErr, rc, "--bam cannot be combined with $(c)", "c=%s", conflict ) );
+        }
+    }
+    return rc;
+}
+
 rc_t gather_options( Args * args, samdump_opts * opts )
 {
     rc_t rc = gather_region_options( args, opts );
@@ -1200,6 +1247,7 @@ rc_t gather_options( Args * args, samdump_opts * opts )
     if ( rc == 0 ) { rc = gather_int_options( args, opts ); }
     if ( rc == 0 ) { rc = gather_matepair_distances( args, opts ); }
     if ( rc == 0 ) { gather_unaligned_options( opts ); }
+    if ( rc == 0 ) { rc = check_bam_options( opts ); }
     return rc;
 }
 
@@ -1222,32 +1270,51 @@ bool is_this_alignment_requested( const samdump_opts * opts, const char *refname
     return res;
 }
 
+/* the QNAME goes into the BAM-record or is printed */
+static rc_t name_out( const samdump_opts * opts, const char * fmt, ... ) {
+    rc_t rc;
+    va_list args;
+    va_start ( args, fmt );
+    if ( opts->rec != NULL ) {
+        char buffer[ 1024 ];
+        size_t num_writ;
+        rc = string_vprintf( buffer, sizeof buffer, &num_writ, fmt, args );
+        if ( rc == 0 ) {
+            rc = bam_rec_name( opts->rec, buffer, num_writ ); /* bam_out.c */
+        }
+    } else {
+        rc = pt_vout( opts->out, fmt, args ); /* pileup_threads.c */
+    }
+    va_end ( args );
+    return rc;
+}
+
 rc_t dump_name( const samdump_opts * opts, int64_t seq_spot_id,
                 const char * spot_group, uint32_t spot_group_len ) {
     rc_t rc;
 
     if ( opts->print_cg_names ) {
         if ( spot_group != NULL && spot_group_len != 0 ) {
-            rc = KOutMsg( "%.*s-1:%lu", spot_group_len, spot_group, seq_spot_id );
+            rc = name_out( opts, "%.*s-1:%lu", spot_group_len, spot_group, seq_spot_id );
         } else {
-            rc = KOutMsg( "%lu", seq_spot_id );
+            rc = name_out( opts, "%lu", seq_spot_id );
         }
     } else {
         if ( opts->qname_prefix != NULL ) {
             /* we do have to print a prefix */
             if ( opts->print_spot_group_in_name && spot_group != NULL && spot_group_len > 0 ) {
-                rc = KOutMsg( "%s.%lu.%.*s", opts->qname_prefix, seq_spot_id, spot_group_len, spot_group );
+                rc = name_out( opts, "%s.%lu.%.*s", opts->qname_prefix, seq_spot_id, spot_group_len, spot_group );
             } else {
             /* we do NOT have to append the spot-group */
-                rc = KOutMsg( "%s.%lu", opts->qname_prefix, seq_spot_id );
+                rc = name_out( opts, "%s.%lu", opts->qname_prefix, seq_spot_id );
             }
         } else {
             /* we do NOT have to print a prefix */
             if ( opts->print_spot_group_in_name && spot_group != NULL && spot_group_len > 0 ) {
-                rc = KOutMsg( "%lu.%.*s", seq_spot_id, spot_group_len, spot_group );
+                rc = name_out( opts, "%lu.%.*s", seq_spot_id, spot_group_len, spot_group );
             } else {
             /* we do NOT have to append the spot-group */
-                rc = KOutMsg( "%lu", seq_spot_id );
+                rc = name_out( opts, "%lu", seq_spot_id );
             }
         }
     }
@@ -1278,6 +1345,31 @@ rc_t dump_name_legacy( const samdump_opts * opts, const char * name, size_t name
     return rc;
 }
 
+/* the BAM-record takes the qualities as phred + 33, the way they are printed */
+static rc_t bam_rec_quality( const samdump_opts * opts, char const *quality, uint32_t qual_len,
+                             bool reverse, uint8_t offset ) {
+    uint32_t i;
+    rc_t rc = 0;
+    size_t size = 0;
+    char buffer [ 4096 ];
+
+    for ( i = 0; i < qual_len && rc == 0; ++i ) {
+        uint8_t qual = ( uint8_t )quality[ reverse ? qual_len - i - 1 : i ] + offset;
+        if ( opts->qual_quant != NULL ) {
+            qual = opts->qual_quant_matrix[ ( uint8_t )( qual - 33 ) ] + 33;
+        }
+        buffer [ size ] = ( char )qual;
+        if ( ++ size == sizeof buffer ) {
+            rc = bam_rec_qual( opts->rec, buffer, size ); /* bam_out.c */
+            size = 0;
+        }
+    }
+    if ( rc == 0 && size != 0 ) {
+        rc = bam_rec_qual( opts->rec, buffer, size ); /* bam_out.c */
+    }
+    return rc;
+}
+
 #define USE_KWRT_HANDLER 1
 
 rc_t dump_quality( const samdump_opts * opts, char const *quality, uint32_t qual_len, bool reverse ) {
@@ -1289,7 +1381,13 @@ rc_t dump_quality( const samdump_opts * opts, char const *quality, uint32_t qual
     char buffer [ 4096 ];
 #if USE_KWRT_HANDLER
     size_t num_writ;
-    KWrtHandler * kout_msg_handler = KOutHandlerGet ();
+    KWrtHandler * kout_msg_handler;
+#endif
+    if ( opts->rec != NULL ) {
+        return bam_rec_quality( opts, quality, qual_len, reverse, 33 );
+    }
+#if USE_KWRT_HANDLER
+    kout_msg_handler = KOutHandlerGet ();
     assert ( kout_msg_handler != NULL );
 #endif
     if ( reverse ) {
@@ -1370,13 +1468,17 @@ rc_t dump_quality_33( const samdump_opts * opts, char const *quality, uint32_t q
     size_t size = 0;
     char buffer [ 4096 ];
 
+    if ( opts->rec != NULL ) {
+        return bam_rec_quality( opts, quality, qual_len, reverse, 0 );
+    }
+
     if ( reverse ) {
         if ( quantize ) {
             for ( i = 0; i < qual_len && rc == 0; ++i ) {
                 uint32_t qual = quality[ qual_len - i - 1 ] - 33;
                 buffer [ size ] = ( opts->qual_quant_matrix[ qual ] + 33 );
                 if ( ++ size == sizeof buffer ) {
-                    rc = KOutMsg( "%.*s", ( uint32_t ) size, buffer );
+                    rc = pt_out( opts->out, "%.*s", ( uint32_t ) size, buffer );
                     if ( rc != 0 ) break;
                     size = 0;
                 }
@@ -1385,7 +1487,7 @@ rc_t dump_quality_33( const samdump_opts * opts, char const *quality, uint32_t q
             for ( i = 0; i < qual_len && rc == 0; ++i ) {
                 buffer [ size ] = quality[ qual_len - i - 1 ];
                 if ( ++ size == sizeof buffer ) {
-                    rc = KOutMsg( "%.*s", ( uint32_t ) size, buffer );
+                    rc = pt_out( opts->out, "%.*s", ( uint32_t ) size, buffer );
                     if ( rc != 0 ) break;
                     size = 0;
                 }
@@ -1397,18 +1499,33 @@ rc_t dump_quality_33( const samdump_opts * opts, char const *quality, uint32_t q
                 uint32_t qual = quality[ i ] - 33;
                 buffer [ size ] = opts->qual_quant_matrix[ qual ] + 33;
                 if ( ++ size == sizeof buffer ) {
-                    rc = KOutMsg( "%.*s", ( uint32_t ) size, buffer );
+                    rc = pt_out( opts->out, "%.*s", ( uint32_t ) size, buffer );
                     if ( rc != 0 ) break;
                     size = 0;
                 }
             }
         } else {
-            rc = KOutMsg( "%.*s", qual_len, quality );
+            rc = pt_out( opts->out, "%.*s", qual_len, quality );
         }
     }
 
     if ( rc == 0 && size != 0 ) {
-        rc = KOutMsg( "%.*s", ( uint32_t ) size, buffer );
+        rc = pt_out( opts->out, "%.*s", ( uint32_t ) size, buffer );
+    }
+    return rc;
+}
+
+rc_t dump_bam_rec( const samdump_opts * opts ) {
+    const void * data;
+    size_t len;
+    rc_t rc = bam_rec_finish( opts->rec, &data, &len ); /* bam_out.c */
+    if ( rc == 0 ) {
+        if ( opts->out != NULL ) {
+            /* we are in a shard-worker, the records go out in shard-order */
+            rc = pt_write( opts->out, data, len ); /* pileup_threads.c */
+        } else {
+            rc = bam_out_write( opts->bam, data, len ); /* bam_out.c */
+        }
     }
     return rc;
 }
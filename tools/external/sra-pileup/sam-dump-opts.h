@@ -115,6 +115,8 @@ extern "C" {
 #define OPT_MD_FLAG     "with-md-flag"
 #define OPT_NGC         "ngc"
 #define OPT_NOQUAL      "omit-quality"
+#define OPT_BAM         "bam"
+#define OPT_THREADS     "threads"
 
 typedef struct range {
     uint64_t start;
@@ -195,6 +197,13 @@ typedef struct samdump_opts {
     /* timing-performane-log, created if timing_file given */
     struct perf_log * perf_log;
 
+    /* where the aligned spots are printed to, NULL = KOutMsg() ( pileup_threads.c ) */
+    struct pt_sink * out;
+
+    /* with --bam: where the records go, and the record the printers fill ( bam_out.c ) */
+    struct bam_out * bam;
+    struct bam_rec * rec;
+
     /* logging of rna-splicing on reqest */
     struct rna_splice_log * rna_splice_log;
 
@@ -207,6 +216,10 @@ typedef struct samdump_opts {
     /* how much buffering on the output-buffer, of OFF if zero */
     uint32_t output_buffer_size;
 
+    /* how many threads format the aligned spots and compress the BAM-output,
+       one = the main-thread does it */
+    uint32_t threads;
+
     /* mate's farther apart than this are not cached */
     uint32_t mape_gap_cache_limit;
 
@@ -267,6 +280,8 @@ typedef struct samdump_opts {
     /* option to disable multi-threading */
     bool no_mt;
     bool no_qual;
+    /* produce BAM instead of SAM */
+    bool output_bam;
 
 	bool with_md_flag;
 	
@@ -307,6 +322,9 @@ rc_t dump_quality( const samdump_opts * opts, char const *quality, uint32_t qual
 
 rc_t dump_quality_33( const samdump_opts * opts, char const *quality, uint32_t qual_len, bool reverse );
 
+/* hands the BAM-record in opts -> rec over to the sink of the shard or to the BAM-output */
+rc_t dump_bam_rec( const samdump_opts * opts );
+
 typedef struct samdump_ctx {
     const samdump_opts * const opts;
     const input_files * const ifs;
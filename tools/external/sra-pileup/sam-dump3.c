@@ -80,6 +80,10 @@
 #include "sam-unaligned.h"
 #endif
 
+#ifndef _h_bam_out_
+#include "bam_out.h"
+#endif
+
 #include <stdio.h>
 
 char const *sd_unaligned_usage[]      = { "Output unaligned reads along with aligned reads",
@@ -210,6 +214,10 @@ char const *no_qual_usage[]           = { "omit qualities", NULL };
 
 char const *with_md_flag_usage[]      = { "print MD-flag", NULL };
 
+char const *bam_usage[]               = { "Output BAM instead of SAM", NULL };
+
+char const *threads_usage[]           = { "number of threads formatting the aligned reads and compressing the BAM-output ( default 1 )", NULL };
+
 char const *ngc_usage[]               = { "PATH to ngc file", NULL };
 
 OptDef SamDumpArgs[] = {
@@ -255,6 +263,8 @@ OptDef SamDumpArgs[] = {
     { OPT_NO_MT,        NULL, NULL, no_mt_usage,             0, false, false },  /* force new code-path */
     { OPT_NOQUAL,       "o",  NULL, no_qual_usage,           0, false, false },  /* ommit qualities */
     { OPT_MD_FLAG,      NULL, NULL, with_md_flag_usage,      0, false, false },  /* print the MD-flag */
+    { OPT_BAM,          NULL, NULL, bam_usage,               0, false, false },  /* output BAM */
+    { OPT_THREADS,      NULL, NULL, threads_usage,           0, true,  false },  /* threads formatting aligned reads / compressing BAM */
     { OPT_DUMP_MODE,    NULL, NULL, NULL,                    0, true,  false },  /* how to produce aligned reads if no regions given */
     { OPT_CIGAR_TEST,   NULL, NULL, NULL,                    0, true,  false },  /* test cg-treatment of cigar string */
     { OPT_LEGACY,       NULL, NULL, NULL,                    0, false, false },  /* force legacy code-path */
@@ -306,6 +316,8 @@ char const *sd_usage_params[] = {
     NULL,                       /* no-mt */
     NULL,                       /* no-qualities */
     NULL,                       /* with-md-flag */
+    NULL,                       /* bam */
+    "count",                    /* threads */
     NULL,                       /* dump_mode */
     NULL,                       /* cigar test */
     NULL,                       /* force legacy code path */
@@ -430,7 +442,8 @@ static rc_t print_samdump( const samdump_opts * const opts ) {
                                  ( opts -> output_format == of_sam )     &&
                                  ( sam_ctx . ifs -> database_count > 0 ) &&
                                  ( opts -> header_mode != hm_none )      &&
-                                 !( opts -> dump_unaligned_only ) ) {
+                                 ( !( opts -> dump_unaligned_only ) || opts -> bam != NULL ) ) {
+                                /* the BAM-records need the reference-names of the header, even for unaligned mates */
                                 /* ------------------------------------------------------ */
                                 rc = print_headers_1( opts, sam_ctx . ifs ); /* sam-hdr.c */
                                 /* ------------------------------------------------------ */
@@ -519,9 +532,26 @@ static rc_t samdump_main( Args * args, const samdump_opts * const opts )
                 (void)LOGERR( klogErr, rc, "no inputfiles given at commandline" );
                 Usage( args );
             } else {
-                /* ------------------------------------------------------ */
-                rc = print_samdump( opts );
-                /* ------------------------------------------------------ */
+                /* a copy of the options, with the BAM-output and the record of the main-thread */
+                samdump_opts bam_opts = *opts;
+                if ( opts->output_bam ) {
+                    uint32_t num_threads = ( opts->threads > 1 && !opts->no_mt ) ? opts->threads : 0;
+                    rc = bam_out_make( &bam_opts.bam, num_threads, -1 ); /* from bam_out.c */
+                    if ( rc == 0 ) {
+                        rc = bam_rec_make( &bam_opts.rec, bam_opts.bam ); /* from bam_out.c */
+                    }
+                }
+                if ( rc == 0 ) {
+                    /* ------------------------------------------------------ */
+                    rc = print_samdump( &bam_opts );
+                    /* ------------------------------------------------------ */
+                }
+                if ( bam_opts.rec != NULL ) {
+                    bam_rec_release( bam_opts.rec ); /* from bam_out.c */
+                }
+                if ( bam_opts.bam != NULL ) {
+                    rc = bam_out_finish( bam_opts.bam, rc ); /* from bam_out.c */
+                }
             }
         }
         release_out_redir( &redir ); /* from out_redir.c */
@@ -50,6 +50,14 @@
 #include <klib/log.h>
 #endif
 
+#ifndef _h_dyn_string_
+#include "dyn_string.h"
+#endif
+
+#ifndef _h_bam_out_
+#include "bam_out.h"
+#endif
+
 typedef struct headers {
     VNamelist * SQ_Lines_1;
     VNamelist * SQ_Lines_2;
@@ -647,28 +655,43 @@ static rc_t collect_from_src_and_files( headers * h, const input_files * ifs, co
     return rc;
 }
 
-static rc_t print_HD_line( const VNamelist * lines ) {
+/* text == NULL: the line is printed, otherwise it is collected for the BAM-output */
+static rc_t print_line( struct dyn_string * text, const char * line ) {
+    rc_t rc;
+    if ( text == NULL ) {
+        rc = KOutMsg( "%s\n", line );
+    } else {
+        rc = ds_add_str( text, line ); /* dyn_string.c */
+        if ( rc == 0 ) {
+            rc = ds_add_char( text, '\n' ); /* dyn_string.c */
+        }
+    }
+    return rc;
+}
+
+static rc_t print_HD_line( const VNamelist * lines, struct dyn_string * text ) {
     uint32_t count;
     rc_t rc = VNameListCount( lines, &count );
     if ( rc == 0 && count > 0 ) {
         const char * line = NULL;
         rc = VNameListGet( lines, 0, &line );
         if ( rc == 0 && line != NULL ) {
-            rc = KOutMsg( "%s\n", line );
+            rc = print_line( text, line );
         } else {
-            rc = KOutMsg( "@HD\tVN:1.2\tSO:coordinate\n" );
+            rc = print_line( text, "@HD\tVN:1.2\tSO:coordinate" );
         }
     } else {
-        rc = KOutMsg( "@HD\tVN:1.2\tSO:coordinate\n" );
+        rc = print_line( text, "@HD\tVN:1.2\tSO:coordinate" );
     }
     return rc;
 }
 
 static rc_t print_callback( const char * line, void * context ) {
-    return KOutMsg( "%s\n", line );
+    return print_line( context, line );
 }
 
-static rc_t merge_and_print( VNamelist ** L1, const VNamelist * L2, bool print_L2_if_only_src ) {
+static rc_t merge_and_print( VNamelist ** L1, const VNamelist * L2, bool print_L2_if_only_src,
+                             struct dyn_string * text ) {
     uint32_t count1, count2;
     
     rc_t rc = VNameListCount( *L1, &count1 );
@@ -681,12 +704,12 @@ static rc_t merge_and_print( VNamelist ** L1, const VNamelist * L2, bool print_L
                 rc = merge_header_tags_of_2_lists( L1, L2, true );
             }
             if ( rc == 0 ) {
-                rc = for_each_line( *L1, print_callback, NULL );
+                rc = for_each_line( *L1, print_callback, text );
             }
         } else if ( count1 > 0 ) {
-            rc = for_each_line( *L1, print_callback, NULL );
+            rc = for_each_line( *L1, print_callback, text );
         } else if ( print_L2_if_only_src && ( count2 > 0 ) ) {
-            rc = for_each_line( L2, print_callback, NULL );
+            rc = for_each_line( L2, print_callback, text );
         }
     }
     return rc;
@@ -694,7 +717,14 @@ static rc_t merge_and_print( VNamelist ** L1, const VNamelist * L2, bool print_L
 
 rc_t print_headers_1( const samdump_opts * opts, const input_files * ifs ) {
     headers h;
+    struct dyn_string * text = NULL;    /* the header-text for the BAM-output */
     rc_t rc = init_headers( &h, 25 );
+    if ( rc == 0 && opts->bam != NULL ) {
+        rc = ds_allocate( &text, 4096 ); /* dyn_string.c */
+        if ( rc != 0 ) {
+            release_headers( &h );
+        }
+    }
     if ( rc == 0 ) {
         /* collect ... */
         switch( opts->header_mode ) {
@@ -704,20 +734,20 @@ rc_t print_headers_1( const samdump_opts * opts, const input_files * ifs ) {
                the recalculated-lines ( if requested via --seqid ) will be in list #2
             */
             case hm_dump    :  rc = collect_from_bam_hdr( &h, ifs, opts->use_seqid_as_refname );
-                               if ( rc == 0 ) { rc = print_HD_line( h.HD_Lines ); }
-                               if ( rc == 0 ) { rc = for_each_line( h.SQ_Lines_1, print_callback, NULL ); }
-                               if ( rc == 0 ) { rc = for_each_line( h.SQ_Lines_2, print_callback, NULL ); }
-                               if ( rc == 0 ) { rc = for_each_line( h.RG_Lines_1, print_callback, NULL ); }
-                               if ( rc == 0 ) { rc = for_each_line( h.RG_Lines_2, print_callback, NULL ); }
+                               if ( rc == 0 ) { rc = print_HD_line( h.HD_Lines, text ); }
+                               if ( rc == 0 ) { rc = for_each_line( h.SQ_Lines_1, print_callback, text ); }
+                               if ( rc == 0 ) { rc = for_each_line( h.SQ_Lines_2, print_callback, text ); }
+                               if ( rc == 0 ) { rc = for_each_line( h.RG_Lines_1, print_callback, text ); }
+                               if ( rc == 0 ) { rc = for_each_line( h.RG_Lines_2, print_callback, text ); }
                                break;
 
             /* collect the headers by iterating over the REFERENCE-table
                the recalculated-lines will be in list #1
             */
             case hm_recalc  : rc = collect_by_recalc( &h, ifs, opts->use_seqid_as_refname );
-                              if ( rc == 0 ) { rc = print_HD_line( h.HD_Lines ); }
-                              if ( rc == 0 ) { rc = for_each_line( h.SQ_Lines_1, print_callback, NULL ); }
-                              if ( rc == 0 ) { rc = for_each_line( h.RG_Lines_1, print_callback, NULL ); }
+                              if ( rc == 0 ) { rc = print_HD_line( h.HD_Lines, text ); }
+                              if ( rc == 0 ) { rc = for_each_line( h.SQ_Lines_1, print_callback, text ); }
+                              if ( rc == 0 ) { rc = for_each_line( h.RG_Lines_1, print_callback, text ); }
                               break;
 
             /* collect the headers that were written by the loader ( list #1 )
@@ -725,11 +755,11 @@ rc_t print_headers_1( const samdump_opts * opts, const input_files * ifs ) {
                and merge header-fields with the ones from a user-supplied file ( list #3 )
             */
             case hm_file    : rc = collect_from_src_and_files( &h, ifs, opts->header_file, opts->use_seqid_as_refname );
-                              if ( rc == 0 ) { rc = print_HD_line( h.HD_Lines ); }
-                              if ( rc == 0 ) { rc = merge_and_print( &h.SQ_Lines_1, h.SQ_Lines_3, true ); }
-                              if ( rc == 0 ) { rc = merge_and_print( &h.RG_Lines_1, h.RG_Lines_3, true ); }
-                              if ( rc == 0 ) { rc = merge_and_print( &h.SQ_Lines_2, h.SQ_Lines_3, false ); }
-                              if ( rc == 0 ) { rc = merge_and_print( &h.RG_Lines_2, h.RG_Lines_3, false ); }
+                              if ( rc == 0 ) { rc = print_HD_line( h.HD_Lines, text ); }
+                              if ( rc == 0 ) { rc = merge_and_print( &h.SQ_Lines_1, h.SQ_Lines_3, true, text ); }
+                              if ( rc == 0 ) { rc = merge_and_print( &h.RG_Lines_1, h.RG_Lines_3, true, text ); }
+                              if ( rc == 0 ) { rc = merge_and_print( &h.SQ_Lines_2, h.SQ_Lines_3, false, text ); }
+                              if ( rc == 0 ) { rc = merge_and_print( &h.RG_Lines_2, h.RG_Lines_3, false, text ); }
                               break;
 
             case hm_none    : break; /* to not let the compiler complain about not handled enum */
@@ -737,8 +767,12 @@ rc_t print_headers_1( const samdump_opts * opts, const input_files * ifs ) {
 
         /* all other lines collected: ( not HD,SQ,RG ) */
         if ( rc == 0 ) {
-            rc = for_each_line( h.Other_Lines, print_callback, NULL );
+            rc = for_each_line( h.Other_Lines, print_callback, text );
+        }
+        if ( rc == 0 && text != NULL ) {
+            rc = bam_out_header( opts->bam, ds_get_char( text, 0 ), ds_len( text ) ); /* bam_out.c */
         }
+        ds_free( text );    /* tolerates NULL-ptr */
         release_headers( &h );
     }
     return rc;
@@ -42,7 +42,16 @@
 #include "perf_log.h"
 #endif
 
+#ifndef _h_bam_out_
+#include "bam_out.h"
+#endif
+
+#ifndef _h_klib_printf_
+#include <klib/printf.h>
+#endif
+
 #include <ctype.h>    /* isalpha() / islower() / tolower() / toupper() */
+#include <stdarg.h>
 
 rc_t Quitting( void );      /* instead of including <kapp/main.h> */
 
@@ -348,7 +357,8 @@ static rc_t get_mate_info( const prim_table_ctx * const ptx,
     return rc;
 }
 
-static rc_t print_sliced_read( const INSDC_dna_text * read,
+static rc_t print_sliced_read( const samdump_opts * opts,
+                               const INSDC_dna_text * read,
                                uint32_t read_idx,
                                bool reverse,
                                const INSDC_coord_zero * read_start,
@@ -356,7 +366,11 @@ static rc_t print_sliced_read( const INSDC_dna_text * read,
     rc_t rc = 0;
     const INSDC_dna_text * ptr = read + read_start[ read_idx ];
     if ( !reverse ) {
-        rc = KOutMsg( "%.*s", read_len[ read_idx ], ptr );
+        if ( opts -> rec != NULL ) {
+            rc = bam_rec_seq( opts -> rec, ptr, read_len[ read_idx ] ); /* bam_out.c */
+        } else {
+            rc = KOutMsg( "%.*s", read_len[ read_idx ], ptr );
+        }
     } else {
         const char cmp_tbl [] = {
             'T', 'V', 'G', 'H', 'E', 'F', 'C', 'D',
@@ -374,7 +388,12 @@ static rc_t print_sliced_read( const INSDC_dna_text * read,
                      c = cmp_tbl [ c - 'A' ];
                 }
             }
-            rc = KOutMsg( "%c", ( char ) c );
+            if ( opts -> rec != NULL ) {
+                char base = ( char ) c;
+                rc = bam_rec_seq( opts -> rec, &base, 1 ); /* bam_out.c */
+            } else {
+                rc = KOutMsg( "%c", ( char ) c );
+            }
             i--;
         }
     }
@@ -397,8 +416,8 @@ static rc_t print_sliced_quality( const sam_dump_ctx * sam_ctx,
             if ( n > 0 ) {
                 rc = ds_print_char_n( sam_ctx -> ds, '?', n );
             }
-        } else {
-            rc = KOutMsg( "*" );
+        } else if ( opts -> rec == NULL ) {
+            rc = KOutMsg( "*" ); /* a BAM-record without qualities gets 0xff for them */
         }
     } else {
         const char * quality_ptr = quality + read_start[ read_idx ];
@@ -407,7 +426,52 @@ static rc_t print_sliced_quality( const sam_dump_ctx * sam_ctx,
     return rc;
 }
 
-static rc_t dump_the_other_read( const seq_table_ctx * const stx,
+/* QNAME: goes into the BAM-record or is printed followed by a tab */
+static rc_t print_qname( const samdump_opts * opts, const char * fmt, ... ) {
+    rc_t rc;
+    char buffer[ 1024 ];
+    size_t num_writ;
+    va_list args;
+
+    va_start ( args, fmt );
+    rc = string_vprintf( buffer, sizeof buffer, &num_writ, fmt, args );
+    va_end ( args );
+    if ( rc == 0 ) {
+        if ( opts -> rec != NULL ) {
+            rc = bam_rec_name( opts -> rec, buffer, num_writ ); /* bam_out.c */
+        } else {
+            rc = KOutMsg( "%.*s\t", ( uint32_t )num_writ, buffer );
+        }
+    }
+    return rc;
+}
+
+/* FLAG, RNAME, POS, MAPQ, CIGAR of an unaligned read */
+static rc_t print_unplaced( const samdump_opts * opts, uint32_t sam_flags ) {
+    if ( opts -> rec != NULL ) {
+        return bam_rec_place( opts -> rec, sam_flags, NULL, 0, -1, 0 ); /* bam_out.c */
+    }
+    return KOutMsg( "%u\t*\t0\t0\t*\t", sam_flags );
+}
+
+/* RNEXT, PNEXT and a TLEN of zero, pos as printed ( 1-based, 0 = none ) */
+static rc_t print_mate( const samdump_opts * opts, const char * ref_name, uint32_t ref_name_len, int64_t pos ) {
+    if ( opts -> rec != NULL ) {
+        return bam_rec_mate( opts -> rec, ref_name, ref_name_len, pos - 1, 0 ); /* bam_out.c */
+    }
+    return KOutMsg( "%.*s\t%li\t0\t", ref_name_len, ref_name, pos );
+}
+
+/* the end of the record: the line-feed or the BAM-record goes out */
+static rc_t print_end_of_record( const samdump_opts * opts ) {
+    if ( opts -> rec != NULL ) {
+        return dump_bam_rec( opts ); /* sam-dump-opts.c */
+    }
+    return KOutMsg( "\n" );
+}
+
+static rc_t dump_the_other_read( const samdump_opts * opts,
+                                 const seq_table_ctx * const stx,
                                  const prim_table_ctx * const ptx,
                                  const int64_t row_id,
                                  const uint32_t mate_idx ) {
@@ -428,7 +492,7 @@ static rc_t dump_the_other_read( const seq_table_ctx * const stx,
             /* read from the PRIMARY_ALIGNMENT_TABLE the value of the columns "REF_NAME" and "REF_POS" */
             int64_t a_row_id = prim_al_id_ptr[ mate_idx ];
             if ( a_row_id == 0 ) {
-                rc = KOutMsg( "*\t0\t" );
+                rc = print_mate( opts, "*", 1, 0 );
             } else {
                 const char * ref_name;
                 uint32_t ref_name_len;
@@ -443,7 +507,7 @@ static rc_t dump_the_other_read( const seq_table_ctx * const stx,
                         rc = read_INSDC_coord_zero_ptr( a_row_id, ptx -> cursor, ptx -> ref_pos_idx,
                                                         &ref_pos, &row_len, "REF_POS" );
                         if ( rc == 0 ) {
-                            rc = KOutMsg( "%.*s\t%i\t", ref_name_len, ref_name, ref_pos[ 0 ] + 1 );
+                            rc = print_mate( opts, ref_name, ref_name_len, ( int64_t )ref_pos[ 0 ] + 1 );
                         }
                     }
                 }
@@ -535,24 +599,32 @@ static bool calc_reverse_flag( const samdump_opts * const opts,
     return res;
 }
 
-static rc_t opt_field_spot_group( const seq_table_ctx * const stx, int64_t row_id ) {
+static rc_t opt_field_spot_group( const samdump_opts * opts, const seq_table_ctx * const stx, int64_t row_id ) {
     const char * spot_group = NULL;
     uint32_t spot_group_len;
     rc_t rc = read_char_ptr( row_id, stx -> cursor, stx -> spot_group_idx, &spot_group,
                              &spot_group_len, "SPOT_GROUP" );
     if ( rc == 0 && spot_group_len > 0 ) {
-        rc = KOutMsg( "\tRG:Z:%.*s", spot_group_len, spot_group );
+        if ( opts -> rec != NULL ) {
+            rc = bam_rec_tag_Z( opts -> rec, "RG", spot_group, spot_group_len ); /* bam_out.c */
+        } else {
+            rc = KOutMsg( "\tRG:Z:%.*s", spot_group_len, spot_group );
+        }
     }
     return rc;
 }
 
-static rc_t opt_field_lnk_group( const seq_table_ctx * const stx, int64_t row_id ) {
+static rc_t opt_field_lnk_group( const samdump_opts * opts, const seq_table_ctx * const stx, int64_t row_id ) {
     const char * lnk_grp;
     uint32_t lnk_grp_len;
     rc_t rc = read_char_ptr( row_id, stx -> cursor, stx -> lnk_group_idx, &lnk_grp,
                              &lnk_grp_len, "LINKAGE_GROUP" );
     if ( rc == 0 && lnk_grp_len > 0 ) {
-        rc = KOutMsg( "\tBX:Z:%.*s", lnk_grp_len, lnk_grp );
+        if ( opts -> rec != NULL ) {
+            rc = bam_rec_tag_Z( opts -> rec, "BX", lnk_grp, lnk_grp_len ); /* bam_out.c */
+        } else {
+            rc = KOutMsg( "\tBX:Z:%.*s", lnk_grp_len, lnk_grp );
+        }
     }
     return rc;
 }
@@ -626,12 +698,12 @@ static rc_t dump_seq_row_sam_filtered( const sam_dump_ctx * sam_ctx,
                                     rc = read_char_ptr( row_id, stx -> cursor, stx -> spot_group_idx,
                                                         &spot_group, &spot_group_len, "SPOT_GROUP" );
                                     if ( rc == 0 && spot_group_len > 0 ) {
-                                        rc = KOutMsg( "%ld.%.*s\t", seq_spot_id, spot_group_len, spot_group );
+                                        rc = print_qname( opts, "%ld.%.*s", seq_spot_id, spot_group_len, spot_group );
                                         print_just_seq_spot_id = false;
                                     }
                                 }
                                 if ( print_just_seq_spot_id ) {
-                                    rc = KOutMsg( "%ld\t", seq_spot_id );
+                                    rc = print_qname( opts, "%ld", seq_spot_id );
                                 }
                             }
 
@@ -648,24 +720,18 @@ static rc_t dump_seq_row_sam_filtered( const sam_dump_ctx * sam_ctx,
                             if ( rc == 0 ) {
                                 uint32_t sam_flags = calculate_unaligned_sam_flags_db( nreads, read_idx, mate_idx,
                                                                        align_id, read_type, reverse, read_filter );
-                                rc = KOutMsg( "%u\t", sam_flags );
-                            }
-
-                            /* SAM-FIELD: RNAME     SRA-column: none, fix '*' */
-                            /* SAM-FIELD: POS       SRA-column: none, fix '0' */
-                            /* SAM-FIELD: MAPQ      SRA-column: none, fix '0' */
-                            /* SAM-FIELD: CIGAR     SRA-column: none, fix '*' */
-                            if ( rc == 0 ) {
-                                rc = KOutMsg( "*\t0\t0\t*\t" );
+                                /* SAM-FIELD: RNAME     SRA-column: none, fix '*' */
+                                /* SAM-FIELD: POS       SRA-column: none, fix '0' */
+                                /* SAM-FIELD: MAPQ      SRA-column: none, fix '0' */
+                                /* SAM-FIELD: CIGAR     SRA-column: none, fix '*' */
+                                rc = print_unplaced( opts, sam_flags );
                             }
                             /* SAM-FIELD: RNEXT     SRA-column: found in cache */
                             /* SAM-FIELD: POS       SRA-column: found in cache */
-                            if ( rc == 0 ) {
-                                rc = KOutMsg( "%s\t%li\t", mate_ref_name, mate_ref_pos + 1 );
-                            }
                             /* SAM-FIELD: TLEN      SRA-column: none, fix '0' */
                             if ( rc == 0 ) {
-                                rc = KOutMsg( "0\t" );
+                                rc = print_mate( opts, mate_ref_name, string_size( mate_ref_name ),
+                                                 ( int64_t )mate_ref_pos + 1 );
                             }
                             if ( rc == 0 && read == NULL ) {
                                 rc = read_INSDC_dna_text_ptr( row_id, stx -> cursor, stx -> read_idx,
@@ -679,9 +745,9 @@ static rc_t dump_seq_row_sam_filtered( const sam_dump_ctx * sam_ctx,
                             }
                             /* SAM-FIELD: SEQ       SRA-column: READ, sliced by READ_START/READ_LEN */
                             if ( rc == 0 ) {
-                                rc = print_sliced_read( read, read_idx, reverse, read_start, read_len );
+                                rc = print_sliced_read( opts, read, read_idx, reverse, read_start, read_len );
                             }
-                            if ( rc == 0 ) {
+                            if ( rc == 0 && opts -> rec == NULL ) {
                                 rc = KOutMsg( "\t" );
                             }
                             /* SAM-FIELD: QUAL      SRA-column: QUALITY, sliced by READ_START/READ_LEN */
@@ -690,18 +756,22 @@ static rc_t dump_seq_row_sam_filtered( const sam_dump_ctx * sam_ctx,
                             }
                             /* OPT SAM-FIELD:       SRA-column: ALIGN_ID */
                             if ( rc == 0 && opts -> print_alignment_id_in_column_xi ) {
-                                rc = KOutMsg( "\tXI:i:%u", row_id );
+                                if ( opts -> rec != NULL ) {
+                                    rc = bam_rec_tag_i( opts -> rec, "XI", ( uint32_t )row_id ); /* bam_out.c */
+                                } else {
+                                    rc = KOutMsg( "\tXI:i:%u", row_id );
+                                }
                             }
                             /* OPT SAM-FIELD:      SRA-column: SPOT_GROUP */
                             if ( rc == 0 && stx -> spot_group_idx != COL_NOT_AVAILABLE ) {
-                                rc = opt_field_spot_group( stx, row_id );
+                                rc = opt_field_spot_group( opts, stx, row_id );
                             }
                             /* OPT SAM-FIELD:       SRA-column: LINKAGE_GROUP */
                             if ( rc == 0 && stx -> lnk_group_idx != COL_NOT_AVAILABLE ) {
-                                rc = opt_field_lnk_group( stx, row_id );
+                                rc = opt_field_lnk_group( opts, stx, row_id );
                             }
                             if ( rc == 0 ) {
-                                rc = KOutMsg( "\n" );
+                                rc = print_end_of_record( opts );
                             }
                         }
                     }
@@ -776,12 +846,12 @@ static rc_t dump_seq_prim_row_sam( const sam_dump_ctx * sam_ctx,
                     rc = read_char_ptr( row_id, stx -> cursor, stx -> spot_group_idx,
                                         &spot_group, &spot_group_len, "SPOT_GROUP" );
                     if ( rc == 0 && spot_group_len > 0 ) {
-                        rc = KOutMsg( "%ld.%.*s\t", row_id, spot_group_len, spot_group );
+                        rc = print_qname( opts, "%ld.%.*s", row_id, spot_group_len, spot_group );
                         print_just_seq_spot_id = false;
                     }
                 }
                 if ( print_just_seq_spot_id ) {
-                    rc = KOutMsg( "%ld\t", row_id );
+                    rc = print_qname( opts, "%ld", row_id );
                 }
             }
 
@@ -800,21 +870,19 @@ static rc_t dump_seq_prim_row_sam( const sam_dump_ctx * sam_ctx,
                         sam_flags = 0x04;
                     }
                 }
-                rc = KOutMsg( "%u\t", sam_flags );
+                /* SAM-FIELD: RNAME     SRA-column: none, fix '*' */
+                /* SAM-FIELD: POS       SRA-column: none, fix '0' */
+                /* SAM-FIELD: MAPQ      SRA-column: none, fix '0' */
+                /* SAM-FIELD: CIGAR     SRA-column: none, fix '*' */
+                rc = print_unplaced( opts, sam_flags );
             }
 
-            /* SAM-FIELD: RNAME     SRA-column: none, fix '*' */
-            /* SAM-FIELD: POS       SRA-column: none, fix '0' */
-            /* SAM-FIELD: MAPQ      SRA-column: none, fix '0' */
-            /* SAM-FIELD: CIGAR     SRA-column: none, fix '*' */
-            if ( rc == 0 )
-                rc = KOutMsg( "*\t0\t0\t*\t" );
-
             /* SAM-FIELD: RNEXT     SRA-column: look up in cache, or none */
             /* SAM-FIELD: POS       SRA-column: look up in cache, or none */
+            /* SAM-FIELD: TLEN      SRA-column: none, fix '0' */
             if ( rc == 0 ) {
                 if ( ptx == NULL || !mate_available ) {
-                    rc = KOutMsg( "*\t0\t" );   /* no way to get that without PRIM_ALIGN-table */
+                    rc = print_mate( opts, "*", 1, 0 );   /* no way to get that without PRIM_ALIGN-table */
                 } else {
                     if ( opts -> use_mate_cache && sam_ctx -> mc != NULL && ids != NULL ) {
                         const char * mate_ref_name;
@@ -824,19 +892,14 @@ static rc_t dump_seq_prim_row_sam( const sam_dump_ctx * sam_ctx,
                         rc = get_mate_info( ptx, sam_ctx -> mc, ids, row_id, mate_id, nreads,
                                             &mate_ref_name, &mate_ref_name_len, &mate_ref_pos );
                         if ( rc == 0 ) {
-                            rc = KOutMsg( "%.*s\t%li\t", mate_ref_name_len, mate_ref_name, mate_ref_pos );
+                            rc = print_mate( opts, mate_ref_name, mate_ref_name_len, mate_ref_pos );
                         }
                     } else {
                         /* print the mate info */
-                        rc = dump_the_other_read( stx, ptx, row_id, mate_idx );
+                        rc = dump_the_other_read( opts, stx, ptx, row_id, mate_idx );
                     }
                 }
             }
-
-            /* SAM-FIELD: TLEN      SRA-column: none, fix '0' */
-            if ( rc == 0 ) {
-                rc = KOutMsg( "0\t" );
-            }
             if ( rc == 0 && read == NULL ) {
                 rc = read_INSDC_dna_text_ptr( row_id, stx -> cursor, stx -> read_idx, &read, &rd_len, "READ" );
             }
@@ -845,9 +908,9 @@ static rc_t dump_seq_prim_row_sam( const sam_dump_ctx * sam_ctx,
             }
             /* SAM-FIELD: SEQ       SRA-column: READ, sliced by READ_START/READ_LEN */
             if ( rc == 0 ) {
-                rc = print_sliced_read( read, read_idx, reverse, read_start, read_len );
+                rc = print_sliced_read( opts, read, read_idx, reverse, read_start, read_len );
             }
-            if ( rc == 0 ) {
+            if ( rc == 0 && opts -> rec == NULL ) {
                 rc = KOutMsg( "\t" );
             }
             if ( rc == 0 && quality == NULL && ( !( opts -> no_qual ) ) ) {
@@ -859,18 +922,22 @@ static rc_t dump_seq_prim_row_sam( const sam_dump_ctx * sam_ctx,
             }
             /* OPT SAM-FIIELD:      SRA-column: ALIGN_ID */
             if ( rc == 0 && opts -> print_alignment_id_in_column_xi ) {
-                rc = KOutMsg( "\tXI:i:%u", row_id );
+                if ( opts -> rec != NULL ) {
+                    rc = bam_rec_tag_i( opts -> rec, "XI", ( uint32_t )row_id ); /* bam_out.c */
+                } else {
+                    rc = KOutMsg( "\tXI:i:%u", row_id );
+                }
             }
             /* OPT SAM-FIIELD:      SRA-column: SPOT_GROUP */
             if ( rc == 0 && stx -> spot_group_idx != COL_NOT_AVAILABLE ) {
-                rc = opt_field_spot_group( stx, row_id );
+                rc = opt_field_spot_group( opts, stx, row_id );
             }
             /* OPT SAM-FIELD:       SRA-column: LINKAGE_GROUP */
             if ( rc == 0 && stx->lnk_group_idx != COL_NOT_AVAILABLE ) {
-                rc = opt_field_lnk_group( stx, row_id );
+                rc = opt_field_lnk_group( opts, stx, row_id );
             }
             if ( rc == 0 ) {
-                rc = KOutMsg( "\n" );
+                rc = print_end_of_record( opts );
             }
         }
     }
@@ -935,9 +1002,9 @@ static rc_t dump_seq_row_sam( const sam_dump_ctx * sam_ctx,
                                         &spot_group, &spot_group_len, "SPOT_GROUP" );
                     if ( rc == 0 && spot_group_len > 0 ) {
                         if ( name != NULL && name_len > 0 ) {
-                            rc = KOutMsg( "%.*s.%.*s\t", name_len, name, spot_group_len, spot_group );
+                            rc = print_qname( opts, "%.*s.%.*s", name_len, name, spot_group_len, spot_group );
                         } else {
-                            rc = KOutMsg( "%ld.%.*s\t", row_id, spot_group_len, spot_group );
+                            rc = print_qname( opts, "%ld.%.*s", row_id, spot_group_len, spot_group );
                         }
                         print_just_seq_spot_id = false;
                     }
@@ -945,9 +1012,9 @@ static rc_t dump_seq_row_sam( const sam_dump_ctx * sam_ctx,
 
                 if ( print_just_seq_spot_id ) {
                     if ( name != NULL && name_len > 0 ) {
-                        rc = KOutMsg( "%.*s\t", name_len, name );
+                        rc = print_qname( opts, "%.*s", name_len, name );
                     } else {
-                        rc = KOutMsg( "%lu\t", row_id );
+                        rc = print_qname( opts, "%lu", row_id );
                     }
                 }
             }
@@ -956,7 +1023,7 @@ static rc_t dump_seq_row_sam( const sam_dump_ctx * sam_ctx,
             if ( rc == 0 ) {
                 uint32_t sam_flags = calculate_unaligned_sam_flags_db( nreads, read_idx, mate_idx,
                                             0, read_type, reverse, read_filter );
-                rc = KOutMsg( "%u\t", sam_flags );
+                rc = print_unplaced( opts, sam_flags );
             }
 
             /* SAM-FIELD: RNAME     SRA-column: none, fix '*' */
@@ -968,7 +1035,7 @@ static rc_t dump_seq_row_sam( const sam_dump_ctx * sam_ctx,
             /* SAM-FIELD: TLEN      SRA-column: none, fix '0' */
 
             if ( rc == 0 ) {
-                rc = KOutMsg( "*\t0\t0\t*\t*\t0\t0\t" );
+                rc = print_mate( opts, "*", 1, 0 );
             }
             if ( rc == 0 && read == NULL ) {
                 rc = read_INSDC_dna_text_ptr( row_id, stx -> cursor, stx -> read_idx,
@@ -979,9 +1046,9 @@ static rc_t dump_seq_row_sam( const sam_dump_ctx * sam_ctx,
             }
             /* SAM-FIELD: SEQ       SRA-column: READ, sliced by READ_START/READ_LEN */
             if ( rc == 0 ) {
-                rc = print_sliced_read( read, read_idx, reverse, read_start, read_len );
+                rc = print_sliced_read( opts, read, read_idx, reverse, read_start, read_len );
             }
-            if ( rc == 0 ) {
+            if ( rc == 0 && opts -> rec == NULL ) {
                 rc = KOutMsg( "\t" );
             }
             if ( rc == 0 && quality == NULL && ( !( opts -> no_qual ) ) ) {
@@ -993,18 +1060,22 @@ static rc_t dump_seq_row_sam( const sam_dump_ctx * sam_ctx,
             }
             /* OPT SAM-FIIELD:      SRA-column: ALIGN_ID */
             if ( rc == 0 && opts -> print_alignment_id_in_column_xi ) {
-                rc = KOutMsg( "\tXI:i:%u", row_id );
+                if ( opts -> rec != NULL ) {
+                    rc = bam_rec_tag_i( opts -> rec, "XI", ( uint32_t )row_id ); /* bam_out.c */
+                } else {
+                    rc = KOutMsg( "\tXI:i:%u", row_id );
+                }
             }
             /* OPT SAM-FIIELD:      SRA-column: SPOT_GROUP */
             if ( rc == 0 && stx -> spot_group_idx != COL_NOT_AVAILABLE ) {
-                rc = opt_field_spot_group( stx, row_id );
+                rc = opt_field_spot_group( opts, stx, row_id );
             }
             /* OPT SAM-FIELD:       SRA-column: LINKAGE_GROUP */
             if ( rc == 0 && stx -> lnk_group_idx != COL_NOT_AVAILABLE ) {
-                rc = opt_field_lnk_group( stx, row_id );
+                rc = opt_field_lnk_group( opts, stx, row_id );
             }
             if ( rc == 0 ) {
-                rc = KOutMsg( "\n" );
+                rc = print_end_of_record( opts );
             }
         }
     }
@@ -1082,7 +1153,7 @@ static rc_t dump_seq_row_fastx_filtered( const sam_dump_ctx * sam_ctx,
                     }
                     /* the READ */
                     if ( rc == 0 ) {
-                        rc = print_sliced_read( read, read_idx, /* reverse */ false, read_start, read_len );
+                        rc = print_sliced_read( opts, read, read_idx, /* reverse */ false, read_start, read_len );
                     }
                     if ( rc == 0 ) {
                         rc = KOutMsg( "\n" );
@@ -1165,7 +1236,7 @@ static rc_t dump_seq_row_fastx( const sam_dump_ctx * sam_ctx,
             }
             /* the READ */
             if ( rc == 0 ) {
-                rc = print_sliced_read( read, read_idx, /*reverse*/ false, read_start, read_len );
+                rc = print_sliced_read( opts, read, read_idx, /*reverse*/ false, read_start, read_len );
             }
             if ( rc == 0 ) {
                 rc = KOutMsg( "\n" );
@@ -1239,7 +1310,7 @@ static rc_t dump_seq_tab_row_fastx( const sam_dump_ctx * sam_ctx,
             }
             /* the READ */
             if ( rc == 0 ) {
-                rc = print_sliced_read( read, read_idx, /* reverse */ false, read_start, read_len );
+                rc = print_sliced_read( opts, read, read_idx, /* reverse */ false, read_start, read_len );
             }
             if ( rc == 0 ) {
                 rc = KOutMsg( "\n" );
@@ -72,6 +72,10 @@
 #include "pileup_v2.h"
 #endif
 
+#ifndef _h_pileup_threads_
+#include "pileup_threads.h"
+#endif
+
 #ifndef _h_kapp_main_
 #include <kapp/main.h>
 #endif
@@ -112,6 +116,10 @@
 #include <align/manager.h>
 #endif
 
+#ifndef _h_kproc_lock_
+#include <kproc/lock.h>
+#endif
+
 #include <stdio.h>  /* because of fwrite() */
 
 #define COL_QUALITY "QUALITY"
@@ -144,6 +152,11 @@
 
 #define OPTION_NGC "ngc"
 
+#define OPTION_THREADS "threads"
+
+/* the references are cut into slices of this length for --threads */
+#define PILEUP_SLICE_LEN ( 4 * 1024 * 1024 )
+
 #define OPTION_FUNC    "function"
 #define ALIAS_FUNC     NULL
 
@@ -216,6 +229,10 @@ static const char * func_usage[]            = { "alternative functionality", NUL
 
 static const char * ngc_usage[] = { "path to ngc file", NULL };
 
+static const char * threads_usage[]         = { "number of threads walking slices of the references, ",
+                                                "used for the default output and the functions ",
+                                                "count and mismatch (default=1)", NULL };
+
 OptDef MyOptions[] =
 {
     /*name,           	alias,         	hfkt,	usage-help,		maxcount, needs value, required */
@@ -230,6 +247,7 @@ OptDef MyOptions[] =
     { OPTION_MERGE,		NULL,			NULL,	merge_usage,	1,        true,        false },
     { OPTION_FUNC,		ALIAS_FUNC,		NULL,	func_usage,		1,        true,        false },
     { OPTION_NGC,       NULL,           NULL,   ngc_usage, 1, true, false },
+    { OPTION_THREADS,   NULL,           NULL,   threads_usage,  1,        true,        false },
 };
 
 /* =========================================================================================== */
@@ -308,6 +326,9 @@ static rc_t get_pileup_options( Args * args, pileup_options *opts )
     if ( rc == 0 ) {
         rc = get_uint32_option( args, OPTION_MERGE, &opts->merge_dist, 10000 );
     }
+    if ( rc == 0 ) {
+        rc = get_uint32_option( args, OPTION_THREADS, &opts->threads, 1 );
+    }
     if ( rc == 0 ) {
         rc = get_bool_option( args, OPTION_DUPS, &opts->process_dups, false );
     }
@@ -408,6 +429,7 @@ rc_t CC Usage ( const Args * args ) {
     HelpOptionLine ( ALIAS_SEQNAME, OPTION_SEQNAME, NULL, seqname_usage );
     HelpOptionLine ( NULL, OPTION_MIN_M, NULL, min_m_usage );
     HelpOptionLine ( NULL, OPTION_MERGE, NULL, merge_usage );
+    HelpOptionLine ( NULL, OPTION_THREADS, "count", threads_usage );
 
     HelpOptionLine ( NULL, "function ref",      NULL, func_ref_usage );
     HelpOptionLine ( NULL, "function ref-ex",   NULL, func_ref_ex_usage );
@@ -814,9 +836,9 @@ static rc_t walk_position( ReferenceIterator *ref_iter,
                             if ( depth > 0 ) {
                                 rc = walk_spot_groups( ref_iter, line, events, qualities, options );
                             }
-                            /* only one KOutMsg() per line... */
+                            /* only one output-call per line... */
                             if ( rc == 0 ) {
-                                rc = KOutMsg( "%s\n", ds_get_char( line, 0 ) );
+                                rc = pt_out( options -> out, "%s\n", ds_get_char( line, 0 ) ); /* pileup_threads.c */
                             }
                             if ( GetRCState( rc ) == rcDone ) { rc = 0; }
                         }
@@ -1047,6 +1069,21 @@ static bool row_not_found_while_reading_column( rc_t rc ) {
              rcNotFound == GetRCState( rc ) );
 }
 
+/* the 1-based, inclusive bounds of a section on a reference of the given length */
+static void section_bounds( INSDC_coord_len len, const struct reference_range * range,
+                            uint32_t * start, uint32_t * end ) {
+    if ( range == NULL ) {
+        *start = 1;
+        *end = ( len - *start ) + 1;
+    } else {
+        *start = get_ref_range_start( range );
+        *end   = get_ref_range_end( range );
+    }
+
+    if ( *start == 0 ) { *start = 1; }
+    if ( ( *end == 0 )||( *end > len + 1 ) ) { *end = ( len - *start ) + 1; }
+}
+
 static rc_t CC prepare_section_cb( prepare_ctx * ctx, const struct reference_range * range ) {
     rc_t rc = 0;
     INSDC_coord_len len;
@@ -1064,16 +1101,7 @@ static rc_t CC prepare_section_cb( prepare_ctx * ctx, const struct reference_ran
             uint32_t start, end;
             rc_t rc1 = 0, rc2 = 0, rc3 = 0;
 
-            if ( range == NULL ) {
-                start = 1;
-                end = ( len - start ) + 1;
-            } else {
-                start = get_ref_range_start( range );
-                end   = get_ref_range_end( range );
-            }
-
-            if ( start == 0 ) { start = 1; }
-            if ( ( end == 0 )||( end > len + 1 ) ) { end = ( len - start ) + 1; }
+            section_bounds( len, range, &start, &end );
             
             /* depending on ctx->select prepare primary, secondary or both... */
             if ( ctx->use_primary_alignments ) {
@@ -1193,14 +1221,13 @@ typedef struct foreach_arg_ctx {
     ReferenceIterator *ref_iter;
     BSTree *ranges;
     Vector *cursor_ids;
+    struct slice_plan *plan;    /* only used by plan_on_argument() */
 } foreach_arg_ctx;
 
 
-/* called for each source-file/accession */
-static rc_t CC on_argument( const char * path, const char * spot_group, void * data ) {
+/* the source has to be a csra-database */
+static rc_t check_source( foreach_arg_ctx * ctx, const char * path ) {
     rc_t rc = 0;
-    foreach_arg_ctx * ctx = ( foreach_arg_ctx * )data;
-
     int path_type = ( VDBManagerPathType ( ctx -> vdb_mgr, "%s", path ) & ~ kptAlias );
     ReportResetObject ( path );
     if ( path_type != kptDatabase ) {
@@ -1218,38 +1245,50 @@ static rc_t CC on_argument( const char * path, const char * spot_group, void * d
             if ( !is_csra ) {
                 rc = RC ( rcApp, rcNoTarg, rcOpening, rcItem, rcUnsupported );
                 PLOGERR( klogErr, ( klogErr, rc, "failed to open '$(path)', it is not a csra-database", "path=%s", path ) );
-            } else {
-                prepare_ctx prep;   /* from cmdline_cmn.h */
-
-                prep . omit_qualities = ctx -> options -> cmn . omit_qualities;
-                prep . read_tlen = ctx -> options -> read_tlen;
-                prep . use_primary_alignments = ( ( ctx -> options -> cmn . tab_select & primary_ats ) == primary_ats );
-                prep . use_secondary_alignments = ( ( ctx -> options -> cmn . tab_select & secondary_ats ) == secondary_ats );
-                prep . use_evidence_alignments = ( ( ctx -> options -> cmn . tab_select & evidence_ats ) == evidence_ats );
-                prep . ref_iter = ctx -> ref_iter;
-                prep . spot_group = spot_group;
-                prep . on_section = prepare_section_cb;
-                prep . data = ctx -> cursor_ids;
-                prep . path = path;
-                prep . db = NULL;
-                prep . prim_cur = NULL;
-                prep . sec_cur = NULL;
-                prep . ev_cur = NULL;
-                
-                rc = prepare_ref_iter( &prep, ctx -> vdb_mgr, ctx -> vdb_schema, path, ctx -> ranges ); /* cmdline_cmn.c */
-                if ( rc == 0 && prep . db == NULL ) {
-                    rc = RC ( rcApp, rcNoTarg, rcOpening, rcSelf, rcInvalid );
-                    LOGERR( klogInt, rc, "unsupported source" );
-                }
-                if ( prep . prim_cur != NULL ) { VCursorRelease( prep.prim_cur ); }
-                if ( prep . sec_cur != NULL ) { VCursorRelease( prep.sec_cur ); }
-                if ( prep . ev_cur != NULL ) { VCursorRelease( prep.ev_cur ); }
             }
         }
     }
     return rc;
 }
 
+static void init_prepare_ctx( prepare_ctx * prep, foreach_arg_ctx * ctx,
+                              const char * path, const char * spot_group ) {
+    prep -> omit_qualities = ctx -> options -> cmn . omit_qualities;
+    prep -> read_tlen = ctx -> options -> read_tlen;
+    prep -> use_primary_alignments = ( ( ctx -> options -> cmn . tab_select & primary_ats ) == primary_ats );
+    prep -> use_secondary_alignments = ( ( ctx -> options -> cmn . tab_select & secondary_ats ) == secondary_ats );
+    prep -> use_evidence_alignments = ( ( ctx -> options -> cmn . tab_select & evidence_ats ) == evidence_ats );
+    prep -> ref_iter = ctx -> ref_iter;
+    prep -> spot_group = spot_group;
+    prep -> on_section = prepare_section_cb;
+    prep -> data = ctx -> cursor_ids;
+    prep -> path = path;
+    prep -> db = NULL;
+    prep -> prim_cur = NULL;
+    prep -> sec_cur = NULL;
+    prep -> ev_cur = NULL;
+}
+
+/* called for each source-file/accession */
+static rc_t CC on_argument( const char * path, const char * spot_group, void * data ) {
+    foreach_arg_ctx * ctx = ( foreach_arg_ctx * )data;
+    rc_t rc = check_source( ctx, path );
+    if ( rc == 0 ) {
+        prepare_ctx prep;   /* from cmdline_cmn.h */
+
+        init_prepare_ctx( &prep, ctx, path, spot_group );
+        rc = prepare_ref_iter( &prep, ctx -> vdb_mgr, ctx -> vdb_schema, path, ctx -> ranges ); /* cmdline_cmn.c */
+        if ( rc == 0 && prep . db == NULL ) {
+            rc = RC ( rcApp, rcNoTarg, rcOpening, rcSelf, rcInvalid );
+            LOGERR( klogInt, rc, "unsupported source" );
+        }
+        if ( prep . prim_cur != NULL ) { VCursorRelease( prep.prim_cur ); }
+        if ( prep . sec_cur != NULL ) { VCursorRelease( prep.sec_cur ); }
+        if ( prep . ev_cur != NULL ) { VCursorRelease( prep.ev_cur ); }
+    }
+    return rc;
+}
+
 
 /* free all cursor-ids-blocks created in parallel with the alignment-cursor */
 static void CC cur_id_vector_entry_whack( void *item, void *data ) {
@@ -1257,6 +1296,302 @@ static void CC cur_id_vector_entry_whack( void *item, void *data ) {
     free( ids );
 }
 
+/* =========================================================================================== */
+
+/*
+    multi-threaded pileup ( --threads N ):
+    * the requested regions ( or the whole references ) are cut into slices of PILEUP_SLICE_LEN
+    * every slice is loaded into its own reference-iterator, with its own cursors,
+      alignments overlapping the slice-boundaries are loaded for both slices
+    * every position is reported by exactly one slice, the alignment-ends ( ^ and $ )
+      come from the alignment, not from the slice ---> the output is the same as single-threaded
+    * the worker-threads walk the slices, the main-thread writes the output in slice-order
+      ( pileup_threads.c )
+    * opening the sources and placing the alignments is done under a lock, walking is not
+*/
+
+typedef struct pileup_slice {
+    BSTNode node;
+    const char * name;      /* seq-id of the reference */
+    uint64_t start;         /* 1-based, inclusive */
+    uint64_t end;
+} pileup_slice;
+
+typedef struct slice_plan {
+    BSTree known;           /* the slices by name and start, to not add them twice */
+    Vector slices;          /* the slices in reference-order */
+} slice_plan;
+
+static int64_t CC slice_vs_slice( const BSTNode *item, const BSTNode *n ) {
+    const pileup_slice * a = ( const pileup_slice * )item;
+    const pileup_slice * b = ( const pileup_slice * )n;
+    int64_t res = cmp_pchar( a -> name, b -> name );
+    if ( res == 0 ) {
+        res = ( a -> start < b -> start ) ? -1 : ( a -> start > b -> start ) ? 1 : 0;
+    }
+    return res;
+}
+
+static void CC slice_whack( BSTNode *n, void *data ) {
+    pileup_slice * slice = ( pileup_slice * )n;
+    free( ( void * )slice -> name );
+    free( slice );
+}
+
+static void init_slice_plan( slice_plan * plan ) {
+    BSTreeInit( &( plan -> known ) );
+    VectorInit( &( plan -> slices ), 0, 512 );
+}
+
+static void free_slice_plan( slice_plan * plan ) {
+    /* the vector does not own the slices, the tree does */
+    VectorWhack( &( plan -> slices ), NULL, NULL );
+    BSTreeWhack( &( plan -> known ), slice_whack, NULL );
+}
+
+static rc_t add_slice( slice_plan * plan, const char * name, uint64_t start, uint64_t end ) {
+    rc_t rc = 0;
+    pileup_slice * slice = malloc( sizeof * slice );
+    if ( slice == NULL ) {
+        rc = RC( rcApp, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    } else {
+        slice -> name = string_dup_measure( name, NULL );
+        slice -> start = start;
+        slice -> end = end;
+        if ( slice -> name == NULL ) {
+            free( slice );
+            rc = RC( rcApp, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+        } else {
+            BSTNode * existing;
+            rc = BSTreeInsertUnique( &( plan -> known ), &( slice -> node ), &existing, slice_vs_slice );
+            if ( rc != 0 ) {
+                /* the slice is already known from a previous source */
+                slice_whack( &( slice -> node ), NULL );
+                rc = 0;
+            } else {
+                rc = VectorAppend( &( plan -> slices ), NULL, slice );
+            }
+        }
+    }
+    return rc;
+}
+
+/* called like prepare_section_cb(), but cuts the section into slices instead of loading it */
+static rc_t CC plan_section_cb( prepare_ctx * ctx, const struct reference_range * range ) {
+    rc_t rc = 0;
+    if ( ctx -> db != NULL && ctx -> refobj != NULL ) {
+        INSDC_coord_len len;
+        rc = ReferenceObj_SeqLength( ctx -> refobj, &len );
+        if ( rc != 0 ) {
+            LOGERR( klogInt, rc, "ReferenceObj_SeqLength() failed" );
+        } else {
+            const char * seq_id = NULL;
+            rc = ReferenceObj_SeqId( ctx -> refobj, &seq_id );
+            if ( rc != 0 ) {
+                LOGERR( klogInt, rc, "ReferenceObj_SeqId() failed" );
+            } else {
+                uint32_t start, end;
+                uint64_t pos;
+
+                section_bounds( len, range, &start, &end );
+                for ( pos = start; rc == 0 && pos <= end; pos += PILEUP_SLICE_LEN ) {
+                    uint64_t slice_end = pos + PILEUP_SLICE_LEN - 1;
+                    rc = add_slice( ctx -> data, seq_id, pos, slice_end < end ? slice_end : end );
+                }
+            }
+        }
+    }
+    return rc;
+}
+
+/* called for each source-file/accession, before the slices are walked */
+static rc_t CC plan_on_argument( const char * path, const char * spot_group, void * data ) {
+    foreach_arg_ctx * ctx = ( foreach_arg_ctx * )data;
+    rc_t rc = check_source( ctx, path );
+    if ( rc == 0 ) {
+        prepare_ctx prep;   /* from cmdline_cmn.h */
+
+        init_prepare_ctx( &prep, ctx, path, spot_group );
+        prep . on_section = plan_section_cb;
+        prep . data = ctx -> plan;
+        rc = prepare_ref_iter( &prep, ctx -> vdb_mgr, ctx -> vdb_schema, path, ctx -> ranges ); /* cmdline_cmn.c */
+    }
+    return rc;
+}
+
+typedef struct slice_worker {
+    pileup_options options;         /* a copy, with the output-sink of the worker */
+    pileup_callback_data cb_data;
+    foreach_arg_ctx arg_ctx;
+    Vector cur_ids_vector;
+    Args * args;
+    KDirectory * dir;
+    KLock * prepare_lock;           /* shared by all workers */
+    const Vector * slices;
+} slice_worker;
+
+/* load the slice into a new reference-iterator */
+static rc_t prepare_slice( slice_worker * w, BSTree * regions ) {
+    rc_t rc = KLockAcquire( w -> prepare_lock );
+    if ( rc != 0 ) {
+        LOGERR( klogInt, rc, "KLockAcquire() failed" );
+    } else {
+        PlacementRecordExtendFuncs cb_block;
+
+        cb_block.data = &( w -> cb_data );
+        cb_block.destroy = NULL;
+        cb_block.populate = populate_tooldata;
+        cb_block.alloc_size = alloc_size;
+        cb_block.fixed_size = 0;
+
+        rc = AlignMgrMakeReferenceIterator ( w -> cb_data . almgr, &( w -> arg_ctx . ref_iter ),
+                                             &cb_block, w -> options . minmapq );
+        if ( rc != 0 ) {
+            LOGERR( klogInt, rc, "AlignMgrMakeReferenceIterator() failed" );
+        } else {
+            w -> arg_ctx . ranges = regions;
+            rc = foreach_argument( w -> args, w -> dir, w -> options . div_by_spotgrp, NULL,
+                                   on_argument, &( w -> arg_ctx ) ); /* cmdline_cmn.c */
+        }
+        KLockUnlock( w -> prepare_lock );
+    }
+    return rc;
+}
+
+/* called by pt_run() in a worker-thread for each slice of this worker */
+static rc_t CC on_slice( uint32_t slice_idx, struct pt_sink * sink, void * data ) {
+    slice_worker * w = data;
+    const pileup_slice * slice = VectorGet( w -> slices, slice_idx );
+    BSTree regions;
+    rc_t rc;
+
+    BSTreeInit( &regions );
+    w -> arg_ctx . ref_iter = NULL;
+    rc = add_region( &regions, slice -> name, slice -> start, slice -> end ); /* ref_regions.c */
+    if ( rc == 0 ) {
+        rc = prepare_slice( w, &regions );
+    }
+    if ( rc == 0 ) {
+        ReferenceIterator * ref_iter = w -> arg_ctx . ref_iter;
+        w -> options . out = sink;
+        switch( w -> options . function )
+        {
+            case sra_pileup_counters    : rc = walk_counters( ref_iter, &( w -> options ) ); break;
+            case sra_pileup_mismatch    : rc = walk_mismatches( ref_iter, &( w -> options ) ); break;
+            default : rc = walk_ref_iter( ref_iter, &( w -> options ) ); break;
+        }
+        w -> options . out = NULL;
+    }
+
+    if ( w -> arg_ctx . ref_iter != NULL ) {
+        ReferenceIteratorRelease( w -> arg_ctx . ref_iter );
+        w -> arg_ctx . ref_iter = NULL;
+    }
+    free_ref_regions( &regions );
+    /* the cursor-ids are used by the placements, we can drop them after the walk */
+    VectorWhack ( &( w -> cur_ids_vector ), cur_id_vector_entry_whack, NULL );
+    VectorInit ( &( w -> cur_ids_vector ), 0, 20 );
+    return rc;
+}
+
+/* only these functions produce their output strictly position by position */
+static bool use_slices( const pileup_options * options ) {
+    bool res = false;
+    if ( options -> threads > 1 && !options -> cmn . no_mt ) {
+        switch( options -> function ) {
+            case sra_pileup_samtools    :
+            case sra_pileup_counters    :
+            case sra_pileup_mismatch    : res = true; break;
+        }
+    }
+    return res;
+}
+
+static rc_t walk_slices( Args * args, KDirectory * dir, const foreach_arg_ctx * arg_ctx,
+                         const pileup_callback_data * cb_data, const slice_plan * plan ) {
+    rc_t rc = 0;
+    uint32_t num_slices = VectorLength( &( plan -> slices ) );
+    uint32_t num_workers = arg_ctx -> options -> threads;
+    if ( num_workers > num_slices ) {
+        num_workers = num_slices;
+    }
+    if ( num_workers > 0 ) {
+        slice_worker * workers = calloc( num_workers, sizeof * workers );
+        void ** data = calloc( num_workers, sizeof * data );
+        KLock * prepare_lock = NULL;
+        if ( workers == NULL || data == NULL ) {
+            rc = RC( rcApp, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+        } else {
+            rc = KLockMake( &prepare_lock );
+            if ( rc != 0 ) {
+                LOGERR( klogInt, rc, "KLockMake() failed" );
+            }
+        }
+        if ( rc == 0 ) {
+            uint32_t i;
+            for ( i = 0; i < num_workers; ++i ) {
+                slice_worker * w = &( workers[ i ] );
+                w -> options = *( arg_ctx -> options );
+                w -> options . skiplist = NULL;
+                w -> options . out = NULL;
+                w -> cb_data . almgr = cb_data -> almgr;
+                w -> cb_data . options = &( w -> options );
+                w -> arg_ctx = *arg_ctx;
+                w -> arg_ctx . options = &( w -> options );
+                w -> arg_ctx . cursor_ids = &( w -> cur_ids_vector );
+                w -> arg_ctx . ref_iter = NULL;
+                w -> arg_ctx . plan = NULL;
+                VectorInit ( &( w -> cur_ids_vector ), 0, 20 );
+                w -> args = args;
+                w -> dir = dir;
+                w -> prepare_lock = prepare_lock;
+                w -> slices = &( plan -> slices );
+                data[ i ] = w;
+            }
+
+            rc = pt_run( num_workers, num_slices, on_slice, data ); /* pileup_threads.c */
+
+            for ( i = 0; i < num_workers; ++i ) {
+                VectorWhack ( &( workers[ i ] . cur_ids_vector ), cur_id_vector_entry_whack, NULL );
+            }
+        }
+        if ( prepare_lock != NULL ) { KLockRelease( prepare_lock ); }
+        free( data );
+        free( workers );
+    }
+    return rc;
+}
+
+/* (5) + (6) of pileup_main() for --threads */
+static rc_t pileup_slices( Args * args, KDirectory * dir, foreach_arg_ctx * arg_ctx,
+                           const pileup_callback_data * cb_data ) {
+    BSTree regions;
+    rc_t rc = init_ref_regions( &regions, args ); /* cmdline_cmn.c */
+    if ( rc == 0 ) {
+        slice_plan plan;
+        bool empty = false;
+
+        /* no merging of close regions: every slice only covers requested positions */
+        check_ref_regions( &regions, 0 );
+        init_slice_plan( &plan );
+
+        arg_ctx -> ranges = &regions;
+        arg_ctx -> plan = &plan;
+        rc = foreach_argument( args, dir, arg_ctx -> options -> div_by_spotgrp, &empty, plan_on_argument, arg_ctx ); /* cmdline_cmn.c */
+        arg_ctx -> plan = NULL;
+        if ( empty ) {
+            Usage ( args );
+            rc = RC ( rcApp, rcArgv, rcAccessing, rcSelf, rcInsufficient );
+        }
+        if ( rc == 0 ) {
+            rc = walk_slices( args, dir, arg_ctx, cb_data, &plan );
+        }
+        free_slice_plan( &plan );
+        free_ref_regions( &regions );
+    }
+    return rc;
+}
+
 static rc_t pileup_main( Args * args, pileup_options *options ) {
     foreach_arg_ctx arg_ctx;
     pileup_callback_data cb_data;
@@ -1274,6 +1609,7 @@ static rc_t pileup_main( Args * args, pileup_options *options ) {
     arg_ctx . options = options;
     arg_ctx . vdb_schema = NULL;
     arg_ctx . cursor_ids = &cur_ids_vector;
+    arg_ctx . plan = NULL;
 
     /* (2) make the reference-iterator */
     if ( rc == 0 ) {
@@ -1361,8 +1697,13 @@ static rc_t pileup_main( Args * args, pileup_options *options ) {
         }
     }
 
+    /* (5) + (6) for --threads: walk slices of the references in parallel */
+    if ( rc == 0 && use_slices( options ) ) {
+        rc = pileup_slices( args, dir, &arg_ctx, &cb_data );
+    }
+
     /* (5) loop through the given input-filenames and load the ref-iter with it's input */
-    if ( rc == 0 ) {
+    if ( rc == 0 && !use_slices( options ) ) {
         BSTree regions;
         rc = init_ref_regions( &regions, args ); /* cmdline_cmn.c */
         if ( rc == 0 ) {
@@ -1382,7 +1723,7 @@ static rc_t pileup_main( Args * args, pileup_options *options ) {
     }
 
     /* (6) walk the "loaded" ref-iterator ===> perform the pileup */
-    if ( rc == 0 ) {
+    if ( rc == 0 && !use_slices( options ) ) {
         /* ============================================== */
         switch( options -> function )
         {
@@ -1433,6 +1774,7 @@ rc_t CC KMain( int argc, char *argv [] )
                     enum out_redir_mode mode;
 
                     options . skiplist = NULL;
+                    options . out = NULL;
                     
                     if ( options . cmn . gzip_output ) {
                         mode = orm_gzip;
@@ -43,6 +43,8 @@
 #include <kfs/directory.h> /* KDirectory */
 #include <kfs/file.h> /* KFile */
 
+#include <kproc/thread.h> /* KThread */
+
 #include <klib/checksum.h>
 #include <klib/container.h>
 #include <klib/debug.h> /* DBGMSG */
@@ -92,6 +94,10 @@ static size_t MAX_NREADS = 2500;
 
 #define DEFAULT_CURSOR_CAPACITY (1024*1024*1024UL)
 
+#define ALN_RAW_READ "(INSDC:4na:bin)RAW_READ"
+
+#define MAX_THREADS 64
+
 /********** _XMLLogger_Encode : copied from kapp/log-xml.c (-lload) ***********/
 
 static
@@ -262,6 +268,7 @@ typedef struct {
     uint64_t cnt[5];
     EBasesType basesType;
 
+    const char    * nameSEQUENCE; /* column added to cursSEQUENCE */
     const VCursor * cursSEQUENCE;
     uint32_t        idxSEQUENCE;
     uint32_t        idxSEQ_READ_LEN;
@@ -323,6 +330,7 @@ typedef struct srastat_parms {
     bool xml; /* output format (txt or xml) */
 
     int64_t  start, stop;
+    uint32_t threads; /* for base composition */
 } srastat_parms;
 
 static
@@ -411,7 +419,7 @@ static rc_t BasesInit(Bases *self, const Ctx *ctx, const VTable *vtbl,
                 DISP_RC(rc, "Cannot VCursorOpen");
             }
             if (rc == 0) {
-                const char name [] = "(INSDC:4na:bin)RAW_READ";
+                const char name [] = ALN_RAW_READ;
                 rc = VCursorAddColumn(curs, &self->idxALIGNMENT, name);
                 DISP_RC2(rc, "Cannot VCursorAddColumn", name);
             }
@@ -515,6 +523,7 @@ static rc_t BasesInit(Bases *self, const Ctx *ctx, const VTable *vtbl,
             ? "(INSDC:x2cs:bin)CSREAD" :
               self->basesType == ebtREAD
                   ? "(INSDC:x2na:bin)READ" : "(INSDC:x2na:bin)CMP_READ";
+        self->nameSEQUENCE = name;
         rc = VTableCreateCachedCursorRead(vtbl, &self->cursSEQUENCE,
                                           DEFAULT_CURSOR_CAPACITY);
         DISP_RC(rc, "Cannot VTableCreateCachedCursorRead");
@@ -597,6 +606,74 @@ static rc_t BasesRelease(Bases *self) {
     return rc;
 }
 
+/* Base composition of a single read: adds its bases to self->cnt.
+   Codes are validated with one max-reduction over the read, which the compiler
+   vectorizes; the per-base scan only runs to report an invalid value.
+   Counting goes to four interleaved histograms, so runs of the same base
+   do not serialize on a single counter. */
+static rc_t BasesCountRead(Bases *self, const unsigned char *bases,
+    uint32_t len, bool alignment, int64_t spotid, int64_t offset)
+{
+    static const unsigned char x [16]
+        = { 4, 0, 1, 4, 2, 4, 4, 4, 3, 4, 4, 4, 4, 4, 4, 4, };
+    /*      0  1  2  3  4  5  6  7  8  9 10 11 12 13 14 15
+               A  C     G           T                    N  */
+
+    const unsigned char limit = alignment ? 15 : 4;
+    unsigned char max = 0;
+    uint32_t hist [ 4 ] [ 16 ];
+    uint32_t i = 0;
+    int b = 0;
+
+    assert(self && bases);
+
+    for (i = 0; i < len; ++i) {
+        if (bases[i] > max)
+            max = bases[i];
+    }
+
+    if (max > limit) {
+        rc_t rc = RC(rcExe, rcColumn, rcReading, rcData, rcInvalid);
+        for (i = 0; bases[i] <= limit; ++i)
+            ;
+        if (alignment) {
+            PLOGERR(klogInt, (klogErr, rc, "Invalid RAW_READ column "
+                "value '$(base)' while VCursorCellDataDirect"
+                "(spotid=$(spotid), index=$(i))",
+                "base=%d,spotid=%lu,i=%lu", bases[i], spotid, offset + i));
+        }
+        else {
+            const char * name = self->basesType == ebtCSREAD ? "CSREAD"
+                : self->basesType == ebtREAD ? "READ" : "RAW_READ";
+            PLOGERR(klogInt, (klogErr, rc,
+               "Invalid READ column value '$(base)' while VCursorCellDataDirect"
+               "($(name), spotid=$(spotid), index=$(i))",
+               "base=%d,name=%s,spotid=%lu,i=%lu",
+               bases[i], name, spotid, offset + i));
+        }
+        return rc;
+    }
+
+    memset(hist, 0, sizeof hist);
+    for (i = 0; i + 4 <= len; i += 4) {
+        ++hist[0][bases[i    ]];
+        ++hist[1][bases[i + 1]];
+        ++hist[2][bases[i + 2]];
+        ++hist[3][bases[i + 3]];
+    }
+    for (; i < len; ++i)
+        ++hist[0][bases[i]];
+
+    for (b = 0; b <= limit; ++b) {
+        uint64_t n = ( uint64_t ) hist[0][b] + hist[1][b]
+                                  + hist[2][b] + hist[3][b];
+        if (n > 0)
+            self->cnt[alignment ? x[b] : b] += n;
+    }
+
+    return 0;
+}
+
 static rc_t BasesAdd(Bases *self, int64_t spotid, bool alignment,
     uint32_t * dREAD_LEN, uint8_t * dREAD_TYPE)
 {
@@ -613,7 +690,6 @@ static rc_t BasesAdd(Bases *self, int64_t spotid, bool alignment,
     int nreads = 0;
 
     int read = 0;
-    uint32_t nxtRdStart = 0;
 
     assert(self);
 
@@ -710,62 +786,188 @@ static rc_t BasesAdd(Bases *self, int64_t spotid, bool alignment,
     row_bits /= 8;
     bases = base;
 
-    for (i = 0; i < row_bits; ++i) {
-        unsigned char base = bases[i];
-        if ( i == nxtRdStart) {
-            if ( read > nreads )
-                return RC(rcExe, rcNumeral, rcComparing, rcData, rcInvalid);
-            nxtRdStart += dREAD_LEN [ read ++ ];
-            assert ( read > 0 );
-            if ( ( (dREAD_TYPE[read-1] & SRA_READ_TYPE_BIOLOGICAL) == 0 )
-                    /* skip non-biological reads */
-                 ||
-                 ( dREAD_LEN [ read - 1 ] == 0 )
-                    /* skip empty reads */
-               )
-            {
-                if ( dREAD_LEN [ read - 1 ] > 0 )
-                    i += dREAD_LEN [ read - 1 ];
-                -- i; /* here i can become negative: it should be signed */
-                continue;                
-            }
-        }
-
-        if ( alignment ) {
-            const unsigned char x [16]
-                = { 4, 0, 1, 4, 2, 4, 4, 4, 3, 4, 4, 4, 4, 4, 4, 4, };
-            /*      0  1  2  3  4  5  6  7  8  9 10 11 12 13 14 15
-                       A  C     G           T                    N  */
-            if (base > 15) {
-                rc = RC(rcExe, rcColumn, rcReading, rcData, rcInvalid);
-                PLOGERR(klogInt, (klogErr, rc, "Invalid RAW_READ column "
-                    "value '$(base)' while VCursorCellDataDirect"
-                    "(spotid=$(spotid), index=$(i))",
-                    "base=%d,spotid=%lu,i=%lu", base, spotid, i));
+    for (i = 0; read < nreads && ( bitsz_t ) i < row_bits; ++read) {
+        uint32_t len = dREAD_LEN [ read ];
+        if ( len > row_bits - i )
+            len = ( uint32_t ) ( row_bits - i );
+        if ( ( dREAD_TYPE [ read ] & SRA_READ_TYPE_BIOLOGICAL ) != 0
+            /* skip non-biological reads */
+             && len > 0 )
+            /* skip empty reads */
+        {
+            rc = BasesCountRead(self, bases + i, len, alignment, spotid, i);
+            if (rc != 0) {
                 BasesRelease(self);
                 return rc;
             }
-            assert ( base < sizeof x / sizeof x [ 0 ] );
-            base = x [  base ];
         }
+        i += len;
+    }
 
-        if (base > 4) {
-            const char * name = self->basesType == ebtCSREAD ? "CSREAD"
-                : self->basesType == ebtREAD ? "READ" : "RAW_READ";
-            rc = RC(rcExe, rcColumn, rcReading, rcData, rcInvalid);
-            PLOGERR(klogInt, (klogErr, rc,
-               "Invalid READ column value '$(base)' while VCursorCellDataDirect"
-               "($(name), spotid=$(spotid), index=$(i))",
-               "base=%d,name=%s,spotid=%lu,i=%lu",
-               base, name, spotid, i));
-            BasesRelease(self);
-            return rc;
+    if ( ( bitsz_t ) i < row_bits )
+        return RC(rcExe, rcNumeral, rcComparing, rcData, rcInvalid);
+
+    return 0;
+}
+
+/* Base composition pass split by row ranges between threads.
+   Every worker has its own cursors and counters;
+   counters are added to self when all the workers are done. */
+typedef struct BasesWorker {
+    Bases      bases;
+    uint32_t * dREAD_LEN;
+    uint8_t  * dREAD_TYPE;
+    KThread  * thread;
+} BasesWorker;
+
+static rc_t BasesOpenCursor(const VCursor *proto, const char *name,
+    size_t capacity, const VCursor **curs,
+    uint32_t *idx, uint32_t *idxREAD_LEN, uint32_t *idxREAD_TYPE)
+{
+    const VTable *tbl = NULL;
+    rc_t rc = VCursorOpenParentRead(proto, &tbl);
+    DISP_RC(rc, "Cannot VCursorOpenParentRead");
+
+    assert(curs && name);
+
+    if (rc == 0) {
+        rc = VTableCreateCachedCursorRead(tbl, curs, capacity);
+        DISP_RC(rc, "Cannot VTableCreateCachedCursorRead");
+    }
+    if (rc == 0) {
+        rc = VCursorAddColumn(*curs, idx, "%s", name);
+        DISP_RC2(rc, name, "while calling VCursorAddColumn");
+    }
+    if (rc == 0) {
+        rc = VCursorAddColumn(*curs, idxREAD_LEN, "READ_LEN");
+        DISP_RC2(rc, "READ_LEN", "while calling VCursorAddColumn");
+    }
+    if (rc == 0) {
+        rc = VCursorAddColumn(*curs, idxREAD_TYPE, "READ_TYPE");
+        DISP_RC2(rc, "READ_TYPE", "while calling VCursorAddColumn");
+    }
+    if (rc == 0) {
+        rc = VCursorOpen(*curs);
+        DISP_RC2(rc, name, "while calling VCursorOpen");
+    }
+
+    RELEASE(VTable, tbl);
+
+    return rc;
+}
+
+static rc_t CC BasesWorkerRun(const KThread *self, void *data) {
+    BasesWorker *w = data;
+    rc_t rc = 0;
+    int64_t spotid = 0;
+
+    assert(w);
+
+    for (spotid = w->bases.startALIGNMENT;
+         spotid < ( int64_t ) w->bases.stopALIGNMENT && rc == 0; ++spotid)
+    {
+        rc = BasesAdd(&w->bases, spotid, true, w->dREAD_LEN, w->dREAD_TYPE);
+        if (rc == 0)
+            rc = Quitting();
+    }
+
+    for (spotid = w->bases.startSEQUENCE;
+         spotid < ( int64_t ) w->bases.stopSEQUENCE && rc == 0; ++spotid)
+    {
+        rc = BasesAdd(&w->bases, spotid, false, w->dREAD_LEN, w->dREAD_TYPE);
+        if (rc == 0)
+            rc = Quitting();
+    }
+
+    return rc;
+}
+
+static rc_t BasesAddParallel(Bases *self, uint32_t threads,
+    const KLoadProgressbar *pr)
+{
+    rc_t rc = 0;
+    uint32_t i = 0;
+    uint32_t started = 0;
+    BasesWorker *w = NULL;
+
+    uint64_t nALIGNMENT = 0;
+    uint64_t nSEQUENCE = 0;
+
+    assert(self && threads > 0);
+
+    if (self->cursSEQUENCE == NULL)
+        return 0;
+
+    if (self->cursALIGNMENT != NULL)
+        nALIGNMENT = self->stopALIGNMENT - self->startALIGNMENT;
+    nSEQUENCE = self->stopSEQUENCE - self->startSEQUENCE;
+
+    w = calloc(threads, sizeof *w);
+    if (w == NULL)
+        return RC(rcExe, rcStorage, rcAllocating, rcMemory, rcExhausted);
+
+    for (i = 0; i < threads && rc == 0; ++i) {
+        Bases *b = &w[i].bases;
+
+        b->basesType = self->basesType;
+        b->startSEQUENCE = self->startSEQUENCE + nSEQUENCE * i / threads;
+        b->stopSEQUENCE
+            = self->startSEQUENCE + nSEQUENCE * (i + 1) / threads;
+        if (nALIGNMENT > 0) {
+            b->startALIGNMENT
+                = self->startALIGNMENT + nALIGNMENT * i / threads;
+            b->stopALIGNMENT
+                = self->startALIGNMENT + nALIGNMENT * (i + 1) / threads;
         }
 
-        ++self->cnt[base];
+        w[i].dREAD_LEN  = calloc(MAX_NREADS, sizeof *w[i].dREAD_LEN);
+        w[i].dREAD_TYPE = calloc(MAX_NREADS, sizeof *w[i].dREAD_TYPE);
+        if (w[i].dREAD_LEN == NULL || w[i].dREAD_TYPE == NULL)
+            rc = RC(rcExe, rcStorage, rcAllocating, rcMemory, rcExhausted);
+
+        if (rc == 0)
+            rc = BasesOpenCursor(self->cursSEQUENCE, self->nameSEQUENCE,
+                DEFAULT_CURSOR_CAPACITY / threads, &b->cursSEQUENCE,
+                &b->idxSEQUENCE, &b->idxSEQ_READ_LEN, &b->idxSEQ_READ_TYPE);
+        if (rc == 0 && nALIGNMENT > 0)
+            rc = BasesOpenCursor(self->cursALIGNMENT, ALN_RAW_READ,
+                DEFAULT_CURSOR_CAPACITY / threads, &b->cursALIGNMENT,
+                &b->idxALIGNMENT, &b->idxALN_READ_LEN, &b->idxALN_READ_TYPE);
+
+        if (rc == 0) {
+            rc = KThreadMake(&w[i].thread, BasesWorkerRun, &w[i]);
+            DISP_RC(rc, "Cannot KThreadMake");
+        }
+        if (rc == 0)
+            ++started;
     }
 
-    return 0;
+    for (i = 0; i < started; ++i) {
+        rc_t status = 0;
+        rc_t r2 = KThreadWait(w[i].thread, &status);
+        if (r2 == 0)
+            r2 = status;
+        if (rc == 0)
+            rc = r2;
+        KThreadRelease(w[i].thread);
+    }
+
+    for (i = 0; i < threads; ++i) {
+        if (rc == 0) {
+            size_t b = 0;
+            for (b = 0; b < sizeof self->cnt / sizeof self->cnt[0]; ++b)
+                self->cnt[b] += w[i].bases.cnt[b];
+        }
+        BasesRelease(&w[i].bases);
+        free(w[i].dREAD_LEN);
+        free(w[i].dREAD_TYPE);
+    }
+    free(w);
+
+    if (rc == 0 && pr != NULL)
+        KLoadProgressbar_Process(pr, nALIGNMENT + nSEQUENCE, false);
+
+    return rc;
 }
 
 static rc_t BasesPrint(const Bases *self,
@@ -1160,6 +1362,102 @@ static int64_t CC srastats_cmp(const void *item, const BSTNode *n) {
     return strcmp(sg,ss->spot_group);
 }
 
+/* Flat open-addressing index SPOT_GROUP -> SraStats in front of the BSTree:
+   the tree owns the nodes and keeps them sorted for printing,
+   the index makes the per-spot lookup a hash probe instead of log(n) strcmp.
+   Spots of the same group usually come in runs, so the last hit is tried first.
+ */
+typedef struct SpotGroupIndex {
+    SraStats ** slot;
+    size_t capacity; /* power of 2 */
+    size_t count;
+    SraStats * last;
+} SpotGroupIndex;
+
+static uint64_t SpotGroupHash(const char *spot_group) {
+    uint64_t h = 14695981039346656037ULL; /* FNV-1a */
+    const unsigned char *c = (const unsigned char*)spot_group;
+    for (; *c != '\0'; ++c) {
+        h ^= *c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static void SpotGroupIndexPut(SpotGroupIndex *self, SraStats *ss) {
+    size_t i = 0;
+
+    assert(self && self->slot && ss);
+
+    i = SpotGroupHash(ss->spot_group) & (self->capacity - 1);
+    while (self->slot[i] != NULL)
+        i = (i + 1) & (self->capacity - 1);
+
+    self->slot[i] = ss;
+    ++self->count;
+}
+
+static rc_t SpotGroupIndexInsert(SpotGroupIndex *self, SraStats *ss) {
+    assert(self && ss);
+
+    if ((self->count + 1) * 2 > self->capacity) {
+        size_t i = 0;
+        SraStats ** old = self->slot;
+        size_t oldCapacity = self->capacity;
+        size_t capacity = oldCapacity == 0 ? 64 : oldCapacity * 2;
+
+        SraStats ** slot = calloc(capacity, sizeof *slot);
+        if (slot == NULL)
+            return RC(rcExe, rcStorage, rcAllocating, rcMemory, rcExhausted);
+
+        self->slot = slot;
+        self->capacity = capacity;
+        self->count = 0;
+        for (i = 0; i < oldCapacity; ++i) {
+            if (old[i] != NULL)
+                SpotGroupIndexPut(self, old[i]);
+        }
+        free(old);
+    }
+
+    SpotGroupIndexPut(self, ss);
+    self->last = ss;
+
+    return 0;
+}
+
+static SraStats * SpotGroupIndexFind(SpotGroupIndex *self,
+    const char *spot_group)
+{
+    size_t i = 0;
+
+    assert(self && spot_group);
+
+    if (self->last != NULL && strcmp(self->last->spot_group, spot_group) == 0)
+        return self->last;
+
+    if (self->capacity == 0)
+        return NULL;
+
+    for (i = SpotGroupHash(spot_group) & (self->capacity - 1);
+         self->slot[i] != NULL; i = (i + 1) & (self->capacity - 1))
+    {
+        if (strcmp(self->slot[i]->spot_group, spot_group) == 0) {
+            self->last = self->slot[i];
+            return self->last;
+        }
+    }
+
+    return NULL;
+}
+
+static void SpotGroupIndexWhack(SpotGroupIndex *self) {
+    assert(self);
+
+    free(self->slot);
+    memset(self, 0, sizeof *self);
+}
+
 static
 rc_t CC tree_RG_callback(const BAM_HEADER_RG* rg, const void* data)
 {
@@ -3547,6 +3845,8 @@ static rc_t sra_stat(srastat_parms* pb, BSTree* tr,
 
     int g_nreads = 0;
     int64_t  n_spots = 0;
+
+    SpotGroupIndex sgIndex;
     int64_t start = 0;
     int64_t stop  = 0;
 
@@ -3568,6 +3868,8 @@ static rc_t sra_stat(srastat_parms* pb, BSTree* tr,
         DBGMSG ( DBG_APP, DBG_COND_1,
             ( "Allocated buffers for %zu READS\n", MAX_NREADS ) );
 
+    memset(&sgIndex, 0, sizeof sgIndex);
+
     rc = VTableCreateCachedCursorRead(vtbl, &curs, DEFAULT_CURSOR_CAPACITY);
     DISP_RC(rc, "Cannot VTableCreateCachedCursorRead");
 
@@ -4052,8 +4354,8 @@ static rc_t sra_stat(srastat_parms* pb, BSTree* tr,
                                     }
                                 }
 
-                                ss = (SraStats*)BSTreeFind
-                                    (tr, dSPOT_GROUP, srastats_cmp);
+                                ss = SpotGroupIndexFind
+                                    (&sgIndex, dSPOT_GROUP);
                                 if (ss == NULL) {
                                     ss = calloc(1, sizeof(*ss));
                                     if (ss == NULL) {
@@ -4065,6 +4367,10 @@ static rc_t sra_stat(srastat_parms* pb, BSTree* tr,
                                         strcpy(ss->spot_group, dSPOT_GROUP);
                                         BSTreeInsert
                                             (tr, (BSTNode*)ss, srastats_sort);
+                                        rc = SpotGroupIndexInsert
+                                            (&sgIndex, ss);
+                                        if (rc != 0)
+                                            break;
                                     }
                                 }
      /* eSG_SPOT_COUNT */       ++ss->spot_count;
@@ -4169,8 +4475,13 @@ static rc_t sra_stat(srastat_parms* pb, BSTree* tr,
                     } /* for (spotid = start; spotid <= stop && rc == 0;
                               ++spotid) */
 
+                    if (pb->threads > 1 && !pb->quick && rc == 0) {
+                        rc = BasesAddParallel(&total->bases_count,
+                            pb->threads, pb->progress ? pr : NULL);
+                    }
+
                     for (spotid = total->bases_count.startALIGNMENT;
-                         !pb->quick &&
+                         !pb->quick && pb->threads <= 1 &&
                            spotid < total->bases_count.stopALIGNMENT && rc == 0;
                          ++spotid)
                     {
@@ -4184,7 +4495,7 @@ static rc_t sra_stat(srastat_parms* pb, BSTree* tr,
                     }
 
                     for (spotid = total->bases_count.startSEQUENCE;
-                         !pb->quick &&
+                         !pb->quick && pb->threads <= 1 &&
                            spotid < total->bases_count.stopSEQUENCE && rc == 0;
                          ++spotid)
                     {
@@ -4300,6 +4611,8 @@ static rc_t sra_stat(srastat_parms* pb, BSTree* tr,
     free ( g_nonZeroLenReads );
     free ( g_dREAD_LEN );
 
+    SpotGroupIndexWhack(&sgIndex);
+
     return rc;
 }
 
@@ -4552,6 +4865,11 @@ static const char * stats_usage[] = {
 #define OPTION_STOP    "stop"
 static const char * stop_usage[] = { "Ending spot id, default is max.", NULL };
 
+#define ALIAS_THREADS  "j"
+#define OPTION_THREADS "threads"
+static const char * threads_usage[] = {
+   "Number of threads to count base composition, default is 1.", NULL };
+
 #define ALIAS_TEST     "t"
 #define OPTION_TEST    "test"
 static const char * test_usage[] = {
@@ -4576,6 +4894,7 @@ OptDef Options[] = {
     , { OPTION_STATS   , ALIAS_STATS   , NULL, stats_usage   , 1, false, false }
     , { OPTION_STOP    , ALIAS_STOP    , NULL, stop_usage    , 1, true,  false }
     , { OPTION_TEST    , ALIAS_TEST    , NULL, test_usage    , 1, false, false }
+    , { OPTION_THREADS , ALIAS_THREADS , NULL, threads_usage , 1, true,  false }
     , { OPTION_XML     , ALIAS_XML     , NULL, xml_usage     , 1, false, false }
 };
 
@@ -4619,6 +4938,7 @@ rc_t CC Usage (const Args * args)
     HelpOptionLine(ALIAS_STATS   , OPTION_STATS   , NULL      , stats_usage);
     HelpOptionLine(ALIAS_ALIGN   , OPTION_ALIGN   , "on | off", align_usage);
     HelpOptionLine(ALIAS_PROGRESS, OPTION_PROGRESS, NULL      , progress_usage);
+    HelpOptionLine(ALIAS_THREADS , OPTION_THREADS , "count"   , threads_usage);
     HelpOptionLine(ALIAS_NGC     , OPTION_NGC     , "path"    , ngc_usage);
     XMLLogger_Usage();
     HelpOptionLine(ALIAS_REPAIR  , OPTION_REPAIR  , NULL      , repair_usage);
@@ -4697,6 +5017,29 @@ rc_t CC KMain ( int argc, char *argv [] )
                 }
 
 
+                rc = ArgsOptionCount (args, OPTION_THREADS, &pcount);
+                if (rc != 0) {
+                    break;
+                }
+
+                pb.threads = 1;
+                if (pcount == 1) {
+                    rc = ArgsOptionValue (args, OPTION_THREADS, 0, (const void **)&pc);
+                    if (rc != 0) {
+                        break;
+                    }
+
+                    pb.threads = AsciiToU32 (pc, NULL, NULL);
+                    if (pb.threads == 0 || pb.threads > MAX_THREADS) {
+                        rc = RC(rcExe, rcArgv, rcParsing, rcParam, rcOutofrange);
+                        PLOGERR(klogErr, (klogErr, rc,
+                            "--$(opt) must be in 1..$(max)", "opt=%s,max=%d",
+                            OPTION_THREADS, MAX_THREADS));
+                        break;
+                    }
+                }
+
+
                 rc = ArgsOptionCount (args, OPTION_XML, &pcount);
                 if (rc != 0) {
                     break;
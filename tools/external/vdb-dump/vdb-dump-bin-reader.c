@@ -0,0 +1,265 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "vdb-dump-bin-reader.h"
+#include "vdb-dump-bin.h"
+
+#include <sysalloc.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+static rc_t vdbbr_short( void )
+{
+    return RC( rcVDB, rcFile, rcReading, rcData, rcInsufficient );
+}
+
+static rc_t vdbbr_get( vdbbr_reader * self, void * dst, size_t len )
+{
+    if ( self -> size - self -> pos < len )
+    {
+        return vdbbr_short();
+    }
+    memmove( dst, self -> data + self -> pos, len );
+    self -> pos += len;
+    return 0;
+}
+
+static rc_t vdbbr_skip( vdbbr_reader * self, size_t len, const uint8_t ** at )
+{
+    if ( self -> size - self -> pos < len )
+    {
+        return vdbbr_short();
+    }
+    *at = self -> data + self -> pos;
+    self -> pos += len;
+    return 0;
+}
+
+rc_t vdbbr_open( vdbbr_reader * self, const void * data, size_t size )
+{
+    rc_t rc;
+    char magic[ VDBB_MAGIC_LEN ];
+    uint32_t bom = 0;
+    uint32_t i;
+
+    if ( NULL == self || NULL == data )
+    {
+        return RC( rcVDB, rcFile, rcOpening, rcParam, rcNull );
+    }
+    memset( self, 0, sizeof * self );
+    self -> data = data;
+    self -> size = size;
+
+    rc = vdbbr_get( self, magic, VDBB_MAGIC_LEN );
+    if ( 0 == rc && 0 != memcmp( magic, VDBB_MAGIC, VDBB_MAGIC_LEN ) )
+    {
+        rc = RC( rcVDB, rcFile, rcOpening, rcFormat, rcIncorrect );
+    }
+    if ( 0 == rc ) { rc = vdbbr_get( self, &bom, sizeof bom ); }
+    if ( 0 == rc && VDBB_BOM != bom )
+    {
+        rc = RC( rcVDB, rcFile, rcOpening, rcByteOrder, rcIncorrect );
+    }
+    if ( 0 == rc ) { rc = vdbbr_get( self, &( self -> version ), sizeof self -> version ); }
+    if ( 0 == rc && self -> version > VDBB_VERSION )
+    {
+        rc = RC( rcVDB, rcFile, rcOpening, rcFormat, rcUnsupported );
+    }
+    if ( 0 == rc ) { rc = vdbbr_get( self, &( self -> num_cols ), sizeof self -> num_cols ); }
+    if ( 0 == rc && self -> num_cols > 0 )
+    {
+        self -> cols = calloc( self -> num_cols, sizeof self -> cols[ 0 ] );
+        if ( NULL == self -> cols )
+        {
+            rc = RC( rcVDB, rcFile, rcOpening, rcMemory, rcExhausted );
+        }
+    }
+    for ( i = 0; 0 == rc && i < self -> num_cols; ++i )
+    {
+        vdbbr_column * col = &( self -> cols[ i ] );
+        const uint8_t * name;
+        rc = vdbbr_get( self, &( col -> name_len ), sizeof col -> name_len );
+        if ( 0 == rc ) { rc = vdbbr_skip( self, col -> name_len, &name ); }
+        if ( 0 == rc ) { col -> name = ( const char * )name; }
+        if ( 0 == rc ) { rc = vdbbr_get( self, &( col -> domain ), sizeof col -> domain ); }
+        if ( 0 == rc ) { rc = vdbbr_get( self, &( col -> intrinsic_bits ), sizeof col -> intrinsic_bits ); }
+        if ( 0 == rc ) { rc = vdbbr_get( self, &( col -> intrinsic_dim ), sizeof col -> intrinsic_dim ); }
+    }
+    if ( 0 != rc )
+    {
+        vdbbr_close( self );
+    }
+    return rc;
+}
+
+void vdbbr_close( vdbbr_reader * self )
+{
+    if ( NULL != self )
+    {
+        free( ( void * )self -> cols );
+        memset( self, 0, sizeof * self );
+    }
+}
+
+rc_t vdbbr_next_group( vdbbr_reader * self, vdbbr_group * group, bool * done )
+{
+    rc_t rc;
+    char tag[ VDBB_TAG_LEN ];
+    uint32_t i;
+
+    if ( NULL == self || NULL == group || NULL == done )
+    {
+        return RC( rcVDB, rcFile, rcReading, rcParam, rcNull );
+    }
+    memset( group, 0, sizeof * group );
+    *done = false;
+
+    rc = vdbbr_get( self, tag, VDBB_TAG_LEN );
+    if ( 0 != rc )
+    {
+        /* a missing trailer means a truncated output */
+        return rc;
+    }
+    if ( 0 == memcmp( tag, VDBB_END_MAGIC, VDBB_TAG_LEN ) )
+    {
+        *done = true;
+        return 0;
+    }
+    if ( 0 != memcmp( tag, VDBB_GROUP_MAGIC, VDBB_TAG_LEN ) )
+    {
+        return RC( rcVDB, rcFile, rcReading, rcFormat, rcIncorrect );
+    }
+
+    rc = vdbbr_get( self, &( group -> row_count ), sizeof group -> row_count );
+    if ( 0 == rc )
+    {
+        rc = vdbbr_skip( self, ( size_t )group -> row_count * sizeof( int64_t ), &( group -> row_ids ) );
+    }
+    if ( 0 == rc && self -> num_cols > 0 )
+    {
+        group -> chunks = calloc( self -> num_cols, sizeof group -> chunks[ 0 ] );
+        if ( NULL == group -> chunks )
+        {
+            rc = RC( rcVDB, rcFile, rcReading, rcMemory, rcExhausted );
+        }
+    }
+    for ( i = 0; 0 == rc && i < self -> num_cols; ++i )
+    {
+        vdbbr_chunk * chunk = &( group -> chunks[ i ] );
+        uint64_t chunk_size;
+        size_t lens_size = ( size_t )group -> row_count * sizeof( uint32_t );
+        rc = vdbbr_get( self, &chunk_size, sizeof chunk_size );
+        if ( 0 == rc && chunk_size < lens_size )
+        {
+            rc = RC( rcVDB, rcFile, rcReading, rcData, rcCorrupt );
+        }
+        if ( 0 == rc ) { rc = vdbbr_skip( self, lens_size, &( chunk -> lens ) ); }
+        if ( 0 == rc )
+        {
+            chunk -> data_size = chunk_size - lens_size;
+            rc = vdbbr_skip( self, ( size_t )chunk -> data_size, &( chunk -> data ) );
+        }
+    }
+    if ( 0 != rc )
+    {
+        vdbbr_group_free( group );
+    }
+    return rc;
+}
+
+void vdbbr_group_free( vdbbr_group * group )
+{
+    if ( NULL != group )
+    {
+        free( ( void * )group -> chunks );
+        memset( group, 0, sizeof * group );
+    }
+}
+
+int64_t vdbbr_row_id( const vdbbr_group * group, uint32_t row )
+{
+    int64_t res = 0;
+    if ( NULL != group && row < group -> row_count )
+    {
+        memmove( &res, group -> row_ids + ( size_t )row * sizeof res, sizeof res );
+    }
+    return res;
+}
+
+uint32_t vdbbr_elem_count( const vdbbr_chunk * chunk, uint32_t row )
+{
+    uint32_t res = 0;
+    if ( NULL != chunk )
+    {
+        memmove( &res, chunk -> lens + ( size_t )row * sizeof res, sizeof res );
+    }
+    return res;
+}
+
+rc_t vdbbr_cell_iter_init( vdbbr_cell_iter * self, const vdbbr_reader * reader,
+                           const vdbbr_group * group, uint32_t col_nr )
+{
+    if ( NULL == self || NULL == reader || NULL == group )
+    {
+        return RC( rcVDB, rcNoTarg, rcConstructing, rcParam, rcNull );
+    }
+    if ( col_nr >= reader -> num_cols )
+    {
+        return RC( rcVDB, rcNoTarg, rcConstructing, rcId, rcOutofrange );
+    }
+    self -> chunk = &( group -> chunks[ col_nr ] );
+    self -> elem_bits = ( uint64_t )reader -> cols[ col_nr ] . intrinsic_bits *
+                        reader -> cols[ col_nr ] . intrinsic_dim;
+    self -> offset = 0;
+    self -> row = 0;
+    self -> row_count = group -> row_count;
+    return 0;
+}
+
+bool vdbbr_cell_iter_next( vdbbr_cell_iter * self, const void ** data,
+                           uint32_t * elem_count, size_t * byte_len )
+{
+    uint32_t count;
+    uint64_t len;
+    if ( NULL == self || self -> row >= self -> row_count )
+    {
+        return false;
+    }
+    count = vdbbr_elem_count( self -> chunk, self -> row );
+    len = ( self -> elem_bits * count + 7 ) >> 3;
+    if ( self -> offset + len > self -> chunk -> data_size )
+    {
+        /* corrupt chunk: stop here */
+        return false;
+    }
+    if ( NULL != data ) { *data = self -> chunk -> data + self -> offset; }
+    if ( NULL != elem_count ) { *elem_count = count; }
+    if ( NULL != byte_len ) { *byte_len = ( size_t )len; }
+    self -> offset += len;
+    self -> row++;
+    return true;
+}
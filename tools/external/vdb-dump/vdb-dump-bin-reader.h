@@ -0,0 +1,114 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_vdb_dump_bin_reader_
+#define _h_vdb_dump_bin_reader_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#include <klib/rc.h>
+
+/*************************************************************************************
+    reader for the binary columnar output-format of vdb-dump ( -f bin ),
+    the layout is described in vdb-dump-bin.h
+
+    works on a complete image of the output in memory ( read or mapped by the caller ),
+    nothing is copied: names, row-ids, element-counts and cell-data point into that image
+*************************************************************************************/
+
+typedef struct vdbbr_column
+{
+    const char * name;      /* not 0-terminated! */
+    uint16_t name_len;
+    uint32_t domain;
+    uint32_t intrinsic_bits;
+    uint32_t intrinsic_dim;
+} vdbbr_column;
+
+/* one column of a row-group */
+typedef struct vdbbr_chunk
+{
+    const uint8_t * lens;   /* row_count element-counts ( u32, may be unaligned ) */
+    const uint8_t * data;   /* the cell-data, each cell padded to whole bytes */
+    uint64_t data_size;
+} vdbbr_chunk;
+
+typedef struct vdbbr_group
+{
+    uint32_t row_count;
+    const uint8_t * row_ids;    /* row_count row-ids ( i64, may be unaligned ) */
+    vdbbr_chunk * chunks;       /* one per column */
+} vdbbr_group;
+
+typedef struct vdbbr_reader
+{
+    const uint8_t * data;
+    size_t size;
+    size_t pos;
+    uint32_t version;
+    uint32_t num_cols;
+    vdbbr_column * cols;
+} vdbbr_reader;
+
+/* parses the header */
+rc_t vdbbr_open( vdbbr_reader * self, const void * data, size_t size );
+void vdbbr_close( vdbbr_reader * self );
+
+/* reads the next row-group, *done is set if the trailer has been reached */
+rc_t vdbbr_next_group( vdbbr_reader * self, vdbbr_group * group, bool * done );
+void vdbbr_group_free( vdbbr_group * group );
+
+int64_t vdbbr_row_id( const vdbbr_group * group, uint32_t row );
+uint32_t vdbbr_elem_count( const vdbbr_chunk * chunk, uint32_t row );
+
+/* walks the cells of one column of a row-group in row-order */
+typedef struct vdbbr_cell_iter
+{
+    const vdbbr_chunk * chunk;
+    uint64_t elem_bits;
+    uint64_t offset;
+    uint32_t row;
+    uint32_t row_count;
+} vdbbr_cell_iter;
+
+rc_t vdbbr_cell_iter_init( vdbbr_cell_iter * self, const vdbbr_reader * reader,
+                           const vdbbr_group * group, uint32_t col_nr );
+
+/* returns false after the last cell */
+bool vdbbr_cell_iter_next( vdbbr_cell_iter * self, const void ** data,
+                           uint32_t * elem_count, size_t * byte_len );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
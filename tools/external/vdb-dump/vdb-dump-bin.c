@@ -0,0 +1,258 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "vdb-dump-bin.h"
+
+#include <klib/text.h>
+
+#include <sysalloc.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define VDBB_BUF_INC ( 16 * 1024 )
+
+static rc_t vdbb_put_u16( p_dump_str dst, uint16_t value )
+{
+    return vds_append_bytes( dst, &value, sizeof value ); /* vdb-dump-str.c */
+}
+
+static rc_t vdbb_put_u32( p_dump_str dst, uint32_t value )
+{
+    return vds_append_bytes( dst, &value, sizeof value );
+}
+
+static rc_t vdbb_put_u64( p_dump_str dst, uint64_t value )
+{
+    return vds_append_bytes( dst, &value, sizeof value );
+}
+
+rc_t vdbb_write_header( p_dump_str dst, uint32_t num_cols, const vdbb_col_desc * cols )
+{
+    rc_t rc;
+    uint32_t i;
+    if ( NULL == dst || NULL == cols )
+    {
+        return RC( rcVDB, rcNoTarg, rcWriting, rcParam, rcNull );
+    }
+    rc = vds_append_bytes( dst, VDBB_MAGIC, VDBB_MAGIC_LEN );
+    if ( 0 == rc ) { rc = vdbb_put_u32( dst, VDBB_BOM ); }
+    if ( 0 == rc ) { rc = vdbb_put_u32( dst, VDBB_VERSION ); }
+    if ( 0 == rc ) { rc = vdbb_put_u32( dst, num_cols ); }
+    for ( i = 0; 0 == rc && i < num_cols; ++i )
+    {
+        const vdbb_col_desc * col = &( cols[ i ] );
+        size_t name_len = string_size( col -> name );
+        if ( name_len > 0xFFFF )
+        {
+            rc = RC( rcVDB, rcNoTarg, rcWriting, rcName, rcExcessive );
+        }
+        else
+        {
+            rc = vdbb_put_u16( dst, ( uint16_t )name_len );
+            if ( 0 == rc && name_len > 0 ) { rc = vds_append_bytes( dst, col -> name, name_len ); }
+            if ( 0 == rc ) { rc = vdbb_put_u32( dst, col -> domain ); }
+            if ( 0 == rc ) { rc = vdbb_put_u32( dst, col -> intrinsic_bits ); }
+            if ( 0 == rc ) { rc = vdbb_put_u32( dst, col -> intrinsic_dim ); }
+        }
+    }
+    return rc;
+}
+
+rc_t vdbb_write_trailer( p_dump_str dst )
+{
+    if ( NULL == dst )
+    {
+        return RC( rcVDB, rcNoTarg, rcWriting, rcParam, rcNull );
+    }
+    return vds_append_bytes( dst, VDBB_END_MAGIC, VDBB_TAG_LEN );
+}
+
+rc_t vdbb_group_init( vdbb_group * self, uint32_t num_cols )
+{
+    rc_t rc;
+    uint32_t i;
+    if ( NULL == self )
+    {
+        return RC( rcVDB, rcNoTarg, rcConstructing, rcSelf, rcNull );
+    }
+    memset( self, 0, sizeof * self );
+    self -> lens = calloc( num_cols, sizeof self -> lens[ 0 ] );
+    self -> data = calloc( num_cols, sizeof self -> data[ 0 ] );
+    if ( NULL == self -> lens || NULL == self -> data )
+    {
+        vdbb_group_free( self );
+        return RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    }
+    rc = vds_make( &( self -> row_ids ), 0, VDBB_BUF_INC );
+    for ( i = 0; 0 == rc && i < num_cols; ++i )
+    {
+        rc = vds_make( &( self -> lens[ i ] ), 0, VDBB_BUF_INC );
+        if ( 0 == rc )
+        {
+            rc = vds_make( &( self -> data[ i ] ), 0, VDBB_BUF_INC );
+            if ( 0 == rc )
+            {
+                self -> num_cols = i + 1;
+            }
+            else
+            {
+                vds_free( &( self -> lens[ i ] ) );
+            }
+        }
+    }
+    if ( 0 != rc )
+    {
+        vdbb_group_free( self );
+    }
+    return rc;
+}
+
+void vdbb_group_free( vdbb_group * self )
+{
+    if ( NULL != self )
+    {
+        uint32_t i;
+        for ( i = 0; i < self -> num_cols; ++i )
+        {
+            vds_free( &( self -> lens[ i ] ) );
+            vds_free( &( self -> data[ i ] ) );
+        }
+        if ( NULL != self -> row_ids . buf )
+        {
+            vds_free( &( self -> row_ids ) );
+        }
+        free( ( void * )self -> lens );
+        free( ( void * )self -> data );
+        memset( self, 0, sizeof * self );
+    }
+}
+
+void vdbb_group_clear( vdbb_group * self )
+{
+    if ( NULL != self )
+    {
+        uint32_t i;
+        for ( i = 0; i < self -> num_cols; ++i )
+        {
+            vds_clear( &( self -> lens[ i ] ) );
+            vds_clear( &( self -> data[ i ] ) );
+        }
+        vds_clear( &( self -> row_ids ) );
+        self -> row_count = 0;
+    }
+}
+
+rc_t vdbb_group_add_row( vdbb_group * self, int64_t row_id )
+{
+    rc_t rc;
+    if ( NULL == self )
+    {
+        return RC( rcVDB, rcNoTarg, rcInserting, rcSelf, rcNull );
+    }
+    rc = vds_append_bytes( &( self -> row_ids ), &row_id, sizeof row_id );
+    if ( 0 == rc )
+    {
+        self -> row_count++;
+    }
+    return rc;
+}
+
+rc_t vdbb_group_add_cell( vdbb_group * self, uint32_t col_nr,
+                          const void * base, uint32_t boff,
+                          uint32_t elem_bits, uint32_t row_len )
+{
+    rc_t rc;
+    if ( NULL == self )
+    {
+        return RC( rcVDB, rcNoTarg, rcInserting, rcSelf, rcNull );
+    }
+    if ( col_nr >= self -> num_cols )
+    {
+        return RC( rcVDB, rcNoTarg, rcInserting, rcId, rcOutofrange );
+    }
+    if ( NULL == base )
+    {
+        row_len = 0;
+    }
+    rc = vdbb_put_u32( &( self -> lens[ col_nr ] ), row_len );
+    if ( 0 == rc && row_len > 0 )
+    {
+        p_dump_str dst = &( self -> data[ col_nr ] );
+        bitsz_t bits = ( bitsz_t )elem_bits * row_len;
+        size_t bytes = ( size_t )( ( bits + 7 ) >> 3 );
+        if ( 0 == boff )
+        {
+            /* the common case: the cell starts on a byte-boundary */
+            rc = vds_append_bytes( dst, base, bytes );
+        }
+        else
+        {
+            /* the cell starts in the middle of a byte */
+            rc = vds_append_bits( dst, base, boff, bits );
+        }
+    }
+    return rc;
+}
+
+rc_t vdbb_group_write( const vdbb_group * self, p_dump_str dst )
+{
+    rc_t rc;
+    uint32_t i;
+    if ( NULL == self || NULL == dst )
+    {
+        return RC( rcVDB, rcNoTarg, rcWriting, rcParam, rcNull );
+    }
+    rc = vds_append_bytes( dst, VDBB_GROUP_MAGIC, VDBB_TAG_LEN );
+    if ( 0 == rc ) { rc = vdbb_put_u32( dst, self -> row_count ); }
+    if ( 0 == rc && self -> row_count > 0 )
+    {
+        rc = vds_append_bytes( dst, self -> row_ids . buf, self -> row_ids . str_len );
+    }
+    for ( i = 0; 0 == rc && i < self -> num_cols; ++i )
+    {
+        const dump_str * lens = &( self -> lens[ i ] );
+        const dump_str * data = &( self -> data[ i ] );
+        if ( lens -> str_len != ( size_t )self -> row_count * sizeof( uint32_t ) )
+        {
+            /* every row needs a cell in every column */
+            rc = RC( rcVDB, rcNoTarg, rcWriting, rcData, rcInconsistent );
+        }
+        else
+        {
+            rc = vdbb_put_u64( dst, ( uint64_t )( lens -> str_len + data -> str_len ) );
+            if ( 0 == rc && lens -> str_len > 0 )
+            {
+                rc = vds_append_bytes( dst, lens -> buf, lens -> str_len );
+            }
+            if ( 0 == rc && data -> str_len > 0 )
+            {
+                rc = vds_append_bytes( dst, data -> buf, data -> str_len );
+            }
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,126 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_vdb_dump_bin_
+#define _h_vdb_dump_bin_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#include <klib/rc.h>
+
+#include "vdb-dump-str.h"
+
+/*************************************************************************************
+    binary columnar output-format ( -f bin ):
+
+    all integers are written in host byte-order, the byte-order-mark in the header
+    lets a reader detect a mismatch
+
+    file         := header group* trailer
+    header       := "VDBCOLS1"              ( 8 bytes )
+                    u32 byte-order-mark     ( 0x01020304 )
+                    u32 version             ( VDBB_VERSION )
+                    u32 column-count
+                    column-def[ column-count ]
+    column-def   := u16 name-len, name      ( not 0-terminated )
+                    u32 domain              ( VTypedesc.domain: vtdBool ... vtdUnicode )
+                    u32 intrinsic-bits
+                    u32 intrinsic-dim
+    group        := "RGRP"
+                    u32 row-count
+                    i64 row-id[ row-count ]
+                    column-chunk[ column-count ]
+    column-chunk := u64 chunk-size          ( bytes following this field )
+                    u32 element-count[ row-count ]
+                    cell-data[ row-count ]  ( each cell padded to whole bytes )
+    trailer      := "VEND"
+
+    the element-size of a column is intrinsic-bits * intrinsic-dim,
+    a cell that could not be read has an element-count of zero
+*************************************************************************************/
+
+#define VDBB_MAGIC          "VDBCOLS1"
+#define VDBB_MAGIC_LEN      8
+#define VDBB_BOM            0x01020304
+#define VDBB_VERSION        1
+#define VDBB_GROUP_MAGIC    "RGRP"
+#define VDBB_END_MAGIC      "VEND"
+#define VDBB_TAG_LEN        4
+
+/* the description of one column in the header */
+typedef struct vdbb_col_desc
+{
+    const char * name;
+    uint32_t domain;
+    uint32_t intrinsic_bits;
+    uint32_t intrinsic_dim;
+} vdbb_col_desc;
+
+/* appends the header to dst */
+rc_t vdbb_write_header( p_dump_str dst, uint32_t num_cols, const vdbb_col_desc * cols );
+
+/* appends the trailer to dst */
+rc_t vdbb_write_trailer( p_dump_str dst );
+
+/* collects the cells of a row-group column by column */
+typedef struct vdbb_group
+{
+    uint32_t num_cols;
+    uint32_t row_count;
+    dump_str row_ids;
+    dump_str * lens;    /* num_cols element-count arrays */
+    dump_str * data;    /* num_cols cell-data buffers */
+} vdbb_group;
+
+rc_t vdbb_group_init( vdbb_group * self, uint32_t num_cols );
+void vdbb_group_free( vdbb_group * self );
+
+/* forget the collected rows, keep the buffers */
+void vdbb_group_clear( vdbb_group * self );
+
+/* starts a new row in the group */
+rc_t vdbb_group_add_row( vdbb_group * self, int64_t row_id );
+
+/* adds a cell to the current row, the cell-data is copied as is ( no formatting ),
+   base / boff / elem_bits / row_len as returned by VCursorCellDataDirect() */
+rc_t vdbb_group_add_cell( vdbb_group * self, uint32_t col_nr,
+                          const void * base, uint32_t boff,
+                          uint32_t elem_bits, uint32_t row_len );
+
+/* appends the collected row-group to dst */
+rc_t vdbb_group_write( const vdbb_group * self, p_dump_str dst );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -115,6 +115,7 @@ static void vdco_init_values( p_dump_context ctx ) {
     ctx -> max_line_len = 0;
     ctx -> indented_line_len = 0;
     ctx -> slice_depth = 0;
+    ctx -> num_threads = 1;
 
     ctx -> help_requested = false;
     ctx -> usage_requested = false;
@@ -369,6 +370,8 @@ static bool vdco_set_format( p_dump_context ctx, const char *src ) {
         ctx -> format = df_qual1;
     } else if ( 0 == strcmp( src, "sql" ) ) {
         ctx -> format = df_sql;
+    } else if ( 0 == strcmp( src, "bin" ) ) {
+        ctx -> format = df_bin;
     } else {
         ctx -> format = df_default;
     }
@@ -514,6 +517,7 @@ static void vdco_evaluate_options( const Args *args, dump_context *ctx ) {
     ctx -> enum_static = vdco_get_bool_option( args, OPTION_ENUM_STATIC, false );
     ctx -> idx_enum_requested = vdco_get_bool_option( args, OPTION_IDX_ENUM, false );
     ctx -> disable_multithreading = vdco_get_bool_option( args, OPTION_NO_MULTITHREAD, false );
+    ctx -> num_threads = vdco_get_uint16_option( args, OPTION_THREADS, 1 );
     ctx -> print_info = vdco_get_bool_option( args, OPTION_INFO, false );
     ctx -> show_spotgroups = vdco_get_bool_option( args, OPTION_SPOTGROUPS, false );
     ctx -> merge_ranges = vdco_get_bool_option( args, OPTION_MERGE_RANGES, false );
@@ -27,8 +27,10 @@
 #include "vdb-dump-fastq.h"
 #include "vdb-dump-helper.h"
 #include "vdb-dump-tools.h"
+#include "vdb-dump-threads.h"
 
 #include <stdlib.h>
+#include <stdarg.h>
 
 #include <kdb/manager.h>
 #include <vdb/vdb-priv.h>
@@ -44,6 +46,16 @@ rc_t CC Quitting ( void );
 
 #define INVALID_COLUMN 0xFFFFFFFF
 #define DEF_FASTA_LEN 70
+#define VDF_MT_CHUNK_ROWS 1024
+
+/* per worker-thread state of the multi-threaded dump ( --threads ) */
+typedef struct vdf_mt {
+    struct ordered_worker * self;
+    p_dump_str chunk;               /* the output of the current chunk of this worker */
+    uint64_t num;                   /* position of the next row in the selected rows */
+    uint32_t worker_id;
+    uint32_t num_workers;
+} vdf_mt;
 
 typedef struct fastq_ctx {
     const char * run_name;
@@ -59,8 +71,59 @@ typedef struct fastq_ctx {
     uint32_t idx_read_start;
     uint32_t idx_read_len;
     uint32_t idx_read_type;
+    vdf_mt * mt;                    /* NULL if single-threaded */
 } fastq_ctx;
 
+/*************************************************************************************
+    all output of the loops goes through here: either directly to KOutMsg(),
+    or into the chunk of the current worker-thread ( multi-threaded dump )
+*************************************************************************************/
+static rc_t vdf_out( const fastq_ctx * fctx, const char * fmt, ... ) {
+    rc_t rc;
+    va_list args;
+    va_start( args, fmt );
+    if ( NULL == fctx -> mt || NULL == fctx -> mt -> chunk ) {
+        rc = KOutVMsg( fmt, args );
+    } else {
+        rc = vds_append_vfmt_no_limit_check( fctx -> mt -> chunk, fmt, args );
+    }
+    va_end( args );
+    return rc;
+}
+
+/*************************************************************************************
+    all loops get their rows from here: single-threaded that is every selected row,
+    multi-threaded only the rows of the chunks of this worker ( worker #n takes the
+    chunks n, n + N ... ), at the start of each of its chunks the previous chunk is
+    handed over to the writer
+*************************************************************************************/
+static bool vdf_next_row( const fastq_ctx * fctx, int64_t * row_id, rc_t * rc ) {
+    vdf_mt * mt = fctx -> mt;
+    if ( NULL == mt ) {
+        return num_gen_iterator_next( fctx -> row_iter, row_id, rc );
+    }
+    while ( num_gen_iterator_next( fctx -> row_iter, row_id, rc ) ) {
+        uint64_t num = mt -> num++;
+        if ( 0 != *rc ) {
+            return true;
+        }
+        /* we skip over the rows of the chunks of the other workers */
+        if ( ( ( num / VDF_MT_CHUNK_ROWS ) % mt -> num_workers ) == mt -> worker_id ) {
+            if ( 0 == ( num % VDF_MT_CHUNK_ROWS ) ) {
+                if ( NULL != mt -> chunk ) {
+                    *rc = vdmt_deliver( mt -> self, mt -> chunk ); /* vdb-dump-threads.c */
+                    mt -> chunk = NULL;
+                }
+                if ( 0 == *rc ) {
+                    *rc = vdmt_make_chunk( &( mt -> chunk ) ); /* vdb-dump-threads.c */
+                }
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
 static char * vdb_fastq_extract_run_name( const char * acc_or_path ) {
     char * delim = string_rchr ( acc_or_path, string_size( acc_or_path ), '/' );
     if ( NULL == delim ) {
@@ -84,6 +147,7 @@ static void init_fastq_ctx( const p_dump_context ctx, fastq_ctx * fctx, const ch
     fctx -> idx_read_start  = INVALID_COLUMN;
     fctx -> idx_read_len    = INVALID_COLUMN;
     fctx -> idx_read_type   = INVALID_COLUMN;
+    fctx -> mt = NULL;
 }
 
 static void vdb_fastq_row_error( const char * fmt, rc_t rc, int64_t row_id ) {
@@ -251,7 +315,7 @@ static rc_t vdb_fastq1_frag_type_checked( fastq_spot * spot, int64_t row_id, con
         for ( idx = 0, frag = 1, ofs = 0; 0 == rc && idx < spot -> num_rd_start; ++idx ) {
             if ( ( READ_TYPE_BIOLOGICAL == ( spot -> rd_type[ idx ] & READ_TYPE_BIOLOGICAL ) ) &&
                  spot -> rd_len[ idx ] > 0 ) {
-                rc = KOutMsg( "@%s.%li.%d %.*s length=%u\n%.*s\n+%s.%li.%d %.*s length=%u\n%.*s\n",
+                rc = vdf_out( fctx, "@%s.%li.%d %.*s length=%u\n%.*s\n+%s.%li.%d %.*s length=%u\n%.*s\n",
                               fctx -> run_name, row_id, frag, spot -> name_len, spot -> name, spot -> rd_len[ idx ],
                               spot -> rd_len[ idx ], &( spot -> bases[ ofs ] ),
                               fctx -> run_name, row_id, frag, spot -> name_len, spot -> name, spot -> rd_len[ idx ],
@@ -283,7 +347,7 @@ static rc_t vdb_fastq1_frag_not_type_checked( fastq_spot * spot, int64_t row_id,
         uint32_t idx, frag, ofs;
         for ( idx = 0, frag = 1, ofs = 0; 0 == rc && idx < spot -> num_rd_start; ++idx ) {
             if ( spot -> rd_len[ idx ] > 0 ) {
-                rc = KOutMsg( "@%s.%li.%d %.*s length=%u\n%.*s\n+%s.%li.%d %.*s length=%u\n%.*s\n",
+                rc = vdf_out( fctx, "@%s.%li.%d %.*s length=%u\n%.*s\n+%s.%li.%d %.*s length=%u\n%.*s\n",
                               fctx -> run_name, row_id, frag, spot -> name_len, spot -> name, spot -> rd_len[ idx ],
                               spot -> rd_len[ idx ], &( spot -> bases[ ofs ] ),
                               fctx -> run_name, row_id, frag, spot -> name_len, spot -> name, spot -> rd_len[ idx ],
@@ -307,7 +371,7 @@ static rc_t vdb_fastq1_loop( const fastq_ctx * fctx ) {
     } else {
         bool has_type = ( INVALID_COLUMN != fctx -> idx_read_type );
         int64_t row_id;
-        while ( 0 == rc && num_gen_iterator_next( fctx -> row_iter, &row_id, &rc ) ) {
+        while ( 0 == rc && vdf_next_row( fctx, &row_id, &rc ) ) {
             if ( 0 == rc ) { rc = Quitting(); }
             if ( 0 == rc ) {
                 fastq_spot spot;
@@ -333,7 +397,7 @@ static rc_t vdb_fastq_loop( const fastq_ctx * fctx ) {
     } else {
         bool has_name = ( INVALID_COLUMN != fctx -> idx_name );
         int64_t row_id;
-        while ( 0 == rc && num_gen_iterator_next( fctx -> row_iter, &row_id, &rc ) ) {
+        while ( 0 == rc && vdf_next_row( fctx, &row_id, &rc ) ) {
             if ( 0 == rc ) {
                 rc = Quitting();
             }
@@ -342,13 +406,13 @@ static rc_t vdb_fastq_loop( const fastq_ctx * fctx ) {
                 rc = read_spot( fctx, row_id, &spot );
                 if ( rc == 0 ) {
                     if ( has_name ) {
-                        rc = KOutMsg( "@%s.%li %.*s length=%u\n%.*s\n+%s.%li %.*s length=%u\n%.*s\n",
+                        rc = vdf_out( fctx, "@%s.%li %.*s length=%u\n%.*s\n+%s.%li %.*s length=%u\n%.*s\n",
                                     fctx -> run_name, row_id, spot . name_len, spot . name, spot . num_bases,
                                     spot . num_bases, spot . bases,
                                     fctx -> run_name, row_id, spot . name_len, spot . name, spot . num_qual,
                                     spot . num_qual, spot . qual );
                     } else {
-                        rc = KOutMsg( "@%s.%li %li length=%u\n%.*s\n+%s.%li %li length=%u\n%.*s\n",
+                        rc = vdf_out( fctx, "@%s.%li %li length=%u\n%.*s\n+%s.%li %li length=%u\n%.*s\n",
                                     fctx -> run_name, row_id, row_id, spot . num_bases,
                                     spot . num_bases, spot . bases,
                                     fctx -> run_name, row_id, row_id, spot . num_bases,
@@ -361,10 +425,10 @@ static rc_t vdb_fastq_loop( const fastq_ctx * fctx ) {
     return rc;
 }
 
-static rc_t print_bases( const char * bases, uint32_t num_bases, uint32_t max_line_len ) {
+static rc_t print_bases( const fastq_ctx * fctx, const char * bases, uint32_t num_bases, uint32_t max_line_len ) {
     rc_t rc;
     if ( 0 == max_line_len ) {
-        rc = KOutMsg( "%.*s\n", num_bases, bases );
+        rc = vdf_out( fctx, "%.*s\n", num_bases, bases );
     } else {
         uint32_t idx = 0, to_print = num_bases;
         rc = 0;
@@ -372,7 +436,7 @@ static rc_t print_bases( const char * bases, uint32_t num_bases, uint32_t max_li
             if ( to_print > max_line_len ) {
                 to_print = max_line_len;
             }
-            rc = KOutMsg( "%.*s\n", to_print, &bases[ idx ] );
+            rc = vdf_out( fctx, "%.*s\n", to_print, &bases[ idx ] );
             if ( 0 == rc ) {
                 idx += to_print;
                 to_print = ( num_bases - idx );
@@ -382,7 +446,7 @@ static rc_t print_bases( const char * bases, uint32_t num_bases, uint32_t max_li
     return rc;
 }
 
-static rc_t print_qual( const char * qual, uint32_t count, uint32_t max_line_len ) {
+static rc_t print_qual( const fastq_ctx * fctx, const char * qual, uint32_t count, uint32_t max_line_len ) {
     rc_t rc = 0;
     uint32_t i = 0, on_line = 0;
     while ( 0 == rc && i < count ) {
@@ -391,21 +455,21 @@ static rc_t print_qual( const char * qual, uint32_t count, uint32_t max_line_len
         rc = string_printf( buffer, sizeof buffer, &num_writ, "%d", qual[ i ] );
         if ( 0 == rc ) {
             if ( 0 == on_line ) {
-                rc = KOutMsg( "%s", buffer );
+                rc = vdf_out( fctx, "%s", buffer );
                 on_line = ( uint32_t )num_writ;
             } else {
                 if ( ( on_line + num_writ + 1 ) < max_line_len ) {
-                    rc = KOutMsg( " %s", buffer );
+                    rc = vdf_out( fctx, " %s", buffer );
                     on_line += ( ( uint32_t )num_writ + 1 );
                 } else {
-                    rc = KOutMsg( "\n%s", buffer );
+                    rc = vdf_out( fctx, "\n%s", buffer );
                     on_line = ( uint32_t )num_writ;
                 }
             }
             i++;
         }
     }
-    rc = KOutMsg( "\n" );
+    rc = vdf_out( fctx, "\n" );
     return rc;
 }
 
@@ -413,7 +477,7 @@ static rc_t vdb_fasta_frag_type_checked_loop( const fastq_ctx * fctx ) {
     rc_t rc = 0;
     bool has_name = ( INVALID_COLUMN != fctx -> idx_name );
     int64_t row_id;
-    while ( 0 == rc && num_gen_iterator_next( fctx -> row_iter, &row_id, &rc ) ) {
+    while ( 0 == rc && vdf_next_row( fctx, &row_id, &rc ) ) {
         if ( 0 == rc ) { rc = Quitting(); }
         if ( 0 == rc ) {
             fastq_spot spot;
@@ -425,14 +489,14 @@ static rc_t vdb_fasta_frag_type_checked_loop( const fastq_ctx * fctx ) {
                     if ( frag_len > 0 &&
                          ( ( spot.rd_type[ idx ] & READ_TYPE_BIOLOGICAL ) == READ_TYPE_BIOLOGICAL ) ) {
                         if ( has_name ) {
-                            rc = KOutMsg( ">%s.%li.%d %.*s length=%u\n",
+                            rc = vdf_out( fctx, ">%s.%li.%d %.*s length=%u\n",
                                     fctx -> run_name, row_id, frag, spot . name_len, spot . name, frag_len );
                         } else {
-                            rc = KOutMsg( ">%s.%li.%d %li length=%u\n",
+                            rc = vdf_out( fctx, ">%s.%li.%d %li length=%u\n",
                                     fctx -> run_name, row_id, frag, row_id, frag_len );
                         }
                         if ( 0 == rc ) {
-                            rc = print_bases( &( spot.bases[ ofs ] ), frag_len, fctx -> max_line_len );
+                            rc = print_bases( fctx, &( spot.bases[ ofs ] ), frag_len, fctx -> max_line_len );
                         }
                         frag++;
                     }
@@ -448,7 +512,7 @@ static rc_t vdb_fasta_frag_no_type_check_loop( const fastq_ctx * fctx ) {
     rc_t rc = 0;
     bool has_name = ( INVALID_COLUMN != fctx -> idx_name );
     int64_t row_id;
-    while ( 0 == rc && num_gen_iterator_next( fctx -> row_iter, &row_id, &rc ) ) {
+    while ( 0 == rc && vdf_next_row( fctx, &row_id, &rc ) ) {
         if ( 0 == rc ) { rc = Quitting(); }
         if ( 0 == rc ) {
             fastq_spot spot;
@@ -459,14 +523,14 @@ static rc_t vdb_fasta_frag_no_type_check_loop( const fastq_ctx * fctx ) {
                     uint32_t frag_len = spot.rd_len[ idx ];
                     if ( frag_len > 0 ) {
                         if ( has_name ) {
-                            rc = KOutMsg( ">%s.%li.%d %.*s length=%u\n",
+                            rc = vdf_out( fctx, ">%s.%li.%d %.*s length=%u\n",
                                     fctx -> run_name, row_id, frag, spot . name_len, spot . name, frag_len );
                         } else {
-                            rc = KOutMsg( ">%s.%li.%d %li length=%u\n",
+                            rc = vdf_out( fctx, ">%s.%li.%d %li length=%u\n",
                                     fctx -> run_name, row_id, frag, row_id, frag_len );
                         }
                         if ( 0 == rc ) {
-                            rc = print_bases( &( spot.bases[ ofs ] ), frag_len, fctx -> max_line_len );
+                            rc = print_bases( fctx, &( spot.bases[ ofs ] ), frag_len, fctx -> max_line_len );
                         }
                         frag++;
                     }
@@ -482,20 +546,20 @@ static rc_t vdb_fasta_spot_loop( const fastq_ctx * fctx ) {
     rc_t rc = 0;
     bool has_name = ( INVALID_COLUMN != fctx -> idx_name );
     int64_t row_id;
-    while ( 0 == rc && num_gen_iterator_next( fctx -> row_iter, &row_id, &rc ) ) {
+    while ( 0 == rc && vdf_next_row( fctx, &row_id, &rc ) ) {
         if ( 0 == rc ) { rc = Quitting(); }
         if ( 0 == rc ) {
             fastq_spot spot;
             rc = read_spot( fctx, row_id, &spot );
             if ( 0 == rc ) {
                 if ( has_name ) {
-                    rc = KOutMsg( ">%s.%li %.*s length=%u\n",
+                    rc = vdf_out( fctx, ">%s.%li %.*s length=%u\n",
                             fctx -> run_name, row_id, spot . name_len, spot . name, spot . num_bases );
                 } else {
-                    rc = KOutMsg( ">%s.%li %li length=%u\n", fctx -> run_name, row_id, row_id, spot . num_bases );
+                    rc = vdf_out( fctx, ">%s.%li %li length=%u\n", fctx -> run_name, row_id, row_id, spot . num_bases );
                 }   
                 if ( 0 == rc ) {
-                    rc = print_bases( spot.bases, spot.num_bases, fctx -> max_line_len );
+                    rc = print_bases( fctx, spot.bases, spot.num_bases, fctx -> max_line_len );
                 }
             }
         }
@@ -531,7 +595,7 @@ static rc_t vdb_qual_frag_type_checked_loop( const fastq_ctx * fctx ) {
     rc_t rc = 0;
     bool has_name = ( INVALID_COLUMN != fctx -> idx_name );
     int64_t row_id;
-    while ( 0 == rc && num_gen_iterator_next( fctx -> row_iter, &row_id, &rc ) ) {
+    while ( 0 == rc && vdf_next_row( fctx, &row_id, &rc ) ) {
         if ( 0 == rc ) { rc = Quitting(); }
         if ( 0 == rc ) {
             fastq_spot spot;
@@ -543,14 +607,14 @@ static rc_t vdb_qual_frag_type_checked_loop( const fastq_ctx * fctx ) {
                     if ( frag_len > 0 &&
                          ( READ_TYPE_BIOLOGICAL == ( spot.rd_type[ idx ] & READ_TYPE_BIOLOGICAL ) ) ) {
                         if ( has_name ) {
-                            rc = KOutMsg( ">%s.%li.%d %.*s length=%u\n",
+                            rc = vdf_out( fctx, ">%s.%li.%d %.*s length=%u\n",
                                     fctx -> run_name, row_id, frag, spot . name_len, spot . name, frag_len );
                         } else {
-                            rc = KOutMsg( ">%s.%li.%d %li length=%u\n",
+                            rc = vdf_out( fctx, ">%s.%li.%d %li length=%u\n",
                                     fctx -> run_name, row_id, frag, row_id, frag_len );
                         }
                         if ( 0 == rc ) {
-                            rc = print_qual( &( spot . qual[ ofs ] ), frag_len, fctx -> max_line_len );
+                            rc = print_qual( fctx, &( spot . qual[ ofs ] ), frag_len, fctx -> max_line_len );
                         }
                         frag++;
                     }
@@ -566,7 +630,7 @@ static rc_t vdb_qual_frag_no_type_check_loop( const fastq_ctx * fctx ) {
     rc_t rc = 0;
     bool has_name = ( INVALID_COLUMN != fctx -> idx_name );
     int64_t row_id;
-    while ( 0 == rc && num_gen_iterator_next( fctx -> row_iter, &row_id, &rc ) ) {
+    while ( 0 == rc && vdf_next_row( fctx, &row_id, &rc ) ) {
         if ( 0 == rc ) { rc = Quitting(); }
         if ( 0 == rc ) {
             fastq_spot spot;
@@ -577,14 +641,14 @@ static rc_t vdb_qual_frag_no_type_check_loop( const fastq_ctx * fctx ) {
                     uint32_t frag_len = spot.rd_len[ idx ];
                     if ( frag_len > 0 ) {
                         if ( has_name ) {
-                            rc = KOutMsg( ">%s.%li.%d %.*s length=%u\n",
+                            rc = vdf_out( fctx, ">%s.%li.%d %.*s length=%u\n",
                                     fctx -> run_name, row_id, frag, spot . name_len, spot . name, frag_len );
                         } else {
-                            rc = KOutMsg( ">%s.%li.%d %li length=%u\n",
+                            rc = vdf_out( fctx, ">%s.%li.%d %li length=%u\n",
                                     fctx -> run_name, row_id, frag, row_id, frag_len );
                         }
                         if ( 0 == rc ) {
-                            rc = print_qual( &( spot.qual[ ofs ] ), frag_len, fctx -> max_line_len );
+                            rc = print_qual( fctx, &( spot.qual[ ofs ] ), frag_len, fctx -> max_line_len );
                         }
                         frag++;
                     }
@@ -600,21 +664,21 @@ static rc_t vdb_qual_spot_loop( const fastq_ctx * fctx ) {
     rc_t rc = 0;
     bool has_name = ( INVALID_COLUMN != fctx -> idx_name );
     int64_t row_id;
-    while ( 0 == rc && num_gen_iterator_next( fctx -> row_iter, &row_id, &rc ) ) {
+    while ( 0 == rc && vdf_next_row( fctx, &row_id, &rc ) ) {
         if ( 0 == rc ) { rc = Quitting(); }
         if ( 0 == rc ) {
             fastq_spot spot;
             rc = read_spot( fctx, row_id, &spot );
             if ( 0 == rc ) {
                 if ( has_name ) {
-                    rc = KOutMsg( ">%s.%li %.*s length=%u\n",
+                    rc = vdf_out( fctx, ">%s.%li %.*s length=%u\n",
                             fctx -> run_name, row_id, spot . name_len, spot . name, spot . num_qual );
                 } else {
-                    rc = KOutMsg( ">%s.%li %li length=%u\n",
+                    rc = vdf_out( fctx, ">%s.%li %li length=%u\n",
                             fctx -> run_name, row_id, row_id, spot . num_qual );
                 }   
                 if ( 0 == rc ) {
-                    rc = print_qual( spot.qual, spot.num_qual, fctx -> max_line_len );
+                    rc = print_qual( fctx, spot.qual, spot.num_qual, fctx -> max_line_len );
                 }
             }
         }
@@ -646,26 +710,26 @@ static rc_t vdb_qual_loop( const fastq_ctx * fctx ) {
 
 /* -------------------------------------------------------------------------------------------------------------- */
 
-static rc_t vdb_fasta_accumulated( const char * bases, uint32_t num_bases, 
+static rc_t vdb_fasta_accumulated( const fastq_ctx * fctx, const char * bases, uint32_t num_bases, 
                                    int32_t * chars_left_on_line, uint32_t max_line_len ) {
     rc_t rc = 0;
     if ( num_bases < (uint32_t)( *chars_left_on_line ) ) {
-        rc = KOutMsg( "%.*s", num_bases, bases );
+        rc = vdf_out( fctx, "%.*s", num_bases, bases );
         ( *chars_left_on_line ) -= num_bases;
     } else if ( num_bases == ( *chars_left_on_line ) ) {
-        rc = KOutMsg( "%.*s\n", num_bases, bases );
+        rc = vdf_out( fctx, "%.*s\n", num_bases, bases );
         ( *chars_left_on_line ) = max_line_len;
     } else {
         uint32_t ofs = 0;
         int32_t remaining = num_bases;
         while( 0 == rc && ofs < num_bases ) {
             if ( remaining >= ( *chars_left_on_line ) ) {
-                rc = KOutMsg( "%.*s\n", ( *chars_left_on_line ), &bases[ ofs ] );
+                rc = vdf_out( fctx, "%.*s\n", ( *chars_left_on_line ), &bases[ ofs ] );
                 ofs += ( *chars_left_on_line );
                 remaining -= ( *chars_left_on_line );
                 ( *chars_left_on_line ) = max_line_len;
             } else {
-                rc = KOutMsg( "%.*s", remaining, &bases[ ofs ] );
+                rc = vdf_out( fctx, "%.*s", remaining, &bases[ ofs ] );
                 ofs += remaining;
                 ( *chars_left_on_line ) -= remaining;
                 remaining = 0;
@@ -684,18 +748,18 @@ static rc_t vdb_fasta1_loop( const fastq_ctx * fctx ) {
         int64_t row_id;
         int32_t chars_left_on_line = fctx -> max_line_len;
         
-        rc = KOutMsg( ">%s\n", fctx -> run_name );
-        while ( 0 == rc && num_gen_iterator_next( fctx -> row_iter, &row_id, &rc ) ) {
+        rc = vdf_out( fctx, ">%s\n", fctx -> run_name );
+        while ( 0 == rc && vdf_next_row( fctx, &row_id, &rc ) ) {
             if ( 0 == rc ) { rc = Quitting(); }
             if ( 0 == rc ) {
                 fastq_spot spot;
                 rc = read_spot( fctx, row_id, &spot );
                 if ( 0 == rc ) {
-                    rc = vdb_fasta_accumulated( spot.bases, spot.num_bases, &chars_left_on_line, fctx -> max_line_len );
+                    rc = vdb_fasta_accumulated( fctx, spot.bases, spot.num_bases, &chars_left_on_line, fctx -> max_line_len );
                 }
             }
         }
-        rc = KOutMsg( "\n" );
+        rc = vdf_out( fctx, "\n" );
     }
     return rc;
 }
@@ -711,7 +775,7 @@ static rc_t vdb_fasta2_loop( const fastq_ctx * fctx ) {
         int64_t row_id;
         int32_t chars_left_on_line = fctx -> max_line_len;
         
-        while ( 0 == rc && num_gen_iterator_next( fctx -> row_iter, &row_id, &rc ) ) {
+        while ( 0 == rc && vdf_next_row( fctx, &row_id, &rc ) ) {
             if ( 0 == rc ) { rc = Quitting(); }
             if ( 0 == rc ) {
                 fastq_spot spot;
@@ -727,20 +791,154 @@ static rc_t vdb_fasta2_loop( const fastq_ctx * fctx ) {
                     }
                     if ( print_ref_name ) {
                         if ( chars_left_on_line == fctx -> max_line_len ) {
-                            rc = KOutMsg( ">%.*s\n", spot . name_len, spot . name );
+                            rc = vdf_out( fctx, ">%.*s\n", spot . name_len, spot . name );
                         } else {
-                            rc = KOutMsg( "\n>%.*s\n", spot . name_len, spot . name );
+                            rc = vdf_out( fctx, "\n>%.*s\n", spot . name_len, spot . name );
                             chars_left_on_line = fctx -> max_line_len;
                         }
                         last_name_len = string_copy ( last_name, sizeof last_name, spot . name, spot . name_len );
                     }
                     if ( 0 == rc ) {
-                        rc = vdb_fasta_accumulated( spot.bases, spot.num_bases, &chars_left_on_line, fctx -> max_line_len );
+                        rc = vdb_fasta_accumulated( fctx, spot.bases, spot.num_bases, &chars_left_on_line, fctx -> max_line_len );
+                    }
+                }
+            }
+        }
+        rc = vdf_out( fctx, "\n" );
+    }
+    return rc;
+}
+
+static rc_t vdb_fastq_rows( const fastq_ctx * fctx ) {
+    rc_t rc = 0;
+    switch( fctx -> format ) {
+        /* one FASTQ-record ( 4 liner ) per READ/SPOT */
+        case df_fastq : rc = vdb_fastq_loop( fctx ); /* <--- */
+                         break;
+
+        /* one FASTQ-record ( 4 liner ) per FRAGMENT/ALIGNMENT */
+        case df_fastq1 : rc = vdb_fastq1_loop( fctx ); /* <--- */
+                          break;
+
+        /* one FASTA-record ( 2 liner ) per READ/SPOT */
+        case df_fasta :  rc = vdb_fasta_loop( fctx ); /* <--- */
+                         break;
+
+         /* one FASTA-record ( many lines ) for the whole accession ( REFSEQ-accession )  */
+        case df_fasta1 : rc = vdb_fasta1_loop( fctx ); /* <--- */
+                         break;
+
+         /* one FASTA-record ( many lines ) for each REFERENCE used in a cSRA-database  */
+        case df_fasta2 : rc = vdb_fasta2_loop( fctx ); /* <--- */
+                         break;
+
+        /* one QUAL-record ( 2 liner ) per whole READ/SPOT */
+        case df_qual :  rc = vdb_qual_spot_loop( fctx ); /* <--- */
+                         break;
+
+        /* one QUAL-record ( 2 liner ) per FRAGMENT/ALIGNMENTT */
+        case df_qual1 :  rc = vdb_qual_loop( fctx ); /* <--- */
+                         break;
+
+        default : break;
+    }
+    return rc;
+}
+
+typedef struct vdf_mt_data {
+    fastq_ctx fctx;     /* a copy of the main fastq-ctx, with its own cursor and iterator */
+    vdf_mt mt;
+} vdf_mt_data;
+
+static rc_t CC vdf_mt_produce( struct ordered_worker * self, uint32_t worker_id,
+                               uint32_t num_workers, void * data ) {
+    vdf_mt_data * d = data;
+    rc_t rc;
+    d -> mt . self = self;
+    d -> mt . worker_id = worker_id;
+    d -> mt . num_workers = num_workers;
+    d -> fctx . mt = &( d -> mt );
+    d -> fctx . cursor = NULL;
+    rc = vdb_prepare_cursor( &( d -> fctx ) );
+    DISP_RC( rc, "vdf_mt_produce().vdb_prepare_cursor() failed" );
+    if ( 0 == rc ) {
+        rc = vdb_fastq_rows( &( d -> fctx ) );
+        if ( 0 == rc && NULL != d -> mt . chunk ) {
+            /* the last chunk of this worker */
+            rc = vdmt_deliver( self, d -> mt . chunk ); /* vdb-dump-threads.c */
+            d -> mt . chunk = NULL;
+        }
+        vdmt_release_chunk( d -> mt . chunk ); /* only in case of an error */
+        d -> mt . chunk = NULL;
+        rc = vdh_vcursor_release( rc, d -> fctx . cursor );
+    }
+    return rc;
+}
+
+/*************************************************************************************
+    multi-threaded dump ( --threads ):
+    * the selected rows are cut into chunks of VDF_MT_CHUNK_ROWS rows
+    * each worker has its own cursor and iterator and formats the rows of its chunks
+    * the chunks are written in order ( vdb-dump-threads.c ), the output is the same
+      as the single-threaded one
+    * fasta1/fasta2 records span many rows, these formats stay single-threaded
+*************************************************************************************/
+static rc_t vdb_fastq_rows_mt( const p_dump_context ctx, const fastq_ctx * fctx ) {
+    rc_t rc = 0;
+    uint32_t num_workers = ctx -> num_threads;
+    if ( df_fasta1 == fctx -> format || df_fasta2 == fctx -> format ) {
+        LOGMSG( klogWarn, "--threads ignored: a fasta1/fasta2 record spans many rows" );
+        num_workers = 1;
+    } else {
+        uint64_t count = 0;
+        const struct num_gen_iter * iter;
+        rc = num_gen_iterator_make( ctx -> rows, &iter );
+        DISP_RC( rc, "vdb_fastq_rows_mt().num_gen_iterator_make() failed" );
+        if ( 0 == rc ) {
+            rc = num_gen_iterator_count( iter, &count );
+            DISP_RC( rc, "vdb_fastq_rows_mt().num_gen_iterator_count() failed" );
+            num_gen_iterator_destroy( iter );
+        }
+        if ( 0 == rc ) {
+            /* no need for more workers than chunks */
+            uint64_t num_chunks = ( count + VDF_MT_CHUNK_ROWS - 1 ) / VDF_MT_CHUNK_ROWS;
+            if ( num_chunks < num_workers ) {
+                num_workers = ( uint32_t )num_chunks;
+            }
+        }
+    }
+    if ( 0 == rc ) {
+        if ( num_workers < 2 ) {
+            rc = vdb_fastq_rows( fctx );
+        } else {
+            vdf_mt_data * mt = calloc( num_workers, sizeof * mt );
+            void ** data = calloc( num_workers, sizeof * data );
+            if ( NULL == mt || NULL == data ) {
+                rc = RC( rcExe, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+            } else {
+                uint32_t i;
+                for ( i = 0; 0 == rc && i < num_workers; ++i ) {
+                    mt[ i ] . fctx = *fctx;
+                    data[ i ] = &( mt[ i ] );
+                    /* each worker has its own iterator over the selected rows */
+                    rc = num_gen_iterator_make( ctx -> rows, &( mt[ i ] . fctx . row_iter ) );
+                    DISP_RC( rc, "vdb_fastq_rows_mt().num_gen_iterator_make() failed" );
+                    if ( 0 != rc ) {
+                        mt[ i ] . fctx . row_iter = NULL;
+                    }
+                }
+                if ( 0 == rc ) {
+                    rc = vdmt_run( num_workers, vdf_mt_produce, data ); /* vdb-dump-threads.c */
+                }
+                for ( i = 0; i < num_workers; ++i ) {
+                    if ( NULL != mt[ i ] . fctx . row_iter ) {
+                        num_gen_iterator_destroy( mt[ i ] . fctx . row_iter );
                     }
                 }
             }
+            free( ( void * )data );
+            free( ( void * )mt );
         }
-        rc = KOutMsg( "\n" );
     }
     return rc;
 }
@@ -774,36 +972,10 @@ static rc_t vdb_fastq_tbl( const p_dump_context ctx, fastq_ctx * fctx ) {
                         if ( 0 == fctx -> max_line_len ) {
                             fctx -> max_line_len = DEF_FASTA_LEN;
                         }    
-                        switch( fctx -> format ) {
-                            /* one FASTQ-record ( 4 liner ) per READ/SPOT */
-                            case df_fastq : rc = vdb_fastq_loop( fctx ); /* <--- */
-                                             break;
-
-                            /* one FASTQ-record ( 4 liner ) per FRAGMENT/ALIGNMENT */
-                            case df_fastq1 : rc = vdb_fastq1_loop( fctx ); /* <--- */
-                                              break;
-
-                            /* one FASTA-record ( 2 liner ) per READ/SPOT */
-                            case df_fasta :  rc = vdb_fasta_loop( fctx ); /* <--- */
-                                             break;
-
-                             /* one FASTA-record ( many lines ) for the whole accession ( REFSEQ-accession )  */
-                            case df_fasta1 : rc = vdb_fasta1_loop( fctx ); /* <--- */
-                                             break;
-
-                             /* one FASTA-record ( many lines ) for each REFERENCE used in a cSRA-database  */
-                            case df_fasta2 : rc = vdb_fasta2_loop( fctx ); /* <--- */
-                                             break;
-
-                            /* one QUAL-record ( 2 liner ) per whole READ/SPOT */
-                            case df_qual :  rc = vdb_qual_spot_loop( fctx ); /* <--- */
-                                             break;
-
-                            /* one QUAL-record ( 2 liner ) per FRAGMENT/ALIGNMENTT */
-                            case df_qual1 :  rc = vdb_qual_loop( fctx ); /* <--- */
-                                             break;
-
-                            default : break;
+                        if ( ctx -> num_threads > 1 ) {
+                            rc = vdb_fastq_rows_mt( ctx, fctx );
+                        } else {
+                            rc = vdb_fastq_rows( fctx );
                         }
                         num_gen_iterator_destroy( fctx -> row_iter );
                     }
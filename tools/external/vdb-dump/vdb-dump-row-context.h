@@ -44,6 +44,8 @@ extern "C" {
         - a pointer to the column-definitions (Vector of column-definition's)
         - a pointer to the dump-context ( parameters and options for cmd-line )
         - a dump-string (structure not pointer!) to be reused to assemble output
+        - a pointer to a dump-string that collects the output of a row, if this is
+          NULL the output goes directly to KOutMsg() ( multi-threaded dump )
         - a Vector containing p_col_data - pointers
         - a return-type to stop if reading data failed ( neccessary to stop after
           last row if no row-range is given at command-line )
@@ -58,6 +60,7 @@ typedef struct row_context
     p_col_defs col_defs;
     p_dump_context ctx;     /* vdb-dump-context.h */
     dump_str s_col;
+    p_dump_str out;
     int64_t row_id;
     uint32_t col_nr;
     rc_t rc;
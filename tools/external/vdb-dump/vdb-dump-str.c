@@ -34,6 +34,7 @@
 #include <kfs/file.h>
 
 #include <sysalloc.h>
+#include <bitstr.h>
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -245,6 +246,77 @@ rc_t vds_append_str_no_limit_check( p_dump_str s, const char *s1 )
 }
 
 
+rc_t vds_append_vfmt_no_limit_check( p_dump_str s, const char *fmt, va_list args )
+{
+    rc_t rc;
+    size_t num_writ = 0;
+    va_list args2;
+
+    if ( ( NULL == s ) || ( NULL == fmt ) )
+    {
+        return RC( rcVDB, rcNoTarg, rcInserting, rcParam, rcNull );
+    }
+
+    /* we may need a second attempt, after growing the buffer */
+    va_copy( args2, args );
+    rc = string_vprintf( s -> buf + s -> str_len, s -> buf_size - s -> str_len, &num_writ, fmt, args );
+    if ( GetRCState( rc ) == rcInsufficient )
+    {
+        /* num_writ contains now the needed size */
+        rc = vds_inc_buffer( s, num_writ );
+        if ( 0 == rc )
+        {
+            rc = string_vprintf( s -> buf + s -> str_len, s -> buf_size - s -> str_len, &num_writ, fmt, args2 );
+        }
+    }
+    va_end( args2 );
+    if ( 0 == rc )
+    {
+        s -> str_len += num_writ;
+    }
+    return rc;
+}
+
+
+rc_t vds_append_bytes( p_dump_str s, const void *src, const size_t len )
+{
+    rc_t rc;
+    if ( ( NULL == s ) || ( NULL == src ) )
+    {
+        return RC( rcVDB, rcNoTarg, rcInserting, rcParam, rcNull );
+    }
+    rc = vds_inc_buffer( s, len );
+    if ( 0 == rc )
+    {
+        memmove( s -> buf + s -> str_len, src, len );
+        s -> str_len += len;
+        s -> buf[ s -> str_len ] = 0;
+    }
+    return rc;
+}
+
+
+rc_t vds_append_bits( p_dump_str s, const void *src, const size_t bit_offset, const size_t bit_count )
+{
+    rc_t rc;
+    size_t len = ( bit_count + 7 ) >> 3;
+    if ( ( NULL == s ) || ( NULL == src ) )
+    {
+        return RC( rcVDB, rcNoTarg, rcInserting, rcParam, rcNull );
+    }
+    rc = vds_inc_buffer( s, len );
+    if ( 0 == rc )
+    {
+        char * dst = s -> buf + s -> str_len;
+        memset( dst, 0, len );
+        bitcpy( dst, 0, src, bit_offset, bit_count );
+        s -> str_len += len;
+        s -> buf[ s -> str_len ] = 0;
+    }
+    return rc;
+}
+
+
 rc_t vds_rinsert( p_dump_str s, const char *s1 )
 {
     size_t len;
@@ -38,6 +38,8 @@ extern "C" {
 #include <klib/rc.h>
 #include <klib/namelist.h>
 
+#include <stdarg.h>
+
 typedef struct dump_str
 {
     char *buf;
@@ -76,6 +78,16 @@ rc_t vds_append_str( p_dump_str s, const char *s1 );
 /* appends the string, does not truncate */
 rc_t vds_append_str_no_limit_check( p_dump_str s, const char *s1 );
 
+/* appends the formated string with a va_list, does not truncate */
+rc_t vds_append_vfmt_no_limit_check( p_dump_str s, const char *fmt, va_list args );
+
+/* appends raw bytes ( may contain 0-bytes ), does not truncate */
+rc_t vds_append_bytes( p_dump_str s, const void *src, const size_t len );
+
+/* appends bit_count bits starting at bit_offset, padded with 0-bits
+   to whole bytes, does not truncate */
+rc_t vds_append_bits( p_dump_str s, const void *src, const size_t bit_offset, const size_t bit_count );
+
 /* right-inserts the string at the end of the ev. limited string */
 rc_t vds_rinsert( p_dump_str s, const char *s1 );
 
@@ -0,0 +1,116 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "vdb-dump-threads.h"
+
+#include <klib/out.h>
+#include <klib/log.h>
+
+#include <sysalloc.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#define DISP_RC(rc,err) (void)((0 == rc) ? 0 : LOGERR( klogInt, rc, err ))
+
+/* initial size of a chunk-buffer */
+#define VDMT_CHUNK_INC ( 64 * 1024 )
+
+rc_t vdmt_make_chunk( p_dump_str * chunk )
+{
+    rc_t rc;
+    p_dump_str res = malloc( sizeof * res );
+    if ( NULL == res )
+    {
+        rc = RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    }
+    else
+    {
+        rc = vds_make( res, 0, VDMT_CHUNK_INC ); /* vdb-dump-str.c */
+        if ( 0 != rc )
+        {
+            free( ( void * )res );
+            res = NULL;
+        }
+    }
+    *chunk = res;
+    return rc;
+}
+
+void vdmt_release_chunk( p_dump_str chunk )
+{
+    if ( NULL != chunk )
+    {
+        vds_free( chunk );
+        free( ( void * )chunk );
+    }
+}
+
+rc_t vdmt_deliver( struct ordered_worker * self, p_dump_str chunk )
+{
+    return ordered_worker_deliver( self, chunk, true ); /* ordered_workers.c */
+}
+
+rc_t vdmt_write_chunk( const p_dump_str chunk )
+{
+    rc_t rc = 0;
+    if ( chunk -> str_len > 0 )
+    {
+        /* the chunk can contain NULs ( -f bin ), it is written by length */
+        KWrtWriter writer = KOutWriterGet();
+        size_t num_writ;
+        if ( NULL == writer )
+        {
+            num_writ = fwrite( chunk -> buf, 1, chunk -> str_len, stdout );
+        }
+        else
+        {
+            rc = writer( KOutDataGet(), chunk -> buf, chunk -> str_len, &num_writ );
+        }
+        if ( 0 == rc && num_writ != chunk -> str_len )
+        {
+            rc = RC( rcVDB, rcNoTarg, rcWriting, rcTransfer, rcIncomplete );
+        }
+        DISP_RC( rc, "vdmt_write_chunk() failed" );
+    }
+    return rc;
+}
+
+static rc_t CC vdmt_consume( void * item, void * data )
+{
+    return vdmt_write_chunk( item );
+}
+
+static void CC vdmt_release( void * item )
+{
+    vdmt_release_chunk( item );
+}
+
+rc_t vdmt_run( uint32_t num_workers, vdmt_produce_fn produce, void ** data )
+{
+    return ordered_workers_run( num_workers, produce, data,
+                                vdmt_consume, NULL, vdmt_release ); /* ordered_workers.c */
+}
@@ -0,0 +1,78 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_vdb_dump_threads_
+#define _h_vdb_dump_threads_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _h_klib_defs_
+#include <klib/defs.h>
+#endif
+
+#include <klib/rc.h>
+
+#include "vdb-dump-str.h"
+
+#include "ordered_workers.h"
+
+/*************************************************************************************
+    ordered output of chunks produced by multiple worker-threads:
+        - the output is cut into chunks numbered 0, 1, 2 ...
+        - worker #n produces the chunks n, n + N, n + 2N ... ( N = number of workers )
+          in ascending order and hands each finished chunk to vdmt_deliver()
+        - the calling thread collects the chunks round-robin from the workers and
+          writes them in their original order via the current KOut-writer
+          ( that respects --output-file, --gzip, --bzip2 ... )
+        - the threads and queues are the ones of ordered_workers.c ( shared )
+*************************************************************************************/
+
+/* the function running in every worker-thread */
+typedef ordered_workers_produce_fn vdmt_produce_fn;
+
+/* creates an empty chunk, to be filled and handed over to vdmt_deliver() */
+rc_t vdmt_make_chunk( p_dump_str * chunk );
+
+/* releases a chunk that has not been handed over to vdmt_deliver(), NULL is ok */
+void vdmt_release_chunk( p_dump_str chunk );
+
+/* hands a finished chunk over to the writer, takes ownership of the chunk */
+rc_t vdmt_deliver( struct ordered_worker * self, p_dump_str chunk );
+
+/* writes a chunk via the current KOut-writer ( for output outside of vdmt_run() ) */
+rc_t vdmt_write_chunk( const p_dump_str chunk );
+
+/* starts num_workers threads running produce( data[ worker_id ] ),
+   writes the produced chunks in order and returns after all threads are done */
+rc_t vdmt_run( uint32_t num_workers, vdmt_produce_fn produce, void ** data );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -64,6 +64,8 @@
 #include "vdb_info.h"
 #include "vdb-dump-view-spec.h"
 #include "vdb-dump-inspect.h"
+#include "vdb-dump-threads.h"
+#include "vdb-dump-bin.h"
 
 static const char * row_id_on_usage[]           = { "print row id",                                 NULL };
 static const char * line_feed_usage[]           = { "line-feed's inbetween rows",                   NULL };
@@ -105,6 +107,7 @@ static const char * gzip_usage[]                = { "compress output using gzip"
 static const char * bzip2_usage[]               = { "compress output using bzip2",                  NULL };
 static const char * outbuf_size_usage[]         = { "size of output-buffer, 0...none",              NULL };
 static const char * disable_mt_usage[]          = { "disable multithreading",                       NULL };
+static const char * threads_usage[]             = { "number of threads formatting rows",            NULL };
 static const char * info_usage[]                = { "print info about run",                         NULL };
 static const char * spotgroup_usage[]           = { "show spotgroups",                              NULL };
 static const char * merge_ranges_usage[]        = { "merge and sort row-ranges",                    NULL };
@@ -161,6 +164,7 @@ OptDef DumpOptions[] =
     { OPTION_BZIP2,                 NULL,                     NULL, bzip2_usage,             1, false,  false },
     { OPTION_OUT_BUF_SIZE,          NULL,                     NULL, outbuf_size_usage,       1, true,   false },
     { OPTION_NO_MULTITHREAD,        NULL,                     NULL, disable_mt_usage,        1, false,  false },
+    { OPTION_THREADS,               NULL,                     NULL, threads_usage,           1, true,   false },
     { OPTION_INFO,                  NULL,                     NULL, info_usage,              1, false,  false },
     { OPTION_SPOTGROUPS,            NULL,                     NULL, spotgroup_usage,         1, false,  false },
     { OPTION_MERGE_RANGES,          NULL,                     NULL, merge_ranges_usage,      1, false,  false },
@@ -232,7 +236,8 @@ rc_t CC Usage ( const Args * args )
     KOutMsg( "      fasta1 .. one FASTA-record for the whole accession (REFSEQ)\n" );
     KOutMsg( "      fasta2 .. one FASTA-record for each REFERENCE in cSRA\n" );
     KOutMsg( "      qual .... QUAL( 2 lines ) for each row\n" );
-    KOutMsg( "      qual1 ... QUAL( 2 lines ) for each fragment if possible\n\n" );
+    KOutMsg( "      qual1 ... QUAL( 2 lines ) for each fragment if possible\n" );
+    KOutMsg( "      bin ..... binary, typed columns in row-groups ( tables only )\n\n" );
     HelpOptionLine ( ALIAS_ID_RANGE,            OPTION_ID_RANGE,        NULL,           id_range_usage );
     HelpOptionLine ( ALIAS_WITHOUT_SRA,         OPTION_WITHOUT_SRA,     NULL,           without_sra_usage );
     HelpOptionLine ( ALIAS_EXCLUDED_COLUMNS,    OPTION_EXCLUDED_COLUMNS,"columns",      excluded_columns_usage );
@@ -255,6 +260,7 @@ rc_t CC Usage ( const Args * args )
     HelpOptionLine ( NULL,                      OPTION_BZIP2,           NULL,           bzip2_usage );
     HelpOptionLine ( NULL,                      OPTION_OUT_BUF_SIZE,    "size",         outbuf_size_usage );
     HelpOptionLine ( NULL,                      OPTION_NO_MULTITHREAD,  NULL,           disable_mt_usage );
+    HelpOptionLine ( NULL,                      OPTION_THREADS,         "count",        threads_usage );
     HelpOptionLine ( NULL,                      OPTION_INFO,            NULL,           info_usage );
     HelpOptionLine ( NULL,                      OPTION_SPOTGROUPS,      NULL,           spotgroup_usage );
     HelpOptionLine ( NULL,                      OPTION_MERGE_RANGES,    NULL,           merge_ranges_usage );
@@ -403,17 +409,58 @@ static void vdm_row_error( const char * fmt, rc_t rc, uint64_t row_id ) {
     PLOGERR( klogInt, ( klogInt, rc, fmt, "row_nr=%lu", row_id ) );
 }
 
+/*************************************************************************************
+    dump_one_row:
+    * set the row-id into the cursor and open the cursor-row
+    * loop throuh the columns
+    * close the row
+    * call print_row (vdb-dump-formats.c) which actually prints the row
+
+r_ctx   [IN] ... row-context ( cursor, dump_context, col_defs, row_id ... )
+first   [IN] ... is this the first row of the output ( for json )
+last    [IN] ... is this the last row of the output ( for json )
+*************************************************************************************/
+static void vdm_dump_one_row( p_row_context r_ctx, bool first, bool last ) {
+    r_ctx -> rc = VCursorSetRowId( r_ctx -> cursor, r_ctx -> row_id );
+    if ( 0 != r_ctx -> rc ) {
+        vdm_row_error( "vdm_dump_rows().VCursorSetRowId( row#$(row_nr) ) failed",
+                    r_ctx -> rc, r_ctx -> row_id ); /* above */
+    } else {
+        r_ctx -> rc = VCursorOpenRow( r_ctx -> cursor );
+        if ( 0 != r_ctx -> rc ) {
+            vdm_row_error( "vdm_dump_rows().VCursorOpenRow( row#$(row_nr) ) failed",
+                        r_ctx -> rc, r_ctx -> row_id ); /* above */
+        } else {
+            /* first reset the string and valid-flag for every column */
+            vdcd_reset_content( r_ctx -> col_defs );
+            /* read the data of every column and create a string for it */
+            VectorForEach( &( r_ctx -> col_defs -> cols ), false, vdm_read_cell_data, r_ctx );
+            if ( 0 == r_ctx -> rc ) {
+                /* prints the collected strings, in vdb-dump-formats.c */
+                if ( !r_ctx -> ctx -> sum_num_elem ) {
+                    r_ctx -> rc = vdfo_print_row( r_ctx, first, last ); /* in vdb-dump-formats.c */
+                    if ( 0 != r_ctx -> rc ) {
+                        vdm_row_error( "vdm_dump_rows().vdfo_print_row( row#$(row_nr) ) failed",
+                            r_ctx -> rc, r_ctx -> row_id ); /* above */
+                    }
+                }
+            }
+            r_ctx -> rc = VCursorCloseRow( r_ctx -> cursor );
+            if ( 0 != r_ctx -> rc ) {
+                vdm_row_error( "vdm_dump_rows().VCursorCloseRow( row#$(row_nr) ) failed",
+                            r_ctx -> rc, r_ctx -> row_id ); /* above */
+            }
+        }
+    }
+}
+
 /*************************************************************************************
     dump_rows:
     * is the main loop to dump all rows or all selected rows ( -R1-10 )
     * creates a dump-string ( parameterizes it with the wanted max. line-len )
     * starts the number-generator
     * as long as the number-generator has a number and the result-code is ok
-      do for every row-id:
-        - set the row-id into the cursor and open the cursor-row
-        - loop throuh the columns
-        - close the row
-        - call print_row (vdb-dump-formats.c) which actually prints the row
+      call dump_one_row() for every row-id
     * the collection of the text's for the columns "read_cell_data_and_dump()"
       is separated from the actual printing "print_row()" !
 
@@ -423,6 +470,12 @@ static rc_t vdm_dump_rows( p_row_context r_ctx ) {
     /* the important row_id is a member of r_ctx ! */
     const struct num_gen_iter * iter;
 
+    if ( df_bin == r_ctx -> ctx -> format ) {
+        ErrMsg( "the binary format is only available for tables" );
+        r_ctx -> rc = RC( rcExe, rcFormatter, rcWriting, rcFormat, rcUnsupported );
+        return r_ctx -> rc;
+    }
+    r_ctx -> out = NULL; /* print directly via KOutMsg() */
     r_ctx -> rc = vds_make( &( r_ctx -> s_col ), r_ctx -> ctx->max_line_len, 512 ); /* vdb-dump-str.sh */
     DISP_RC( r_ctx -> rc, "vdm_dump_rows().vds_make() failed" );
     if ( 0 == r_ctx -> rc ) {
@@ -440,39 +493,7 @@ static rc_t vdm_dump_rows( p_row_context r_ctx ) {
                         r_ctx -> rc = Quitting();
                     }
                     if ( 0 != r_ctx -> rc ) break;
-                    r_ctx -> rc = VCursorSetRowId( r_ctx -> cursor, r_ctx -> row_id );
-                    if ( 0 != r_ctx -> rc ) {
-                        vdm_row_error( "vdm_dump_rows().VCursorSetRowId( row#$(row_nr) ) failed",
-                                    r_ctx -> rc, r_ctx -> row_id ); /* above */
-                    } else {
-                        r_ctx -> rc = VCursorOpenRow( r_ctx -> cursor );
-                        if ( 0 != r_ctx -> rc ) {
-                            vdm_row_error( "vdm_dump_rows().VCursorOpenRow( row#$(row_nr) ) failed",
-                                        r_ctx -> rc, r_ctx -> row_id ); /* above */
-                        } else {
-                            /* first reset the string and valid-flag for every column */
-                            vdcd_reset_content( r_ctx -> col_defs );
-                            /* read the data of every column and create a string for it */
-                            VectorForEach( &( r_ctx -> col_defs -> cols ), false, vdm_read_cell_data, r_ctx );
-                            if ( 0 == r_ctx -> rc ) {
-                                /* prints the collected strings, in vdb-dump-formats.c */
-                                if ( !r_ctx -> ctx -> sum_num_elem ) {
-                                    bool first = ( 0 == num );
-                                    bool last  = ( num >= count - 1 );
-                                    r_ctx -> rc = vdfo_print_row( r_ctx, first, last ); /* in vdb-dump-formats.c */
-                                    if ( 0 != r_ctx -> rc ) {
-                                        vdm_row_error( "vdm_dump_rows().vdfo_print_row( row#$(row_nr) ) failed",
-                                            r_ctx -> rc, r_ctx -> row_id ); /* above */
-                                    }
-                                }
-                            }
-                            r_ctx -> rc = VCursorCloseRow( r_ctx -> cursor );
-                            if ( 0 != r_ctx -> rc ) {
-                                vdm_row_error( "vdm_dump_rows().VCursorCloseRow( row#$(row_nr) ) failed",
-                                            r_ctx -> rc, r_ctx -> row_id ); /* above */
-                            }
-                        }
-                    }
+                    vdm_dump_one_row( r_ctx, ( 0 == num ), ( num >= count - 1 ) ); /* above */
                     num += 1;
                 } /* while( ... ) */
             }
@@ -582,8 +603,7 @@ static uint32_t vdm_extract_or_parse_columns_view( const p_dump_context ctx,
 }
 
 /*************************************************************************************
-    dump_tab_table:
-    * called by "dump_db_table()" and "dump_tab()" as a fkt-pointer
+    open_table_row_ctx:
     * opens a cursor to read
     * checks if the user did not specify columns, or wants all columns ( "*" )
         no columns specified ---> calls "col_defs_extract_from_table()"
@@ -591,32 +611,34 @@ static uint32_t vdm_extract_or_parse_columns_view( const p_dump_context ctx,
     * we end up with a list of column-definitions (name,type) in col_defs
     * calls "col_defs_add_to_cursor()" to add them to the cursor
     * opens the cursor
-    * calls "dump_rows()" to execute the dump
-    * destroys the col_defs - structure
-    * releases the cursor
+    * on success the caller has to destroy r_ctx -> col_defs and release r_ctx -> cursor
 
-ctx [IN] ... contains path, tablename, columns, row-range etc.
-tbl [IN] ... open table needed for vdb-calls
+ctx   [IN]  ... contains path, tablename, columns, row-range etc.
+tbl   [IN]  ... open table needed for vdb-calls
+r_ctx [OUT] ... row-context with cursor and col_defs
 *************************************************************************************/
-static rc_t vdm_dump_opened_table( const p_dump_context ctx, const VTable *tbl ) {
-    row_context r_ctx;
-    rc_t rc = VTableCreateCachedCursorRead( tbl, &( r_ctx . cursor ), ctx -> cur_cache_size );
-    r_ctx . last_rc = 0;
+static rc_t vdm_open_table_row_ctx( const p_dump_context ctx, const VTable *tbl,
+                                    p_row_context r_ctx, uint32_t * invalid_columns ) {
+    rc_t rc = VTableCreateCachedCursorRead( tbl, &( r_ctx -> cursor ), ctx -> cur_cache_size );
+    r_ctx -> last_rc = 0;
+    r_ctx -> col_defs = NULL;
     DISP_RC( rc, "VTableCreateCursorRead() failed" );
     if ( 0 == rc ) {
-        r_ctx . table = tbl;
-        r_ctx . view = NULL;
-        if ( !vdcd_init( &( r_ctx . col_defs ), ctx -> max_line_len ) ) {
+        r_ctx -> table = tbl;
+        r_ctx -> view = NULL;
+        r_ctx -> ctx = ctx;
+        r_ctx -> out = NULL;
+        if ( !vdcd_init( &( r_ctx -> col_defs ), ctx -> max_line_len ) ) {
+            r_ctx -> col_defs = NULL;
             rc = RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
             DISP_RC( rc, "col_defs_init() failed" );
         }
         if ( 0 == rc ) {
-            uint32_t invalid_columns = 0;
-            uint32_t n = vdm_extract_or_parse_columns( ctx, tbl, r_ctx . col_defs, &invalid_columns );
+            uint32_t n = vdm_extract_or_parse_columns( ctx, tbl, r_ctx -> col_defs, invalid_columns );
             if ( n < 1 ) {
                 rc = RC( rcVDB, rcNoTarg, rcConstructing, rcParam, rcInvalid );
             } else {
-                n = vdcd_add_to_cursor( r_ctx . col_defs, r_ctx . cursor );
+                n = vdcd_add_to_cursor( r_ctx -> col_defs, r_ctx -> cursor );
                 if ( n < 1 ) {
                     rc = RC( rcVDB, rcNoTarg, rcConstructing, rcParam, rcInvalid );
                 } else {
@@ -628,54 +650,410 @@ static rc_t vdm_dump_opened_table( const p_dump_context ctx, const VTable *tbl )
                         DISP_RC( rc2, "VTableOpenSchema() failed" );
                         if ( 0 == rc2 ) {
                             /* translate in special columns to numeric values to strings */
-                            vdcd_ins_trans_fkt( r_ctx . col_defs, schema );
+                            vdcd_ins_trans_fkt( r_ctx -> col_defs, schema );
                             vdh_vschema_release( rc, schema );
                         }
                     }
-                    rc = VCursorOpen( r_ctx . cursor );
+                    rc = VCursorOpen( r_ctx -> cursor );
                     DISP_RC( rc, "VCursorOpen() failed" );
+                }
+            }
+        }
+        if ( 0 != rc ) {
+            vdcd_destroy( r_ctx -> col_defs );
+            r_ctx -> col_defs = NULL;
+            rc = vdh_vcursor_release( rc, r_ctx -> cursor );
+            r_ctx -> cursor = NULL;
+        }
+    }
+    return rc;
+}
+
+/*************************************************************************************
+    multi-threaded dump of rows ( --threads N ):
+    * the selected rows are cut into chunks of VDM_MT_CHUNK_ROWS rows
+    * every worker opens its own cursor and column-definitions on the table
+    * worker #n formats the chunks n, n + N, n + 2N ... into its own buffers
+    * the main-thread writes the chunks in order ( vdb-dump-threads.c )
+    * because the same formatting-code is used, the output is identical to
+      the single-threaded dump
+*************************************************************************************/
+#define VDM_MT_CHUNK_ROWS 1024
+
+typedef struct vdm_mt_data {
+    const VTable * tbl;
+    p_dump_context ctx;
+    const struct num_gen_iter * iter;   /* made by the main-thread, one per worker */
+    uint64_t count;                     /* number of selected rows */
+    rc_t last_rc;                       /* last forgiven cell-read-error of this worker */
+} vdm_mt_data;
+
+static rc_t CC vdm_mt_produce( struct ordered_worker * self, uint32_t worker_id,
+                               uint32_t num_workers, void * data ) {
+    vdm_mt_data * mt = data;
+    row_context r_ctx;
+    uint32_t invalid_columns = 0;
+    rc_t rc = vdm_open_table_row_ctx( mt -> ctx, mt -> tbl, &r_ctx, &invalid_columns ); /* above */
+    if ( 0 == rc ) {
+        r_ctx . rc = vds_make( &( r_ctx . s_col ), mt -> ctx -> max_line_len, 512 ); /* vdb-dump-str.c */
+        DISP_RC( r_ctx . rc, "vdm_mt_produce().vds_make() failed" );
+        if ( 0 == r_ctx . rc ) {
+            uint64_t num = 0;
+            p_dump_str chunk = NULL;
+            while ( ( 0 == r_ctx . rc ) &&
+                    num_gen_iterator_next( mt -> iter, &( r_ctx . row_id ), &( r_ctx . rc ) ) ) {
+                /* we skip over the rows of the chunks of the other workers */
+                if ( 0 == r_ctx . rc && ( ( num / VDM_MT_CHUNK_ROWS ) % num_workers ) == worker_id ) {
+                    bool last = ( num >= mt -> count - 1 );
+                    r_ctx . rc = Quitting();
+                    if ( 0 == r_ctx . rc && NULL == chunk ) {
+                        r_ctx . rc = vdmt_make_chunk( &chunk ); /* vdb-dump-threads.c */
+                        r_ctx . out = chunk;
+                    }
+                    if ( 0 == r_ctx . rc ) {
+                        vdm_dump_one_row( &r_ctx, ( 0 == num ), last ); /* above */
+                    }
+                    if ( 0 == r_ctx . rc && ( last || ( VDM_MT_CHUNK_ROWS - 1 ) == ( num % VDM_MT_CHUNK_ROWS ) ) ) {
+                        /* the chunk is complete: hand it over to the writer */
+                        r_ctx . rc = vdmt_deliver( self, chunk ); /* vdb-dump-threads.c */
+                        chunk = NULL;
+                        r_ctx . out = NULL;
+                    }
+                }
+                num += 1;
+            }
+            vdmt_release_chunk( chunk ); /* only in case of an error */
+            vds_free( &( r_ctx . s_col ) ); /* vdb-dump-str.c */
+        }
+        rc = r_ctx . rc;
+        mt -> last_rc = r_ctx . last_rc;
+        vdcd_destroy( r_ctx . col_defs );
+        rc = vdh_vcursor_release( rc, r_ctx . cursor );
+    }
+    return rc;
+}
+
+static rc_t vdm_dump_rows_mt( p_row_context r_ctx ) {
+    uint32_t num_workers = r_ctx -> ctx -> num_threads;
+    uint64_t count = 0;
+    const struct num_gen_iter * iter;
+    rc_t rc = num_gen_iterator_make( r_ctx -> ctx -> rows, &iter );
+    DISP_RC( rc, "vdm_dump_rows_mt().num_gen_iterator_make() failed" );
+    if ( 0 == rc ) {
+        rc = num_gen_iterator_count( iter, &count );
+        DISP_RC( rc, "vdm_dump_rows_mt().num_gen_iterator_count() failed" );
+        num_gen_iterator_destroy( iter );
+    }
+    if ( 0 == rc ) {
+        /* no need for more workers than chunks */
+        uint64_t num_chunks = ( count + VDM_MT_CHUNK_ROWS - 1 ) / VDM_MT_CHUNK_ROWS;
+        if ( num_chunks < num_workers ) {
+            num_workers = ( uint32_t )num_chunks;
+        }
+        if ( num_workers < 2 ) {
+            rc = vdm_dump_rows( r_ctx ); /* above */
+        } else {
+            vdm_mt_data * mt = calloc( num_workers, sizeof * mt );
+            void ** data = calloc( num_workers, sizeof * data );
+            if ( NULL == mt || NULL == data ) {
+                rc = RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+            } else {
+                uint32_t i;
+                for ( i = 0; 0 == rc && i < num_workers; ++i ) {
+                    mt[ i ] . tbl = r_ctx -> table;
+                    mt[ i ] . ctx = r_ctx -> ctx;
+                    mt[ i ] . count = count;
+                    data[ i ] = &( mt[ i ] );
+                    /* each worker has its own iterator over the selected rows */
+                    rc = num_gen_iterator_make( r_ctx -> ctx -> rows, &( mt[ i ] . iter ) );
+                    DISP_RC( rc, "vdm_dump_rows_mt().num_gen_iterator_make() failed" );
+                }
+                if ( 0 == rc ) {
+                    rc = vdmt_run( num_workers, vdm_mt_produce, data ); /* vdb-dump-threads.c */
+                }
+                for ( i = 0; i < num_workers; ++i ) {
+                    if ( NULL != mt[ i ] . iter ) {
+                        num_gen_iterator_destroy( mt[ i ] . iter );
+                    }
+                    if ( 0 != mt[ i ] . last_rc ) {
+                        r_ctx -> last_rc = mt[ i ] . last_rc;
+                    }
+                }
+            }
+            free( ( void * )data );
+            free( ( void * )mt );
+        }
+    }
+    return rc;
+}
+
+/*************************************************************************************
+    binary columnar dump ( -f bin, layout in vdb-dump-bin.h ):
+    * the main-thread writes the header, derived from the column-definitions
+    * the selected rows are cut into row-groups of VDM_BIN_GROUP_ROWS rows
+    * the workers ( --threads ) fill the row-groups column by column, the cell-data
+      is copied as is from VCursorCellDataDirect() without any formatting
+    * the row-groups are written in order ( vdb-dump-threads.c ), then the trailer
+*************************************************************************************/
+#define VDM_BIN_GROUP_ROWS ( 16 * 1024 )
+
+static bool vdm_bin_col_wanted( const p_col_def col_def ) {
+    return ( NULL != col_def && col_def -> valid && !col_def -> excluded );
+}
+
+static rc_t vdm_bin_read_cells( p_row_context r_ctx, vdbb_group * group ) {
+    rc_t rc = vdbb_group_add_row( group, r_ctx -> row_id ); /* vdb-dump-bin.c */
+    uint32_t i, col_nr = 0;
+    uint32_t n = VectorLength( &( r_ctx -> col_defs -> cols ) );
+    for ( i = 0; 0 == rc && i < n; ++i ) {
+        p_col_def col_def = VectorGet( &( r_ctx -> col_defs -> cols ), i );
+        if ( vdm_bin_col_wanted( col_def ) ) {
+            uint32_t elem_bits = 0, boff = 0, row_len = 0;
+            const void * base = NULL;
+            rc_t rc2 = VCursorCellDataDirect( r_ctx -> cursor, r_ctx -> row_id, col_def -> idx,
+                                              &elem_bits, &base, &boff, &row_len );
+            if ( 0 != rc2 ) {
+                PLOGERR( klogInt,
+                         ( klogInt, rc2,
+                         "VCursorCellDataDirect( col:$(col_name) at row #$(row_nr) ) failed",
+                         "col_name=%s,row_nr=%lu",
+                         col_def -> name, r_ctx -> row_id ) );
+                /* remember the last error, but be forgiving like the text-formats */
+                r_ctx -> last_rc = rc2;
+                base = NULL;
+            }
+            rc = vdbb_group_add_cell( group, col_nr++, base, boff, elem_bits, row_len ); /* vdb-dump-bin.c */
+        }
+    }
+    return rc;
+}
+
+static uint32_t vdm_bin_col_count( const p_col_defs col_defs ) {
+    uint32_t i, res = 0;
+    uint32_t n = VectorLength( &( col_defs -> cols ) );
+    for ( i = 0; i < n; ++i ) {
+        if ( vdm_bin_col_wanted( VectorGet( &( col_defs -> cols ), i ) ) ) {
+            res++;
+        }
+    }
+    return res;
+}
+
+static rc_t vdm_bin_deliver_group( struct ordered_worker * self, vdbb_group * group ) {
+    p_dump_str chunk;
+    rc_t rc = vdmt_make_chunk( &chunk ); /* vdb-dump-threads.c */
+    if ( 0 == rc ) {
+        rc = vdbb_group_write( group, chunk ); /* vdb-dump-bin.c */
+        if ( 0 == rc ) {
+            rc = vdmt_deliver( self, chunk ); /* takes ownership of the chunk */
+        } else {
+            vdmt_release_chunk( chunk );
+        }
+    }
+    vdbb_group_clear( group );
+    return rc;
+}
+
+static rc_t CC vdm_bin_produce( struct ordered_worker * self, uint32_t worker_id,
+                                uint32_t num_workers, void * data ) {
+    vdm_mt_data * mt = data;
+    row_context r_ctx;
+    uint32_t invalid_columns = 0;
+    rc_t rc = vdm_open_table_row_ctx( mt -> ctx, mt -> tbl, &r_ctx, &invalid_columns ); /* above */
+    if ( 0 == rc ) {
+        vdbb_group group;
+        rc = vdbb_group_init( &group, vdm_bin_col_count( r_ctx . col_defs ) ); /* vdb-dump-bin.c */
+        if ( 0 == rc ) {
+            uint64_t num = 0;
+            while ( ( 0 == rc ) &&
+                    num_gen_iterator_next( mt -> iter, &( r_ctx . row_id ), &rc ) ) {
+                /* we skip over the rows of the row-groups of the other workers */
+                if ( 0 == rc && ( ( num / VDM_BIN_GROUP_ROWS ) % num_workers ) == worker_id ) {
+                    rc = Quitting();
                     if ( 0 == rc ) {
-                        int64_t  first;
-                        uint64_t count;
-                        rc = VCursorIdRange( r_ctx . cursor, 0, &first, &count );
-                        DISP_RC( rc, "VCursorIdRange() failed" );
-                        if ( 0 == rc ) {
-                            if ( NULL == ctx -> rows ) {
-                                /* if the user did not specify a row-range, take all rows */
-                                rc = num_gen_make_from_range( &( ctx -> rows ), first, count );
-                                DISP_RC( rc, "num_gen_make_from_range() failed" );
-                            } else {
-                                /* if the user did specify a row-range, check the boundaries */
-                                if ( count > 0 ) {
-                                    /* trim only if the row-range is not zero, otherwise
-                                        we will not get data if the user specified only static columns
-                                        because they report a row-range of zero! */
-                                    rc = num_gen_trim( ctx -> rows, first, count );
-                                    DISP_RC( rc, "num_gen_trim() failed" );
-                                }
-                            }
-                            if ( 0 == rc ) {
-                                if ( num_gen_empty( ctx -> rows ) ) {
-                                    rc = RC( rcExe, rcDatabase, rcReading, rcRange, rcEmpty );
-                                } else {
-                                    r_ctx . ctx = ctx;
-                                    rc = vdm_dump_rows( &r_ctx ); /* <--- */
-                                }
-                            }
-                        }
+                        rc = vdm_bin_read_cells( &r_ctx, &group ); /* above */
+                    }
+                    if ( 0 == rc &&
+                         ( num >= mt -> count - 1 || ( VDM_BIN_GROUP_ROWS - 1 ) == ( num % VDM_BIN_GROUP_ROWS ) ) ) {
+                        rc = vdm_bin_deliver_group( self, &group ); /* above */
                     }
                 }
+                num += 1;
             }
-            if ( 0 == rc && invalid_columns > 0 ) {
-                rc = RC( rcExe, rcDatabase, rcResolving, rcColumn, rcInvalid );
+            vdbb_group_free( &group );
+        }
+        mt -> last_rc = r_ctx . last_rc;
+        vdcd_destroy( r_ctx . col_defs );
+        rc = vdh_vcursor_release( rc, r_ctx . cursor );
+    }
+    return rc;
+}
+
+static rc_t vdm_bin_write_header( const p_col_defs col_defs ) {
+    rc_t rc = 0;
+    uint32_t num_cols = vdm_bin_col_count( col_defs );
+    vdbb_col_desc * descs = calloc( num_cols > 0 ? num_cols : 1, sizeof * descs );
+    if ( NULL == descs ) {
+        rc = RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    } else {
+        dump_str header;
+        uint32_t i, col_nr = 0;
+        uint32_t n = VectorLength( &( col_defs -> cols ) );
+        for ( i = 0; i < n; ++i ) {
+            p_col_def col_def = VectorGet( &( col_defs -> cols ), i );
+            if ( vdm_bin_col_wanted( col_def ) ) {
+                vdbb_col_desc * desc = &( descs[ col_nr++ ] );
+                desc -> name = col_def -> name;
+                desc -> domain = col_def -> type_desc . domain;
+                desc -> intrinsic_bits = col_def -> type_desc . intrinsic_bits;
+                desc -> intrinsic_dim = col_def -> type_desc . intrinsic_dim;
             }
-            vdcd_destroy( r_ctx . col_defs );
         }
+        rc = vds_make( &header, 0, 1024 ); /* vdb-dump-str.c */
+        if ( 0 == rc ) {
+            rc = vdbb_write_header( &header, num_cols, descs ); /* vdb-dump-bin.c */
+            if ( 0 == rc ) {
+                rc = vdmt_write_chunk( &header ); /* vdb-dump-threads.c */
+            }
+            vds_free( &header );
+        }
+        free( ( void * )descs );
+    }
+    return rc;
+}
+
+static rc_t vdm_bin_write_trailer( void ) {
+    dump_str trailer;
+    rc_t rc = vds_make( &trailer, 0, 16 ); /* vdb-dump-str.c */
+    if ( 0 == rc ) {
+        rc = vdbb_write_trailer( &trailer ); /* vdb-dump-bin.c */
+        if ( 0 == rc ) {
+            rc = vdmt_write_chunk( &trailer ); /* vdb-dump-threads.c */
+        }
+        vds_free( &trailer );
+    }
+    return rc;
+}
+
+static rc_t vdm_dump_rows_bin( p_row_context r_ctx ) {
+    uint32_t num_workers = r_ctx -> ctx -> num_threads;
+    uint64_t count = 0;
+    const struct num_gen_iter * iter;
+    rc_t rc = num_gen_iterator_make( r_ctx -> ctx -> rows, &iter );
+    DISP_RC( rc, "vdm_dump_rows_bin().num_gen_iterator_make() failed" );
+    if ( 0 == rc ) {
+        rc = num_gen_iterator_count( iter, &count );
+        DISP_RC( rc, "vdm_dump_rows_bin().num_gen_iterator_count() failed" );
+        num_gen_iterator_destroy( iter );
+    }
+    if ( 0 == rc ) {
+        rc = vdm_bin_write_header( r_ctx -> col_defs ); /* above */
+        DISP_RC( rc, "vdm_dump_rows_bin().vdm_bin_write_header() failed" );
+    }
+    if ( 0 == rc ) {
+        /* no need for more workers than row-groups, but we need at least one */
+        uint64_t num_groups = ( count + VDM_BIN_GROUP_ROWS - 1 ) / VDM_BIN_GROUP_ROWS;
+        if ( num_groups < num_workers ) {
+            num_workers = ( uint32_t )num_groups;
+        }
+        if ( num_workers < 1 ) {
+            num_workers = 1;
+        }
+        {
+            vdm_mt_data * mt = calloc( num_workers, sizeof * mt );
+            void ** data = calloc( num_workers, sizeof * data );
+            if ( NULL == mt || NULL == data ) {
+                rc = RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+            } else {
+                uint32_t i;
+                for ( i = 0; 0 == rc && i < num_workers; ++i ) {
+                    mt[ i ] . tbl = r_ctx -> table;
+                    mt[ i ] . ctx = r_ctx -> ctx;
+                    mt[ i ] . count = count;
+                    data[ i ] = &( mt[ i ] );
+                    rc = num_gen_iterator_make( r_ctx -> ctx -> rows, &( mt[ i ] . iter ) );
+                    DISP_RC( rc, "vdm_dump_rows_bin().num_gen_iterator_make() failed" );
+                }
+                if ( 0 == rc ) {
+                    rc = vdmt_run( num_workers, vdm_bin_produce, data ); /* vdb-dump-threads.c */
+                }
+                for ( i = 0; i < num_workers; ++i ) {
+                    if ( NULL != mt[ i ] . iter ) {
+                        num_gen_iterator_destroy( mt[ i ] . iter );
+                    }
+                    if ( 0 != mt[ i ] . last_rc ) {
+                        r_ctx -> last_rc = mt[ i ] . last_rc;
+                    }
+                }
+            }
+            free( ( void * )data );
+            free( ( void * )mt );
+        }
+    }
+    if ( 0 == rc ) {
+        /* a missing trailer tells the reader that the output is incomplete */
+        rc = vdm_bin_write_trailer(); /* above */
+    }
+    return rc;
+}
+
+/*************************************************************************************
+    dump_tab_table:
+    * called by "dump_db_table()" and "dump_tab()" as a fkt-pointer
+    * opens a cursor and the column-definitions via "open_table_row_ctx()"
+    * trims the requested row-range to the row-range of the table
+    * calls "dump_rows()" or "dump_rows_mt()" to execute the dump
+    * destroys the col_defs - structure
+    * releases the cursor
+
+ctx [IN] ... contains path, tablename, columns, row-range etc.
+tbl [IN] ... open table needed for vdb-calls
+*************************************************************************************/
+static rc_t vdm_dump_opened_table( const p_dump_context ctx, const VTable *tbl ) {
+    row_context r_ctx;
+    uint32_t invalid_columns = 0;
+    rc_t rc = vdm_open_table_row_ctx( ctx, tbl, &r_ctx, &invalid_columns ); /* above */
+    if ( 0 == rc ) {
+        int64_t  first;
+        uint64_t count;
+        rc = VCursorIdRange( r_ctx . cursor, 0, &first, &count );
+        DISP_RC( rc, "VCursorIdRange() failed" );
+        if ( 0 == rc ) {
+            if ( NULL == ctx -> rows ) {
+                /* if the user did not specify a row-range, take all rows */
+                rc = num_gen_make_from_range( &( ctx -> rows ), first, count );
+                DISP_RC( rc, "num_gen_make_from_range() failed" );
+            } else {
+                /* if the user did specify a row-range, check the boundaries */
+                if ( count > 0 ) {
+                    /* trim only if the row-range is not zero, otherwise
+                        we will not get data if the user specified only static columns
+                        because they report a row-range of zero! */
+                    rc = num_gen_trim( ctx -> rows, first, count );
+                    DISP_RC( rc, "num_gen_trim() failed" );
+                }
+            }
+            if ( 0 == rc ) {
+                if ( num_gen_empty( ctx -> rows ) ) {
+                    rc = RC( rcExe, rcDatabase, rcReading, rcRange, rcEmpty );
+                } else if ( df_bin == ctx -> format ) {
+                    rc = vdm_dump_rows_bin( &r_ctx ); /* <--- */
+                } else if ( ctx -> num_threads > 1 && !ctx -> sum_num_elem ) {
+                    rc = vdm_dump_rows_mt( &r_ctx ); /* <--- */
+                } else {
+                    rc = vdm_dump_rows( &r_ctx ); /* <--- */
+                }
+            }
+        }
+        vdcd_destroy( r_ctx . col_defs );
         rc = vdh_vcursor_release( rc, r_ctx . cursor );
         if ( 0 == rc && 0 != r_ctx . last_rc ) {
             rc = r_ctx . last_rc;
         }
     }
+    if ( 0 == rc && invalid_columns > 0 ) {
+        rc = RC( rcExe, rcDatabase, rcResolving, rcColumn, rcInvalid );
+    }
     return rc;
 }
 
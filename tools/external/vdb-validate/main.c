@@ -136,6 +136,11 @@ static const char *USAGE_SDC_SEQ_ROWS[] =
 static const char *USAGE_SDC_PLEN_THOLD[] =
 { "Specify a threshold for amount of secondary alignment which are shorter (hard-clipped) than corresponding primaries, default 1%.", NULL };
 
+#define OPTION_THREADS "threads"
+static const char *USAGE_THREADS[] =
+{ "Number of threads for the consistency and referential integrity checks "
+  "(default: 1)", NULL };
+
 #define OPTION_NGC "ngc"
 static const char *USAGE_NGC[] = { "path to ngc file", NULL };
 
@@ -161,6 +166,7 @@ static OptDef options [] =
   , { OPTION_REF_INT , ALIAS_REF_INT , NULL, USAGE_REF_INT , 1, true , false }
   , { OPTION_CNS_CHK , ALIAS_CNS_CHK , NULL, USAGE_CNS_CHK , 1, true , false }
   , { OPTION_NGC     , NULL          , NULL, USAGE_NGC     , 1, true , false }
+  , { OPTION_THREADS , NULL          , NULL, USAGE_THREADS , 1, true , false }
 
     /* secondary alignment table data check options */
   , { OPTION_SDC_SEC_ROWS, NULL      , NULL, USAGE_SDC_SEC_ROWS, 1, true , false }
@@ -225,6 +231,7 @@ rc_t CC Usage ( const Args * args )
     HelpOptionLine(NULL          , OPTION_SDC_SEQ_ROWS, "rows"    , USAGE_SDC_SEQ_ROWS);
     HelpOptionLine(NULL          , OPTION_SDC_PLEN_THOLD, "threshold", USAGE_SDC_PLEN_THOLD);
     HelpOptionLine(NULL          , OPTION_NGC           , "path", USAGE_NGC);
+    HelpOptionLine(NULL          , OPTION_THREADS       , "count", USAGE_THREADS);
 
     HelpOptionLine(NULL          , OPTION_CHECK_REDACT, NULL, USAGE_CHECK_REDACT);
 /*
@@ -266,6 +273,7 @@ rc_t parse_args ( vdb_validate_params *pb, Args *args )
     pb -> sdc_pa_len_thold.percent = 0.01;
 
     pb -> check_redact = false;
+    pb -> threads = 1;
   {
     rc = ArgsOptionCount(args, OPTION_CNS_CHK, &cnt);
     if (rc != 0) {
@@ -537,6 +545,32 @@ rc_t parse_args ( vdb_validate_params *pb, Args *args )
         }
     }
 
+/* OPTION_THREADS */
+    {
+        rc = ArgsOptionCount(args, OPTION_THREADS, &cnt);
+        if (rc != 0) {
+            LOGERR(klogErr, rc, "Failure to get '" OPTION_THREADS "' argument");
+            return rc;
+        }
+        if (cnt != 0) {
+            uint64_t value;
+            rc = ArgsOptionValue(args, OPTION_THREADS, 0, (const void **)&dummy);
+            if (rc != 0) {
+                LOGERR(klogErr, rc,
+                    "Failure to get '" OPTION_THREADS "' argument");
+                return rc;
+            }
+            value = string_to_U64 ( dummy, string_size ( dummy ), &rc );
+            if (rc == 0 && (value == 0 || value > MAX_THREADS))
+                rc = RC(rcExe, rcArgv, rcParsing, rcParam, rcInvalid);
+            if (rc != 0) {
+                LOGERR(klogErr, rc, OPTION_THREADS " has illegal value");
+                return rc;
+            }
+            pb->threads = (unsigned)value;
+        }
+    }
+
 /* OPTION_NGC */
     {
         rc = ArgsOptionCount(args, OPTION_NGC, &cnt);
@@ -647,6 +681,7 @@ static rc_t main_with_args(Args *const args)
                             pb.md5_chk_explicit));
                         STSMSG(2, ("\tblob_crc = %d", pb.blob_crc));
                         STSMSG(2, ("\tconsist_check = %d", pb.consist_check));
+                        STSMSG(2, ("\tthreads = %u", pb.threads));
                         STSMSG(2, ("}"));
                         for ( i = 0; i < pcount; ++ i )
                         {
@@ -52,6 +52,7 @@
 #include <kfs/sra.h>
 #include <kfs/tar.h>
 #include <kfs/file.h> /* KFileRelease */
+#include <kfs/md5.h> /* KMD5SumFmt */
 
 #include <insdc/insdc.h>
 #include <insdc/sra.h>
@@ -69,9 +70,13 @@
 #include <klib/debug.h>
 #include <klib/data-buffer.h>
 #include <klib/sort.h>
+#include <klib/checksum.h> /* MD5State */
+
+#include <kproc/thread.h>
 
 #include <kapp/main.h> /* Quitting */
 
+#include <atomic32.h>
 #include <sysalloc.h>
 
 #include <stdio.h>
@@ -96,6 +101,9 @@
 
 #define SDC_ROW_CHUNK_MAX 8ull*1024ull*1024ull
 
+/* do not split the referential integrity check into smaller parts */
+#define RIC_MIN_ROWS_PER_THREAD (1024ull*1024ull)
+
 #if 0
 #define DBG_MSG(args) KOutMsg args
 #else
@@ -283,9 +291,16 @@ static rc_t report_database(CCReportInfoBlock const *what, cc_context_t *ctx)
 
 static rc_t visiting(CCReportInfoBlock const *what, cc_context_t *ctx)
 {
-    unsigned const nn = ctx->nextNode++;
-    node_t *const nxt = &ctx->nodes[nn];
-    node_t *const cur = nxt - 1;
+    unsigned nn;
+    node_t *nxt;
+    node_t *cur;
+
+    if (ctx->nodes == NULL) /* a worker of the parallel check */
+        return 0;
+
+    nn = ctx->nextNode++;
+    nxt = &ctx->nodes[nn];
+    cur = nxt - 1;
 
     nxt->parent = nxt->prvSibl = nxt->nxtSibl = nxt->firstChild = -1;
     nxt->depth = what->info.visit.depth;
@@ -342,9 +357,313 @@ static rc_t CC report(CCReportInfoBlock const *what, void *Ctx)
     }
 }
 
+/* parallel consistency check of a database:
+ * the objects of the database are listed here and every one of them is handed
+ * to a worker thread with a context of its own:
+ *  - the files of the database itself are checked against its md5-file,
+ *  - a table is checked by KTableConsistencyCheck,
+ *  - a sub-database is checked by KDatabaseConsistencyCheck.
+ * Only the objects directly below the database show up in the node-tree.
+ */
+typedef enum cc_job_kind_e {
+    ccjDatabaseFiles,
+    ccjTable,
+    ccjDatabase
+} cc_job_kind_t;
+
+typedef struct cc_job_s {
+    cc_job_kind_t kind;
+    KDatabase const *db;
+    KTable const *tbl;
+    char const *name;   /* ccjDatabaseFiles only */
+    uint32_t depth;
+    cc_context_t ctx;   /* nodes == NULL: no tree is built */
+    rc_t rc;
+} cc_job_t;
+
+typedef struct cc_jobs_s {
+    cc_job_t *job;
+    unsigned count;
+    unsigned allocated;
+    uint32_t level;
+    atomic32_t next;
+} cc_jobs_t;
+
+static rc_t cc_jobs_add(cc_jobs_t *jobs, cc_job_kind_t kind,
+    KDatabase const *db, KTable const *tbl, char const name[], uint32_t depth)
+{
+    cc_job_t *job;
+
+    if (jobs->count == jobs->allocated) {
+        unsigned const allocated = jobs->allocated ? jobs->allocated * 2 : 16;
+        void *const temp = realloc(jobs->job, allocated * sizeof(jobs->job[0]));
+
+        if (temp == NULL)
+            return RC(rcExe, rcTable, rcValidating, rcMemory, rcExhausted);
+        jobs->job = temp;
+        jobs->allocated = allocated;
+    }
+    job = &jobs->job[jobs->count];
+    memset(job, 0, sizeof(*job));
+    job->kind = kind;
+    job->db = db;
+    job->tbl = tbl;
+    job->name = name;
+    job->depth = depth;
+    ++jobs->count;
+    return 0;
+}
+
+static void cc_jobs_whack(cc_jobs_t *jobs)
+{
+    unsigned i;
+
+    for (i = 0; i < jobs->count; ++i) {
+        KDatabaseRelease(jobs->job[i].db);
+        KTableRelease(jobs->job[i].tbl);
+    }
+    free(jobs->job);
+}
+
+static rc_t cc_file_md5(KDirectory const *dir, char const path[],
+    uint8_t const expected[16])
+{
+    KFile const *f;
+    rc_t rc = KDirectoryOpenFileRead(dir, &f, "%s", path);
+
+    if (rc == 0) {
+        MD5State md5;
+        uint8_t digest[16];
+        char buf[32 * 1024];
+        uint64_t pos = 0;
+        size_t num_read;
+
+        MD5StateInit(&md5);
+        while ((rc = KFileRead(f, pos, buf, sizeof(buf), &num_read)) == 0
+               && num_read > 0)
+        {
+            MD5StateAppend(&md5, buf, num_read);
+            pos += num_read;
+        }
+        MD5StateFinish(&md5, digest);
+        KFileRelease(f);
+
+        if (rc == 0 && memcmp(digest, expected, sizeof(digest)) != 0)
+            rc = RC(rcExe, rcFile, rcValidating, rcChecksum, rcUnequal);
+    }
+    return rc;
+}
+
+/* the md5-file of a database covers the files of the database itself
+ * ( lock, metadata ), it is parsed by the md5-file reader of kfs */
+static rc_t cc_db_md5(KDatabase const *db, char const name[], cc_context_t *ctx)
+{
+    CCReportInfoBlock nfo;
+    KDirectory const *dir;
+    KFile const *file;
+    rc_t rc = KDatabaseOpenDirectoryRead(db, &dir);
+
+    if (rc)
+        return rc;
+
+    memset(&nfo, 0, sizeof(nfo));
+    nfo.objName = name;
+    nfo.objType = kptDatabase;
+
+    if (KDirectoryOpenFileRead(dir, &file, "md5") != 0) {
+        nfo.type = ccrpt_Done;
+        nfo.info.done.mesg = "missing md5 file";
+        rc = report(&nfo, ctx);
+    }
+    else {
+        KMD5SumFmt const *md5;
+
+        rc = KMD5SumFmtMakeRead(&md5, file);
+        if (rc)
+            KFileRelease(file);
+        else {
+            uint32_t count = 0;
+            uint32_t i;
+
+            rc = KMD5SumFmtCount(md5, &count);
+            for (i = 0; rc == 0 && i < count; ++i) {
+                char path[4096];
+                uint8_t expected[16];
+                bool bin;
+
+                rc = KMD5SumFmtGet(md5, i, path, sizeof(path), expected, &bin);
+                if (rc == 0) {
+                    nfo.type = ccrpt_MD5;
+                    nfo.info.MD5.file = path;
+                    nfo.info.MD5.rc = cc_file_md5(dir, path, expected);
+                    rc = report(&nfo, ctx);
+                }
+            }
+            KMD5SumFmtRelease(md5);
+        }
+    }
+    KDirectoryRelease(dir);
+    return rc;
+}
+
+static rc_t CC cc_worker(KThread const *self, void *data)
+{
+    cc_jobs_t *const jobs = (cc_jobs_t *)data;
+
+    for ( ; ; ) {
+        unsigned const i = (unsigned)atomic32_read_and_add(&jobs->next, 1);
+        cc_job_t *job;
+
+        if (i >= jobs->count)
+            break;
+        job = &jobs->job[i];
+        switch (job->kind) {
+        case ccjDatabaseFiles:
+            job->rc = cc_db_md5(job->db, job->name, &job->ctx);
+            break;
+        case ccjTable:
+            job->rc = KTableConsistencyCheck(job->tbl, job->depth, jobs->level,
+                                             report, &job->ctx);
+            break;
+        case ccjDatabase:
+            job->rc = KDatabaseConsistencyCheck(job->db, job->depth, jobs->level,
+                                                report, &job->ctx);
+            break;
+        }
+        if (job->rc == 0)
+            job->rc = job->ctx.rc;
+        if (job->rc != 0 && !exhaustive) {
+            /* do not start any more objects */
+            atomic32_set(&jobs->next, jobs->count);
+        }
+    }
+    return 0;
+}
+
+/* lists the database itself and the objects directly below it as jobs */
+static rc_t cc_list_db(KDatabase const *db, char const name[],
+    cc_context_t *ctx, cc_jobs_t *jobs)
+{
+    CCReportInfoBlock nfo;
+    KNamelist *list = NULL;
+    uint32_t count = 0;
+    uint32_t i;
+    rc_t rc;
+
+    memset(&nfo, 0, sizeof(nfo));
+    nfo.objName = name;
+    nfo.objType = kptDatabase;
+    nfo.type = ccrpt_Visit;
+    nfo.info.visit.depth = 0;
+    rc = report(&nfo, ctx);
+    if (rc == 0)
+        rc = KDatabaseAddRef(db);
+    if (rc == 0) {
+        rc = cc_jobs_add(jobs, ccjDatabaseFiles, db, NULL, name, 0);
+        if (rc)
+            KDatabaseRelease(db);
+    }
+
+    if (rc == 0 && KDatabaseListTbl(db, &list) == 0) {
+        rc = KNamelistCount(list, &count);
+        for (i = 0; rc == 0 && i < count; ++i) {
+            char const *tname;
+            KTable const *tbl;
+
+            rc = KNamelistGet(list, i, &tname);
+            if (rc == 0) {
+                nfo.objName = tname;
+                nfo.objType = kptTable;
+                nfo.info.visit.depth = 1;
+                rc = report(&nfo, ctx);
+            }
+            if (rc == 0)
+                rc = KDatabaseOpenTableRead(db, &tbl, "%s", tname);
+            if (rc == 0) {
+                rc = cc_jobs_add(jobs, ccjTable, NULL, tbl, NULL, 1);
+                if (rc)
+                    KTableRelease(tbl);
+            }
+        }
+        KNamelistRelease(list);
+    }
+
+    if (rc == 0 && KDatabaseListDB(db, &list) == 0) {
+        rc = KNamelistCount(list, &count);
+        for (i = 0; rc == 0 && i < count; ++i) {
+            char const *dname;
+            KDatabase const *child;
+
+            rc = KNamelistGet(list, i, &dname);
+            if (rc == 0) {
+                nfo.objName = dname;
+                nfo.objType = kptDatabase;
+                nfo.info.visit.depth = 1;
+                rc = report(&nfo, ctx);
+            }
+            if (rc == 0)
+                rc = KDatabaseOpenDBRead(db, &child, "%s", dname);
+            if (rc == 0) {
+                rc = cc_jobs_add(jobs, ccjDatabase, child, NULL, NULL, 1);
+                if (rc)
+                    KDatabaseRelease(child);
+            }
+        }
+        KNamelistRelease(list);
+    }
+    return rc;
+}
+
+static rc_t KDatabaseConsistencyCheckParallel(KDatabase const *db,
+    char const name[], uint32_t level, unsigned threads, cc_context_t *ctx)
+{
+    cc_jobs_t jobs;
+    rc_t rc;
+
+    memset(&jobs, 0, sizeof(jobs));
+    jobs.level = level;
+    atomic32_set(&jobs.next, 0);
+
+    rc = cc_list_db(db, name, ctx, &jobs);
+    if (rc == 0) {
+        KThread *thread[MAX_THREADS];
+        unsigned started = 0;
+        unsigned i;
+
+        if (threads > jobs.count)
+            threads = jobs.count;
+        for (i = 0; i < threads; ++i) {
+            if (KThreadMake(&thread[i], cc_worker, &jobs) != 0)
+                break;
+            ++started;
+        }
+        if (started == 0 && jobs.count > 0)
+            cc_worker(NULL, &jobs); /* no threads: do it here */
+        for (i = 0; i < started; ++i) {
+            rc_t status;
+            KThreadWait(thread[i], &status);
+            KThreadRelease(thread[i]);
+        }
+
+        /* merge in the order of the objects */
+        for (i = 0; i < jobs.count; ++i) {
+            cc_job_t const *job = &jobs.job[i];
+
+            ctx->num_columns += job->ctx.num_columns;
+            if (ctx->rc == 0)
+                ctx->rc = job->ctx.rc;
+            if (rc == 0)
+                rc = job->rc;
+        }
+    }
+    cc_jobs_whack(&jobs);
+    return rc;
+}
+
 static
 rc_t kdbcc ( const KDBManager *mgr, char const name[], uint32_t mode,
-    KPathType *pathType, bool is_file, node_t nodes[], char names[] )
+    KPathType *pathType, bool is_file, node_t nodes[], char names[],
+    unsigned threads )
 {
     rc_t rc = 0;
     cc_context_t ctx;
@@ -381,7 +700,10 @@ rc_t kdbcc ( const KDBManager *mgr, char const name[], uint32_t mode,
         rc = KDBManagerOpenDBRead ( mgr, & db, "%s", name );
         if ( rc == 0 )
         {
-            rc = KDatabaseConsistencyCheck ( db, 0, level, report, & ctx );
+            if ( threads > 1 && ! s_IndexOnly )
+                rc = KDatabaseConsistencyCheckParallel ( db, name, level, threads, & ctx );
+            else
+                rc = KDatabaseConsistencyCheck ( db, 0, level, report, & ctx );
             if ( rc == 0 )
             {
                 rc = ctx.rc;
@@ -1182,9 +1504,10 @@ typedef struct id_pair_s {
     int64_t second;
 } id_pair_t;
 
-static size_t work_chunk(uint64_t const count)
+/* ways: the number of threads sharing the memory_suggestion */
+static size_t work_chunk(uint64_t const count, unsigned const ways)
 {
-    size_t const max = memory_suggestion / (sizeof(id_pair_t));
+    size_t const max = memory_suggestion / (sizeof(id_pair_t)) / ways;
     size_t chunk = (size_t)count;
 
 #if 1
@@ -1429,10 +1752,133 @@ static rc_t ric_align_generic(int64_t const startId,
     return 0;
 }
 
+typedef struct ric_worker_s {
+    KThread *thread;
+    VCursor const *acurs;
+    VCursor const *bcurs;
+    ColumnInfo aci;
+    ColumnInfo bci;
+    int64_t startId;
+    uint64_t count;
+    size_t pairs;
+    id_pair_t *pair;
+    void *scratch;
+    bool own_cursors;
+} ric_worker_t;
+
+static rc_t CC ric_align_worker(KThread const *self, void *data)
+{
+    ric_worker_t *const w = (ric_worker_t *)data;
+
+    return ric_align_generic(w->startId, w->count, w->pairs, w->pair,
+                             &w->scratch, w->acurs, &w->aci, w->bcurs, &w->bci);
+}
+
+static rc_t ric_open_cursor(VTable const *tbl, ColumnInfo *ci, VCursor const **curs)
+{
+    rc_t rc = VTableCreateCursorRead(tbl, curs);
+    if (rc == 0)
+        rc = VCursorAddColumn(*curs, &ci->idx, "%s", ci->name);
+    if (rc == 0)
+        rc = VCursorOpen(*curs);
+    return rc;
+}
+
+/* Runs the referential integrity check over the rows of the a-table.
+ * With more than one thread the id-range is split into independent parts,
+ * each thread loads, sorts and checks its part with cursors of its own,
+ * the pair-buffers of all threads together stay within memory_suggestion.
+ * The first failing part ( in id-order ) decides the result.
+ */
+static rc_t ric_align_run(unsigned threads,
+                          int64_t const startId,
+                          uint64_t const count,
+                          VTable const *atbl,
+                          VCursor const *const acurs,
+                          ColumnInfo *const aci,
+                          VTable const *btbl,
+                          VCursor const *const bcurs,
+                          ColumnInfo *const bci)
+{
+    ric_worker_t *worker;
+    uint64_t const part = RIC_MIN_ROWS_PER_THREAD;
+    unsigned started = 0;
+    unsigned i;
+    rc_t rc = 0;
+
+    if (threads > MAX_THREADS)
+        threads = MAX_THREADS;
+    if (threads > count / part)
+        threads = (unsigned)(count / part);
+    if (threads == 0)
+        threads = 1;
+
+    worker = calloc(threads, sizeof(worker[0]));
+    if (worker == NULL)
+        return RC(rcExe, rcDatabase, rcValidating, rcMemory, rcExhausted);
+
+    for (i = 0; i < threads && rc == 0; ++i) {
+        ric_worker_t *const w = &worker[i];
+        uint64_t const first = (count / threads) * i;
+
+        w->startId = startId + first;
+        w->count = (i + 1 == threads) ? count - first : count / threads;
+        w->aci = *aci;
+        w->bci = *bci;
+        w->pairs = work_chunk(w->count, threads);
+        w->pair = malloc(sizeof(id_pair_t) * w->pairs);
+        if (w->pair == NULL)
+            rc = RC(rcExe, rcDatabase, rcValidating, rcMemory, rcExhausted);
+        else if (i == 0) {
+            w->acurs = acurs;
+            w->bcurs = bcurs;
+        }
+        else {
+            /* cursors are not shared between threads */
+            w->own_cursors = true;
+            rc = ric_open_cursor(atbl, &w->aci, &w->acurs);
+            if (rc == 0)
+                rc = ric_open_cursor(btbl, &w->bci, &w->bcurs);
+        }
+    }
+
+    if (rc == 0 && threads == 1)
+        rc = ric_align_worker(NULL, &worker[0]);
+    else if (rc == 0) {
+        for (i = 0; i < threads && rc == 0; ++i) {
+            rc = KThreadMake(&worker[i].thread, ric_align_worker, &worker[i]);
+            if (rc == 0)
+                ++started;
+        }
+        for (i = 0; i < started; ++i) {
+            rc_t status = 0;
+            rc_t const rc2 = KThreadWait(worker[i].thread, &status);
+
+            if (rc == 0)
+                rc = rc2 ? rc2 : status;
+            KThreadRelease(worker[i].thread);
+        }
+    }
+
+    for (i = 0; i < threads; ++i) {
+        ric_worker_t *const w = &worker[i];
+
+        if (w->own_cursors) {
+            VCursorRelease(w->acurs);
+            VCursorRelease(w->bcurs);
+        }
+        free(w->scratch);
+        free(w->pair);
+    }
+    free(worker);
+    return rc;
+}
+
 static rc_t ric_align_ref_and_align(char const dbname[],
                                     VTable const *ref,
                                     VTable const *align,
-                                    int which)
+                                    int which,
+                                    unsigned threads)
 {
     char const *const id_col_name = which == 0 ? "PRIMARY_ALIGNMENT_IDS"
                                   : which == 1 ? "SECONDARY_ALIGNMENT_IDS"
@@ -1470,39 +1916,26 @@ static rc_t ric_align_ref_and_align(char const dbname[],
 									"reference table can not be read", "name=%s", dbname));
 	}
 	if (rc == 0) {
-        size_t const chunk = work_chunk(count);
-        id_pair_t *const pair = (id_pair_t *)malloc(sizeof(id_pair_t) * chunk);
-
-        if (pair) {
-            void *scratch = NULL;
-
-            rc = ric_align_generic(startId, count, chunk, pair, &scratch,
-                                   acurs, &aci, bcurs, &bci);
-            if (scratch)
-                free(scratch);
-
-            if (GetRCObject(rc) == (enum RCObject)rcData && GetRCState(rc) == rcUnexpected)
-                (void)PLOGERR(klogErr, (klogErr, rc,
-                                        "Database '$(name)': failed referential "
-                                        "integrity check", "name=%s", dbname));
-            else if (GetRCObject(rc) == (enum RCObject)rcData &&
-                     GetRCState(rc) == rcInconsistent)
-                (void)PLOGERR(klogErr, (klogErr, rc,
-                                        "Database '$(name)': column '$(idcol)' failed referential integrity check",
-                                        "name=%s,idcol=%s", dbname, id_col_name));
-            else if (GetRCObject(rc) == (enum RCObject)rcData &&
-                     GetRCState(rc) == rcTooBig)
-                (void)PLOGERR(klogWarn, (klogWarn, rc = 0, "Database '$(name)':"
-                                         " referential integrity could not be checked, skipped",
-                                         "name=%s", dbname));
-            else if (rc)
-                (void)PLOGERR(klogErr, (klogErr, rc,
-                                        "Database '$(name)': reference table can not be read", "name=%s", dbname));
+        rc = ric_align_run(threads, startId, count, align, acurs, &aci,
+                           ref, bcurs, &bci);
 
-            free(pair);
-        }
-        else
-            rc = RC(rcExe, rcDatabase, rcValidating, rcMemory, rcExhausted);
+        if (GetRCObject(rc) == (enum RCObject)rcData && GetRCState(rc) == rcUnexpected)
+            (void)PLOGERR(klogErr, (klogErr, rc,
+                                    "Database '$(name)': failed referential "
+                                    "integrity check", "name=%s", dbname));
+        else if (GetRCObject(rc) == (enum RCObject)rcData &&
+                 GetRCState(rc) == rcInconsistent)
+            (void)PLOGERR(klogErr, (klogErr, rc,
+                                    "Database '$(name)': column '$(idcol)' failed referential integrity check",
+                                    "name=%s,idcol=%s", dbname, id_col_name));
+        else if (GetRCObject(rc) == (enum RCObject)rcData &&
+                 GetRCState(rc) == rcTooBig)
+            (void)PLOGERR(klogWarn, (klogWarn, rc = 0, "Database '$(name)':"
+                                     " referential integrity could not be checked, skipped",
+                                     "name=%s", dbname));
+        else if (rc && !(GetRCObject(rc) == rcMemory && GetRCState(rc) == rcExhausted))
+            (void)PLOGERR(klogErr, (klogErr, rc,
+                                    "Database '$(name)': reference table can not be read", "name=%s", dbname));
 
         if (GetRCObject(rc) == rcMemory && GetRCState(rc) == rcExhausted) {
             rc = 0;
@@ -1518,7 +1951,8 @@ static rc_t ric_align_ref_and_align(char const dbname[],
 
 static rc_t ric_align_seq_and_pri(char const dbname[],
                                   VTable const *seq,
-                                  VTable const *pri)
+                                  VTable const *pri,
+                                  unsigned threads)
 {
     rc_t rc;
     VCursor const *acurs = NULL;
@@ -1552,41 +1986,27 @@ static rc_t ric_align_seq_and_pri(char const dbname[],
                 "sequence table can not be read", "name=%s", dbname));
     }
     if (rc == 0) {
-        size_t const chunk = work_chunk(count);
-        id_pair_t *const pair = (id_pair_t *)malloc((sizeof(id_pair_t)+sizeof(int64_t)) * chunk);
-
-        if (pair) {
-            void *scratch = NULL;
+        rc = ric_align_run(threads, startId, count, pri, acurs, &aci,
+                           seq, bcurs, &bci);
 
-            rc = ric_align_generic(startId, count, chunk, pair, &scratch,
-                                   acurs, &aci, bcurs, &bci);
-            if (scratch)
-                free(scratch);
-
-            if (GetRCObject(rc) == (enum RCObject)rcData && GetRCState(rc) == rcUnexpected)
-                (void)PLOGERR(klogErr, (klogErr, rc,
-                    "Database '$(name)': failed referential "
-                    "integrity check", "name=%s", dbname));
-            else if (GetRCObject(rc) == (enum RCObject)rcData &&
-                     GetRCState(rc) == rcInconsistent)
-                (void)PLOGERR(klogErr, (klogErr, rc,
+        if (GetRCObject(rc) == (enum RCObject)rcData && GetRCState(rc) == rcUnexpected)
+            (void)PLOGERR(klogErr, (klogErr, rc,
+                "Database '$(name)': failed referential "
+                "integrity check", "name=%s", dbname));
+        else if (GetRCObject(rc) == (enum RCObject)rcData &&
+                 GetRCState(rc) == rcInconsistent)
+            (void)PLOGERR(klogErr, (klogErr, rc,
 "Database '$(name)': column 'SEQ_SPOT_ID' failed referential integrity check",
 "name=%s", dbname));
-            else if (GetRCObject(rc) == (enum RCObject)rcData &&
-                     GetRCState(rc) == rcTooBig)
-                (void)PLOGERR(klogWarn, (klogWarn, rc = 0, "Database '$(name)':"
-                         " referential integrity could not be checked, skipped",
-                         "name=%s", dbname));
-            else if (rc)
-                (void)PLOGERR(klogErr, (klogErr, rc,
-"Database '$(name)': sequence table can not be read", "name=%s", dbname));
-
-            free(pair);
-        }
-        else
+        else if ((GetRCObject(rc) == (enum RCObject)rcData &&
+                  GetRCState(rc) == rcTooBig) ||
+                 (GetRCObject(rc) == rcMemory && GetRCState(rc) == rcExhausted))
             (void)PLOGERR(klogWarn, (klogWarn, rc = 0, "Database '$(name)':"
-                         " referential integrity could not be checked, skipped",
-                         "name=%s", dbname));
+                     " referential integrity could not be checked, skipped",
+                     "name=%s", dbname));
+        else if (rc)
+            (void)PLOGERR(klogErr, (klogErr, rc,
+"Database '$(name)': sequence table can not be read", "name=%s", dbname));
     }
     VCursorRelease(acurs);
     VCursorRelease(bcurs);
@@ -2149,7 +2569,7 @@ static rc_t dbric_align(const vdb_validate_params *pb,
     rc_t rc = 0;
 
     if ((rc == 0 || exhaustive) && (pri != NULL && seq != NULL)) {
-        rc_t rc2 = ric_align_seq_and_pri(dbname, seq, pri);
+        rc_t rc2 = ric_align_seq_and_pri(dbname, seq, pri, pb->threads);
 
         if (rc2 == 0) {
             (void)PLOGMSG(klogInfo, (klogInfo, "Database '$(dbname)': "
@@ -2161,7 +2581,7 @@ static rc_t dbric_align(const vdb_validate_params *pb,
         }
     }
     if ((rc == 0 || exhaustive) && (pri != NULL && ref != NULL)) {
-        rc_t rc2 = ric_align_ref_and_align(dbname, ref, pri, 0);
+        rc_t rc2 = ric_align_ref_and_align(dbname, ref, pri, 0, pb->threads);
 
         if (rc2 == 0) {
             (void)PLOGMSG(klogInfo, (klogInfo, "Database '$(dbname)': "
@@ -2413,7 +2833,7 @@ rc_t dbcc ( const vdb_validate_params *pb, const char *path, bool is_file )
                       ;
         /* check as kdb object */
         if ( rc == 0 )
-            rc = kdbcc ( pb -> kmgr, path, mode, & pathType, is_file, nodes, names );
+            rc = kdbcc ( pb -> kmgr, path, mode, & pathType, is_file, nodes, names, pb -> threads );
         if ( rc == 0 )
             rc = vdbcc ( pb -> vmgr, path, mode, & pathType, is_file );
         if ( rc == 0 )
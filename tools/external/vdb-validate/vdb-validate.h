@@ -33,6 +33,8 @@ extern bool md5_required;
 extern bool ref_int_check;
 extern bool s_IndexOnly;
 
+#define MAX_THREADS 64
+
 typedef struct vdb_validate_params vdb_validate_params;
 struct vdb_validate_params
 {
@@ -48,6 +50,9 @@ struct vdb_validate_params
     bool exhaustive;
     bool check_redact;
 
+    // worker threads for the consistency and referential-integrity checks
+    unsigned threads;
+
     // data integrity checks parameters
     bool sdc_enabled;
     bool sdc_sec_rows_in_percent;
@@ -941,6 +941,33 @@ rc_t ccat_md5 ( CCTree *tree, const KFile *sf, KTime_t mtime,
     if ( no_md5 )
         return ccat_sz ( tree, sf, mtime, ntype, node, name );
 
+    /* with hashing threads, no formatter is needed */
+    if ( hash_threads > 0 )
+    {
+        const KFile *md5;
+
+        rc = CCHashFileMakeRead ( & md5, sf, node -> _md5 );
+        if ( rc != 0 )
+            PLOGERR ( klogInt,  (klogInt, rc, "failed to create md5 wrapper for '$(path)'", "path=%s", name ));
+        else
+        {
+            rc = ccat_sz ( tree, md5, mtime, ntype, node, name );
+
+            /* waits for the hash and writes the digest into the node */
+            orc = KFileRelease ( md5 );
+            if (orc)
+            {
+                PLOGERR (klogInt,
+                         (klogInt, orc,
+                          "failure in calculating md5 for '$(path)'",
+                          "path=%s", name ));
+                if (rc == 0)
+                    rc = orc;
+            }
+        }
+        return rc;
+    }
+
     /* normal md5 path */
     rc = KMD5SumFmtMakeUpdate ( & fmt, fnull );
     if ( rc != 0 )
@@ -0,0 +1,635 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "copycat-priv.h"
+
+#include <klib/log.h>
+#include <klib/rc.h>
+#include <klib/checksum.h>
+#include <kfs/file.h>
+#include <kproc/thread.h>
+#include <kproc/queue.h>
+#include <atomic32.h>
+#include <sysalloc.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ======================================================================
+ * CCHashFile
+ *
+ * a read wrapper that calculates the MD5 of everything read through it,
+ * the same way as the MD5 wrapper from kfs does.
+ *
+ * the first CC_HASH_INLINE bytes are kept back. if the file ends there,
+ * they go to a pool of threads shared by all small files and members, and
+ * the digest is written into the node later, CCHashShutdown waits for it.
+ * so the many small files of a submission are hashed concurrently, while
+ * the reading thread catalogs and inserts them in their original order.
+ * past CC_HASH_INLINE, if one of the hashing threads is free, the data are
+ * copied into blocks from a pool shared by all hashing files and hashed by
+ * a thread of its own, while the reading thread goes on with decompressing
+ * and parsing.
+ */
+typedef struct CCHashFile CCHashFile;
+#define KFILE_IMPL struct CCHashFile
+#include <kfs/impl.h>
+
+#define CC_HASH_INLINE      ( 1024 * 1024 )
+#define CC_HASH_BLOCK_SIZE  ( 256 * 1024 )
+#define CC_HASH_BLOCKS      8   /* per thread, shared by all */
+#define CC_HASH_QUEUE       4   /* filled blocks waiting per file */
+#define CC_HASH_PENDING     16  /* small files waiting per pool thread */
+
+typedef struct CCHashBlock
+{
+    size_t size;
+    uint8_t data [ CC_HASH_BLOCK_SIZE ];
+} CCHashBlock;
+
+/* the bytes of a small file, hashed by the pool */
+typedef struct CCHashJob
+{
+    uint8_t * digest;
+    uint8_t * data;
+    size_t size;
+    size_t allocated;
+} CCHashJob;
+
+static KQueue * free_blocks;        /* the block-pool, NULL if not threaded */
+static uint32_t max_threads;
+static atomic32_t active_threads;
+
+static KQueue * small_files;        /* jobs waiting for the pool, NULL if not threaded */
+static KThread ** pool;
+static uint32_t pool_threads;
+
+struct CCHashFile
+{
+    KFile dad;
+    const KFile * original;
+    uint8_t * digest;           /* receives the MD5 when released */
+    MD5State md5;
+    uint64_t position;          /* all bytes before this are hashed or queued */
+    KThread * thread;           /* NULL while hashing on the reading thread */
+    KQueue * full_blocks;       /* blocks waiting to be hashed by the thread */
+    CCHashBlock * block;        /* the block being filled */
+    CCHashJob * job;            /* the bytes kept back for the pool */
+    rc_t rc;
+};
+
+
+static
+void CCHashJobWhack ( CCHashJob * job )
+{
+    if ( job != NULL )
+    {
+        free ( job -> data );
+        free ( job );
+    }
+}
+
+static
+rc_t CC CCHashPoolThread ( const KThread * t, void * data )
+{
+    rc_t rc;
+
+    for ( ; ; )
+    {
+        void * item;
+
+        rc = KQueuePop ( small_files, & item, NULL );
+        if ( rc != 0 )
+        {
+            /* sealed and empty */
+            if ( GetRCState ( rc ) == rcDone && GetRCObject ( rc ) == ( enum RCObject )rcData )
+                rc = 0;
+            else
+                LOGERR ( klogInt, rc, "failed to receive small file to hash" );
+            break;
+        }
+        else
+        {
+            CCHashJob * job = item;
+            MD5State md5;
+
+            MD5StateInit ( & md5 );
+            MD5StateAppend ( & md5, job -> data, job -> size );
+            MD5StateFinish ( & md5, job -> digest );
+            CCHashJobWhack ( job );
+        }
+    }
+    return rc;
+}
+
+
+/* ----------------------------------------------------------------------
+ * CCHashSetup
+ *  make the block-pool for up to "threads" hashing threads
+ *  and start "threads" pool threads for the small files,
+ *  with 0 everything is hashed on the reading thread
+ */
+rc_t CCHashSetup ( uint32_t threads )
+{
+    rc_t rc = 0;
+    uint32_t ix, count = threads * CC_HASH_BLOCKS;
+
+    atomic32_set ( & active_threads, 0 );
+    max_threads = threads;
+    if ( threads == 0 )
+        return 0;
+
+    rc = KQueueMake ( & small_files, threads * CC_HASH_PENDING );
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "failed to create md5 queue for small files" );
+        return rc;
+    }
+    pool = calloc ( threads, sizeof * pool );
+    if ( pool == NULL )
+        rc = RC ( rcExe, rcThread, rcAllocating, rcMemory, rcExhausted );
+    for ( ix = 0; rc == 0 && ix < threads; ++ix )
+    {
+        rc = KThreadMake ( & pool [ ix ], CCHashPoolThread, NULL );
+        if ( rc == 0 )
+            ++ pool_threads;
+    }
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "failed to start md5 threads for small files" );
+        CCHashShutdown ();
+        return rc;
+    }
+
+    rc = KQueueMake ( & free_blocks, count );
+    if ( rc != 0 )
+        LOGERR ( klogInt, rc, "failed to create md5 block-pool" );
+    for ( ix = 0; rc == 0 && ix < count; ++ix )
+    {
+        CCHashBlock * block = malloc ( sizeof * block );
+        if ( block == NULL )
+            rc = RC ( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+        else
+        {
+            rc = KQueuePush ( free_blocks, block, NULL );
+            if ( rc != 0 )
+                free ( block );
+        }
+        if ( rc != 0 )
+            LOGERR ( klogInt, rc, "failed to fill md5 block-pool" );
+    }
+    if ( rc != 0 )
+        CCHashShutdown ();
+    return rc;
+}
+
+
+/* ----------------------------------------------------------------------
+ * CCHashShutdown
+ *  all hashing files have to be released before,
+ *  waits for the pool to write the digests of the small files
+ */
+rc_t CCHashShutdown ( void )
+{
+    rc_t rc = 0;
+
+    if ( small_files != NULL )
+    {
+        uint32_t ix;
+
+        KQueueSeal ( small_files );
+        for ( ix = 0; ix < pool_threads; ++ix )
+        {
+            rc_t orc, status = 0;
+
+            orc = KThreadWait ( pool [ ix ], & status );
+            if ( rc == 0 )
+                rc = orc != 0 ? orc : status;
+            KThreadRelease ( pool [ ix ] );
+        }
+        KQueueRelease ( small_files );
+        small_files = NULL;
+    }
+    free ( pool );
+    pool = NULL;
+    pool_threads = 0;
+
+    if ( free_blocks != NULL )
+    {
+        void * block;
+
+        KQueueSeal ( free_blocks );
+        while ( KQueuePop ( free_blocks, & block, NULL ) == 0 )
+            free ( block );
+        KQueueRelease ( free_blocks );
+        free_blocks = NULL;
+    }
+    max_threads = 0;
+
+    if ( rc != 0 )
+        LOGERR ( klogInt, rc, "failed to calculate md5 of small files" );
+    return rc;
+}
+
+
+static
+rc_t CC CCHashFileThread ( const KThread * t, void * data )
+{
+    CCHashFile * self = data;
+    rc_t rc;
+
+    for ( ; ; )
+    {
+        void * item;
+
+        rc = KQueuePop ( self -> full_blocks, & item, NULL );
+        if ( rc != 0 )
+        {
+            /* sealed and empty */
+            if ( GetRCState ( rc ) == rcDone && GetRCObject ( rc ) == ( enum RCObject )rcData )
+                rc = 0;
+            else
+                LOGERR ( klogInt, rc, "failed to receive block to hash" );
+            break;
+        }
+        else
+        {
+            CCHashBlock * block = item;
+
+            MD5StateAppend ( & self -> md5, block -> data, block -> size );
+            rc = KQueuePush ( free_blocks, block, NULL );
+            if ( rc != 0 )
+            {
+                LOGERR ( klogInt, rc, "failed to return hashed block" );
+                free ( block );
+                break;
+            }
+        }
+    }
+    return rc;
+}
+
+
+static
+rc_t CCHashFilePushBlock ( CCHashFile * self )
+{
+    rc_t rc = KQueuePush ( self -> full_blocks, self -> block, NULL );
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "failed to queue block to hash" );
+        free ( self -> block );
+    }
+    self -> block = NULL;
+    return rc;
+}
+
+
+/* hand the hashing to a thread of its own, if one is free */
+static
+void CCHashFileStartThread ( CCHashFile * self )
+{
+    if ( free_blocks == NULL ||
+         atomic32_read_and_add_lt ( & active_threads, 1, max_threads ) >= ( int )max_threads )
+        return;
+
+    if ( KQueueMake ( & self -> full_blocks, CC_HASH_QUEUE ) == 0 )
+    {
+        if ( KThreadMake ( & self -> thread, CCHashFileThread, self ) == 0 )
+            return;
+        KQueueRelease ( self -> full_blocks );
+        self -> full_blocks = NULL;
+    }
+    /* no thread, keep on hashing inline */
+    self -> thread = NULL;
+    atomic32_dec ( & active_threads );
+}
+
+
+/* keep the bytes of a file that might be small for the pool */
+static
+rc_t CCHashFileKeep ( CCHashFile * self, const uint8_t * data, size_t size )
+{
+    CCHashJob * job = self -> job;
+
+    if ( job == NULL )
+    {
+        job = calloc ( 1, sizeof * job );
+        if ( job == NULL )
+            return RC ( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+        job -> digest = self -> digest;
+        self -> job = job;
+    }
+    if ( job -> size + size > job -> allocated )
+    {
+        void * bytes;
+        size_t allocated = job -> allocated == 0 ? 4096 : job -> allocated;
+
+        while ( allocated < job -> size + size )
+            allocated += allocated;
+        bytes = realloc ( job -> data, allocated );
+        if ( bytes == NULL )
+            return RC ( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+        job -> data = bytes;
+        job -> allocated = allocated;
+    }
+    memmove ( job -> data + job -> size, data, size );
+    job -> size += size;
+    return 0;
+}
+
+
+/* hash the bytes, on the reading thread or by the thread of the file */
+static
+rc_t CCHashFileFeed ( CCHashFile * self, const uint8_t * data, size_t size )
+{
+    rc_t rc = 0;
+
+    if ( self -> thread == NULL )
+        MD5StateAppend ( & self -> md5, data, size );
+    else
+    {
+        size_t done;
+        for ( done = 0; rc == 0 && done < size; )
+        {
+            size_t n;
+
+            if ( self -> block == NULL )
+            {
+                void * item;
+                rc = KQueuePop ( free_blocks, & item, NULL );
+                if ( rc != 0 )
+                {
+                    LOGERR ( klogInt, rc, "failed to get block to hash" );
+                    break;
+                }
+                self -> block = item;
+                self -> block -> size = 0;
+            }
+
+            n = CC_HASH_BLOCK_SIZE - self -> block -> size;
+            if ( n > size - done )
+                n = size - done;
+            memmove ( self -> block -> data + self -> block -> size, data + done, n );
+            self -> block -> size += n;
+            done += n;
+
+            if ( self -> block -> size == CC_HASH_BLOCK_SIZE )
+                rc = CCHashFilePushBlock ( self );
+        }
+    }
+    return rc;
+}
+
+
+/* the next "size" bytes of the file go into the hash */
+static
+rc_t CCHashFileAppend ( CCHashFile * self, const uint8_t * data, size_t size )
+{
+    rc_t rc = 0;
+
+    if ( self -> thread == NULL && self -> position + size > CC_HASH_INLINE )
+    {
+        CCHashFileStartThread ( self );
+
+        /* not a small file: the bytes kept back go first */
+        if ( self -> job != NULL )
+        {
+            rc = CCHashFileFeed ( self, self -> job -> data, self -> job -> size );
+            CCHashJobWhack ( self -> job );
+            self -> job = NULL;
+        }
+    }
+
+    if ( rc == 0 )
+    {
+        if ( small_files != NULL && self -> position + size <= CC_HASH_INLINE )
+            rc = CCHashFileKeep ( self, data, size );
+        else
+            rc = CCHashFileFeed ( self, data, size );
+    }
+    if ( rc == 0 )
+        self -> position += size;
+    else if ( self -> rc == 0 )
+        self -> rc = rc;
+    return rc;
+}
+
+
+/* ----------------------------------------------------------------------
+ * Destroy
+ *  waits for the thread to hash what is left and writes the digest,
+ *  a small file is handed to the pool, that writes the digest later
+ */
+static
+rc_t CC CCHashFileDestroy ( CCHashFile * self )
+{
+    rc_t rc = self -> rc;
+
+    if ( self -> job != NULL )
+    {
+        if ( rc == 0 && KQueuePush ( small_files, self -> job, NULL ) == 0 )
+        {
+            /* the pool owns the job now */
+            self -> job = NULL;
+            KFileRelease ( self -> original );
+            free ( self );
+            return 0;
+        }
+        /* hash it here */
+        MD5StateAppend ( & self -> md5, self -> job -> data, self -> job -> size );
+        CCHashJobWhack ( self -> job );
+        self -> job = NULL;
+    }
+
+    if ( self -> thread != NULL )
+    {
+        rc_t orc, status = 0;
+
+        if ( self -> block != NULL )
+        {
+            if ( self -> block -> size > 0 && rc == 0 )
+                rc = CCHashFilePushBlock ( self );
+            else
+            {
+                KQueuePush ( free_blocks, self -> block, NULL );
+                self -> block = NULL;
+            }
+        }
+        KQueueSeal ( self -> full_blocks );
+        orc = KThreadWait ( self -> thread, & status );
+        if ( rc == 0 )
+            rc = orc != 0 ? orc : status;
+        KThreadRelease ( self -> thread );
+        KQueueRelease ( self -> full_blocks );
+        atomic32_dec ( & active_threads );
+    }
+    if ( rc == 0 )
+        MD5StateFinish ( & self -> md5, self -> digest );
+
+    KFileRelease ( self -> original );
+    free ( self );
+    return rc;
+}
+
+static
+struct KSysFile *CC CCHashFileGetSysFile ( const CCHashFile *self, uint64_t *offset )
+{
+    /* the bytes have to pass through us */
+    * offset = 0;
+    return NULL;
+}
+
+static
+rc_t CC CCHashFileRandomAccess ( const CCHashFile *self )
+{
+    return KFileRandomAccess ( self -> original );
+}
+
+static
+uint32_t CC CCHashFileType ( const CCHashFile *self )
+{
+    return KFileType ( self -> original );
+}
+
+static
+rc_t CC CCHashFileSize ( const CCHashFile *self, uint64_t *size )
+{
+    return KFileSize ( self -> original, size );
+}
+
+static
+rc_t CC CCHashFileSetSize ( CCHashFile *self, uint64_t size )
+{
+    return RC ( rcExe, rcFile, rcUpdating, rcFile, rcReadonly );
+}
+
+/* ----------------------------------------------------------------------
+ * Read
+ *  bytes the reader skips are read and hashed here,
+ *  bytes read again are not hashed twice
+ */
+static
+rc_t CC CCHashFileRead ( const CCHashFile *cself, uint64_t pos,
+                         void *buffer, size_t bsize, size_t *num_read )
+{
+    CCHashFile * self = ( CCHashFile * )cself;
+    rc_t rc = self -> rc;
+    size_t num;
+
+    if ( num_read == NULL )
+        num_read = & num;
+    * num_read = 0;
+
+    /* use the caller's buffer to fill the gap */
+    while ( rc == 0 && self -> position < pos && bsize > 0 )
+    {
+        size_t gap = bsize;
+        if ( gap > pos - self -> position )
+            gap = ( size_t )( pos - self -> position );
+        rc = KFileRead ( self -> original, self -> position, buffer, gap, & num );
+        if ( rc == 0 )
+        {
+            if ( num == 0 )
+                return 0; /* pos is beyond the end */
+            rc = CCHashFileAppend ( self, buffer, num );
+        }
+    }
+
+    if ( rc == 0 )
+        rc = KFileRead ( self -> original, pos, buffer, bsize, num_read );
+
+    if ( rc == 0 && pos <= self -> position && pos + * num_read > self -> position )
+    {
+        size_t skip = ( size_t )( self -> position - pos );
+        rc = CCHashFileAppend ( self, ( const uint8_t * )buffer + skip, * num_read - skip );
+    }
+    return rc;
+}
+
+static
+rc_t CC CCHashFileWrite ( CCHashFile *self, uint64_t pos,
+                          const void *buffer, size_t bsize, size_t *num_writ )
+{
+    return RC ( rcExe, rcFile, rcWriting, rcFile, rcReadonly );
+}
+
+static const KFile_vt_v1 vtCCHashFile =
+{
+    /* version */
+    1, 1,
+
+    /* 1.0 */
+    CCHashFileDestroy,
+    CCHashFileGetSysFile,
+    CCHashFileRandomAccess,
+    CCHashFileSize,
+    CCHashFileSetSize,
+    CCHashFileRead,
+    CCHashFileWrite,
+
+    /* 1.1 */
+    CCHashFileType
+};
+
+/* ----------------------------------------------------------------------
+ * CCHashFileMakeRead
+ *  "digest" [ OUT ] - receives the MD5 when the file is released,
+ *  unless there was an error
+ */
+rc_t CCHashFileMakeRead ( const KFile ** pself, const KFile * original,
+                          uint8_t digest [ 16 ] )
+{
+    CCHashFile * self;
+    rc_t rc;
+
+    assert ( pself );
+    assert ( original );
+    assert ( digest );
+
+    * pself = NULL;
+    self = calloc ( 1, sizeof * self );
+    if ( self == NULL )
+        rc = RC ( rcExe, rcFile, rcConstructing, rcMemory, rcExhausted );
+    else
+    {
+        rc = KFileInit ( & self -> dad, ( const KFile_vt * ) & vtCCHashFile,
+                         "CCHashFile", "no-name", true, false );
+        if ( rc == 0 )
+            rc = KFileAddRef ( original );
+        if ( rc == 0 )
+        {
+            self -> original = original;
+            self -> digest = digest;
+            MD5StateInit ( & self -> md5 );
+            * pself = & self -> dad;
+            return 0;
+        }
+        free ( self );
+    }
+    return rc;
+}
+
+/* end of file cchash.c */
@@ -63,6 +63,7 @@ extern bool xml_dir;            /* if set we will output XML to match our extrac
                                  * the original packed submission */
 extern bool no_bzip2;           /* if true, don't try to decompress bzipped files */
 extern bool no_md5;             /* if true, don't calculate md5 sums */
+extern uint32_t hash_threads;   /* if > 0, files are hashed by up to this many threads */
 extern char epath [8192];       /* we build a path down through containes/archives */
 extern char * ehere;            /* the pointer to the next character in epath during descent */
 extern KCreateMode cm;          
@@ -121,6 +122,28 @@ rc_t ccat_buf ( CCTree *tree, const struct KFile *sf, KTime_t mtime,
                 enum CCType ntype, CCFileNode *node, const char *name);
 
 
+/*--------------------------------------------------------------------------
+ * CCHashFile
+ *  read wrapper calculating the MD5 of a file,
+ *  small files are hashed by a pool of threads,
+ *  large files by threads of their own ( cchash.c )
+ */
+rc_t CCHashSetup ( uint32_t threads );
+
+/* CCHashShutdown
+ *  waits for the digests of the small files, returns the first error
+ */
+rc_t CCHashShutdown ( void );
+
+/* CCHashFileMakeRead
+ *  "digest" [ OUT ] - receives the MD5 when the file is released,
+ *  or, for a small file, by the time CCHashShutdown returns
+ */
+rc_t CCHashFileMakeRead ( const struct KFile ** self,
+                          const struct KFile * original,
+                          uint8_t digest [ 16 ] );
+
+
 /* -----
  * copycat
  *
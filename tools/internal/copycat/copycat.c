@@ -78,6 +78,7 @@ bool xml_dir = false;
 bool extract_dir = false;
 bool no_bzip2 = false;
 bool no_md5 = false;
+uint32_t hash_threads = 0;
 void * dump_out;
 const char * xml_base = NULL;
 
@@ -208,6 +209,7 @@ KCreateMode cm = kcmParents | kcmCreate;
 #define OPTION_OUTBLOCK "output-buffer"
 #define OPTION_NOBZIP2 "no-bzip2"
 #define OPTION_NOMD5   "no-md5"
+#define OPTION_THREADS "threads"
 
 #define ALIAS_CACHE   "x"
 #define ALIAS_FORCE   "f"
@@ -222,6 +224,7 @@ KCreateMode cm = kcmParents | kcmCreate;
 #define ALIAS_OUTBLOCK ""
 #define ALIAS_NOBZIP2 ""
 #define ALIAS_NOMD5   ""
+#define ALIAS_THREADS ""
 
 
 
@@ -257,6 +260,9 @@ const char * no_bzip2_usage[] =
 { "do not decompress files compressed with bzip2", NULL };
 const char * no_md5_usage[] = 
 { "do not calculate md5 hashes", NULL };
+static
+const char * threads_usage[] = 
+{ "calculate the md5 hashes on up to this many threads", "default 0: on the reading thread", NULL };
 
 
 const char UsageDefaultName [] = "copycat";
@@ -299,6 +305,7 @@ rc_t CC Usage (const Args * args)
     HelpOptionLine (ALIAS_OUTBLOCK,OPTION_OUTBLOCK, "size-in-KB", outblock_usage);
     HelpOptionLine (ALIAS_NOBZIP2,OPTION_NOBZIP2, NULL, no_bzip2_usage);
     HelpOptionLine (ALIAS_NOMD5,OPTION_NOMD5, NULL, no_md5_usage);
+    HelpOptionLine (ALIAS_THREADS,OPTION_THREADS, "count", threads_usage);
     HelpOptionsStandard ();
 
 
@@ -391,6 +398,10 @@ rc_t CC Usage (const Args * args)
     OUTMSG (("  To prevent calculation of MD5 hashes, use the option\n"
              "    '--no-md5'\n"
              "\n"));
+    OUTMSG (("  To calculate the MD5 hashes on separate threads, while\n"
+             "  the sources are read and parsed, use the option\n"
+             "    '--threads <count>'\n"
+             "\n"));
 
     HelpVersion (fullpath, KAppVersion());
 
@@ -411,7 +422,8 @@ OptDef Options[] =
     { OPTION_INBLOCK, ALIAS_OUTBLOCK,NULL, inblock_usage, 1, true,  false },
     { OPTION_OUTBLOCK,ALIAS_OUTBLOCK,NULL, outblock_usage,1, true,  false },
     { OPTION_NOBZIP2, ALIAS_NOBZIP2, NULL, no_bzip2_usage,0, false, false },
-    { OPTION_NOMD5,   ALIAS_NOMD5,   NULL, no_md5_usage,  0, false, false }
+    { OPTION_NOMD5,   ALIAS_NOMD5,   NULL, no_md5_usage,  0, false, false },
+    { OPTION_THREADS, ALIAS_THREADS, NULL, threads_usage, 1, true,  false }
 };
 
 /* file2file
@@ -1081,6 +1093,25 @@ rc_t KMain ( int argc, char *argv [] )
                 no_md5 = true;
             }
 
+            rc = ArgsOptionCount (args, OPTION_THREADS, &pcount);
+            if (pcount == 1)
+            {
+                const char * start;
+                char * end;
+
+                rc = ArgsOptionValue (args, OPTION_THREADS, 0, (const void **)&start);
+                if (rc)
+                    break;
+
+                hash_threads = strtou32 (start, &end, 10);
+
+                if (*end != '\0')
+                {
+                    rc = RC (rcExe, rcArgv, rcAccessing, rcParam, rcInvalid);
+                    break;
+                }
+            }
+
             /* all parameters plus the possible dest option parameter */
             rc = ArgsParamCount (args, &pcount);
             if (rc)
@@ -1208,8 +1239,20 @@ rc_t KMain ( int argc, char *argv [] )
 
                                     dump_out = stdout; /* kludge */
 
+                                    rc = CCHashSetup (no_md5 ? 0 : hash_threads);
+                                    if (rc)
+                                    {
+                                        LOGERR (klogWarn, rc,
+                                                "failed to start md5 threads, "
+                                                "hashing on the reading thread");
+                                        hash_threads = 0;
+                                    }
                                     rc = copycat_run (tree, &logs, mgr, cache,
                                                       dp, extract, &params);
+                                    /* waits for the md5 of the small files */
+                                    orc = CCHashShutdown ();
+                                    if (rc == 0)
+                                        rc = orc;
                                     if ( rc == 0 )
                                         rc = copycat_dump ( xml_dir ? etree : tree, &logs );
                                     DEBUG_STATUS(("%s: Output XML\n", __func__));
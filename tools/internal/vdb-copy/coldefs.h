@@ -92,6 +92,9 @@ typedef struct col_def
     bool redactable;        /* this column is in the list of redactable
                                columns */
 
+    bool blob_copy;         /* this column is copied blob by blob, not by
+                               the write-cursor ( to_copy is cleared ) */
+
     VTypedecl type_decl;    /* type-decl of this column via read-schema */
     VTypedesc type_desc;    /* type-desc of this column via read-schema */
 
@@ -26,6 +26,8 @@
 
 #include "context.h"
 
+#include <klib/log.h>
+
 #ifndef _h_helper_
 #include "helper.h"
 #endif
@@ -79,6 +81,9 @@ static void context_init_values( p_context ctx ) {
     ctx -> md5_mode = MD5_MODE_AUTO;
     ctx -> force_kcmInit = false;
     ctx -> force_unlock = false;
+    ctx -> num_threads = 1;
+    ctx -> no_blob_copy = false;
+    ctx -> row_range_given = false;
 
     ctx -> dont_remove_target = false;
     config_values_init( &( ctx -> config ) );
@@ -285,12 +290,31 @@ static rc_t context_set_blob_checksum( p_context ctx, const char *src ) {
     return 0;
 }
 
+#define MAX_NUM_THREADS 64
+
+static void context_set_num_threads( p_context ctx, const char *src ) {
+    if ( NULL != src ) {
+        uint64_t value = strtou64( src, NULL, 10 );
+        if ( value > 0 && value <= MAX_NUM_THREADS ) {
+            ctx -> num_threads = ( uint32_t )value;
+        } else {
+            /* do not let the user believe the value was taken */
+            if ( value > MAX_NUM_THREADS ) {
+                ctx -> num_threads = MAX_NUM_THREADS;
+            }
+            PLOGMSG( klogWarn, ( klogWarn, "--threads '$(given)' is out of range ( 1...$(max) ), using $(used)",
+                                 "given=%s,max=%u,used=%u", src, MAX_NUM_THREADS, ctx -> num_threads ) );
+        }
+    }
+}
+
 static rc_t context_set_row_range( p_context ctx, const char *src ) {
     rc_t rc;
     if ( ( NULL == ctx )||( NULL == src ) ) {
         rc = RC( rcVDB, rcNoTarg, rcWriting, rcParam, rcNull );
     } else {
         rc = num_gen_parse( ctx -> row_generator, src );
+        ctx -> row_range_given = ( 0 == rc );
     }
     return rc;
 }
@@ -385,9 +409,11 @@ static void context_evaluate_options( const Args *my_args, p_context ctx ) {
         ctx -> show_meta     = context_get_bool_option( my_args, OPTION_SHOW_META, false );
         ctx -> force_kcmInit = context_get_bool_option( my_args, OPTION_FORCE, false );
         ctx -> force_unlock  = context_get_bool_option( my_args, OPTION_UNLOCK, false );
+        ctx -> no_blob_copy  = context_get_bool_option( my_args, OPTION_NO_BLOB_COPY, false );
 
         context_set_md5_mode( ctx, context_get_str_option( my_args, OPTION_MD5_MODE ) );
         context_set_blob_checksum( ctx, context_get_str_option( my_args, OPTION_BLOB_CHECKSUM ) );
+        context_set_num_threads( ctx, context_get_str_option( my_args, OPTION_THREADS ) );
 
     #if ALLOW_EXTERNAL_CONFIG
         context_set_kfg_path( ctx, context_get_str_option( my_args, OPTION_KFG_PATH ) );
@@ -0,0 +1,307 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+#include "copy_blobs.h"
+
+#ifndef _h_definitions_
+#include "definitions.h"
+#endif
+
+#ifndef _h_copy_meta_
+#include "copy_meta.h"
+#endif
+
+#ifndef _h_klib_out_
+#include <klib/out.h>
+#endif
+
+#ifndef _h_klib_namelist_
+#include <klib/namelist.h>
+#endif
+
+#ifndef _h_kapp_main_
+#include <kapp/main.h>      /* for Quitting() */
+#endif
+
+#ifndef _h_kdb_table_
+#include <kdb/table.h>
+#endif
+
+#ifndef _h_kdb_namelist_
+#include <kdb/namelist.h>
+#endif
+
+#ifndef _h_vdb_vdb_priv_
+#include <vdb/vdb-priv.h>
+#endif
+
+#include <sysalloc.h>
+#include <stdlib.h>
+
+typedef struct blob_buffer
+{
+    char * data;
+    size_t size;
+} blob_buffer;
+
+static rc_t copy_blobs_resize( blob_buffer * buf, size_t size ) {
+    if ( size > buf -> size ) {
+        char * tmp = realloc( buf -> data, size );
+        if ( NULL == tmp ) {
+            return RC( rcExe, rcBuffer, rcResizing, rcMemory, rcExhausted );
+        }
+        buf -> data = tmp;
+        buf -> size = size;
+    }
+    return 0;
+}
+
+/* reads the whole blob into the buffer */
+static rc_t copy_blobs_read( const KColumnBlob * blob, blob_buffer * buf, size_t * blob_size ) {
+    char probe[ 8 ];
+    size_t num_read, remaining;
+    /* first we ask about the size to be read */
+    rc_t rc = KColumnBlobRead ( blob, 0, probe, 0, &num_read, &remaining );
+    DISP_RC( rc, "copy_blobs_read:KColumnBlobRead(1) failed" );
+    if ( 0 == rc ) {
+        size_t total = 0;
+        *blob_size = remaining + num_read;
+        rc = copy_blobs_resize( buf, *blob_size );
+        while ( 0 == rc && total < *blob_size ) {
+            rc = KColumnBlobRead ( blob, total, buf -> data + total, *blob_size - total,
+                                   &num_read, &remaining );
+            DISP_RC( rc, "copy_blobs_read:KColumnBlobRead(2) failed" );
+            if ( 0 == rc ) {
+                if ( 0 == num_read ) {
+                    rc = RC( rcExe, rcBlob, rcReading, rcData, rcInsufficient );
+                }
+                total += num_read;
+            }
+        }
+    }
+    return rc;
+}
+
+/* copies one blob, returns the first row-id after it in *next */
+static rc_t copy_blobs_one( const KColumn * src_col, KColumn * dst_col, int64_t row_id,
+                            blob_buffer * buf, int64_t * next ) {
+    const KColumnBlob * src_blob;
+    rc_t rc = KColumnOpenBlobRead( src_col, &src_blob, row_id );
+    if ( 0 != rc ) {
+        if ( rcNotFound == GetRCState( rc ) ) {
+            /* a gap in the column: continue with the next blob */
+            rc = KColumnFindFirstRowId( src_col, next, row_id );
+            if ( rcNotFound == GetRCState( rc ) ) {
+                *next = INT64_MAX;  /* no blob left */
+                return 0;
+            }
+            DISP_RC( rc, "copy_blobs_one:KColumnFindFirstRowId() failed" );
+            return rc;
+        }
+        DISP_RC( rc, "copy_blobs_one:KColumnOpenBlobRead() failed" );
+        return rc;
+    } else {
+        int64_t first;
+        uint32_t count;
+        rc = KColumnBlobIdRange( src_blob, &first, &count );
+        DISP_RC( rc, "copy_blobs_one:KColumnBlobIdRange() failed" );
+        if ( 0 == rc ) {
+            size_t blob_size;
+            rc = copy_blobs_read( src_blob, buf, &blob_size );
+            if ( 0 == rc ) {
+                KColumnBlob * dst_blob;
+                rc = KColumnCreateBlob( dst_col, &dst_blob );
+                DISP_RC( rc, "copy_blobs_one:KColumnCreateBlob() failed" );
+                if ( 0 == rc ) {
+                    rc = KColumnBlobAppend( dst_blob, buf -> data, blob_size );
+                    DISP_RC( rc, "copy_blobs_one:KColumnBlobAppend() failed" );
+                    if ( 0 == rc ) {
+                        rc = KColumnBlobAssignRange( dst_blob, first, count );
+                        DISP_RC( rc, "copy_blobs_one:KColumnBlobAssignRange() failed" );
+                    }
+                    if ( 0 == rc ) {
+                        rc = KColumnBlobCommit( dst_blob );
+                        DISP_RC( rc, "copy_blobs_one:KColumnBlobCommit() failed" );
+                    }
+                    KColumnBlobRelease( dst_blob );
+                }
+            }
+            *next = first + count;
+        }
+        KColumnBlobRelease( src_blob );
+    }
+    return rc;
+}
+
+static rc_t copy_blobs_column( const KTable * src_tab, KTable * dst_tab, const char * name,
+                               KCreateMode cmode, KChecksum checksum,
+                               blob_buffer * buf, const bool show_progress,
+                               const bool show_meta ) {
+    const KColumn * src_col;
+    rc_t rc = KTableOpenColumnRead( src_tab, &src_col, "%s", name );
+    DISP_RC( rc, "copy_blobs_column:KTableOpenColumnRead() failed" );
+    if ( 0 == rc ) {
+        KColumn * dst_col;
+        rc = KTableCreateColumn( dst_tab, &dst_col, cmode, checksum, 0, "%s", name );
+        DISP_RC( rc, "copy_blobs_column:KTableCreateColumn() failed" );
+        if ( 0 == rc ) {
+            int64_t first;
+            uint64_t count;
+            rc = copy_column_meta( src_col, dst_col, show_meta );
+            if ( 0 == rc ) {
+                rc = KColumnIdRange( src_col, &first, &count );
+                DISP_RC( rc, "copy_blobs_column:KColumnIdRange() failed" );
+            }
+            if ( 0 == rc ) {
+                int64_t row_id = first;
+                int64_t end = first + count;
+                uint64_t blobs = 0;
+                while ( 0 == rc && row_id < end ) {
+                    rc = Quitting();    /* to be able to cancel the loop by signal */
+                    if ( 0 == rc ) {
+                        rc = copy_blobs_one( src_col, dst_col, row_id, buf, &row_id );
+                        blobs++;
+                    }
+                }
+                if ( 0 == rc && show_progress ) {
+                    KOutMsg( "blob-copy of >%s< : %lu blobs\n", name, blobs );
+                }
+            }
+            {
+                rc_t rc1 = KColumnRelease( dst_col );
+                DISP_RC( rc1, "copy_blobs_column:KColumnRelease(dst) failed" );
+            }
+        }
+        KColumnRelease( src_col );
+    }
+    return rc;
+}
+
+/* copies the physical columns in "names" */
+static rc_t copy_blobs_names( const VTable * src_table, VTable * dst_table,
+                              const KNamelist * names,
+                              KCreateMode cmode, KChecksum checksum,
+                              const bool show_progress, const bool show_meta ) {
+    const KTable * src_tab;
+    rc_t rc = VTableOpenKTableRead( src_table, &src_tab );
+    DISP_RC( rc, "copy_blobs_names:VTableOpenKTableRead() failed" );
+    if ( 0 == rc ) {
+        KTable * dst_tab;
+        rc = VTableOpenKTableUpdate( dst_table, &dst_tab );
+        DISP_RC( rc, "copy_blobs_names:VTableOpenKTableUpdate() failed" );
+        if ( 0 == rc ) {
+            uint32_t i, count;
+            blob_buffer buf = { NULL, 0 };
+            rc = KNamelistCount( names, &count );
+            for ( i = 0; 0 == rc && i < count; ++i ) {
+                const char * name;
+                rc = KNamelistGet( names, i, &name );
+                if ( 0 == rc ) {
+                    rc = copy_blobs_column( src_tab, dst_tab, name, cmode, checksum,
+                                            &buf, show_progress, show_meta );
+                }
+            }
+            free( buf . data );
+            KTableRelease( dst_tab );
+        }
+        KTableRelease( src_tab );
+    }
+    return rc;
+}
+
+rc_t copy_blobs_table( const VTable * src_table, VTable * dst_table,
+                       KCreateMode cmode, KChecksum checksum,
+                       const bool show_progress, const bool show_meta ) {
+    const KTable * src_tab;
+    rc_t rc;
+
+    if ( NULL == src_table || NULL == dst_table ) {
+        return RC( rcExe, rcNoTarg, rcCopying, rcParam, rcNull );
+    }
+    rc = VTableOpenKTableRead( src_table, &src_tab );
+    DISP_RC( rc, "copy_blobs_table:VTableOpenKTableRead() failed" );
+    if ( 0 == rc ) {
+        KNamelist * names;
+        rc = KTableListCol( src_tab, &names );
+        DISP_RC( rc, "copy_blobs_table:KTableListCol() failed" );
+        if ( 0 == rc ) {
+            rc = copy_blobs_names( src_table, dst_table, names, cmode, checksum,
+                                   show_progress, show_meta );
+            KNamelistRelease( names );
+        }
+        KTableRelease( src_tab );
+    }
+    return rc;
+}
+
+rc_t copy_blobs_columns( const VTable * src_table, VTable * dst_table,
+                         const KNamelist * names,
+                         KCreateMode cmode, KChecksum checksum,
+                         const bool show_progress, const bool show_meta ) {
+    if ( NULL == src_table || NULL == dst_table || NULL == names ) {
+        return RC( rcExe, rcNoTarg, rcCopying, rcParam, rcNull );
+    }
+    /* the write-cursor must not have created one of them already */
+    cmode = ( cmode & ~kcmValueMask ) | kcmCreate;
+    return copy_blobs_names( src_table, dst_table, names, cmode, checksum,
+                             show_progress, show_meta );
+}
+
+bool copy_blobs_src_has_column( const VTable * src_table, const char * name ) {
+    bool res = false;
+    const KTable * src_tab;
+    rc_t rc = VTableOpenKTableRead( src_table, &src_tab );
+    DISP_RC( rc, "copy_blobs_src_has_column:VTableOpenKTableRead() failed" );
+    if ( 0 == rc ) {
+        res = KTableExists( src_tab, kptColumn, "%s", name );
+        KTableRelease( src_tab );
+    }
+    return res;
+}
+
+bool copy_blobs_src_indexed( const VTable * src_table ) {
+    bool res = true;
+    const KTable * src_tab;
+    rc_t rc = VTableOpenKTableRead( src_table, &src_tab );
+    DISP_RC( rc, "copy_blobs_src_indexed:VTableOpenKTableRead() failed" );
+    if ( 0 == rc ) {
+        KNamelist * names;
+        rc = KTableListIdx( src_tab, &names );
+        if ( 0 == rc ) {
+            uint32_t count;
+            rc = KNamelistCount( names, &count );
+            DISP_RC( rc, "copy_blobs_src_indexed:KNamelistCount() failed" );
+            res = ( 0 != rc || count > 0 );
+            KNamelistRelease( names );
+        } else if ( rcNotFound == GetRCState( rc ) ) {
+            /* a table without an idx-directory */
+            res = false;
+        }
+        KTableRelease( src_tab );
+    }
+    return res;
+}
@@ -0,0 +1,88 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+#ifndef _h_copy_blobs_
+#define _h_copy_blobs_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _h_klib_rc_
+#include <klib/rc.h>
+#endif
+
+#ifndef _h_kdb_manager_
+#include <kdb/manager.h>
+#endif
+
+#ifndef _h_kdb_column_
+#include <kdb/column.h>
+#endif
+
+#ifndef _h_vdb_table_
+#include <vdb/table.h>
+#endif
+
+/*
+ * copies every physical column of the source-table into the
+ * destination-table blob by blob, without decoding/encoding a single cell
+ * the blobs are stored with the checksum-type requested for the destination
+ * this is only correct if the destination-table uses the same schema
+ * and all rows of the source-table are copied unchanged
+*/
+rc_t copy_blobs_table( const VTable * src_table, VTable * dst_table,
+                       KCreateMode cmode, KChecksum checksum,
+                       const bool show_progress, const bool show_meta );
+
+/*
+ * copies only the physical columns in "names" blob by blob, for the columns
+ * that are copied unchanged while the others are decoded and re-encoded
+ * by the write-cursor, fails if the destination has one of them already
+*/
+rc_t copy_blobs_columns( const VTable * src_table, VTable * dst_table,
+                         const struct KNamelist * names,
+                         KCreateMode cmode, KChecksum checksum,
+                         const bool show_progress, const bool show_meta );
+
+/*
+ * true if the source-table has a physical column of this name
+*/
+bool copy_blobs_src_has_column( const VTable * src_table, const char * name );
+
+/*
+ * true if the source-table has indices, they are built by the write-cursor
+ * ( e.g. idx:text:insert ) and would be lost by copying the blobs,
+ * also true if the indices cannot be listed
+*/
+bool copy_blobs_src_indexed( const VTable * src_table );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
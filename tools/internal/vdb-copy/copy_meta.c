@@ -417,6 +417,83 @@ rc_t copy_table_meta ( const VTable *src_table, VTable *dst_table,
 }
 
 
+rc_t copy_table_meta_nodes ( const VTable *src_table, VTable *dst_table,
+                             const char * nodes, const bool show_meta ) {
+    const KMetadata *src_meta;
+    rc_t rc;
+
+    if ( NULL == src_table || NULL == dst_table || NULL == nodes ) {
+        return RC( rcExe, rcNoTarg, rcCopying, rcParam, rcNull );
+    }
+    rc = VTableOpenMetadataRead ( src_table, & src_meta );
+    DISP_RC( rc, "copy_table_meta_nodes:VTableOpenMetadataRead() failed" );
+    if ( 0 == rc ) {
+        KMetadata *dst_meta;
+        rc = VTableOpenMetadataUpdate ( dst_table, & dst_meta );
+        DISP_RC( rc, "copy_table_meta_nodes:VTableOpenMetadataUpdate() failed" );
+        if ( 0 == rc ) {
+            const KMDataNode *src_root;
+            rc = KMetadataOpenNodeRead ( src_meta, & src_root, NULL );
+            DISP_RC( rc, "copy_table_meta_nodes:KMetadataOpenNodeRead() failed" );
+            if ( 0 == rc ) {
+                KMDataNode *dst_root;
+                rc = KMetadataOpenNodeUpdate ( dst_meta, & dst_root, NULL );
+                DISP_RC( rc, "copy_table_meta_nodes:KMetadataOpenNodeUpdate() failed" );
+                if ( 0 == rc ) {
+                    const VNamelist *names;
+                    rc = nlt_make_VNamelist_from_string( &names, nodes );
+                    DISP_RC( rc, "copy_table_meta_nodes:nlt_make_VNamelist_from_string() failed" );
+                    if ( 0 == rc ) {
+                        uint32_t i, count;
+                        rc = VNameListCount( names, &count );
+                        for ( i = 0; 0 == rc && i < count; ++ i ) {
+                            const char *node_path;
+                            rc = VNameListGet( names, i, &node_path );
+                            if ( 0 == rc ) {
+                                const KMDataNode *probe;
+                                /* a node missing in the source is not an error */
+                                if ( 0 == KMDataNodeOpenNodeRead ( src_root, & probe, "%s", node_path ) ) {
+                                    KMDataNodeRelease ( probe );
+                                    rc = copy_metadata_child ( src_root, dst_root, node_path, show_meta );
+                                }
+                            }
+                        }
+                        VNamelistRelease( names );
+                    }
+                    KMDataNodeRelease ( dst_root );
+                }
+                KMDataNodeRelease ( src_root );
+            }
+            KMetadataRelease ( dst_meta );
+        }
+        KMetadataRelease ( src_meta );
+    }
+    return rc;
+}
+
+rc_t copy_column_meta ( const KColumn *src_col, KColumn *dst_col,
+                        const bool show_meta ) {
+    const KMetadata *src_meta;
+    rc_t rc;
+
+    if ( NULL == src_col || NULL == dst_col ) {
+        return RC( rcExe, rcNoTarg, rcCopying, rcParam, rcNull );
+    }
+    rc = KColumnOpenMetadataRead ( src_col, & src_meta );
+    DISP_RC( rc, "copy_column_meta:KColumnOpenMetadataRead() failed" );
+    if ( 0 == rc ) {
+        KMetadata *dst_meta;
+        rc = KColumnOpenMetadataUpdate ( dst_col, & dst_meta );
+        DISP_RC( rc, "copy_column_meta:KColumnOpenMetadataUpdate() failed" );
+        if ( 0 == rc ) {
+            rc = copy_stray_metadata ( src_meta, dst_meta, NULL, show_meta );
+            KMetadataRelease ( dst_meta );
+        }
+        KMetadataRelease ( src_meta );
+    }
+    return rc;
+}
+
 rc_t copy_database_meta ( const VDatabase *src_db, VDatabase *dst_db,
                           const char * excluded_nodes,
                           const bool show_meta ) {
@@ -42,11 +42,24 @@ extern "C" {
 #ifndef _h_vdb_database_
 #include <vdb/database.h>
 #endif
+
+#ifndef _h_kdb_column_
+#include <kdb/column.h>
+#endif
     
 rc_t copy_table_meta ( const VTable *src_table, VTable *dst_table,
                        const char * excluded_nodes,
                        const bool show_meta, const bool schema_updated );
 
+/* copies only the given ( comma-separated ) root-nodes of the table-metadata,
+   nodes missing in the source are skipped */
+rc_t copy_table_meta_nodes ( const VTable *src_table, VTable *dst_table,
+                             const char * nodes, const bool show_meta );
+
+/* copies the metadata of a physical column */
+rc_t copy_column_meta ( const KColumn *src_col, KColumn *dst_col,
+                        const bool show_meta );
+
 rc_t copy_database_meta ( const VDatabase *src_db, VDatabase *dst_db,
                           const char * excluded_nodes,
                           const bool show_meta );
@@ -0,0 +1,173 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+#include "copy_workers.h"
+
+#ifndef _h_definitions_
+#include "definitions.h"
+#endif
+
+#include <sysalloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* initial size of the data-buffer of a batch */
+#define ROW_BATCH_DATA_INC ( 1024 * 1024 )
+
+rc_t row_batch_make( row_batch ** batch, uint32_t num_cols, uint32_t max_rows ) {
+    row_batch * res;
+    if ( NULL == batch || 0 == max_rows ) {
+        return RC( rcExe, rcNoTarg, rcConstructing, rcParam, rcInvalid );
+    }
+    *batch = NULL;
+    res = calloc( 1, sizeof * res );
+    if ( NULL == res ) {
+        return RC( rcExe, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    }
+    res -> num_cols = num_cols;
+    res -> max_rows = max_rows;
+    res -> row_ids = malloc( max_rows * sizeof res -> row_ids[ 0 ] );
+    res -> flags = malloc( max_rows * sizeof res -> flags[ 0 ] );
+    res -> cells = malloc( ( ( size_t )max_rows * ( num_cols > 0 ? num_cols : 1 ) ) * sizeof res -> cells[ 0 ] );
+    res -> data = malloc( ROW_BATCH_DATA_INC );
+    if ( NULL == res -> row_ids || NULL == res -> flags ||
+         NULL == res -> cells || NULL == res -> data ) {
+        row_batch_release( res );
+        return RC( rcExe, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    }
+    res -> data_size = ROW_BATCH_DATA_INC;
+    *batch = res;
+    return 0;
+}
+
+void row_batch_release( row_batch * batch ) {
+    if ( NULL != batch ) {
+        free( batch -> row_ids );
+        free( batch -> flags );
+        free( batch -> cells );
+        free( batch -> data );
+        free( batch );
+    }
+}
+
+rc_t row_batch_add_row( row_batch * batch, int64_t row_id, uint8_t flags ) {
+    if ( NULL == batch ) {
+        return RC( rcExe, rcNoTarg, rcInserting, rcSelf, rcNull );
+    }
+    if ( batch -> row_count >= batch -> max_rows ) {
+        return RC( rcExe, rcNoTarg, rcInserting, rcBuffer, rcExhausted );
+    }
+    batch -> row_ids[ batch -> row_count ] = row_id;
+    batch -> flags[ batch -> row_count ] = flags;
+    /* cells not added later ( rejected rows ) stay empty */
+    memset( &( batch -> cells[ ( size_t )batch -> row_count * batch -> num_cols ] ), 0,
+            batch -> num_cols * sizeof batch -> cells[ 0 ] );
+    batch -> row_count++;
+    return 0;
+}
+
+rc_t row_batch_add_cell( row_batch * batch, uint32_t col_nr,
+                         uint32_t elem_bits, const void * base,
+                         uint32_t boff, uint32_t count ) {
+    row_cell * cell;
+    size_t bytes;
+    if ( NULL == batch ) {
+        return RC( rcExe, rcNoTarg, rcInserting, rcSelf, rcNull );
+    }
+    if ( 0 == batch -> row_count || col_nr >= batch -> num_cols ) {
+        return RC( rcExe, rcNoTarg, rcInserting, rcId, rcOutofrange );
+    }
+    /* keep the bit-offset within the first byte, skip the whole bytes before it */
+    base = ( const char * )base + ( boff >> 3 );
+    boff &= 7;
+    bytes = ( ( size_t )boff + ( size_t )elem_bits * count + 7 ) >> 3;
+    if ( batch -> data_used + bytes > batch -> data_size ) {
+        size_t new_size = batch -> data_size;
+        char * tmp;
+        while ( batch -> data_used + bytes > new_size ) {
+            new_size += ROW_BATCH_DATA_INC;
+        }
+        tmp = realloc( batch -> data, new_size );
+        if ( NULL == tmp ) {
+            return RC( rcExe, rcNoTarg, rcInserting, rcMemory, rcExhausted );
+        }
+        batch -> data = tmp;
+        batch -> data_size = new_size;
+    }
+    cell = &( batch -> cells[ ( size_t )( batch -> row_count - 1 ) * batch -> num_cols + col_nr ] );
+    cell -> offset = batch -> data_used;
+    cell -> elem_bits = elem_bits;
+    cell -> boff = boff;
+    cell -> count = count;
+    if ( bytes > 0 ) {
+        memmove( batch -> data + batch -> data_used, base, bytes );
+        batch -> data_used += bytes;
+    }
+    return 0;
+}
+
+const row_cell * row_batch_get_cell( const row_batch * batch,
+                                     uint32_t row, uint32_t col_nr ) {
+    if ( NULL == batch || row >= batch -> row_count || col_nr >= batch -> num_cols ) {
+        return NULL;
+    }
+    return &( batch -> cells[ ( size_t )row * batch -> num_cols + col_nr ] );
+}
+
+/********************************************************************/
+
+rc_t copy_workers_deliver( struct ordered_worker * self, row_batch * batch ) {
+    return ordered_worker_deliver( self, batch, true ); /* ordered_workers.c */
+}
+
+static void CC copy_workers_release( void * item ) {
+    row_batch_release( item );
+}
+
+/* the consumer gets the batches in the order of the row-set */
+typedef struct copy_workers_consumer {
+    copy_workers_consume_fn consume;
+    void * data;
+} copy_workers_consumer;
+
+static rc_t CC copy_workers_consume( void * item, void * data ) {
+    copy_workers_consumer * c = data;
+    return c -> consume( item, c -> data );
+}
+
+rc_t copy_workers_run( uint32_t num_workers,
+                       copy_workers_produce_fn produce, void ** data,
+                       copy_workers_consume_fn consume, void * consume_data ) {
+    copy_workers_consumer c;
+    if ( NULL == consume ) {
+        return RC( rcExe, rcNoTarg, rcConstructing, rcParam, rcInvalid );
+    }
+    c . consume = consume;
+    c . data = consume_data;
+    return ordered_workers_run( num_workers, produce, data,
+                                copy_workers_consume, &c, copy_workers_release ); /* ordered_workers.c */
+}
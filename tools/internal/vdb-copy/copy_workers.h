@@ -0,0 +1,114 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+#ifndef _h_copy_workers_
+#define _h_copy_workers_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _h_klib_rc_
+#include <klib/rc.h>
+#endif
+
+#ifndef _h_ordered_workers_
+#include "ordered_workers.h"
+#endif
+
+/********************************************************************
+a row-batch holds the decoded cells of consecutive rows ( of the
+row-set to be copied ), produced by a worker reading the source
+********************************************************************/
+typedef struct row_cell
+{
+    size_t offset;          /* where the cell-data starts in the batch-buffer */
+    uint32_t elem_bits;
+    uint32_t boff;          /* bit-offset of the first element ( 0..7 ) */
+    uint32_t count;         /* number of elements */
+} row_cell;
+
+#define ROW_FLAG_PASS   1   /* copy this row */
+#define ROW_FLAG_REDACT 2   /* redact the redactable columns of this row */
+
+typedef struct row_batch
+{
+    int64_t * row_ids;
+    uint8_t * flags;
+    row_cell * cells;       /* max_rows * num_cols */
+    char * data;
+    size_t data_used;
+    size_t data_size;
+    uint32_t num_cols;
+    uint32_t max_rows;
+    uint32_t row_count;
+} row_batch;
+
+rc_t row_batch_make( row_batch ** batch, uint32_t num_cols, uint32_t max_rows );
+
+/* NULL is ok */
+void row_batch_release( row_batch * batch );
+
+/* starts a new row, the cells have to be added in column-order */
+rc_t row_batch_add_row( row_batch * batch, int64_t row_id, uint8_t flags );
+
+/* copies the cell-data into the batch, for the last added row */
+rc_t row_batch_add_cell( row_batch * batch, uint32_t col_nr,
+                         uint32_t elem_bits, const void * base,
+                         uint32_t boff, uint32_t count );
+
+const row_cell * row_batch_get_cell( const row_batch * batch,
+                                     uint32_t row, uint32_t col_nr );
+
+/********************************************************************
+ordered processing of batches produced by multiple worker-threads:
+    - the row-set is cut into batches numbered 0, 1, 2 ...
+    - worker #n produces the batches n, n + N, n + 2N ... ( N = number of workers )
+      and hands each finished batch to copy_workers_deliver()
+    - the calling thread takes the batches round-robin from the workers
+      and hands them in their original order to the consumer
+    - the threads and queues are the ones of ordered_workers.c ( shared )
+********************************************************************/
+typedef ordered_workers_produce_fn copy_workers_produce_fn;
+
+typedef rc_t ( CC * copy_workers_consume_fn )( const row_batch * batch, void * data );
+
+/* hands a finished batch over to the consumer, takes ownership of the batch */
+rc_t copy_workers_deliver( struct ordered_worker * self, row_batch * batch );
+
+/* starts num_workers threads running produce( data[ worker_id ] ),
+   calls consume( batch, consume_data ) in the calling thread for every batch
+   in order and returns after all threads are done */
+rc_t copy_workers_run( uint32_t num_workers,
+                       copy_workers_produce_fn produce, void ** data,
+                       copy_workers_consume_fn consume, void * consume_data );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -80,6 +80,9 @@ extern "C" {
 #define META_IGNORE_NODES_KEY "/VDBCOPY/META/IGNORE"
 #define META_IGNROE_NODES_DFLT "col,.seq,STATS"
 
+/* produced by the write-cursor, taken from the source if blobs are copied */
+#define META_BLOB_COPY_NODES ".seq,STATS"
+
 #define TYPE_SCORE_PREFIX "/VDBCOPY/SCORE/"
 
 #define LEGACY_SCHEMA_KEY "/schema"
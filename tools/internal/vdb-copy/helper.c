@@ -296,6 +296,19 @@ static uint16_t bitlength_2_bytes( const size_t n_bits ) {
  * it copies the data via memmove where to the dst-pointer
  * points to / the size in the vdb-table can be smaller
 */
+static uint64_t helper_extract_int( const void *src_buffer,
+                                    uint32_t offset_in_bits,
+                                    uint32_t element_bits ) {
+    uint64_t value = 0;
+    char *src_ptr = (char*)src_buffer + ( offset_in_bits >> 3 );
+    if ( 0 == ( offset_in_bits & 7 ) ) {
+        memmove( &value, src_ptr, bitlength_2_bytes( element_bits ) );
+    } else {
+        bitcpy ( &value, 0, src_ptr, offset_in_bits, element_bits );
+    }
+    return value;
+}
+
 rc_t helper_read_vdb_int_row_open( const VCursor* src_cursor,
                           const uint32_t col_idx, uint64_t * dst ) {
     const void *src_buffer;
@@ -307,14 +320,25 @@ rc_t helper_read_vdb_int_row_open( const VCursor* src_cursor,
                   &src_buffer, &offset_in_bits, &element_count );
     DISP_RC( rc, "helper_read_int_intern:VCursorCellData() failed" );
     if ( 0 == rc ) {
-        uint64_t value = 0;
-        char *src_ptr = (char*)src_buffer + ( offset_in_bits >> 3 );
-        if ( 0 == ( offset_in_bits & 7 ) ) {
-            memmove( &value, src_ptr, bitlength_2_bytes( element_bits ) );
-        } else {
-            bitcpy ( &value, 0, src_ptr, offset_in_bits, element_bits );
-        }
-        *dst = value;
+        *dst = helper_extract_int( src_buffer, offset_in_bits, element_bits );
+    }
+    return rc;
+}
+
+rc_t helper_read_vdb_int_direct( const VCursor* src_cursor,
+                                 const int64_t row_id,
+                                 const uint32_t col_idx,
+                                 uint64_t * dst ) {
+    const void *src_buffer;
+    uint32_t offset_in_bits;
+    uint32_t element_bits;
+    uint32_t element_count;
+
+    rc_t rc = VCursorCellDataDirect( src_cursor, row_id, col_idx, &element_bits,
+                  &src_buffer, &offset_in_bits, &element_count );
+    DISP_RC( rc, "helper_read_vdb_int_direct:VCursorCellDataDirect() failed" );
+    if ( 0 == rc ) {
+        *dst = helper_extract_int( src_buffer, offset_in_bits, element_bits );
     }
     return rc;
 }
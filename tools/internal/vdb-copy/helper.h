@@ -128,6 +128,17 @@ rc_t helper_read_vdb_int( const VCursor* src_cursor,
                           uint64_t * dst );
 
 
+/*
+ * reads a int64 out of a vdb-table:
+ * needs a open cursor, does not open a row ( VCursorCellDataDirect )
+ * can be used by multiple threads, each with its own cursor
+*/
+rc_t helper_read_vdb_int_direct( const VCursor* src_cursor,
+                                 const int64_t row_id,
+                                 const uint32_t col_idx,
+                                 uint64_t * dst );
+
+
 /*
  * reads a string out of a KConfig-object:
  * needs a cfg-object, and the full name of the key(node)
@@ -40,6 +40,10 @@
 #include <klib/progressbar.h>
 #endif
 
+#ifndef _h_klib_namelist_
+#include <klib/namelist.h>
+#endif
+
 #ifndef _h_vdb_database_
 #include <vdb/database.h>
 #endif
@@ -64,6 +68,14 @@
 #include "copy_meta.h"
 #endif
 
+#ifndef _h_copy_blobs_h
+#include "copy_blobs.h"
+#endif
+
+#ifndef _h_copy_workers_h
+#include "copy_workers.h"
+#endif
+
 static const char * table_usage[] = { "table-name", NULL };
 static const char * rows_usage[] = { "set of rows to be copied(default = all)", NULL };
 #if ALLOW_COLUMN_SPEC
@@ -87,6 +99,8 @@ static const char * md5mode_usage[] = { "MD5-mode def.: auto, '1'...forced ON, '
 static const char * blcmode_usage[] = { "Blob-checksum def.: auto, '1'...CRC32, 'M'...MD5, '0'...OFF)", NULL };
 static const char * force_usage[] = { "forces an existing target to be overwritten", NULL };
 static const char * unlock_usage[] = { "forces a locked target to be unlocked", NULL };
+static const char * threads_usage[] = { "number of threads decoding the source ( default: 1, at most 64 )", NULL };
+static const char * no_blob_copy_usage[] = { "always decode and re-encode, never copy unchanged blobs", NULL };
 
 OptDef MyOptions[] = {
     { OPTION_TABLE, ALIAS_TABLE, NULL, table_usage, 1, true, false },
@@ -111,7 +125,9 @@ OptDef MyOptions[] = {
     { OPTION_MD5_MODE, ALIAS_MD5_MODE, NULL, md5mode_usage, 1, true, false },
     { OPTION_BLOB_CHECKSUM, ALIAS_BLOB_CHECKSUM, NULL, blcmode_usage, 1, true, false },
     { OPTION_FORCE, ALIAS_FORCE, NULL, force_usage, 1, false, false },
-    { OPTION_UNLOCK, ALIAS_UNLOCK, NULL, unlock_usage, 1, false, false }
+    { OPTION_UNLOCK, ALIAS_UNLOCK, NULL, unlock_usage, 1, false, false },
+    { OPTION_THREADS, ALIAS_THREADS, NULL, threads_usage, 1, true, false },
+    { OPTION_NO_BLOB_COPY, ALIAS_NO_BLOB_COPY, NULL, no_blob_copy_usage, 1, false, false }
 };
 
 const char UsageDefaultName[] = "vdb-copy";
@@ -164,6 +180,8 @@ rc_t CC Usage ( const Args * args ) {
     HelpOptionLine ( ALIAS_UNLOCK, OPTION_UNLOCK, NULL, unlock_usage );
     HelpOptionLine ( ALIAS_MD5_MODE, OPTION_MD5_MODE, NULL, md5mode_usage );
     HelpOptionLine ( ALIAS_BLOB_CHECKSUM, OPTION_BLOB_CHECKSUM, NULL, blcmode_usage );
+    HelpOptionLine ( ALIAS_THREADS, OPTION_THREADS, "count", threads_usage );
+    HelpOptionLine ( ALIAS_NO_BLOB_COPY, OPTION_NO_BLOB_COPY, NULL, no_blob_copy_usage );
 
     HelpOptionsStandard();
 
@@ -172,6 +190,42 @@ rc_t CC Usage ( const Args * args ) {
     return rc;
 }
 
+/* writes the redacted replacement of a cell with n_elements of elem_bits each */
+static rc_t vdb_copy_write_redacted( VCursor * dst_cursor, const p_col_def col,
+                                     uint64_t row_id, uint32_t elem_bits,
+                                     uint32_t n_elements, redact_buffer * rbuf,
+                                     const bool show_redact ) {
+    size_t new_size = ( ( elem_bits * n_elements ) + 8 ) >> 3;
+    rc_t rc = redact_buf_resize( rbuf, new_size );
+    DISP_RC( rc, "vdb_copy_write_redacted:redact_buf_resize() failed" );
+    if ( 0 == rc ) {
+        if ( col -> r_val != NULL ) {
+            if ( show_redact ) {
+                char * c = ( char * )col -> r_val -> value;
+                KOutMsg( "redacting #%lu %s -> 0x%.02x\n", row_id, col -> dst_cast, *c );
+            }
+            redact_val_fill_buffer( col -> r_val, rbuf, new_size );
+        } else {
+            if ( show_redact ) {
+                KOutMsg( "redacting #%lu %s -> 0\n", row_id, col -> dst_cast );
+            }
+            memset( rbuf -> buffer, 0, new_size );
+        }
+
+        rc = VCursorWrite( dst_cursor, col -> dst_idx, elem_bits,
+                           rbuf -> buffer, 0, n_elements );
+        if ( 0 != rc ) {
+            PLOGERR( klogInt,
+                     ( klogInt,
+                     rc,
+                     "VCursorWrite( col:$(col_name) at row #$(row_nr) ) failed",
+                     "col_name=%s,row_nr=%lu",
+                      col -> name, row_id ) );
+        }
+    }
+    return rc;
+}
+
 static rc_t vdb_copy_redact_cell( const VCursor * src_cursor, VCursor * dst_cursor,
                                   const p_col_def col, uint64_t row_id,
                                   redact_buffer * rbuf,
@@ -192,34 +246,8 @@ static rc_t vdb_copy_redact_cell( const VCursor * src_cursor, VCursor * dst_curs
                  "col_name=%s,row_nr=%lu",
                   col->name, row_id ));
     } else {
-        size_t new_size = ( ( elem_bits * n_elements ) + 8 ) >> 3;
-        rc = redact_buf_resize( rbuf, new_size );
-        DISP_RC( rc, "vdb_copy_redact_cell:redact_buf_resize() failed" );
-        if ( 0 == rc ) {
-            if ( col -> r_val != NULL ) {
-                if ( show_redact ) {
-                    char * c = ( char * )col -> r_val -> value;
-                    KOutMsg( "redacting #%lu %s -> 0x%.02x\n", row_id, col -> dst_cast, *c );
-                }
-                redact_val_fill_buffer( col -> r_val, rbuf, new_size );
-            } else {
-                if ( show_redact ) {
-                    KOutMsg( "redacting #%lu %s -> 0\n", row_id, col -> dst_cast );
-                }
-                memset( rbuf -> buffer, 0, new_size );
-            }
-
-            rc = VCursorWrite( dst_cursor, col -> dst_idx, elem_bits,
-                               rbuf -> buffer, 0, n_elements );
-            if ( 0 != rc ) {
-                PLOGERR( klogInt,
-                         ( klogInt,
-                         rc,
-                         "VCursorWrite( col:$(col_name) at row #$(row_nr) ) failed",
-                         "col_name=%s,row_nr=%lu",
-                          col -> name, row_id ) );
-            }
-        }
+        rc = vdb_copy_write_redacted( dst_cursor, col, row_id, elem_bits, n_elements,
+                                      rbuf, show_redact );
     }
     return rc;
 }
@@ -258,6 +286,29 @@ static rc_t vdb_copy_cell( const VCursor * src_cursor, VCursor * dst_cursor,
     return rc;
 }
 
+static rc_t vdb_copy_commit_row( VCursor * dst_cursor, uint64_t row_id ) {
+    rc_t rc = VCursorCommitRow( dst_cursor );
+    if ( 0 != rc ) {
+        PLOGERR( klogInt,
+                 (klogInt,
+                 rc,
+                 "VCursorCommitRow(dst) row #$(row_nr) failed",
+                 "row_nr=%lu",
+                 row_id ));
+    }
+
+    rc = VCursorCloseRow( dst_cursor );
+    if ( 0 != rc ) {
+        PLOGERR( klogInt,
+                 (klogInt,
+                 rc,
+                 "VCursorCloseRow(dst) row #$(row_nr) failed",
+                 "row_nr=%lu",
+                 row_id ));
+    }
+    return rc;
+}
+
 static rc_t vdb_copy_row( const VCursor * src_cursor,
                           VCursor * dst_cursor,
                           col_defs * columns,
@@ -293,29 +344,26 @@ static rc_t vdb_copy_row( const VCursor * src_cursor,
         }
     }
     if ( 0 == rc ) {
-        rc = VCursorCommitRow( dst_cursor );
-        if ( 0 != rc ) {
-            PLOGERR( klogInt,
-                     (klogInt,
-                     rc,
-                     "VCursorCommitRow(dst) row #$(row_nr) failed",
-                     "row_nr=%lu",
-                     row_id ));
-        }
-
-        rc = VCursorCloseRow( dst_cursor );
-        if ( 0 != rc ) {
-            PLOGERR( klogInt,
-                     (klogInt,
-                     rc,
-                     "VCursorCloseRow(dst) row #$(row_nr) failed",
-                     "row_nr=%lu",
-                     row_id ));
-        }
+        rc = vdb_copy_commit_row( dst_cursor, row_id );
     }
     return rc;
 }
 
+static void vdb_copy_eval_filter( const p_context ctx,
+                                  const uint64_t filter,
+                                  bool *pass,
+                                  bool *redact ) {
+    switch( filter ) {
+    case SRA_READ_FILTER_REJECT   : 
+        if ( ctx -> ignore_reject == false ) { *pass = false; }
+        break;
+
+    case SRA_READ_FILTER_REDACTED : 
+        if ( ctx -> ignore_redact == false ) { *redact = true; }
+        break;
+    }
+}
+
 static rc_t vdb_copy_read_row_flags( const p_context ctx,
                                      const VCursor *cursor,
                                      const uint32_t src_idx,
@@ -326,18 +374,19 @@ static rc_t vdb_copy_read_row_flags( const p_context ctx,
     rc_t rc = helper_read_vdb_int_row_open( cursor, src_idx, &filter );
     if ( 0 != rc ) return rc;
 
-    switch( filter ) {
-    case SRA_READ_FILTER_REJECT   : 
-        if ( ctx -> ignore_reject == false ) { *pass = false; }
-        break;
-
-    case SRA_READ_FILTER_REDACTED : 
-        if ( ctx -> ignore_redact == false ) { *redact = true; }
-        break;
-    }
+    vdb_copy_eval_filter( ctx, filter, pass, redact );
     return rc;
 }
 
+/* num_gen_iterator_next() reports the end of the row-set this way */
+static bool vdb_copy_iter_done( rc_t rc ) {
+    return ( GetRCModule( rc ) == rcVDB && 
+             GetRCTarget( rc ) == rcNoTarg && 
+             GetRCContext( rc ) == rcReading &&
+             GetRCObject( rc ) == rcId &&
+             GetRCState( rc ) == rcInvalid );
+}
+
 static rc_t vdb_copy_row_loop( const p_context ctx,
                                const VCursor * src_cursor,
                                VCursor * dst_cursor,
@@ -417,11 +466,7 @@ static rc_t vdb_copy_row_loop( const p_context ctx,
     }
 
     /* set rc to zero for num_gen_iterator_next() reached last id */
-    if ( GetRCModule( rc ) == rcVDB && 
-         GetRCTarget( rc ) == rcNoTarg && 
-         GetRCContext( rc ) == rcReading &&
-         GetRCObject( rc ) == rcId &&
-         GetRCState( rc ) == rcInvalid ) {
+    if ( vdb_copy_iter_done( rc ) ) {
         rc = 0;
     }
 
@@ -444,6 +489,304 @@ static rc_t vdb_copy_row_loop( const p_context ctx,
     return rc;
 }
 
+/* ---------------------------------------------------------------------------
+   multi-threaded row-loop: the worker-threads read and decode the source with
+   their own cursors, this thread writes their batches in the original row-order
+   --------------------------------------------------------------------------- */
+
+/* how many rows a worker hands over to the writer at once */
+#define VDB_COPY_BATCH_ROWS 4096
+
+typedef struct vdb_copy_reader {
+    p_context ctx;
+    const VTable * src_table;
+    col_defs * columns;
+    const struct num_gen_iter * iter;
+} vdb_copy_reader;
+
+typedef struct vdb_copy_writer {
+    p_context ctx;
+    VCursor * dst_cursor;
+    col_defs * columns;
+    redact_buffer rbuf;
+    struct progressbar * progress;
+    uint64_t processed;
+    uint64_t total;
+    uint64_t count;
+} vdb_copy_writer;
+
+/* does the worker-cursor need this column? */
+static bool vdb_copy_reader_needs( const vdb_copy_reader * self, const p_col_def col, uint32_t idx ) {
+    return ( NULL != col &&
+             ( col -> to_copy || ( int32_t )idx == self -> columns -> filter_idx ) );
+}
+
+static rc_t vdb_copy_reader_open( const vdb_copy_reader * self, const VCursor ** cursor,
+                                  uint32_t * col_idx, uint32_t num_cols ) {
+    rc_t rc = VTableCreateCursorRead( self -> src_table, cursor );
+    DISP_RC( rc, "vdb_copy_reader_open:VTableCreateCursorRead() failed" );
+    if ( 0 == rc ) {
+        uint32_t idx;
+        for ( idx = 0; 0 == rc && idx < num_cols; ++idx ) {
+            p_col_def col = col_defs_get( self -> columns, idx );
+            if ( vdb_copy_reader_needs( self, col, idx ) ) {
+                rc = VCursorAddColumn( *cursor, &( col_idx[ idx ] ), "%s", col -> src_cast );
+                DISP_RC( rc, "vdb_copy_reader_open:VCursorAddColumn() failed" );
+            }
+        }
+        if ( 0 == rc ) {
+            rc = VCursorOpen( *cursor );
+            DISP_RC( rc, "vdb_copy_reader_open:VCursorOpen() failed" );
+        }
+        if ( 0 != rc ) {
+            VCursorRelease( *cursor );
+            *cursor = NULL;
+        }
+    }
+    return rc;
+}
+
+/* reads the filter-flags and the cells of one row into the batch */
+static rc_t vdb_copy_reader_row( const vdb_copy_reader * self, const VCursor * cursor,
+                                 const uint32_t * col_idx, uint32_t num_cols,
+                                 int64_t row_id, row_batch * batch ) {
+    rc_t rc = 0;
+    bool pass_flag = true;
+    bool redact_flag = false;
+    int32_t filter_idx = self -> columns -> filter_idx;
+
+    if ( -1 != filter_idx ) {
+        uint64_t filter;
+        /* like vdb_copy_row_loop(): a row without a readable filter-value is copied unchanged */
+        if ( 0 == helper_read_vdb_int_direct( cursor, row_id, col_idx[ filter_idx ], &filter ) ) {
+            vdb_copy_eval_filter( self -> ctx, filter, &pass_flag, &redact_flag );
+        }
+    }
+    {
+        uint8_t flags = ( pass_flag ? ROW_FLAG_PASS : 0 ) | ( redact_flag ? ROW_FLAG_REDACT : 0 );
+        rc = row_batch_add_row( batch, row_id, flags );
+    }
+    if ( 0 == rc && pass_flag ) {
+        uint32_t idx;
+        for ( idx = 0; 0 == rc && idx < num_cols; ++idx ) {
+            p_col_def col = col_defs_get( self -> columns, idx );
+            if ( NULL != col && col -> to_copy ) {
+                const void * buffer;
+                uint32_t offset_in_bits;
+                uint32_t number_of_elements;
+                uint32_t elem_bits;
+                rc = VCursorCellDataDirect( cursor, row_id, col_idx[ idx ], &elem_bits,
+                                            &buffer, &offset_in_bits, &number_of_elements );
+                if ( 0 != rc ) {
+                    PLOGERR( klogInt,
+                             ( klogInt,
+                             rc,
+                             "VCursorCellDataDirect( col:$(col_name) at row #$(row_nr) ) failed",
+                             "col_name=%s,row_nr=%ld",
+                              col -> name, row_id ) );
+                } else {
+                    rc = row_batch_add_cell( batch, idx, elem_bits, buffer,
+                                             offset_in_bits, number_of_elements );
+                    DISP_RC( rc, "vdb_copy_reader_row:row_batch_add_cell() failed" );
+                }
+            }
+        }
+    }
+    return rc;
+}
+
+/* runs in every worker-thread: produces the batches #worker_id, #worker_id + num_workers ... */
+static rc_t CC vdb_copy_produce( struct ordered_worker * worker, uint32_t worker_id,
+                                 uint32_t num_workers, void * data ) {
+    const vdb_copy_reader * self = data;
+    uint32_t num_cols = VectorLength( &( self -> columns -> cols ) );
+    uint32_t * col_idx = calloc( num_cols > 0 ? num_cols : 1, sizeof col_idx[ 0 ] );
+    const VCursor * cursor = NULL;
+    rc_t rc;
+
+    if ( NULL == col_idx ) {
+        return RC( rcExe, rcNoTarg, rcCopying, rcMemory, rcExhausted );
+    }
+    rc = vdb_copy_reader_open( self, &cursor, col_idx, num_cols );
+    if ( 0 == rc ) {
+        row_batch * batch = NULL;
+        uint64_t row_nr = 0;
+        int64_t row_id;
+        while ( 0 == rc && num_gen_iterator_next( self -> iter, &row_id, &rc ) ) {
+            if ( 0 == rc ) {
+                /* the rows of the batches of the other workers are skipped */
+                uint64_t batch_nr = row_nr++ / VDB_COPY_BATCH_ROWS;
+                if ( worker_id == ( batch_nr % num_workers ) ) {
+                    if ( NULL == batch ) {
+                        rc = row_batch_make( &batch, num_cols, VDB_COPY_BATCH_ROWS );
+                        DISP_RC( rc, "vdb_copy_produce:row_batch_make() failed" );
+                    }
+                    if ( 0 == rc ) {
+                        rc = vdb_copy_reader_row( self, cursor, col_idx, num_cols, row_id, batch );
+                    }
+                    if ( 0 == rc && batch -> row_count == batch -> max_rows ) {
+                        rc = copy_workers_deliver( worker, batch );
+                        batch = NULL;
+                    }
+                }
+            }
+        }
+        if ( vdb_copy_iter_done( rc ) ) {
+            rc = 0;
+        }
+        if ( 0 == rc && NULL != batch ) {
+            /* the last, incomplete batch */
+            rc = copy_workers_deliver( worker, batch );
+            batch = NULL;
+        }
+        row_batch_release( batch );
+        VCursorRelease( cursor );
+    }
+    free( col_idx );
+    return rc;
+}
+
+/* runs in the main thread: writes the batches in order into the dst-cursor */
+static rc_t CC vdb_copy_consume( const row_batch * batch, void * data ) {
+    vdb_copy_writer * self = data;
+    uint32_t num_cols = VectorLength( &( self -> columns -> cols ) );
+    uint32_t row;
+    rc_t rc = 0;
+
+    for ( row = 0; 0 == rc && row < batch -> row_count; ++row ) {
+        int64_t row_id = batch -> row_ids[ row ];
+        uint8_t flags = batch -> flags[ row ];
+        rc = Quitting();    /* to be able to cancel the loop by signal */
+        if ( 0 == rc && 0 != ( flags & ROW_FLAG_PASS ) ) {
+            rc = VCursorOpenRow( self -> dst_cursor );
+            if ( 0 != rc ) {
+                PLOGERR( klogInt, ( klogInt, rc,
+                         "VCursorOpenRow(dst) row #$(row_nr) failed",
+                         "row_nr=%ld", row_id ) );
+            } else {
+                uint32_t idx;
+                for ( idx = 0; 0 == rc && idx < num_cols; ++idx ) {
+                    p_col_def col = col_defs_get( self -> columns, idx );
+                    if ( NULL != col && col -> to_copy ) {
+                        const row_cell * cell = row_batch_get_cell( batch, row, idx );
+                        if ( 0 != ( flags & ROW_FLAG_REDACT ) && col -> redactable ) {
+                            rc = vdb_copy_write_redacted( self -> dst_cursor, col, row_id,
+                                    cell -> elem_bits, cell -> count,
+                                    &( self -> rbuf ), self -> ctx -> show_redact );
+                        } else {
+                            rc = VCursorWrite( self -> dst_cursor, col -> dst_idx, cell -> elem_bits,
+                                               batch -> data + cell -> offset, cell -> boff, cell -> count );
+                            if ( 0 != rc ) {
+                                PLOGERR( klogInt,
+                                         (klogInt,
+                                         rc,
+                                         "VCursorWrite( col:$(col_name) at row #$(row_nr) ) failed",
+                                         "col_name=%s,row_nr=%ld",
+                                          col -> name, row_id ));
+                            }
+                        }
+                    }
+                }
+                if ( 0 == rc ) {
+                    rc = vdb_copy_commit_row( self -> dst_cursor, row_id );
+                }
+            }
+        }
+        if ( 0 == rc ) {
+            self -> count++;
+        }
+    }
+    self -> processed += batch -> row_count;
+    if ( self -> ctx -> show_progress && self -> total > 0 ) {
+        update_progressbar( self -> progress, ( uint32_t )( ( self -> processed * 10000 ) / self -> total ) );
+    }
+    return rc;
+}
+
+static rc_t vdb_copy_row_loop_mt( const p_context ctx,
+                                  const VTable * src_table,
+                                  VCursor * dst_cursor,
+                                  col_defs * columns,
+                                  redact_vals * rvals ) {
+    uint32_t i, num_workers = ctx -> num_threads;
+    vdb_copy_reader * readers = calloc( num_workers, sizeof readers[ 0 ] );
+    void ** data = calloc( num_workers, sizeof data[ 0 ] );
+    vdb_copy_writer writer;
+    rc_t rc = 0;
+
+    if ( NULL == readers || NULL == data ) {
+        free( readers );
+        free( data );
+        return RC( rcExe, rcNoTarg, rcCopying, rcMemory, rcExhausted );
+    }
+    memset( &writer, 0, sizeof writer );
+    /* every worker walks the row-set with its own iterator */
+    for ( i = 0; 0 == rc && i < num_workers; ++i ) {
+        vdb_copy_reader * r = &( readers[ i ] );
+        r -> ctx = ctx;
+        r -> src_table = src_table;
+        r -> columns = columns;
+        rc = num_gen_iterator_make( ctx -> row_generator, &( r -> iter ) );
+        DISP_RC( rc, "vdb_copy_row_loop_mt:num_gen_iterator_make() failed" );
+        data[ i ] = r;
+    }
+    if ( 0 == rc ) {
+        rc = num_gen_iterator_count( readers[ 0 ] . iter, &( writer . total ) );
+        DISP_RC( rc, "vdb_copy_row_loop_mt:num_gen_iterator_count() failed" );
+    }
+    if ( 0 == rc ) {
+        rc = make_progressbar( &( writer . progress ), 2 );
+        DISP_RC( rc, "vdb_copy_row_loop_mt:make_progressbar() failed" );
+    }
+    if ( 0 == rc ) {
+        writer . ctx = ctx;
+        writer . dst_cursor = dst_cursor;
+        writer . columns = columns;
+        redact_buf_init( &( writer . rbuf ) );
+        col_defs_find_redact_vals( columns, rvals );
+
+        /**************************************************/
+        rc = copy_workers_run( num_workers, vdb_copy_produce, data,
+                               vdb_copy_consume, &writer );
+        /**************************************************/
+
+        if ( ctx -> show_progress ) {
+            KOutMsg( "\n" );
+        }
+        destroy_progressbar( writer . progress );
+        redact_buf_free( &( writer . rbuf ) );
+
+        PLOGMSG( klogInfo, ( klogInfo, "\n $(row_cnt) rows copied", "row_cnt=%lu", writer . count ));
+
+        if ( 0 == rc ) {
+            rc = VCursorCommit( dst_cursor );
+            if ( 0 != rc ) {
+                LOGERR( klogInt, rc, "VCursorCommit( dst ) after processing all rows failed" );
+            }
+        }
+    }
+    for ( i = 0; i < num_workers; ++i ) {
+        if ( NULL != readers[ i ] . iter ) {
+            num_gen_iterator_destroy( readers[ i ] . iter );
+        }
+    }
+    free( readers );
+    free( data );
+    return rc;
+}
+
+static rc_t vdb_copy_rows( const p_context ctx,
+                           const VTable * src_table,
+                           const VCursor * src_cursor,
+                           VCursor * dst_cursor,
+                           col_defs * columns,
+                           redact_vals * rvals ) {
+    if ( ctx -> num_threads > 1 ) {
+        return vdb_copy_row_loop_mt( ctx, src_table, dst_cursor, columns, rvals );
+    }
+    return vdb_copy_row_loop( ctx, src_cursor, dst_cursor, columns, rvals );
+}
+
 static rc_t vdb_copy_make_dst_table( const p_context ctx,
                                      VDBManager * vdb_mgr, 
                                      const VSchema * src_schema,
@@ -490,12 +833,11 @@ static rc_t vdb_copy_make_dst_table( const p_context ctx,
     return rc;
 }
 
-static rc_t vdb_copy_open_dest_table( const p_context ctx,
-                                      const VTable * src_table,
-                                      VTable * dst_table,
-                                      VCursor ** dst_cursor,
-                                      col_defs * columns,
-                                      bool is_legacy ) {
+static rc_t vdb_copy_prepare_dest_table( const p_context ctx,
+                                         const VTable * src_table,
+                                         VTable * dst_table,
+                                         col_defs * columns,
+                                         bool is_legacy ) {
     /* copy the metadata */
     rc_t rc = copy_table_meta( src_table, dst_table, 
                           ctx -> config.meta_ignore_nodes, 
@@ -504,11 +846,15 @@ static rc_t vdb_copy_open_dest_table( const p_context ctx,
 
     /* mark all columns which are to be found writable as to_copy */
     rc = col_defs_mark_writable_columns( columns, dst_table, false );
-    DISP_RC( rc, "vdb_copy_open_dest_table:col_defs_mark_writable_columns() failed" );
-    if ( 0 != rc ) return rc;
+    DISP_RC( rc, "vdb_copy_prepare_dest_table:col_defs_mark_writable_columns() failed" );
+    return rc;
+}
 
+static rc_t vdb_copy_open_dest_table( VTable * dst_table,
+                                      VCursor ** dst_cursor,
+                                      col_defs * columns ) {
     /* make a writable cursor */
-    rc = VTableCreateCursorWrite( dst_table, dst_cursor, kcmInsert );
+    rc_t rc = VTableCreateCursorWrite( dst_table, dst_cursor, kcmInsert );
     DISP_RC( rc, "vdb_copy_open_dest_table:VTableCreateCursorWrite(dst) failed" );
     if ( 0 != rc ) return rc;
 
@@ -764,6 +1110,142 @@ static rc_t vdb_copy_open_source_table( const p_context ctx,
     return vdb_copy_check_range( ctx, src_cursor );
 }
 
+/* can we copy physical columns blob by blob instead of cell by cell?
+   only if every row is copied, and nothing depends on the write-cursor:
+   no schema given by the user and no index in the source-table */
+static bool vdb_copy_blobs_allowed( const p_context ctx,
+                                    const VTable * src_table,
+                                    col_defs * columns,
+                                    bool is_legacy ) {
+    bool filter_active = ( -1 != columns -> filter_idx );
+
+    if ( ctx -> no_blob_copy || is_legacy || ctx -> row_range_given ) {
+        return false;
+    }
+    if ( context_schema_count( ctx ) > 0 ) {
+        return false;
+    }
+    if ( NULL != ctx -> excluded_columns ||
+         ( NULL != ctx -> columns && 0 != nlt_strcmp( ctx -> columns, "*" ) ) ) {
+        return false;
+    }
+    /* rejected rows would be dropped */
+    if ( filter_active && !( ctx -> ignore_reject ) ) {
+        return false;
+    }
+    return !copy_blobs_src_indexed( src_table );
+}
+
+/* are the cells of this column copied unchanged? */
+static bool vdb_copy_column_unchanged( const p_context ctx,
+                                       const p_col_def col,
+                                       bool filter_active ) {
+    /* a type-cast between source and destination */
+    if ( NULL == col -> src_cast || NULL == col -> dst_cast ||
+         0 != nlt_strcmp( col -> src_cast, col -> dst_cast ) ) {
+        return false;
+    }
+    /* redacted cells would be replaced */
+    if ( filter_active && !( ctx -> ignore_redact ) && col -> redactable ) {
+        return false;
+    }
+    return true;
+}
+
+/* decides column by column, returns the number of columns copied blob by blob:
+   - if all columns are unchanged, the whole table is copied blob by blob
+   - otherwise every unchanged column with a physical column of the same name
+     is marked blob_copy and taken away from the write-cursor */
+static uint32_t vdb_copy_mark_blob_columns( const p_context ctx,
+                                            const VTable * src_table,
+                                            col_defs * columns,
+                                            bool * whole_table ) {
+    bool filter_active = ( -1 != columns -> filter_idx );
+    uint32_t idx, len = VectorLength( &( columns -> cols ) );
+    uint32_t changed = 0, marked = 0;
+
+    for ( idx = 0; idx < len; ++idx ) {
+        p_col_def col = col_defs_get( columns, idx );
+        if ( NULL != col && col -> to_copy && !vdb_copy_column_unchanged( ctx, col, filter_active ) ) {
+            changed++;
+        }
+    }
+    *whole_table = ( 0 == changed );
+    if ( *whole_table ) {
+        return len;
+    }
+    for ( idx = 0; idx < len; ++idx ) {
+        p_col_def col = col_defs_get( columns, idx );
+        if ( NULL != col && col -> to_copy &&
+             vdb_copy_column_unchanged( ctx, col, filter_active ) &&
+             copy_blobs_src_has_column( src_table, col -> name ) ) {
+            col -> blob_copy = true;
+            col -> to_copy = false;
+            marked++;
+        }
+    }
+    return marked;
+}
+
+static rc_t vdb_copy_blobs( const p_context ctx,
+                            const VTable * src_table,
+                            VTable * dst_table,
+                            KCreateMode cmode ) {
+    KChecksum cs_mode = helper_assemble_ChecksumMode( ctx -> blob_checksum );
+    rc_t rc;
+
+    LOGMSG( klogInfo, "columns unchanged: copying blobs without decoding" );
+    rc = copy_blobs_table( src_table, dst_table, cmode, cs_mode,
+                           ctx -> show_progress, ctx -> show_meta );
+    DISP_RC( rc, "vdb_copy_blobs:copy_blobs_table() failed" );
+    if ( 0 == rc ) {
+        /* no write-cursor has produced these nodes, take them from the source */
+        rc = copy_table_meta_nodes( src_table, dst_table, META_BLOB_COPY_NODES, ctx -> show_meta );
+        DISP_RC( rc, "vdb_copy_blobs:copy_table_meta_nodes() failed" );
+    }
+    return rc;
+}
+
+/* copies the columns marked blob_copy, after the write-cursor is released */
+static rc_t vdb_copy_blob_columns( const p_context ctx,
+                                   const VTable * src_table,
+                                   VTable * dst_table,
+                                   col_defs * columns,
+                                   KCreateMode cmode ) {
+    KChecksum cs_mode = helper_assemble_ChecksumMode( ctx -> blob_checksum );
+    VNamelist * names;
+    rc_t rc = VNamelistMake( &names, 8 );
+    DISP_RC( rc, "vdb_copy_blob_columns:VNamelistMake() failed" );
+    if ( 0 == rc ) {
+        uint32_t idx, len = VectorLength( &( columns -> cols ) );
+        for ( idx = 0; 0 == rc && idx < len; ++idx ) {
+            p_col_def col = col_defs_get( columns, idx );
+            if ( NULL != col && col -> blob_copy ) {
+                rc = VNamelistAppend( names, col -> name );
+                DISP_RC( rc, "vdb_copy_blob_columns:VNamelistAppend() failed" );
+            }
+        }
+        if ( 0 == rc ) {
+            const KNamelist * list;
+            rc = VNamelistToConstNamelist( names, &list );
+            DISP_RC( rc, "vdb_copy_blob_columns:VNamelistToConstNamelist() failed" );
+            if ( 0 == rc ) {
+                rc = copy_blobs_columns( src_table, dst_table, list, cmode, cs_mode,
+                                         ctx -> show_progress, ctx -> show_meta );
+                DISP_RC( rc, "vdb_copy_blob_columns:copy_blobs_columns() failed" );
+                KNamelistRelease( list );
+            }
+        }
+        VNamelistRelease( names );
+    }
+    if ( 0 == rc ) {
+        /* the write-cursor did not see all columns, take these nodes from the source */
+        rc = copy_table_meta_nodes( src_table, dst_table, META_BLOB_COPY_NODES, ctx -> show_meta );
+        DISP_RC( rc, "vdb_copy_blob_columns:copy_table_meta_nodes() failed" );
+    }
+    return rc;
+}
+
 static rc_t vdb_copy_table2( const p_context ctx,
                              VDBManager * vdb_mgr,
                              const VTable * src_table,
@@ -781,21 +1263,38 @@ static rc_t vdb_copy_table2( const p_context ctx,
                                      src_table, src_cursor, cmode, &dst_table, columns,
                                      &is_legacy, type_matcher );
     if ( 0 == rc ) {
-        VCursor * dst_cursor;
-        rc = vdb_copy_open_dest_table( ctx, src_table, dst_table, &dst_cursor, columns, 
-                                       is_legacy );
+        rc = vdb_copy_prepare_dest_table( ctx, src_table, dst_table, columns, is_legacy );
         if ( 0 == rc ) {
             /* this function does not fail, because it is ok to not find
                filter-column, redactable types and excluded columns */
             vdb_copy_find_filter_and_redact_columns( src_schema,
                                    columns, &(ctx->config), type_matcher );
 
-            rc = vdb_copy_row_loop( ctx, src_cursor, dst_cursor,
-                                    columns, ctx->rvals );
-
-            {
-                rc_t rc1 = VCursorRelease( dst_cursor );
-                DISP_RC( rc1, "vdb_copy_table2:VCursorRelease() failed" );
+            bool whole_table = false;
+            uint32_t blob_columns = 0;
+            if ( vdb_copy_blobs_allowed( ctx, src_table, columns, is_legacy ) ) {
+                blob_columns = vdb_copy_mark_blob_columns( ctx, src_table, columns, &whole_table );
+            }
+            if ( whole_table ) {
+                rc = vdb_copy_blobs( ctx, src_table, dst_table, cmode );
+            } else {
+                VCursor * dst_cursor = NULL;
+                if ( blob_columns > 0 ) {
+                    PLOGMSG( klogInfo, ( klogInfo, "$(n) columns unchanged: copying their blobs without decoding",
+                                         "n=%u", blob_columns ) );
+                }
+                rc = vdb_copy_open_dest_table( dst_table, &dst_cursor, columns );
+                if ( 0 == rc ) {
+                    rc = vdb_copy_rows( ctx, src_table, src_cursor, dst_cursor,
+                                        columns, ctx->rvals );
+                }
+                {
+                    rc_t rc1 = VCursorRelease( dst_cursor );
+                    DISP_RC( rc1, "vdb_copy_table2:VCursorRelease() failed" );
+                }
+                if ( 0 == rc && blob_columns > 0 ) {
+                    rc = vdb_copy_blob_columns( ctx, src_table, dst_table, columns, cmode );
+                }
             }
             if ( 0 == rc && ctx -> reindex ) {
                 /* releasing the cursor is necessary for reindex */
@@ -859,6 +1358,7 @@ static rc_t perform_vdb_copy_on_table( const p_context ctx,
 }
 
 static rc_t vdb_copy_cur_2_cur( const p_context ctx,
+                                const VTable * src_tab,
                                 const VCursor * src_cursor,
                                 VCursor * dst_cursor,
                                 const VSchema * schema,
@@ -899,8 +1399,8 @@ static rc_t vdb_copy_cur_2_cur( const p_context ctx,
                                                    columns, &(ctx->config), type_matcher );
 
                             /**************************************************/
-                            rc = vdb_copy_row_loop( ctx, src_cursor, dst_cursor,
-                                                    columns, ctx->rvals );
+                            rc = vdb_copy_rows( ctx, src_tab, src_cursor, dst_cursor,
+                                                columns, ctx->rvals );
                             /**************************************************/
                         }
                     }
@@ -950,7 +1450,7 @@ static rc_t vdb_copy_tab_2_tab( const p_context ctx,
                                     DISP_RC( rc, "vdb_copy_tab_2_tab:VTableCreateCursorWrite(dst) failed" );
                                     if ( 0 == rc ) {
                                         /*****************************************************/
-                                        rc = vdb_copy_cur_2_cur( ctx, src_cursor, dst_cursor,
+                                        rc = vdb_copy_cur_2_cur( ctx, src_tab, src_cursor, dst_cursor,
                                                                  schema, columns, type_matcher,
                                                                  tab_name );
                                         /*****************************************************/
@@ -0,0 +1,784 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "blob_by_blob.h"
+
+#include <klib/log.h>
+#include <klib/out.h>
+#include <klib/namelist.h>
+#include <klib/data-buffer.h>
+#include <kfs/directory.h>
+#include <kfs/file.h>
+#include <kdb/table.h>
+#include <kdb/column.h>
+#include <kdb/meta.h>
+#include <kdb/namelist.h>
+#include <kdb/kdb-priv.h>   /* KTableOpenDirectoryRead */
+#include <kproc/thread.h>
+#include <vdb/vdb-priv.h>   /* VTableOpenKTableRead */
+
+#include "namelist_tools.h"
+
+#include <atomic32.h>
+#include <sysalloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+rc_t Quitting( void );  /* because we cannot include <kapp/main.h> where it is defined! */
+
+/********************************************************************
+the suspect rows
+********************************************************************/
+static rc_t bbb_add_range( suspect_rows * rows, int64_t first, uint64_t count )
+{
+	if ( rows -> count > 0 )
+	{
+		/* ranges are added in ascending order: extend the last one if they touch */
+		suspect_range * last = &( rows -> ranges[ rows -> count - 1 ] );
+		int64_t last_end = last -> first + ( int64_t )last -> count;
+		if ( first >= last -> first && first <= last_end )
+		{
+			int64_t end = first + ( int64_t )count;
+			if ( end > last_end )
+				last -> count = ( uint64_t )( end - last -> first );
+			return 0;
+		}
+	}
+
+	if ( rows -> count == rows -> allocated )
+	{
+		uint32_t allocated = ( rows -> allocated == 0 ) ? 64 : rows -> allocated * 2;
+		suspect_range * tmp = realloc( rows -> ranges, allocated * sizeof *tmp );
+		if ( tmp == NULL )
+		{
+			rc_t rc = RC( rcExe, rcBuffer, rcResizing, rcMemory, rcExhausted );
+			LOGERR ( klogInt, rc, "cannot grow list of suspect rows" );
+			return rc;
+		}
+		rows -> ranges = tmp;
+		rows -> allocated = allocated;
+	}
+	rows -> ranges[ rows -> count ].first = first;
+	rows -> ranges[ rows -> count ].count = count;
+	rows -> count++;
+	return 0;
+}
+
+static int CC bbb_cmp_range( const void * a, const void * b )
+{
+	const suspect_range * r1 = a;
+	const suspect_range * r2 = b;
+	if ( r1 -> first < r2 -> first ) return -1;
+	if ( r1 -> first > r2 -> first ) return 1;
+	return 0;
+}
+
+void bbb_release_suspect_rows( suspect_rows * rows )
+{
+	if ( rows != NULL )
+	{
+		free( rows -> ranges );
+		free( rows );
+	}
+}
+
+bool bbb_is_suspect( const suspect_rows * rows, int64_t row_id )
+{
+	uint32_t lo = 0, hi;
+	if ( rows == NULL )
+		return true;
+	hi = rows -> count;
+	while ( lo < hi )
+	{
+		uint32_t mid = lo + ( hi - lo ) / 2;
+		const suspect_range * r = &( rows -> ranges[ mid ] );
+		if ( row_id < r -> first )
+			hi = mid;
+		else if ( row_id >= r -> first + ( int64_t )r -> count )
+			lo = mid + 1;
+		else
+			return true;
+	}
+	return false;
+}
+
+uint64_t bbb_suspect_count( const suspect_rows * rows )
+{
+	uint64_t res = 0;
+	if ( rows != NULL )
+	{
+		uint32_t i;
+		for ( i = 0; i < rows -> count; ++i )
+			res += rows -> ranges[ i ].count;
+	}
+	return res;
+}
+
+
+/********************************************************************
+comparing the md5-files of a column
+********************************************************************/
+static rc_t bbb_read_md5_file( const KTable * ktab, const char * name, char ** data, uint64_t * size )
+{
+	const KDirectory * dir;
+	rc_t rc = KTableOpenDirectoryRead( ktab, &dir );
+	*data = NULL;
+	*size = 0;
+	if ( rc != 0 )
+	{
+		LOGERR ( klogInt, rc, "KTableOpenDirectoryRead() failed" );
+	}
+	else
+	{
+		const KFile * f;
+		/* no md5-file is not an error, the column has been created without it */
+		if ( KDirectoryOpenFileRead( dir, &f, "col/%s/md5", name ) == 0 )
+		{
+			rc = KFileSize( f, size );
+			if ( rc == 0 && *size > 0 )
+			{
+				*data = malloc( *size );
+				if ( *data == NULL )
+					rc = RC( rcExe, rcFile, rcReading, rcMemory, rcExhausted );
+				else
+				{
+					size_t num_read;
+					rc = KFileReadAll( f, 0, *data, *size, &num_read );
+					if ( rc == 0 && num_read != *size )
+						rc = RC( rcExe, rcFile, rcReading, rcData, rcInsufficient );
+					if ( rc != 0 )
+					{
+						free( *data );
+						*data = NULL;
+					}
+				}
+			}
+			if ( rc != 0 )
+			{
+				PLOGERR( klogInt, ( klogInt, rc, "cannot read md5-file of column '$(col)'", "col=%s", name ) );
+			}
+			KFileRelease( f );
+		}
+		KDirectoryRelease( dir );
+	}
+	return rc;
+}
+
+static rc_t bbb_md5_equal( const KTable * ktab_1, const KTable * ktab_2, const char * name, bool * equal )
+{
+	char * md5_1;
+	uint64_t size_1;
+	rc_t rc = bbb_read_md5_file( ktab_1, name, &md5_1, &size_1 );
+	*equal = false;
+	if ( rc == 0 && md5_1 != NULL )
+	{
+		char * md5_2;
+		uint64_t size_2;
+		rc = bbb_read_md5_file( ktab_2, name, &md5_2, &size_2 );
+		if ( rc == 0 && md5_2 != NULL )
+		{
+			/* the md5-file lists the digest of every file of the column */
+			*equal = ( size_1 == size_2 && memcmp( md5_1, md5_2, size_1 ) == 0 );
+			free( md5_2 );
+		}
+		free( md5_1 );
+	}
+	return rc;
+}
+
+
+/********************************************************************
+comparing the stored blobs of a column
+********************************************************************/
+static rc_t bbb_blob_size( const KColumnBlob * blob, size_t * size )
+{
+	char probe[ 8 ];
+	size_t num_read, remaining;
+	rc_t rc = KColumnBlobRead ( blob, 0, probe, 0, &num_read, &remaining );
+	if ( rc != 0 )
+	{
+		LOGERR ( klogInt, rc, "KColumnBlobRead() failed" );
+	}
+	else
+		*size = num_read + remaining;
+	return rc;
+}
+
+/* reads the blob together with the CRC32/MD5 stored for it, the checksum stays zero if the column has none */
+static rc_t bbb_read_blob( const KColumnBlob * blob, KDataBuffer * buf, KColumnBlobCSData * cs )
+{
+	rc_t rc;
+	memset( cs, 0, sizeof *cs );
+	rc = KColumnBlobReadAll ( blob, buf, cs, sizeof *cs );
+	if ( rc != 0 )
+	{
+		LOGERR ( klogInt, rc, "KColumnBlobReadAll() failed" );
+	}
+	return rc;
+}
+
+static bool bbb_has_checksum( const KColumnBlobCSData * cs )
+{
+	static const KColumnBlobCSData none;
+	return ( memcmp( cs, &none, sizeof none ) != 0 );
+}
+
+/* blobs of the same size: the stored checksums decide, the bytes only if there are none */
+static rc_t bbb_blobs_equal( const KColumnBlob * blob_1, const KColumnBlob * blob_2, bool * equal )
+{
+	KDataBuffer buf_1;
+	KColumnBlobCSData cs_1;
+	rc_t rc = bbb_read_blob( blob_1, &buf_1, &cs_1 );
+	if ( rc == 0 )
+	{
+		KDataBuffer buf_2;
+		KColumnBlobCSData cs_2;
+		rc = bbb_read_blob( blob_2, &buf_2, &cs_2 );
+		if ( rc == 0 )
+		{
+			if ( bbb_has_checksum( &cs_1 ) && bbb_has_checksum( &cs_2 ) )
+				*equal = ( memcmp( &cs_1, &cs_2, sizeof cs_1 ) == 0 );
+			else
+				*equal = ( buf_1.elem_count == buf_2.elem_count &&
+						   memcmp( buf_1.base, buf_2.base, ( size_t )buf_1.elem_count ) == 0 );
+			KDataBufferWhack( &buf_2 );
+		}
+		KDataBufferWhack( &buf_1 );
+	}
+	return rc;
+}
+
+typedef struct bbb_worker
+{
+	KThread * thread;
+	const KTable * ktab_1;
+	const KTable * ktab_2;
+	const KNamelist * names;
+	uint32_t name_count;
+	atomic32_t * next_col;		/* shared by all workers: index of the next column to check */
+	bool show_progress;
+
+	suspect_rows rows;			/* what this worker has found */
+	uint64_t blobs_checked;
+	uint64_t blobs_different;
+	uint32_t cols_md5_equal;
+} bbb_worker;
+
+/* row_id is in a gap of col_1: if col_2 has a blob there, all of its rows are suspect,
+   otherwise both columns are skipped up to the next blob of either one */
+static rc_t bbb_diff_gap( bbb_worker * w, const KColumn * col_1, const KColumn * col_2,
+						  int64_t row_id, int64_t * next )
+{
+	const KColumnBlob * blob_2;
+	rc_t rc = KColumnOpenBlobRead( col_2, &blob_2, row_id );
+	if ( rc == 0 )
+	{
+		int64_t first_2;
+		uint32_t count_2;
+		rc = KColumnBlobIdRange( blob_2, &first_2, &count_2 );
+		if ( rc != 0 )
+		{
+			LOGERR ( klogInt, rc, "KColumnBlobIdRange( acc #2 ) failed" );
+		}
+		else
+		{
+			*next = first_2 + count_2;
+			w -> blobs_checked++;
+			w -> blobs_different++;
+			rc = bbb_add_range( &( w -> rows ), first_2, count_2 );
+		}
+		KColumnBlobRelease( blob_2 );
+	}
+	else if ( GetRCState( rc ) == rcNotFound )
+	{
+		int64_t found_1, found_2;
+		rc_t rc_1 = KColumnFindFirstRowId( col_1, &found_1, row_id );
+		rc_t rc_2 = KColumnFindFirstRowId( col_2, &found_2, row_id );
+		rc = 0;
+		if ( rc_1 != 0 && GetRCState( rc_1 ) != rcNotFound )
+			rc = rc_1;
+		else if ( rc_2 != 0 && GetRCState( rc_2 ) != rcNotFound )
+			rc = rc_2;
+		if ( rc != 0 )
+		{
+			LOGERR ( klogInt, rc, "KColumnFindFirstRowId() failed" );
+		}
+		else if ( rc_1 == 0 && ( rc_2 != 0 || found_1 < found_2 ) )
+			*next = found_1;
+		else if ( rc_2 == 0 )
+			*next = found_2;
+		else
+			*next = INT64_MAX;	/* no blob left in either column */
+	}
+	else
+	{
+		LOGERR ( klogInt, rc, "KColumnOpenBlobRead( acc #2 ) failed" );
+	}
+	return rc;
+}
+
+/* compares the blob of col_1 containing row_id with its counterpart in col_2,
+   returns the first row after the blob in *next */
+static rc_t bbb_diff_blob( bbb_worker * w, const KColumn * col_1, const KColumn * col_2,
+						   int64_t row_id, int64_t * next )
+{
+	const KColumnBlob * blob_1;
+	rc_t rc = KColumnOpenBlobRead( col_1, &blob_1, row_id );
+	if ( rc != 0 )
+	{
+		if ( GetRCState( rc ) == rcNotFound )
+			return bbb_diff_gap( w, col_1, col_2, row_id, next );
+		LOGERR ( klogInt, rc, "KColumnOpenBlobRead( acc #1 ) failed" );
+	}
+	else
+	{
+		int64_t first_1;
+		uint32_t count_1;
+		rc = KColumnBlobIdRange( blob_1, &first_1, &count_1 );
+		if ( rc != 0 )
+		{
+			LOGERR ( klogInt, rc, "KColumnBlobIdRange( acc #1 ) failed" );
+		}
+		else
+		{
+			const KColumnBlob * blob_2;
+			bool equal = false;
+
+			*next = first_1 + count_1;
+			if ( KColumnOpenBlobRead( col_2, &blob_2, first_1 ) == 0 )
+			{
+				int64_t first_2;
+				uint32_t count_2;
+				rc = KColumnBlobIdRange( blob_2, &first_2, &count_2 );
+				if ( rc != 0 )
+				{
+					LOGERR ( klogInt, rc, "KColumnBlobIdRange( acc #2 ) failed" );
+				}
+				else if ( first_1 == first_2 && count_1 == count_2 )
+				{
+					size_t size_1, size_2;
+					rc = bbb_blob_size( blob_1, &size_1 );
+					if ( rc == 0 )
+						rc = bbb_blob_size( blob_2, &size_2 );
+					/* only if the sizes match, we have to look at the checksums */
+					if ( rc == 0 && size_1 == size_2 )
+						rc = bbb_blobs_equal( blob_1, blob_2, &equal );
+				}
+				else
+				{
+					/* the blob-boundaries are different, the rows of both blobs are suspect */
+					if ( first_2 < first_1 )
+						first_1 = first_2;
+					if ( first_2 + count_2 > *next )
+						*next = first_2 + count_2;
+					count_1 = ( uint32_t )( *next - first_1 );
+				}
+				KColumnBlobRelease( blob_2 );
+			}
+
+			w -> blobs_checked++;
+			if ( rc == 0 && !equal )
+			{
+				w -> blobs_different++;
+				rc = bbb_add_range( &( w -> rows ), first_1, count_1 );
+			}
+		}
+		KColumnBlobRelease( blob_1 );
+	}
+	return rc;
+}
+
+static rc_t bbb_diff_column( bbb_worker * w, const char * name )
+{
+	bool md5_equal;
+	rc_t rc = bbb_md5_equal( w -> ktab_1, w -> ktab_2, name, &md5_equal );
+	if ( rc == 0 && md5_equal )
+	{
+		w -> cols_md5_equal++;
+		if ( w -> show_progress )
+			rc = KOutMsg( "column '%s' : md5 identical\n", name );
+	}
+	else if ( rc == 0 )
+	{
+		const KColumn * col_1;
+		rc = KTableOpenColumnRead( w -> ktab_1, &col_1, "%s", name );
+		if ( rc != 0 )
+		{
+			PLOGERR( klogInt, ( klogInt, rc, "KTableOpenColumnRead( #1 '$(col)' ) failed", "col=%s", name ) );
+		}
+		else
+		{
+			const KColumn * col_2;
+			rc = KTableOpenColumnRead( w -> ktab_2, &col_2, "%s", name );
+			if ( rc != 0 )
+			{
+				PLOGERR( klogInt, ( klogInt, rc, "KTableOpenColumnRead( #2 '$(col)' ) failed", "col=%s", name ) );
+			}
+			else
+			{
+				int64_t first_1, first_2;
+				uint64_t count_1, count_2;
+				rc = KColumnIdRange( col_1, &first_1, &count_1 );
+				if ( rc == 0 )
+					rc = KColumnIdRange( col_2, &first_2, &count_2 );
+				if ( rc != 0 )
+				{
+					PLOGERR( klogInt, ( klogInt, rc, "KColumnIdRange( '$(col)' ) failed", "col=%s", name ) );
+				}
+				else
+				{
+					uint64_t blobs_different = w -> blobs_different;
+					int64_t row_id = first_1;
+					int64_t end = first_1 + count_1;
+
+					/* rows only one of the columns has are suspect */
+					if ( first_2 != first_1 || count_2 != count_1 )
+					{
+						int64_t end_2 = first_2 + count_2;
+						int64_t lo = ( first_1 < first_2 ) ? first_1 : first_2;
+						int64_t hi = ( end > end_2 ) ? end : end_2;
+						rc = bbb_add_range( &( w -> rows ), lo, ( uint64_t )( hi - lo ) );
+						row_id = end;
+					}
+
+					while ( rc == 0 && row_id < end )
+					{
+						rc = Quitting();    /* to be able to cancel the loop by signal */
+						if ( rc == 0 )
+							rc = bbb_diff_blob( w, col_1, col_2, row_id, &row_id );
+					}
+
+					if ( rc == 0 && w -> show_progress )
+						rc = KOutMsg( "column '%s' : %,lu blobs differ\n",
+									  name, w -> blobs_different - blobs_different );
+				}
+				KColumnRelease( col_2 );
+			}
+			KColumnRelease( col_1 );
+		}
+	}
+	return rc;
+}
+
+static rc_t CC bbb_thread( const KThread * thread, void * data )
+{
+	bbb_worker * w = data;
+	rc_t rc = 0;
+	while ( rc == 0 )
+	{
+		uint32_t idx = ( uint32_t )atomic32_read_and_add( w -> next_col, 1 );
+		if ( idx >= w -> name_count )
+			break;
+		else
+		{
+			const char * name;
+			rc = KNamelistGet( w -> names, idx, &name );
+			if ( rc != 0 )
+			{
+				LOGERR ( klogInt, rc, "KNamelistGet() failed" );
+			}
+			else
+				rc = bbb_diff_column( w, name );
+		}
+	}
+	if ( rc != 0 )
+		atomic32_set( w -> next_col, w -> name_count );	/* let the other workers stop too */
+	return rc;
+}
+
+
+/********************************************************************
+the schema has to be identical, otherwise the same physical data can
+produce different cells
+********************************************************************/
+static rc_t bbb_read_schema( const KTable * ktab, char ** data, size_t * size )
+{
+	const KMetadata * meta;
+	rc_t rc = KTableOpenMetadataRead( ktab, &meta );
+	*data = NULL;
+	*size = 0;
+	if ( rc != 0 )
+	{
+		LOGERR ( klogInt, rc, "KTableOpenMetadataRead() failed" );
+	}
+	else
+	{
+		const KMDataNode * node;
+		/* no schema-node ( legacy tables ): we cannot tell, *data stays NULL */
+		if ( KMetadataOpenNodeRead( meta, &node, "schema" ) == 0 )
+		{
+			char probe[ 8 ];
+			size_t num_read, remaining;
+			rc = KMDataNodeRead( node, 0, probe, 0, &num_read, &remaining );
+			if ( rc == 0 && remaining > 0 )
+			{
+				*data = malloc( remaining );
+				if ( *data == NULL )
+					rc = RC( rcExe, rcNode, rcReading, rcMemory, rcExhausted );
+				else
+				{
+					rc = KMDataNodeRead( node, 0, *data, remaining, size, NULL );
+					if ( rc != 0 )
+					{
+						free( *data );
+						*data = NULL;
+					}
+				}
+			}
+			if ( rc != 0 )
+			{
+				LOGERR ( klogInt, rc, "KMDataNodeRead( 'schema' ) failed" );
+			}
+			KMDataNodeRelease( node );
+		}
+		KMetadataRelease( meta );
+	}
+	return rc;
+}
+
+static rc_t bbb_schema_equal( const KTable * ktab_1, const KTable * ktab_2, bool * equal )
+{
+	char * schema_1;
+	size_t size_1;
+	rc_t rc = bbb_read_schema( ktab_1, &schema_1, &size_1 );
+	*equal = false;
+	if ( rc == 0 && schema_1 != NULL )
+	{
+		char * schema_2;
+		size_t size_2;
+		rc = bbb_read_schema( ktab_2, &schema_2, &size_2 );
+		if ( rc == 0 && schema_2 != NULL )
+		{
+			*equal = ( size_1 == size_2 && memcmp( schema_1, schema_2, size_1 ) == 0 );
+			free( schema_2 );
+		}
+		free( schema_1 );
+	}
+	return rc;
+}
+
+
+/********************************************************************
+spread the physical columns over the workers, merge what they found
+********************************************************************/
+static rc_t bbb_merge( bbb_worker * workers, uint32_t num_workers, suspect_rows * rows )
+{
+	rc_t rc = 0;
+	uint32_t i, total = 0;
+	suspect_range * all;
+
+	for ( i = 0; i < num_workers; ++i )
+		total += workers[ i ].rows.count;
+	if ( total == 0 )
+		return 0;
+
+	all = malloc( total * sizeof *all );
+	if ( all == NULL )
+	{
+		rc = RC( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+		LOGERR ( klogInt, rc, "cannot merge suspect rows" );
+	}
+	else
+	{
+		uint32_t n = 0;
+		for ( i = 0; i < num_workers; ++i )
+		{
+			memmove( &all[ n ], workers[ i ].rows.ranges, workers[ i ].rows.count * sizeof *all );
+			n += workers[ i ].rows.count;
+		}
+		qsort( all, total, sizeof *all, bbb_cmp_range );
+		for ( i = 0; rc == 0 && i < total; ++i )
+			rc = bbb_add_range( rows, all[ i ].first, all[ i ].count );
+		free( all );
+	}
+	return rc;
+}
+
+static rc_t bbb_diff_phys_columns( const KTable * ktab_1, const KTable * ktab_2, const KNamelist * names,
+								   const struct diff_ctx * dctx, suspect_rows * rows )
+{
+	uint32_t name_count;
+	rc_t rc = KNamelistCount( names, &name_count );
+	if ( rc != 0 )
+	{
+		LOGERR ( klogInt, rc, "KNamelistCount() failed" );
+	}
+	else
+	{
+		uint32_t num_workers = dctx -> num_threads;
+		bbb_worker * workers;
+
+		if ( num_workers > name_count ) num_workers = name_count;
+		if ( num_workers == 0 ) num_workers = 1;
+
+		workers = calloc( num_workers, sizeof *workers );
+		if ( workers == NULL )
+		{
+			rc = RC( rcExe, rcThread, rcAllocating, rcMemory, rcExhausted );
+			LOGERR ( klogInt, rc, "cannot allocate workers" );
+		}
+		else
+		{
+			atomic32_t next_col;
+			uint32_t i, started = 0;
+			uint64_t blobs_checked = 0, blobs_different = 0;
+			uint32_t cols_md5_equal = 0;
+
+			atomic32_set( &next_col, 0 );
+			for ( i = 0; i < num_workers; ++i )
+			{
+				bbb_worker * w = &workers[ i ];
+				w -> ktab_1 = ktab_1;
+				w -> ktab_2 = ktab_2;
+				w -> names = names;
+				w -> name_count = name_count;
+				w -> next_col = &next_col;
+				w -> show_progress = dctx -> show_progress;
+			}
+
+			if ( num_workers == 1 )
+				rc = bbb_thread( NULL, &workers[ 0 ] );
+			else
+			{
+				for ( i = 0; rc == 0 && i < num_workers; ++i )
+				{
+					rc = KThreadMake( &( workers[ i ].thread ), bbb_thread, &workers[ i ] );
+					if ( rc != 0 )
+					{
+						LOGERR ( klogInt, rc, "KThreadMake() failed" );
+						atomic32_set( &next_col, name_count );
+					}
+					else
+						started++;
+				}
+				for ( i = 0; i < started; ++i )
+				{
+					rc_t rc_thread = 0;
+					rc_t rc1 = KThreadWait( workers[ i ].thread, &rc_thread );
+					if ( rc1 != 0 )
+					{
+						LOGERR ( klogInt, rc1, "KThreadWait() failed" );
+					}
+					if ( rc == 0 ) rc = ( rc1 != 0 ) ? rc1 : rc_thread;
+					KThreadRelease( workers[ i ].thread );
+				}
+			}
+
+			if ( rc == 0 )
+				rc = bbb_merge( workers, num_workers, rows );
+
+			for ( i = 0; i < num_workers; ++i )
+			{
+				bbb_worker * w = &workers[ i ];
+				blobs_checked += w -> blobs_checked;
+				blobs_different += w -> blobs_different;
+				cols_md5_equal += w -> cols_md5_equal;
+				free( w -> rows.ranges );
+			}
+			free( workers );
+
+			if ( rc == 0 )
+				rc = KOutMsg( "%u physical columns ( %u identical by md5 ), %,lu blobs checked, %,lu blobs differ\n",
+							  name_count, cols_md5_equal, blobs_checked, blobs_different );
+		}
+	}
+	return rc;
+}
+
+rc_t bbb_find_suspect_rows( const VTable * tab_1, const VTable * tab_2,
+							const struct diff_ctx * dctx, suspect_rows ** rows )
+{
+	const KTable * ktab_1;
+	rc_t rc = VTableOpenKTableRead( tab_1, &ktab_1 );
+	*rows = NULL;
+	if ( rc != 0 )
+	{
+		LOGERR ( klogInt, rc, "VTableOpenKTableRead( acc #1 ) failed" );
+	}
+	else
+	{
+		const KTable * ktab_2;
+		rc = VTableOpenKTableRead( tab_2, &ktab_2 );
+		if ( rc != 0 )
+		{
+			LOGERR ( klogInt, rc, "VTableOpenKTableRead( acc #2 ) failed" );
+		}
+		else
+		{
+			bool schema_equal;
+			rc = bbb_schema_equal( ktab_1, ktab_2, &schema_equal );
+			if ( rc == 0 && !schema_equal )
+				rc = KOutMsg( "checksum-first: schemas differ, comparing all rows\n" );
+			else if ( rc == 0 )
+			{
+				KNamelist * names_1;
+				rc = KTableListCol( ktab_1, &names_1 );
+				if ( rc != 0 )
+				{
+					LOGERR ( klogInt, rc, "KTableListCol( acc #1 ) failed" );
+				}
+				else
+				{
+					KNamelist * names_2;
+					rc = KTableListCol( ktab_2, &names_2 );
+					if ( rc != 0 )
+					{
+						LOGERR ( klogInt, rc, "KTableListCol( acc #2 ) failed" );
+					}
+					else
+					{
+						if ( !nlt_compare_namelists( names_1, names_2, NULL ) )
+							rc = KOutMsg( "checksum-first: physical columns differ, comparing all rows\n" );
+						else
+						{
+							suspect_rows * res = calloc( 1, sizeof *res );
+							if ( res == NULL )
+							{
+								rc = RC( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+								LOGERR ( klogInt, rc, "cannot allocate suspect rows" );
+							}
+							else
+							{
+								/* *************************************************************** */
+								rc = bbb_diff_phys_columns( ktab_1, ktab_2, names_1, dctx, res );
+								/* *************************************************************** */
+								if ( rc == 0 )
+									*rows = res;
+								else
+									bbb_release_suspect_rows( res );
+							}
+						}
+						KNamelistRelease( names_2 );
+					}
+					KNamelistRelease( names_1 );
+				}
+			}
+			KTableRelease( ktab_2 );
+		}
+		KTableRelease( ktab_1 );
+	}
+	return rc;
+}
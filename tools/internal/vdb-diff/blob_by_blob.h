@@ -0,0 +1,87 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_blob_by_blob_
+#define _h_blob_by_blob_
+
+#include <klib/rc.h>
+#include <vdb/table.h>
+#include "vdb-diff-context.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************************************************************
+a range of rows that lives in blobs which differ ( or cannot be matched )
+between the 2 tables, only these rows have to be decoded and compared
+********************************************************************/
+typedef struct suspect_range
+{
+    int64_t first;
+    uint64_t count;
+} suspect_range;
+
+typedef struct suspect_rows
+{
+    suspect_range * ranges;     /* sorted by first, not overlapping */
+    uint32_t count;
+    uint32_t allocated;
+} suspect_rows;
+
+
+/*
+ * compares the physical columns of the 2 tables without decoding them:
+ * first the md5-file of each column, then blob by blob the sizes and the stored
+ * CRC32/MD5 checksums ( the bytes only if the column has no checksums )
+ *
+ * *rows == NULL : the tables cannot be compared this way ( different schema,
+ *                 different set of physical columns ), every row is suspect
+ * ( *rows )->count == 0 : the physical data is identical
+*/
+rc_t bbb_find_suspect_rows( const VTable * tab_1, const VTable * tab_2,
+                            const struct diff_ctx * dctx, suspect_rows ** rows );
+
+
+/*
+ * is the given row in one of the suspect ranges? ( rows == NULL : always true )
+*/
+bool bbb_is_suspect( const suspect_rows * rows, int64_t row_id );
+
+
+/*
+ * how many rows are covered by the suspect ranges
+*/
+uint64_t bbb_suspect_count( const suspect_rows * rows );
+
+
+void bbb_release_suspect_rows( suspect_rows * rows );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -28,9 +28,32 @@
 #include <klib/log.h>
 #include <klib/out.h>
 
+#include <stdarg.h>
+
+/* out == NULL : print via KOutMsg, otherwise append to the buffer */
+static rc_t cmn_out( KDataBuffer * out, const char * fmt, ... )
+{
+    rc_t rc;
+    va_list args;
+    va_start( args, fmt );
+    if ( out == NULL )
+        rc = KOutVMsg( fmt, args );
+    else
+        rc = KDataBufferVPrintf( out, fmt, args );
+    va_end( args );
+    return rc;
+}
+
 rc_t cmn_diff_column( const col_pair * pair,
                       const VCursor * cur_1, const VCursor * cur_2,
                       int64_t row_id,  bool * res )
+{
+    return cmn_diff_column_into( pair, cur_1, cur_2, row_id, res, NULL );
+}
+
+rc_t cmn_diff_column_into( const col_pair * pair,
+                           const VCursor * cur_1, const VCursor * cur_2,
+                           int64_t row_id,  bool * res, KDataBuffer * out )
 {
     uint32_t elem_bits_1, boff_1, row_len_1;
     const void * base_1;
@@ -61,21 +84,21 @@ rc_t cmn_diff_column( const col_pair * pair,
             if ( elem_bits_1 != elem_bits_2 )
             {
                 *res = false;
-                rc = KOutMsg( "%s[ %ld ].elem_bits %u != %u\n", pair->name, row_id, elem_bits_1, elem_bits_2 );
+                rc = cmn_out( out, "%s[ %ld ].elem_bits %u != %u\n", pair->name, row_id, elem_bits_1, elem_bits_2 );
             }
 
             if ( row_len_1 != row_len_2 )
             {
                 *res = false;
                 if ( rc == 0 )
-                    rc = KOutMsg( "%s[ %ld ].row_len %u != %u\n", pair->name, row_id, row_len_1, row_len_2 );
+                    rc = cmn_out( out, "%s[ %ld ].row_len %u != %u\n", pair->name, row_id, row_len_1, row_len_2 );
             }
 
             if ( boff_1 != 0 || boff_2 != 0 )
             {
                 *res = false;
                 if ( rc == 0 )
-                    rc = KOutMsg( "%s[ %ld ].bit_offset: %u, %u\n", pair->name, row_id, boff_1, boff_2 );
+                    rc = cmn_out( out, "%s[ %ld ].bit_offset: %u, %u\n", pair->name, row_id, boff_1, boff_2 );
             }
             
             if ( *res )
@@ -84,7 +107,7 @@ rc_t cmn_diff_column( const col_pair * pair,
                 if ( num_bits & 0x07 )
                 {
                     if ( rc == 0 )
-                        rc = KOutMsg( "%s[ %ld ].bits_total %% 8 = %u\n", pair->name, row_id, ( num_bits % 8 ) );
+                        rc = cmn_out( out, "%s[ %ld ].bits_total %% 8 = %u\n", pair->name, row_id, ( num_bits % 8 ) );
                 }
                 else
                 {
@@ -93,7 +116,7 @@ rc_t cmn_diff_column( const col_pair * pair,
                     if ( cmp != 0 )
                     {
                         if ( rc == 0 )
-                            rc = KOutMsg( "%s[ %ld ] differ\n", pair->name, row_id );
+                            rc = cmn_out( out, "%s[ %ld ] differ\n", pair->name, row_id );
                         *res = false;
                     }
                 }
@@ -30,6 +30,7 @@
 #include <klib/rc.h>
 #include <vdb/cursor.h>
 #include <klib/num-gen.h>
+#include <klib/data-buffer.h>
 
 #include "coldefs.h"
 
@@ -41,6 +42,11 @@ rc_t cmn_diff_column( const col_pair * pair,
                       const VCursor * cur_1, const VCursor * cur_2,
                       int64_t row_id,  bool * res );
 
+/* same as above, but the differences are appended to out ( out == NULL : printed ) */
+rc_t cmn_diff_column_into( const col_pair * pair,
+                           const VCursor * cur_1, const VCursor * cur_2,
+                           int64_t row_id,  bool * res, KDataBuffer * out );
+
 rc_t cmn_make_num_gen( const VCursor * cur_1, const VCursor * cur_2,
                        int idx_1, int idx_2,
                        const struct num_gen * src, struct num_gen ** dst );
@@ -30,9 +30,11 @@
 #include <klib/num-gen.h>
 #include <vdb/cursor.h>
 #include <klib/progressbar.h>
+#include <klib/data-buffer.h>
 
 #include "coldefs.h"
 #include "cmn.h"
+#include "ordered_workers.h"
 
 #include <sysalloc.h>
 #include <stdlib.h>
@@ -40,15 +42,25 @@
 
 rc_t Quitting( void );  /* because we cannot include <kapp/main.h> where it is defined! */
 
+static rc_t cbc_print_summary( const suspect_rows * suspects, uint64_t rows_checked,
+                               uint64_t rows_different, uint64_t rows_skipped )
+{
+    if ( suspects == NULL )
+        return KOutMsg( "\n%,lu rows checked, %,lu rows differ\n", rows_checked, rows_different );
+    return KOutMsg( "\n%,lu rows checked, %,lu rows differ, %,lu rows skipped ( blobs identical )\n",
+                    rows_checked, rows_different, rows_skipped );
+}
+
 static rc_t cbc_diff_column_iter( const col_pair * pair, const VCursor * cur_1, const VCursor * cur_2,
                                   const struct diff_ctx * dctx, const struct num_gen_iter * iter,
-                                  unsigned long int * diffs )
+                                  const suspect_rows * suspects, unsigned long int * diffs )
 {
     rc_t rc = 0;
     struct progressbar * progress = NULL;
     int64_t row_id;
     uint64_t rows_checked = 0;
     uint64_t rows_different = 0;
+    uint64_t rows_skipped = 0;
     
     if ( dctx -> show_progress )
         make_progressbar( &progress, 2 );
@@ -56,7 +68,12 @@ static rc_t cbc_diff_column_iter( const col_pair * pair, const VCursor * cur_1,
     while ( ( rc == 0 ) && ( num_gen_iterator_next( iter, &row_id, &rc ) ) && ( *diffs < dctx -> max_err ) )
     {
         if ( rc == 0 ) rc = Quitting();    /* to be able to cancel the loop by signal */
-        if ( rc == 0 )
+        if ( rc == 0 && !bbb_is_suspect( suspects, row_id ) )
+        {
+            /* the stored blobs of this row are identical */
+            rows_skipped++;
+        }
+        else if ( rc == 0 )
         {
             bool col_equal = true;
 
@@ -82,15 +99,15 @@ static rc_t cbc_diff_column_iter( const col_pair * pair, const VCursor * cur_1,
     } /* while ( num_gen_iterator_next() ) */
 
     if ( rc == 0 )
-        rc = KOutMsg( "\n%,lu rows checked, %,lu rows differ\n", rows_checked, rows_different );
+        rc = cbc_print_summary( suspects, rows_checked, rows_different, rows_skipped );
 
     if ( progress != NULL ) destroy_progressbar( progress );
 	
 	return rc;
 }
 
-static rc_t cbc_diff_column( col_pair * pair, const VCursor * cur_1, const VCursor * cur_2,
-                             const struct diff_ctx * dctx, unsigned long int *diffs )
+/* adds the column to both cursors and opens them */
+static rc_t cbc_open_column( col_pair * pair, const VCursor * cur_1, const VCursor * cur_2 )
 {
     rc_t rc = VCursorAddColumn( cur_1, &( pair -> idx[ 0 ] ), "%s", pair -> name );
     if ( rc != 0 )
@@ -118,36 +135,65 @@ static rc_t cbc_diff_column( col_pair * pair, const VCursor * cur_1, const VCurs
                 {
                     LOGERR ( klogInt, rc, "VCursorOpen( acc #2 ) failed" );
                 }
-                else
-                {
-                    struct num_gen * rows_to_diff = NULL;
-                    rc = cmn_make_num_gen( cur_1, cur_2, pair->idx[0], pair->idx[1], dctx -> rows, &rows_to_diff );
-                    if ( rc == 0 && rows_to_diff != NULL )
-                    {
-                        const struct num_gen_iter * iter = NULL;
-                        rc = num_gen_iterator_make( rows_to_diff, &iter );
-                        if ( rc != 0 )
-                        {
-                            LOGERR ( klogInt, rc, "num_gen_iterator_make() failed" );
-                        }
-                        else if ( iter != NULL )
-                        {
-                            /* *************************************************************** */
-                            rc = cbc_diff_column_iter( pair, cur_1, cur_2, dctx, iter, diffs );
-                            /* *************************************************************** */
-                            num_gen_iterator_destroy( iter );
-                        }
-                        num_gen_destroy( rows_to_diff );
-                    }
-                }
             }
         }
     }
     return rc;
 }
 
-rc_t cbc_diff_columns( const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
-                       const struct diff_ctx * dctx, const char * tablename, unsigned long int *diffs )
+static rc_t cbc_diff_column( col_pair * pair, const VCursor * cur_1, const VCursor * cur_2,
+                             const struct diff_ctx * dctx, const suspect_rows * suspects,
+                             unsigned long int *diffs )
+{
+    rc_t rc = cbc_open_column( pair, cur_1, cur_2 );
+    if ( rc == 0 )
+    {
+        struct num_gen * rows_to_diff = NULL;
+        rc = cmn_make_num_gen( cur_1, cur_2, pair->idx[0], pair->idx[1], dctx -> rows, &rows_to_diff );
+        if ( rc == 0 && rows_to_diff != NULL )
+        {
+            const struct num_gen_iter * iter = NULL;
+            rc = num_gen_iterator_make( rows_to_diff, &iter );
+            if ( rc != 0 )
+            {
+                LOGERR ( klogInt, rc, "num_gen_iterator_make() failed" );
+            }
+            else if ( iter != NULL )
+            {
+                /* *************************************************************** */
+                rc = cbc_diff_column_iter( pair, cur_1, cur_2, dctx, iter, suspects, diffs );
+                /* *************************************************************** */
+                num_gen_iterator_destroy( iter );
+            }
+            num_gen_destroy( rows_to_diff );
+        }
+    }
+    return rc;
+}
+
+static rc_t cbc_make_cursors( const VTable * tab_1, const VTable * tab_2,
+                              const VCursor ** cur_1, const VCursor ** cur_2 )
+{
+    rc_t rc = VTableCreateCursorRead( tab_1, cur_1 );
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "VTableCreateCursorRead( acc #1 ) failed" );
+    }
+    else
+    {
+        rc = VTableCreateCursorRead( tab_2, cur_2 );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "VTableCreateCursorRead( acc #2 ) failed" );
+            VCursorRelease( *cur_1 );
+        }
+    }
+    return rc;
+}
+
+static rc_t cbc_diff_columns_serial( const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                                     const struct diff_ctx * dctx, const char * tablename,
+                                     const suspect_rows * suspects, unsigned long int *diffs )
 {
     rc_t rc = 0;
     uint32_t i;
@@ -161,30 +207,329 @@ rc_t cbc_diff_columns( const col_defs * defs, const VTable * tab_1, const VTable
             if ( rc == 0 )
             {
                 const VCursor * cur_1;
-                rc = VTableCreateCursorRead( tab_1, &cur_1 );
-                if ( rc != 0 )
+                const VCursor * cur_2;
+                rc = cbc_make_cursors( tab_1, tab_2, &cur_1, &cur_2 );
+                if ( rc == 0 )
                 {
-                    LOGERR ( klogInt, rc, "VTableCreateCursorRead( acc #1 ) failed" );
+                    /* *************************************************************** */
+                    rc = cbc_diff_column( pair, cur_1, cur_2, dctx, suspects, diffs );
+                    /* *************************************************************** */
+                    VCursorRelease( cur_2 );
+                    VCursorRelease( cur_1 );
                 }
-                else
+            }
+        }
+    }
+    return rc;
+}
+
+
+/********************************************************************
+the parallel version: worker #n compares the columns n, n + N ...,
+each with a pair of cursors of its own, and collects the differences
+of a column in a buffer. The calling thread prints the columns in
+their order and counts the differences - the output is the same as
+the one of the serial loop
+********************************************************************/
+
+/* returned by the consumer to stop the workers, when max_err is reached */
+#define CBC_MAX_ERR_REACHED RC( rcExe, rcColumn, rcProcessing, rcData, rcExcessive )
+
+/* a row that differs, its text is in the buffer of the column */
+typedef struct cbc_diff_row
+{
+    uint64_t rows_checked;      /* rows of the column checked before this one */
+    uint64_t rows_skipped;      /* rows of the column skipped before this one */
+    uint64_t text_end;          /* end of its text in the buffer of the column */
+} cbc_diff_row;
+
+typedef struct cbc_column
+{
+    KDataBuffer text;
+    cbc_diff_row * rows;
+    const char * name;          /* NULL: no column at this index */
+    uint32_t num_rows;
+    uint32_t allocated;
+    uint64_t rows_checked;
+    uint64_t rows_skipped;
+    bool compared;              /* false: both tables are empty */
+    rc_t rc;                    /* the column could not be compared */
+} cbc_column;
+
+typedef struct cbc_worker
+{
+    const col_defs * defs;
+    const VTable * tab_1;
+    const VTable * tab_2;
+    const struct diff_ctx * dctx;
+    const suspect_rows * suspects;
+    uint32_t column_count;
+} cbc_worker;
+
+typedef struct cbc_collector
+{
+    const struct diff_ctx * dctx;
+    const suspect_rows * suspects;
+    const char * tablename;
+    unsigned long int * diffs;
+} cbc_collector;
+
+static uint64_t cbc_text_len( const KDataBuffer * text )
+{
+    /* KDataBufferPrintf() keeps the buffer 0-terminated */
+    return ( text -> elem_count > 0 ) ? text -> elem_count - 1 : 0;
+}
+
+static void CC cbc_column_release( void * item )
+{
+    cbc_column * col = item;
+    if ( col != NULL )
+    {
+        KDataBufferWhack( &( col -> text ) );
+        free( col -> rows );
+        free( col );
+    }
+}
+
+static rc_t cbc_column_make( cbc_column ** col )
+{
+    rc_t rc = 0;
+    cbc_column * c = calloc( 1, sizeof *c );
+    if ( c == NULL )
+        rc = RC( rcExe, rcColumn, rcAllocating, rcMemory, rcExhausted );
+    else
+    {
+        rc = KDataBufferMakeBytes( &( c -> text ), 0 );
+        if ( rc != 0 )
+            free( c );
+    }
+    if ( rc != 0 )
+        LOGERR ( klogInt, rc, "cannot allocate column-differences" );
+    else
+        *col = c;
+    return rc;
+}
+
+static rc_t cbc_column_add_diff( cbc_column * col )
+{
+    cbc_diff_row * row;
+    if ( col -> num_rows == col -> allocated )
+    {
+        uint32_t allocated = ( col -> allocated > 0 ) ? col -> allocated * 2 : 16;
+        void * temp = realloc( col -> rows, allocated * sizeof col -> rows[ 0 ] );
+        if ( temp == NULL )
+        {
+            rc_t rc = RC( rcExe, rcColumn, rcAllocating, rcMemory, rcExhausted );
+            LOGERR ( klogInt, rc, "cannot allocate row-differences" );
+            return rc;
+        }
+        col -> rows = temp;
+        col -> allocated = allocated;
+    }
+    row = &( col -> rows[ col -> num_rows++ ] );
+    row -> rows_checked = col -> rows_checked;
+    row -> rows_skipped = col -> rows_skipped;
+    row -> text_end = cbc_text_len( &( col -> text ) );
+    return 0;
+}
+
+/* a column never contributes more than max_err differences: stop there */
+static rc_t cbc_diff_column_into( const cbc_worker * w, col_pair * pair, cbc_column * col,
+                                  struct progressbar * progress )
+{
+    const VCursor * cur_1;
+    const VCursor * cur_2;
+    rc_t rc = cbc_make_cursors( w -> tab_1, w -> tab_2, &cur_1, &cur_2 );
+    if ( rc == 0 )
+    {
+        struct num_gen * rows_to_diff = NULL;
+        rc = cbc_open_column( pair, cur_1, cur_2 );
+        if ( rc == 0 )
+            rc = cmn_make_num_gen( cur_1, cur_2, pair->idx[0], pair->idx[1], w -> dctx -> rows, &rows_to_diff );
+        if ( rc == 0 && rows_to_diff != NULL )
+        {
+            const struct num_gen_iter * iter = NULL;
+            rc = num_gen_iterator_make( rows_to_diff, &iter );
+            if ( rc != 0 )
+            {
+                LOGERR ( klogInt, rc, "num_gen_iterator_make() failed" );
+            }
+            else if ( iter != NULL )
+            {
+                int64_t row_id;
+                col -> compared = true;
+                while ( rc == 0 && num_gen_iterator_next( iter, &row_id, &rc ) &&
+                        col -> num_rows < w -> dctx -> max_err )
                 {
-                    const VCursor * cur_2;
-                    rc = VTableCreateCursorRead( tab_2, &cur_2 );
-                    if ( rc != 0 )
+                    if ( rc == 0 ) rc = Quitting();    /* to be able to cancel the loop by signal */
+                    if ( rc == 0 && !bbb_is_suspect( w -> suspects, row_id ) )
                     {
-                        LOGERR ( klogInt, rc, "VTableCreateCursorRead( acc #2 ) failed" );
+                        col -> rows_skipped++;
                     }
-                    else
+                    else if ( rc == 0 )
                     {
-                        /* *************************************************************** */
-                        rc = cbc_diff_column( pair, cur_1, cur_2, dctx, diffs );
-                        /* *************************************************************** */
-                        VCursorRelease( cur_2 );
+                        bool col_equal = true;
+                        rc = cmn_diff_column_into( pair, cur_1, cur_2, row_id, &col_equal, &( col -> text ) );
+                        if ( rc == 0 && !col_equal )
+                            rc = cbc_column_add_diff( col );
+                        col -> rows_checked++;
+
+                        if ( progress != NULL )
+                        {
+                            uint32_t progress_value;
+                            if ( num_gen_iterator_percent( iter, 2, &progress_value ) == 0 )
+                                update_progressbar( progress, progress_value );
+                        }
                     }
-                    VCursorRelease( cur_1 );
                 }
+                num_gen_iterator_destroy( iter );
             }
+            num_gen_destroy( rows_to_diff );
         }
+        VCursorRelease( cur_2 );
+        VCursorRelease( cur_1 );
     }
     return rc;
 }
+
+/* worker #n takes the columns n, n + N, n + 2N ..., one turn per column */
+static rc_t CC cbc_produce( struct ordered_worker * self, uint32_t worker_id,
+                            uint32_t num_workers, void * data )
+{
+    cbc_worker * w = data;
+    struct progressbar * progress = NULL;
+    rc_t rc = 0;
+    uint32_t i;
+
+    /* the progress of the first worker is good enough */
+    if ( w -> dctx -> show_progress && worker_id == 0 )
+        make_progressbar( &progress, 2 );
+
+    for ( i = worker_id; rc == 0 && i < w -> column_count; i += num_workers )
+    {
+        cbc_column * col;
+        rc = Quitting();    /* to be able to cancel the loop by signal */
+        if ( rc == 0 )
+            rc = cbc_column_make( &col );
+        if ( rc == 0 )
+        {
+            col_pair * pair = VectorGet( &( w -> defs -> cols ), i );
+            if ( pair != NULL )
+            {
+                col -> name = pair -> name;
+                /* the consumer reports the error after the name of the column */
+                col -> rc = cbc_diff_column_into( w, pair, col, progress );
+            }
+            rc = ordered_worker_deliver( self, col, true ); /* ordered_workers.c */
+            if ( rc == 0 && col -> rc != 0 )
+                break;
+        }
+    }
+
+    if ( progress != NULL )
+        destroy_progressbar( progress );
+    return rc;
+}
+
+/* prints the differences of a column, like the serial loop: stops after the row reaching max_err */
+static rc_t CC cbc_consume( void * item, void * data )
+{
+    rc_t rc = 0;
+    cbc_column * col = item;
+    cbc_collector * c = data;
+
+    if ( *( c -> diffs ) >= c -> dctx -> max_err )
+        return CBC_MAX_ERR_REACHED;
+    if ( col -> name == NULL )
+        return 0;
+
+    rc = KOutMsg( "comparing column '%s.%s'\n", c -> tablename, col -> name );
+    if ( rc == 0 )
+        rc = col -> rc;
+    if ( rc == 0 && col -> compared )
+    {
+        const char * text = col -> text . base;
+        uint64_t text_start = 0;
+        uint64_t rows_checked = col -> rows_checked;
+        uint64_t rows_skipped = col -> rows_skipped;
+        uint64_t rows_different = 0;
+        uint32_t i;
+
+        for ( i = 0; rc == 0 && i < col -> num_rows; ++i )
+        {
+            const cbc_diff_row * row = &( col -> rows[ i ] );
+            rc = KOutMsg( "%.*s\n", ( uint32_t )( row -> text_end - text_start ), &( text[ text_start ] ) );
+            text_start = row -> text_end;
+            rows_different++;
+            ( *( c -> diffs ) )++;
+            if ( *( c -> diffs ) >= c -> dctx -> max_err )
+            {
+                rows_checked = row -> rows_checked + 1;
+                rows_skipped = row -> rows_skipped;
+                break;
+            }
+        }
+        if ( rc == 0 )
+            rc = cbc_print_summary( c -> suspects, rows_checked, rows_different, rows_skipped );
+    }
+    return rc;
+}
+
+static rc_t cbc_diff_columns_parallel( const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                                       const struct diff_ctx * dctx, const char * tablename,
+                                       const suspect_rows * suspects, unsigned long int *diffs )
+{
+    rc_t rc = 0;
+    uint32_t count = VectorLength( &( defs -> cols ) );
+    /* no need for more workers than columns */
+    uint32_t num_workers = ( dctx -> num_threads < count ) ? dctx -> num_threads : count;
+    cbc_worker * workers = calloc( num_workers, sizeof *workers );
+    void ** worker_ptrs = calloc( num_workers, sizeof *worker_ptrs );
+    if ( workers == NULL || worker_ptrs == NULL )
+    {
+        rc = RC( rcExe, rcThread, rcAllocating, rcMemory, rcExhausted );
+        LOGERR ( klogInt, rc, "cannot allocate workers" );
+    }
+    else
+    {
+        cbc_collector c;
+        uint32_t i;
+
+        for ( i = 0; i < num_workers; ++i )
+        {
+            cbc_worker * w = &workers[ i ];
+            w -> defs = defs;
+            w -> tab_1 = tab_1;
+            w -> tab_2 = tab_2;
+            w -> dctx = dctx;
+            w -> suspects = suspects;
+            w -> column_count = count;
+            worker_ptrs[ i ] = w;
+        }
+
+        memset( &c, 0, sizeof c );
+        c.dctx = dctx;
+        c.suspects = suspects;
+        c.tablename = tablename;
+        c.diffs = diffs;
+
+        /* ************************************************ */
+        rc = ordered_workers_run( num_workers, cbc_produce, worker_ptrs,
+                                  cbc_consume, &c, cbc_column_release ); /* ordered_workers.c */
+        /* ************************************************ */
+        if ( rc == CBC_MAX_ERR_REACHED )
+            rc = 0;
+    }
+    free( ( void * ) worker_ptrs );
+    free( workers );
+    return rc;
+}
+
+rc_t cbc_diff_columns( const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                       const struct diff_ctx * dctx, const char * tablename,
+                       const suspect_rows * suspects, unsigned long int *diffs )
+{
+    if ( dctx -> num_threads > 1 && VectorLength( &( defs -> cols ) ) > 1 )
+        return cbc_diff_columns_parallel( defs, tab_1, tab_2, dctx, tablename, suspects, diffs );
+    return cbc_diff_columns_serial( defs, tab_1, tab_2, dctx, tablename, suspects, diffs );
+}
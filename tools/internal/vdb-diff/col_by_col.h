@@ -30,13 +30,18 @@
 #include <vdb/table.h>
 #include "vdb-diff-context.h"
 #include "coldefs.h"
+#include "blob_by_blob.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* compares one column after the other over all rows,
+   rows outside of the suspect ranges are skipped ( suspects == NULL : no rows skipped ),
+   with dctx->num_threads > 1 the columns are spread over the threads */
 rc_t cbc_diff_columns( const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
-                       const struct diff_ctx * dctx, const char * tablename, unsigned long int *diffs );
+                       const struct diff_ctx * dctx, const char * tablename,
+                       const suspect_rows * suspects, unsigned long int *diffs );
 
 #ifdef __cplusplus
 }
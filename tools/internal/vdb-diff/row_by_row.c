@@ -30,9 +30,12 @@
 #include <klib/num-gen.h>
 #include <vdb/cursor.h>
 #include <klib/progressbar.h>
+#include <klib/data-buffer.h>
 
 #include "coldefs.h"
 #include "cmn.h"
+#include "blob_by_blob.h"
+#include "ordered_workers.h"
 
 #include <sysalloc.h>
 #include <stdlib.h>
@@ -189,3 +192,379 @@ rc_t rbr_diff_columns( col_defs * defs, const VTable * tab_1, const VTable * tab
 	}
 	return rc;
 }
+
+
+/********************************************************************
+the parallel version: each worker has its own pair of cursors, and
+takes every n-th chunk of rows, rows outside of the suspect ranges
+( stored blobs are identical ) are skipped without decoding them.
+The workers collect the differences of a chunk in a buffer, the
+calling thread prints the chunks in the order of the rows and counts
+the differences - the output is the same as the one of the serial loop
+********************************************************************/
+#define RBR_CHUNK_ROWS 4096
+
+/* returned by the consumer to stop the workers, when max_err is reached */
+#define RBR_MAX_ERR_REACHED RC( rcExe, rcRow, rcProcessing, rcData, rcExcessive )
+
+/* a row that differs, its text is in the buffer of the chunk */
+typedef struct rbr_diff_row
+{
+	uint64_t rows_checked;		/* rows of the chunk checked before this one */
+	uint64_t rows_skipped;		/* rows of the chunk skipped before this one */
+	uint64_t text_end;			/* end of its text in the buffer of the chunk */
+	uint32_t col_diffs;
+} rbr_diff_row;
+
+typedef struct rbr_chunk
+{
+	KDataBuffer text;
+	rbr_diff_row * rows;
+	uint32_t num_rows;
+	uint32_t allocated;
+	uint64_t rows_checked;
+	uint64_t rows_skipped;
+} rbr_chunk;
+
+typedef struct rbr_worker
+{
+	const col_defs * defs;
+	const VCursor * cur_1;
+	const VCursor * cur_2;
+	const struct diff_ctx * dctx;
+	const struct num_gen_iter * iter;
+	const suspect_rows * suspects;
+	uint32_t column_count;
+} rbr_worker;
+
+typedef struct rbr_collector
+{
+	const struct diff_ctx * dctx;
+	unsigned long int * diffs;
+	uint64_t rows_checked;
+	uint64_t rows_different;
+	uint64_t rows_skipped;
+} rbr_collector;
+
+static uint64_t rbr_text_len( const KDataBuffer * text )
+{
+	/* KDataBufferPrintf() keeps the buffer 0-terminated */
+	return ( text -> elem_count > 0 ) ? text -> elem_count - 1 : 0;
+}
+
+static void CC rbr_chunk_release( void * item )
+{
+	rbr_chunk * chunk = item;
+	if ( chunk != NULL )
+	{
+		KDataBufferWhack( &( chunk -> text ) );
+		free( chunk -> rows );
+		free( chunk );
+	}
+}
+
+static rc_t rbr_chunk_make( rbr_chunk ** chunk )
+{
+	rc_t rc = 0;
+	rbr_chunk * c = calloc( 1, sizeof *c );
+	if ( c == NULL )
+		rc = RC( rcExe, rcRow, rcAllocating, rcMemory, rcExhausted );
+	else
+	{
+		rc = KDataBufferMakeBytes( &( c -> text ), 0 );
+		if ( rc != 0 )
+			free( c );
+	}
+	if ( rc != 0 )
+		LOGERR ( klogInt, rc, "cannot allocate chunk of rows" );
+	else
+		*chunk = c;
+	return rc;
+}
+
+static rc_t rbr_chunk_add_diff( rbr_chunk * chunk, uint32_t col_diffs )
+{
+	rbr_diff_row * row;
+	if ( chunk -> num_rows == chunk -> allocated )
+	{
+		uint32_t allocated = ( chunk -> allocated > 0 ) ? chunk -> allocated * 2 : 16;
+		void * temp = realloc( chunk -> rows, allocated * sizeof chunk -> rows[ 0 ] );
+		if ( temp == NULL )
+		{
+			rc_t rc = RC( rcExe, rcRow, rcAllocating, rcMemory, rcExhausted );
+			LOGERR ( klogInt, rc, "cannot allocate row-differences" );
+			return rc;
+		}
+		chunk -> rows = temp;
+		chunk -> allocated = allocated;
+	}
+	row = &( chunk -> rows[ chunk -> num_rows++ ] );
+	row -> rows_checked = chunk -> rows_checked;
+	row -> rows_skipped = chunk -> rows_skipped;
+	row -> text_end = rbr_text_len( &( chunk -> text ) );
+	row -> col_diffs = col_diffs;
+	return 0;
+}
+
+static rc_t rbr_diff_row_into( rbr_worker * w, rbr_chunk * chunk, int64_t row_id )
+{
+	rc_t rc = 0;
+	uint32_t col_diffs = 0;
+	uint32_t col_id;
+	for ( col_id = 0; col_id < w -> column_count && rc == 0; ++col_id )
+	{
+		col_pair * pair = VectorGet( &( w -> defs -> cols ), col_id );
+		if ( pair != NULL )
+		{
+			bool col_equal;
+			rc = cmn_diff_column_into( pair, w -> cur_1, w -> cur_2, row_id, &col_equal, &( chunk -> text ) );
+			if ( !col_equal )
+				col_diffs++;
+		}
+	}
+	if ( rc == 0 && col_diffs > 0 )
+		rc = rbr_chunk_add_diff( chunk, col_diffs );
+	chunk -> rows_checked++;
+	return rc;
+}
+
+/* worker #n takes the chunks n, n + N, n + 2N ... */
+static rc_t CC rbr_produce( struct ordered_worker * self, uint32_t worker_id,
+                            uint32_t num_workers, void * data )
+{
+	rbr_worker * w = data;
+	struct progressbar * progress = NULL;
+	rbr_chunk * chunk = NULL;
+	uint64_t chunk_id = 0;
+	uint64_t n = 0;
+	int64_t row_id;
+	rc_t rc = 0;
+
+	/* the workers walk the same rows, the progress of the first one is good enough */
+	if ( w -> dctx -> show_progress && worker_id == 0 )
+		make_progressbar( &progress, 2 );
+
+	while ( rc == 0 && num_gen_iterator_next( w -> iter, &row_id, &rc ) )
+	{
+		uint64_t id = ( n++ ) / RBR_CHUNK_ROWS;
+		if ( rc == 0 && ( id % num_workers ) == worker_id )
+		{
+			rc = Quitting();    /* to be able to cancel the loop by signal */
+			if ( rc == 0 && chunk != NULL && id != chunk_id )
+			{
+				rc = ordered_worker_deliver( self, chunk, true ); /* ordered_workers.c */
+				chunk = NULL;
+			}
+			if ( rc == 0 && chunk == NULL )
+			{
+				rc = rbr_chunk_make( &chunk );
+				chunk_id = id;
+			}
+			if ( rc == 0 )
+			{
+				if ( !bbb_is_suspect( w -> suspects, row_id ) )
+					chunk -> rows_skipped++;
+				else
+					rc = rbr_diff_row_into( w, chunk, row_id );
+			}
+
+			if ( progress != NULL )
+			{
+				uint32_t progress_value;
+				if ( num_gen_iterator_percent( w -> iter, 2, &progress_value ) == 0 )
+					update_progressbar( progress, progress_value );
+			}
+		}
+	}
+
+	if ( chunk != NULL )
+	{
+		if ( rc == 0 )
+			rc = ordered_worker_deliver( self, chunk, true ); /* ordered_workers.c */
+		else
+			rbr_chunk_release( chunk );
+	}
+	if ( progress != NULL )
+		destroy_progressbar( progress );
+	return rc;
+}
+
+/* prints the differences of a chunk, like the serial loop: stops after the row reaching max_err */
+static rc_t CC rbr_consume( void * item, void * data )
+{
+	rc_t rc = 0;
+	rbr_chunk * chunk = item;
+	rbr_collector * c = data;
+	const char * text = chunk -> text . base;
+	uint64_t text_start = 0;
+	uint32_t i;
+
+	if ( *( c -> diffs ) >= c -> dctx -> max_err )
+		return RBR_MAX_ERR_REACHED;
+
+	for ( i = 0; rc == 0 && i < chunk -> num_rows; ++i )
+	{
+		const rbr_diff_row * row = &( chunk -> rows[ i ] );
+		rc = KOutMsg( "%.*s\n", ( uint32_t )( row -> text_end - text_start ), &( text[ text_start ] ) );
+		text_start = row -> text_end;
+		*( c -> diffs ) += row -> col_diffs;
+		c -> rows_different++;
+		if ( rc == 0 && *( c -> diffs ) >= c -> dctx -> max_err )
+		{
+			c -> rows_checked += row -> rows_checked + 1;
+			c -> rows_skipped += row -> rows_skipped;
+			return RBR_MAX_ERR_REACHED;
+		}
+	}
+	c -> rows_checked += chunk -> rows_checked;
+	c -> rows_skipped += chunk -> rows_skipped;
+	return rc;
+}
+
+/* the cursors are made on the main thread: col_defs_add_to_cursor() writes the column-index into the pairs */
+static rc_t rbr_worker_open( rbr_worker * w, col_defs * defs, const VTable * tab_1, const VTable * tab_2 )
+{
+	rc_t rc = VTableCreateCursorRead( tab_1, &( w -> cur_1 ) );
+	if ( rc != 0 )
+	{
+		LOGERR ( klogInt, rc, "VTableCreateCursorRead( acc #1 ) failed" );
+	}
+	else
+	{
+		rc = VTableCreateCursorRead( tab_2, &( w -> cur_2 ) );
+		if ( rc != 0 )
+		{
+			LOGERR ( klogInt, rc, "VTableCreateCursorRead( acc #2 ) failed" );
+		}
+		else
+		{
+			rc = col_defs_add_to_cursor( defs, w -> cur_1, 0 );
+			if ( rc != 0 )
+			{
+				LOGERR ( klogInt, rc, "failed to add all requested columns to cursor of 1st accession" );
+			}
+			else
+			{
+				rc = col_defs_add_to_cursor( defs, w -> cur_2, 1 );
+				if ( rc != 0 )
+				{
+					LOGERR ( klogInt, rc, "failed to add all requested columns to cursor of 2nd accession" );
+				}
+			}
+			if ( rc == 0 )
+			{
+				rc = VCursorOpen( w -> cur_1 );
+				if ( rc != 0 )
+				{
+					LOGERR ( klogInt, rc, "VCursorOpen( acc #1 ) failed" );
+				}
+			}
+			if ( rc == 0 )
+			{
+				rc = VCursorOpen( w -> cur_2 );
+				if ( rc != 0 )
+				{
+					LOGERR ( klogInt, rc, "VCursorOpen( acc #2 ) failed" );
+				}
+			}
+		}
+	}
+	return rc;
+}
+
+static void rbr_worker_close( rbr_worker * w )
+{
+	if ( w -> iter != NULL )
+		num_gen_iterator_destroy( w -> iter );
+	if ( w -> cur_2 != NULL )
+		VCursorRelease( w -> cur_2 );
+	if ( w -> cur_1 != NULL )
+		VCursorRelease( w -> cur_1 );
+}
+
+rc_t rbr_diff_columns_parallel( col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                                const struct diff_ctx * dctx, const suspect_rows * suspects,
+                                unsigned long int *diffs )
+{
+	uint32_t column_count;
+	rc_t rc = col_defs_count( defs, &column_count );
+	if ( rc != 0 )
+	{
+		LOGERR ( klogInt, rc, "col_defs_count() failed" );
+	}
+	else
+	{
+		uint32_t num_workers = ( dctx -> num_threads > 0 ) ? dctx -> num_threads : 1;
+		rbr_worker * workers = calloc( num_workers, sizeof *workers );
+		void ** worker_ptrs = calloc( num_workers, sizeof *worker_ptrs );
+		if ( workers == NULL || worker_ptrs == NULL )
+		{
+			rc = RC( rcExe, rcThread, rcAllocating, rcMemory, rcExhausted );
+			LOGERR ( klogInt, rc, "cannot allocate workers" );
+		}
+		else
+		{
+			struct num_gen * rows_to_diff = NULL;
+			uint32_t i;
+
+			for ( i = 0; rc == 0 && i < num_workers; ++i )
+			{
+				rbr_worker * w = &workers[ i ];
+				w -> defs = defs;
+				w -> dctx = dctx;
+				w -> suspects = suspects;
+				w -> column_count = column_count;
+				worker_ptrs[ i ] = w;
+				rc = rbr_worker_open( w, defs, tab_1, tab_2 );
+			}
+
+			if ( rc == 0 )
+			{
+				rc = cmn_make_num_gen( workers[ 0 ].cur_1, workers[ 0 ].cur_2, 0, 0, dctx -> rows, &rows_to_diff );
+			}
+
+			/* every worker walks the rows with its own iterator ( rows_to_diff == NULL : both tables empty ) */
+			for ( i = 0; rc == 0 && rows_to_diff != NULL && i < num_workers; ++i )
+			{
+				rc = num_gen_iterator_make( rows_to_diff, &( workers[ i ].iter ) );
+				if ( rc != 0 )
+				{
+					LOGERR ( klogInt, rc, "num_gen_iterator_make() failed" );
+				}
+			}
+
+			if ( rc == 0 && rows_to_diff != NULL )
+			{
+				rbr_collector c;
+				memset( &c, 0, sizeof c );
+				c.dctx = dctx;
+				c.diffs = diffs;
+
+				/* ************************************************ */
+				rc = ordered_workers_run( num_workers, rbr_produce, worker_ptrs,
+										  rbr_consume, &c, rbr_chunk_release ); /* ordered_workers.c */
+				/* ************************************************ */
+				if ( rc == RBR_MAX_ERR_REACHED )
+					rc = 0;
+
+				if ( rc == 0 )
+				{
+					if ( suspects == NULL )
+						rc = KOutMsg( "\n%,lu rows checked ( %d columns each ), %,lu rows differ\n",
+							c.rows_checked, column_count, c.rows_different );
+					else
+						rc = KOutMsg( "\n%,lu rows checked ( %d columns each ), %,lu rows differ, %,lu rows skipped ( blobs identical )\n",
+							c.rows_checked, column_count, c.rows_different, c.rows_skipped );
+				}
+			}
+
+			for ( i = 0; i < num_workers; ++i )
+				rbr_worker_close( &workers[ i ] );
+			if ( rows_to_diff != NULL )
+				num_gen_destroy( rows_to_diff );
+		}
+		free( ( void * ) worker_ptrs );
+		free( workers );
+	}
+	return rc;
+}
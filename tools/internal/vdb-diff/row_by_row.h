@@ -30,6 +30,7 @@
 #include <vdb/table.h>
 #include "vdb-diff-context.h"
 #include "coldefs.h"
+#include "blob_by_blob.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,6 +39,12 @@ extern "C" {
 rc_t rbr_diff_columns( col_defs * defs, const VTable * tab_1, const VTable * tab_2,
                        const struct diff_ctx * dctx, unsigned long int *diffs );
 
+/* same as above, but spread over dctx->num_threads workers,
+   rows not in suspects are skipped ( suspects == NULL : compare all rows ) */
+rc_t rbr_diff_columns_parallel( col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                                const struct diff_ctx * dctx, const suspect_rows * suspects,
+                                unsigned long int *diffs );
+
 #ifdef __cplusplus
 }
 #endif
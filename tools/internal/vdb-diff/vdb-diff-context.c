@@ -54,6 +54,8 @@ void init_diff_ctx( struct diff_ctx * dctx )
 	dctx -> show_progress = false;
 	dctx -> intersect = false;
     dctx -> columnwise = false;
+    dctx -> checksum_first = false;
+    dctx -> num_threads = DFLT_THREADS;
 }
 
 void release_diff_ctx( struct diff_ctx * dctx )
@@ -161,6 +163,12 @@ rc_t gather_diff_ctx( struct diff_ctx * dctx, Args * args )
 		dctx -> intersect = get_bool_option( args, OPTION_INTERSECT, false );
 		dctx -> max_err = get_uint32t_option( args, OPTION_MAXERR, 1 );
         dctx -> columnwise = get_bool_option( args, OPTION_COLUMNWISE, false );
+        dctx -> checksum_first = get_bool_option( args, OPTION_CHECKSUM, false );
+        dctx -> num_threads = get_uint32t_option( args, OPTION_THREADS, DFLT_THREADS );
+        if ( dctx -> num_threads == 0 )
+            dctx -> num_threads = 1;
+        else if ( dctx -> num_threads > MAX_THREADS )
+            dctx -> num_threads = MAX_THREADS;
     }
 
     return rc;
@@ -199,6 +207,10 @@ rc_t report_diff_ctx( struct diff_ctx * dctx )
 		rc = KOutMsg( "- max err : %u\n", dctx -> max_err );
 	if ( rc == 0 )
 		rc = KOutMsg( "- col-by-col: %s\n", dctx -> columnwise ? "yes" : "no" );
+	if ( rc == 0 )
+		rc = KOutMsg( "- checksum-first: %s\n", dctx -> checksum_first ? "yes" : "no" );
+	if ( rc == 0 )
+		rc = KOutMsg( "- threads : %u\n", dctx -> num_threads );
 
 	if ( rc == 0 )
 		rc = KOutMsg( "\n" );
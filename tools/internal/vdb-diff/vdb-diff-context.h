@@ -62,6 +62,15 @@ extern "C" {
 #define OPTION_COLUMNWISE   "col-by-col"
 #define ALIAS_COLUMNWISE    "c"
 
+#define OPTION_CHECKSUM     "checksum-first"
+#define ALIAS_CHECKSUM      "s"
+
+#define OPTION_THREADS      "threads"
+#define ALIAS_THREADS       "j"
+
+#define DFLT_THREADS        1
+#define MAX_THREADS         64
+
 struct diff_ctx
 {
     const char * src1;
@@ -75,6 +84,8 @@ struct diff_ctx
 	bool show_progress;
 	bool intersect;
     bool columnwise;
+    bool checksum_first;
+    uint32_t num_threads;
 };
 
 void init_diff_ctx( struct diff_ctx * dctx );
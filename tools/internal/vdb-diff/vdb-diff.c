@@ -45,6 +45,7 @@
 #include "vdb-diff-context.h"
 #include "row_by_row.h"
 #include "col_by_col.h"
+#include "blob_by_blob.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -57,6 +58,8 @@ static const char * maxerr_usage[] = { "max errors im comparing (default = 1)",
 static const char * intersect_usage[] = { "intersect column-set from both runs", NULL };
 static const char * exclude_usage[] = { "exclude these columns from comapring", NULL };
 static const char * columnwise_usage[] = { "exclude these columns from comapring", NULL };
+static const char * checksum_usage[] = { "compare the stored blobs first, decode only rows in blobs that differ", NULL };
+static const char * threads_usage[] = { "number of worker threads (default = 1)", NULL };
 
 OptDef MyOptions[] =
 {
@@ -67,7 +70,9 @@ OptDef MyOptions[] =
 	{ OPTION_MAXERR, 		ALIAS_MAXERR,		NULL, 	maxerr_usage,		1, 	true, 	false },
 	{ OPTION_INTERSECT,		ALIAS_INTERSECT,	NULL, 	intersect_usage,	1, 	false, 	false },
 	{ OPTION_EXCLUDE,		ALIAS_EXCLUDE,		NULL, 	exclude_usage,		1, 	true, 	false },
-    { OPTION_COLUMNWISE,    ALIAS_COLUMNWISE,   NULL,   columnwise_usage,   1,  false,  false }
+    { OPTION_COLUMNWISE,    ALIAS_COLUMNWISE,   NULL,   columnwise_usage,   1,  false,  false },
+    { OPTION_CHECKSUM,      ALIAS_CHECKSUM,     NULL,   checksum_usage,     1,  false,  false },
+    { OPTION_THREADS,       ALIAS_THREADS,      NULL,   threads_usage,      1,  true,   false }
 };
 
 const char UsageDefaultName[] = "vdb-diff";
@@ -106,6 +111,8 @@ rc_t CC Usage ( const Args * args )
 	HelpOptionLine ( ALIAS_INTERSECT, 	OPTION_INTERSECT,   NULL,			intersect_usage );
 	HelpOptionLine ( ALIAS_EXCLUDE, 	OPTION_EXCLUDE,   	"column-set",	exclude_usage );
 	HelpOptionLine ( ALIAS_COLUMNWISE, 	OPTION_COLUMNWISE, 	NULL,	        columnwise_usage );
+	HelpOptionLine ( ALIAS_CHECKSUM, 	OPTION_CHECKSUM, 	NULL,	        checksum_usage );
+	HelpOptionLine ( ALIAS_THREADS, 	OPTION_THREADS, 	"count",	    threads_usage );
 
     HelpOptionsStandard ();
     HelpVersion ( fullpath, KAppVersion() );
@@ -158,16 +165,32 @@ static rc_t perform_table_diff( const VTable * tab_1, const VTable * tab_2,
                 }
                 else
                 {
+                    suspect_rows * suspects = NULL;
                     rc = col_defs_fill( defs, cols_to_diff );
-                    if ( rc == 0 )
+                    if ( rc == 0 && dctx -> checksum_first )
+                        rc = bbb_find_suspect_rows( tab_1, tab_2, dctx, &suspects );
+                    if ( rc == 0 && suspects != NULL && suspects -> count == 0 )
                     {
-                        /* ******************************************* */
-                        if ( dctx -> columnwise )
-                            rc = cbc_diff_columns( defs, tab_1, tab_2, dctx, tablename, diffs );
-                        else
-                            rc = rbr_diff_columns( defs, tab_1, tab_2, dctx, diffs );
-                        /* ******************************************* */
+                        /* the stored data is identical: nothing to decode */
+                        rc = KOutMsg( "\nall blobs identical, no rows decoded\n" );
                     }
+                    else if ( rc == 0 )
+                    {
+                        if ( suspects != NULL )
+                            rc = KOutMsg( "%,lu rows in blobs that differ\n", bbb_suspect_count( suspects ) );
+                        if ( rc == 0 )
+                        {
+                            /* ******************************************* */
+                            if ( dctx -> columnwise )
+                                rc = cbc_diff_columns( defs, tab_1, tab_2, dctx, tablename, suspects, diffs );
+                            else if ( dctx -> num_threads > 1 || suspects != NULL )
+                                rc = rbr_diff_columns_parallel( defs, tab_1, tab_2, dctx, suspects, diffs );
+                            else
+                                rc = rbr_diff_columns( defs, tab_1, tab_2, dctx, diffs );
+                            /* ******************************************* */
+                        }
+                    }
+                    bbb_release_suspect_rows( suspects );
                     col_defs_destroy( defs );
                 }
                 KNamelistRelease( cols_to_diff );
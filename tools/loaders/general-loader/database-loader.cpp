@@ -42,23 +42,330 @@
 
 #include <kapp/main.h>
 
+#include <kproc/thread.h>
+#include <kproc/queue.h>
+#include <kproc/timeout.h>
+
 #include <loader/loader-meta.h>
 
 #include <algorithm>
 
+#include <string.h>
+
 using namespace std;
 
+///////////// GeneralLoader::DatabaseLoader::TableWriter
+
+static
+rc_t
+CommitRow ( VCursor * p_cursor )
+{
+    rc_t rc = VCursorCommitRow ( p_cursor );
+    if ( rc == 0 )
+    {
+        rc = VCursorCloseRow ( p_cursor );
+        if ( rc == 0 )
+        {
+            rc = VCursorOpenRow ( p_cursor );
+        }
+    }
+    return rc;
+}
+
+// Cells and row commits for some tables are appended to a batch on the parser's thread;
+// full batches go through a bounded queue to a thread that owns these tables' cursors from
+// OpenStream until Stop, so tables encode and commit concurrently while the events of
+// each table are applied in stream order. --threads N gives N writers, table i goes to writer i % N
+class GeneralLoader :: DatabaseLoader :: TableWriter
+{
+public:
+    TableWriter ( const Cursors& p_cursors );
+    ~TableWriter ();
+
+    rc_t Start ();
+    // submits the pending batch and waits until the thread has applied everything; returns the first error
+    rc_t Stop ();
+
+    rc_t CellData    ( const Column& p_col, const void* p_data, size_t p_elemCount );
+    rc_t CellDefault ( const Column& p_col, const void* p_data, size_t p_elemCount );
+    rc_t NextRow ( uint32_t p_cursorIdx );
+    rc_t MoveAhead ( uint32_t p_cursorIdx, uint64_t p_count );
+
+private:
+    enum { BatchSize = 64 * 1024, QueueCapacity = 64 };
+
+    enum RecordType { recData, recDefault, recNextRow, recMoveAhead };
+    struct Record
+    {
+        uint32_t type;
+        uint32_t cursorIdx;
+        uint32_t columnIdx;
+        uint32_t elemBits;
+        uint32_t size;      // bytes of data following the record, padded to 8
+        uint64_t count;     // elements for recData/recDefault, rows for recMoveAhead
+    };
+    typedef std :: vector < uint8_t > Batch;
+
+    rc_t Append ( RecordType p_type, uint32_t p_cursorIdx, const Column* p_col, const void* p_data, uint64_t p_count );
+    rc_t Submit ();
+    rc_t Apply ( const Batch& p_batch );
+
+    static rc_t CC Run ( const KThread * p_self, void * p_data );
+
+private:
+    Cursors     m_cursors;  // a copy, the stream cannot add tables once it is open
+    KQueue *    m_queue;
+    KThread *   m_thread;
+    Batch *     m_batch;
+    rc_t        m_rc;   // written by the thread, read after KThreadWait
+};
+
+GeneralLoader :: DatabaseLoader :: TableWriter :: TableWriter ( const Cursors& p_cursors )
+:   m_cursors ( p_cursors ),
+    m_queue ( 0 ),
+    m_thread ( 0 ),
+    m_batch ( 0 ),
+    m_rc ( 0 )
+{
+}
+
+GeneralLoader :: DatabaseLoader :: TableWriter :: ~TableWriter ()
+{
+    Stop ();
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Start ()
+{
+    assert ( m_thread == 0 );
+    m_rc = 0;
+    rc_t rc = KQueueMake ( & m_queue, QueueCapacity );
+    if ( rc == 0 )
+    {
+        rc = KThreadMake ( & m_thread, Run, this );
+        if ( rc != 0 )
+        {
+            KQueueRelease ( m_queue );
+            m_queue = 0;
+        }
+    }
+    return rc;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Stop ()
+{
+    if ( m_thread == 0 )
+    {
+        return 0;
+    }
+
+    rc_t rc = Submit ();
+    KQueueSeal ( m_queue );
+
+    rc_t status = 0;
+    rc_t rc2 = KThreadWait ( m_thread, & status );
+    if ( rc == 0 )
+    {
+        rc = rc2 != 0 ? rc2 : m_rc;
+    }
+    KThreadRelease ( m_thread );
+    m_thread = 0;
+
+    // the thread may have quit on an error, leaving batches behind
+    void * item;
+    timeout_t tm;
+    TimeoutInit ( & tm, 0 );
+    while ( KQueuePop ( m_queue, & item, & tm ) == 0 )
+    {
+        delete static_cast < Batch * > ( item );
+    }
+    KQueueRelease ( m_queue );
+    m_queue = 0;
+
+    delete m_batch;
+    m_batch = 0;
+
+    return rc;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Append ( RecordType p_type, uint32_t p_cursorIdx, const Column* p_col, const void* p_data, uint64_t p_count )
+{
+    uint64_t bytes = 0;
+    if ( p_col != 0 )
+    {
+        bytes = ( p_col -> elemBits * p_count + 7 ) / 8;
+        if ( bytes > 0xFFFFFFF0 )
+        {
+            return RC ( rcExe, rcCursor, rcWriting, rcData, rcExcessive );
+        }
+    }
+
+    if ( m_batch == 0 )
+    {
+        m_batch = new Batch;
+        m_batch -> reserve ( BatchSize + sizeof ( Record ) );
+    }
+
+    Record rec;
+    rec . type      = p_type;
+    rec . cursorIdx = p_cursorIdx;
+    rec . columnIdx = p_col == 0 ? 0 : p_col -> columnIdx;
+    rec . elemBits  = p_col == 0 ? 0 : p_col -> elemBits;
+    rec . size      = ( uint32_t ) ( ( bytes + 7 ) & ~ ( uint64_t ) 7 );
+    rec . count     = p_count;
+
+    size_t const offset = m_batch -> size ();
+    m_batch -> resize ( offset + sizeof rec + rec . size );
+    memmove ( & ( * m_batch ) [ offset ], & rec, sizeof rec );
+    if ( bytes != 0 )
+    {
+        memmove ( & ( * m_batch ) [ offset + sizeof rec ], p_data, bytes );
+    }
+
+    return m_batch -> size () >= BatchSize ? Submit () : 0;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Submit ()
+{
+    if ( m_batch == 0 || m_batch -> empty () )
+    {
+        return 0;
+    }
+    if ( m_thread == 0 )
+    {
+        return RC ( rcExe, rcCursor, rcWriting, rcThread, rcInvalid );
+    }
+
+    for ( ; ; )
+    {
+        timeout_t tm;
+        TimeoutInit ( & tm, 1000 );
+        rc_t rc = KQueuePush ( m_queue, m_batch, & tm );
+        if ( rc == 0 )
+        {
+            m_batch = 0;
+            return 0;
+        }
+        if ( GetRCObject ( rc ) != ( RCObject ) rcTimeout )
+        {   // the thread sealed the queue after a failure; report the failure rather than the sealed queue
+            delete m_batch;
+            m_batch = 0;
+            rc_t rc2 = Stop ();
+            return rc2 != 0 ? rc2 : rc;
+        }
+    }
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: Apply ( const Batch& p_batch )
+{
+    rc_t rc = 0;
+    size_t offset = 0;
+    while ( rc == 0 && offset < p_batch . size () )
+    {
+        const Record * rec = reinterpret_cast < const Record * > ( & p_batch [ offset ] );
+        const void * data = & p_batch [ offset ] + sizeof ( Record );
+        VCursor * cursor = m_cursors [ rec -> cursorIdx ];
+        switch ( rec -> type )
+        {
+        case recData:
+            rc = VCursorWrite ( cursor, rec -> columnIdx, rec -> elemBits, data, 0, rec -> count );
+            break;
+        case recDefault:
+            rc = VCursorDefault ( cursor, rec -> columnIdx, rec -> elemBits, data, 0, rec -> count );
+            break;
+        case recNextRow:
+            rc = CommitRow ( cursor );
+            break;
+        case recMoveAhead:
+            for ( uint64_t i = 0; rc == 0 && i < rec -> count; ++i )
+            {
+                rc = CommitRow ( cursor );
+            }
+            break;
+        }
+        offset += sizeof ( Record ) + rec -> size;
+    }
+    return rc;
+}
+
+rc_t CC
+GeneralLoader :: DatabaseLoader :: TableWriter :: Run ( const KThread * p_self, void * p_data )
+{
+    TableWriter & self = * static_cast < TableWriter * > ( p_data );
+    for ( ; ; )
+    {
+        void * item;
+        timeout_t tm;
+        TimeoutInit ( & tm, 1000 );
+        rc_t rc = KQueuePop ( self . m_queue, & item, & tm );
+        if ( rc == 0 )
+        {
+            Batch * batch = static_cast < Batch * > ( item );
+            self . m_rc = self . Apply ( * batch );
+            delete batch;
+            if ( self . m_rc != 0 )
+            {   // stop accepting batches, the parser sees the failure on its next push
+                KQueueSeal ( self . m_queue );
+                break;
+            }
+        }
+        else if ( GetRCObject ( rc ) == ( RCObject ) rcTimeout )
+        {
+            continue;
+        }
+        else
+        {
+            if ( GetRCObject ( rc ) != ( RCObject ) rcData || GetRCState ( rc ) != rcDone )
+            {   // anything but "sealed and empty"
+                self . m_rc = rc;
+            }
+            break;
+        }
+    }
+    return self . m_rc;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: CellData ( const Column& p_col, const void* p_data, size_t p_elemCount )
+{
+    return Append ( recData, p_col . cursorIdx, & p_col, p_data, p_elemCount );
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: CellDefault ( const Column& p_col, const void* p_data, size_t p_elemCount )
+{
+    return Append ( recDefault, p_col . cursorIdx, & p_col, p_data, p_elemCount );
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: NextRow ( uint32_t p_cursorIdx )
+{
+    return Append ( recNextRow, p_cursorIdx, 0, 0, 0 );
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: TableWriter :: MoveAhead ( uint32_t p_cursorIdx, uint64_t p_count )
+{
+    return Append ( recMoveAhead, p_cursorIdx, 0, 0, p_count );
+}
+
 ///////////// GeneralLoader::DatabaseLoader
 
 GeneralLoader :: DatabaseLoader :: DatabaseLoader ( const std::string&  p_programName,
                                                     const Paths&        p_includePaths,
                                                     const Paths&        p_schemas,
-                                                    const std::string&  p_dbNameOverride )
+                                                    const std::string&  p_dbNameOverride,
+                                                    uint32_t            p_threads )
 :   m_includePaths ( p_includePaths ),
     m_schemas ( p_schemas ),
     m_programName ( p_programName ),
     m_databaseName ( p_dbNameOverride ), // if specified, overrides the database path coming in from the stream
     m_softwareVersion ( 0 ),
+    m_threads ( p_threads ),
     m_mgr ( 0 ),
     m_schema ( 0 ),
     m_databaseNameOverridden ( ! m_databaseName.empty() )
@@ -68,6 +375,8 @@ GeneralLoader :: DatabaseLoader :: DatabaseLoader ( const std::string&  p_progra
 
 GeneralLoader :: DatabaseLoader :: ~DatabaseLoader ()
 {
+    StopTableWriters ();
+
     m_tables . clear();
     m_columns . clear ();
 
@@ -485,6 +794,20 @@ GeneralLoader :: DatabaseLoader :: TblMetadataNode ( uint32_t p_objId, const str
     Tables::iterator it = m_tables . find ( p_objId );
     if ( it != m_tables . end() )
     {
+        if ( ! m_writers . empty () )
+        {   // let the table's writer catch up with the stream before touching its metadata
+            TableWriter * writer = m_writers [ it -> second . cursorIdx ];
+            rc = writer -> Stop ();
+            if ( rc == 0 )
+            {
+                rc = writer -> Start ();
+            }
+            if ( rc != 0 )
+            {
+                return rc;
+            }
+        }
+
         struct VTable* tbl;
         assert ( m_cursors [ it -> second . cursorIdx ] );
         rc = VCursorOpenParentUpdate ( m_cursors [ it -> second . cursorIdx ], &tbl );
@@ -637,7 +960,14 @@ GeneralLoader :: DatabaseLoader :: CellData ( uint32_t p_columnId, const void* p
                   "database-loader: columnIdx = $(i), elem size=$(s) bits, elem count=$(c)",
                   "i=%u,s=%u,c=%u",
                   col . columnIdx, col . elemBits, p_elemCount );
-        rc = CursorWrite ( col, p_data, p_elemCount );
+        if ( m_writers . empty () )
+        {
+            rc = CursorWrite ( col, p_data, p_elemCount );
+        }
+        else
+        {
+            rc = m_writers [ col . cursorIdx ] -> CellData ( col, p_data, p_elemCount );
+        }
     }
     else
     {
@@ -658,7 +988,14 @@ GeneralLoader :: DatabaseLoader :: CellDefault ( uint32_t p_columnId, const void
                   "database-loader: columnIdx = $(i), elem size=$(s) bits, elem count=$(c)",
                   "i=%u,s=%u,c=%u",
                   col . columnIdx, col . elemBits, p_elemCount );
-        rc = CursorDefault ( col, p_data, p_elemCount );
+        if ( m_writers . empty () )
+        {
+            rc = CursorDefault ( col, p_data, p_elemCount );
+        }
+        else
+        {
+            rc = m_writers [ col . cursorIdx ] -> CellDefault ( col, p_data, p_elemCount );
+        }
     }
     else
     {
@@ -741,13 +1078,77 @@ GeneralLoader :: DatabaseLoader :: OpenStream ()
             }
         }
     }
+    if ( rc == 0 )
+    {
+        rc = StartTableWriters ();
+    }
     return rc;
 }
 
 rc_t
-GeneralLoader :: DatabaseLoader :: CloseStream ()
+GeneralLoader :: DatabaseLoader :: StartTableWriters ()
+{
+    if ( m_threads <= 1 || m_cursors . size () <= 1 )
+    {
+        return 0;
+    }
+
+    // no more writers than threads requested, table i is written by writer i % n
+    size_t const count = m_cursors . size () < m_threads ? m_cursors . size () : m_threads;
+    pLogMsg ( klogDebug, "database-loader: writing $(t) tables on $(n) threads", "t=%u,n=%u",
+              ( unsigned int ) m_cursors . size (), ( unsigned int ) count );
+
+    for ( size_t i = 0; i < count; ++i )
+    {
+        TableWriter * writer = new TableWriter ( m_cursors );
+        m_writers . push_back ( writer );
+        rc_t rc = writer -> Start ();
+        if ( rc != 0 )
+        {
+            StopTableWriters ();
+            return rc;
+        }
+    }
+    for ( size_t i = count; i < m_cursors . size (); ++i )
+    {
+        m_writers . push_back ( m_writers [ i % count ] );
+    }
+    return 0;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: StopTableWriters ()
 {
     rc_t rc = 0;
+    // the writers of the first tables are shared by the others, each of them is in front once
+    size_t const count = m_writers . size () < m_threads ? m_writers . size () : m_threads;
+    for ( size_t i = 0; i < count; ++i )
+    {
+        rc_t rc2 = m_writers [ i ] -> Stop ();
+        if ( rc == 0 )
+        {
+            rc = rc2;
+        }
+        delete m_writers [ i ];
+    }
+    m_writers . clear ();
+    return rc;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: CloseStream ()
+{
+    // every table's events have to be applied before the rows are closed
+    rc_t rc = StopTableWriters ();
+    if ( rc != 0 )
+    {
+        return rc;
+    }
+    if ( ! m_rowBatches . empty () )
+    {
+        LogMsg ( klogErr, "database-loader: stream ended with cell rows not followed by next-rows" );
+        return RC ( rcExe, rcFile, rcReading, rcData, rcIncomplete );
+    }
     rc_t rc2 = 0;
 
     for ( Cursors::iterator it = m_cursors . begin(); it != m_cursors . end(); ++it )
@@ -810,15 +1211,13 @@ GeneralLoader :: DatabaseLoader :: NextRow ( uint32_t p_tableId )
     Tables::const_iterator table = m_tables . find ( p_tableId );
     if ( table != m_tables . end() )
     {
-        VCursor * cursor = m_cursors [ table -> second . cursorIdx ];
-        rc = VCursorCommitRow ( cursor );
-        if ( rc == 0 )
+        if ( m_writers . empty () )
         {
-            rc = VCursorCloseRow ( cursor );
-            if ( rc == 0 )
-            {
-                rc = VCursorOpenRow ( cursor );
-            }
+            rc = CommitRow ( m_cursors [ table -> second . cursorIdx ] );
+        }
+        else
+        {
+            rc = m_writers [ table -> second . cursorIdx ] -> NextRow ( table -> second . cursorIdx );
         }
     }
     else
@@ -833,7 +1232,11 @@ GeneralLoader :: DatabaseLoader :: MoveAhead ( uint32_t p_tableId, uint64_t p_co
 {
     rc_t rc = 0;
     Tables::const_iterator table = m_tables . find ( p_tableId );
-    if ( table != m_tables . end() )
+    if ( table != m_tables . end() && ! m_writers . empty () )
+    {
+        rc = m_writers [ table -> second . cursorIdx ] -> MoveAhead ( table -> second . cursorIdx, p_count );
+    }
+    else if ( table != m_tables . end() )
     {
         VCursor * cursor = m_cursors [ table -> second . cursorIdx ];
         for ( uint64_t i = 0; i < p_count; ++i )
@@ -862,6 +1265,98 @@ GeneralLoader :: DatabaseLoader :: MoveAhead ( uint32_t p_tableId, uint64_t p_co
     return rc;
 }
 
+rc_t
+GeneralLoader :: DatabaseLoader :: CellRows ( uint32_t p_columnId, const void* p_data, const uint32_t* p_elemCounts, uint32_t p_rowCount )
+{
+    Columns::const_iterator curIt = m_columns . find ( p_columnId );
+    if ( curIt == m_columns . end () )
+    {
+        return RC ( rcExe, rcFile, rcReading, rcColumn, rcNotFound );
+    }
+    const Column& col = curIt -> second;
+    if ( col . elemBits % 8 != 0 )
+    {
+        return RC ( rcExe, rcFile, rcReading, rcData, rcInvalid );
+    }
+
+    uint64_t elemCount = 0;
+    for ( uint32_t i = 0; i < p_rowCount; ++i )
+    {
+        elemCount += p_elemCounts [ i ];
+    }
+    pLogMsg ( klogDebug,
+              "database-loader: columnIdx = $(i), elem size=$(s) bits, rows=$(r), elem count=$(c)",
+              "i=%u,s=%u,r=%u,c=%lu",
+              col . columnIdx, col . elemBits, p_rowCount, elemCount );
+
+    PendingRows& pending = m_rowBatches [ p_columnId ];
+    pending . elemCounts . insert ( pending . elemCounts . end (), p_elemCounts, p_elemCounts + p_rowCount );
+    const uint8_t* data = static_cast < const uint8_t* > ( p_data );
+    pending . data . insert ( pending . data . end (), data, data + elemCount * ( col . elemBits / 8 ) );
+    return 0;
+}
+
+rc_t
+GeneralLoader :: DatabaseLoader :: NextRows ( uint32_t p_tableId, uint64_t p_count )
+{
+    Tables::const_iterator table = m_tables . find ( p_tableId );
+    if ( table == m_tables . end() )
+    {
+        return RC ( rcExe, rcFile, rcReading, rcTable, rcNotFound );
+    }
+
+    // the table's columns with pending cells; each has to cover exactly p_count rows
+    typedef std :: pair < const Column*, RowBatches :: iterator > Batch;
+    std :: vector < Batch > batches;
+    for ( RowBatches::iterator it = m_rowBatches . begin(); it != m_rowBatches . end(); ++it )
+    {
+        const Column& col = m_columns [ it -> first ];
+        if ( col . tableId != p_tableId )
+        {
+            continue;
+        }
+        if ( it -> second . elemCounts . size () != p_count )
+        {
+            pLogMsg ( klogErr,
+                      "database-loader: column '$(c)' has $(n) pending rows, expected $(e)",
+                      "c=%s,n=%lu,e=%lu",
+                      col . name . c_str (), ( uint64_t ) it -> second . elemCounts . size (), p_count );
+            return RC ( rcExe, rcFile, rcReading, rcData, rcInconsistent );
+        }
+        batches . push_back ( Batch ( & col, it ) );
+    }
+
+    rc_t rc = 0;
+    std :: vector < size_t > offsets ( batches . size (), 0 );
+    TableWriter * writer = m_writers . empty () ? 0 : m_writers [ table -> second . cursorIdx ];
+    for ( uint64_t row = 0; row < p_count && rc == 0; ++row )
+    {
+        for ( size_t i = 0; i < batches . size () && rc == 0; ++i )
+        {
+            const Column& col = * batches [ i ] . first;
+            const PendingRows& pending = batches [ i ] . second -> second;
+            uint32_t elemCount = pending . elemCounts [ row ];
+            if ( elemCount == 0 )
+            {   // same as a cell that was never written
+                continue;
+            }
+            const void* data = & pending . data [ offsets [ i ] ];
+            rc = writer == 0 ? CursorWrite ( col, data, elemCount ) : writer -> CellData ( col, data, elemCount );
+            offsets [ i ] += elemCount * ( col . elemBits / 8 );
+        }
+        if ( rc == 0 )
+        {
+            rc = writer == 0 ? CommitRow ( m_cursors [ table -> second . cursorIdx ] ) : writer -> NextRow ( table -> second . cursorIdx );
+        }
+    }
+
+    for ( size_t i = 0; i < batches . size (); ++i )
+    {
+        m_rowBatches . erase ( batches [ i ] . second );
+    }
+    return rc;
+}
+
 rc_t
 GeneralLoader :: DatabaseLoader :: ErrorMessage ( const string & p_text )
 {
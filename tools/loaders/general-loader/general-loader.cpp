@@ -34,26 +34,71 @@
 #include <kfs/directory.h>
 
 #include <general-writer/general-writer.h>
+#include <general-writer/gw-ring.h>
+
+#include <errno.h>
 
 using namespace std;
 
 ///////////// GeneralLoader::Reader
 
 GeneralLoader::Reader::Reader( const struct KStream& p_input )
-:   m_input ( p_input ),
+:   m_input ( & p_input ),
+    m_ring ( 0 ),
+    m_held ( 0 ),
+    m_data ( 0 ),
+    m_buffer ( 0 ),
+    m_bufSize ( 0 ),
+    m_readCount ( 0 )
+{
+    KStreamAddRef ( m_input );
+}
+
+GeneralLoader::Reader::Reader( struct gw_ring& p_input )
+:   m_input ( 0 ),
+    m_ring ( & p_input ),
+    m_held ( 0 ),
+    m_data ( 0 ),
     m_buffer ( 0 ),
     m_bufSize ( 0 ),
     m_readCount ( 0 )
 {
-    KStreamAddRef ( & m_input );
 }
 
 GeneralLoader::Reader::~Reader()
 {
-    KStreamRelease ( & m_input );
+    ReleaseHeld ();
+    KStreamRelease ( m_input );
     free ( m_buffer );
 }
 
+static
+rc_t
+RingRC ( int p_err )
+{
+    switch ( p_err )
+    {
+    case 0:
+        return 0;
+    case EPIPE:
+        return RC ( rcExe, rcFile, rcReading, rcTransfer, rcIncomplete );
+    default:
+        return RC ( rcExe, rcFile, rcReading, rcParam, rcInvalid );
+    }
+}
+
+void
+GeneralLoader::Reader::ReleaseHeld()
+{
+    // bytes handed out in place by the previous Read( size_t ) are done with
+    if ( m_held != 0 )
+    {
+        gw_ring_consume ( m_ring, m_held );
+        m_held = 0;
+    }
+    m_data = 0;
+}
+
 rc_t
 GeneralLoader::Reader::Read( void * p_buffer, size_t p_size )
 {
@@ -63,12 +108,34 @@ GeneralLoader::Reader::Read( void * p_buffer, size_t p_size )
              ( unsigned int ) p_size, m_readCount );
 
     m_readCount += p_size;
-    return KStreamReadExactly ( & m_input, p_buffer, p_size );
+    if ( m_ring != 0 )
+    {
+        ReleaseHeld ();
+        return RingRC ( gw_ring_read ( m_ring, p_buffer, p_size ) );
+    }
+    return KStreamReadExactly ( m_input, p_buffer, p_size );
 }
 
 rc_t
 GeneralLoader::Reader::Read( size_t p_size )
 {
+    pLogMsg ( klogDebug, "general-loader: reading $(s) bytes", "s=%u", ( unsigned int ) p_size );
+
+    if ( m_ring != 0 )
+    {
+        ReleaseHeld ();
+        if ( p_size <= gw_ring_capacity ( m_ring ) )
+        {
+            rc_t rc = RingRC ( gw_ring_acquire ( m_ring, & m_data, p_size ) );
+            if ( rc == 0 )
+            {
+                m_held = p_size;
+                m_readCount += p_size;
+            }
+            return rc;
+        }
+    }
+
     if ( p_size > m_bufSize )
     {
         m_buffer = realloc ( m_buffer, p_size );
@@ -78,12 +145,16 @@ GeneralLoader::Reader::Read( size_t p_size )
             m_readCount = 0;
             return RC ( rcExe, rcFile, rcReading, rcMemory, rcExhausted );
         }
+        m_bufSize = p_size;
     }
-
-    pLogMsg ( klogDebug, "general-loader: reading $(s) bytes", "s=%u", ( unsigned int ) p_size );
+    m_data = m_buffer;
 
     m_readCount += p_size;
-    return KStreamReadExactly ( & m_input, m_buffer, p_size );
+    if ( m_ring != 0 )
+    {
+        return RingRC ( gw_ring_read ( m_ring, m_buffer, p_size ) );
+    }
+    return KStreamReadExactly ( m_input, m_buffer, p_size );
 }
 
 void
@@ -100,7 +171,15 @@ GeneralLoader::Reader::Align( uint8_t p_bytes )
 
 GeneralLoader::GeneralLoader ( const std::string& p_programName, const struct KStream& p_input )
 :   m_programName ( p_programName ),
-    m_reader ( p_input )
+    m_reader ( p_input ),
+    m_threads ( 1 )
+{
+}
+
+GeneralLoader::GeneralLoader ( const std::string& p_programName, struct gw_ring& p_input )
+:   m_programName ( p_programName ),
+    m_reader ( p_input ),
+    m_threads ( 1 )
 {
 }
 
@@ -114,6 +193,12 @@ GeneralLoader::SetTargetOverride( const std::string& p_path )
     m_targetOverride = p_path;
 }
 
+void
+GeneralLoader::SetThreads( uint32_t p_threads )
+{
+    m_threads = p_threads;
+}
+
 void
 GeneralLoader::SplitAndAdd( Paths& p_paths, const string& p_path )
 {
@@ -147,7 +232,7 @@ GeneralLoader::Run()
     rc_t rc = ReadHeader ( packed );
     if ( rc == 0 )
     {
-        DatabaseLoader loader ( m_programName, m_includePaths, m_schemas, m_targetOverride );
+        DatabaseLoader loader ( m_programName, m_includePaths, m_schemas, m_targetOverride, m_threads );
         if ( packed )
         {
             PackedProtocolParser p;
@@ -34,6 +34,8 @@
 #include <map>
 
 struct KStream;
+struct gw_ring;
+struct gwp_rows_evt_v1;
 struct VCursor;
 struct VDatabase;
 struct VDBManager;
@@ -48,11 +50,14 @@ public:
     
 public:
     GeneralLoader ( const std :: string& p_programName, const struct KStream& p_input );
+    // reads from a shared-memory ring attached by the caller, which keeps ownership
+    GeneralLoader ( const std :: string& p_programName, struct gw_ring& p_input );
     ~GeneralLoader ();
     
     void AddSchemaIncludePath( const std::string& p_path );
     void AddSchemaFile( const std::string& p_file );
     void SetTargetOverride( const std::string& p_path );
+    void SetThreads( uint32_t p_threads );
     
     rc_t Run ();
     
@@ -66,22 +71,29 @@ private:
     {
     public:
         Reader( const struct KStream& p_input );
+        Reader( struct gw_ring& p_input );
         ~Reader();
         
         // read into caller's buffer
         rc_t Read( void * p_buffer, size_t p_size ); 
         
         // if rc == 0, there are p_size bytes available through GetBuffer until the next call to Read
+        // ( from a ring, these normally point into the ring itself )
         rc_t Read( size_t p_size ); 
         
-        const void* GetBuffer() const { return m_buffer; }
+        const void* GetBuffer() const { return m_data; }
         
         void Align( uint8_t p_bytes = 4 );
         
         uint64_t GetReadCount() { return m_readCount; }
         
     private:
-        const struct KStream& m_input;
+        void ReleaseHeld();
+        
+        const struct KStream* m_input;
+        struct gw_ring* m_ring;
+        size_t m_held;
+        const void* m_data;
         void* m_buffer;
         size_t m_bufSize;
         uint64_t m_readCount;
@@ -114,7 +126,7 @@ private:
         };
 
     public:
-        DatabaseLoader ( const std :: string& p_programName, const Paths& p_includePaths, const Paths& p_schemas, const std::string& p_dbNameOverride = std::string() );
+        DatabaseLoader ( const std :: string& p_programName, const Paths& p_includePaths, const Paths& p_schemas, const std::string& p_dbNameOverride = std::string(), uint32_t p_threads = 1 );
         ~DatabaseLoader();
     
         rc_t UseSchema ( const std :: string& p_file, const std :: string& p_name );
@@ -138,6 +150,10 @@ private:
         rc_t CellDefault ( uint32_t p_columnId, const void* p_data, size_t p_elemCount );
         rc_t NextRow ( uint32_t p_tableId );
         rc_t MoveAhead ( uint32_t p_tableId, uint64_t p_count );
+        
+        // cells for p_rowCount consecutive rows of a column, held until NextRows commits the rows
+        rc_t CellRows ( uint32_t p_columnId, const void* p_data, const uint32_t* p_elemCounts, uint32_t p_rowCount );
+        rc_t NextRows ( uint32_t p_tableId, uint64_t p_count );
         rc_t ErrorMessage ( const std :: string& p_text );
         rc_t LogMessage ( const std :: string& p_text );
         rc_t ProgressMessage ( const std :: string& p_name, uint32_t p_pid, uint32_t p_timestamp, uint32_t p_version, uint32_t p_percent );
@@ -163,11 +179,30 @@ private:
         // From database id to parent database id 
         typedef std::map < uint32_t, uint32_t > DatabaseToParent; 
         
+        // Writes the cells and rows of some tables on its own thread
+        class TableWriter;
+        
+        // Parallel to Cursors, a writer is shared by the tables i, i + m_threads, ...;
+        // empty unless writing tables in parallel
+        typedef std::vector < TableWriter * > TableWriters;
+        
+        // Cells given by CellRows, waiting for NextRows
+        struct PendingRows
+        {
+            std :: vector < uint8_t > data;
+            std :: vector < uint32_t > elemCounts;
+        };
+        
+        // from ColumnId to its pending cells
+        typedef std::map < uint32_t, PendingRows > RowBatches;
+        
     private:
         rc_t MakeDatabase ( uint32_t p_id );
         rc_t CursorWrite   ( const Column& p_col, const void* p_data, size_t p_size );
         rc_t CursorDefault ( const Column& p_col, const void* p_data, size_t p_size );
         rc_t SaveColumnMetadata ( const Column& p_col );
+        rc_t StartTableWriters ();
+        rc_t StopTableWriters ();
 
     private:
         Paths                   m_includePaths;
@@ -186,6 +221,10 @@ private:
         Databases               m_databases;    
         DatabaseToParent        m_dbParents;    
         
+        uint32_t                m_threads;
+        TableWriters            m_writers;
+        RowBatches              m_rowBatches;
+        
         struct VDBManager*      m_mgr;
         struct VSchema*         m_schema;
         
@@ -213,13 +252,15 @@ private:
         virtual rc_t ParseEvents ( Reader&, DatabaseLoader& );
         
     private:
-        // read p_dataSize bytes and use one of the decoder functions in utf8-like-int-codec.h to unpack a sequence of integer values, 
+        // use one of the decoder functions in utf8-like-int-codec.h to unpack a sequence of integer values from [p_begin, p_end),
         // stored in m_unpackingBuf as a collection of bytes
-        template < typename T_uintXX > rc_t UncompressInt ( Reader& p_reader, uint32_t p_dataSize, int ( * p_decode ) ( uint8_t const* buf_start, uint8_t const* buf_xend, T_uintXX* ret_decoded ) );
+        template < typename T_uintXX > rc_t UncompressInt ( const uint8_t* p_begin, const uint8_t* p_end, int ( * p_decode ) ( uint8_t const* buf_start, uint8_t const* buf_xend, T_uintXX* ret_decoded ) );
         
         rc_t ParseData ( Reader& p_reader, DatabaseLoader& p_dbLoader, uint32_t p_columnId, uint32_t p_dataSize );
+        rc_t ParseRows ( Reader& p_reader, DatabaseLoader& p_dbLoader, uint32_t p_columnId, const gwp_rows_evt_v1& p_evt );
         
         std::vector<uint8_t>    m_unpackingBuf;
+        std::vector<uint32_t>   m_rowCounts;
     };
     
 private:    
@@ -238,6 +279,7 @@ private:
     Paths                   m_includePaths;
     Paths                   m_schemas;
     std::string             m_targetOverride;
+    uint32_t                m_threads;
 };
 
 #endif
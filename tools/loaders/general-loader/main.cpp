@@ -31,6 +31,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <errno.h>
 
 #include <iostream>
 
@@ -44,6 +45,8 @@
 
 #include <kns/stream.h>
 
+#include <general-writer/gw-ring.h>
+
 static char const option_include_paths[] = "include";
 #define OPTION_INCLUDE_PATHS option_include_paths
 #define ALIAS_INCLUDE_PATHS  "I"
@@ -74,6 +77,29 @@ char const * target_usage[] =
     NULL
 };
 
+static char const option_threads[] = "threads";
+#define OPTION_THREADS option_threads
+#define ALIAS_THREADS  "t"
+static
+char const * threads_usage[] = 
+{
+    "Number of threads writing tables in parallel, a thread writes several tables if there are more tables than threads. Default 1 (all tables are written on the input thread).",
+    NULL
+};
+
+static char const option_ring[] = "ring";
+#define OPTION_RING option_ring
+#define ALIAS_RING  "R"
+static
+char const * ring_usage[] = 
+{
+    "Read the stream from a shared-memory ring created by a writer on the same host, instead of standard input.",
+    NULL
+};
+
+/* how long to wait for the writer to create the ring */
+#define RING_ATTACH_TIMEOUT_MS ( 60 * 1000 )
+
 OptDef Options[] = 
 {
     /* order here is same as in param array below!!! */                 
@@ -81,6 +107,8 @@ OptDef Options[] =
     { OPTION_INCLUDE_PATHS, ALIAS_INCLUDE_PATHS,    NULL, include_paths_usage,  0,  true,        false },
     { OPTION_SCHEMAS,       ALIAS_SCHEMAS,          NULL, schemas_usage,        0,  true,        false },
     { OPTION_TARGET,        ALIAS_TARGET,           NULL, target_usage,         1,  true,        false },
+    { OPTION_THREADS,       ALIAS_THREADS,          NULL, threads_usage,        1,  true,        false },
+    { OPTION_RING,          ALIAS_RING,             NULL, ring_usage,           1,  true,        false },
 };
 
 const char* OptHelpParam[] =
@@ -89,6 +117,8 @@ const char* OptHelpParam[] =
     "path(s)",
     "path(s)",
     "path",
+    "count",
+    "path",
     "",
 };
 
@@ -99,7 +129,7 @@ rc_t UsageSummary (char const * progname)
         "\t%s [options] \n"
         "\n"
         "Summary:\n"
-        "\tPopulate a VDB database from standard input\n"
+        "\tPopulate a VDB database from standard input or a shared-memory ring\n"
         "\n"
         ,progname);
 }
@@ -140,6 +170,83 @@ rc_t CC Usage (const Args * args)
     return rc;
 }
 
+static
+rc_t
+RunLoader ( GeneralLoader& loader, const Args * args )
+{
+    uint32_t pcount;
+    rc_t rc = ArgsOptionCount (args, OPTION_INCLUDE_PATHS, &pcount);
+    if ( rc == 0 )
+    {
+        for ( uint32_t i = 0 ; i < pcount; ++i )
+        {
+            const void* value;
+            rc = ArgsOptionValue (args, OPTION_INCLUDE_PATHS, i, &value);
+            if ( rc != 0 )
+            {
+                break;
+            }
+            loader . AddSchemaIncludePath ( static_cast <char const*> (value) );
+        }
+    }
+    
+    rc = ArgsOptionCount (args, OPTION_SCHEMAS, &pcount);
+    if ( rc == 0 )
+    {
+        for ( uint32_t i = 0 ; i < pcount; ++i )
+        {
+            const void* value;
+            rc = ArgsOptionValue (args, OPTION_SCHEMAS, i, &value);
+            if ( rc != 0 )
+            {
+                break;
+            }
+            loader . AddSchemaFile( static_cast <char const*> (value) );
+        }
+    }
+    
+    rc = ArgsOptionCount (args, OPTION_TARGET, &pcount);
+    if ( rc == 0 && pcount == 1 )
+    {
+        const void* value;
+        rc = ArgsOptionValue (args, OPTION_TARGET, 0, &value);
+        if ( rc == 0 )
+        {
+            loader . SetTargetOverride ( static_cast <char const*> (value) );
+        }
+    }
+    
+    if ( rc == 0 )
+    {
+        rc = ArgsOptionCount (args, OPTION_THREADS, &pcount);
+        if ( rc == 0 && pcount == 1 )
+        {
+            const void* value;
+            rc = ArgsOptionValue (args, OPTION_THREADS, 0, &value);
+            if ( rc == 0 )
+            {
+                char * end;
+                unsigned long threads = strtoul ( static_cast <char const*> (value), & end, 10 );
+                if ( *end != 0 || threads == 0 || threads > UINT_MAX )
+                {
+                    rc = RC(rcApp, rcArgv, rcAccessing, rcParam, rcInvalid);
+                    LOGERR ( klogErr, rc, "invalid --threads value" );
+                }
+                else
+                {
+                    loader . SetThreads ( ( uint32_t ) threads );
+                }
+            }
+        }
+    }
+    
+    if ( rc == 0 )
+    {
+        rc = loader . Run();
+    }
+    return rc;
+}
+
 rc_t CC KMain (int argc, char * argv[])
 {
     Args * args;
@@ -163,65 +270,60 @@ rc_t CC KMain (int argc, char * argv[])
                     MiniUsage (args);
                 }
                 else
-                { 
-                    const KStream *std_in;
-                    rc = KStreamMakeStdIn ( & std_in );
-                    if ( rc == 0 )
+                {
+                    const char * ring_path = NULL;
+                    rc = ArgsOptionCount (args, OPTION_RING, &pcount);
+                    if ( rc == 0 && pcount == 1 )
                     {
-                        KStream* buffered;
-                        rc = KStreamMakeBuffered ( &buffered, std_in, 0 /*input-only*/, 0 /*use default size*/ );
+                        const void* value;
+                        rc = ArgsOptionValue (args, OPTION_RING, 0, &value);
                         if ( rc == 0 )
                         {
-                            GeneralLoader loader ( argv[0], *buffered );
-                            
-                            rc = ArgsOptionCount (args, OPTION_INCLUDE_PATHS, &pcount);
-                            if ( rc == 0 )
+                            ring_path = static_cast <char const*> (value);
+                        }
+                    }
+
+                    if ( rc == 0 && ring_path != NULL )
+                    {
+                        gw_ring * ring;
+                        int err = gw_ring_attach ( & ring, ring_path, RING_ATTACH_TIMEOUT_MS );
+                        if ( err != 0 )
+                        {
+                            if ( err == ETIMEDOUT )
                             {
-                                for ( uint32_t i = 0 ; i < pcount; ++i )
-                                {
-                                    const void* value;
-                                    rc = ArgsOptionValue (args, OPTION_INCLUDE_PATHS, i, &value);
-                                    if ( rc != 0 )
-                                    {
-                                        break;
-                                    }
-                                    loader . AddSchemaIncludePath ( static_cast <char const*> (value) );
-                                }
+                                rc = RC(rcApp, rcFile, rcOpening, rcTimeout, rcExhausted);
                             }
-                            
-                            rc = ArgsOptionCount (args, OPTION_SCHEMAS, &pcount);
-                            if ( rc == 0 )
+                            else
                             {
-                                for ( uint32_t i = 0 ; i < pcount; ++i )
-                                {
-                                    const void* value;
-                                    rc = ArgsOptionValue (args, OPTION_SCHEMAS, i, &value);
-                                    if ( rc != 0 )
-                                    {
-                                        break;
-                                    }
-                                    loader . AddSchemaFile( static_cast <char const*> (value) );
-                                }
+                                rc = RC(rcApp, rcFile, rcOpening, rcFile, rcInvalid);
                             }
-                            
-                            rc = ArgsOptionCount (args, OPTION_TARGET, &pcount);
-                            if ( rc == 0 && pcount == 1 )
+                            pLogErr ( klogErr, rc, "cannot attach to ring '$(p)': $(e)", "p=%s,e=%s", ring_path, strerror ( err ) );
+                        }
+                        else
+                        {
                             {
-                                const void* value;
-                                rc = ArgsOptionValue (args, OPTION_TARGET, 0, &value);
-                                if ( rc == 0 )
-                                {
-                                    loader . SetTargetOverride ( static_cast <char const*> (value) );
-                                }
+                                GeneralLoader loader ( argv[0], *ring );
+                                rc = RunLoader ( loader, args );
                             }
-                            
+                            gw_ring_release ( ring );
+                        }
+                    }
+                    else if ( rc == 0 )
+                    {
+                        const KStream *std_in;
+                        rc = KStreamMakeStdIn ( & std_in );
+                        if ( rc == 0 )
+                        {
+                            KStream* buffered;
+                            rc = KStreamMakeBuffered ( &buffered, std_in, 0 /*input-only*/, 0 /*use default size*/ );
                             if ( rc == 0 )
                             {
-                                rc = loader . Run();
+                                GeneralLoader loader ( argv[0], *buffered );
+                                rc = RunLoader ( loader, args );
+                                KStreamRelease ( buffered );
                             }
-                            KStreamRelease ( buffered );
+                            KStreamRelease ( std_in );
                         }
-                        KStreamRelease ( std_in );
                     }
                 }
             }
@@ -460,14 +460,14 @@ GeneralLoader :: UnpackedProtocolParser :: ParseEvents ( Reader& p_reader, Datab
 
 template < typename T_uintXX >
 rc_t
-GeneralLoader :: PackedProtocolParser :: UncompressInt (  Reader& p_reader, uint32_t p_dataSize, int (*p_decode) ( uint8_t const* buf_start, uint8_t const* buf_xend, T_uintXX* ret_decoded )  )
+GeneralLoader :: PackedProtocolParser :: UncompressInt (  const uint8_t* p_begin, const uint8_t* p_end, int (*p_decode) ( uint8_t const* buf_start, uint8_t const* buf_xend, T_uintXX* ret_decoded )  )
 {
     m_unpackingBuf . clear();
     // reserve enough for the best-packed case, when each element is represented with 1 byte
-    m_unpackingBuf . reserve ( sizeof ( T_uintXX ) * p_dataSize );
+    m_unpackingBuf . reserve ( sizeof ( T_uintXX ) * ( p_end - p_begin ) );
 
-    const uint8_t* buf_begin = reinterpret_cast<const uint8_t*> ( p_reader . GetBuffer() );
-    const uint8_t* buf_end   = buf_begin + p_dataSize;
+    const uint8_t* buf_begin = p_begin;
+    const uint8_t* buf_end   = p_end;
     while ( buf_begin < buf_end )
     {
         T_uintXX ret_decoded;
@@ -501,16 +501,17 @@ GeneralLoader :: PackedProtocolParser :: ParseData ( Reader& p_reader, DatabaseL
         {
             if ( col -> IsCompressed () )
             {
+                const uint8_t* buf = reinterpret_cast<const uint8_t*> ( p_reader . GetBuffer() );
                 switch ( col -> elemBits )
                 {
                 case 16:
-                    rc = UncompressInt ( p_reader, p_dataSize, decode_uint16 );
+                    rc = UncompressInt ( buf, buf + p_dataSize, decode_uint16 );
                     break;
                 case 32:
-                    rc = UncompressInt ( p_reader, p_dataSize, decode_uint32 );
+                    rc = UncompressInt ( buf, buf + p_dataSize, decode_uint32 );
                     break;
                 case 64:
-                    rc = UncompressInt ( p_reader, p_dataSize, decode_uint64 );
+                    rc = UncompressInt ( buf, buf + p_dataSize, decode_uint64 );
                     break;
                 default:
                     LogMsg ( klogErr, "protocol-parser: bad element size for packed integer" );
@@ -535,6 +536,90 @@ GeneralLoader :: PackedProtocolParser :: ParseData ( Reader& p_reader, DatabaseL
     return rc;
 }
 
+rc_t
+GeneralLoader :: PackedProtocolParser :: ParseRows ( Reader& p_reader, DatabaseLoader& p_dbLoader, uint32_t p_columnId, const gwp_rows_evt_v1& p_evt )
+{
+    const DatabaseLoader :: Column* col = p_dbLoader . GetColumn ( p_columnId );
+    if ( col == 0 )
+    {
+        return RC ( rcExe, rcFile, rcReading, rcColumn, rcNotFound );
+    }
+    if ( col -> elemBits % 8 != 0 )
+    {
+        LogMsg ( klogErr, "protocol-parser: cell rows for a column with partial-byte elements" );
+        return RC ( rcExe, rcFile, rcReading, rcData, rcInvalid );
+    }
+
+    uint32_t rowCount = ncbi :: rows ( p_evt );
+    uint32_t dataSize = ncbi :: size ( p_evt );
+    rc_t rc = p_reader . Read ( dataSize );
+    if ( rc != 0 )
+    {
+        return rc;
+    }
+
+    const uint8_t* buf = reinterpret_cast<const uint8_t*> ( p_reader . GetBuffer() );
+    const uint8_t* end = buf + dataSize;
+
+    uint64_t elemCount = 0;
+    if ( ncbi :: variable ( p_evt ) )
+    {
+        m_rowCounts . resize ( rowCount );
+        for ( uint32_t i = 0; i < rowCount; ++i )
+        {
+            int numRead = decode_uint32 ( buf, end, & m_rowCounts [ i ] );
+            if ( numRead <= 0 )
+            {
+                pLogMsg ( klogErr, "protocol-parser: decode_uint32() returned $(i)", "i=%i", numRead );
+                return RC ( rcExe, rcFile, rcReading, rcData, rcCorrupt );
+            }
+            buf += numRead;
+            elemCount += m_rowCounts [ i ];
+        }
+    }
+    else
+    {
+        m_rowCounts . assign ( rowCount, ncbi :: elem_count ( p_evt ) );
+        elemCount = ( uint64_t ) rowCount * ncbi :: elem_count ( p_evt );
+    }
+
+    const void* data = buf;
+    size_t dataBytes = end - buf;
+    if ( col -> IsCompressed () )
+    {
+        switch ( col -> elemBits )
+        {
+        case 16:
+            rc = UncompressInt ( buf, end, decode_uint16 );
+            break;
+        case 32:
+            rc = UncompressInt ( buf, end, decode_uint32 );
+            break;
+        case 64:
+            rc = UncompressInt ( buf, end, decode_uint64 );
+            break;
+        default:
+            LogMsg ( klogErr, "protocol-parser: bad element size for packed integer" );
+            rc = RC ( rcExe, rcFile, rcReading, rcData, rcInvalid );
+            break;
+        }
+        data = m_unpackingBuf . data ();
+        dataBytes = m_unpackingBuf . size ();
+    }
+
+    if ( rc == 0 && dataBytes != elemCount * ( col -> elemBits / 8 ) )
+    {
+        LogMsg ( klogErr, "protocol-parser: cell rows data does not match element counts" );
+        rc = RC ( rcExe, rcFile, rcReading, rcData, rcCorrupt );
+    }
+
+    if ( rc == 0 )
+    {
+        rc = p_dbLoader . CellRows ( p_columnId, data, m_rowCounts . data (), rowCount );
+    }
+    return rc;
+}
+
 rc_t
 GeneralLoader :: PackedProtocolParser :: ParseEvents( Reader& p_reader, DatabaseLoader& p_dbLoader )
 {
@@ -937,6 +1022,34 @@ GeneralLoader :: PackedProtocolParser :: ParseEvents( Reader& p_reader, Database
             }
             break;
 
+        case evt_cell_rows:
+            {
+                uint32_t columnId = ncbi :: id ( evt_header );
+                pLogMsg ( klogDebug, "protocol-parser event: Cell-Rows (packed), id=$(i)", "i=%u", columnId );
+
+                gwp_rows_evt_v1 evt;
+                rc = ReadEvent ( p_reader, evt );
+                if ( rc == 0 )
+                {
+                    rc = ParseRows ( p_reader, p_dbLoader, columnId, evt );
+                }
+            }
+            break;
+
+        case evt_next_rows:
+            {
+                uint32_t tableId = ncbi :: id ( evt_header );
+                pLogMsg ( klogDebug, "protocol-parser event: Next-Rows (packed), id=$(i)", "i=%u", tableId );
+
+                gwp_move_ahead_evt_v1 evt;
+                rc = ReadEvent ( p_reader, evt );
+                if ( rc == 0 )
+                {
+                    rc = p_dbLoader . NextRows ( tableId, ncbi :: get_nrows ( evt ) );
+                }
+            }
+            break;
+
         case evt_move_ahead:
             {
                 uint32_t tableId = ncbi :: id ( evt_header );
@@ -33,6 +33,7 @@
 #include "protocol-parser.cpp"
 
 #include <general-writer/utf8-like-int-codec.h>
+#include <general-writer/general-writer.hpp>
 
 #include <ktst/unit_test.hpp>
 
@@ -1124,6 +1125,178 @@ FIXTURE_TEST_CASE ( IntegerCompression_MultipleValues, GeneralLoaderFixture )
     REQUIRE_EQ ( u64value2, GetValueWithIndex<uint64_t> ( "TABLE1", "column64", 1, 2, 1 ) );
 }
 
+// batched cell rows
+
+FIXTURE_TEST_CASE ( CellRows_Fixed, GeneralLoaderFixture )
+{
+    if ( ! TestSource::packed )
+        return; // cell rows are used in packed mode only
+
+    OpenStream_OneTableOneColumn ( GetName() );
+
+    string value = "abcdefghi";
+    m_source . CellRowsEventRaw ( DefaultColumnId, 3, 3, false, value . data (), ( uint32_t ) value . size () );
+    m_source . NextRowsEvent ( DefaultTableId, 3 );
+    m_source . CloseStreamEvent();
+
+    REQUIRE ( Run ( m_source . MakeSource (), 0 ) );
+
+    REQUIRE_EQ ( string ( "abc" ), GetValue<string> ( DefaultTable, DefaultColumn, 1 ) );
+    REQUIRE_EQ ( string ( "def" ), GetValue<string> ( DefaultTable, DefaultColumn, 2 ) );
+    REQUIRE_EQ ( string ( "ghi" ), GetValue<string> ( DefaultTable, DefaultColumn, 3 ) );
+    REQUIRE_THROW ( GetValue<string> ( DefaultTable, DefaultColumn, 4 ) );
+}
+
+FIXTURE_TEST_CASE ( CellRows_Variable_IntegerCompression, GeneralLoaderFixture )
+{
+    if ( ! SetUpForIntegerCompression ( GetName() ) )
+        return;
+
+    m_source . OpenStreamEvent();
+
+    uint8_t buf[128];
+
+    {   // one element per row
+        int bytesTotal = 0;
+        for ( uint16_t i = 1; i <= 3; ++i )
+        {
+            bytesTotal += encode_uint16 ( i, buf + bytesTotal, buf + sizeof buf );
+        }
+        m_source . CellRowsEventRaw ( Column16Id, 3, 1, false, buf, bytesTotal );
+    }
+
+    {   // 2, 1 and 3 elements
+        const uint32_t counts [ 3 ] = { 2, 1, 3 };
+        int bytesTotal = 0;
+        for ( size_t i = 0; i < 3; ++i )
+        {
+            bytesTotal += encode_uint32 ( counts [ i ], buf + bytesTotal, buf + sizeof buf );
+        }
+        for ( uint32_t i = 10; i < 16; ++i )
+        {
+            bytesTotal += encode_uint32 ( i, buf + bytesTotal, buf + sizeof buf );
+        }
+        m_source . CellRowsEventRaw ( Column32Id, 3, 0, true, buf, bytesTotal );
+    }
+
+    m_source . NextRowsEvent ( DefaultTableId, 3 );
+    m_source . CloseStreamEvent();
+
+    {
+        GeneralLoader* gl = MakeLoader ( m_source . MakeSource () );
+        REQUIRE ( RunLoader ( *gl, 0 ) );
+        delete gl;
+    } // make sure loader is destroyed (= db closed) before we reopen the database for verification
+
+    REQUIRE_EQ ( ( uint16_t ) 1, GetValue<uint16_t> ( "TABLE1", "column16", 1 ) );
+    REQUIRE_EQ ( ( uint16_t ) 2, GetValue<uint16_t> ( "TABLE1", "column16", 2 ) );
+    REQUIRE_EQ ( ( uint16_t ) 3, GetValue<uint16_t> ( "TABLE1", "column16", 3 ) );
+
+    REQUIRE_EQ ( ( uint32_t ) 10, GetValueWithIndex<uint32_t> ( "TABLE1", "column32", 1, 2, 0 ) );
+    REQUIRE_EQ ( ( uint32_t ) 11, GetValueWithIndex<uint32_t> ( "TABLE1", "column32", 1, 2, 1 ) );
+    REQUIRE_EQ ( ( uint32_t ) 12, GetValue<uint32_t> ( "TABLE1", "column32", 2 ) );
+    REQUIRE_EQ ( ( uint32_t ) 13, GetValueWithIndex<uint32_t> ( "TABLE1", "column32", 3, 3, 0 ) );
+    REQUIRE_EQ ( ( uint32_t ) 15, GetValueWithIndex<uint32_t> ( "TABLE1", "column32", 3, 3, 2 ) );
+}
+
+FIXTURE_TEST_CASE ( CellRows_RowCountMismatch, GeneralLoaderFixture )
+{
+    if ( ! TestSource::packed )
+        return; // cell rows are used in packed mode only
+
+    OpenStream_OneTableOneColumn ( GetName() );
+
+    string value = "abcdefghi";
+    m_source . CellRowsEventRaw ( DefaultColumnId, 3, 3, false, value . data (), ( uint32_t ) value . size () );
+    m_source . NextRowsEvent ( DefaultTableId, 2 );
+    m_source . CloseStreamEvent();
+
+    REQUIRE ( Run ( m_source . MakeSource (), RC ( rcExe, rcFile, rcReading, rcData, rcInconsistent ) ) );
+}
+
+FIXTURE_TEST_CASE ( CellRows_NotCommitted, GeneralLoaderFixture )
+{
+    if ( ! TestSource::packed )
+        return; // cell rows are used in packed mode only
+
+    OpenStream_OneTableOneColumn ( GetName() );
+
+    string value = "abc";
+    m_source . CellRowsEventRaw ( DefaultColumnId, 1, 3, false, value . data (), ( uint32_t ) value . size () );
+    m_source . CloseStreamEvent();
+
+    REQUIRE ( Run ( m_source . MakeSource (), RC ( rcExe, rcFile, rcReading, rcData, rcIncomplete ) ) );
+}
+
+// batched cell rows, as produced by the C++ writer
+
+FIXTURE_TEST_CASE ( CellRows_WriterRoundTrip, GeneralLoaderFixture )
+{
+    if ( ! TestSource::packed )
+        return; // the writer produces packed streams only
+
+    string dbName = ScratchDir + GetName() + "-packed";
+    m_source . DatabaseEvent ( dbName ); // for the fixture to find the database
+    string streamFile = ScratchDir + GetName() + ".gw";
+    {
+        ncbi :: GeneralWriter gw ( streamFile );
+        gw . useRowBatches ();
+        gw . setRemotePath ( dbName );
+        gw . useSchema ( DefaultSchema, DefaultDatabase );
+        int tableId = gw . addTable ( DefaultTable );
+        int asciiId = gw . addColumn ( tableId, DefaultColumn, 8 );
+        int u32Id = gw . addIntegerColumn ( tableId, U32Column, 32 );
+        gw . open ();
+
+        const char ascii [] = "abcdefg";
+        const uint32_t counts [ 3 ] = { 3, 1, 3 };
+        gw . writeRows ( asciiId, 8, ascii, counts, 3 );
+        const uint32_t u32 [ 3 ] = { 1, 1000, 100000 };
+        gw . writeRows ( u32Id, 32, u32, 1, 3 );
+        gw . nextRows ( tableId, 3 );
+        gw . endStream ();
+    }
+
+    const KFile * input;
+    REQUIRE_RC ( KDirectoryOpenFileRead ( m_wd, & input, "%s", streamFile . c_str () ) );
+    REQUIRE ( Run ( input, 0 ) );
+
+    REQUIRE_EQ ( string ( "abc" ), GetValue<string> ( DefaultTable, DefaultColumn, 1 ) );
+    REQUIRE_EQ ( string ( "d" ), GetValue<string> ( DefaultTable, DefaultColumn, 2 ) );
+    REQUIRE_EQ ( string ( "efg" ), GetValue<string> ( DefaultTable, DefaultColumn, 3 ) );
+    REQUIRE_EQ ( ( uint32_t ) 1, GetValue<uint32_t> ( DefaultTable, U32Column, 1 ) );
+    REQUIRE_EQ ( ( uint32_t ) 1000, GetValue<uint32_t> ( DefaultTable, U32Column, 2 ) );
+    REQUIRE_EQ ( ( uint32_t ) 100000, GetValue<uint32_t> ( DefaultTable, U32Column, 3 ) );
+    REQUIRE_THROW ( GetValue<string> ( DefaultTable, DefaultColumn, 4 ) );
+}
+
+FIXTURE_TEST_CASE ( CellRows_WriterStaysCompatible, GeneralLoaderFixture )
+{
+    if ( ! TestSource::packed )
+        return;
+
+    // without row batches the stream is readable by version 2 loaders
+    string streamFile = ScratchDir + GetName() + ".gw";
+    {
+        ncbi :: GeneralWriter gw ( streamFile );
+        gw . setRemotePath ( ScratchDir + GetName() );
+        gw . useSchema ( DefaultSchema, DefaultDatabase );
+        int tableId = gw . addTable ( DefaultTable );
+        int asciiId = gw . addColumn ( tableId, DefaultColumn, 8 );
+        gw . open ();
+
+        REQUIRE_THROW ( gw . writeRows ( asciiId, 8, "abc", 3, 1 ) );
+        REQUIRE_THROW ( gw . useRowBatches () );
+        gw . endStream ();
+    }
+
+    ifstream in ( streamFile . c_str (), ifstream :: binary );
+    :: gw_header_v1 hdr;
+    in . read ( ( char * ) & hdr, sizeof hdr );
+    REQUIRE ( in . good () );
+    REQUIRE_EQ ( ( uint32_t ) GW_COMPATIBLE_VERSION, hdr . dad . version );
+}
+
 // default values
 
 FIXTURE_TEST_CASE ( OneColumnDefaultNoWrite, GeneralLoaderFixture )
@@ -1416,6 +1589,122 @@ FIXTURE_TEST_CASE ( MultipleTables_Multiple_Columns_MultipleRows, GeneralLoaderF
     REQUIRE_EQ ( t2c2v2,    GetValue<uint8_t>   ( Table2, U8Column, 2 ) );
 }
 
+FIXTURE_TEST_CASE ( MultipleTables_Threads, GeneralLoaderFixture )
+{
+    SetUpStream ( GetName() );
+
+    m_source . NewTableEvent ( 100, DefaultTable );
+    m_source . NewColumnEvent ( 1, 100, DefaultColumn, 8 );
+    m_source . NewColumnEvent ( 2, 100, U32Column, 32 );
+
+    m_source . NewTableEvent ( 200, Table2 );
+    m_source . NewColumnEvent ( 3, 200, I64Column, 64 );
+    m_source . NewColumnEvent ( 4, 200, U8Column, 8 );
+
+    m_source . OpenStreamEvent();
+
+    const uint64_t Rows = 1000;
+    string t1c1v = "default";
+    m_source . CellDefaultEvent( 1, t1c1v );
+    for ( uint64_t i = 1; i <= Rows; ++i )
+    {
+            uint32_t t1c2v = ( uint32_t ) i;
+            m_source . CellDataEvent( 2, t1c2v );
+        m_source . NextRowEvent ( 100 );
+
+            int64_t t2c1v = - ( int64_t ) i;
+            m_source . CellDataEvent( 3, t2c1v );
+            uint8_t t2c2v = ( uint8_t ) i;
+            m_source . CellDataEvent( 4, t2c2v );
+        m_source . NextRowEvent ( 200 );
+    }
+    m_source . MoveAheadEvent ( 100, 2 );
+
+    m_source . CloseStreamEvent();
+
+    {
+        GeneralLoader* gl = MakeLoader ( m_source . MakeSource () );
+        gl -> SetThreads ( 2 );
+        REQUIRE ( RunLoader ( *gl, 0 ) );
+        delete gl;
+    } // make sure loader is destroyed (= db closed) before we reopen the database for verification
+
+    REQUIRE_EQ ( t1c1v,                 GetValue<string>    ( DefaultTable, DefaultColumn, 1 ) );
+    REQUIRE_EQ ( ( uint32_t ) 1,        GetValue<uint32_t>  ( DefaultTable, U32Column, 1 ) );
+    REQUIRE_EQ ( ( uint32_t ) Rows,     GetValue<uint32_t>  ( DefaultTable, U32Column, Rows ) );
+    REQUIRE_EQ ( t1c1v,                 GetValue<string>    ( DefaultTable, DefaultColumn, Rows + 2 ) );
+    REQUIRE_THROW ( GetValue<string> ( DefaultTable, DefaultColumn, Rows + 3 ) );
+
+    REQUIRE_EQ ( - ( int64_t ) Rows,    GetValue<int64_t>   ( Table2, I64Column, Rows ) );
+    REQUIRE_EQ ( ( uint8_t ) Rows,      GetValue<uint8_t>   ( Table2, U8Column, Rows ) );
+    REQUIRE_THROW ( GetValue<int64_t> ( Table2, I64Column, Rows + 1 ) );
+}
+
+struct RingProducer
+{
+    gw_ring * ring;
+    std::string data;
+};
+
+static
+rc_t CC
+RingProducerThread ( const KThread *self, void *data )
+{
+    RingProducer * p = ( RingProducer * ) data;
+    int err = gw_ring_write ( p -> ring, p -> data . data (), p -> data . size () );
+    gw_ring_release ( p -> ring );
+    return err == 0 ? 0 : RC ( rcExe, rcFile, rcWriting, rcTransfer, rcIncomplete );
+}
+
+FIXTURE_TEST_CASE ( SharedRing, GeneralLoaderFixture )
+{
+    OpenStream_OneTableOneColumn ( GetName() );
+
+    const uint64_t Rows = 2000;
+    for ( uint64_t i = 1; i <= Rows; ++i )
+    {
+        m_source . CellDataEvent( DefaultColumnId, string ( i % 97 + 1, 'a' + i % 26 ) );
+        m_source . NextRowEvent ( DefaultTableId );
+    }
+    m_source . CloseStreamEvent();
+
+    // the serialized stream is much larger than the ring, so both sides wrap and wait
+    RingProducer producer;
+    {
+        const KFile * file = m_source . MakeSource ();
+        uint64_t size;
+        THROW_ON_RC ( KFileSize ( file, & size ) );
+        producer . data . resize ( size );
+        size_t num_read;
+        THROW_ON_RC ( KFileReadAll ( file, 0, & producer . data [ 0 ], size, & num_read ) );
+        THROW_ON_RC ( KFileRelease ( file ) );
+        REQUIRE_EQ ( ( size_t ) size, num_read );
+    }
+
+    string ringPath = ScratchDir + GetName() + ".ring";
+    REQUIRE_EQ ( 0, gw_ring_create ( & producer . ring, ringPath . c_str (), 4096 ) );
+    gw_ring * ring;
+    REQUIRE_EQ ( 0, gw_ring_attach ( & ring, ringPath . c_str (), 0 ) );
+    REQUIRE_LT ( gw_ring_capacity ( ring ), producer . data . size () );
+
+    KThread * t;
+    REQUIRE_RC ( KThreadMake ( & t, RingProducerThread, & producer ) );
+    {
+        GeneralLoader gl ( argv0, * ring );
+        gl . AddSchemaIncludePath ( ScratchDir );
+        REQUIRE ( RunLoader ( gl, 0 ) );
+    }
+    rc_t status;
+    REQUIRE_RC ( KThreadWait ( t, & status ) );
+    REQUIRE_RC ( status );
+    KThreadRelease ( t );
+    gw_ring_release ( ring );
+
+    REQUIRE_EQ ( string ( 2, 'a' + 1 ), GetValue<string> ( DefaultTable, DefaultColumn, 1 ) );
+    REQUIRE_EQ ( string ( Rows % 97 + 1, 'a' + Rows % 26 ), GetValue<string> ( DefaultTable, DefaultColumn, Rows ) );
+    REQUIRE_THROW ( GetValue<string> ( DefaultTable, DefaultColumn, Rows + 1 ) );
+}
+
 FIXTURE_TEST_CASE ( AdditionalSchemaIncludePaths_Single, GeneralLoaderFixture )
 {
     string schemaPath = "schema";
@@ -432,7 +432,28 @@ TestSource::Buffer::WritePacked ( const TestSource::Event& p_event )
         }
         break;
         
+    case evt_cell_rows :
+        {
+            gwp_rows_evt_v1 hdr;
+            init ( hdr, p_event . m_id1, evt_cell_rows );
+            set_rows ( hdr, p_event . m_uint32_2 );
+            if ( p_event . m_uint8 & GW_ROWS_VARIABLE )
+            {
+                set_variable ( hdr );
+            }
+            else
+            {
+                set_elem_count ( hdr, p_event . m_uint32 );
+            }
+            set_size ( hdr, p_event . m_val . size() );
+
+            Write ( & hdr, sizeof hdr );
+        }
+        Write ( p_event . m_val . data(), p_event . m_val . size() );
+        break;
+
     case evt_move_ahead:
+    case evt_next_rows:
         {
             gwp_move_ahead_evt_v1 hdr;
             init ( hdr, p_event . m_id1, p_event . m_event );
@@ -558,6 +579,12 @@ TestSource::MoveAheadEvent ( TableId p_id, uint64_t p_count )
     m_buffer -> Write ( Event ( evt_move_ahead, p_id, p_count ) );
 }
 
+void 
+TestSource::NextRowsEvent ( TableId p_id, uint64_t p_count )
+{
+    m_buffer -> Write ( Event ( evt_next_rows, p_id, p_count ) );
+}
+
 template<> void TestSource::CellDataEvent ( ColumnId p_columnId, string p_value )
 {
     m_buffer -> Write ( Event ( evt_cell_data, p_columnId, ( uint32_t ) p_value . size(), ( uint32_t ) p_value . size(), p_value . c_str() ) );
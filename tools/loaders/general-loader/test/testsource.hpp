@@ -86,6 +86,7 @@ public:
     void CloseStreamEvent ();
     void NextRowEvent ( TableId p_id );
     void MoveAheadEvent ( TableId p_id, uint64_t p_count );
+    void NextRowsEvent ( TableId p_id, uint64_t p_count );
     void CellDefaultEvent ( ColumnId p_columnId, const std :: string& p_value );
     void CellDefaultEvent ( ColumnId p_columnId, uint32_t p_value );
     void CellDefaultEvent ( ColumnId p_columnId, bool p_value );
@@ -108,6 +109,15 @@ public:
         m_buffer -> Write ( Event ( evt_cell_data, p_columnId, p_elemCount, p_size, p_value ) );
     }
 
+    // p_value holds the payload of the event as is: the packed per-row element counts if p_variable, then the elements
+    void CellRowsEventRaw ( ColumnId p_columnId, uint32_t p_rowCount, uint32_t p_elemCount, bool p_variable, const void* p_value, uint32_t p_size )
+    {
+        Event evt ( evt_cell_rows, p_columnId, p_elemCount, p_size, p_value );
+        evt . m_uint32_2 = p_rowCount;
+        evt . m_uint8 = p_variable ? GW_ROWS_VARIABLE : 0;
+        m_buffer -> Write ( evt );
+    }
+
 private:
     struct Event
     {
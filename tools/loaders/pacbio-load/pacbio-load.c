@@ -58,6 +58,8 @@
 
 #include <kfs/arrayfile.h>
 
+#include <kproc/thread.h>
+
 #include <loader/loader-meta.h>
 
 #include <sysalloc.h>
@@ -86,6 +88,7 @@ static const char* tabs_usage[] = { "load only these tabs (SCPM), dflt=all",
                                      " P...Passes",
                                      " M...Metrics", NULL };
 static const char* progress_usage[] = { "show load-progress", NULL };
+static const char* threads_usage[] = { "if > 1, load up to N tables in parallel, dflt=1", NULL };
 
 
 rc_t CC Usage ( const Args * args )
@@ -112,6 +115,7 @@ rc_t CC Usage ( const Args * args )
     HelpOptionLine ( ALIAS_TABS, OPTION_TABS, "tabs", tabs_usage );
     HelpOptionLine ( ALIAS_WITH_PROGRESS, OPTION_WITH_PROGRESS,
                      "load-progress", progress_usage );
+    HelpOptionLine ( NULL, OPTION_THREADS, "threads", threads_usage );
     XMLLogger_Usage();
     HelpOptionsStandard ();
     HelpVersion ( fullpath, KAppVersion() );
@@ -323,6 +327,198 @@ static rc_t pacbio_get_hdf5_src( KDirectory * wd, const VNamelist * path_list, u
 }
 
 
+enum { tab_sequence = 0, tab_consensus, tab_passes, tab_metrics, tab_count };
+
+/* one table of one source, loaded by its own thread */
+typedef struct table_job
+{
+    KThread * thread;
+    seq_con_pas_met * dst;
+    KDirectory * src;       /* its own handle to the hdf5-source */
+    ld_context lctx;        /* its own copy, to have its own progressbar */
+    uint32_t tab;
+    bool started;
+    rc_t rc;
+} table_job;
+
+
+static ld_context ** table_lctx( seq_con_pas_met * dst, uint32_t tab )
+{
+    switch( tab )
+    {
+        case tab_sequence  : return &dst->sequence.lctx;
+        case tab_consensus : return &dst->consensus.lctx;
+        case tab_passes    : return &dst->passes.lctx;
+        default            : return &dst->metrics.lctx;
+    }
+}
+
+
+static rc_t CC table_job_run( const KThread *self, void *data )
+{
+    table_job * job = data;
+    switch( job->tab )
+    {
+        case tab_sequence  : job->rc = load_seq_src( &job->dst->sequence, job->src ); break;
+        case tab_consensus : job->rc = load_consensus_src( &job->dst->consensus, job->src ); break;
+        case tab_passes    : job->rc = load_passes_src( &job->dst->passes, job->src ); break;
+        case tab_metrics   : job->rc = load_metrics_src( &job->dst->metrics, job->src ); break;
+    }
+    progress_release( &job->lctx.xml_progress );
+    return job->rc;
+}
+
+
+static rc_t table_job_start( table_job * job, uint32_t tab, context *ctx, KDirectory * wd,
+                             seq_con_pas_met * dst, uint32_t idx, ld_context * lctx )
+{
+    rc_t rc;
+
+    job->thread = NULL;
+    job->dst = dst;
+    job->src = NULL;
+    job->lctx = *lctx;
+    job->lctx.xml_progress = NULL;
+    /* the console-progressbar only for the sequence-table, they would overwrite each other */
+    job->lctx.with_progress = ( lctx->with_progress && tab == tab_sequence );
+    job->lctx.total_seq_bases = 0;
+    job->lctx.total_seq_spots = 0;
+    job->tab = tab;
+    job->rc = 0;
+
+    hdf5_enter();
+    rc = pacbio_get_hdf5_src( wd, ctx->src_paths, idx, &job->src );
+    hdf5_leave();
+    if ( rc == 0 )
+    {
+        *( table_lctx( dst, tab ) ) = &job->lctx;
+        rc = KThreadMake ( &job->thread, table_job_run, job );
+        if ( rc != 0 )
+        {
+            LOGERR( klogErr, rc, "cannot start thread to load table" );
+            *( table_lctx( dst, tab ) ) = lctx;
+            hdf5_enter();
+            KDirectoryRelease ( job->src );
+            hdf5_leave();
+        }
+    }
+    job->started = ( rc == 0 );
+    return rc;
+}
+
+
+static rc_t table_job_join( table_job * job, ld_context * lctx )
+{
+    rc_t rc = 0;
+    if ( job->started )
+    {
+        rc_t status;
+        rc = KThreadWait ( job->thread, &status );
+        if ( rc == 0 )
+            rc = job->rc;
+        KThreadRelease ( job->thread );
+
+        *( table_lctx( job->dst, job->tab ) ) = lctx;
+        lctx->total_seq_bases += job->lctx.total_seq_bases;
+        lctx->total_seq_spots += job->lctx.total_seq_spots;
+
+        hdf5_enter();
+        KDirectoryRelease ( job->src );
+        hdf5_leave();
+        job->started = false;
+    }
+    return rc;
+}
+
+
+static void table_job_join_optional( table_job * job, ld_context * lctx )
+{
+    if ( job->started && table_job_join( job, lctx ) != 0 )
+    {
+        if ( job->tab == tab_passes )
+            LOGMSG( klogWarn, "the passes-table is missing" );
+        else
+            LOGMSG( klogWarn, "the metrics-table is missing" );
+    }
+}
+
+
+/* waits for the optional tables until less than max_threads tables are loading */
+static void table_jobs_limit( table_job * jobs, uint32_t max_threads, ld_context * lctx )
+{
+    uint32_t tab, running = 0;
+
+    for ( tab = 0; tab < tab_count; ++tab )
+    {
+        if ( jobs[ tab ].started )
+            running++;
+    }
+    for ( tab = tab_passes; tab < tab_count && running >= max_threads; ++tab )
+    {
+        if ( jobs[ tab ].started )
+        {
+            table_job_join_optional( &jobs[ tab ], lctx );
+            running--;
+        }
+    }
+}
+
+
+/* same as pacbio_load_src(), but every table is loaded by its own thread:
+   SEQUENCE and CONSENSUS in parallel, PASSES and METRICS are only loaded
+   if CONSENSUS was present, they start as soon as it is done,
+   never more than ctx->threads tables are loading at the same time */
+static rc_t pacbio_load_src_parallel( context *ctx, KDirectory * wd, seq_con_pas_met * dst,
+                                      uint32_t idx, bool * consensus_present, ld_context * lctx )
+{
+    table_job jobs[ tab_count ];
+    uint32_t tab;
+    rc_t rc1, rc = 0;
+
+    for ( tab = 0; tab < tab_count; ++tab )
+        jobs[ tab ].started = false;
+
+    /* the jobs make their own progressbars, the initial one would stay at 0% */
+    progress_release( &lctx->xml_progress );
+
+    if ( ctx_ld_sequence( ctx ) )
+        rc = table_job_start( &jobs[ tab_sequence ], tab_sequence, ctx, wd, dst, idx, lctx );
+
+    if ( rc == 0 && ctx_ld_consensus( ctx ) )
+    {
+        rc = table_job_start( &jobs[ tab_consensus ], tab_consensus, ctx, wd, dst, idx, lctx );
+        if ( rc == 0 )
+        {
+            rc1 = table_job_join( &jobs[ tab_consensus ], lctx );
+            if ( rc1 == 0 )
+                *consensus_present = true;
+            else
+                LOGMSG( klogWarn, "the consensus-group is missing" );
+        }
+    }
+
+    if ( rc == 0 && ctx_ld_passes( ctx ) && *consensus_present )
+    {
+        table_jobs_limit( jobs, ctx->threads, lctx );
+        rc = table_job_start( &jobs[ tab_passes ], tab_passes, ctx, wd, dst, idx, lctx );
+    }
+
+    if ( rc == 0 && ctx_ld_metrics( ctx ) && *consensus_present )
+    {
+        table_jobs_limit( jobs, ctx->threads, lctx );
+        rc = table_job_start( &jobs[ tab_metrics ], tab_metrics, ctx, wd, dst, idx, lctx );
+    }
+
+    table_job_join_optional( &jobs[ tab_passes ], lctx );
+    table_job_join_optional( &jobs[ tab_metrics ], lctx );
+
+    rc1 = table_job_join( &jobs[ tab_sequence ], lctx );
+    if ( rc == 0 )
+        rc = rc1;
+    return rc;
+}
+
+
 static bool pacbio_has_MultiParts( KDirectory * hdf5_src )
 {
     uint32_t pt = KDirectoryPathType ( hdf5_src, "MultiPart/Parts" );
@@ -377,7 +573,10 @@ static rc_t pacbio_load_multipart( context * ctx, KDirectory * wd, VDatabase * d
     rc_t rc = pacbio_prepare( database, &dst, *hdf5_src, lctx );
     while ( idx < count && rc == 0 )
     {
-        rc = pacbio_load_src( ctx, &dst, *hdf5_src, consensus_present );
+        if ( ctx->threads > 1 )
+            rc = pacbio_load_src_parallel( ctx, wd, &dst, idx, consensus_present, lctx );
+        else
+            rc = pacbio_load_src( ctx, &dst, *hdf5_src, consensus_present );
         idx++;
         if ( rc == 0 && idx < count )
         {
@@ -420,6 +619,9 @@ static rc_t pacbio_load( context *ctx, KDirectory * wd, ld_context *lctx, const
     if ( rc == 0 )
         rc = pacbio_load_schema( wd, vdb_mgr, &schema, ctx->schema_name );
 
+    if ( rc == 0 && ctx->threads > 1 )
+        rc = pl_locks_make(); /* pl-tools.c */
+
 
     /* creates the output vdb database */
     if ( rc == 0 )
@@ -511,6 +713,8 @@ static rc_t pacbio_load( context *ctx, KDirectory * wd, ld_context *lctx, const
 
     if ( vdb_mgr != NULL )
         VDBManagerRelease ( vdb_mgr );
+
+    pl_locks_release(); /* pl-tools.c */
     return rc;
 }
 
@@ -582,7 +786,8 @@ OptDef MyOptions[] =
     { OPTION_FORCE, ALIAS_FORCE, NULL, force_usage, 1, false, false },
     { OPTION_WITH_PROGRESS, ALIAS_WITH_PROGRESS, NULL, progress_usage, 1, false, false },
     { OPTION_TABS, ALIAS_TABS, NULL, tabs_usage, 1, true, false },
-    { OPTION_OUTPUT, ALIAS_OUTPUT, NULL, output_usage, 1, true, true }
+    { OPTION_OUTPUT, ALIAS_OUTPUT, NULL, output_usage, 1, true, true },
+    { OPTION_THREADS, NULL, NULL, threads_usage, 1, true, false }
 };
 
 
@@ -93,6 +93,21 @@ static const char* ctx_get_str( const Args *args, const char *name, const char *
 }
 
 
+static uint32_t ctx_get_uint32( const Args *args, const char *name, const uint32_t def )
+{
+    uint32_t res = def;
+    const char * value = ctx_get_str( args, name, NULL );
+    if ( value != NULL )
+    {
+        char * end;
+        unsigned long v = strtoul( value, &end, 10 );
+        if ( end != value && *end == 0 )
+            res = ( uint32_t )v;
+    }
+    return res;
+}
+
+
 void ctx_free( context *ctx )
 {
     if ( ctx->dst_path != NULL )
@@ -114,6 +129,7 @@ rc_t ctx_init( const Args * args, context *ctx )
     ctx->tabs = NULL;
     ctx->force = false;
     ctx->with_progress = false;
+    ctx->threads = 1;
 
     rc = VNamelistMake ( &ctx->src_paths, 5 );
     if ( rc == 0 )
@@ -126,6 +142,7 @@ rc_t ctx_init( const Args * args, context *ctx )
             ctx->schema_name = ctx_set_str( ctx_get_str( args, OPTION_SCHEMA, DFLT_SCHEMA ), DFLT_SCHEMA );
             ctx->dst_path = ctx_set_str( ctx_get_str( args, OPTION_OUTPUT, NULL ), NULL );
             ctx->tabs = ctx_set_str( ctx_get_str( args, OPTION_TABS, NULL ), NULL );
+            ctx->threads = ctx_get_uint32( args, OPTION_THREADS, 1 );
         }
         if ( rc == 0 )
         {
@@ -172,6 +189,8 @@ rc_t ctx_show( context * ctx )
         LOGMSG( klogInfo, "   force   : 'no'" );
     if ( ctx->tabs != NULL )
         PLOGMSG( klogInfo, ( klogInfo, "   tabs    : '$(SRC)'", "SRC=%s", ctx->tabs ));
+    if ( ctx->threads > 1 )
+        PLOGMSG( klogInfo, ( klogInfo, "   threads : '$(N)'", "N=%u", ctx->threads ));
 
     KLogLevelSet( tmp_lvl );
     return rc;
@@ -45,6 +45,7 @@ extern "C" {
 #define OPTION_TABS         "tabs"
 #define OPTION_WITH_PROGRESS  "with_progressbar"
 #define OPTION_OUTPUT       "output"
+#define OPTION_THREADS      "threads"
 
 #define ALIAS_SCHEMA        "S"
 #define ALIAS_FORCE         "f"
@@ -67,6 +68,7 @@ typedef struct context
     VNamelist * src_paths;  /* list of source-paths */
     bool force;         /* if true", overwrite eventually existing output-db */
     bool with_progress; /* if true", use the pl_progressbar */
+    uint32_t threads;   /* if > 1, load up to threads tables of a source in parallel */
 } context;
 
 
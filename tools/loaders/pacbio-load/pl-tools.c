@@ -34,6 +34,7 @@
 #include <kdb/database.h>
 #include <vdb/database.h>
 #include <vdb/vdb-priv.h>
+#include <kproc/lock.h>
 
 void lctx_init( ld_context * lctx )
 {
@@ -63,10 +64,57 @@ void lctx_free( ld_context * lctx )
 }
 
 
-rc_t check_src_objects( const KDirectory *hdf5_dir,
-                        const char ** groups, 
-                        const char **tables,
-                        bool show_not_found )
+static KLock * hdf5_lock = NULL;
+static KLock * progress_lock = NULL;
+
+
+rc_t pl_locks_make( void )
+{
+    rc_t rc = KLockMake ( &hdf5_lock );
+    if ( rc == 0 )
+        rc = KLockMake ( &progress_lock );
+    if ( rc != 0 )
+    {
+        LOGERR( klogErr, rc, "cannot make lock" );
+        pl_locks_release();
+    }
+    return rc;
+}
+
+
+void pl_locks_release( void )
+{
+    if ( hdf5_lock != NULL )
+    {
+        KLockRelease ( hdf5_lock );
+        hdf5_lock = NULL;
+    }
+    if ( progress_lock != NULL )
+    {
+        KLockRelease ( progress_lock );
+        progress_lock = NULL;
+    }
+}
+
+
+void hdf5_enter( void )
+{
+    if ( hdf5_lock != NULL )
+        KLockAcquire ( hdf5_lock );
+}
+
+
+void hdf5_leave( void )
+{
+    if ( hdf5_lock != NULL )
+        KLockUnlock ( hdf5_lock );
+}
+
+
+static rc_t check_src_objects_no_lock( const KDirectory *hdf5_dir,
+                                       const char ** groups,
+                                       const char **tables,
+                                       bool show_not_found )
 {
     rc_t rc = 0;
     uint16_t idx = 0;
@@ -117,6 +165,19 @@ rc_t check_src_objects( const KDirectory *hdf5_dir,
 }
 
 
+rc_t check_src_objects( const KDirectory *hdf5_dir,
+                        const char ** groups, 
+                        const char **tables,
+                        bool show_not_found )
+{
+    rc_t rc;
+    hdf5_enter();
+    rc = check_src_objects_no_lock( hdf5_dir, groups, tables, show_not_found );
+    hdf5_leave();
+    return rc;
+}
+
+
 void init_array_file( af_data * af )
 {
     af->f  = NULL;
@@ -124,10 +185,13 @@ void init_array_file( af_data * af )
     af->extents = NULL;
     af->rc = -1;
     af->content = NULL;
+    af->window = NULL;
+    af->window_pos = 0;
+    af->window_count = 0;
 }
 
 
-void free_array_file( af_data * af )
+static void free_array_file_no_lock( af_data * af )
 {
     if ( af->af != NULL )
     {
@@ -149,6 +213,20 @@ void free_array_file( af_data * af )
         free( af->content );
         af->content = NULL;
     }
+    if ( af->window != NULL )
+    {
+        free( af->window );
+        af->window = NULL;
+    }
+    af->window_count = 0;
+}
+
+
+void free_array_file( af_data * af )
+{
+    hdf5_enter();
+    free_array_file_no_lock( af );
+    hdf5_leave();
 }
 
 
@@ -185,14 +263,14 @@ static rc_t read_cache_content( af_data * af )
 }
 
 
-rc_t open_array_file( const KDirectory *dir,
-                      const char *name,
-                      af_data * af,
-                      const uint64_t expected_element_bits,
-                      const uint64_t expected_cols,
-                      bool disp_wrong_bitsize,
-                      bool cache_content,
-                      bool supress_err_msg )
+static rc_t open_array_file_no_lock( const KDirectory *dir,
+                                     const char *name,
+                                     af_data * af,
+                                     const uint64_t expected_element_bits,
+                                     const uint64_t expected_cols,
+                                     bool disp_wrong_bitsize,
+                                     bool cache_content,
+                                     bool supress_err_msg )
 {
     rc_t rc;
 
@@ -215,7 +293,7 @@ rc_t open_array_file( const KDirectory *dir,
     {
         PLOGERR( klogErr, ( klogErr, rc, "cannot open hdf5-arrayfile '$(name)'",
                             "name=%s", name ) );
-        free_array_file( af );
+        free_array_file_no_lock( af );
         return rc;
     }
     /* detect the dimensionality of the array-file */
@@ -224,7 +302,7 @@ rc_t open_array_file( const KDirectory *dir,
     {
         PLOGERR( klogErr, ( klogErr, rc, "cannot retrieve dimensionality on '$(name)'",
                             "name=%s", name ) );
-        free_array_file( af );
+        free_array_file_no_lock( af );
         return rc;
     }
     /* make a array to hold the extent in every dimension */
@@ -234,7 +312,7 @@ rc_t open_array_file( const KDirectory *dir,
         rc = RC ( rcApp, rcArgv, rcAccessing, rcMemory, rcExhausted );
         PLOGERR( klogErr, ( klogErr, rc, "cannot allocate enough memory for extents of '$(name)'",
                             "name=%s", name ) );
-        free_array_file( af );
+        free_array_file_no_lock( af );
         return rc;
     }
     /* read the actuall extents into the created array */
@@ -243,7 +321,7 @@ rc_t open_array_file( const KDirectory *dir,
     {
         PLOGERR( klogErr, ( klogErr, rc, "cannot retrieve extents of '$(name)'",
                             "name=%s", name ) );
-        free_array_file( af );
+        free_array_file_no_lock( af );
         return rc;
     }
     /* request the size of the element in bits */
@@ -252,7 +330,7 @@ rc_t open_array_file( const KDirectory *dir,
     {
         PLOGERR( klogErr, ( klogErr, rc, "cannot retrieve element-size of '$(name)'",
                             "name=%s", name ) );
-        free_array_file( af );
+        free_array_file_no_lock( af );
         return rc;
     }
     /* compare the discovered bit-size with the expected one */
@@ -267,7 +345,7 @@ rc_t open_array_file( const KDirectory *dir,
             PLOGERR( klogErr, ( klogErr, rc, "unexpected element-bits of $(bsize) in '$(name)'",
                      "bsize=%lu,name=%s", af->element_bits, name ) );
 
-        free_array_file( af );
+        free_array_file_no_lock( af );
         return rc;
     }
 
@@ -280,7 +358,7 @@ rc_t open_array_file( const KDirectory *dir,
             rc = RC ( rcExe, rcNoTarg, rcLoading, rcData, rcInconsistent );
             PLOGERR( klogErr, ( klogErr, rc, "unexpected dimensionality of $(dim) in '$(name)'",
                                 "dim=%lu,name=%s", af->dimensionality, name ) );
-            free_array_file( af );
+            free_array_file_no_lock( af );
             return rc;
         }
     }
@@ -292,7 +370,7 @@ rc_t open_array_file( const KDirectory *dir,
             rc = RC ( rcExe, rcNoTarg, rcLoading, rcData, rcInconsistent );
             PLOGERR( klogErr, ( klogErr, rc, "unexpected dimensionality of $(dim) in '$(name)'",
                                 "dim=%lu,name=%s", af->dimensionality, name ) );
-            free_array_file( af );
+            free_array_file_no_lock( af );
             return rc;
         }
         else
@@ -302,7 +380,7 @@ rc_t open_array_file( const KDirectory *dir,
                 rc = RC ( rcExe, rcNoTarg, rcLoading, rcData, rcInconsistent );
                 PLOGERR( klogErr, ( klogErr, rc, "unexpected extent[1] of $(ext) in '$(name)'",
                                     "ext=%lu,name=%s", af->extents[ 1 ], name ) );
-                free_array_file( af );
+                free_array_file_no_lock( af );
                 return rc;
             }
         }
@@ -315,6 +393,24 @@ rc_t open_array_file( const KDirectory *dir,
 }
 
 
+rc_t open_array_file( const KDirectory *dir,
+                      const char *name,
+                      af_data * af,
+                      const uint64_t expected_element_bits,
+                      const uint64_t expected_cols,
+                      bool disp_wrong_bitsize,
+                      bool cache_content,
+                      bool supress_err_msg )
+{
+    rc_t rc;
+    hdf5_enter();
+    rc = open_array_file_no_lock( dir, name, af, expected_element_bits, expected_cols,
+                                  disp_wrong_bitsize, cache_content, supress_err_msg );
+    hdf5_leave();
+    return rc;
+}
+
+
 /* assembles the 'absolute' path to the requested array-file before opening it */
 rc_t open_element( const KDirectory *hdf5_dir, 
                    af_data *element, 
@@ -342,6 +438,100 @@ rc_t open_element( const KDirectory *hdf5_dir,
 }
 
 
+/* the loaders read the datasets front to back in small pieces ( one spot at a time ),
+   instead of asking HDF5 for every piece we read AF_WINDOW_BYTES at once,
+   a row of a 2-dim. dataset is extents[ 1 ] elements */
+static uint64_t array_file_row_bytes( const af_data * af )
+{
+    uint64_t res = ( af->element_bits >> 3 );
+    if ( af->dimensionality == 2 )
+        res *= af->extents[ 1 ];
+    return res;
+}
+
+
+static bool array_file_use_window( const af_data * af, const uint64_t count )
+{
+    return ( ( af->dimensionality == 1 || af->dimensionality == 2 ) &&
+             af->element_bits >= 8 && ( af->element_bits & 7 ) == 0 &&
+             array_file_row_bytes( af ) > 0 &&
+             count * array_file_row_bytes( af ) <= AF_WINDOW_BYTES );
+}
+
+
+static rc_t array_file_fill_window( af_data * af, const uint64_t pos )
+{
+    rc_t rc = 0;
+    uint64_t count = 0;
+
+    if ( af->window == NULL )
+    {
+        af->window = malloc( AF_WINDOW_BYTES );
+        if ( af->window == NULL )
+            rc = RC ( rcExe, rcNoTarg, rcLoading, rcMemory, rcExhausted );
+    }
+    af->window_pos = pos;
+    af->window_count = 0;
+    if ( rc == 0 && pos < af->extents[ 0 ] )
+    {
+        count = AF_WINDOW_BYTES / array_file_row_bytes( af );
+        if ( count > af->extents[ 0 ] - pos )
+            count = af->extents[ 0 ] - pos;
+    }
+    if ( rc == 0 && count > 0 )
+    {
+        hdf5_enter();
+        if ( af->dimensionality == 1 )
+        {
+            uint64_t n_read = 0;
+            rc = KArrayFileRead ( af->af, 1, &pos, af->window, &count, &n_read );
+            if ( rc == 0 )
+                af->window_count = n_read;
+        }
+        else
+        {
+            uint64_t pos2[ 2 ];
+            uint64_t read2[ 2 ];
+            uint64_t count2[ 2 ];
+
+            pos2[ 0 ] = pos;
+            pos2[ 1 ] = 0;
+            count2[ 0 ] = count;
+            count2[ 1 ] = af->extents[ 1 ];
+            rc = KArrayFileRead ( af->af, 2, pos2, af->window, count2, read2 );
+            if ( rc == 0 )
+                af->window_count = read2[ 0 ];
+        }
+        hdf5_leave();
+    }
+    return rc;
+}
+
+
+/* serves count rows at pos from the window, refills it if they are not in it */
+static rc_t array_file_read_window( af_data * af, const uint64_t pos,
+                                    void *dst, const uint64_t count,
+                                    uint64_t *n_read )
+{
+    rc_t rc = 0;
+    uint64_t row_bytes = array_file_row_bytes( af );
+    if ( pos < af->window_pos || pos + count > af->window_pos + af->window_count )
+        rc = array_file_fill_window( af, pos );
+    if ( rc == 0 )
+    {
+        /* near the end of the dataset the window can hold less than requested */
+        uint64_t avail = ( af->window_pos + af->window_count ) - pos;
+        if ( avail > count )
+            avail = count;
+        memmove( dst,
+                 ( char * )af->window + ( pos - af->window_pos ) * row_bytes,
+                 avail * row_bytes );
+        *n_read = avail;
+    }
+    return rc;
+}
+
+
 /* we are reading data from an array-file,
    the underlying array-file knows the size of an element */
 rc_t array_file_read_dim1( af_data * af, const uint64_t pos,
@@ -349,8 +539,16 @@ rc_t array_file_read_dim1( af_data * af, const uint64_t pos,
                            uint64_t *n_read )
 {
     rc_t rc = 0;
-    if ( af->content == NULL )
+    if ( af->content == NULL && af->dimensionality == 1 && array_file_use_window( af, count ) )
+    {
+        rc = array_file_read_window( af, pos, dst, count, n_read );
+    }
+    else if ( af->content == NULL )
+    {
+        hdf5_enter();
         rc = KArrayFileRead ( af->af, 1, &pos, dst, &count, n_read );
+        hdf5_leave();
+    }
     else
     {
         if ( ( pos + count ) > af->extents[ 0 ] )
@@ -377,7 +575,15 @@ rc_t array_file_read_dim2( af_data * af, const uint64_t pos,
                            const uint64_t ext2, uint64_t *n_read )
 {
     rc_t rc = 0;
-    if ( af->content == NULL )
+    if ( af->content == NULL && af->dimensionality == 2 &&
+         ext2 == af->extents[ 1 ] && array_file_use_window( af, count ) )
+    {
+        /* whole rows: served from the window, n_read counts rows like KArrayFileRead */
+        rc = array_file_read_window( af, pos, dst, count, n_read );
+        if ( rc != 0 )
+            LOGERR( klogErr, rc, "error reading arrayfile-data (2 dim)" );
+    }
+    else if ( af->content == NULL )
     {
         uint64_t pos2[ 2 ];
         uint64_t read2[ 2 ];
@@ -388,7 +594,9 @@ rc_t array_file_read_dim2( af_data * af, const uint64_t pos,
         pos2[ 1 ] = 0;
         count2[ 0 ] = count;
         count2[ 1 ] = ext2;
+        hdf5_enter();
         rc = KArrayFileRead ( af->af, 2, pos2, dst, count2, read2 );
+        hdf5_leave();
         if ( rc != 0 )
             LOGERR( klogErr, rc, "error reading arrayfile-data (2 dim)" );
         *n_read = read2[ 0 ];
@@ -570,9 +778,12 @@ rc_t load_table( VDatabase * database, KDirectory * hdf5_src, ld_context *lctx,
 }
 
 
+/* the progressbars are kept in a global list by the loader-library */
 rc_t progress_chunk( const KLoadProgressbar ** xml_progress, const uint64_t chunk )
 {
     rc_t rc;
+    if ( progress_lock != NULL )
+        KLockAcquire ( progress_lock );
     /* release the old progressbar... */
     if ( *xml_progress != NULL )
     {
@@ -585,16 +796,38 @@ rc_t progress_chunk( const KLoadProgressbar ** xml_progress, const uint64_t chun
     else
         LOGERR( klogErr, rc, "cannot make KLoadProgressbar" );
 
+    if ( progress_lock != NULL )
+        KLockUnlock ( progress_lock );
     return rc;
 }
 
 
 rc_t progress_step( const KLoadProgressbar * xml_progress )
 {
+    rc_t rc = 0;
     if ( xml_progress != NULL )
-       return KLoadProgressbar_Process( xml_progress, 1, false );
-    else
-        return 0;
+    {
+        if ( progress_lock != NULL )
+            KLockAcquire ( progress_lock );
+        rc = KLoadProgressbar_Process( xml_progress, 1, false );
+        if ( progress_lock != NULL )
+            KLockUnlock ( progress_lock );
+    }
+    return rc;
+}
+
+
+void progress_release( const KLoadProgressbar ** xml_progress )
+{
+    if ( *xml_progress != NULL )
+    {
+        if ( progress_lock != NULL )
+            KLockAcquire ( progress_lock );
+        KLoadProgressbar_Release( *xml_progress, false );
+        *xml_progress = NULL;
+        if ( progress_lock != NULL )
+            KLockUnlock ( progress_lock );
+    }
 }
 
 
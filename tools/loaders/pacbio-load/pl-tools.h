@@ -191,6 +191,17 @@ void lctx_init( ld_context * lctx );
 void lctx_free( ld_context * lctx );
 
 
+/* the HDF5-library is not thread-safe, if the tables are loaded by multiple
+   threads every call into it is made between hdf5_enter() and hdf5_leave(),
+   the progressbars are guarded the same way
+   ( without pl_locks_make() these calls do nothing ) */
+rc_t pl_locks_make( void );
+void pl_locks_release( void );
+
+void hdf5_enter( void );
+void hdf5_leave( void );
+
+
 rc_t check_src_objects( const KDirectory *hdf5_dir,
                         const char ** groups,
                         const char **tables,
@@ -205,8 +216,14 @@ typedef struct af_data
     uint64_t * extents;         /* the extension in every dimension */
     uint64_t element_bits;      /* how big in bits is the element */
     void * content;             /* read the whole thing into memory */
+    void * window;              /* a chunk of the dataset, read in one call */
+    uint64_t window_pos;        /* the first row in the window */
+    uint64_t window_count;      /* how many rows are in the window */
 } af_data;
 
+/* small reads of 1-dim. and 2-dim. datasets are served from a window of this size */
+#define AF_WINDOW_BYTES ( 1024 * 1024 )
+
 
 void init_array_file( af_data * af );
 void free_array_file( af_data * af );
@@ -278,6 +295,7 @@ rc_t load_table( VDatabase * database, KDirectory * hdf5_src, ld_context *lctx,
 
 rc_t progress_chunk( const KLoadProgressbar ** xml_progress, const uint64_t chunk );
 rc_t progress_step( const KLoadProgressbar * xml_progress );
+void progress_release( const KLoadProgressbar ** xml_progress );
 
 void print_log_info( const char * info );
 
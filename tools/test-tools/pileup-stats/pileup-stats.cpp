@@ -344,7 +344,7 @@ namespace ncbi
         {
             if ( verbosity > 0 )
             {
-                std :: cerr << "# Preparing version " << GW_CURRENT_VERSION << " pipe to stdout\n";
+                std :: cerr << "# Preparing version " << GW_COMPATIBLE_VERSION << " pipe to stdout\n";
                 if ( ( integer_column_flag_bits & 1 ) != 0 )
                     std :: cerr << "#   USING INTEGER PACKING\n";
             }
@@ -34,6 +34,8 @@
 #include <stdexcept>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <thread>
 #include <cassert>
 #include <cmath>
 #include "utility.hpp"
@@ -346,7 +348,264 @@ struct ContigPair { ///< a pair of contigs that are *known* to be joined, e.g. t
     }
 };
 
-static int process(VDB::Writer const &out, LineBuffer &ifs)
+struct TextSource { ///< contig pairs from the sorted output of `map`
+    LineBuffer &in;
+
+    TextSource(LineBuffer &in) : in(in) {}
+    ContigPair next() { return ContigPair(in); }
+    double position() const { return in.position(); }
+};
+
+/// fixed-width binary records are sorted in the same order as
+/// `sort -k1,1 -k2n,2n -k3n,3n -k4,4 -k5n,5n -k6n,6n` would sort the text;
+/// references are ranked by name, so the order doesn't depend on the order in which the names were seen
+struct PairOrder {
+    std::vector<unsigned> refRank;
+    std::vector<unsigned> groupRank;
+
+    static std::vector<unsigned> ranks(strings_map const &names) {
+        auto const N = names.count();
+        auto sorted = std::vector<std::pair<std::string, unsigned>>();
+        sorted.reserve(N);
+        for (auto i = decltype(N)(0); i < N; ++i)
+            sorted.emplace_back(names[i], i);
+        std::sort(sorted.begin(), sorted.end());
+
+        auto result = std::vector<unsigned>(N);
+        for (auto i = decltype(N)(0); i < N; ++i)
+            result[sorted[i].second] = i;
+        return result;
+    }
+    /// new names never change the relative order of existing ones, so runs sorted with older ranks stay sorted
+    void update() {
+        refRank = ranks(references);
+        groupRank = ranks(groups);
+    }
+    bool operator ()(ContigPair const &a, ContigPair const &b) const {
+        if (a.first.ref != b.first.ref) return refRank[a.first.ref] < refRank[b.first.ref];
+        if (a.first.start != b.first.start) return a.first.start < b.first.start;
+        if (a.first.end != b.first.end) return a.first.end < b.first.end;
+        if (a.second.ref != b.second.ref) return refRank[a.second.ref] < refRank[b.second.ref];
+        if (a.second.start != b.second.start) return a.second.start < b.second.start;
+        if (a.second.end != b.second.end) return a.second.end < b.second.end;
+        if (a.group != b.group) return groupRank[a.group] < groupRank[b.group];
+        return false;
+    }
+};
+
+/// sorts contig pairs within a memory budget;
+/// when the buffer fills, it is cut into one slice per thread, each slice is sorted and spilled to its own temp file;
+/// identical pairs are collapsed into one with the sum of their counts, `process` would merge them anyway
+class PairSorter {
+    struct Run {
+        FILE *fp;
+        size_t remain;          ///< records not yet read from the file
+        std::vector<ContigPair> buffer;
+        ContigPair const *cur;
+        ContigPair const *end;
+        ContigPair head;
+
+        bool advance() {
+            if (cur == end) {
+                if (fp == nullptr || remain == 0) return false;
+                auto const n = fread(buffer.data(), sizeof(ContigPair), std::min(remain, buffer.size()), fp);
+                if (n == 0) {
+                    std::cerr << "error: failed to read temporary file" << std::endl;
+                    exit(3);
+                }
+                remain -= n;
+                cur = buffer.data();
+                end = cur + n;
+            }
+            head = *cur++;
+            return true;
+        }
+    };
+    struct Slice {
+        ContigPair *beg;
+        ContigPair *end;
+    };
+
+    PairOrder order;
+    std::vector<ContigPair> buffer;
+    size_t const capacity;  ///< in records
+    unsigned const threads;
+    std::string const tmpdir;
+    std::vector<std::pair<FILE *, size_t>> spilled;
+    std::vector<Slice> slices;  ///< of the last buffer, if nothing was spilled
+    std::vector<Run> runs;
+    std::vector<unsigned> heap;
+    uint64_t total;
+    uint64_t consumed;
+
+    PairSorter(PairSorter const &); // no copy
+    PairSorter &operator =(PairSorter const &); // no assignment
+
+    static ContigPair *collapse(ContigPair *const beg, ContigPair *const end) {
+        if (beg == end) return end;
+        auto out = beg;
+        for (auto i = beg + 1; i != end; ++i) {
+            if (*out == *i)
+                out->count += i->count;
+            else
+                *++out = *i;
+        }
+        return out + 1;
+    }
+    FILE *tempFile() const {
+        auto path = tmpdir + "/summarize-pairs.XXXXXX";
+        auto const fd = mkstemp(&path[0]);
+        if (fd < 0) {
+            std::cerr << "failed to create temporary file in " << tmpdir << std::endl;
+            exit(3);
+        }
+        POSIX::unlink(path.c_str()); ///< the file is gone as soon as it's closed
+        auto const fp = fdopen(fd, "w+b");
+        if (fp == nullptr) {
+            std::cerr << "failed to open temporary file in " << tmpdir << std::endl;
+            exit(3);
+        }
+        return fp;
+    }
+    /// sorts the buffer in one slice per thread; if `spill`, each thread writes its slice to its own temp file
+    void sortBuffer(bool const spill) {
+        order.update();
+        slices.clear();
+
+        auto const N = buffer.size();
+        auto const n = std::max<size_t>(1, std::min<size_t>(threads, N / 1024));
+        auto files = std::vector<FILE *>(n, nullptr);
+        auto failed = std::vector<char>(n, 0);
+        auto workers = std::vector<std::thread>();
+
+        for (auto i = decltype(n)(0); i < n; ++i) {
+            auto const slice = Slice({ buffer.data() + N * i / n, buffer.data() + N * (i + 1) / n });
+            slices.push_back(slice);
+            if (spill)
+                files[i] = tempFile();
+        }
+        for (auto i = decltype(n)(0); i < n; ++i) {
+            workers.emplace_back([this, i, &files, &failed]() {
+                auto &slice = slices[i];
+                std::sort(slice.beg, slice.end, order);
+                slice.end = collapse(slice.beg, slice.end);
+                if (files[i]) {
+                    auto const count = size_t(slice.end - slice.beg);
+                    if (fwrite(slice.beg, sizeof(ContigPair), count, files[i]) != count || fflush(files[i]) != 0)
+                        failed[i] = 1;
+                }
+            });
+        }
+        for (auto && worker : workers)
+            worker.join();
+
+        if (!spill) return;
+        for (auto i = decltype(n)(0); i < n; ++i) {
+            if (failed[i]) {
+                std::cerr << "failed to write temporary file in " << tmpdir << std::endl;
+                exit(3);
+            }
+            spilled.emplace_back(files[i], size_t(slices[i].end - slices[i].beg));
+        }
+        slices.clear();
+        buffer.clear();
+    }
+    bool greater(unsigned const a, unsigned const b) const {
+        return order(runs[b].head, runs[a].head);
+    }
+public:
+    PairSorter(size_t const memory, unsigned const threads, std::string const &tmpdir)
+    : capacity(std::max<size_t>(memory / sizeof(ContigPair), 64 * 1024))
+    , threads(threads ? threads : 1)
+    , tmpdir(tmpdir)
+    , total(0)
+    , consumed(0)
+    {
+        buffer.reserve(capacity);
+    }
+    ~PairSorter() {
+        for (auto && i : spilled)
+            fclose(i.first);
+    }
+    void add(ContigPair const &pair) {
+        buffer.push_back(pair);
+        if (buffer.size() == capacity) {
+            sortBuffer(true);
+            std::cerr << "info: spilled run " << spilled.size() << " to " << tmpdir << std::endl;
+        }
+    }
+    /// sorts whatever is left and sets up the merge
+    void finish() {
+        if (spilled.empty()) {
+            sortBuffer(false);
+            for (auto && slice : slices) {
+                auto run = Run();
+                run.fp = nullptr;
+                run.remain = 0;
+                run.cur = slice.beg;
+                run.end = slice.end;
+                runs.push_back(run);
+                total += slice.end - slice.beg;
+            }
+        }
+        else {
+            if (!buffer.empty())
+                sortBuffer(true);
+            std::vector<ContigPair>().swap(buffer); ///< the merge buffers get the memory now
+
+            auto const perRun = std::max<size_t>(capacity / spilled.size(), 4096);
+            runs.reserve(spilled.size());
+            for (auto && i : spilled) {
+                rewind(i.first);
+                auto run = Run();
+                run.fp = i.first;
+                run.remain = i.second;
+                runs.push_back(run);
+                runs.back().buffer.resize(std::min(perRun, i.second));
+                runs.back().cur = runs.back().end = nullptr;
+                total += i.second;
+            }
+        }
+        auto const cmp = [this](unsigned a, unsigned b) { return greater(a, b); };
+        for (auto i = decltype(runs.size())(0); i < runs.size(); ++i) {
+            if (runs[i].advance()) {
+                heap.push_back(unsigned(i));
+                std::push_heap(heap.begin(), heap.end(), cmp);
+            }
+        }
+    }
+    /// the next pair in sorted order; count is 0 at the end
+    ContigPair next() {
+        auto const cmp = [this](unsigned a, unsigned b) { return greater(a, b); };
+        auto result = ContigPair();
+        result.count = 0;
+
+        while (!heap.empty()) {
+            auto const top = heap.front();
+            auto const &head = runs[top].head;
+            if (result.count == 0)
+                result = head;
+            else if (result == head)
+                result.count += head.count;
+            else
+                break;
+            ++consumed;
+
+            std::pop_heap(heap.begin(), heap.end(), cmp);
+            if (runs[top].advance())
+                std::push_heap(heap.begin(), heap.end(), cmp);
+            else
+                heap.pop_back();
+        }
+        return result;
+    }
+    double position() const {
+        return total > 0 ? double(consumed) / total : 1.0;
+    }
+};
+
+template <typename Source>
+static int process(VDB::Writer const &out, Source &ifs)
 {
     auto active = std::vector<ContigPair>();
     
@@ -361,7 +620,7 @@ static int process(VDB::Writer const &out, LineBuffer &ifs)
     auto report = freq;
 
     for ( ; ; ) {
-        auto pair = ContigPair(ifs);
+        auto pair = ifs.next();
         auto const isEOF = pair.count == 0;
         
         if ((!active.empty() && (pair.first.ref != ref || pair.first.start >= end)) || isEOF) {
@@ -515,17 +774,9 @@ static int process(VDB::Writer const &out, LineBuffer &ifs)
     }
 }
 
-static int reduce(FILE *out, std::string const &source)
+template <typename Source>
+static int summarize(FILE *out, Source &source)
 {
-    int fd = 0;
-    if (source != "-") {
-        fd = POSIX::open(source.c_str(), O_RDONLY);
-        if (fd < 0) {
-            std::cerr << "failed to open pairs file: " << source << std::endl;
-            exit(3);
-        }
-    }
-    LineBuffer in(fd);
     auto const writer = VDB::Writer(out);
     
     writer.destination("IR.vdb");
@@ -535,13 +786,34 @@ static int reduce(FILE *out, std::string const &source)
     ContigPair::setup(writer);
 
     writer.beginWriting();
-    auto const result = process(writer, in);
+    auto const result = process(writer, source);
     writer.endWriting();
     
     return result;
 }
 
-static int map(FILE *out, std::string const &run)
+static int reduce(FILE *out, std::string const &source)
+{
+    int fd = 0;
+    if (source != "-") {
+        fd = POSIX::open(source.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "failed to open pairs file: " << source << std::endl;
+            exit(3);
+        }
+    }
+    LineBuffer in(fd);
+    auto pairs = TextSource(in);
+
+    return summarize(out, pairs);
+}
+
+static size_t sortMemory = size_t(1024) << 20;
+static unsigned sortThreads = std::thread::hardware_concurrency();
+static std::string sortTempDir;
+
+template <typename F>
+static void mapPairs(std::string const &run, F &&f)
 {
     auto const mgr = VDB::Manager();
     auto const inDb = mgr[run];
@@ -557,16 +829,36 @@ static int map(FILE *out, std::string const &run)
             for (auto && two : fragment.detail) {
                 if (two.readNo != 2 || !two.aligned) continue;
                 
-                ContigPair(one, two, fragment.group).write(out);
+                f(ContigPair(one, two, fragment.group));
             }
         }
     }
+}
+
+static int map(FILE *out, std::string const &run)
+{
+    mapPairs(run, [&](ContigPair const &pair) { pair.write(out); });
     return 0;
 }
 
+/// map, sort and reduce without the text round trip through `sort`
+static int mapReduce(FILE *out, std::string const &run)
+{
+    PairSorter sorter(sortMemory, sortThreads, sortTempDir);
+
+    std::cerr << "status: mapping" << std::endl;
+    mapPairs(run, [&](ContigPair const &pair) { sorter.add(pair); });
+
+    std::cerr << "status: sorting" << std::endl;
+    sorter.finish();
+
+    std::cerr << "status: reducing" << std::endl;
+    return summarize(out, sorter);
+}
+
 namespace pairsStatistics {
     static void usage(CommandLine const &commandLine, bool error) {
-        (error ? std::cerr : std::cout) << "usage: " << commandLine.program[0] << " [-out=<path>] (map <sra run> | reduce <pairs>)" << std::endl;
+        (error ? std::cerr : std::cout) << "usage: " << commandLine.program[0] << " [-out=<path>] [-mem=<MB>] [-threads=<n>] [-tmpdir=<path>] (map <sra run> | reduce <pairs> | map-reduce <sra run>)" << std::endl;
         exit(error ? 3 : 0);
     }
     
@@ -584,11 +876,31 @@ namespace pairsStatistics {
                 outPath = arg.substr(5);
                 continue;
             }
+            if (arg.substr(0, 5) == "-mem=") {
+                auto const value = arg.substr(5);
+                auto mb = size_t(0);
+                if (!string_to_u(mb, value.data(), value.data() + value.size()) || mb == 0)
+                    usage(commandLine, true);
+                sortMemory = mb << 20;
+                continue;
+            }
+            if (arg.substr(0, 9) == "-threads=") {
+                auto const value = arg.substr(9);
+                if (!string_to_u(sortThreads, value.data(), value.data() + value.size()) || sortThreads == 0)
+                    usage(commandLine, true);
+                continue;
+            }
+            if (arg.substr(0, 8) == "-tmpdir=") {
+                sortTempDir = arg.substr(8);
+                continue;
+            }
             if (verb == nullptr) {
                 if (arg == "map")
                     verb = &map;
                 else if (arg == "reduce")
                     verb = &reduce;
+                else if (arg == "map-reduce")
+                    verb = &mapReduce;
                 else
                     usage(commandLine, true);
                 continue;
@@ -602,6 +914,11 @@ namespace pairsStatistics {
         
         if (source.empty())
             usage(commandLine, true);
+
+        if (sortTempDir.empty()) {
+            auto const tmpdir = getenv("TMPDIR");
+            sortTempDir = (tmpdir && tmpdir[0]) ? tmpdir : "/tmp";
+        }
         
         FILE *ofs = nullptr;
         if (!outPath.empty()) {